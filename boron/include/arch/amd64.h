@@ -74,7 +74,7 @@ MMADDRESS_CONVERT;
 #define MM_AMD64_PTE_ACCESSED   (1ULL <<  5)
 #define MM_AMD64_PTE_DIRTY      (1ULL <<  6)
 #define MM_AMD64_PTE_PAT        (1ULL <<  7)
-#define MM_AMD64_PTE_PAGESIZE   (1ULL <<  7) // in terms of PML3/PML2 entries, for 1GB/2MB pages respectively. Not Used by the kernel
+#define MM_AMD64_PTE_PAGESIZE   (1ULL <<  7) // in terms of PML3/PML2 entries, for 1GB/2MB pages respectively. Only 2MB pages are used by the kernel
 #define MM_AMD64_PTE_GLOBAL     (1ULL <<  8) // doesn't invalidate the pages from the TLB when CR3 is changed
 #define MM_AMD64_PTE_ISFROMPMM  (1ULL <<  9) // if the allocated memory is managed by the PFN database
 //#define MM_AMD64_PTE_COW        (1ULL << 10) // if this page is to be copied after a write -- TODO: We are supposed to be phasing this one out.
@@ -101,6 +101,9 @@ typedef uint64_t MMPTE_HW, *PMMPTE_HW;
 
 #define PAGE_SIZE (0x1000)
 
+// The size of a huge page, mapped by a single PML2 entry.
+#define MM_HUGE_PAGE_SIZE (0x200000)
+
 // bits 0.11   - Offset within the page
 // bits 12..20 - Index within the PML1
 // bits 21..29 - Index within the PML2
@@ -24,6 +24,8 @@ Author:
 #include <ex/process.h>
 #include <ex/object.h>
 #include <ex/bootcfg.h>
+#include <ex/boottrc.h>
+#include <ex/worker.h>
 
 BSTATUS OSQuerySystemInformation(
 	uint32_t QueryType,
@@ -0,0 +1,36 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ex/boottrc.h
+	
+Abstract:
+	This header file defines the executive's boot trace and
+	boot task interface.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#define BOOT_TRACE_MAX_PHASES (128)
+
+typedef void(*PEX_BOOT_TASK)(void* Context);
+
+// Starts timing a boot phase.  The returned value must be passed to ExEndBootPhase.
+// If the trace is full, the phase isn't recorded.
+int ExBeginBootPhase(const char* Name);
+
+void ExEndBootPhase(int Phase);
+
+// Runs Routine once for each of the contexts, and returns once all of them
+// have finished.  Each run is recorded as a boot phase with the matching name.
+//
+// If "ParallelInit=yes" is passed on the kernel command line, each run takes
+// place on its own system thread, so the runs must be independent of each other.
+// Otherwise, they are run one after another on the current thread.
+void ExRunBootTasks(PEX_BOOT_TASK Routine, void** Contexts, const char** Names, int Count);
+
+// Prints the boot trace to the debug log.
+void ExDumpBootTrace();
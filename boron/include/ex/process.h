@@ -15,6 +15,7 @@ Author:
 
 #include <ke/process.h>
 #include <mm/vad.h>
+#include <mm/ws.h>
 #include <ex/rwlock.h>
 
 typedef struct EPROCESS_tag EPROCESS, *PEPROCESS;
@@ -38,6 +39,9 @@ struct EPROCESS_tag
 	// The heap manager for this process.
 	MMHEAP Heap;
 	
+	// The working set information of this process.
+	MMWORKING_SET WorkingSet;
+	
 	// Rwlock that guards the address space of the process.
 	// TODO:  Perhaps this should be replaced by the VAD list lock?
 	EX_RW_LOCK AddressLock;
@@ -47,6 +47,13 @@ typedef struct _EX_RW_LOCK
 	int ExclusiveWaiterCount;
 	
 	int HeldCount;
+	
+#ifdef LOCK_STATISTICS
+	// Lock class of the exclusive owner's acquisition, and when it happened.
+	// Hold times are not tracked for shared owners.
+	PKLOCK_CLASS ExclusiveStatClass;
+	uint64_t ExclusiveAcquiredAt;
+#endif
 }
 EX_RW_LOCK, *PEX_RW_LOCK;
 
@@ -0,0 +1,61 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ex/worker.h
+	
+Abstract:
+	This header file defines the executive's work queue
+	interface.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <ke.h>
+
+typedef void(*PEX_WORKER_ROUTINE)(void* Context);
+
+typedef enum
+{
+	// Work which must be done soon, such as I/O post-processing.  These workers
+	// run at high priority, and at least one of them always exists.
+	WORK_QUEUE_CRITICAL,
+	
+	// Work which may block for a while, such as flushing caches.
+	WORK_QUEUE_DELAYED,
+	
+	// Work which can wait until nothing else is running.
+	WORK_QUEUE_BACKGROUND,
+	
+	WORK_QUEUE_COUNT
+}
+EX_WORK_QUEUE_TYPE;
+
+typedef struct _EX_WORK_ITEM
+{
+	LIST_ENTRY ListEntry;
+	PEX_WORKER_ROUTINE Routine;
+	void* Context;
+}
+EX_WORK_ITEM, *PEX_WORK_ITEM;
+
+// Initializes a work item.  Its storage must stay valid until the routine starts
+// running.  The routine may free it or queue it again.
+void ExInitializeWorkItem(PEX_WORK_ITEM WorkItem, PEX_WORKER_ROUTINE Routine, void* Context);
+
+// Queues a work item to the current processor's pool of worker threads of the
+// specified type.  The routine is called at IPL_NORMAL and may block.
+//
+// This may be called at IPL_DPC or below.  A work item may not be queued again
+// until its routine has started running.
+void ExQueueWorkItem(PEX_WORK_ITEM WorkItem, EX_WORK_QUEUE_TYPE QueueType);
+
+// Same as ExQueueWorkItem, but the work item is queued to the pool of the
+// specified processor instead.
+void ExQueueWorkItemProcessor(PEX_WORK_ITEM WorkItem, EX_WORK_QUEUE_TYPE QueueType, int Processor);
+
+// Creates the worker pools.  Called during executive initialization.
+bool ExInitializeWorkQueues();
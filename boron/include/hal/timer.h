@@ -52,6 +52,7 @@ bool HalUseOneShotTimer();
 // ==== One Shot Timer ====
 // Requests an interrupt in a certain amount of ticks.
 // This is a feature of the OST only, don't call this if HalUseOneShotTimer() is false.
+// Requesting an interrupt in zero ticks stops the timer.
 void HalRequestInterruptInTicks(uint64_t ticks);
 
 // ==== Periodic Timer ====
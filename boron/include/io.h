@@ -24,6 +24,8 @@ typedef struct _DRIVER_OBJECT DRIVER_OBJECT, *PDRIVER_OBJECT;
 typedef struct _CONTROLLER_OBJECT CONTROLLER_OBJECT, *PCONTROLLER_OBJECT;
 typedef struct _FILE_OBJECT FILE_OBJECT, *PFILE_OBJECT;
 typedef struct _FCB FCB, *PFCB;
+typedef struct _IO_COMPLETION_PORT IO_COMPLETION_PORT, *PIO_COMPLETION_PORT;
+typedef struct _IO_COMPLETION_ASSOCIATION IO_COMPLETION_ASSOCIATION, *PIO_COMPLETION_ASSOCIATION;
 
 #include <io/devobj.h>
 #include <io/drvobj.h>
@@ -33,6 +35,7 @@ typedef struct _FCB FCB, *PFCB;
 #include <io/rdwr.h>
 #include <io/part.h>
 #include <io/pipe.h>
+#include <io/complet.h>
 
 // These aren't meant to be used directly. Instead, they're used
 // by the IoGetBuiltInData function. If the compile unit including
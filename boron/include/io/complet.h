@@ -0,0 +1,49 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	io/complet.h
+	
+Abstract:
+	This header defines APIs related to I/O completion
+	port objects.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+// Associates a file object with a completion port.  Each time the file may
+// have become readable or writable, an entry with the specified key is queued
+// to the port.  An entry is also queued right away, so that the current state
+// of the file is not missed.  A file object may only be associated once.
+BSTATUS IoAssociateCompletionPort(PFILE_OBJECT FileObject, PIO_COMPLETION_PORT Port, void* Key);
+
+// Queues an entry to a completion port.
+BSTATUS IoPostCompletionPort(PIO_COMPLETION_PORT Port, void* Key, BSTATUS Status, uint64_t Information);
+
+// Tells the completion ports associated with file objects opened on this FCB that
+// the file may have become readable or writable (see IO_COMPLETION_READABLE and
+// IO_COMPLETION_WRITABLE).  While an entry for an association is still queued,
+// further notifications are merged into it.
+//
+// File system drivers which support non-blocking I/O call this function.
+void IoNotifyReadinessFcb(PFCB Fcb, uint32_t Readiness);
+
+// ** SYSTEM SERVICES **
+
+BSTATUS OSCreateCompletionPort(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, int MaximumConcurrency);
+
+BSTATUS OSAssociateCompletionPort(HANDLE PortHandle, HANDLE FileHandle, void* Key);
+
+BSTATUS OSPostCompletionPort(HANDLE PortHandle, void* Key, BSTATUS Status, uintptr_t Information);
+
+BSTATUS OSRemoveCompletionPort(
+	HANDLE PortHandle,
+	PIO_COMPLETION_ENTRY Entries,
+	int MaximumEntries,
+	int* OutEntryCount,
+	bool Alertable,
+	int TimeoutMS
+);
@@ -28,6 +28,11 @@ typedef struct _FCB
 	
 	IO_CACHE_INFO CacheInfo;
 	
+	// The completion port associations of file objects opened on this FCB.
+	// See IoNotifyReadinessFcb.
+	KSPIN_LOCK CompletionLock;
+	LIST_ENTRY CompletionList;
+	
 	// FILE_TYPE
 	uint8_t FileType;
 	uint32_t Flags;
@@ -14,6 +14,7 @@ Author:
 #pragma once
 
 typedef struct _IO_STATUS_BLOCK IO_STATUS_BLOCK, *PIO_STATUS_BLOCK;
+typedef struct _IO_COMPLETION_ASSOCIATION IO_COMPLETION_ASSOCIATION, *PIO_COMPLETION_ASSOCIATION;
 
 typedef struct _FILE_OBJECT
 {
@@ -30,6 +31,9 @@ typedef struct _FILE_OBJECT
 	
 	uint32_t Flags;
 	uint32_t OpenFlags;
+	
+	// The completion port association of this file object, if any.
+	PIO_COMPLETION_ASSOCIATION CompletionAssociation;
 }
 FILE_OBJECT, *PFILE_OBJECT;
 
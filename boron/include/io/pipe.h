@@ -15,6 +15,11 @@ Author:
 
 BSTATUS IoCreatePipeObject(PFILE_OBJECT* OutFileObject, PFCB* OutFcb, POBJECT_ATTRIBUTES ObjectAttributes, size_t BufferSize);
 
+// Redirects the pipe's readiness notifications (see IoNotifyReadinessFcb) to other FCBs.
+// This is used when a pipe is part of another object whose file objects are read from
+// and written to instead, such as a terminal.
+void IoSetNotifyFcbsPipe(PFCB PipeFcb, PFCB ReadableNotifyFcb, PFCB WritableNotifyFcb);
+
 BSTATUS IoCreatePipe(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, size_t BufferSize);
 
 BSTATUS OSCreatePipe(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, size_t BufferSize);
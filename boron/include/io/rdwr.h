@@ -38,6 +38,17 @@ BSTATUS IoPerformModifiedPageWrite(
 	uint64_t FileOffset
 );
 
+// Performs a direct write operation over a file object, bypassing the
+// cache.  Used by the page file writer.  Only meant for the kernel,
+// should not be used by device drivers.
+
+BSTATUS IoPerformPagingWrite(
+	PIO_STATUS_BLOCK Iosb,
+	PFILE_OBJECT FileObject,
+	PMDL Mdl,
+	uint64_t FileOffset
+);
+
 #endif
 
 BSTATUS IoReadFileMdl(
@@ -106,6 +117,19 @@ BSTATUS IoDeviceIoControl(
 
 BSTATUS IoSeekFile(PFILE_OBJECT FileObject, int64_t Offset, int Whence, uint64_t* NewOutOffset);
 
+// Moves up to Length bytes from one file object to another through a kernel buffer.
+// If an offset pointer is NULL, the file's current offset is used and advanced.
+// Otherwise, the offset it points to is used and advanced.
+BSTATUS IoSpliceFile(
+	PIO_STATUS_BLOCK Iosb,
+	PFILE_OBJECT InputFile,
+	uint64_t* InputOffset,
+	PFILE_OBJECT OutputFile,
+	uint64_t* OutputOffset,
+	size_t Length,
+	uint32_t Flags
+);
+
 // ** SYSTEM SERVICES **
 
 BSTATUS OSReadFile(PIO_STATUS_BLOCK Iosb, HANDLE Handle, uint64_t ByteOffset, void* Buffer, size_t Length, uint32_t Flags);
@@ -122,6 +146,8 @@ BSTATUS OSGetAlignmentFile(HANDLE Handle, size_t* AlignmentOut);
 
 BSTATUS OSSeekFile(HANDLE FileHandle, int64_t Offset, int Whence, uint64_t* NewOutOffset);
 
+BSTATUS OSSpliceFile(PIO_STATUS_BLOCK Iosb, HANDLE InputHandle, uint64_t* InputOffset, HANDLE OutputHandle, uint64_t* OutputOffset, size_t Length, uint32_t Flags);
+
 BSTATUS OSReadDirectoryEntries(PIO_STATUS_BLOCK Iosb, HANDLE FileHandle, size_t DirectoryEntryCount, PIO_DIRECTORY_ENTRY DirectoryEntries);
 
 BSTATUS OSDeviceIoControl(HANDLE FileHandle, int IoControlCode, void* InBuffer, size_t InBufferSize, void* OutBuffer, size_t OutBufferSize);
@@ -26,6 +26,8 @@ Author:
 #include <ke/locks.h>
 #include <ke/prcb.h>
 #include <ke/stats.h>
+#include <ke/stattbl.h>
+#include <ke/dpcstat.h>
 #include <ke/irq.h>
 #include <ke/int.h>
 #include <ke/dbg.h>
@@ -19,6 +19,7 @@ Author:
 #include <rtl/list.h>
 
 typedef struct KTHREAD_tag KTHREAD, *PKTHREAD;
+typedef struct KQUEUE_tag KQUEUE, *PKQUEUE;
 
 typedef struct KDISPATCH_HEADER_tag
 {
@@ -38,6 +39,7 @@ enum
 	DISPATCH_SEMAPHORE,
 	DISPATCH_THREAD,
 	DISPATCH_PROCESS,
+	DISPATCH_QUEUE,
 };
 
 enum
@@ -65,3 +67,4 @@ void KeInitializeDispatchHeader(PKDISPATCH_HEADER Object, int Type);
 #include "mutex.h"
 #include "semaphor.h"
 #include "process.h"
+#include "queue.h"
@@ -16,6 +16,10 @@ Author:
 #define BORON_KE_DPC_H
 
 #include <arch.h>
+#include <ke/locks.h>
+
+// Passed to KeSetTargetProcessorDpc to run a DPC on the processor which enqueues it.
+#define DPC_TARGET_CURRENT (-1)
 
 typedef struct KDPC_tag KDPC, *PKDPC;
 
@@ -31,20 +35,45 @@ struct KDPC_tag
 	void* SystemArgument1;
 	void* SystemArgument2;
 	
+	// The processor the DPC runs on, or DPC_TARGET_CURRENT.
+	int TargetProcessor;
+	
+	// The time at which the DPC was enqueued.  Only kept track of with DPC_STATS=yes,
+	// but always present, so that drivers don't depend on that setting.
+	uint64_t EnqueuedTime;
+	
 	bool Initialized;
 	bool Enqueued;
 	bool Important;
+	
+	// Threaded DPCs run in their processor's threaded DPC thread instead of at IPL_DPC.
+	bool Threaded;
 };
 
 typedef struct KDPC_QUEUE_tag
 {
 	LIST_ENTRY List;
+	
+	// Other processors insert into this queue when they target a DPC at its
+	// processor.  This lock is only ever held with interrupts disabled.
+	KSPIN_LOCK Lock;
 }
 KDPC_QUEUE, *PKDPC_QUEUE;
 
 // Initialize a DPC object.
 void KeInitializeDpc(PKDPC Dpc, PKDEFERRED_ROUTINE Routine, void* DeferredContext);
 
+// Initialize a threaded DPC object.  Its routine is called at IPL_NORMAL from a real
+// time priority thread of the target processor, so that a long running routine
+// doesn't hold up every other thread on that processor.  The routine should still
+// not block, because the processor's other threaded DPCs wait for it to return.
+void KeInitializeThreadedDpc(PKDPC Dpc, PKDEFERRED_ROUTINE Routine, void* DeferredContext);
+
+// Set the processor that the DPC will run on.  DPC_TARGET_CURRENT, the default, means
+// the processor which enqueues it.  Like KeSetImportantDpc, this must be called while
+// the DPC isn't enqueued.
+void KeSetTargetProcessorDpc(PKDPC Dpc, int Processor);
+
 // Set the importance of the DPC object.
 // Note! You *must* call this BEFORE enqueuing the DPC, otherwise the
 // behavior is undefined. Even if the DPC is still enqueued, its place
@@ -0,0 +1,78 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/dpcstat.h
+	
+Abstract:
+	This header file contains the definitions for the DPC and
+	interrupt statistics facility.  It is only compiled in if the
+	kernel was built with DPC_STATS=yes.
+	
+	DPCs are grouped by their routine, and interrupts by their
+	vector.  Each group keeps track of the number of runs, and
+	the total and maximum time spent running.  DPC groups also
+	keep track of the time between being queued and running.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <main.h>
+
+#ifdef DPC_STATISTICS
+
+// The maximum number of DPC routines tracked at once.  Must be a power of two.
+#define DPC_CLASS_TABLE_SIZE (256)
+
+// The number of interrupt vectors tracked.
+#define INTERRUPT_CLASS_TABLE_SIZE (256)
+
+typedef struct KDPC_CLASS_tag
+{
+	// The address of the routine.  Zero if the slot is free.
+	uintptr_t Routine;
+	
+	// The type of routine (DPC_STAT_TYPE_*, see kes.h).
+	int Type;
+	
+	uint64_t Count;
+	
+	// All times are measured in HalGetTickCount() ticks.
+	uint64_t TotalTime;
+	uint64_t MaxTime;
+	uint64_t TotalLatency;
+	uint64_t MaxLatency;
+	
+	// The number of runs which went over the watchdog's budget.
+	uint64_t OverBudgetCount;
+}
+KDPC_CLASS, *PKDPC_CLASS;
+
+// Gets the current time for DPC statistics purposes.  Returns zero if the
+// HAL isn't loaded yet.
+uint64_t KeDpcStatGetTime();
+
+// Records a run of a DPC routine which started at StartTime.  EnqueuedAt is
+// the time at which the DPC was enqueued.
+//
+// If the DPC isn't threaded, and it ran for longer than the watchdog's budget,
+// this is logged, or the system is crashed, depending on the watchdog's settings.
+void KeDpcStatRecordDpc(uintptr_t Routine, bool Threaded, uint64_t EnqueuedAt, uint64_t StartTime);
+
+// Records a run of the service routines of an interrupt vector which started at StartTime.
+void KeDpcStatRecordInterrupt(int Vector, uintptr_t Routine, uint64_t StartTime);
+
+// Sets the longest time, in microseconds, that a DPC may run for.  Zero disables the
+// watchdog.  If Crash is true, a DPC going over the budget crashes the system.
+void KeSetDpcWatchdog(uint64_t BudgetMicroseconds, bool Crash);
+
+// Gets the DPC class table.  Slots whose Routine is zero are unused.
+PKDPC_CLASS KeDpcStatGetClassTable(size_t* Count);
+
+// Gets the interrupt class table, indexed by vector.  Slots whose Count is zero are unused.
+PKDPC_CLASS KeDpcStatGetInterruptTable(size_t* Count);
+
+#endif
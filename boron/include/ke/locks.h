@@ -16,6 +16,7 @@ Author:
 #define BORON_KE_LOCKS_H
 
 #include <ke/ipl.h>
+#include <ke/lockstat.h>
 #include <arch.h>
 
 #define SPINLOCK_TRACK_PC
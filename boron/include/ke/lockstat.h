@@ -0,0 +1,85 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/lockstat.h
+	
+Abstract:
+	This header file contains the definitions for the lock
+	statistics facility.  It is only compiled in if the kernel
+	was built with LOCK_STATS=yes.
+	
+	Locks are grouped into lock classes by the call site that
+	acquired them.  Each lock class keeps track of the number of
+	acquisitions, how many of them were contended, and the total
+	and maximum time spent waiting for and holding the lock.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <main.h>
+
+#ifdef LOCK_STATISTICS
+
+// The maximum number of lock classes tracked at once.  Must be a power of two.
+#define LOCK_CLASS_TABLE_SIZE (1024)
+
+// The maximum number of spin locks tracked as held by a single processor.
+#define LOCK_STAT_MAX_HELD (16)
+
+typedef struct KLOCK_CLASS_tag
+{
+	// The address of the code that acquired the lock.  Zero if the slot is free.
+	uintptr_t CallSite;
+	
+	// The type of lock (LOCK_TYPE_*, see kes.h).
+	int Type;
+	
+	uint64_t Acquisitions;
+	uint64_t ContendedAcquisitions;
+	
+	// All times are measured in HalGetTickCount() ticks.
+	uint64_t TotalWaitTime;
+	uint64_t MaxWaitTime;
+	uint64_t TotalHoldTime;
+	uint64_t MaxHoldTime;
+}
+KLOCK_CLASS, *PKLOCK_CLASS;
+
+// Describes a spin lock currently held by a processor.  Spin locks don't have
+// room for the acquisition timestamp, so it's tracked in the PRCB instead.
+typedef struct KLOCK_STAT_HELD_tag
+{
+	void* Lock;
+	PKLOCK_CLASS Class;
+	uint64_t AcquiredAt;
+}
+KLOCK_STAT_HELD, *PKLOCK_STAT_HELD;
+
+// Gets the current time for lock statistics purposes.  Returns zero if the
+// HAL isn't loaded yet.
+uint64_t KeLockStatGetTime();
+
+// Finds or creates the lock class associated with a call site.  Returns NULL
+// if the lock class table is full.
+PKLOCK_CLASS KeLockStatGetClass(uintptr_t CallSite, int Type);
+
+// Records an acquisition of a lock of this class.  WaitStart is the time at
+// which the acquirer started waiting, or zero if the acquisition was uncontended.
+// Returns the time of acquisition, to be passed to KeLockStatRecordRelease.
+uint64_t KeLockStatRecordAcquire(PKLOCK_CLASS Class, uint64_t WaitStart);
+
+// Records the release of a lock of this class.
+void KeLockStatRecordRelease(PKLOCK_CLASS Class, uint64_t AcquiredAt);
+
+// Records the acquisition and release of a spin lock on the current processor.
+void KeLockStatAcquiredSpinLock(void* Lock, uintptr_t CallSite, uint64_t WaitStart);
+void KeLockStatReleasedSpinLock(void* Lock);
+
+// Gets the lock class table.  Slots whose CallSite is zero are unused.
+PKLOCK_CLASS KeLockStatGetClassTable(size_t* Count);
+
+#endif
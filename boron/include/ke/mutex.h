@@ -29,6 +29,12 @@ typedef struct KMUTEX_tag
 	PKTHREAD OwnerThread;
 	
 	LIST_ENTRY MutexListEntry;
+	
+#ifdef LOCK_STATISTICS
+	// Lock class of the current owner's acquisition, and when it happened.
+	PKLOCK_CLASS StatClass;
+	uint64_t AcquiredAt;
+#endif
 }
 KMUTEX, *PKMUTEX;
 
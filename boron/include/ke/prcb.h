@@ -22,6 +22,7 @@ Author:
 #include <ke/dpc.h>
 #include <ke/sched.h>
 #include <ke/lpb.h>
+#include <ke/stats.h>
 
 NO_RETURN void KeStopCurrentCPU(void); // stops the current CPU
 
@@ -58,6 +59,12 @@ typedef struct KPRCB_tag
 	// are we the bootstrap processor?
 	bool IsBootstrap;
 	
+	// Topology information.  Processors with the same PackageId are on the
+	// same package, and processors with the same CacheId also share their
+	// last level cache.  Used by the scheduler to pick who to steal work from.
+	uint32_t PackageId;
+	uint32_t CacheId;
+	
 	// the SMP info we're given
 	PLOADER_AP LoaderAp;
 	
@@ -70,9 +77,19 @@ typedef struct KPRCB_tag
 	// DPC queue
 	KDPC_QUEUE DpcQueue;
 	
+	// Threaded DPC queue.  The wake DPC, queued along with each threaded DPC,
+	// sets the event that the threaded DPC thread waits on.
+	KDPC_QUEUE ThreadedDpcQueue;
+	KDPC ThreadedDpcWakeDpc;
+	KEVENT ThreadedDpcEvent;
+	PKTHREAD ThreadedDpcThread;
+	
 	// Whether a yield is pending for the current thread.
 	bool YieldCurrentThread;
 	
+	// Set by other processors before sending a DPC IPI, to make this processor reschedule.
+	bool RescheduleRequested;
+	
 	// Software interrupt pending flags.
 	#define PENDING(Ipl) (1 << (Ipl - 1))
 	int PendingSoftInterrupts;
@@ -82,6 +99,15 @@ typedef struct KPRCB_tag
 	
 	// HAL Control Block - HAL specific data.
 	PKHALCB HalData;
+	
+	// Statistics for this processor.
+	KSTATISTICS Statistics;
+	
+#ifdef LOCK_STATISTICS
+	// Spin locks currently held by this processor, used to measure hold times.
+	KLOCK_STAT_HELD HeldSpinLocks[LOCK_STAT_MAX_HELD];
+	int HeldSpinLockCount;
+#endif
 }
 KPRCB, *PKPRCB;
 
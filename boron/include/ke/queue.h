@@ -0,0 +1,68 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/queue.h
+	
+Abstract:
+	This header file contains the definitions for the
+	queue dispatch object.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <ke/dispatch.h>
+
+struct KQUEUE_tag
+{
+	// The signaled state is the number of entries which were not
+	// yet claimed by a thread.
+	KDISPATCH_HEADER Header;
+	
+	LIST_ENTRY EntryListHead;
+	
+	// The list of threads associated with this queue.
+	LIST_ENTRY ThreadListHead;
+	
+	// The number of associated threads which are currently running,
+	// that is, not blocked in a wait.
+	int CurrentCount;
+	
+	// The number of associated threads allowed to run at once.  Entries
+	// are not handed out while CurrentCount is at this limit.
+	int MaximumCount;
+};
+
+#define ASSERT_QUEUE(Queue) ASSERT((Queue)->Header.Type == DISPATCH_QUEUE)
+
+// Initializes a queue.  If MaximumCount is zero, the processor count is used.
+void KeInitializeQueue(PKQUEUE Queue, int MaximumCount);
+
+// Returns the number of entries in the queue which were not yet claimed.
+int KeReadStateQueue(PKQUEUE Queue);
+
+// Inserts an entry at the tail of the queue, waking up a waiting thread if
+// the queue's concurrency limit allows it.
+void KeInsertQueue(PKQUEUE Queue, PLIST_ENTRY Entry);
+
+// Removes up to MaximumCount entries from the queue, waiting for at least one if
+// the queue is empty.  The current thread becomes associated with the queue.
+//
+// While a thread associated with a queue is blocked in any other wait, it does not
+// count toward the queue's concurrency limit, so another thread may take its place.
+BSTATUS KeRemoveQueue(
+	PKQUEUE Queue,
+	bool Alertable,
+	int TimeoutMS,
+	KPROCESSOR_MODE WaitMode,
+	PLIST_ENTRY* Entries,
+	int MaximumCount,
+	int* OutCount
+);
+
+// Disassociates all threads from the queue, and moves the entries which are still
+// queued to the list specified.  This must be called before the queue is freed.
+void KeRundownQueue(PKQUEUE Queue, PLIST_ENTRY OutEntryList);
@@ -67,14 +67,30 @@ typedef struct _KSCHEDULER
 	
 	int ThreadsOnQueueCount;
 	
+	// The processor that work was last stolen from.
+	int StealCursor;
+	
+	// The tick at which this processor will next try to balance its load.
+	uint64_t NextLoadBalance;
+	
 #if IS_32_BIT
 	__attribute__((aligned(8)))
 #endif
 	uint64_t TicksSpentNonIdle;
 	
 	// in ticks, copy of CurrentThread->QuantumUntil unless
-	// CurrentThread is null, in which case it's zero
+	// CurrentThread is null, in which case it's zero.  Also zero
+	// if the current thread runs without a quantum because nothing
+	// competes with it for this processor.
 	uint64_t QuantumUntil;
+	
+	// The expiry tick of the first timer in TimerTree, or zero if
+	// there are no timers.  Read by KeTimerTick without the dispatcher
+	// lock, so it's kept outside of the tree.
+#if IS_32_BIT
+	__attribute__((aligned(8)))
+#endif
+	uint64_t NextTimerExpiry;
 }
 KSCHEDULER, *PKSCHEDULER;
 
@@ -15,20 +15,87 @@ Author:
 #ifndef BORON_KE_STATS_H
 #define BORON_KE_STATS_H
 
-// Note. This object is global, that means there's one single
-// instance of this object at a time and you should use atomic
-// writes to write to the statistics object.
+#include <main.h>
+
+typedef struct KTHREAD_tag KTHREAD, *PKTHREAD;
+typedef struct KPROCESS_tag KPROCESS, *PKPROCESS;
+
+// Note. There is one instance of this object per processor, in its
+// PRCB.  It is only ever written to by the processor that owns it,
+// but because interrupts can show up at any time, you should still
+// use atomic writes to write to the statistics object.
 typedef struct KSTATISTICS_tag
 {
-	int ContextSwitches;
+	uint64_t ContextSwitches;
+	
+	// The number of threads this processor took from another
+	// processor's execution queue.
+	uint64_t WorkSteals;
+	
+	uint64_t IpisReceived;
+	
+	uint64_t DpcsRun;
+	
+	// The number of hardware interrupts (including IPIs) serviced.
+	uint64_t Interrupts;
 }
 KSTATISTICS, *PKSTATISTICS;
 
+// Per-thread scheduler statistics.  These are modified with the
+// dispatcher lock held.  All times are measured in HalGetTickCount()
+// ticks.
+typedef struct KTHREAD_STATISTICS_tag
+{
+	// Time spent running on a processor.
+	uint64_t RunTime;
+	
+	// Time spent in the waiting state.
+	uint64_t WaitTime;
+	
+	// Time spent on an execution queue before being scheduled in.
+	uint64_t ReadyTime;
+	uint64_t MaxReadyLatency;
+	
+	// Voluntary switches happen when the thread stops being runnable,
+	// such as when it starts waiting.  Involuntary switches happen when
+	// the thread was still runnable, but was preempted or has yielded.
+	uint64_t VoluntarySwitches;
+	uint64_t InvoluntarySwitches;
+	
+	// The number of times the thread was scheduled in on a different
+	// processor than the one it last ran on.
+	uint64_t Migrations;
+}
+KTHREAD_STATISTICS, *PKTHREAD_STATISTICS;
+
+// Called for each thread by the thread enumeration functions, with the
+// dispatcher lock held.  Statistics is a snapshot of the thread's statistics,
+// including the time spent in its current state.  Return false to stop the
+// enumeration.
+typedef bool(*PKENUMERATE_THREAD_ROUTINE)(PKTHREAD Thread, PKTHREAD_STATISTICS Statistics, void* Context);
+
 // Modify
 void KeStatsAddContextSwitch();
 
+void KeStatsAddWorkSteal();
+
+void KeStatsAddIpi();
+
+void KeStatsAddDpc();
+
+void KeStatsAddInterrupt();
 
 // Read
 int KeStatsGetContextSwitchCount();
 
-#endif//BORON_KE_STATS_H
\ No newline at end of file
+// Copies the statistics of a processor.  TicksSpentNonIdle receives the number
+// of ticks the processor spent running threads other than its idle thread.
+void KeStatsGetProcessorStatistics(int Processor, PKSTATISTICS Statistics, uint64_t* TicksSpentNonIdle);
+
+// Enumerates all threads in the system.
+void KeEnumerateThreads(PKENUMERATE_THREAD_ROUTINE Routine, void* Context);
+
+// Enumerates the threads of a process.
+void KeEnumerateThreadsProcess(PKPROCESS Process, PKENUMERATE_THREAD_ROUTINE Routine, void* Context);
+
+#endif//BORON_KE_STATS_H
@@ -0,0 +1,46 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/stattbl.h
+	
+Abstract:
+	This header file contains the definitions for the statistics
+	tables shared by the lock, DPC and pool tag statistics.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <main.h>
+
+// Finds the entry whose key is Key in a statistics table, or claims a free one
+// for it if there is none.
+//
+// Parameters:
+//     Table - The table, an array of EntryCount entries of EntrySize bytes each.
+//             EntryCount must be a power of two.
+//
+//     KeyOffset - The offset of the entry's key, a uintptr_t, within the entry.
+//                 A key of zero marks the entry as free.
+//
+//     Key - The key to look up.  May not be zero.
+//
+//     OutClaimed - Set to whether the entry was claimed by this call, in which case
+//                  the caller may initialize the entry's other non-counter fields.
+//
+// Return value:
+//     The entry, or NULL if the table is full.
+void* KeStatTableLookUp(
+	void* Table,
+	size_t EntryCount,
+	size_t EntrySize,
+	size_t KeyOffset,
+	uintptr_t Key,
+	bool* OutClaimed
+);
+
+// Atomically raises the value of Maximum to Value, if it is lower.
+void KeStatUpdateMaximum(uint64_t* Maximum, uint64_t Value);
@@ -18,6 +18,7 @@ Author:
 #include <rtl/list.h>
 #include <arch.h>
 #include <ke/dispatch.h>
+#include <ke/stats.h>
 
 #define MAXIMUM_WAIT_BLOCKS (64)
 #define THREAD_WAIT_BLOCKS (4)
@@ -108,6 +109,11 @@ struct KTHREAD_tag
 	// List of owned mutexes.
 	LIST_ENTRY MutexList;
 	
+	// The queue this thread is associated with, if any, and its entry into
+	// that queue's list of threads.  See KeRemoveQueue.
+	PKQUEUE Queue;
+	LIST_ENTRY QueueListEntry;
+	
 	PKPROCESS AttachedProcess;
 	
 	bool Suspended;
@@ -141,6 +147,20 @@ struct KTHREAD_tag
 	// The tick when this thread was scheduled.
 	uint64_t TickScheduledAt;
 	
+	// The tick when this thread was placed on an execution queue, or
+	// zero if it isn't on one.
+	uint64_t EnqueuedTime;
+	
+	// The tick when this thread started waiting, or zero if it isn't.
+	uint64_t WaitStartedAt;
+	
+	// The processor this thread last ran on, or -1 if it never ran.
+	// Unlike LastProcessor, this is not updated when it's enqueued.
+	int LastRunProcessor;
+	
+	// Scheduler statistics for this thread.
+	KTHREAD_STATISTICS Statistics;
+	
 	// Priority increment after thread is terminated.
 	KPRIORITY IncrementTerminated;
 	
@@ -159,8 +179,6 @@ struct KTHREAD_tag
 	// This is used when initiating a wait at high IPL
 	// to ensure the thread doesn't hold any locks.
 	int HoldingSpinlocks;
-	
-	uint64_t EnqueuedTime;
 #endif
 	
 	// When calling KeReleaseMutexWait, KeReleaseSemaphoreWait,
@@ -174,6 +192,14 @@ struct KTHREAD_tag
 	// User-space pointer to the TEB (thread environment block).
 	void* TebPointer;
 	
+#ifdef LOCK_STATISTICS
+	// The call site of the current wait, and the time at which the thread
+	// started blocking (zero if it didn't block).  Used to account for
+	// mutex acquisitions.
+	uintptr_t WaitCallSite;
+	uint64_t WaitStartTime;
+#endif
+	
 #ifdef TARGET_ARM
 	// ARM implements instruction page faults and data page faults in
 	// separate ways, so tell them apart using this flag.
@@ -39,6 +39,7 @@ Author:
 #include <mm/services.h>
 #include <mm/forksup.h>
 #include <mm/mpw.h>
+#include <mm/ws.h>
 
 #ifdef KERNEL
 
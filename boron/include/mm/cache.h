@@ -33,6 +33,10 @@ typedef struct _CCB
 	// operation.
 	KMUTEX Mutex;
 	MMSLA Sla;
+	
+	// Incremented after every write to the file, so that the image section
+	// cache can tell which of its sections are stale.  See mm/imgcache.c.
+	int ImageWriteSequence;
 }
 CCB, *PCCB;
 
@@ -66,6 +66,12 @@ MDL_ONEPAGE, *PMDL_ONEPAGE;
 // Do not use MDL_FLAG_FROMPOOL or MDL_FLAG_MAPPED.
 PMDL_ONEPAGE MmInitializeSinglePageMdl(PMDL_ONEPAGE Mdl, MMPFN Pfn, int Flags);
 
+// Initializes an MDL structure with a list of physical pages, which don't need
+// to be contiguous.  The structure must have room for PageCount pages.
+//
+// Do not use MDL_FLAG_FROMPOOL or MDL_FLAG_MAPPED.
+PMDL MmInitializePageListMdl(PMDL Mdl, const MMPFN* Pfns, size_t PageCount, int Flags);
+
 // Allocates an MDL structure.
 PMDL MmAllocateMdl(uintptr_t VirtualAddress, size_t Length);
 
@@ -102,3 +108,6 @@ void MmCopyIntoMdl(PMDL Mdl, uintptr_t Offset, const void* SourceBuffer, size_t
 
 // Copies from an MDL into a destination buffer in a "gather" operation.
 void MmCopyFromMdl(PMDL Mdl, uintptr_t Offset, void* DestinationBuffer, size_t Size);
+
+// Copies from one MDL into another without mapping either of them.
+void MmCopyMdlToMdl(PMDL DestinationMdl, uintptr_t DestinationOffset, PMDL SourceMdl, uintptr_t SourceOffset, size_t Size);
@@ -50,7 +50,11 @@ typedef struct
 		// If this flag is set, then this page is part of a file's page cache.
 		unsigned IsFileCache : 1;
 		
-		unsigned Spare : 9;
+		// The number of working set scans in a row that found this page not accessed.
+		// This is used by the working set manager to pick pages to trim.
+		unsigned Age : 3;
+		
+		unsigned Spare : 6;
 		
 		// The upper part of the offset within the page cache of a file, if needed.
 		unsigned _OffsetUpper : 16;
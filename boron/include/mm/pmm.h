@@ -87,6 +87,11 @@ void MmSetModifiedPage(MMPFN Pfn);
 // Assign a prototype PTE address to the page frame.
 void MmSetPrototypePtePfn(MMPFN Pfn, MM_PROTOTYPE_PTE_PTR PrototypePte);
 
+// Detaches a page frame from the page cache entry that refers to it.  This is
+// used when the page cache is torn down.  If the page is on the standby or the
+// modified page list, then it's freed right away.
+void MmDetachCachedPfn(MMPFN Pfn);
+
 // Assign an FCB pointer and offset, to the page frame.
 //
 // Note that the reference to the FCB is weak, i.e. it does not count towards
@@ -118,6 +123,66 @@ size_t MmGetTotalFreePages();
 // Gets the total amount of pages of physical memory, both free and used, on the system.
 size_t MmGetTotalAvailablePages();
 
+typedef struct
+{
+	// The size of a huge page, or zero if huge pages aren't used.
+	size_t PageSize;
+	
+	// The number of huge pages currently mapped.
+	size_t InUse;
+	
+	// The number of huge pages that were mapped so far.
+	uint64_t Allocations;
+	
+	// The number of times a huge page could have been used, but regular
+	// pages were used instead because no contiguous memory was found.
+	uint64_t Fallbacks;
+	
+	// The number of huge pages that were split into regular pages.
+	uint64_t Splits;
+}
+MM_HUGE_PAGE_STATISTICS, *PMM_HUGE_PAGE_STATISTICS;
+
+// Gets the huge page usage statistics.
+void MmGetHugePageStatistics(PMM_HUGE_PAGE_STATISTICS Statistics);
+
+typedef struct
+{
+	// The number of pages held in the compressed page store.
+	size_t StoredPages;
+	
+	// The size of their compressed data, in bytes.
+	size_t StoredBytes;
+	
+	// The number of pages that were compressed into the store so far, and the number
+	// of times a page was brought back from it.
+	uint64_t Compressions;
+	uint64_t Decompressions;
+	
+	// The number of pages that didn't compress well enough to be stored.
+	uint64_t Rejections;
+}
+MM_COMPRESSED_STORE_STATISTICS, *PMM_COMPRESSED_STORE_STATISTICS;
+
+// Gets the compressed page store usage statistics.
+void MmGetCompressedStoreStatistics(PMM_COMPRESSED_STORE_STATISTICS Statistics);
+
+typedef struct
+{
+	// The size of the page file, and the number of its pages in use, in pages.
+	// Both are zero if there is no page file.
+	size_t TotalPages;
+	size_t UsedPages;
+	
+	// The number of pages written to and read back from the page file so far.
+	uint64_t PagesWritten;
+	uint64_t PagesRead;
+}
+MM_PAGE_FILE_STATISTICS, *PMM_PAGE_FILE_STATISTICS;
+
+// Gets the page file usage statistics.
+void MmGetPageFileStatistics(PMM_PAGE_FILE_STATISTICS Statistics);
+
 // Registers a range of memory as MMIO.  This means that user applications
 // will be able to map this memory in directly, however, the pages will
 // never behave like regular memory.
@@ -126,6 +191,10 @@ void MmRegisterMMIOAsMemory(uintptr_t Base, uintptr_t Size);
 // TODO: Not sure where to place this.  Do we really need a new file?
 void MmInitializeModifiedPageWriter(void);
 
+// Opens the page file named by the boot configuration, if any, and starts
+// the page file writer.
+void MmInitializePageFile(void);
+
 // Allocates a contiguous memory region with an address alignment.  Note that
 // this is slow and so it should be called cautiously.  Thanks for your stupid
 // unconventional page table layout, ARM!  Someday I may opt to implement a
@@ -60,8 +60,16 @@ void* MmMapIoSpace(uintptr_t PhysicalAddress, size_t SizeBytes, uintptr_t Permis
 // * The POOL_FLAG_CALLER_CONTROLLED flag is not supported and will return NULL.
 void* MmAllocatePool(int PoolFlags, size_t Size);
 
+// Allocate pool memory, and count it under a tag in the pool tag statistics.  The memory
+// is freed with MmFreePool.  The tag is stored in front of the allocation, so this uses a
+// size class 8 bytes larger than MmAllocatePool would.
+void* MmAllocatePoolWithTag(int PoolFlags, size_t Size, int Tag);
+
 void MmFreePool(void* Pointer);
 
+// Fills in an array of SYSTEM_POOL_TAG_INFORMATION, one per pool tag in use.
+BSTATUS MmQueryPoolTagInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+
 // Shorthand function to allocate a thread's kernel stack using default parameters.
 void* MmAllocateKernelStack();
 
@@ -82,6 +82,12 @@ PMMPTE MmGetPteLocation(uintptr_t Address);
 // Same as MmGetPteLocation, except returns NULL if MmCheckPteLocation returns false.
 PMMPTE MmGetPteLocationCheck(uintptr_t Address, bool GenerateMissingLevels);
 
+// Same as MmCheckPteLocation with GenerateMissingLevels set to false, except that, if the
+// PTE location is inaccessible, the first address past the highest page mapping level that
+// is missing is written to SkipToAddress.  Walks over sparse ranges use this to skip absent
+// page table subtrees in one step, instead of checking every page in them.
+bool MiCheckPteLocationOrSkip(uintptr_t Address, uintptr_t* SkipToAddress);
+
 // Attempts to map a physical page into the specified address space.
 bool MiMapAnonPage(uintptr_t Address, uintptr_t Permissions, bool NonPaged);
 
@@ -163,5 +163,16 @@ MM_PTE_API bool MmIsEqualPte(MMPTE Pte1, MMPTE Pte2);
 // Checks if the PTE has unsupported parameters.
 MM_PTE_API bool MmIsUnsupportedHigherLevelPte(MMPTE Pte);
 
+#ifdef MM_HUGE_PAGE_SIZE
+
+// Builds a present higher level PTE which maps a huge page.  The PFN must be
+// aligned to the size of a huge page.
+MM_PTE_API MMPTE MmBuildHugePte(MMPFN Pfn, uintptr_t PageBits);
+
+// Checks if the higher level PTE is present and maps a huge page.
+MM_PTE_API bool MmIsHugePte(MMPTE Pte);
+
+#endif
+
 // Flushes PTE modifications.
 MM_PTE_API void MmFlushTlbUpdates();
@@ -15,12 +15,22 @@ Author:
 
 #include <obs.h>
 
+typedef struct _FILE_OBJECT FILE_OBJECT, *PFILE_OBJECT;
+typedef struct _FCB FCB, *PFCB;
+
 typedef struct
 {
 	MAPPABLE_HEADER Mappable;
 	KMUTEX Mutex;
 	MMSLA Sla;
 	uint64_t MaxSizePages;
+	
+	// The file whose base-relocated image this section holds, if it was
+	// built by the image section cache.  Lets OSGetMappedFileHandle find
+	// the file behind a view of the section.  Such sections are shared by
+	// every process which loads the image, so they may only be written to
+	// through copy-on-write views.
+	PFILE_OBJECT ImageFile;
 }
 MMSECTION, *PMMSECTION;
 
@@ -34,3 +44,22 @@ BSTATUS OSCreateSectionObject(
 	POBJECT_ATTRIBUTES ObjectAttributes,
 	uint64_t MaxSize
 );
+
+BSTATUS OSLookUpImageSection(
+	PHANDLE OutSectionHandle,
+	HANDLE FileHandle,
+	uintptr_t ImageBase,
+	size_t ImageSize
+);
+
+// Gets a referenced pointer to the cached section holding the base-relocated
+// contents of an image, building it from the image file if it isn't cached at
+// this base yet.
+BSTATUS MmReferenceImageSection(
+	PMMSECTION* OutSection,
+	PFILE_OBJECT FileObject,
+	uintptr_t ImageBase,
+	size_t ImageSize
+);
+
+void MmInvalidateImageSections(PFCB Fcb);
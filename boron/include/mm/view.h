@@ -25,6 +25,15 @@ BSTATUS MmMapViewOfObject(
 	int Protection
 );
 
+BSTATUS MmMapViewOfObjectPointer(
+	void* MappableObject,
+	void** BaseAddressOut,
+	size_t ViewSize,
+	int AllocationType,
+	uint64_t SectionOffset,
+	int Protection
+);
+
 BSTATUS MmMapViewOfFileInSystemSpace(
 	PFILE_OBJECT FileObject,
 	void** BaseAddressOut,
@@ -0,0 +1,44 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/ws.h
+	
+Abstract:
+	This header defines the per-process working set information,
+	and the interface with the working set manager.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <main.h>
+
+// The working set information of a process.  These fields are guarded by the
+// address space lock of the process.
+typedef struct
+{
+	// The number of pages mapped in the process, as of the last scan
+	// done by the working set manager.
+	size_t ResidentPages;
+	
+	// The highest number of pages that a scan ever found mapped.
+	size_t PeakResidentPages;
+	
+	// The number of pages that were accessed between the last two scans.
+	size_t AccessedPages;
+	
+	// The total number of pages trimmed from the process.
+	uint64_t TrimmedPages;
+	
+	// The total number of page faults taken on the address space.
+	uint64_t PageFaultCount;
+}
+MMWORKING_SET, *PMMWORKING_SET;
+
+// Starts the working set manager.  It periodically ages the pages of each
+// process, and trims the ones that weren't used in a while if free memory
+// runs low.
+void MmInitializeWorkingSetManager(void);
@@ -294,6 +294,11 @@ BSTATUS ObCreateSymbolicLinkObject(
 // Adds 1 to the internal reference count of the object.
 void* ObReferenceObjectByPointer(void* Object);
 
+// Adds 1 to the internal reference count of the object, unless the object has
+// already dropped its final reference and is being deleted.  Returns whether
+// a reference was added.
+bool ObReferenceObjectSafe(void* Object);
+
 // Takes a reference away from the internal ref count of the object.
 // If the reference count hits zero, the object will be deleted.
 void ObDereferenceObject(void* Object);
@@ -15,6 +15,7 @@ Author:
 #pragma once
 
 #include <ex/process.h>
+#include <pss.h>
 
 typedef struct _OBJECT_ATTRIBUTES *POBJECT_ATTRIBUTES;
 
@@ -42,11 +43,24 @@ BSTATUS OSCreateProcess(
 	bool DeepCloneHandles
 );
 
+BSTATUS OSSpawnProcess(
+	PHANDLE OutProcessHandle,
+	PHANDLE OutThreadHandle,
+	POBJECT_ATTRIBUTES ObjectAttributes,
+	PSPAWN_PARAMETERS Parameters
+);
+
 // POSIX fork support.
 BSTATUS OSForkProcess(PHANDLE OutChildHandle, void* ChildReturnPC, void* ChildReturnSP);
 
 BSTATUS OSSetImageNameProcess(HANDLE ProcessHandle, const char* ImageName, size_t ImageNameLength);
 
+typedef void(*PPS_ENUMERATE_PROCESS_ROUTINE)(PEPROCESS Process, void* Context);
+
+// Calls Routine for each process in the process list.  The process list
+// is locked during the enumeration, so processes can't be removed from it.
+void PsEnumerateProcesses(PPS_ENUMERATE_PROCESS_ROUTINE Routine, void* Context);
+
 #ifdef KERNEL
 extern EPROCESS PsSystemProcess;
 #else
@@ -9,6 +9,13 @@ import sys
 def SymKey(s):
     return s[0]  # Return the address member
 
+# Must match RtlGnuHash, which DbgLookUpAddress uses to probe the hash table.
+def GnuHash(Name):
+    Hash = 5381
+    for Char in Name.encode():
+        Hash = (Hash * 33 + Char) & 0xFFFFFFFF
+    return Hash
+
 if len(sys.argv) < 1:
     print('bad usage')
     exit()
@@ -24,6 +31,8 @@ print('; ********** The Boron Operating System **********/')
 print('section .rodata')
 print('global KiSymbolTable')
 print('global KiSymbolTableEnd')
+print('global KiSymbolHashTable')
+print('global KiSymbolHashTableEnd')
 print('KiSymbolTable:')
 
 Names = "section .rodata\n"
@@ -86,4 +95,24 @@ for Symbol in SymbolList:
     Count += 1
 
 print('KiSymbolTableEnd:')
+
+# Build the name lookup hash table.  It is open addressed with linear probing, and
+# at most half full.  Symbols are inserted in address order, so that a lookup finds
+# the same symbol that a linear scan of the table would.
+HashTableSize = 1
+while HashTableSize < len(SymbolList) * 2:
+    HashTableSize *= 2
+
+HashTable = [0] * HashTableSize
+for Index, Symbol in enumerate(SymbolList):
+    Slot = GnuHash(Symbol[2]) & (HashTableSize - 1)
+    while HashTable[Slot] != 0:
+        Slot = (Slot + 1) & (HashTableSize - 1)
+    HashTable[Slot] = Index + 1
+
+print('KiSymbolHashTable:')
+for Entry in HashTable:
+    print(f'dd {Entry}')
+print('KiSymbolHashTableEnd:')
+
 print(Names)
@@ -0,0 +1,197 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ex/boottrc.c
+	
+Abstract:
+	This module implements the boot trace, which records how long
+	each phase of system initialization took, and the boot task
+	runner, which allows independent initialization work to run
+	on all processors at once.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "exp.h"
+#include <ps.h>
+#include <hal.h>
+
+typedef struct
+{
+	char Name[BOOT_PHASE_NAME_SIZE];
+	int ProcessorId;
+	uint64_t StartTime;
+	uint64_t EndTime;
+}
+EXP_BOOT_PHASE, *PEXP_BOOT_PHASE;
+
+typedef struct
+{
+	PEX_BOOT_TASK Routine;
+	void* Context;
+	const char* Name;
+	PETHREAD Thread;
+}
+EXP_BOOT_TASK, *PEXP_BOOT_TASK;
+
+static EXP_BOOT_PHASE ExpBootPhases[BOOT_TRACE_MAX_PHASES];
+static int ExpBootPhaseCount;
+static KSPIN_LOCK ExpBootTraceLock;
+
+int ExBeginBootPhase(const char* Name)
+{
+	KIPL Ipl;
+	KeAcquireSpinLock(&ExpBootTraceLock, &Ipl);
+	
+	int Phase = -1;
+	if (ExpBootPhaseCount < BOOT_TRACE_MAX_PHASES)
+	{
+		Phase = ExpBootPhaseCount++;
+		
+		PEXP_BOOT_PHASE Entry = &ExpBootPhases[Phase];
+		StringCopySafe(Entry->Name, Name, sizeof Entry->Name);
+		Entry->ProcessorId = KeGetCurrentPRCB()->Id;
+		Entry->StartTime = HalGetTickCount();
+	}
+	
+	KeReleaseSpinLock(&ExpBootTraceLock, Ipl);
+	return Phase;
+}
+
+void ExEndBootPhase(int Phase)
+{
+	if (Phase < 0)
+		return;
+	
+	// Only the starter of the phase writes its end time, so there is no need to lock.
+	ExpBootPhases[Phase].EndTime = HalGetTickCount();
+}
+
+static void ExpRunBootTask(PEXP_BOOT_TASK Task)
+{
+	int Phase = ExBeginBootPhase(Task->Name);
+	Task->Routine(Task->Context);
+	ExEndBootPhase(Phase);
+}
+
+static NO_RETURN void ExpBootTaskWorker(void* Context)
+{
+	ExpRunBootTask(Context);
+	PsTerminateThread();
+}
+
+INIT
+void ExRunBootTasks(PEX_BOOT_TASK Routine, void** Contexts, const char** Names, int Count)
+{
+	if (Count <= 0)
+		return;
+	
+	PEXP_BOOT_TASK Tasks = MmAllocatePool(POOL_NONPAGED, sizeof(EXP_BOOT_TASK) * Count);
+	if (!Tasks)
+		KeCrash("ExRunBootTasks: Could not allocate %d boot tasks", Count);
+	
+	for (int i = 0; i < Count; i++)
+	{
+		Tasks[i].Routine = Routine;
+		Tasks[i].Context = Contexts[i];
+		Tasks[i].Name = Names[i];
+		Tasks[i].Thread = NULL;
+	}
+	
+	bool Parallel = Count > 1 && KeGetProcessorCount() > 1 && ExIsConfigValue("ParallelInit", CONFIG_YES);
+	
+	if (!Parallel)
+	{
+		for (int i = 0; i < Count; i++)
+			ExpRunBootTask(&Tasks[i]);
+		
+		MmFreePool(Tasks);
+		return;
+	}
+	
+	// The scheduler balances the new threads across the processors by itself.
+	for (int i = 0; i < Count; i++)
+	{
+		BSTATUS Status = PsCreateSystemThreadFast(&Tasks[i].Thread, ExpBootTaskWorker, &Tasks[i], false);
+		if (FAILED(Status))
+		{
+			// Run it here instead.
+			DbgPrint("ExRunBootTasks: Could not create thread for %s: %d (%s)", Names[i], Status, RtlGetStatusString(Status));
+			Tasks[i].Thread = NULL;
+			ExpRunBootTask(&Tasks[i]);
+		}
+	}
+	
+	for (int i = 0; i < Count; i++)
+	{
+		if (!Tasks[i].Thread)
+			continue;
+		
+		KeWaitForSingleObject(&Tasks[i].Thread->Tcb, false, TIMEOUT_INFINITE, MODE_KERNEL);
+		ObDereferenceObject(Tasks[i].Thread);
+	}
+	
+	MmFreePool(Tasks);
+}
+
+INIT
+void ExDumpBootTrace()
+{
+#ifdef DEBUG
+	if (ExpBootPhaseCount == 0)
+		return;
+	
+	uint64_t Frequency = HalGetTickFrequency();
+	uint64_t BootStart = ExpBootPhases[0].StartTime;
+	
+	DbgPrint("Boot trace (%d phases, times in microseconds):", ExpBootPhaseCount);
+	
+	for (int i = 0; i < ExpBootPhaseCount; i++)
+	{
+		PEXP_BOOT_PHASE Phase = &ExpBootPhases[i];
+		uint64_t EndTime = Phase->EndTime ? Phase->EndTime : Phase->StartTime;
+		
+		DbgPrint(
+			"  %-32s cpu %2d  start %10llu  took %10llu%s",
+			Phase->Name,
+			Phase->ProcessorId,
+			(Phase->StartTime - BootStart) * 1000000 / Frequency,
+			(EndTime - Phase->StartTime) * 1000000 / Frequency,
+			Phase->EndTime ? "" : " (unfinished)"
+		);
+	}
+#endif
+}
+
+BSTATUS ExpQueryBootTraceInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize)
+{
+	PSYSTEM_BOOT_TRACE_INFORMATION TraceInfo = Buffer;
+	size_t Written = 0;
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&ExpBootTraceLock, &Ipl);
+	
+	for (int i = 0; i < ExpBootPhaseCount; i++)
+	{
+		if (Written + sizeof(*TraceInfo) > BufferSize)
+			break;
+		
+		PEXP_BOOT_PHASE Phase = &ExpBootPhases[i];
+		
+		TraceInfo->Size = sizeof(*TraceInfo);
+		TraceInfo->ProcessorId = Phase->ProcessorId;
+		StringCopySafe(TraceInfo->Name, Phase->Name, sizeof TraceInfo->Name);
+		TraceInfo->StartTime = Phase->StartTime;
+		TraceInfo->EndTime = Phase->EndTime;
+		
+		Written += sizeof(*TraceInfo);
+		TraceInfo = NEXT_SYSTEM_INFORMATION(TraceInfo);
+	}
+	
+	KeReleaseSpinLock(&ExpBootTraceLock, Ipl);
+	
+	*WrittenBufferSize = Written;
+	return STATUS_SUCCESS;
+}
@@ -35,4 +35,6 @@ bool ExpCreateProcessType();
 
 void ExInitBootConfig();
 
+BSTATUS ExpQueryBootTraceInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+
 #include <ex/internal.h>
@@ -19,6 +19,28 @@ Author:
 #include <tty.h>
 #include <ipc.h>
 
+#ifdef DPC_STATISTICS
+
+// Arms the DPC watchdog if a budget was specified in the boot configuration.
+// "DpcBudget" is the budget in microseconds, and "DpcBudgetCrash" makes the
+// watchdog crash the system instead of printing a message.
+INIT
+static void ExpInitDpcWatchdog()
+{
+	const char* Value = ExGetConfigValue("DpcBudget", NULL);
+	if (!Value)
+		return;
+	
+	uint64_t Budget = 0;
+	for (; *Value >= '0' && *Value <= '9'; Value++)
+		Budget = Budget * 10 + (*Value - '0');
+	
+	if (Budget)
+		KeSetDpcWatchdog(Budget, ExIsConfigValue("DpcBudgetCrash", CONFIG_YES));
+}
+
+#endif
+
 INIT
 bool ExInitSystem()
 {
@@ -37,43 +59,42 @@ bool ExInitSystem()
 #endif
 	
 	ExInitBootConfig();
+	
+#ifdef DPC_STATISTICS
+	ExpInitDpcWatchdog();
+#endif
+	
 	return true;
 }
 
+// Runs one phase of executive initialization, and records it in the boot trace.
+INIT
+static void ExpInitializePhase(const char* Name, bool (*Routine)(), const char* FailureMessage)
+{
+	int Phase = ExBeginBootPhase(Name);
+	
+	if (!Routine())
+		KeCrash("%s", FailureMessage);
+	
+	ExEndBootPhase(Phase);
+}
+
 // This routine initializes the executive layer, that is, the part
 // of the kernel that's implemented on top of the kernel core.
 INIT
 NO_RETURN void ExpInitializeExecutive(UNUSED void* Context)
 {
-	if (!ObInitSystem())
-		KeCrash("Could not initialize object manager");
-	
-	if (!ExInitSystem())
-		KeCrash("Could not initialize executive");
-	
-	if (!MmInitSystem())
-		KeCrash("Could not initialize memory manager");
-	
-	if (!PsInitSystem())
-		KeCrash("Could not initialize process manager");
-	
-	if (!IoInitSystem())
-		KeCrash("Could not initialize I/O manager");
-	
-	if (!LdrPrepareInitialRoot())
-		KeCrash("Could not prepare initial root");
-	
-	if (!PsInitSystemPart2())
-		KeCrash("Could not initialize process manager - part 2");
-	
-	if (!TtyInitSystem())
-		KeCrash("Could not initialize pseudoterminal subsystem");
-	
-	if (!IpcInitSystem())
-		KeCrash("Could not initialize IPC subsystem");
-	
-	if (!ObLinkRootDirectory())
-		KeCrash("Could not create a symbolic link to the root directory");
+	ExpInitializePhase("Object manager", ObInitSystem, "Could not initialize object manager");
+	ExpInitializePhase("Executive", ExInitSystem, "Could not initialize executive");
+	ExpInitializePhase("Memory manager", MmInitSystem, "Could not initialize memory manager");
+	ExpInitializePhase("Process manager", PsInitSystem, "Could not initialize process manager");
+	ExpInitializePhase("Work queues", ExInitializeWorkQueues, "Could not initialize executive work queues");
+	ExpInitializePhase("I/O manager", IoInitSystem, "Could not initialize I/O manager");
+	ExpInitializePhase("Initial root", LdrPrepareInitialRoot, "Could not prepare initial root");
+	ExpInitializePhase("Process manager 2", PsInitSystemPart2, "Could not initialize process manager - part 2");
+	ExpInitializePhase("Pseudoterminals", TtyInitSystem, "Could not initialize pseudoterminal subsystem");
+	ExpInitializePhase("IPC", IpcInitSystem, "Could not initialize IPC subsystem");
+	ExpInitializePhase("Root link", ObLinkRootDirectory, "Could not create a symbolic link to the root directory");
 	
 	// TODO: Crash inside of these functions instead of returning false.
 	// It'll be more useful because those functions actually have the
@@ -81,7 +102,10 @@ NO_RETURN void ExpInitializeExecutive(UNUSED void* Context)
 	//
 	// We should do it like this:
 	MmInitializeModifiedPageWriter();
+	MmInitializeWorkingSetManager();
+	MmInitializePageFile();
 	
+	ExDumpBootTrace();
 	KeTerminateThread(0);
 }
 
@@ -49,6 +49,11 @@ void ExInitializeRwLock(PEX_RW_LOCK Lock)
 	Lock->SharedWaiterCount = 0;
 	Lock->ExclusiveWaiterCount = 0;
 	Lock->HeldCount = 0;
+	
+#ifdef LOCK_STATISTICS
+	Lock->ExclusiveStatClass = NULL;
+	Lock->ExclusiveAcquiredAt = 0;
+#endif
 }
 
 void ExDeinitializeRwLock(PEX_RW_LOCK Lock)
@@ -83,6 +88,11 @@ BSTATUS ExAcquireExclusiveRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertabl
 		Lock->ExclusiveOwner.Locked = 1;
 		Lock->ExclusiveOwner.OwnerThread = CurrentThread;
 		
+	#ifdef LOCK_STATISTICS
+		Lock->ExclusiveStatClass = KeLockStatGetClass(CallerAddress(), LOCK_TYPE_RW_LOCK_EXCLUSIVE);
+		Lock->ExclusiveAcquiredAt = KeLockStatRecordAcquire(Lock->ExclusiveStatClass, 0);
+	#endif
+		
 		// Won't initialize the list entry because it's not part of a list.
 		
 		KeReleaseSpinLock(&Lock->GuardLock, Ipl);
@@ -119,6 +129,10 @@ BSTATUS ExAcquireExclusiveRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertabl
 	Lock->ExclusiveWaiterCount++;
 	KeReleaseSpinLock(&Lock->GuardLock, Ipl);
 	
+#ifdef LOCK_STATISTICS
+	uint64_t WaitStart = KeLockStatGetTime();
+#endif
+	
 	DbgPrintA("EXCL(%p): Waiting on lock", CurrentThread);
 	BSTATUS Status = ExWaitOnRwLock(Lock, &Lock->ExclusiveSyncEvent);
 	
@@ -129,6 +143,11 @@ BSTATUS ExAcquireExclusiveRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertabl
 	
 	Lock->ExclusiveOwner.OwnerThread = CurrentThread;
 	
+#ifdef LOCK_STATISTICS
+	Lock->ExclusiveStatClass = KeLockStatGetClass(CallerAddress(), LOCK_TYPE_RW_LOCK_EXCLUSIVE);
+	Lock->ExclusiveAcquiredAt = KeLockStatRecordAcquire(Lock->ExclusiveStatClass, WaitStart);
+#endif
+	
 	if (Alertable)
 	{
 		// TODO: Check if the thread was killed and release if so.
@@ -166,6 +185,10 @@ BSTATUS ExAcquireSharedRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertable,
 			Lock->SharedOwner.OwnerThread = CurrentThread;
 			Lock->HeldCount = 1;
 			
+		#ifdef LOCK_STATISTICS
+			KeLockStatRecordAcquire(KeLockStatGetClass(CallerAddress(), LOCK_TYPE_RW_LOCK_SHARED), 0);
+		#endif
+			
 			KeReleaseSpinLock(&Lock->GuardLock, Ipl);
 			DbgPrintA("SHRD(%p): Acquired via heldcount==0 case", CurrentThread);
 			return STATUS_SUCCESS;
@@ -230,6 +253,10 @@ BSTATUS ExAcquireSharedRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertable,
 				Owner->Locked = 1;
 				Lock->HeldCount++;
 				
+			#ifdef LOCK_STATISTICS
+				KeLockStatRecordAcquire(KeLockStatGetClass(CallerAddress(), LOCK_TYPE_RW_LOCK_SHARED), 0);
+			#endif
+				
 				KeReleaseSpinLock(&Lock->GuardLock, Ipl);
 				DbgPrintA("SHRD(%p): Acquired via exclusivewaitercount==0 case", CurrentThread);
 				return STATUS_SUCCESS;
@@ -257,6 +284,10 @@ BSTATUS ExAcquireSharedRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertable,
 	}
 	
 	// Wait!
+#ifdef LOCK_STATISTICS
+	uint64_t WaitStart = KeLockStatGetTime();
+#endif
+	
 	DbgPrintA("SHRD(%p): Waiting on lock", CurrentThread);
 	BSTATUS Status = ExWaitOnRwLock(Lock, &Lock->SharedSemaphore);
 	
@@ -265,6 +296,10 @@ BSTATUS ExAcquireSharedRwLock(PEX_RW_LOCK Lock, bool DontBlock, bool Alertable,
 		KeCrash("ExAcquireSharedRwLock: ExWaitOnRwLock failed! %d", Status);
 #endif
 	
+#ifdef LOCK_STATISTICS
+	KeLockStatRecordAcquire(KeLockStatGetClass(CallerAddress(), LOCK_TYPE_RW_LOCK_SHARED), WaitStart);
+#endif
+	
 	if (Alertable)
 	{
 		// TODO: Check if the thread was killed and release if so.
@@ -298,6 +333,12 @@ void ExDemoteToSharedRwLock(PEX_RW_LOCK Lock)
 		
 		Lock->ExclusiveOwner.OwnerThread = NULL;
 		
+	#ifdef LOCK_STATISTICS
+		KeLockStatRecordRelease(Lock->ExclusiveStatClass, Lock->ExclusiveAcquiredAt);
+		Lock->ExclusiveStatClass = NULL;
+		Lock->ExclusiveAcquiredAt = 0;
+	#endif
+		
 		Owner->OwnerThread = KeGetCurrentThread();
 		Owner->Locked = Lock->ExclusiveOwner.Locked;
 		
@@ -487,6 +528,15 @@ void ExReleaseRwLock(PEX_RW_LOCK Lock)
 	
 	Owner->OwnerThread = NULL;
 	
+#ifdef LOCK_STATISTICS
+	if (Exclusive)
+	{
+		KeLockStatRecordRelease(Lock->ExclusiveStatClass, Lock->ExclusiveAcquiredAt);
+		Lock->ExclusiveStatClass = NULL;
+		Lock->ExclusiveAcquiredAt = 0;
+	}
+#endif
+	
 	Lock->HeldCount--;
 	
 	if (Lock->HeldCount == 0)
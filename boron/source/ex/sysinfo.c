@@ -13,7 +13,7 @@ Abstract:
 Author:
 	iProgramInCpp - 4 March 2026
 ***/
-#include <ex.h>
+#include "exp.h"
 #include <ps.h>
 #include <mm.h>
 #include <string.h>
@@ -23,6 +23,11 @@ Author:
 
 static BSTATUS ExpQueryBasicInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
 static BSTATUS ExpQueryMemoryInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+static BSTATUS ExpQueryLockInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+static BSTATUS ExpQueryProcessInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+static BSTATUS ExpQueryThreadInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+static BSTATUS ExpQueryProcessorInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
+static BSTATUS ExpQueryDpcInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize);
 
 BSTATUS OSQuerySystemInformation(
 	uint32_t QueryType,
@@ -54,14 +59,16 @@ BSTATUS OSQuerySystemInformation(
 	if (BufferSize < MIN_BUFFER_SIZE)
 		BufferSize = MIN_BUFFER_SIZE;
 	
-	void* Buffer = MmAllocatePool(POOL_PAGED, UserBufferSize);
+	// Thread information is gathered with the dispatcher lock held, so the
+	// buffer may not be paged out.
+	void* Buffer = MmAllocatePool(POOL_NONPAGED, BufferSize);
 	if (!Buffer)
 	{
 		// allocation failed!
 		return STATUS_INSUFFICIENT_MEMORY;
 	}
 	
-	memset(Buffer, 0, sizeof Buffer);
+	memset(Buffer, 0, BufferSize);
 	
 	size_t SizeOfReturnedData = 0;
 	switch (QueryType)
@@ -75,13 +82,31 @@ BSTATUS OSQuerySystemInformation(
 			break;
 		
 		case QUERY_PROCESS_INFORMATION:
-			// Return process information here.
-			Status = STATUS_UNIMPLEMENTED;
+			Status = ExpQueryProcessInformation(Buffer, BufferSize, &SizeOfReturnedData);
 			break;
 		
 		case QUERY_THREAD_INFORMATION:
-			// Return thread information here.
-			Status = STATUS_UNIMPLEMENTED;
+			Status = ExpQueryThreadInformation(Buffer, BufferSize, &SizeOfReturnedData);
+			break;
+		
+		case QUERY_PROCESSOR_INFORMATION:
+			Status = ExpQueryProcessorInformation(Buffer, BufferSize, &SizeOfReturnedData);
+			break;
+		
+		case QUERY_LOCK_INFORMATION:
+			Status = ExpQueryLockInformation(Buffer, BufferSize, &SizeOfReturnedData);
+			break;
+		
+		case QUERY_BOOT_TRACE_INFORMATION:
+			Status = ExpQueryBootTraceInformation(Buffer, BufferSize, &SizeOfReturnedData);
+			break;
+		
+		case QUERY_DPC_INFORMATION:
+			Status = ExpQueryDpcInformation(Buffer, BufferSize, &SizeOfReturnedData);
+			break;
+		
+		case QUERY_POOL_TAG_INFORMATION:
+			Status = MmQueryPoolTagInformation(Buffer, BufferSize, &SizeOfReturnedData);
 			break;
 	}
 
@@ -147,6 +172,305 @@ static BSTATUS ExpQueryMemoryInformation(void* Buffer, size_t BufferSize, size_t
 	MemoryInfo->TotalPhysicalMemoryPages = MmGetTotalAvailablePages();
 	MemoryInfo->FreePhysicalMemoryPages = MmGetTotalFreePages();
 	
+	MM_HUGE_PAGE_STATISTICS HugePages;
+	MmGetHugePageStatistics(&HugePages);
+	
+	MemoryInfo->HugePageSize = HugePages.PageSize;
+	MemoryInfo->HugePagesInUse = HugePages.InUse;
+	MemoryInfo->HugePageAllocations = HugePages.Allocations;
+	MemoryInfo->HugePageFallbacks = HugePages.Fallbacks;
+	MemoryInfo->HugePageSplits = HugePages.Splits;
+	
+	MM_COMPRESSED_STORE_STATISTICS CompressedStore;
+	MmGetCompressedStoreStatistics(&CompressedStore);
+	
+	MemoryInfo->CompressedStorePages = CompressedStore.StoredPages;
+	MemoryInfo->CompressedStoreBytes = CompressedStore.StoredBytes;
+	MemoryInfo->PageCompressions = CompressedStore.Compressions;
+	MemoryInfo->PageDecompressions = CompressedStore.Decompressions;
+	MemoryInfo->PageCompressionRejections = CompressedStore.Rejections;
+	
+	MM_PAGE_FILE_STATISTICS PageFile;
+	MmGetPageFileStatistics(&PageFile);
+	
+	MemoryInfo->PageFileTotalPages = PageFile.TotalPages;
+	MemoryInfo->PageFileUsedPages = PageFile.UsedPages;
+	MemoryInfo->PageFileWrites = PageFile.PagesWritten;
+	MemoryInfo->PageFileReads = PageFile.PagesRead;
+	
 	*WrittenBufferSize = sizeof(*MemoryInfo);
 	return STATUS_SUCCESS;
 }
+
+static BSTATUS ExpQueryLockInformation(
+	UNUSED void* Buffer,
+	UNUSED size_t BufferSize,
+	UNUSED size_t* WrittenBufferSize
+)
+{
+#ifdef LOCK_STATISTICS
+	size_t ClassCount = 0;
+	PKLOCK_CLASS ClassTable = KeLockStatGetClassTable(&ClassCount);
+	
+	PSYSTEM_LOCK_INFORMATION LockInfo = Buffer;
+	size_t Written = 0;
+	
+	for (size_t i = 0; i < ClassCount; i++)
+	{
+		PKLOCK_CLASS Class = &ClassTable[i];
+		if (!AtLoad(Class->CallSite))
+			continue;
+		
+		if (Written + sizeof(*LockInfo) > BufferSize)
+			break;
+		
+		LockInfo->Size = sizeof(*LockInfo);
+		LockInfo->Type = (short) Class->Type;
+		LockInfo->CallSite = Class->CallSite;
+		LockInfo->Acquisitions = AtLoad(Class->Acquisitions);
+		LockInfo->ContendedAcquisitions = AtLoad(Class->ContendedAcquisitions);
+		LockInfo->TotalWaitTime = AtLoad(Class->TotalWaitTime);
+		LockInfo->MaxWaitTime = AtLoad(Class->MaxWaitTime);
+		LockInfo->TotalHoldTime = AtLoad(Class->TotalHoldTime);
+		LockInfo->MaxHoldTime = AtLoad(Class->MaxHoldTime);
+		
+		uintptr_t BaseAddress = 0;
+		const char* Name = DbgLookUpRoutineNameByAddress(Class->CallSite, &BaseAddress);
+		if (Name)
+		{
+			snprintf(
+				LockInfo->CallSiteName,
+				sizeof LockInfo->CallSiteName,
+				"%s+%zx",
+				Name,
+				(size_t)(Class->CallSite - BaseAddress)
+			);
+		}
+		
+		Written += sizeof(*LockInfo);
+		LockInfo = NEXT_SYSTEM_INFORMATION(LockInfo);
+	}
+	
+	*WrittenBufferSize = Written;
+	return STATUS_SUCCESS;
+#else
+	// The kernel was built without lock statistics.
+	return STATUS_UNSUPPORTED_FUNCTION;
+#endif
+}
+
+#ifdef DPC_STATISTICS
+
+static bool ExpFillDpcInformation(
+	PKDPC_CLASS Class,
+	int Vector,
+	PSYSTEM_DPC_INFORMATION* DpcInfoInOut,
+	size_t* WrittenInOut,
+	size_t BufferSize
+)
+{
+	PSYSTEM_DPC_INFORMATION DpcInfo = *DpcInfoInOut;
+	if (*WrittenInOut + sizeof(*DpcInfo) > BufferSize)
+		return false;
+	
+	DpcInfo->Size = sizeof(*DpcInfo);
+	DpcInfo->Type = (short) Class->Type;
+	DpcInfo->Vector = Vector;
+	DpcInfo->Routine = AtLoad(Class->Routine);
+	DpcInfo->Count = AtLoad(Class->Count);
+	DpcInfo->TotalTime = AtLoad(Class->TotalTime);
+	DpcInfo->MaxTime = AtLoad(Class->MaxTime);
+	DpcInfo->TotalLatency = AtLoad(Class->TotalLatency);
+	DpcInfo->MaxLatency = AtLoad(Class->MaxLatency);
+	DpcInfo->OverBudgetCount = AtLoad(Class->OverBudgetCount);
+	
+	const char* Name = DbgLookUpRoutineNameByAddressExact(DpcInfo->Routine);
+	if (Name)
+		StringCopySafe(DpcInfo->RoutineName, Name, sizeof DpcInfo->RoutineName);
+	
+	*WrittenInOut += sizeof(*DpcInfo);
+	*DpcInfoInOut = NEXT_SYSTEM_INFORMATION(DpcInfo);
+	return true;
+}
+
+#endif
+
+static BSTATUS ExpQueryDpcInformation(
+	UNUSED void* Buffer,
+	UNUSED size_t BufferSize,
+	UNUSED size_t* WrittenBufferSize
+)
+{
+#ifdef DPC_STATISTICS
+	size_t ClassCount = 0;
+	PKDPC_CLASS ClassTable = KeDpcStatGetClassTable(&ClassCount);
+	
+	PSYSTEM_DPC_INFORMATION DpcInfo = Buffer;
+	size_t Written = 0;
+	
+	for (size_t i = 0; i < ClassCount; i++)
+	{
+		if (!AtLoad(ClassTable[i].Routine))
+			continue;
+		
+		if (!ExpFillDpcInformation(&ClassTable[i], -1, &DpcInfo, &Written, BufferSize))
+			goto Done;
+	}
+	
+	ClassTable = KeDpcStatGetInterruptTable(&ClassCount);
+	
+	for (size_t i = 0; i < ClassCount; i++)
+	{
+		if (!AtLoad(ClassTable[i].Count))
+			continue;
+		
+		if (!ExpFillDpcInformation(&ClassTable[i], (int) i, &DpcInfo, &Written, BufferSize))
+			goto Done;
+	}
+	
+Done:
+	*WrittenBufferSize = Written;
+	return STATUS_SUCCESS;
+#else
+	// The kernel was built without DPC statistics.
+	return STATUS_UNSUPPORTED_FUNCTION;
+#endif
+}
+
+typedef struct
+{
+	void* Buffer;
+	size_t BufferSize;
+	size_t Written;
+}
+EXP_QUERY_CONTEXT, *PEXP_QUERY_CONTEXT;
+
+static void ExpFillThreadInformation(PSYSTEM_THREAD_INFORMATION ThreadInfo, PKTHREAD Thread, PKTHREAD_STATISTICS Statistics)
+{
+	ThreadInfo->Size = sizeof(*ThreadInfo);
+	ThreadInfo->Status = Thread->Status;
+	
+	if (Thread->Process)
+		ThreadInfo->ParentProcessId = (uint32_t) CONTAINING_RECORD(Thread->Process, EPROCESS, Pcb)->ProcessId;
+	
+	ThreadInfo->Priority = Thread->Priority;
+	ThreadInfo->BasePriority = Thread->BasePriority;
+	ThreadInfo->LastProcessor = Thread->LastRunProcessor;
+	
+	ThreadInfo->RunTime = Statistics->RunTime;
+	ThreadInfo->WaitTime = Statistics->WaitTime;
+	ThreadInfo->ReadyTime = Statistics->ReadyTime;
+	ThreadInfo->MaxReadyLatency = Statistics->MaxReadyLatency;
+	ThreadInfo->VoluntarySwitches = Statistics->VoluntarySwitches;
+	ThreadInfo->InvoluntarySwitches = Statistics->InvoluntarySwitches;
+	ThreadInfo->Migrations = Statistics->Migrations;
+}
+
+static bool ExpCountProcessThread(PKTHREAD Thread, PKTHREAD_STATISTICS Statistics, void* Context)
+{
+	PSYSTEM_PROCESS_INFORMATION ProcessInfo = Context;
+	
+	// The first thread in the thread list is the main thread.
+	if (ProcessInfo->ThreadCount == 0)
+		ExpFillThreadInformation(&ProcessInfo->MainThread, Thread, Statistics);
+	
+	ProcessInfo->ThreadCount++;
+	return true;
+}
+
+static void ExpQueryProcess(PEPROCESS Process, void* ContextV)
+{
+	PEXP_QUERY_CONTEXT Context = ContextV;
+	PSYSTEM_PROCESS_INFORMATION ProcessInfo = (void*)((uintptr_t) Context->Buffer + Context->Written);
+	
+	if (Context->Written + sizeof(*ProcessInfo) > Context->BufferSize)
+		return;
+	
+	ProcessInfo->Size = sizeof(*ProcessInfo);
+	ProcessInfo->ProcessId = Process->ProcessId;
+	
+	// These are read without the address space lock, so they may be slightly out of date.
+	ProcessInfo->WorkingSetPages = Process->WorkingSet.ResidentPages;
+	ProcessInfo->PeakWorkingSetPages = Process->WorkingSet.PeakResidentPages;
+	ProcessInfo->PageFaultCount = Process->WorkingSet.PageFaultCount;
+	ProcessInfo->TrimmedPages = Process->WorkingSet.TrimmedPages;
+	
+	static_assert(SPI_MAX_IMAGE_NAME <= MAX_IMAGE_NAME);
+	memcpy(ProcessInfo->ImageName, Process->ImageName, SPI_MAX_IMAGE_NAME);
+	ProcessInfo->ImageName[SPI_MAX_IMAGE_NAME - 1] = 0;
+	
+	KeEnumerateThreadsProcess(&Process->Pcb, ExpCountProcessThread, ProcessInfo);
+	
+	Context->Written += sizeof(*ProcessInfo);
+}
+
+static BSTATUS ExpQueryProcessInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize)
+{
+	EXP_QUERY_CONTEXT Context;
+	Context.Buffer = Buffer;
+	Context.BufferSize = BufferSize;
+	Context.Written = 0;
+	
+	PsEnumerateProcesses(ExpQueryProcess, &Context);
+	
+	*WrittenBufferSize = Context.Written;
+	return STATUS_SUCCESS;
+}
+
+static bool ExpQueryThread(PKTHREAD Thread, PKTHREAD_STATISTICS Statistics, void* ContextV)
+{
+	PEXP_QUERY_CONTEXT Context = ContextV;
+	PSYSTEM_THREAD_INFORMATION ThreadInfo = (void*)((uintptr_t) Context->Buffer + Context->Written);
+	
+	if (Context->Written + sizeof(*ThreadInfo) > Context->BufferSize)
+		return false;
+	
+	ExpFillThreadInformation(ThreadInfo, Thread, Statistics);
+	
+	Context->Written += sizeof(*ThreadInfo);
+	return true;
+}
+
+static BSTATUS ExpQueryThreadInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize)
+{
+	EXP_QUERY_CONTEXT Context;
+	Context.Buffer = Buffer;
+	Context.BufferSize = BufferSize;
+	Context.Written = 0;
+	
+	KeEnumerateThreads(ExpQueryThread, &Context);
+	
+	*WrittenBufferSize = Context.Written;
+	return STATUS_SUCCESS;
+}
+
+static BSTATUS ExpQueryProcessorInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize)
+{
+	PSYSTEM_PROCESSOR_INFORMATION ProcessorInfo = Buffer;
+	size_t Written = 0;
+	
+	for (int i = 0; i < KeGetProcessorCount(); i++)
+	{
+		if (Written + sizeof(*ProcessorInfo) > BufferSize)
+			break;
+		
+		KSTATISTICS Statistics;
+		uint64_t TicksSpentNonIdle = 0;
+		KeStatsGetProcessorStatistics(i, &Statistics, &TicksSpentNonIdle);
+		
+		ProcessorInfo->Size = sizeof(*ProcessorInfo);
+		ProcessorInfo->ProcessorId = i;
+		ProcessorInfo->BusyTime = TicksSpentNonIdle;
+		ProcessorInfo->ContextSwitches = Statistics.ContextSwitches;
+		ProcessorInfo->WorkSteals = Statistics.WorkSteals;
+		ProcessorInfo->IpisReceived = Statistics.IpisReceived;
+		ProcessorInfo->DpcsRun = Statistics.DpcsRun;
+		ProcessorInfo->Interrupts = Statistics.Interrupts;
+		
+		Written += sizeof(*ProcessorInfo);
+		ProcessorInfo = NEXT_SYSTEM_INFORMATION(ProcessorInfo);
+	}
+	
+	*WrittenBufferSize = Written;
+	return STATUS_SUCCESS;
+}
@@ -0,0 +1,253 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ex/worker.c
+	
+Abstract:
+	This module implements the executive's work queues.  Each
+	processor has a pool of worker threads for each type of work
+	queue.  Pools grow when their workers block with work still
+	pending, and shrink when their extra workers stay idle.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "exp.h"
+#include <ps.h>
+
+#define EXP_BALANCE_INTERVAL_MS    (1000)
+#define EXP_WORKER_IDLE_TIMEOUT_MS (30000)
+#define EXP_BALANCE_BOOST          (1)
+
+typedef struct
+{
+	int Priority;
+	int MinimumThreads;
+	int MaximumThreads;
+}
+EXP_WORK_QUEUE_INFO;
+
+typedef struct
+{
+	// Only one worker of a pool runs at a time.  While it's blocked in another
+	// wait, the queue lets another worker take the next item.
+	KQUEUE Queue;
+	
+	EX_WORK_QUEUE_TYPE Type;
+	int Processor;
+	
+	int ThreadCount;
+	
+	// The number of workers waiting on the queue for an item.
+	int IdleCount;
+}
+EXP_WORKER_POOL, *PEXP_WORKER_POOL;
+
+static const EXP_WORK_QUEUE_INFO ExpWorkQueueInfo[WORK_QUEUE_COUNT] =
+{
+	{ PRIORITY_HIGH,   1, 8 }, // WORK_QUEUE_CRITICAL
+	{ PRIORITY_NORMAL, 0, 8 }, // WORK_QUEUE_DELAYED
+	{ PRIORITY_LOW,    0, 2 }, // WORK_QUEUE_BACKGROUND
+};
+
+// Indexed by Processor * WORK_QUEUE_COUNT + Type.
+static PEXP_WORKER_POOL ExpWorkerPools;
+static int ExpWorkerPoolCount;
+
+// Set to have the balance manager check the pools right away.
+static KEVENT ExpBalanceEvent;
+
+static bool ExpCreateWorker(PEXP_WORKER_POOL Pool);
+
+// Called when a worker has been idle for a while.  Returns true if the worker
+// may exit, in which case it is no longer counted as part of the pool.
+static bool ExpRetireWorker(PEXP_WORKER_POOL Pool)
+{
+	int MinimumThreads = ExpWorkQueueInfo[Pool->Type].MinimumThreads;
+	int Count = AtLoad(Pool->ThreadCount);
+	
+	do
+	{
+		if (Count <= MinimumThreads)
+			return false;
+	}
+	while (!AtCompareExchange(&Pool->ThreadCount, &Count, Count - 1));
+	
+	// An item may have been queued just as this worker gave up on waiting.
+	if (KeReadStateQueue(&Pool->Queue) > 0)
+		KeSetEvent(&ExpBalanceEvent, EXP_BALANCE_BOOST);
+	
+	return true;
+}
+
+static NO_RETURN void ExpWorkerThread(void* Context)
+{
+	PEXP_WORKER_POOL Pool = Context;
+	int MinimumThreads = ExpWorkQueueInfo[Pool->Type].MinimumThreads;
+	
+	while (true)
+	{
+		PLIST_ENTRY Entry;
+		int Count;
+		
+		// Workers beyond the pool's minimum exit once they stay idle for long enough.
+		int Timeout = TIMEOUT_INFINITE;
+		if (AtLoad(Pool->ThreadCount) > MinimumThreads)
+			Timeout = EXP_WORKER_IDLE_TIMEOUT_MS;
+		
+		AtAddFetch(Pool->IdleCount, 1);
+		BSTATUS Status = KeRemoveQueue(&Pool->Queue, false, Timeout, MODE_KERNEL, &Entry, 1, &Count);
+		AtAddFetch(Pool->IdleCount, -1);
+		
+		if (Status == STATUS_TIMEOUT)
+		{
+			if (ExpRetireWorker(Pool))
+				PsTerminateThread();
+			
+			continue;
+		}
+		
+		ASSERT(Status == STATUS_SUCCESS);
+		
+		// The routine may free or requeue the work item, so don't touch it afterwards.
+		PEX_WORK_ITEM WorkItem = CONTAINING_RECORD(Entry, EX_WORK_ITEM, ListEntry);
+		WorkItem->Routine(WorkItem->Context);
+		
+		ASSERT(KeGetIPL() == IPL_NORMAL);
+	}
+}
+
+// Items are only left waiting while the pool's concurrency limit would allow a
+// worker to run if no worker is waiting for them.  That means that every worker
+// is blocked somewhere else, or that the pool has no workers at all.
+static void ExpBalancePool(PEXP_WORKER_POOL Pool)
+{
+	if (KeReadStateQueue(&Pool->Queue) == 0)
+		return;
+	
+	if (AtLoad(Pool->IdleCount) != 0)
+		return;
+	
+	if (AtLoad(Pool->Queue.CurrentCount) >= Pool->Queue.MaximumCount)
+		return;
+	
+	if (AtLoad(Pool->ThreadCount) >= ExpWorkQueueInfo[Pool->Type].MaximumThreads)
+		return;
+	
+	ExpCreateWorker(Pool);
+}
+
+static NO_RETURN void ExpWorkerBalanceManager(UNUSED void* Context)
+{
+	while (true)
+	{
+		// The periodic pass catches workers which blocked after their item was queued.
+		KeWaitForSingleObject(&ExpBalanceEvent, false, EXP_BALANCE_INTERVAL_MS, MODE_KERNEL);
+		
+		for (int i = 0; i < ExpWorkerPoolCount; i++)
+			ExpBalancePool(&ExpWorkerPools[i]);
+	}
+}
+
+static bool ExpCreateWorker(PEXP_WORKER_POOL Pool)
+{
+	PETHREAD Thread;
+	
+	AtAddFetch(Pool->ThreadCount, 1);
+	
+	BSTATUS Status = PsCreateSystemThreadFast(&Thread, ExpWorkerThread, Pool, true);
+	if (FAILED(Status))
+	{
+		AtAddFetch(Pool->ThreadCount, -1);
+		DbgPrint("ExpCreateWorker: Could not create worker thread: %d (%s)", Status, RtlGetStatusString(Status));
+		return false;
+	}
+	
+	// Keep the worker on its pool's processor, close to the data its items were queued with.
+	if (Pool->Processor < (int)(sizeof(KAFFINITY) * 8))
+		Thread->Tcb.Affinity = 1ULL << Pool->Processor;
+	
+	KeSetPriorityThread(&Thread->Tcb, ExpWorkQueueInfo[Pool->Type].Priority);
+	KeReadyThread(&Thread->Tcb);
+	
+	ObDereferenceObject(Thread);
+	return true;
+}
+
+void ExInitializeWorkItem(PEX_WORK_ITEM WorkItem, PEX_WORKER_ROUTINE Routine, void* Context)
+{
+	WorkItem->ListEntry.Flink = WorkItem->ListEntry.Blink = NULL;
+	WorkItem->Routine = Routine;
+	WorkItem->Context = Context;
+}
+
+void ExQueueWorkItemProcessor(PEX_WORK_ITEM WorkItem, EX_WORK_QUEUE_TYPE QueueType, int Processor)
+{
+	ASSERT(KeGetIPL() <= IPL_DPC);
+	ASSERT(ExpWorkerPools);
+	ASSERT(QueueType < WORK_QUEUE_COUNT);
+	ASSERT(Processor >= 0 && Processor < KeGetProcessorCount());
+	
+	PEXP_WORKER_POOL Pool = &ExpWorkerPools[Processor * WORK_QUEUE_COUNT + QueueType];
+	
+	KeInsertQueue(&Pool->Queue, &WorkItem->ListEntry);
+	
+	// If no worker was waiting for it, and the existing ones (if any) are blocked,
+	// have the balance manager add one now instead of at its next pass.
+	if (AtLoad(Pool->IdleCount) == 0 &&
+		AtLoad(Pool->Queue.CurrentCount) < Pool->Queue.MaximumCount)
+		KeSetEvent(&ExpBalanceEvent, EXP_BALANCE_BOOST);
+}
+
+void ExQueueWorkItem(PEX_WORK_ITEM WorkItem, EX_WORK_QUEUE_TYPE QueueType)
+{
+	// If the caller is preempted and moved to another processor right after
+	// this, the item merely runs on the old processor, which is harmless.
+	ExQueueWorkItemProcessor(WorkItem, QueueType, KeGetCurrentPRCB()->Id);
+}
+
+INIT
+bool ExInitializeWorkQueues()
+{
+	ExpWorkerPoolCount = KeGetProcessorCount() * WORK_QUEUE_COUNT;
+	ExpWorkerPools = MmAllocatePool(POOL_NONPAGED, sizeof(EXP_WORKER_POOL) * ExpWorkerPoolCount);
+	if (!ExpWorkerPools)
+		return false;
+	
+	KeInitializeEvent(&ExpBalanceEvent, EVENT_SYNCHRONIZATION, false);
+	
+	for (int i = 0; i < ExpWorkerPoolCount; i++)
+	{
+		PEXP_WORKER_POOL Pool = &ExpWorkerPools[i];
+		
+		KeInitializeQueue(&Pool->Queue, 1);
+		Pool->Type = i % WORK_QUEUE_COUNT;
+		Pool->Processor = i / WORK_QUEUE_COUNT;
+		Pool->ThreadCount = 0;
+		Pool->IdleCount = 0;
+	}
+	
+	for (int i = 0; i < ExpWorkerPoolCount; i++)
+	{
+		PEXP_WORKER_POOL Pool = &ExpWorkerPools[i];
+		
+		for (int j = 0; j < ExpWorkQueueInfo[Pool->Type].MinimumThreads; j++)
+		{
+			if (!ExpCreateWorker(Pool))
+				return false;
+		}
+	}
+	
+	PETHREAD Thread;
+	BSTATUS Status = PsCreateSystemThreadFast(&Thread, ExpWorkerBalanceManager, NULL, true);
+	if (FAILED(Status))
+		return false;
+	
+	KeSetPriorityThread(&Thread->Tcb, PRIORITY_HIGH_MAX);
+	KeReadyThread(&Thread->Tcb);
+	ObDereferenceObject(Thread);
+	
+	return true;
+}
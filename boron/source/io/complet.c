@@ -0,0 +1,414 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	io/complet.c
+	
+Abstract:
+	This module implements the I/O completion port object.
+	
+	A completion port is a kernel queue of entries, which a
+	pool of worker threads removes in batches.  The queue
+	limits how many of the workers run at once, by default
+	to the processor count.
+	
+	Entries are either posted directly, or queued on behalf
+	of file objects associated with the port, when the file
+	may have become readable or writable.  Such entries are
+	embedded in the association, so that notifying a port
+	never allocates memory, and repeated notifications are
+	merged while the entry is still queued.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "iop.h"
+#include <ex/internal.h>
+
+typedef struct _IO_COMPLETION_PACKET
+{
+	LIST_ENTRY ListEntry;
+	
+	// The association this packet is embedded in, or NULL if the packet
+	// was posted with IoPostCompletionPort.
+	PIO_COMPLETION_ASSOCIATION Association;
+	
+	void* Key;
+	BSTATUS Status;
+	uint64_t Information;
+}
+IO_COMPLETION_PACKET, *PIO_COMPLETION_PACKET;
+
+struct _IO_COMPLETION_ASSOCIATION
+{
+	// Entry into the FCB's list of associations.  Guarded by the FCB's
+	// completion lock.
+	LIST_ENTRY FcbListEntry;
+	
+	// The port is referenced by the association.
+	PIO_COMPLETION_PORT Port;
+	
+	IO_COMPLETION_PACKET Packet;
+	
+	// Whether the packet is queued, and whether the file object was deleted
+	// while it was.  In that case, whoever takes the packet off the queue
+	// frees the association.  Guarded by the port's lock.
+	bool Queued;
+	bool Closed;
+};
+
+struct _IO_COMPLETION_PORT
+{
+	KQUEUE Queue;
+	
+	KSPIN_LOCK Lock;
+};
+
+POBJECT_TYPE IoCompletionPortType;
+
+static void IopQueueAssociation(PIO_COMPLETION_ASSOCIATION Association, uint32_t Readiness)
+{
+	PIO_COMPLETION_PORT Port = Association->Port;
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&Port->Lock, &Ipl);
+	
+	if (Association->Queued)
+	{
+		Association->Packet.Information |= Readiness;
+	}
+	else
+	{
+		Association->Packet.Information = Readiness;
+		Association->Queued = true;
+		KeInsertQueue(&Port->Queue, &Association->Packet.ListEntry);
+	}
+	
+	KeReleaseSpinLock(&Port->Lock, Ipl);
+}
+
+void IoNotifyReadinessFcb(PFCB Fcb, uint32_t Readiness)
+{
+	// Most FCBs never have associations, so avoid the lock in that case.  An
+	// association made concurrently queues its own packet, so nothing is lost.
+	if (IsListEmpty(&Fcb->CompletionList))
+		return;
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&Fcb->CompletionLock, &Ipl);
+	
+	PLIST_ENTRY Entry = Fcb->CompletionList.Flink;
+	while (Entry != &Fcb->CompletionList)
+	{
+		PIO_COMPLETION_ASSOCIATION Association = CONTAINING_RECORD(Entry, IO_COMPLETION_ASSOCIATION, FcbListEntry);
+		IopQueueAssociation(Association, Readiness);
+		Entry = Entry->Flink;
+	}
+	
+	KeReleaseSpinLock(&Fcb->CompletionLock, Ipl);
+}
+
+BSTATUS IoAssociateCompletionPort(PFILE_OBJECT FileObject, PIO_COMPLETION_PORT Port, void* Key)
+{
+	PFCB Fcb = FileObject->Fcb;
+	
+	PIO_COMPLETION_ASSOCIATION Association = MmAllocatePool(POOL_NONPAGED, sizeof(IO_COMPLETION_ASSOCIATION));
+	if (!Association)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	Association->Port = Port;
+	Association->Packet.Association = Association;
+	Association->Packet.Key = Key;
+	Association->Packet.Status = STATUS_SUCCESS;
+	Association->Packet.Information = 0;
+	Association->Queued = false;
+	Association->Closed = false;
+	
+	ObReferenceObjectByPointer(Port);
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&Fcb->CompletionLock, &Ipl);
+	
+	if (FileObject->CompletionAssociation)
+	{
+		KeReleaseSpinLock(&Fcb->CompletionLock, Ipl);
+		ObDereferenceObject(Port);
+		MmFreePool(Association);
+		return STATUS_ALREADY_ASSOCIATED;
+	}
+	
+	FileObject->CompletionAssociation = Association;
+	InsertTailList(&Fcb->CompletionList, &Association->FcbListEntry);
+	
+	// The file may already be readable or writable, and no notification will
+	// arrive for that, so let the port find out for itself.
+	IopQueueAssociation(Association, IO_COMPLETION_READABLE | IO_COMPLETION_WRITABLE);
+	
+	KeReleaseSpinLock(&Fcb->CompletionLock, Ipl);
+	return STATUS_SUCCESS;
+}
+
+// Called when a file object associated with a completion port is deleted.
+void IopDisassociateCompletionPort(PFILE_OBJECT FileObject)
+{
+	PFCB Fcb = FileObject->Fcb;
+	PIO_COMPLETION_ASSOCIATION Association = FileObject->CompletionAssociation;
+	PIO_COMPLETION_PORT Port = Association->Port;
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&Fcb->CompletionLock, &Ipl);
+	RemoveEntryList(&Association->FcbListEntry);
+	FileObject->CompletionAssociation = NULL;
+	KeReleaseSpinLock(&Fcb->CompletionLock, Ipl);
+	
+	KeAcquireSpinLock(&Port->Lock, &Ipl);
+	bool FreeNow = !Association->Queued;
+	Association->Closed = true;
+	KeReleaseSpinLock(&Port->Lock, Ipl);
+	
+	if (FreeNow)
+		MmFreePool(Association);
+	
+	ObDereferenceObject(Port);
+}
+
+BSTATUS IoPostCompletionPort(PIO_COMPLETION_PORT Port, void* Key, BSTATUS Status, uint64_t Information)
+{
+	PIO_COMPLETION_PACKET Packet = MmAllocatePool(POOL_NONPAGED, sizeof(IO_COMPLETION_PACKET));
+	if (!Packet)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	Packet->Association = NULL;
+	Packet->Key = Key;
+	Packet->Status = Status;
+	Packet->Information = Information;
+	
+	KeInsertQueue(&Port->Queue, &Packet->ListEntry);
+	return STATUS_SUCCESS;
+}
+
+// Takes a packet, which was removed from the port's queue, and fills in an entry
+// from it.  Returns false if the packet belonged to a file object which has since
+// been deleted.
+static bool IopConsumePacket(PIO_COMPLETION_PORT Port, PIO_COMPLETION_PACKET Packet, PIO_COMPLETION_ENTRY Entry)
+{
+	PIO_COMPLETION_ASSOCIATION Association = Packet->Association;
+	
+	if (!Association)
+	{
+		Entry->Key = Packet->Key;
+		Entry->Status = Packet->Status;
+		Entry->Information = Packet->Information;
+		MmFreePool(Packet);
+		return true;
+	}
+	
+	// Readiness may have been merged into the packet until now, so read it while
+	// marking it as no longer queued.
+	KIPL Ipl;
+	KeAcquireSpinLock(&Port->Lock, &Ipl);
+	
+	Entry->Key = Packet->Key;
+	Entry->Status = Packet->Status;
+	Entry->Information = Packet->Information;
+	
+	bool Closed = Association->Closed;
+	Association->Queued = false;
+	
+	KeReleaseSpinLock(&Port->Lock, Ipl);
+	
+	if (Closed)
+	{
+		MmFreePool(Association);
+		return false;
+	}
+	
+	return true;
+}
+
+// Removes up to MaximumEntries entries from the completion port, waiting for at
+// least one if there are none.
+BSTATUS IoRemoveCompletionPort(
+	PIO_COMPLETION_PORT Port,
+	PIO_COMPLETION_ENTRY Entries,
+	int MaximumEntries,
+	int* OutEntryCount,
+	bool Alertable,
+	int TimeoutMS,
+	KPROCESSOR_MODE WaitMode
+)
+{
+	PLIST_ENTRY ListEntries[IO_COMPLETION_MAX_ENTRIES];
+	BSTATUS Status = STATUS_SUCCESS;
+	int EntryCount = 0;
+	
+	if (MaximumEntries > IO_COMPLETION_MAX_ENTRIES)
+		MaximumEntries = IO_COMPLETION_MAX_ENTRIES;
+	
+	// Entries of deleted file objects are dropped, so wait again if all of them were.
+	while (EntryCount == 0)
+	{
+		int Count = 0;
+		Status = KeRemoveQueue(&Port->Queue, Alertable, TimeoutMS, WaitMode, ListEntries, MaximumEntries, &Count);
+		if (Status != STATUS_SUCCESS)
+			break;
+		
+		for (int i = 0; i < Count; i++)
+		{
+			PIO_COMPLETION_PACKET Packet = CONTAINING_RECORD(ListEntries[i], IO_COMPLETION_PACKET, ListEntry);
+			
+			if (IopConsumePacket(Port, Packet, &Entries[EntryCount]))
+				EntryCount++;
+		}
+	}
+	
+	*OutEntryCount = EntryCount;
+	return Status;
+}
+
+void IopDeleteCompletionPort(void* Object)
+{
+	PIO_COMPLETION_PORT Port = Object;
+	
+	LIST_ENTRY EntryList;
+	KeRundownQueue(&Port->Queue, &EntryList);
+	
+	// Associations keep the port alive, so any packets left belong either to
+	// deleted file objects, or were posted directly.
+	while (!IsListEmpty(&EntryList))
+	{
+		PLIST_ENTRY Entry = RemoveHeadList(&EntryList);
+		PIO_COMPLETION_PACKET Packet = CONTAINING_RECORD(Entry, IO_COMPLETION_PACKET, ListEntry);
+		
+		if (Packet->Association)
+		{
+			ASSERT(Packet->Association->Closed);
+			MmFreePool(Packet->Association);
+		}
+		else
+		{
+			MmFreePool(Packet);
+		}
+	}
+}
+
+static BSTATUS IopInitializeCompletionPort(void* Object, void* Context)
+{
+	PIO_COMPLETION_PORT Port = Object;
+	
+	KeInitializeQueue(&Port->Queue, *(int*) Context);
+	KeInitializeSpinLock(&Port->Lock);
+	return STATUS_SUCCESS;
+}
+
+BSTATUS OSCreateCompletionPort(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, int MaximumConcurrency)
+{
+	if (MaximumConcurrency < 0)
+		return STATUS_INVALID_PARAMETER;
+	
+	return ExCreateObjectUserCall(
+		OutHandle,
+		ObjectAttributes,
+		IoCompletionPortType,
+		sizeof(IO_COMPLETION_PORT),
+		IopInitializeCompletionPort,
+		&MaximumConcurrency,
+		POOL_NONPAGED,
+		false
+	);
+}
+
+BSTATUS OSAssociateCompletionPort(HANDLE PortHandle, HANDLE FileHandle, void* Key)
+{
+	BSTATUS Status;
+	void* PortV;
+	void* FileObjectV;
+	
+	Status = ObReferenceObjectByHandle(PortHandle, IoCompletionPortType, &PortV);
+	if (FAILED(Status))
+		return Status;
+	
+	Status = ObReferenceObjectByHandle(FileHandle, IoFileType, &FileObjectV);
+	if (FAILED(Status))
+	{
+		ObDereferenceObject(PortV);
+		return Status;
+	}
+	
+	Status = IoAssociateCompletionPort(FileObjectV, PortV, Key);
+	
+	ObDereferenceObject(FileObjectV);
+	ObDereferenceObject(PortV);
+	return Status;
+}
+
+BSTATUS OSPostCompletionPort(HANDLE PortHandle, void* Key, BSTATUS Status, uintptr_t Information)
+{
+	void* PortV;
+	BSTATUS Status2 = ObReferenceObjectByHandle(PortHandle, IoCompletionPortType, &PortV);
+	if (FAILED(Status2))
+		return Status2;
+	
+	Status2 = IoPostCompletionPort(PortV, Key, Status, Information);
+	
+	ObDereferenceObject(PortV);
+	return Status2;
+}
+
+BSTATUS OSRemoveCompletionPort(
+	HANDLE PortHandle,
+	PIO_COMPLETION_ENTRY Entries,
+	int MaximumEntries,
+	int* OutEntryCount,
+	bool Alertable,
+	int TimeoutMS
+)
+{
+	BSTATUS Status;
+	KPROCESSOR_MODE Mode = KeGetPreviousMode();
+	
+	if (MaximumEntries <= 0 || !Entries || !OutEntryCount)
+		return STATUS_INVALID_PARAMETER;
+	
+	if (MaximumEntries > IO_COMPLETION_MAX_ENTRIES)
+		MaximumEntries = IO_COMPLETION_MAX_ENTRIES;
+	
+	// Check the buffers before removing anything, because the entries would be
+	// lost if they couldn't be copied out.
+	Status = MmProbeAddress(Entries, MaximumEntries * sizeof(IO_COMPLETION_ENTRY), true, Mode);
+	if (FAILED(Status))
+		return Status;
+	
+	Status = MmProbeAddress(OutEntryCount, sizeof(int), true, Mode);
+	if (FAILED(Status))
+		return Status;
+	
+	PIO_COMPLETION_ENTRY EntriesCopy = MmAllocatePool(POOL_PAGED, MaximumEntries * sizeof(IO_COMPLETION_ENTRY));
+	if (!EntriesCopy)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	void* PortV;
+	Status = ObReferenceObjectByHandle(PortHandle, IoCompletionPortType, &PortV);
+	if (FAILED(Status))
+	{
+		MmFreePool(EntriesCopy);
+		return Status;
+	}
+	
+	int EntryCount = 0;
+	Status = IoRemoveCompletionPort(PortV, EntriesCopy, MaximumEntries, &EntryCount, Alertable, TimeoutMS, Mode);
+	
+	ObDereferenceObject(PortV);
+	
+	BSTATUS Status2 = MmSafeCopy(Entries, EntriesCopy, EntryCount * sizeof(IO_COMPLETION_ENTRY), Mode, true);
+	if (SUCCEEDED(Status2))
+		Status2 = MmSafeCopy(OutEntryCount, &EntryCount, sizeof(int), Mode, true);
+	
+	MmFreePool(EntriesCopy);
+	
+	if (FAILED(Status2))
+		return Status2;
+	
+	return Status;
+}
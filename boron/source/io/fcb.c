@@ -26,6 +26,8 @@ PFCB IoAllocateFcb(PIO_DISPATCH_TABLE Dispatch, size_t ExtensionSize, bool NonPa
 	
 	ExInitializeRwLock(&Fcb->RwLock);
 	IoInitializeCacheInfo(&Fcb->CacheInfo);
+	KeInitializeSpinLock(&Fcb->CompletionLock);
+	InitializeListHead(&Fcb->CompletionList);
 	
 	memset(Fcb->Extension, 0, Fcb->ExtensionSize);
 	return Fcb;
@@ -33,6 +35,8 @@ PFCB IoAllocateFcb(PIO_DISPATCH_TABLE Dispatch, size_t ExtensionSize, bool NonPa
 
 void IoFreeFcb(PFCB Fcb)
 {
+	ASSERT(IsListEmpty(&Fcb->CompletionList));
+	
 	ExDeinitializeRwLock(&Fcb->RwLock);
 	IoTeardownCacheInfo(&Fcb->CacheInfo);
 	MmFreePool(Fcb);
@@ -45,6 +45,7 @@ BSTATUS IoCreateFileObject(PFCB Fcb, PFILE_OBJECT* OutObject, uint32_t Flags, ui
 	FileObject->CurrentFileOffset = 0;
 	FileObject->CurrentDirectoryVersion = 0;
 	FileObject->OpenFlags = OpenFlags;
+	FileObject->CompletionAssociation = NULL;
 	
 	KeInitializeMutex(&FileObject->FileOffsetMutex, 0);
 	
@@ -90,6 +91,9 @@ void IopDeleteFile(void* Object)
 {
 	PFILE_OBJECT File = Object;
 	
+	if (File->CompletionAssociation)
+		IopDisassociateCompletionPort(File);
+	
 	// Delete the reference to the FCB.
 	IO_DELETE_OBJ_METHOD DeleteObjMethod = File->Fcb->DispatchTable->DeleteObject;
 	
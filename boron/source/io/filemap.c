@@ -228,13 +228,17 @@ static BSTATUS IopSetPageModifiedFile(void* MappableObject, uint64_t SectionOffs
 
 static BSTATUS IopPrepareWriteFile(void* MappableObject, uint64_t SectionOffset)
 {
-	(void) MappableObject;
 	(void) SectionOffset;
 	
 	// The modified state of shared pages in a file does not need to be set
 	// instantly when a page is written.  The only requirement is that the page
 	// is set as modified at SOME point in order to flush it to disk -- this
 	// may simply be done when unmapping the file from memory.
+	//
+	// However, image sections built from the file are about to go stale.  Any
+	// later writes to the same page are caught when it is written back.
+	PFILE_OBJECT FileObject = MappableObject;
+	MmInvalidateImageSections(FileObject->Fcb);
 	
 	return STATUS_SUCCESS;
 }
@@ -91,6 +91,17 @@ bool IopInitializeObjectTypes()
 		return false;
 	}
 	
+	// Initialize the CompletionPort object type.
+	memset (&Info, 0, sizeof Info);
+	Info.NonPagedPool = true;
+	Info.Delete = IopDeleteCompletionPort;
+	Status = ObCreateObjectType("CompletionPort", &Info, &IoCompletionPortType);
+	if (FAILED(Status))
+	{
+		DbgPrint("IO: Failed to create CompletionPort type.");
+		return false;
+	}
+	
 	// All done.
 	return true;
 }
@@ -117,9 +128,13 @@ bool IoInitSystem()
 	
 	IopInitPartitionManager();
 	
+	int Phase = ExBeginBootPhase("Drivers");
 	LdrInitializeDrivers();
+	ExEndBootPhase(Phase);
 	
+	Phase = ExBeginBootPhase("File systems");
 	IoScanForFileSystems();
+	ExEndBootPhase(Phase);
 	
 #ifdef IO_INIT_DEBUG
 	// TEST: This is test code.
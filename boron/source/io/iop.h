@@ -69,5 +69,10 @@ void IoScanForFileSystems();
 // Create a partition from a block device.
 BSTATUS IoCreatePartition(PDEVICE_OBJECT* OutDevice, PDEVICE_OBJECT InDevice, uint64_t Offset, uint64_t Size, size_t Number);
 
+// Completion port object operations
+extern POBJECT_TYPE IoCompletionPortType;
+void IopDeleteCompletionPort(void* Object);
+void IopDisassociateCompletionPort(PFILE_OBJECT FileObject);
+
 // File object mappable
 extern MAPPABLE_DISPATCH_TABLE IopFileObjectMappableDispatch;
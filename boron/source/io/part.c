@@ -157,6 +157,19 @@ Done:
 		DbgPrint("Failed to find partitions on %s: %d (%s)", Name, Status, RtlGetStatusString(Status));
 }
 
+typedef struct
+{
+	PDEVICE_OBJECT Device;
+	POBJECT_DIRECTORY MountDir;
+}
+IOP_SCAN_TASK, *PIOP_SCAN_TASK;
+
+static void IopScanForFileSystemsTask(void* Context)
+{
+	PIOP_SCAN_TASK Task = Context;
+	IopScanForFileSystemsOnDevice(Task->Device, Task->MountDir);
+}
+
 // Initiates the file system scanning procedure.
 void IoScanForFileSystems()
 {
@@ -175,13 +188,50 @@ void IoScanForFileSystems()
 	if (FAILED(Status))
 		KeCrash("ERROR: Failed to create %s: %d (%s)", IopDefaultMountPath, Status, RtlGetStatusString(Status));
 	
+	// Each device is scanned as a separate boot task.  The partitions found on
+	// one device are independent from those found on another, so the scans may
+	// run concurrently.  Both lists stay locked until every scan is done.
+	int Count = 0;
 	for (PLIST_ENTRY Entry = IopPartitionableListHead.Flink;
 		Entry != &IopPartitionableListHead;
 		Entry = Entry->Flink)
+	{
+		Count++;
+	}
+	
+	PIOP_SCAN_TASK Tasks = NULL;
+	void** Contexts = NULL;
+	const char** Names = NULL;
+	
+	if (Count != 0)
+	{
+		Tasks = MmAllocatePool(POOL_NONPAGED, sizeof(IOP_SCAN_TASK) * Count);
+		Contexts = MmAllocatePool(POOL_NONPAGED, sizeof(void*) * Count);
+		Names = MmAllocatePool(POOL_NONPAGED, sizeof(const char*) * Count);
+		if (!Tasks || !Contexts || !Names)
+			KeCrash("ERROR: Could not allocate file system scan tasks");
+	}
+	
+	int Index = 0;
+	for (PLIST_ENTRY Entry = IopPartitionableListHead.Flink;
+		Entry != &IopPartitionableListHead;
+		Entry = Entry->Flink, Index++)
 	{
 		PDEVICE_OBJECT Device = CONTAINING_RECORD(Entry, DEVICE_OBJECT, PartitionableListEntry);
 		
-		IopScanForFileSystemsOnDevice(Device, MountDir);
+		Tasks[Index].Device = Device;
+		Tasks[Index].MountDir = MountDir;
+		Contexts[Index] = &Tasks[Index];
+		Names[Index] = OBJECT_GET_HEADER(Device)->ObjectName;
+	}
+	
+	ExRunBootTasks(IopScanForFileSystemsTask, Contexts, Names, Count);
+	
+	if (Count != 0)
+	{
+		MmFreePool(Tasks);
+		MmFreePool(Contexts);
+		MmFreePool(Names);
 	}
 	
 	KeReleaseMutex(&IopPartitionableListLock);
@@ -10,6 +10,10 @@ Abstract:
 	is implemented using a circular ring buffer of variable
 	size.
 	
+	Large writes skip the ring buffer.  The writer's pinned
+	buffer is handed to the readers, who copy out of it
+	directly.
+	
 	This implementation supports anonymous pipes and named
 	pipes.  Named pipes are implemented using a special object
 	type called NamedPipe which parses into a file object when
@@ -30,6 +34,11 @@ Author:
 // Maximum pipe size.
 #define MAX_PIPE_SIZE (32768)
 
+// Writes of at least this many bytes, which also don't fit into the ring buffer,
+// are handed to readers directly if the ring buffer is empty.  Smaller writes
+// always go through the ring buffer.
+#define PIPE_DIRECT_THRESHOLD (PAGE_SIZE)
+
 // A pipe is an FCB whose extension is this structure.
 typedef struct _PIPE
 {
@@ -41,6 +50,20 @@ typedef struct _PIPE
 	size_t Tail;
 	size_t BufferSize;
 	bool   EndReadNow;
+	
+	// The buffer of a writer in IopWritePipeDirect, if any.  While it is set,
+	// the ring buffer is empty and no other writer may write.
+	PMDL   DirectMdl;
+	size_t DirectOffset;
+	size_t DirectEnd;
+	KEVENT DirectDoneEvent;
+	
+	// The FCBs whose associated completion ports are told when the pipe may have
+	// become readable or writable.  This is the pipe's own FCB, unless the pipe
+	// is part of another object, such as a terminal.
+	PFCB ReadableNotifyFcb;
+	PFCB WritableNotifyFcb;
+	
 	char Buffer[];
 }
 PIPE, *PPIPE;
@@ -51,9 +74,101 @@ void IopInitializePipe(PPIPE Pipe, size_t BufferSize)
 	Pipe->Head = 0;
 	Pipe->Tail = 0;
 	Pipe->ReferenceCount = 1;
+	Pipe->EndReadNow = false;
+	Pipe->DirectMdl = NULL;
+	Pipe->DirectOffset = 0;
+	Pipe->DirectEnd = 0;
 	KeInitializeMutex(&Pipe->Mutex, 0);
 	KeInitializeEvent(&Pipe->QueueEmptyEvent, EVENT_NOTIFICATION, false);
 	KeInitializeEvent(&Pipe->QueueFullEvent,  EVENT_NOTIFICATION, false);
+	KeInitializeEvent(&Pipe->DirectDoneEvent, EVENT_NOTIFICATION, false);
+}
+
+// Copies data out of the buffer published by a writer in IopWritePipeDirect,
+// straight into the reader's buffer.  Returns the number of bytes read.
+//
+// The pipe's mutex must be held.
+static size_t IopReadPipeDirect(PPIPE Pipe, PMDL MdlBuffer, size_t BytesRead, size_t* ByteCount, uint32_t Flags)
+{
+	size_t ReadSize = *ByteCount - BytesRead;
+	size_t AvailableData = Pipe->DirectEnd - Pipe->DirectOffset;
+	if (ReadSize > AvailableData)
+		ReadSize = AvailableData;
+	
+	if (Flags & IO_RW_FINISH_ON_NEWLINE)
+	{
+		// The writer's buffer can't be scanned in place, so scan it in small pieces.
+		char Chunk[64];
+		bool Found = false;
+		
+		for (size_t Scanned = 0; Scanned < ReadSize && !Found; Scanned += sizeof Chunk)
+		{
+			size_t ChunkSize = ReadSize - Scanned;
+			if (ChunkSize > sizeof Chunk)
+				ChunkSize = sizeof Chunk;
+			
+			MmCopyFromMdl(Pipe->DirectMdl, Pipe->DirectOffset + Scanned, Chunk, ChunkSize);
+			
+			for (size_t i = 0; i < ChunkSize; i++)
+			{
+				if (Chunk[i] != '\n' && Chunk[i] != '\r')
+					continue;
+				
+				// The read size should also include the newline in question.
+				ReadSize = Scanned + i + 1;
+				*ByteCount = BytesRead + ReadSize;
+				Found = true;
+				break;
+			}
+		}
+	}
+	
+	MmCopyMdlToMdl(MdlBuffer, BytesRead, Pipe->DirectMdl, Pipe->DirectOffset, ReadSize);
+	Pipe->DirectOffset += ReadSize;
+	
+	if (Pipe->DirectOffset == Pipe->DirectEnd)
+		KeSetEvent(&Pipe->DirectDoneEvent, PIPE_INCREMENT);
+	
+	return ReadSize;
+}
+
+// Hands the rest of a large write directly to the readers, and waits until they
+// have consumed all of it.  This way, each byte is copied once (from the writer's
+// pages to the reader's pages) instead of twice (through the ring buffer).
+//
+// The pipe's mutex must be held, and the ring buffer must be empty.  The mutex is
+// held again when this function returns, even if it fails.
+static BSTATUS IopWritePipeDirect(PPIPE Pipe, PMDL MdlBuffer, size_t* BytesWritten, size_t ByteCount)
+{
+	ASSERT(Pipe->Head == Pipe->Tail);
+	ASSERT(!Pipe->DirectMdl);
+	
+	Pipe->DirectMdl = MdlBuffer;
+	Pipe->DirectOffset = *BytesWritten;
+	Pipe->DirectEnd = ByteCount;
+	KeResetEvent(&Pipe->DirectDoneEvent);
+	
+	// Wake up any readers waiting for data.
+	KePulseEvent(&Pipe->QueueEmptyEvent, PIPE_INCREMENT);
+	IoNotifyReadinessFcb(Pipe->ReadableNotifyFcb, IO_COMPLETION_READABLE);
+	
+	KeReleaseMutexWait(&Pipe->Mutex);
+	BSTATUS Status = KeWaitForSingleObject(&Pipe->DirectDoneEvent, true, TIMEOUT_INFINITE, KeGetPreviousMode());
+	
+	// Even if the wait was interrupted, the buffer must be taken back before returning,
+	// because it's about to be freed.  So this wait must not be interrupted.
+	KeWaitForSingleObject(&Pipe->Mutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	
+	*BytesWritten = Pipe->DirectOffset;
+	Pipe->DirectMdl = NULL;
+	
+	if (*BytesWritten == ByteCount)
+		Status = STATUS_SUCCESS;
+	
+	// Let other writers, which were waiting for the buffer to be consumed, write.
+	KePulseEvent(&Pipe->QueueFullEvent, PIPE_INCREMENT);
+	IoNotifyReadinessFcb(Pipe->WritableNotifyFcb, IO_COMPLETION_WRITABLE);
+	return Status;
 }
 
 // Reads data from a pipe.
@@ -78,6 +193,14 @@ BSTATUS IopReadPipe(PIO_STATUS_BLOCK Iosb, PFCB Fcb, UNUSED uint64_t Offset, PMD
 	size_t ByteCount = MdlBuffer->ByteCount;
 	while (BytesRead < ByteCount)
 	{
+		// If a writer's buffer was handed over directly, read from it.  Once it has been
+		// consumed, the writer takes it back, so treat the pipe as empty until then.
+		if (Pipe->DirectMdl && Pipe->DirectOffset < Pipe->DirectEnd)
+		{
+			BytesRead += IopReadPipeDirect(Pipe, MdlBuffer, BytesRead, &ByteCount, Flags);
+			continue;
+		}
+		
 		if (Pipe->Head == Pipe->Tail)
 		{
 			// If the pipe has only one owner, return prematurely, otherwise a deadlock will ensue.
@@ -195,6 +318,7 @@ BSTATUS IopReadPipe(PIO_STATUS_BLOCK Iosb, PFCB Fcb, UNUSED uint64_t Offset, PMD
 		
 		// Since some data was consumed, signal writers to write
 		KePulseEvent(&Pipe->QueueFullEvent, PIPE_INCREMENT);
+		IoNotifyReadinessFcb(Pipe->WritableNotifyFcb, IO_COMPLETION_WRITABLE);
 	}
 	
 	Status = STATUS_SUCCESS;
@@ -235,8 +359,29 @@ BSTATUS IopWritePipe(PIO_STATUS_BLOCK Iosb, PFCB Fcb, UNUSED uint64_t Offset, PM
 	{
 		Iosb->BytesWritten = BytesWritten;
 		
+		// Large writes into an empty pipe are handed to the readers directly.  Only
+		// writes that don't fit into the ring buffer are, because those would have
+		// to wait for the readers anyway.
+		if (!Pipe->DirectMdl &&
+			Pipe->Head == Pipe->Tail &&
+			ByteCount - BytesWritten >= PIPE_DIRECT_THRESHOLD &&
+			ByteCount - BytesWritten >= Pipe->BufferSize &&
+			Pipe->ReferenceCount > 1 &&
+			!(Flags & IO_RW_NONBLOCK))
+		{
+			Status = IopWritePipeDirect(Pipe, MdlBuffer, &BytesWritten, ByteCount);
+			if (FAILED(Status))
+				goto FinishRelease;
+			
+			continue;
+		}
+		
 		size_t FreeSpace;
-		if (Pipe->Head >= Pipe->Tail)
+		if (Pipe->DirectMdl)
+			// Another writer's buffer is being read directly.  Writing to the
+			// ring buffer now would reorder the data, so wait for it to finish.
+			FreeSpace = 0;
+		else if (Pipe->Head >= Pipe->Tail)
 			FreeSpace = Pipe->BufferSize - 1 - (Pipe->Head - Pipe->Tail);
 		else
 			FreeSpace = Pipe->Tail - Pipe->Head - 1;
@@ -311,6 +456,7 @@ BSTATUS IopWritePipe(PIO_STATUS_BLOCK Iosb, PFCB Fcb, UNUSED uint64_t Offset, PM
 		
 		// Since some data was written, signal readers to read
 		KePulseEvent(&Pipe->QueueEmptyEvent, PIPE_INCREMENT);
+		IoNotifyReadinessFcb(Pipe->ReadableNotifyFcb, IO_COMPLETION_READABLE);
 	}
 	
 	Status = STATUS_SUCCESS;
@@ -321,6 +467,7 @@ BSTATUS IopWritePipe(PIO_STATUS_BLOCK Iosb, PFCB Fcb, UNUSED uint64_t Offset, PM
 	{
 		Pipe->EndReadNow = true;
 		KePulseEvent(&Pipe->QueueEmptyEvent, PIPE_INCREMENT);
+		IoNotifyReadinessFcb(Pipe->ReadableNotifyFcb, IO_COMPLETION_READABLE);
 	}
 	
 FinishRelease:
@@ -328,6 +475,7 @@ FinishRelease:
 	
 Finish:
 	Iosb->Status = Status;
+	Iosb->BytesWritten = BytesWritten;
 	
 	// Relock the rwlock because the caller expects us to do so.
 	IoLockFcbShared(Fcb);
@@ -345,11 +493,18 @@ void IopDereferencePipe(PFCB Fcb)
 {
 	PPIPE Pipe = (PPIPE) Fcb->Extension;
 	
-	if (AtAddFetch(Pipe->ReferenceCount, -1) == 0)
+	size_t ReferenceCount = AtAddFetch(Pipe->ReferenceCount, -1);
+	if (ReferenceCount == 0)
 	{
 		DbgPrint("IopDereferencePipe: Freeing pipe FCB");
 		IoFreeFcb(Fcb);
 	}
+	else if (ReferenceCount == 1)
+	{
+		// The other owner went away, so operations on the pipe no longer block.
+		IoNotifyReadinessFcb(Pipe->ReadableNotifyFcb, IO_COMPLETION_READABLE);
+		IoNotifyReadinessFcb(Pipe->WritableNotifyFcb, IO_COMPLETION_WRITABLE);
+	}
 }
 
 IO_DISPATCH_TABLE IopPipeDispatchTable =
@@ -375,7 +530,10 @@ BSTATUS IoCreatePipeObject(PFILE_OBJECT* OutFileObject, PFCB* OutFcb, POBJECT_AT
 	
 	// Initialize the pipe with the specified buffer size, create its corresponding
 	// file object, and then insert it into the handle table.
-	IopInitializePipe((PPIPE) Fcb->Extension, BufferSize);
+	PPIPE Pipe = (PPIPE) Fcb->Extension;
+	IopInitializePipe(Pipe, BufferSize);
+	Pipe->ReadableNotifyFcb = Fcb;
+	Pipe->WritableNotifyFcb = Fcb;
 	
 	BSTATUS Status = IoCreateFileObject(Fcb, OutFileObject, 0, 0);
 	if (FAILED(Status))
@@ -388,6 +546,14 @@ BSTATUS IoCreatePipeObject(PFILE_OBJECT* OutFileObject, PFCB* OutFcb, POBJECT_AT
 	return Status;
 }
 
+void IoSetNotifyFcbsPipe(PFCB PipeFcb, PFCB ReadableNotifyFcb, PFCB WritableNotifyFcb)
+{
+	PPIPE Pipe = (PPIPE) PipeFcb->Extension;
+	
+	Pipe->ReadableNotifyFcb = ReadableNotifyFcb;
+	Pipe->WritableNotifyFcb = WritableNotifyFcb;
+}
+
 BSTATUS IoCreatePipe(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, size_t BufferSize)
 {
 	PFCB Fcb = NULL;
@@ -378,6 +378,10 @@ static BSTATUS IopWriteFile(PIO_STATUS_BLOCK Iosb, PFILE_OBJECT FileObject, PMDL
 		KeReleaseMutex(&FileObject->FileOffsetMutex);
 	}
 	
+	// Image sections built from the old contents of the file must not be handed out
+	// anymore.  This is also done if the write failed, because it may have failed halfway.
+	MmInvalidateImageSections(FileObject->Fcb);
+	
 	return Status;
 }
 
@@ -427,6 +431,19 @@ BSTATUS IoPerformPagingRead(
 	return IopReadFile(Iosb, FileObject, Mdl, IO_RW_PAGING, FileOffset, false, &Unused);
 }
 
+BSTATUS IoPerformPagingWrite(
+	PIO_STATUS_BLOCK Iosb,
+	PFILE_OBJECT FileObject,
+	PMDL Mdl,
+	uint64_t FileOffset
+)
+{
+	ASSERT(FileObject->Fcb);
+	
+	uint64_t Unused;
+	return IopWriteFile(Iosb, FileObject, Mdl, IO_RW_PAGING, FileOffset, false, &Unused);
+}
+
 BSTATUS IoPerformOperationFileHandle(
 	PIO_STATUS_BLOCK Iosb, 
 	HANDLE Handle,
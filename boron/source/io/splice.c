@@ -0,0 +1,227 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	io/splice.c
+	
+Abstract:
+	This module implements the splice operation, which moves
+	data from one file object to another (for example, from a
+	file to a pipe) without passing it through user space.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "iop.h"
+
+// The size of the kernel buffer which the data passes through.
+#define SPLICE_BUFFER_SIZE (64 * 1024)
+
+// Reads or writes one chunk of a splice through the splice buffer.
+static BSTATUS IopSpliceTransfer(
+	PIO_STATUS_BLOCK Iosb,
+	PFILE_OBJECT FileObject,
+	uint64_t* Offset,
+	void* Buffer,
+	size_t Size,
+	uint32_t Flags,
+	bool IsWrite
+)
+{
+	PMDL Mdl;
+	BSTATUS Status = MmCreateMdl(&Mdl, (uintptr_t) Buffer, Size, MODE_KERNEL, !IsWrite);
+	if (FAILED(Status))
+		return IOSB_STATUS(Iosb, Status);
+	
+	uint64_t FileOffset = 0;
+	if (Offset)
+		FileOffset = *Offset;
+	else
+		Flags |= IO_RW_SHARED_FILE_OFFSET;
+	
+	if (IsWrite)
+		Status = IoWriteFileMdl(Iosb, FileObject, Mdl, Flags, FileOffset, true);
+	else
+		Status = IoReadFileMdl(Iosb, FileObject, Mdl, Flags, FileOffset, true);
+	
+	MmFreeMdl(Mdl);
+	
+	if (Offset)
+		*Offset += Iosb->BytesRead;
+	
+	return Status;
+}
+
+// Moves the input back over data which was read, but which the output didn't take,
+// so that the next read gets it again.  Data read from a file which isn't seekable,
+// such as a pipe, can't be put back.
+static void IopSpliceUnread(PFILE_OBJECT FileObject, uint64_t* Offset, size_t Size)
+{
+	if (!IoIsSeekable(FileObject->Fcb))
+		return;
+	
+	if (Offset)
+	{
+		*Offset -= Size;
+		return;
+	}
+	
+	// This wait isn't alertable, so it can't fail.
+	(void) KeWaitForSingleObject(&FileObject->FileOffsetMutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	FileObject->CurrentFileOffset -= Size;
+	KeReleaseMutex(&FileObject->FileOffsetMutex);
+}
+
+BSTATUS IoSpliceFile(
+	PIO_STATUS_BLOCK Iosb,
+	PFILE_OBJECT InputFile,
+	uint64_t* InputOffset,
+	PFILE_OBJECT OutputFile,
+	uint64_t* OutputOffset,
+	size_t Length,
+	uint32_t Flags
+)
+{
+	Iosb->BytesWritten = 0;
+	
+	size_t BufferSize = Length < SPLICE_BUFFER_SIZE ? Length : SPLICE_BUFFER_SIZE;
+	if (BufferSize == 0)
+		return IOSB_STATUS(Iosb, STATUS_SUCCESS);
+	
+	void* Buffer = MmAllocatePool(POOL_NONPAGED, BufferSize);
+	if (!Buffer)
+		return IOSB_STATUS(Iosb, STATUS_INSUFFICIENT_MEMORY);
+	
+	BSTATUS Status = STATUS_SUCCESS;
+	size_t Transferred = 0;
+	
+	while (Transferred < Length)
+	{
+		size_t ChunkSize = Length - Transferred;
+		if (ChunkSize > BufferSize)
+			ChunkSize = BufferSize;
+		
+		// Take whatever is available, but wait if nothing is.  Without this, a
+		// splice from a pipe would wait until the whole chunk was filled.
+		IO_STATUS_BLOCK ReadIosb;
+		Status = IopSpliceTransfer(&ReadIosb, InputFile, InputOffset, Buffer, ChunkSize, Flags | IO_RW_NONBLOCK_UNLESS_EMPTY, false);
+		
+		size_t BytesRead = ReadIosb.BytesRead;
+		if (BytesRead == 0)
+		{
+			// Reaching the end of the input isn't an error if some data was moved.
+			if (Status == STATUS_END_OF_FILE && Transferred != 0)
+				Status = STATUS_SUCCESS;
+			
+			break;
+		}
+		
+		IO_STATUS_BLOCK WriteIosb;
+		Status = IopSpliceTransfer(&WriteIosb, OutputFile, OutputOffset, Buffer, BytesRead, Flags & ~IO_RW_NONBLOCK, true);
+		
+		Transferred += WriteIosb.BytesWritten;
+		
+		// A short write stops the splice, and the input is rewound to just after the
+		// last byte which was written.
+		if (WriteIosb.BytesWritten < BytesRead)
+		{
+			IopSpliceUnread(InputFile, InputOffset, BytesRead - WriteIosb.BytesWritten);
+			break;
+		}
+		
+		if (FAILED(Status))
+			break;
+		
+		// A short read means that the input was drained, either because the end of
+		// the file was reached or because a pipe had no more data in it for now.
+		if (BytesRead < ChunkSize)
+			break;
+	}
+	
+	MmFreePool(Buffer);
+	
+	Iosb->BytesWritten = Transferred;
+	return IOSB_STATUS(Iosb, Status);
+}
+
+BSTATUS OSSpliceFile(
+	PIO_STATUS_BLOCK Iosb,
+	HANDLE InputHandle,
+	uint64_t* InputOffset,
+	HANDLE OutputHandle,
+	uint64_t* OutputOffset,
+	size_t Length,
+	uint32_t Flags
+)
+{
+	BSTATUS Status;
+	KPROCESSOR_MODE Mode = KeGetPreviousMode();
+	
+	if (Mode == MODE_USER)
+		Flags &= ~IO_RW_USER_MODE_FORBIDDEN_FLAGS;
+	
+	// The offsets are copied in, and the advanced offsets are copied back out.
+	uint64_t InputOffsetCopy = 0, OutputOffsetCopy = 0;
+	
+	if (InputOffset)
+	{
+		Status = MmSafeCopy(&InputOffsetCopy, InputOffset, sizeof(uint64_t), Mode, false);
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	if (OutputOffset)
+	{
+		Status = MmSafeCopy(&OutputOffsetCopy, OutputOffset, sizeof(uint64_t), Mode, false);
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	void* InputFileV;
+	Status = ObReferenceObjectByHandle(InputHandle, IoFileType, &InputFileV);
+	if (FAILED(Status))
+		return Status;
+	
+	void* OutputFileV;
+	Status = ObReferenceObjectByHandle(OutputHandle, IoFileType, &OutputFileV);
+	if (FAILED(Status))
+	{
+		ObDereferenceObject(InputFileV);
+		return Status;
+	}
+	
+	IO_STATUS_BLOCK Iosb2;
+	Status = IoSpliceFile(
+		&Iosb2,
+		InputFileV,
+		InputOffset ? &InputOffsetCopy : NULL,
+		OutputFileV,
+		OutputOffset ? &OutputOffsetCopy : NULL,
+		Length,
+		Flags
+	);
+	
+	ObDereferenceObject(OutputFileV);
+	ObDereferenceObject(InputFileV);
+	
+	BSTATUS Status2 = MmSafeCopy(Iosb, &Iosb2, sizeof(IO_STATUS_BLOCK), Mode, true);
+	if (FAILED(Status2))
+		return Status2;
+	
+	if (InputOffset)
+	{
+		Status2 = MmSafeCopy(InputOffset, &InputOffsetCopy, sizeof(uint64_t), Mode, true);
+		if (FAILED(Status2))
+			return Status2;
+	}
+	
+	if (OutputOffset)
+	{
+		Status2 = MmSafeCopy(OutputOffset, &OutputOffsetCopy, sizeof(uint64_t), Mode, true);
+		if (FAILED(Status2))
+			return Status2;
+	}
+	
+	return Status;
+}
@@ -132,6 +132,59 @@ static void KepSetupTss(KTSS* Tss)
 	memset(Tss, 0, sizeof * Tss);
 }
 
+void KeCpuid(PCPUID_OUTPUT Output, uint32_t Eax);
+void KeCpuidEx(PCPUID_OUTPUT Output, uint32_t Eax, uint32_t Ecx);
+
+static int KepGetTopologyShift(uint32_t Count)
+{
+	int Shift = 0;
+	while ((1U << Shift) < Count)
+		Shift++;
+	
+	return Shift;
+}
+
+// Figures out which package the current processor is on, and which other
+// processors it shares its last level cache with, from its APIC ID.
+INIT
+static void KepSetupTopology()
+{
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	CPUID_OUTPUT Cpuid;
+	
+	KeCpuid(&Cpuid, 0x0);
+	uint32_t MaxLeaf = Cpuid.Bare.Eax;
+	
+	// The highest bits of the APIC ID identify the package.  CPUID leaf 1
+	// tells us how many logical processors a package can contain.
+	int PackageShift = 0;
+	KeCpuid(&Cpuid, 0x1);
+	if (Cpuid.Eax01H.Edx.Htt)
+		PackageShift = KepGetTopologyShift((Cpuid.Bare.Ebx >> 16) & 0xFF);
+	
+	// The deterministic cache parameters leaf tells us how many logical processors
+	// share each cache.  Caches are listed in increasing level order, so the last one
+	// is the last level cache.  If this leaf isn't supported (for example on AMD), then
+	// assume that the whole package shares its last level cache.
+	int CacheShift = PackageShift;
+	if (MaxLeaf >= 0x4)
+	{
+		for (uint32_t Index = 0; Index < 16; Index++)
+		{
+			KeCpuidEx(&Cpuid, 0x4, Index);
+			
+			// A cache type of zero means there are no more caches.
+			if ((Cpuid.Bare.Eax & 0x1F) == 0)
+				break;
+			
+			CacheShift = KepGetTopologyShift(((Cpuid.Bare.Eax >> 14) & 0xFFF) + 1);
+		}
+	}
+	
+	Prcb->PackageId = Prcb->LapicId >> PackageShift;
+	Prcb->CacheId   = Prcb->LapicId >> CacheShift;
+}
+
 extern void KiSystemServiceHandler();
 
 INIT
@@ -183,6 +236,8 @@ void KeInitCPU()
 	ASM("fninit":::"memory");
 	
 	// TODO: enable xsave
+	
+	KepSetupTopology();
 }
 
 extern uintptr_t KiSystemServiceTable[];
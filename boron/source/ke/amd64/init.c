@@ -15,9 +15,11 @@ Author:
 #include <ke.h>
 #include <hal.h>
 #include "archi.h"
+#include "../ki.h"
 
 int KiVectorCrash,
-    KiVectorTlbShootdown;
+    KiVectorTlbShootdown,
+    KiVectorDpcIpi;
 
 // Used by drivers.  The kernel uses the values directly.
 int KeGetSystemInterruptVector(int Number)
@@ -31,6 +33,35 @@ int KeGetSystemInterruptVector(int Number)
 	}
 }
 
+// Sent to processors whose tick may be stopped, when they have to reschedule,
+// and to processors which had a DPC targeted at them.  In the latter case, the
+// sender has already marked the DPC software interrupt as pending, and it is
+// dispatched once this interrupt returns.
+PKREGISTERS KiHandleDpcIpi(PKREGISTERS Regs)
+{
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	
+	bool Reschedule = false, Requested;
+	AtExchange(Prcb->RescheduleRequested, Reschedule, Requested);
+	
+	if (Requested)
+		KiSetPendingQuantumEnd();
+	
+	HalEndOfInterrupt((int) Regs->IntNumber);
+	return Regs;
+}
+
+void KiSendRescheduleIpi(PKPRCB Prcb)
+{
+	AtStore(Prcb->RescheduleRequested, true);
+	HalRequestIpi(Prcb->LapicId, 0, KiVectorDpcIpi);
+}
+
+void KiSendDpcIpi(PKPRCB Prcb)
+{
+	HalRequestIpi(Prcb->LapicId, 0, KiVectorDpcIpi);
+}
+
 void KiSetupIdt();
 
 INIT
@@ -42,9 +73,11 @@ void KeInitArchUP()
 	// Initialize interrupt vectors for certain things
 	KiVectorCrash        = KeAllocateInterruptVector(IPL_NOINTS);
 	KiVectorTlbShootdown = KeAllocateInterruptVector(IPL_NOINTS);
+	KiVectorDpcIpi       = KeAllocateInterruptVector(IPL_CLOCK);
 	
 	KeRegisterInterrupt(KiVectorTlbShootdown, KiHandleTlbShootdownIpiA);
 	KeRegisterInterrupt(KiVectorCrash,        KiHandleCrashIpi);
+	KeRegisterInterrupt(KiVectorDpcIpi,       KiHandleDpcIpi);
 	
 	KiInitializeInterruptSystem();
 }
@@ -211,6 +211,23 @@ KeCpuid:
 	pop  rbx
 	ret
 
+; void KeCpuidEx(PCPUID_OUTPUT Output, uint32_t Eax, uint32_t Ecx)
+global KeCpuidEx
+KeCpuidEx:
+	push rbx
+	
+	mov eax, esi
+	mov ecx, edx
+	cpuid
+	
+	mov  dword [rdi + 0],  eax
+	mov  dword [rdi + 4],  ebx
+	mov  dword [rdi + 8],  ecx
+	mov  dword [rdi + 12], edx
+	
+	pop  rbx
+	ret
+
 ; void KiFxsave()
 global KiFxsave
 KiFxsave:
@@ -20,16 +20,19 @@ bits 64
 
 ; *** SYSTEM SERVICE TABLE ***
 extern OSAllocateVirtualMemory
+extern OSAssociateCompletionPort
 extern OSCheckIsTerminalFile
 extern OSCheckIsValidHandle
 extern OSClose
 extern OSCloseAllUninheritableHandles
+extern OSCreateCompletionPort
 extern OSCreateDirectory
 extern OSCreateEvent
 extern OSCreateFile
 extern OSCreateMutex
 extern OSCreatePipe
 extern OSCreateProcess
+extern OSCreateSectionObject
 extern OSCreateSymbolicLink
 extern OSCreateTerminal
 extern OSCreateTerminalIoHandles
@@ -49,11 +52,13 @@ extern OSGetMappedFileHandle
 extern OSGetTickCount
 extern OSGetTickFrequency
 extern OSGetVersionNumber
+extern OSLookUpImageSection
 extern OSMapViewOfObject
 extern OSOpenEvent
 extern OSOpenFile
 extern OSOpenMutex
 extern OSOutputDebugString
+extern OSPostCompletionPort
 extern OSPulseEvent
 extern OSQueryEvent
 extern OSQueryMutex
@@ -62,6 +67,7 @@ extern OSQueryVirtualMemoryInformation
 extern OSReadDirectoryEntries
 extern OSReadFile
 extern OSReadVirtualMemory
+extern OSRemoveCompletionPort
 extern OSReleaseMutex
 extern OSResetEvent
 extern OSSeekFile
@@ -74,6 +80,8 @@ extern OSSetPebProcess
 extern OSSetSuspendedThread
 extern OSShutDownSystem
 extern OSSleep
+extern OSSpawnProcess
+extern OSSpliceFile
 extern OSTerminateThread
 extern OSTouchFile
 extern OSWaitForMultipleObjects
@@ -145,6 +153,14 @@ KiSystemServiceTable:
 	dq OSSetImageNameProcess
 	dq OSQuerySystemInformation
 	dq OSShutDownSystem
+	dq OSCreateSectionObject
+	dq OSLookUpImageSection
+	dq OSSpawnProcess
+	dq OSSpliceFile
+	dq OSCreateCompletionPort
+	dq OSAssociateCompletionPort
+	dq OSPostCompletionPort
+	dq OSRemoveCompletionPort
 KiSystemServiceTableEnd:
 	nop
 
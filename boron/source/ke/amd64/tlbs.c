@@ -70,9 +70,14 @@ void KeIssueTLBShootDown(uintptr_t Address, size_t Length)
 #endif
 	
 	// Invalidate the pages on the local CPU
-	for (size_t i = 0; i < Length; i++)
+	if (Length >= MAX_TLBS_LENGTH)
 	{
-		KeInvalidatePage((void*)(Address + i * PAGE_SIZE));
+		KeSetCurrentPageTable(KeGetCurrentPageTable());
+	}
+	else
+	{
+		for (size_t i = 0; i < Length; i++)
+			KeInvalidatePage((void*)(Address + i * PAGE_SIZE));
 	}
 	
 	// If we are the only processor, return
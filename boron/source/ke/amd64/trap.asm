@@ -23,7 +23,7 @@ global KiTrapCallList
 
 section .text
 
-; int KiEnterHardwareInterrupt(int IntNo);
+; int KiEnterHardwareInterrupt(int NewIpl, int Vector);
 extern KiEnterHardwareInterrupt
 ; void KiExitHardwareInterrupt(int OldIpl);
 extern KiExitHardwareInterrupt
@@ -110,6 +110,7 @@ KiTrapCommon:
 	push  rbp                              ; Coincidentally, this stack frame is 16 bytes, so we're already properly aligned.
 	mov   rbp, rsp                         ; Finally, use the new aligned RSP.
 	movsx rdi, byte [KiTrapIplList + rbx]  ; Get the IPL for the respective interrupt vector
+	mov   rsi, rbx                         ; Pass the interrupt vector too, for statistics
 	call  KiEnterHardwareInterrupt         ; Tell the kernel we entered a hardware interrupt
 	mov   [r12], rax                       ; Write the old IPL that we obtained from the function
 	mov   rdi, r12                         ; Prepare the PKREGISTERS to call the trap handler
@@ -145,12 +146,21 @@ KiHandleTlbShootdownIpiA:
 	
 	; note: count may never be zero - ensured by KeIssueTLBShootDown
 	mov  rcx, [gs:0x08]
+	
+	; if the range is too big (MAX_TLBS_LENGTH in tlbs.c), flush everything instead
+	cmp  rcx, 4096
+	jb   .loop
+	mov  rax, cr3
+	mov  cr3, rax
+	jmp  .done
+	
 .loop:
 	invlpg [rax]
 	add  rax, 4096
 	dec  rcx
 	jnz  .loop
 	
+.done:
 	; done invalidating, clear the spinlock to 0
 	mov  byte [gs:0x10], 0
 	
@@ -18,6 +18,7 @@ Author:
 #include <hal.h>
 #include <except.h>
 #include "../../ke/ki.h"
+#include "archi.h"
 
 // The trap gate isn't likely to be used as it doesn't turn off
 // interrupts when entering the interrupt handler.
@@ -99,10 +100,19 @@ static void KiLoadInterruptVector(PKIDT Idt, int Vector, KiInterruptVector Handl
 	Entry->Present = true;
 }
 
-int KiEnterHardwareInterrupt(int NewIpl)
+int KiEnterHardwareInterrupt(int NewIpl, int Vector)
 {
 	PKPRCB Prcb = KeGetCurrentPRCB();
 	
+	// Exceptions aren't counted as interrupts.
+	if (Vector >= 0x20)
+	{
+		KeStatsAddInterrupt();
+		
+		if (Vector == KiVectorTlbShootdown || Vector == KiVectorCrash || Vector == KiVectorDpcIpi)
+			KeStatsAddIpi();
+	}
+	
 	PKIPL IplPtr = &Prcb->Ipl;
 	
 	// grab old IPL
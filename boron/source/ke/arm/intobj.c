@@ -147,6 +147,8 @@ void KeDispatchInterruptRequest(int Number)
 	PINTERRUPT_LIST InterruptList = &KiInterruptList[Number];
 	KIPL Ipl;
 	
+	KeStatsAddInterrupt();
+	
 	KeAcquireSpinLock(&InterruptList->Lock, &Ipl);
 	
 	for (PLIST_ENTRY Entry = InterruptList->List.Flink;
@@ -157,8 +159,16 @@ void KeDispatchInterruptRequest(int Number)
 		KIPL Unused;
 		KeAcquireSpinLock(Interrupt->SpinLock, &Unused);
 		
+#ifdef DPC_STATISTICS
+		uint64_t StartTime = KeDpcStatGetTime();
+#endif
+		
 		Interrupt->ServiceRoutine(Interrupt, Interrupt->ServiceContext);
 		
+#ifdef DPC_STATISTICS
+		KeDpcStatRecordInterrupt(Number, (uintptr_t) Interrupt->ServiceRoutine, StartTime);
+#endif
+		
 		KeReleaseSpinLock(Interrupt->SpinLock, Unused);
 	}
 	
@@ -124,6 +124,14 @@ const void* const KiSystemServiceTable[] =
 	OSSetImageNameProcess,
 	OSQuerySystemInformation,
 	OSShutDownSystem,
+	OSCreateSectionObject,
+	OSLookUpImageSection,
+	OSSpawnProcess,
+	OSSpliceFile,
+	OSCreateCompletionPort,
+	OSAssociateCompletionPort,
+	OSPostCompletionPort,
+	OSRemoveCompletionPort,
 };
 
 #define KI_SYSCALL_COUNT ARRAY_COUNT(KiSystemServiceTable)
@@ -27,14 +27,14 @@ NO_DISCARD
 KIPL KiLockDispatcher()
 {
 	KIPL Ipl;
-	KeAcquireSpinLock(&KiDispatcherLock, &Ipl);
+	KiAcquireSpinLockAt(&KiDispatcherLock, &Ipl, CallerAddress());
 	return Ipl;
 }
 
 void KiLockDispatcherWait()
 {
 	KIPL Ipl;
-	KeAcquireSpinLock(&KiDispatcherLock, &Ipl);
+	KiAcquireSpinLockAt(&KiDispatcherLock, &Ipl, CallerAddress());
 	
 	PKTHREAD Thread = KeGetCurrentThread();
 	Thread->DidCallWaitFunction = true;
@@ -80,6 +80,14 @@ bool KiIsObjectSignaled(PKDISPATCH_HEADER Header, PKTHREAD Thread)
 		return Mutex->OwnerThread == Thread;
 	}
 	
+	if (Header->Type == DISPATCH_QUEUE)
+	{
+		// A queue doesn't hand out entries while too many of its threads are running.
+		PKQUEUE Queue = (PKQUEUE) Header;
+		
+		return Header->Signaled != 0 && Queue->CurrentCount < Queue->MaximumCount;
+	}
+	
 	// default case
 	return Header->Signaled != 0;
 }
@@ -124,6 +132,11 @@ static void KiAcquireObject(PKDISPATCH_HEADER Object, PKTHREAD Thread)
 			if (OldSignaled == MUTEX_SIGNALED)
 			{
 				InsertHeadList(&Thread->MutexList, &Mutex->MutexListEntry);
+				
+			#ifdef LOCK_STATISTICS
+				Mutex->StatClass = KeLockStatGetClass(Thread->WaitCallSite, LOCK_TYPE_MUTEX);
+				Mutex->AcquiredAt = KeLockStatRecordAcquire(Mutex->StatClass, Thread->WaitStartTime);
+			#endif
 			}
 			
 			// In effect, this means that the mutex list is always ordered
@@ -143,6 +156,17 @@ static void KiAcquireObject(PKDISPATCH_HEADER Object, PKTHREAD Thread)
 			break;
 		}
 		
+		case DISPATCH_QUEUE: {
+			
+			// Claim an entry.  The thread removes it from the queue in KeRemoveQueue,
+			// and counts toward the queue's limit until it blocks again.
+			PKQUEUE Queue = (PKQUEUE) Object;
+			
+			Object->Signaled--;
+			Queue->CurrentCount++;
+			break;
+		}
+		
 		default:
 			// Object remains signaled
 			break;
@@ -172,6 +196,10 @@ static bool KepSatisfiedEnough(PKDISPATCH_HEADER Object, int SatisfiedCount)
 		case DISPATCH_SEMAPHORE:
 			return Object->Signaled == 0;
 		
+		// A queue can only be acquired if it has entries and its limit allows it.
+		case DISPATCH_QUEUE:
+			return !KiIsObjectSignaled(Object, NULL);
+		
 		// An event depends on its subtype.
 		case DISPATCH_EVENT: {
 			PKEVENT Event = (PKEVENT)Object;
@@ -218,20 +246,27 @@ static void KepWaitTimerExpiry(UNUSED PKDPC Dpc, void* Context, UNUSED void* SA1
 	KiUnlockDispatcher(Ipl);
 }
 
-BSTATUS KeWaitForMultipleObjects(
+static BSTATUS KepWaitForMultipleObjects(
 	int Count,
 	void* Objects[],
 	int WaitType,
 	bool Alertable,
 	int TimeoutMS,
 	PKWAIT_BLOCK WaitBlockArray,
-	KPROCESSOR_MODE WaitMode)
+	KPROCESSOR_MODE WaitMode,
+	UNUSED uintptr_t CallSite)
 {
 	ASSERT(WaitType == WAIT_TYPE_ALL || WaitType == WAIT_TYPE_ANY);
 	
 	BSTATUS Status = STATUS_SUCCESS;
 	PKTHREAD Thread = KeGetCurrentThread();
 	
+	// If this thread is associated with a queue, it stops counting toward the queue's
+	// concurrency limit while it's blocked, unless it's waiting on the queue itself.
+	PKQUEUE Queue = NULL;
+	if (Thread->Queue && !(Count == 1 && Objects[0] == Thread->Queue))
+		Queue = Thread->Queue;
+	
 	int Maximum = MAXIMUM_WAIT_BLOCKS;
 	
 	if (!WaitBlockArray)
@@ -261,6 +296,11 @@ BSTATUS KeWaitForMultipleObjects(
 		Ipl = KiLockDispatcher();
 	}
 	
+#ifdef LOCK_STATISTICS
+	Thread->WaitCallSite = CallSite;
+	Thread->WaitStartTime = 0;
+#endif
+	
 	while (true)
 	{
 		// Am I dead though?!
@@ -325,6 +365,11 @@ BSTATUS KeWaitForMultipleObjects(
 		}
 		
 		// Ok, finally handling the non-trivial case.
+	#ifdef LOCK_STATISTICS
+		if (!Thread->WaitStartTime)
+			Thread->WaitStartTime = KeLockStatGetTime();
+	#endif
+		
 		// Insert each block into the object's wait block queue.
 		for (int i = 0; i < Count; i++)
 		{
@@ -341,6 +386,7 @@ BSTATUS KeWaitForMultipleObjects(
 		Thread->WaitStatus = STATUS_WAITING;
 		Thread->WaitMode = WaitMode;
 		Thread->Status = KTHREAD_STATUS_WAITING;
+		Thread->WaitStartedAt = HalGetTickCount();
 		
 		// Note, surely it's not zero, because we guard against that
 		if (TimeoutMS != TIMEOUT_INFINITE)
@@ -353,6 +399,10 @@ BSTATUS KeWaitForMultipleObjects(
 			KiSetTimer(&Thread->WaitTimer, TimeoutMS, &Thread->WaitDpc);
 		}
 		
+		// Let another thread waiting on our queue run in our place.
+		if (Queue)
+			KiActivateWaiterQueue(Queue);
+		
 		// Yield in order to start waiting on the object(s). However, we must initiate
 		// the yield with the dispatcher lock held, to prevent DPCs and work-stealing
 		// APs from showing up until this thread has been completely scheduled out.
@@ -364,6 +414,11 @@ BSTATUS KeWaitForMultipleObjects(
 		
 		// Fetch the wait status.
 		Status = Thread->WaitStatus;
+		
+		// Count toward the queue's limit again, unless the queue was run down meanwhile.
+		if (Queue && Thread->Queue == Queue)
+			Queue->CurrentCount++;
+		
 		KiUnlockDispatcher(Ipl);
 		
 		ASSERT(Alertable || Status != STATUS_ALERTED);
@@ -402,9 +457,30 @@ BSTATUS KeWaitForMultipleObjects(
 	return Status;
 }
 
+BSTATUS KeWaitForMultipleObjects(
+	int Count,
+	void* Objects[],
+	int WaitType,
+	bool Alertable,
+	int TimeoutMS,
+	PKWAIT_BLOCK WaitBlockArray,
+	KPROCESSOR_MODE WaitMode)
+{
+	return KepWaitForMultipleObjects(
+		Count,
+		Objects,
+		WaitType,
+		Alertable,
+		TimeoutMS,
+		WaitBlockArray,
+		WaitMode,
+		CallerAddress()
+	);
+}
+
 BSTATUS KeWaitForSingleObject(void* Object, bool Alertable, int TimeoutMS, KPROCESSOR_MODE WaitMode)
 {
-	BSTATUS Status = KeWaitForMultipleObjects(1, &Object, WAIT_TYPE_ANY, Alertable, TimeoutMS, NULL, WaitMode);
+	BSTATUS Status = KepWaitForMultipleObjects(1, &Object, WAIT_TYPE_ANY, Alertable, TimeoutMS, NULL, WaitMode, CallerAddress());
 	
 	// Instead of returning wait range, like multiple objects would, return success.
 	if (Status == STATUS_WAIT(0))
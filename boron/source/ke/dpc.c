@@ -15,6 +15,7 @@ Author:
 #include "ki.h"
 #include <arch.h>
 #include <hal.h>
+#include <mm.h>
 
 void KeInitializeDpc(PKDPC Dpc, PKDEFERRED_ROUTINE Routine, void* Context)
 {
@@ -26,11 +27,21 @@ void KeInitializeDpc(PKDPC Dpc, PKDEFERRED_ROUTINE Routine, void* Context)
 	
 	Dpc->Important = false;
 	
+	Dpc->Threaded = false;
+	
+	Dpc->TargetProcessor = DPC_TARGET_CURRENT;
+	
 	Dpc->DeferredContext = Context;
 	
 	Dpc->Initialized = true;
 }
 
+void KeInitializeThreadedDpc(PKDPC Dpc, PKDEFERRED_ROUTINE Routine, void* Context)
+{
+	KeInitializeDpc(Dpc, Routine, Context);
+	Dpc->Threaded = true;
+}
+
 // IPL: Any.
 
 // Note: This must be called BEFORE KeEnqueueDpc.  Calling this after enqueuing
@@ -41,45 +52,123 @@ void KeSetImportantDpc(PKDPC Dpc, bool Important)
 	Dpc->Important = Important;
 }
 
-// IPL: Any.
-void KeEnqueueDpc(PKDPC Dpc, void* SysArg1, void* SysArg2)
+// IPL: Any.  Same note as KeSetImportantDpc applies.
+void KeSetTargetProcessorDpc(PKDPC Dpc, int Processor)
 {
-	PKDPC_QUEUE Queue = &KeGetCurrentPRCB()->DpcQueue;
+	ASSERT(Processor == DPC_TARGET_CURRENT || (Processor >= 0 && Processor < KeGetProcessorCount()));
+	Dpc->TargetProcessor = Processor;
+}
+
+// The DPC queue locks are only held with interrupts disabled, so, unlike
+// KeAcquireSpinLock, these don't touch the IPL.
+static void KepLockDpcQueue(PKDPC_QUEUE Queue)
+{
+	while (AtTestAndSetMO(Queue->Lock.Locked, ATOMIC_MEMORD_ACQUIRE))
+	{
+		while (Queue->Lock.Locked)
+			KeSpinningHint();
+	}
+}
+
+static void KepUnlockDpcQueue(PKDPC_QUEUE Queue)
+{
+	AtClearMO(Queue->Lock.Locked, ATOMIC_MEMORD_RELEASE);
+}
+
+// Inserts a DPC into a queue.  Returns false if the DPC was enqueued already,
+// possibly in a different queue.  Interrupts must be disabled.
+static bool KepInsertQueueDpc(PKDPC_QUEUE Queue, PKDPC Dpc, void* SysArg1, void* SysArg2)
+{
+	bool Expected = false;
+	if (!AtCompareExchange(&Dpc->Enqueued, &Expected, true))
+		return false;
+	
+	Dpc->SystemArgument1 = SysArg1;
+	Dpc->SystemArgument2 = SysArg2;
+	
+#ifdef DPC_STATISTICS
+	Dpc->EnqueuedTime = KeDpcStatGetTime();
+#endif
+	
+	KepLockDpcQueue(Queue);
+	
+	if (Dpc->Important)
+		InsertHeadList(&Queue->List, &Dpc->List);
+	else
+		InsertTailList(&Queue->List, &Dpc->List);
 	
-	bool IsImportant = false;
+	KepUnlockDpcQueue(Queue);
+	return true;
+}
+
+// Pops the first DPC off of a queue, and makes a copy of it, as it might be
+// re-enqueued again as soon as it's off, destroying the context.  Interrupts
+// must be disabled.
+static PKDPC KepRemoveQueueDpc(PKDPC_QUEUE Queue, PKDPC Copy)
+{
+	KepLockDpcQueue(Queue);
 	
+	if (IsListEmpty(&Queue->List))
+	{
+		KepUnlockDpcQueue(Queue);
+		return NULL;
+	}
+	
+	PLIST_ENTRY Entry = RemoveHeadList(&Queue->List);
+	PKDPC Dpc = CONTAINING_RECORD(Entry, KDPC, List);
+	
+	*Copy = *Dpc;
+	AtStore(Dpc->Enqueued, false);
+	
+	KepUnlockDpcQueue(Queue);
+	return Dpc;
+}
+
+// IPL: Any.
+void KeEnqueueDpc(PKDPC Dpc, void* SysArg1, void* SysArg2)
+{
 	// Disable interrupts to prevent them from using the incompletely
 	// manipulated DPC queue.
 	bool Restore = KeDisableInterrupts();
 	
+	PKPRCB CurrentPrcb = KeGetCurrentPRCB();
+	PKPRCB Prcb = CurrentPrcb;
+	
+	if (Dpc->TargetProcessor != DPC_TARGET_CURRENT)
+		Prcb = KeProcessorList[Dpc->TargetProcessor];
+	
+	PKDPC_QUEUE Queue = Dpc->Threaded ? &Prcb->ThreadedDpcQueue : &Prcb->DpcQueue;
+	
 	// If the DPC has been enqueued already, then return early.
 	// This allows an interrupt handler to avoid checking whether the DPC was enqueued by itself.
-	if (Dpc->Enqueued)
+	if (!KepInsertQueueDpc(Queue, Dpc, SysArg1, SysArg2))
 	{
 		KeRestoreInterrupts(Restore);
 		return;
 	}
 	
-	Dpc->SystemArgument1 = SysArg1;
-	Dpc->SystemArgument2 = SysArg2;
-	
-	Dpc->Enqueued = true;
+	// The threaded DPC thread is woken up from a regular DPC on its processor,
+	// because the dispatcher lock can't be taken at any IPL.
+	if (Dpc->Threaded)
+		KepInsertQueueDpc(&Prcb->DpcQueue, &Prcb->ThreadedDpcWakeDpc, NULL, NULL);
 	
-	IsImportant = Dpc->Important;
+	bool RunNow = Dpc->Important && !Dpc->Threaded && Prcb == CurrentPrcb;
 	
-	// Append the element into the queue.
-	if (Dpc->Important)
-		InsertHeadList(&Queue->List, &Dpc->List);
+	if (Prcb == CurrentPrcb)
+	{
+		KeIssueSoftwareInterrupt(IPL_DPC);
+	}
 	else
-		InsertTailList(&Queue->List, &Dpc->List);
-	
-	KeIssueSoftwareInterrupt(IPL_DPC);
+	{
+		AtOrFetch(Prcb->PendingSoftInterrupts, PENDING(IPL_DPC));
+		KiSendDpcIpi(Prcb);
+	}
 	
 	// Restore interrupts.
 	KeRestoreInterrupts(Restore);
 	
 	// XXX: This is probably fine.
-	if (IsImportant)
+	if (RunNow)
 		KiDispatchSoftwareInterrupts(KeGetIPL());
 }
 
@@ -95,27 +184,27 @@ void KiDispatchDpcQueue()
 	bool Restore = KeDisableInterrupts();
 	
 	PKDPC_QUEUE Queue = &KeGetCurrentPRCB()->DpcQueue;
-	while (!IsListEmpty(&Queue->List))
+	PKDPC Dpc;
+	KDPC Copy;
+	
+	while ((Dpc = KepRemoveQueueDpc(Queue, &Copy)) != NULL)
 	{
-		PLIST_ENTRY Entry = RemoveHeadList(&Queue->List);
+		ENABLE_INTERRUPTS();
 		
-		// Pop the DPC off of the list.
-		PKDPC Dpc = CONTAINING_RECORD(Entry, KDPC, List);
-		Dpc->Enqueued = false;
+		KeStatsAddDpc();
 		
-		// Make a copy of the data from the DPC routine, as it might
-		// be re-enqueued again from an interrupt, destroying the context.
-		PKDEFERRED_ROUTINE Routine = Dpc->Routine;
-		void* Context = Dpc->DeferredContext;
-		void* SysArg1 = Dpc->SystemArgument1;
-		void* SysArg2 = Dpc->SystemArgument2;
+#ifdef DPC_STATISTICS
+		uint64_t StartTime = KeDpcStatGetTime();
+#endif
 		
-		ENABLE_INTERRUPTS();
+		Copy.Routine(Dpc,
+		             Copy.DeferredContext,
+		             Copy.SystemArgument1,
+		             Copy.SystemArgument2);
 		
-		Routine(Dpc,
-		        Context,
-		        SysArg1,
-		        SysArg2);
+#ifdef DPC_STATISTICS
+		KeDpcStatRecordDpc((uintptr_t) Copy.Routine, false, Copy.EnqueuedTime, StartTime);
+#endif
 		
 		// Consider the DPC pointer invalid, so don't do anything with it after
 		// invoking its routine.
@@ -130,6 +219,90 @@ void KiDispatchDpcQueue()
 	KeRestoreInterrupts(Restore);
 }
 
+static void KepWakeThreadedDpcThread(UNUSED PKDPC Dpc, void* Context, UNUSED void* SA1, UNUSED void* SA2)
+{
+	PKPRCB Prcb = Context;
+	KeSetEvent(&Prcb->ThreadedDpcEvent, 0);
+}
+
+static NO_RETURN void KepThreadedDpcThread(void* Context)
+{
+	PKPRCB Prcb = Context;
+	PKDPC Dpc;
+	KDPC Copy;
+	
+	while (true)
+	{
+		bool Restore = KeDisableInterrupts();
+		
+		while ((Dpc = KepRemoveQueueDpc(&Prcb->ThreadedDpcQueue, &Copy)) != NULL)
+		{
+			KeRestoreInterrupts(Restore);
+			
+			KeStatsAddDpc();
+			
+#ifdef DPC_STATISTICS
+			uint64_t StartTime = KeDpcStatGetTime();
+#endif
+			
+			Copy.Routine(Dpc,
+			             Copy.DeferredContext,
+			             Copy.SystemArgument1,
+			             Copy.SystemArgument2);
+			
+#ifdef DPC_STATISTICS
+			KeDpcStatRecordDpc((uintptr_t) Copy.Routine, true, Copy.EnqueuedTime, StartTime);
+#endif
+			
+			ASSERT(KeGetIPL() == IPL_NORMAL);
+			
+			Restore = KeDisableInterrupts();
+		}
+		
+		KeRestoreInterrupts(Restore);
+		
+		// A threaded DPC enqueued after the queue was found empty sets the event
+		// through the wake DPC, so it is not missed.
+		KeWaitForSingleObject(&Prcb->ThreadedDpcEvent, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	}
+}
+
+INIT
+void KiInitializeDpcQueues(PKPRCB Prcb)
+{
+	InitializeListHead(&Prcb->DpcQueue.List);
+	KeInitializeSpinLock(&Prcb->DpcQueue.Lock);
+	
+	InitializeListHead(&Prcb->ThreadedDpcQueue.List);
+	KeInitializeSpinLock(&Prcb->ThreadedDpcQueue.Lock);
+	
+	KeInitializeDpc(&Prcb->ThreadedDpcWakeDpc, KepWakeThreadedDpcThread, Prcb);
+	KeInitializeEvent(&Prcb->ThreadedDpcEvent, EVENT_SYNCHRONIZATION, false);
+}
+
+INIT
+void KiStartThreadedDpcThread()
+{
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	
+	PKTHREAD Thread = KeAllocateThread();
+	void* Stack = MmAllocateKernelStack();
+	if (!Thread || !Stack)
+		KeCrash("Could not create threaded DPC thread for processor %d", Prcb->Id);
+	
+	KeInitializeThread2(Thread, Stack, KERNEL_STACK_SIZE, KepThreadedDpcThread, Prcb, KeGetSystemProcess());
+	
+	// The thread must stay on its processor, because the threaded DPCs targeted
+	// at that processor expect to run there.
+	if (Prcb->Id < (int)(sizeof(KAFFINITY) * 8))
+		Thread->Affinity = 1ULL << Prcb->Id;
+	
+	KeSetPriorityThread(Thread, PRIORITY_REALTIME_MAX);
+	
+	Prcb->ThreadedDpcThread = Thread;
+	KeReadyThread(Thread);
+}
+
 void KiSetPendingQuantumEnd()
 {
 	bool Restore = KeDisableInterrupts();
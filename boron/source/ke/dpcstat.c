@@ -0,0 +1,149 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/dpcstat.c
+	
+Abstract:
+	This module implements the DPC and interrupt statistics
+	facility, and the DPC watchdog.
+	
+	The DPC class table is a statistics table (see ke/stattbl.c)
+	keyed by routine.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "ki.h"
+#include <hal.h>
+
+#ifdef DPC_STATISTICS
+
+static KDPC_CLASS KiDpcClassTable[DPC_CLASS_TABLE_SIZE];
+static KDPC_CLASS KiInterruptClassTable[INTERRUPT_CLASS_TABLE_SIZE];
+
+// The DPC watchdog's budget in ticks.  Zero if the watchdog is disabled.
+static uint64_t KiDpcBudget;
+static bool KiDpcBudgetCrash;
+
+static PKDPC_CLASS KepGetDpcClass(uintptr_t Routine, int Type)
+{
+	bool Claimed;
+	PKDPC_CLASS Class = KeStatTableLookUp(
+		KiDpcClassTable,
+		DPC_CLASS_TABLE_SIZE,
+		sizeof(KDPC_CLASS),
+		offsetof(KDPC_CLASS, Routine),
+		Routine,
+		&Claimed
+	);
+	
+	if (Claimed)
+		Class->Type = Type;
+	
+	return Class;
+}
+
+static void KepRecordRun(PKDPC_CLASS Class, uint64_t StartTime, uint64_t EndTime)
+{
+	AtAddFetch(Class->Count, 1);
+	
+	if (EndTime <= StartTime)
+		return;
+	
+	AtAddFetch(Class->TotalTime, EndTime - StartTime);
+	KeStatUpdateMaximum(&Class->MaxTime, EndTime - StartTime);
+}
+
+uint64_t KeDpcStatGetTime()
+{
+	// DPCs can be enqueued before the HAL is loaded.
+	if (!HalWasInitted())
+		return 0;
+	
+	return HalGetTickCount();
+}
+
+void KeDpcStatRecordDpc(uintptr_t Routine, bool Threaded, uint64_t EnqueuedAt, uint64_t StartTime)
+{
+	uint64_t EndTime = KeDpcStatGetTime();
+	if (!StartTime)
+		return;
+	
+	PKDPC_CLASS Class = KepGetDpcClass(Routine, Threaded ? DPC_STAT_TYPE_THREADED_DPC : DPC_STAT_TYPE_DPC);
+	if (!Class)
+		return;
+	
+	KepRecordRun(Class, StartTime, EndTime);
+	
+	// The DPC could have been enqueued from another processor, whose tick count
+	// may be slightly behind ours.
+	if (EnqueuedAt && StartTime > EnqueuedAt)
+	{
+		AtAddFetch(Class->TotalLatency, StartTime - EnqueuedAt);
+		KeStatUpdateMaximum(&Class->MaxLatency, StartTime - EnqueuedAt);
+	}
+	
+	// Threaded DPCs don't hold up the processor, so they don't have a budget.
+	uint64_t Budget = AtLoad(KiDpcBudget);
+	if (Threaded || !Budget || EndTime - StartTime <= Budget)
+		return;
+	
+	AtAddFetch(Class->OverBudgetCount, 1);
+	
+	uintptr_t BaseAddress = 0;
+	const char* Name = DbgLookUpRoutineNameByAddress(Routine, &BaseAddress);
+	uint64_t Microseconds = (EndTime - StartTime) * 1000000 / HalGetTickFrequency();
+	
+	if (KiDpcBudgetCrash)
+	{
+		KeCrash(
+			"DPC watchdog: DPC routine %p (%s) ran for %llu microseconds",
+			(void*) Routine,
+			Name ? Name : "unknown",
+			Microseconds
+		);
+	}
+	
+	DbgPrint(
+		"DPC watchdog: DPC routine %p (%s) ran for %llu microseconds",
+		(void*) Routine,
+		Name ? Name : "unknown",
+		Microseconds
+	);
+}
+
+void KeDpcStatRecordInterrupt(int Vector, uintptr_t Routine, uint64_t StartTime)
+{
+	uint64_t EndTime = KeDpcStatGetTime();
+	if (!StartTime || Vector < 0 || Vector >= INTERRUPT_CLASS_TABLE_SIZE)
+		return;
+	
+	PKDPC_CLASS Class = &KiInterruptClassTable[Vector];
+	
+	Class->Type = DPC_STAT_TYPE_INTERRUPT;
+	AtStore(Class->Routine, Routine);
+	
+	KepRecordRun(Class, StartTime, EndTime);
+}
+
+void KeSetDpcWatchdog(uint64_t BudgetMicroseconds, bool Crash)
+{
+	KiDpcBudgetCrash = Crash;
+	AtStore(KiDpcBudget, BudgetMicroseconds * HalGetTickFrequency() / 1000000);
+}
+
+PKDPC_CLASS KeDpcStatGetClassTable(size_t* Count)
+{
+	*Count = DPC_CLASS_TABLE_SIZE;
+	return KiDpcClassTable;
+}
+
+PKDPC_CLASS KeDpcStatGetInterruptTable(size_t* Count)
+{
+	*Count = INTERRUPT_CLASS_TABLE_SIZE;
+	return KiInterruptClassTable;
+}
+
+#endif
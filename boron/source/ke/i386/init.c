@@ -14,10 +14,23 @@ Author:
 ***/
 #include <ke.h>
 #include <hal.h>
+#include "../ki.h"
 
 void KiSetupIdt();
 void KiInitializeInterruptSystem();
 
+// The scheduler only stops the tick with a one-shot interrupt timer, which
+// this architecture's HALs don't use, so rescheduling IPIs are never sent.
+void KiSendRescheduleIpi(UNUSED PKPRCB Prcb)
+{
+}
+
+// Without IPIs, a processor notices a DPC targeted at it at its next clock tick,
+// when it dispatches its pending software interrupts.
+void KiSendDpcIpi(UNUSED PKPRCB Prcb)
+{
+}
+
 INIT
 void KeInitArchUP()
 {
@@ -46,8 +46,16 @@ static PKREGISTERS KiInterruptDispatch(PKREGISTERS Regs)
 		KIPL Unused;
 		KeAcquireSpinLock(Interrupt->SpinLock, &Unused);
 		
+#ifdef DPC_STATISTICS
+		uint64_t StartTime = KeDpcStatGetTime();
+#endif
+		
 		Interrupt->ServiceRoutine(Interrupt, Interrupt->ServiceContext);
 		
+#ifdef DPC_STATISTICS
+		KeDpcStatRecordInterrupt(Number, (uintptr_t) Interrupt->ServiceRoutine, StartTime);
+#endif
+		
 		KeReleaseSpinLock(Interrupt->SpinLock, Unused);
 	}
 	
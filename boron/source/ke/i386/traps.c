@@ -145,6 +145,10 @@ int KiTryEnterHardwareInterrupt(int IntNum)
 		*IplPtr = NewIpl; // specific to Amd64
 	}
 	
+	// Exceptions aren't counted as interrupts.
+	if (IntNum >= 0x20)
+		KeStatsAddInterrupt();
+	
 	// now that we've setup the hardware interrupt stuff, enable interrupts.
 	// we couldn't have done that before because the CPU would think that we're
 	// in a low IPL thing meanwhile we're not..
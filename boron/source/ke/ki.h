@@ -42,10 +42,27 @@ void KiUnwaitThread(PKTHREAD Thread, int Status, KPRIORITY Increment);
 
 uint64_t KiGetNextTimerExpiryTick();
 
-uint64_t KiGetNextTimerExpiryItTick();
+// Programs the interrupt timer to fire at the next deadline of this processor.
+void KiProgramIntTimer();
+
+// Asks another processor to reschedule.  Defined in arch.
+void KiSendRescheduleIpi(PKPRCB Prcb);
+
+// Asks another processor to check its pending software interrupts.  Defined in arch.
+void KiSendDpcIpi(PKPRCB Prcb);
+
+// Initializes the DPC queues of a processor.
+void KiInitializeDpcQueues(PKPRCB Prcb);
+
+// Starts the current processor's threaded DPC thread.
+void KiStartThreadedDpcThread();
+
+extern PKPRCB* KeProcessorList;
 
 void KiDispatchTimerObjects(); // Called by the scheduler
 
+void KiAcquireSpinLockAt(PKSPIN_LOCK SpinLock, PKIPL OldIpl, uintptr_t CallSite);
+
 NO_DISCARD KIPL KiLockDispatcher();
 
 void KiLockDispatcherWait();
@@ -73,6 +90,9 @@ void KiDispatchSoftwareInterrupts(KIPL NewIpl);
 
 void KiHandleQuantumEnd();
 
+// Lets a thread waiting on the queue run in place of an associated thread which blocks.
+void KiActivateWaiterQueue(PKQUEUE Queue);
+
 void KiHandleQuantumEndDispatcherLockHeld();
 
 void KiSetPendingQuantumEnd();
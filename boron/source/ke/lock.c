@@ -31,16 +31,27 @@ bool KeAttemptAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIPL OldIpl)
 	*OldIpl = KeRaiseIPLIfNeeded(IPL_DPC);
 	
 	if (!AtTestAndSetMO(SpinLock->Locked, ATOMIC_MEMORD_ACQUIRE))
+	{
+#ifdef LOCK_STATISTICS
+		KeLockStatAcquiredSpinLock(SpinLock, CallerAddress(), 0);
+#endif
 		return true;
+	}
 	
 	KeLowerIPL(*OldIpl);
 	return false;
 }
 
-void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIPL OldIpl)
+// Acquires a spin lock on behalf of CallSite.  This is used by wrappers such as
+// KiLockDispatcher, so that the lock is attributed to the wrapper's caller.
+void KiAcquireSpinLockAt(PKSPIN_LOCK SpinLock, PKIPL OldIpl, UNUSED uintptr_t CallSite)
 {
 	*OldIpl = KeRaiseIPLIfNeeded(IPL_DPC);
 	
+#ifdef LOCK_STATISTICS
+	uint64_t WaitStart = 0;
+#endif
+	
 #ifdef DEBUG
 	// If we are a uniprocessor system, check if the lock is locked.
 	// If it is already locked, it can only mean one thing...
@@ -66,7 +77,7 @@ void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIPL OldIpl)
 		{
 #ifdef DEBUG
 #ifdef SPINLOCK_TRACK_PC
-			SpinLock->Pc = CallerAddress();
+			SpinLock->Pc = CallSite;
 #endif
 			
 			if (KeGetCurrentPRCB())
@@ -76,9 +87,18 @@ void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIPL OldIpl)
 					CurrThread->HoldingSpinlocks++;
 			}
 #endif
+
+#ifdef LOCK_STATISTICS
+			KeLockStatAcquiredSpinLock(SpinLock, CallSite, WaitStart);
+#endif
 			return;
 		}
 		
+#ifdef LOCK_STATISTICS
+		if (!WaitStart)
+			WaitStart = KeLockStatGetTime();
+#endif
+		
 		// Use regular reads instead of atomic reads to minimize bus contention
 		while (SpinLock->Locked)
 		{
@@ -87,6 +107,11 @@ void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIPL OldIpl)
 	}
 }
 
+void KeAcquireSpinLock(PKSPIN_LOCK SpinLock, PKIPL OldIpl)
+{
+	KiAcquireSpinLockAt(SpinLock, OldIpl, CallerAddress());
+}
+
 void KeReleaseSpinLock(PKSPIN_LOCK SpinLock, KIPL OldIpl)
 {
 #ifdef DEBUG
@@ -108,6 +133,10 @@ void KeReleaseSpinLock(PKSPIN_LOCK SpinLock, KIPL OldIpl)
 	}
 #endif
 
+#ifdef LOCK_STATISTICS
+	KeLockStatReleasedSpinLock(SpinLock);
+#endif
+
 	AtClearMO(SpinLock->Locked, ATOMIC_MEMORD_RELEASE);
 	KeLowerIPL(OldIpl);
 }
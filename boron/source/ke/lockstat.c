@@ -0,0 +1,163 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/lockstat.c
+	
+Abstract:
+	This module implements the lock statistics facility.
+	
+	The lock class table is a statistics table (see ke/stattbl.c)
+	keyed by call site.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "ki.h"
+
+#ifdef LOCK_STATISTICS
+
+static KLOCK_CLASS KiLockClassTable[LOCK_CLASS_TABLE_SIZE];
+
+uint64_t KeLockStatGetTime()
+{
+	// Locks are used well before the HAL is loaded.
+	if (!HalWasInitted())
+		return 0;
+	
+	return HalGetTickCount();
+}
+
+PKLOCK_CLASS KeLockStatGetClass(uintptr_t CallSite, int Type)
+{
+	bool Claimed;
+	PKLOCK_CLASS Class = KeStatTableLookUp(
+		KiLockClassTable,
+		LOCK_CLASS_TABLE_SIZE,
+		sizeof(KLOCK_CLASS),
+		offsetof(KLOCK_CLASS, CallSite),
+		CallSite,
+		&Claimed
+	);
+	
+	if (Claimed)
+		Class->Type = Type;
+	
+	return Class;
+}
+
+uint64_t KeLockStatRecordAcquire(PKLOCK_CLASS Class, uint64_t WaitStart)
+{
+	uint64_t Now = KeLockStatGetTime();
+	
+	if (!Class)
+		return Now;
+	
+	AtAddFetch(Class->Acquisitions, 1);
+	
+	if (!WaitStart)
+		return Now;
+	
+	AtAddFetch(Class->ContendedAcquisitions, 1);
+	
+	// The wait could have started on another processor, whose tick count
+	// may be slightly behind ours.
+	if (Now > WaitStart)
+	{
+		uint64_t WaitTime = Now - WaitStart;
+		AtAddFetch(Class->TotalWaitTime, WaitTime);
+		KeStatUpdateMaximum(&Class->MaxWaitTime, WaitTime);
+	}
+	
+	return Now;
+}
+
+void KeLockStatRecordRelease(PKLOCK_CLASS Class, uint64_t AcquiredAt)
+{
+	if (!Class || !AcquiredAt)
+		return;
+	
+	uint64_t Now = KeLockStatGetTime();
+	if (Now <= AcquiredAt)
+		return;
+	
+	uint64_t HoldTime = Now - AcquiredAt;
+	AtAddFetch(Class->TotalHoldTime, HoldTime);
+	KeStatUpdateMaximum(&Class->MaxHoldTime, HoldTime);
+}
+
+void KeLockStatAcquiredSpinLock(void* Lock, uintptr_t CallSite, uint64_t WaitStart)
+{
+	PKLOCK_CLASS Class = KeLockStatGetClass(CallSite, LOCK_TYPE_SPIN_LOCK);
+	uint64_t AcquiredAt = KeLockStatRecordAcquire(Class, WaitStart);
+	
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	if (!Prcb || !Class)
+		return;
+	
+	// Interrupt service routines also acquire spin locks, so don't let them
+	// modify the held list while we are.
+	bool Restore = KeDisableInterrupts();
+	
+	// If this lock is already on the list, it was released by another processor
+	// (this is what the TLB shootdown code does), so reuse its slot.
+	int Index;
+	for (Index = 0; Index < Prcb->HeldSpinLockCount; Index++)
+	{
+		if (Prcb->HeldSpinLocks[Index].Lock == Lock)
+			break;
+	}
+	
+	if (Index == Prcb->HeldSpinLockCount)
+	{
+		if (Index == LOCK_STAT_MAX_HELD)
+		{
+			// Too many locks held at once, don't track the hold time of this one.
+			KeRestoreInterrupts(Restore);
+			return;
+		}
+		
+		Prcb->HeldSpinLockCount++;
+	}
+	
+	PKLOCK_STAT_HELD Held = &Prcb->HeldSpinLocks[Index];
+	Held->Lock = Lock;
+	Held->Class = Class;
+	Held->AcquiredAt = AcquiredAt;
+	
+	KeRestoreInterrupts(Restore);
+}
+
+void KeLockStatReleasedSpinLock(void* Lock)
+{
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	if (!Prcb)
+		return;
+	
+	bool Restore = KeDisableInterrupts();
+	
+	// Spin locks are usually released in the reverse order they were acquired in.
+	for (int Index = Prcb->HeldSpinLockCount - 1; Index >= 0; Index--)
+	{
+		PKLOCK_STAT_HELD Held = &Prcb->HeldSpinLocks[Index];
+		if (Held->Lock != Lock)
+			continue;
+		
+		KeLockStatRecordRelease(Held->Class, Held->AcquiredAt);
+		
+		// Fill the gap with the last entry.
+		*Held = Prcb->HeldSpinLocks[--Prcb->HeldSpinLockCount];
+		break;
+	}
+	
+	KeRestoreInterrupts(Restore);
+}
+
+PKLOCK_CLASS KeLockStatGetClassTable(size_t* Count)
+{
+	*Count = LOCK_CLASS_TABLE_SIZE;
+	return KiLockClassTable;
+}
+
+#endif
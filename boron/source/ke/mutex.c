@@ -31,6 +31,12 @@ void KiReleaseMutex(PKMUTEX Mutex)
 		// Remove this mutex from the thread's mutex list.
 		RemoveEntryList(&Mutex->MutexListEntry);
 		
+	#ifdef LOCK_STATISTICS
+		KeLockStatRecordRelease(Mutex->StatClass, Mutex->AcquiredAt);
+		Mutex->StatClass = NULL;
+		Mutex->AcquiredAt = 0;
+	#endif
+		
 		// Set the owner thread of the mutex to NULL.
 		Mutex->OwnerThread = NULL;
 		
@@ -52,6 +58,11 @@ void KeInitializeMutex(PKMUTEX Mutex, int Level)
 	Mutex->Header.Signaled = MUTEX_SIGNALED; 
 	
 	Mutex->OwnerThread = NULL;
+	
+#ifdef LOCK_STATISTICS
+	Mutex->StatClass = NULL;
+	Mutex->AcquiredAt = 0;
+#endif
 }
 
 int KeReadStateMutex(PKMUTEX Mutex)
@@ -0,0 +1,173 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/queue.c
+	
+Abstract:
+	This module implements the kernel queue dispatcher
+	object.  It provides initialize, insert, remove and
+	rundown functions.
+	
+	A queue limits the number of threads which process its
+	entries at once.  Threads become associated with a queue
+	when they remove entries from it.  While an associated
+	thread is blocked in any other wait, it does not count
+	toward the limit, so that another thread may run in its
+	place.  The dispatcher notifies the queue about this in
+	KiActivateWaiterQueue.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "ki.h"
+
+// Called when a thread associated with a queue is about to block in a wait which
+// isn't on the queue itself, or when it terminates.  Lets another thread, waiting
+// for the queue, take an entry in its place.
+void KiActivateWaiterQueue(PKQUEUE Queue)
+{
+	KiAssertOwnDispatcherLock();
+	
+	Queue->CurrentCount--;
+	ASSERT(Queue->CurrentCount >= 0);
+	
+	if (KiIsObjectSignaled(&Queue->Header, NULL))
+		KiWaitTest(&Queue->Header, 0);
+}
+
+// Associates the current thread with a queue, disassociating it from the queue it
+// was associated with before, if any.
+static void KepAssociateThreadQueue(PKTHREAD Thread, PKQUEUE Queue)
+{
+	KiAssertOwnDispatcherLock();
+	
+	if (Thread->Queue == Queue)
+	{
+		// This thread is done with the entries it removed before.
+		Queue->CurrentCount--;
+		return;
+	}
+	
+	if (Thread->Queue)
+	{
+		RemoveEntryList(&Thread->QueueListEntry);
+		KiActivateWaiterQueue(Thread->Queue);
+	}
+	
+	Thread->Queue = Queue;
+	InsertTailList(&Queue->ThreadListHead, &Thread->QueueListEntry);
+}
+
+// -------- Exposed API --------
+
+void KeInitializeQueue(PKQUEUE Queue, int MaximumCount)
+{
+	KeInitializeDispatchHeader(&Queue->Header, DISPATCH_QUEUE);
+	
+	if (MaximumCount <= 0)
+		MaximumCount = KeGetProcessorCount();
+	
+	InitializeListHead(&Queue->EntryListHead);
+	InitializeListHead(&Queue->ThreadListHead);
+	Queue->CurrentCount = 0;
+	Queue->MaximumCount = MaximumCount;
+}
+
+int KeReadStateQueue(PKQUEUE Queue)
+{
+	ASSERT_QUEUE(Queue);
+	
+	return AtLoad(Queue->Header.Signaled);
+}
+
+void KeInsertQueue(PKQUEUE Queue, PLIST_ENTRY Entry)
+{
+	ASSERT_QUEUE(Queue);
+	KIPL Ipl = KiLockDispatcher();
+	
+	InsertTailList(&Queue->EntryListHead, Entry);
+	Queue->Header.Signaled++;
+	
+	if (KiIsObjectSignaled(&Queue->Header, NULL))
+		KiWaitTest(&Queue->Header, 0);
+	
+	KiUnlockDispatcher(Ipl);
+}
+
+BSTATUS KeRemoveQueue(
+	PKQUEUE Queue,
+	bool Alertable,
+	int TimeoutMS,
+	KPROCESSOR_MODE WaitMode,
+	PLIST_ENTRY* Entries,
+	int MaximumCount,
+	int* OutCount)
+{
+	ASSERT_QUEUE(Queue);
+	ASSERT(MaximumCount > 0);
+	
+	PKTHREAD Thread = KeGetCurrentThread();
+	*OutCount = 0;
+	
+	// The wait below is performed atomically with the association.  When it's
+	// satisfied, the thread claims one entry and counts toward the limit again.
+	KiLockDispatcherWait();
+	KepAssociateThreadQueue(Thread, Queue);
+	
+	BSTATUS Status = KeWaitForSingleObject(Queue, Alertable, TimeoutMS, WaitMode);
+	
+	KIPL Ipl = KiLockDispatcher();
+	
+	if (Status != STATUS_SUCCESS)
+	{
+		// The thread is running again, even though it didn't claim an entry.
+		if (Thread->Queue == Queue)
+			Queue->CurrentCount++;
+		
+		KiUnlockDispatcher(Ipl);
+		return Status;
+	}
+	
+	Entries[0] = RemoveHeadList(&Queue->EntryListHead);
+	int Count = 1;
+	
+	// Entries which no other thread has claimed are taken along, without waiting.
+	while (Count < MaximumCount && Queue->Header.Signaled > 0)
+	{
+		Queue->Header.Signaled--;
+		Entries[Count++] = RemoveHeadList(&Queue->EntryListHead);
+	}
+	
+	KiUnlockDispatcher(Ipl);
+	
+	*OutCount = Count;
+	return STATUS_SUCCESS;
+}
+
+void KeRundownQueue(PKQUEUE Queue, PLIST_ENTRY OutEntryList)
+{
+	ASSERT_QUEUE(Queue);
+	KIPL Ipl = KiLockDispatcher();
+	
+	ASSERT(IsListEmpty(&Queue->Header.WaitBlockList));
+	
+	while (!IsListEmpty(&Queue->ThreadListHead))
+	{
+		PLIST_ENTRY Entry = RemoveHeadList(&Queue->ThreadListHead);
+		PKTHREAD Thread = CONTAINING_RECORD(Entry, KTHREAD, QueueListEntry);
+		Thread->Queue = NULL;
+	}
+	
+	InitializeListHead(OutEntryList);
+	
+	while (!IsListEmpty(&Queue->EntryListHead))
+	{
+		PLIST_ENTRY Entry = RemoveHeadList(&Queue->EntryListHead);
+		InsertTailList(OutEntryList, Entry);
+	}
+	
+	Queue->Header.Signaled = 0;
+	KiUnlockDispatcher(Ipl);
+}
@@ -24,9 +24,23 @@ Author:
  
 #define MAX_THREADS_ON_QUEUE_OVERLOADED 100
 
+// The maximum number of threads looked at, per priority level, when looking
+// for a thread that may run on this processor.
+#define MAX_THREADS_SCANNED_PER_QUEUE 16
+
+// How often each processor tries to balance its load with the others.
+#define LOAD_BALANCE_INTERVAL_US 20000
+
+// How many more threads another processor must have queued than this one
+// before threads are pulled from it during load balancing.
+#define LOAD_BALANCE_MIN_IMBALANCE 2
+
+// The longest the one-shot interrupt timer is programmed for at once.  Deadlines further
+// out are reached in several steps, so that the interrupt timer's count doesn't overflow.
+#define MAX_TICKLESS_INTERVAL_US 1000000
+
 //#define SCHED_DISABLE_WORKSTEALING
 
-static int KepNextProcessorToStealWorkFrom;
 extern PKPRCB* KeProcessorList;
 extern int     KeProcessorCount;
 
@@ -69,15 +83,13 @@ PKTHREAD KeGetCurrentThread()
 
 #endif
  
-static bool   KiMoreAggressiveWorkStealing = false;
-static PKPRCB KiMostCrowdedProcessor = NULL;
+static bool KiMoreAggressiveWorkStealing = false;
 
 void KiCheckOverloadedExecQueues()
 {
 	KiAssertOwnDispatcherLock();
 	
 	KiMoreAggressiveWorkStealing = false;
-	KiMostCrowdedProcessor = NULL;
 	
 	PKPRCB* PrcbList = KeProcessorList;
 	for (int i = 0; i < KeProcessorCount; i++)
@@ -85,12 +97,97 @@ void KiCheckOverloadedExecQueues()
 		if (PrcbList[i]->Scheduler.ThreadsOnQueueCount >= MAX_THREADS_ON_QUEUE_OVERLOADED)
 		{
 			KiMoreAggressiveWorkStealing = true;
-			
-			if (!KiMostCrowdedProcessor ||
-			    KiMostCrowdedProcessor->Scheduler.ThreadsOnQueueCount < PrcbList[i]->Scheduler.ThreadsOnQueueCount)
-				KiMostCrowdedProcessor = PrcbList[i];
+			break;
+		}
+	}
+}
+
+// Returns how far apart two processors are.  Zero means that they share their
+// last level cache, one means that they share a package, and two means neither.
+static int KepGetProcessorDistance(PKPRCB Prcb, PKPRCB OtherPrcb)
+{
+	if (Prcb->PackageId != OtherPrcb->PackageId)
+		return 2;
+	
+	if (Prcb->CacheId != OtherPrcb->CacheId)
+		return 1;
+	
+	return 0;
+}
+
+static bool KepCanRunOnProcessor(PKTHREAD Thread, int ProcessorId)
+{
+	return Thread->Affinity & (1ULL << ProcessorId);
+}
+
+// Makes a processor reconsider what it's running as soon as possible.
+static void KepKickProcessor(PKPRCB Prcb)
+{
+	if (Prcb == KeGetCurrentPRCB())
+		KiSetPendingQuantumEnd();
+	else
+		KiSendRescheduleIpi(Prcb);
+}
+
+// With a one-shot interrupt timer, idle processors without any timers pending don't
+// take interrupts at all, so they have to be woken up to steal work from busy ones.
+//
+// A processor running a lone thread is only woken up if its load balancing is due and
+// there's enough of an imbalance, so that it isn't interrupted for every queued thread.
+static void KepWakeIdleProcessor(PKPRCB BusyPrcb, PKTHREAD Thread)
+{
+	if (!HalUseOneShotIntTimer() || Thread->DontSteal)
+		return;
+	
+	PKSCHEDULER BusyScheduler = &BusyPrcb->Scheduler;
+	PKPRCB Target = NULL;
+	uint64_t Now = HalGetTickCount();
+	
+	for (int i = 0; i < KeProcessorCount; i++)
+	{
+		PKPRCB Prcb = KeProcessorList[i];
+		PKSCHEDULER Scheduler = &Prcb->Scheduler;
+		
+		// Processors with a quantum will look for work on their own.
+		if (Prcb == BusyPrcb ||
+			!Scheduler->CurrentThread ||
+			Scheduler->QuantumUntil ||
+			!KepCanRunOnProcessor(Thread, i))
+			continue;
+		
+		if (Scheduler->CurrentThread->BasePriority == PRIORITY_IDLE)
+		{
+			Target = Prcb;
+			break;
 		}
+		
+		if (!Target &&
+			Now >= Scheduler->NextLoadBalance &&
+			BusyScheduler->ThreadsOnQueueCount - Scheduler->ThreadsOnQueueCount >= LOAD_BALANCE_MIN_IMBALANCE)
+			Target = Prcb;
 	}
+	
+	if (Target)
+		KepKickProcessor(Target);
+}
+
+// Called after a thread was placed on a processor's execution queue.  If that processor's
+// current thread was running without a quantum, it now has a competitor, so have it
+// reschedule.  Otherwise, the processor is busy, so try to get an idle one to help out.
+static void KepNotifyThreadQueued(PKPRCB Prcb, PKTHREAD Thread)
+{
+	if (!HalUseOneShotIntTimer())
+		return;
+	
+	// If the scheduler isn't running on that processor yet, it'll find the thread once it does.
+	PKSCHEDULER Scheduler = &Prcb->Scheduler;
+	if (!Scheduler->CurrentThread)
+		return;
+	
+	if (!Scheduler->QuantumUntil)
+		KepKickProcessor(Prcb);
+	else
+		KepWakeIdleProcessor(Prcb, Thread);
 }
 
 void KiSetPriorityThread(PKTHREAD Thread, int Priority)
@@ -148,7 +245,23 @@ void KiReadyThread(PKTHREAD Thread)
 	Thread->Status = KTHREAD_STATUS_READY;
 	Thread->Suspended = false;
 	
-	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	
+	// If the thread may not run on this processor, place it on the queue of
+	// one that it may run on, so that it doesn't have to wait to be stolen.
+	if (!KepCanRunOnProcessor(Thread, Prcb->Id))
+	{
+		for (int i = 0; i < KeProcessorCount; i++)
+		{
+			if (KepCanRunOnProcessor(Thread, i))
+			{
+				Prcb = KeProcessorList[i];
+				break;
+			}
+		}
+	}
+	
+	PKSCHEDULER Scheduler = &Prcb->Scheduler;
 	
 	KIPL Ipl;
 	KeAcquireSpinLock(&KiGlobalThreadListLock, &Ipl);
@@ -156,17 +269,17 @@ void KiReadyThread(PKTHREAD Thread)
 	KeReleaseSpinLock(&KiGlobalThreadListLock, Ipl);
 	
 	InsertTailList(&Scheduler->ExecQueue[Thread->Priority], &Thread->EntryQueue);
-
-#ifdef DEBUG
+	
 	Thread->EnqueuedTime = HalGetTickCount();
-#endif
-
+	
 	Scheduler->ThreadsOnQueueCount++;
 	Scheduler->ExecQueueMask |= QUEUE_BIT(Thread->Priority);
 	
-	Thread->LastProcessor = KeGetCurrentPRCB()->Id;
+	Thread->LastProcessor = Prcb->Id;
 	
 	KiCheckOverloadedExecQueues();
+	
+	KepNotifyThreadQueued(Prcb, Thread);
 }
 
 KPRIORITY KiAdjustPriorityBoost(KPRIORITY BasePriority, KPRIORITY PriorityBoost)
@@ -211,14 +324,22 @@ void KiUnwaitThread(PKTHREAD Thread, int Status, KPRIORITY Increment)
 	Thread->WaitStatus = Status;
 	Thread->DontSteal = true;
 	
+	uint64_t Now = HalGetTickCount();
+	
+	// Account for the time spent waiting.
+	if (Thread->WaitStartedAt)
+	{
+		Thread->Statistics.WaitTime += Now - Thread->WaitStartedAt;
+		Thread->WaitStartedAt = 0;
+	}
+	
 	// Emplace ourselves on the execution queue.
 	InsertTailList(&Scheduler->ExecQueue[Thread->Priority], &Thread->EntryQueue);
 	Scheduler->ExecQueueMask |= QUEUE_BIT(Thread->Priority);
-
-#ifdef DEBUG
-	Thread->EnqueuedTime = HalGetTickCount();
-#endif
-
+	Scheduler->ThreadsOnQueueCount++;
+	
+	Thread->EnqueuedTime = Now;
+	
 	KiCheckOverloadedExecQueues();
 	
 	KiCancelTimer(&Thread->WaitTimer);
@@ -230,6 +351,8 @@ void KiUnwaitThread(PKTHREAD Thread, int Status, KPRIORITY Increment)
 	{
 		KiSetPendingQuantumEnd();
 	}
+	
+	KepNotifyThreadQueued(KeProcessorList[Thread->LastProcessor], Thread);
 }
 
 INIT
@@ -308,30 +431,36 @@ static PKTHREAD KepPopNextThreadIfNeeded(PKSCHEDULER Sched, int MinPriority, boo
 		return NULL;
 #endif
 	
+	int ProcessorId = KeGetCurrentPRCB()->Id;
+	
 	for (int Priority = PRIORITY_COUNT - 1; Priority >= MinPriority; Priority--)
 	{
-		// Is the list empty?
-		if (IsListEmpty(&Sched->ExecQueue[Priority]))
-			continue;
+		PLIST_ENTRY Head = &Sched->ExecQueue[Priority];
+		PKTHREAD Thread = NULL;
 		
-		// Pop off the thread.
-		PLIST_ENTRY ListEntry = Sched->ExecQueue[Priority].Flink;
-		PKTHREAD Thread = CONTAINING_RECORD(ListEntry, KTHREAD, EntryQueue);
-		
-		// Check if the thread's affinity mask contains this processor's ID.
-		if (~Thread->Affinity & (1ULL << KeGetCurrentPRCB()->Id))
+		// Look for the first thread in the queue that can run here.  Don't look
+		// too far, since we are holding the dispatcher lock.
+		int Scanned = 0;
+		for (PLIST_ENTRY ListEntry = Head->Flink;
+			ListEntry != Head && Scanned < MAX_THREADS_SCANNED_PER_QUEUE;
+			ListEntry = ListEntry->Flink, Scanned++)
 		{
-			// Nope, therefore this thread is a no-go.
-			// TODO: Check other threads within the queue?
-			return NULL;
+			PKTHREAD Candidate = CONTAINING_RECORD(ListEntry, KTHREAD, EntryQueue);
+			
+			// Check if the thread's affinity mask contains this processor's ID.
+			if (!KepCanRunOnProcessor(Candidate, ProcessorId))
+				continue;
+			
+			// Check if the thread isn't ready to be stolen yet.
+			if (Candidate->DontSteal && OtherProcessor)
+				continue;
+			
+			Thread = Candidate;
+			break;
 		}
 		
-		// Check if the thread isn't ready to be stolen yet.
-		if (Thread->DontSteal && OtherProcessor)
-		{
-			// Nope, therefore this thread is a no-go.
-			return NULL;
-		}
+		if (!Thread)
+			continue;
 		
 		// Remove this thread from the queue.
 		RemoveEntryList(&Thread->EntryQueue);
@@ -358,26 +487,68 @@ void KiAssignDefaultQuantum(PKTHREAD Thread)
 {
 	KiAssertOwnDispatcherLock();
 	
-	uint64_t QuantumTicks = HalGetTickFrequency() * MAX_QUANTUM_US / 1000000;
-	uint64_t QuantumUntil = HalGetTickCount() + QuantumTicks;
+	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
+	uint64_t QuantumUntil = 0;
+	
+	// With a one-shot interrupt timer, a thread that has no competitors on this processor
+	// runs without a quantum, so that no interrupts are taken only to find out that there
+	// is nothing else to run.  Whoever queues a competitor will request a reschedule.
+	//
+	// Threads of a lower priority couldn't take over the processor anyway, so they don't
+	// count as competitors.
+	if (!HalUseOneShotIntTimer() || (Scheduler->ExecQueueMask & ~(QUEUE_BIT(Thread->BasePriority) - 1)))
+	{
+		uint64_t QuantumTicks = HalGetTickFrequency() * MAX_QUANTUM_US / 1000000;
+		QuantumUntil = HalGetTickCount() + QuantumTicks;
+	}
 	
 	Thread->QuantumUntil = QuantumUntil;
-	KiGetCurrentScheduler()->QuantumUntil = QuantumUntil;
+	Scheduler->QuantumUntil = QuantumUntil;
+	
+	KiProgramIntTimer();
+}
+
+void KiProgramIntTimer()
+{
+	// If using a periodic timer, a new tick will just show up.
+	if (!HalUseOneShotIntTimer())
+		return;
 	
-	if (HalUseOneShotIntTimer())
+	bool Restore = KeDisableInterrupts();
+	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
+	
+	// The scheduler will program the timer when it starts running on this processor.
+	if (!Scheduler->CurrentThread)
 	{
-		uint64_t Tick = HalGetIntTimerFrequency() * MAX_QUANTUM_US / 1000000;
-		uint64_t TimerTick = KiGetNextTimerExpiryItTick();
-		
-		if (Tick > TimerTick && TimerTick)
-			Tick = TimerTick;
-		
-		HalRequestInterruptInTicks(Tick);
+		KeRestoreInterrupts(Restore);
+		return;
 	}
-	else
+	
+	uint64_t Deadline = Scheduler->QuantumUntil;
+	uint64_t TimerExpiry = AtLoad(Scheduler->NextTimerExpiry);
+	
+	if (TimerExpiry && (!Deadline || TimerExpiry < Deadline))
+		Deadline = TimerExpiry;
+	
+	// If there's neither a quantum nor a timer to wait for, stop the tick entirely.
+	uint64_t Ticks = 0;
+	
+	if (Deadline)
 	{
-		// It's just going to show up
+		uint64_t Now = HalGetTickCount();
+		uint64_t MaxInterval = HalGetTickFrequency() * MAX_TICKLESS_INTERVAL_US / 1000000;
+		uint64_t Interval = Deadline > Now ? Deadline - Now : 0;
+		
+		if (Interval > MaxInterval)
+			Interval = MaxInterval;
+		
+		Ticks = Interval * HalGetIntTimerFrequency() / HalGetTickFrequency();
+		if (Ticks == 0)
+			Ticks = 1;
 	}
+	
+	HalRequestInterruptInTicks(Ticks);
+	KeRestoreInterrupts(Restore);
 }
 
 PKTHREAD KiGetNextThread(bool MayDowngrade);
@@ -399,6 +570,12 @@ void KiEndThreadQuantum()
 		// If we don't have any more threads that have at least the priority
 		// of the current one, return immediately. We are not going to switch.
 		KiAssignDefaultQuantum(CurrentThread);
+		
+		// KiPerformYield has accounted for the time the thread ran so far,
+		// so start measuring again.
+		if (CurrentThread)
+			CurrentThread->TickScheduledAt = HalGetTickCount();
+		
 		return;
 	}
 	
@@ -423,13 +600,15 @@ void KiEndThreadQuantum()
 			
 			Scheduler->ThreadsOnQueueCount++;
 			Scheduler->ExecQueueMask |= QUEUE_BIT(CurrentThread->Priority);
+			
+			KepWakeIdleProcessor(KeGetCurrentPRCB(), CurrentThread);
 		}
 		
 		// Set the last processor ID of the thread.
 		CurrentThread->LastProcessor = KeGetCurrentPRCB()->Id;
-#ifdef DEBUG
-		CurrentThread->EnqueuedTime = HalGetTickCount();
-#endif
+		
+		if (!CurrentThread->Suspended)
+			CurrentThread->EnqueuedTime = HalGetTickCount();
 
 		KiCheckOverloadedExecQueues();
 	}
@@ -490,66 +669,125 @@ static void KepCleanUpThread(UNUSED PKDPC Dpc, void* ContextV, UNUSED void* Syst
 // I dub this "work stealing", although I'm pretty sure I've heard this somewhere before.
 // If a processor doesn't have any more threads at the current priority level or higher,
 // it will try to pop threads off of another processor's queue.
-static int KepGetNextProcessorToStealWorkFrom()
+//
+// Processors that share a cache with this one are tried first, then processors on the
+// same package, and finally all others.  Within each group, the processors are visited
+// round-robin, starting after the one that was last stolen from.
+static PKTHREAD KepTryStealThread(int MinPriority)
 {
 	KiAssertOwnDispatcherLock();
 	
-	if (KiMoreAggressiveWorkStealing)
-		return KiMostCrowdedProcessor->Id;
-
-	int Processor = KepNextProcessorToStealWorkFrom;
-	
-	if (++KepNextProcessorToStealWorkFrom == KeProcessorCount)
-		KepNextProcessorToStealWorkFrom = 0;
-	
-	return Processor;
-}
-
-static PKTHREAD KepTryStealThread(int MinPriority)
-{
-	// Try "stealing" one of another processor's higher priority threads.
-	//
 	// N.B. Since we are currently using a big scheduler lock instead of many smaller locks,
 	// there is essentially a guarantee that no one else will be messing with the execution
 	// queue while we are.
-	int ProcToSteal = KepGetNextProcessorToStealWorkFrom();
-	PKSCHEDULER TheirScheduler = &KeProcessorList[ProcToSteal]->Scheduler;
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	PKSCHEDULER Scheduler = &Prcb->Scheduler;
 	
-	return KepPopNextThreadIfNeeded(TheirScheduler, MinPriority + 1, true);
+	for (int Distance = 0; Distance <= 2; Distance++)
+	{
+		for (int i = 1; i < KeProcessorCount; i++)
+		{
+			int Victim = (Scheduler->StealCursor + i) % KeProcessorCount;
+			PKPRCB VictimPrcb = KeProcessorList[Victim];
+			
+			if (VictimPrcb == Prcb || KepGetProcessorDistance(Prcb, VictimPrcb) != Distance)
+				continue;
+			
+			// Try "stealing" one of another processor's higher priority threads.
+			PKTHREAD Thread = KepPopNextThreadIfNeeded(&VictimPrcb->Scheduler, MinPriority + 1, true);
+			if (!Thread)
+				continue;
+			
+			Scheduler->StealCursor = Victim;
+			KeStatsAddWorkSteal();
+			return Thread;
+		}
+	}
+	
+	return NULL;
 }
 
-static void KepStealManyThreads()
+// Moves up to Count threads that may run on this processor from another processor's
+// execution queue onto this processor's.  Idle threads are never moved.
+static void KepStealManyThreads(PKSCHEDULER TheirScheduler, int Count)
 {
 	KiAssertOwnDispatcherLock();
 	
-	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	PKSCHEDULER Scheduler = &Prcb->Scheduler;
 	
-	int ProcToSteal = KepGetNextProcessorToStealWorkFrom();
-	PKSCHEDULER TheirScheduler = &KeProcessorList[ProcToSteal]->Scheduler;
-	
-	int LeftToSteal = TheirScheduler->ThreadsOnQueueCount / 2;
-	//DbgPrint("%d stealing from %d, %d", KeGetCurrentPRCB()->Id, ProcToSteal, LeftToSteal);
-	
-	for (int i = PRIORITY_COUNT - 1; i > 0 && LeftToSteal > 0; i--)
+	for (int i = PRIORITY_COUNT - 1; i > 0 && Count > 0; i--)
 	{
-		while (!IsListEmpty(&TheirScheduler->ExecQueue[i]) && LeftToSteal > 0)
+		PLIST_ENTRY Head = &TheirScheduler->ExecQueue[i];
+		PLIST_ENTRY Entry = Head->Flink;
+		
+		while (Entry != Head && Count > 0)
 		{
-			PLIST_ENTRY Entry = RemoveHeadList(&TheirScheduler->ExecQueue[i]);
-			InsertTailList(&Scheduler->ExecQueue[i], Entry);
+			PKTHREAD Thread = CONTAINING_RECORD(Entry, KTHREAD, EntryQueue);
+			Entry = Entry->Flink;
 			
-			if (IsListEmpty(&TheirScheduler->ExecQueue[i]))
-				TheirScheduler->ExecQueueMask &= ~(1 << i);
+			if (!KepCanRunOnProcessor(Thread, Prcb->Id) || Thread->DontSteal)
+				continue;
 			
-			Scheduler->ExecQueueMask |= 1 << i;
+			RemoveEntryList(&Thread->EntryQueue);
+			InsertTailList(&Scheduler->ExecQueue[i], &Thread->EntryQueue);
+			
+			Scheduler->ExecQueueMask |= QUEUE_BIT(i);
 			
 			TheirScheduler->ThreadsOnQueueCount--;
 			Scheduler->ThreadsOnQueueCount++;
 			
-			LeftToSteal--;
+			Thread->LastProcessor = Prcb->Id;
+			
+			KeStatsAddWorkSteal();
+			Count--;
 		}
+		
+		if (IsListEmpty(Head))
+			TheirScheduler->ExecQueueMask &= ~QUEUE_BIT(i);
 	}
 }
 
+// Pulls threads from the busiest processor if it has significantly more threads queued
+// than this one.  Closer processors are preferred, to keep threads near their caches.
+static void KepBalanceLoad()
+{
+	KiAssertOwnDispatcherLock();
+	
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	PKSCHEDULER Scheduler = &Prcb->Scheduler;
+	
+	PKPRCB Busiest = NULL;
+	int BusiestDistance = 0;
+	
+	for (int i = 0; i < KeProcessorCount; i++)
+	{
+		PKPRCB OtherPrcb = KeProcessorList[i];
+		if (OtherPrcb == Prcb)
+			continue;
+		
+		int Imbalance = OtherPrcb->Scheduler.ThreadsOnQueueCount - Scheduler->ThreadsOnQueueCount;
+		if (Imbalance < LOAD_BALANCE_MIN_IMBALANCE)
+			continue;
+		
+		int Distance = KepGetProcessorDistance(Prcb, OtherPrcb);
+		if (!Busiest ||
+			Distance < BusiestDistance ||
+			(Distance == BusiestDistance && Busiest->Scheduler.ThreadsOnQueueCount < OtherPrcb->Scheduler.ThreadsOnQueueCount))
+		{
+			Busiest = OtherPrcb;
+			BusiestDistance = Distance;
+		}
+	}
+	
+	if (!Busiest)
+		return;
+	
+	int Imbalance = Busiest->Scheduler.ThreadsOnQueueCount - Scheduler->ThreadsOnQueueCount;
+	KepStealManyThreads(&Busiest->Scheduler, Imbalance / 2);
+	KiCheckOverloadedExecQueues();
+}
+
 PKTHREAD KiGetNextThread(bool MayDowngrade)
 {
 	KiAssertOwnDispatcherLock();
@@ -560,12 +798,15 @@ PKTHREAD KiGetNextThread(bool MayDowngrade)
 	if (CurrentThread)
 		MinPriority = CurrentThread->BasePriority;
 	
-	if (KiMoreAggressiveWorkStealing &&
-		KepGetNextProcessorToStealWorkFrom() != KeGetCurrentPRCB()->Id)
+#ifndef SCHED_DISABLE_WORKSTEALING
+	// Balance the load periodically, or right away if some processor is overcrowded.
+	uint64_t Now = HalGetTickCount();
+	if (KiMoreAggressiveWorkStealing || Now >= Scheduler->NextLoadBalance)
 	{
-		// Steal many, many threads from this overcrowded processor.
-		KepStealManyThreads();
+		KepBalanceLoad();
+		Scheduler->NextLoadBalance = Now + HalGetTickFrequency() * LOAD_BALANCE_INTERVAL_US / 1000000;
 	}
+#endif
 	
 	// The "trick" behind this function is that we REALLY don't want to downgrade priority.
 	
@@ -615,11 +856,15 @@ void KiPerformYield()
 	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
 	PKTHREAD CurrentThread = Scheduler->CurrentThread;
 	
-	if (CurrentThread &&
-		CurrentThread->BasePriority != PRIORITY_IDLE &&
-		CurrentThread->TickScheduledAt)
+	if (CurrentThread && CurrentThread->TickScheduledAt)
 	{
-		AtFetchAdd(Scheduler->TicksSpentNonIdle, HalGetTickCount() - CurrentThread->TickScheduledAt);
+		uint64_t RunTime = HalGetTickCount() - CurrentThread->TickScheduledAt;
+		
+		CurrentThread->Statistics.RunTime += RunTime;
+		
+		if (CurrentThread->BasePriority != PRIORITY_IDLE)
+			AtFetchAdd(Scheduler->TicksSpentNonIdle, RunTime);
+		
 		CurrentThread->TickScheduledAt = 0;
 	}
 	
@@ -712,6 +957,38 @@ void KiSwitchToNextThread()
 	
 	Thread->TickScheduledAt = HalGetTickCount();
 	
+	// Account for the time the thread spent on the execution queue.
+	if (Thread->EnqueuedTime)
+	{
+		uint64_t Latency = Thread->TickScheduledAt - Thread->EnqueuedTime;
+		
+		Thread->Statistics.ReadyTime += Latency;
+		if (Thread->Statistics.MaxReadyLatency < Latency)
+			Thread->Statistics.MaxReadyLatency = Latency;
+		
+		Thread->EnqueuedTime = 0;
+	}
+	
+	int ProcessorId = KeGetCurrentPRCB()->Id;
+	if (Thread->LastRunProcessor != ProcessorId)
+	{
+		if (Thread->LastRunProcessor != -1)
+			Thread->Statistics.Migrations++;
+		
+		Thread->LastRunProcessor = ProcessorId;
+	}
+	
+	if (OldThread != Thread)
+	{
+		KeStatsAddContextSwitch();
+		
+		// If the old thread is still runnable, it was preempted (or has yielded).
+		if (OldThread && OldThread->Status == KTHREAD_STATUS_READY)
+			OldThread->Statistics.InvoluntarySwitches++;
+		else if (OldThread)
+			OldThread->Statistics.VoluntarySwitches++;
+	}
+	
 	// Switch to the next thread's architecture specific context.
 	KiSwitchArchSpecificContext(Thread, OldThread);
 	
@@ -805,23 +1082,31 @@ void KeTimerTick()
 	// 2. You really don't need it!
 	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
 	
-	SchedDebug("Scheduler->QuantumUntil: %lld  HalGetTickCount: %lld", Scheduler->QuantumUntil, HalGetTickCount());
+	uint64_t Now = HalGetTickCount();
+	
+	SchedDebug("Scheduler->QuantumUntil: %lld  HalGetTickCount: %lld", Scheduler->QuantumUntil, Now);
 	
-	// TODO: Optimize the amount of reschedules we perform.
+	// If a timer has expired, have the timer queue dispatched.  The DPC interrupt
+	// programs the interrupt timer again afterwards.
+	uint64_t TimerExpiry = AtLoad(Scheduler->NextTimerExpiry);
+	bool TimerExpired = TimerExpiry && TimerExpiry <= Now + 100;
 	
-	if (Scheduler->QuantumUntil <= HalGetTickCount())
+	if (TimerExpired)
+		KeIssueSoftwareInterrupt(IPL_DPC);
+	
+	// A quantum of zero means the thread runs without one.
+	if (Scheduler->QuantumUntil && Scheduler->QuantumUntil <= Now)
 	{
 		// Thread's quantum has expired!!
 		SchedDebug("Thread Quantum Has Expired");
 		KiSetPendingQuantumEnd();
 	}
-	else if (HalUseOneShotIntTimer())
+	else if (!TimerExpired)
 	{
-		// We arrived a little too early! Reschedule in a bit
-		HalRequestInterruptInTicks(100);
+		// We arrived a little too early, or the deadline was too far away to
+		// program all at once.  Wait for the next deadline, if there is one.
+		KiProgramIntTimer();
 	}
-	
-	// If using a periodic timer, a new tick will just show up again soon.
 }
 
 // -------- Exposed API --------
@@ -850,6 +1135,14 @@ NO_RETURN void KeTerminateThread(KPRIORITY Increment)
 	KiCancelTimer(&Thread->WaitTimer);
 	KiCancelTimer(&Thread->SleepTimer);
 	
+	// Let another thread waiting on our queue run in our place.
+	if (Thread->Queue)
+	{
+		RemoveEntryList(&Thread->QueueListEntry);
+		KiActivateWaiterQueue(Thread->Queue);
+		Thread->Queue = NULL;
+	}
+	
 	// Mark the thread as terminated.
 	Thread->Status = KTHREAD_STATUS_TERMINATED;
 	
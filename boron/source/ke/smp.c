@@ -78,6 +78,8 @@ void KiCPUBootstrap(PLOADER_AP LoaderAp)
 	
 	KeSchedulerInit(MmAllocateKernelStack());
 	
+	KiStartThreadedDpcThread();
+	
 	HalInitSystemMP();
 	
 	if (Prcb->IsBootstrap)
@@ -233,7 +235,7 @@ void KeInitSMP()
 		Prcb->IsBootstrap = bIsBSP;
 		Prcb->LoaderAp    = LoaderAp;
 		Prcb->Ipl         = IPL_NOINTS;  // run it at the highest IPL for now. We'll lower it later
-		InitializeListHead(&Prcb->DpcQueue.List);
+		KiInitializeDpcQueues(Prcb);
 		
 		LoaderAp->ExtraArgument = Prcb;
 		KeProcessorList[i] = Prcb;
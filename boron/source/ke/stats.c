@@ -11,16 +11,144 @@ Abstract:
 Author:
 	iProgramInCpp - 14 October 2023
 ***/
-#include <ke.h>
+#include "ki.h"
 
-KSTATISTICS KiStatistics;
+extern PKPRCB* KeProcessorList;
+extern int     KeProcessorCount;
+
+extern LIST_ENTRY KiGlobalThreadList;
+extern KSPIN_LOCK KiGlobalThreadListLock;
+
+static PKSTATISTICS KepGetCurrentStatistics()
+{
+	PKPRCB Prcb = KeGetCurrentPRCB();
+	
+	// Interrupts may show up before the PRCB was set up.
+	if (!Prcb)
+		return NULL;
+	
+	return &Prcb->Statistics;
+}
+
+#define KEP_ADD_STATISTIC(Member) do {                 \
+	PKSTATISTICS Statistics = KepGetCurrentStatistics(); \
+	if (Statistics)                                      \
+		AtAddFetch(Statistics->Member, 1);               \
+} while (0)
 
 void KeStatsAddContextSwitch()
 {
-	AtAddFetch(KiStatistics.ContextSwitches, 1);
+	KEP_ADD_STATISTIC(ContextSwitches);
+}
+
+void KeStatsAddWorkSteal()
+{
+	KEP_ADD_STATISTIC(WorkSteals);
+}
+
+void KeStatsAddIpi()
+{
+	KEP_ADD_STATISTIC(IpisReceived);
+}
+
+void KeStatsAddDpc()
+{
+	KEP_ADD_STATISTIC(DpcsRun);
+}
+
+void KeStatsAddInterrupt()
+{
+	KEP_ADD_STATISTIC(Interrupts);
 }
 
 int KeStatsGetContextSwitchCount()
 {
-	return AtLoad(KiStatistics.ContextSwitches);
+	uint64_t Count = 0;
+	
+	for (int i = 0; i < KeProcessorCount; i++)
+		Count += AtLoad(KeProcessorList[i]->Statistics.ContextSwitches);
+	
+	return (int) Count;
+}
+
+void KeStatsGetProcessorStatistics(int Processor, PKSTATISTICS Statistics, uint64_t* TicksSpentNonIdle)
+{
+	ASSERT(Processor >= 0 && Processor < KeProcessorCount);
+	
+	PKPRCB Prcb = KeProcessorList[Processor];
+	
+	Statistics->ContextSwitches = AtLoad(Prcb->Statistics.ContextSwitches);
+	Statistics->WorkSteals      = AtLoad(Prcb->Statistics.WorkSteals);
+	Statistics->IpisReceived    = AtLoad(Prcb->Statistics.IpisReceived);
+	Statistics->DpcsRun         = AtLoad(Prcb->Statistics.DpcsRun);
+	Statistics->Interrupts      = AtLoad(Prcb->Statistics.Interrupts);
+	
+	*TicksSpentNonIdle = AtLoad(Prcb->Scheduler.TicksSpentNonIdle);
+}
+
+// Takes a snapshot of a thread's statistics.  The time spent in the
+// thread's current state is added to the snapshot, since it's only
+// accounted for when the thread leaves that state.
+static void KepSnapshotThreadStatistics(PKTHREAD Thread, PKTHREAD_STATISTICS Statistics, uint64_t Now)
+{
+	KiAssertOwnDispatcherLock();
+	
+	*Statistics = Thread->Statistics;
+	
+	if (Thread->Status == KTHREAD_STATUS_RUNNING && Thread->TickScheduledAt && Now > Thread->TickScheduledAt)
+		Statistics->RunTime += Now - Thread->TickScheduledAt;
+	
+	if (Thread->WaitStartedAt && Now > Thread->WaitStartedAt)
+		Statistics->WaitTime += Now - Thread->WaitStartedAt;
+	
+	if (Thread->EnqueuedTime && Now > Thread->EnqueuedTime)
+		Statistics->ReadyTime += Now - Thread->EnqueuedTime;
+}
+
+void KeEnumerateThreads(PKENUMERATE_THREAD_ROUTINE Routine, void* Context)
+{
+	KIPL Ipl = KiLockDispatcher();
+	
+	KIPL Ipl2;
+	KeAcquireSpinLock(&KiGlobalThreadListLock, &Ipl2);
+	
+	uint64_t Now = HalGetTickCount();
+	
+	for (PLIST_ENTRY Entry = KiGlobalThreadList.Flink;
+		Entry != &KiGlobalThreadList;
+		Entry = Entry->Flink)
+	{
+		PKTHREAD Thread = CONTAINING_RECORD(Entry, KTHREAD, EntryGlobal);
+		
+		KTHREAD_STATISTICS Statistics;
+		KepSnapshotThreadStatistics(Thread, &Statistics, Now);
+		
+		if (!Routine(Thread, &Statistics, Context))
+			break;
+	}
+	
+	KeReleaseSpinLock(&KiGlobalThreadListLock, Ipl2);
+	KiUnlockDispatcher(Ipl);
+}
+
+void KeEnumerateThreadsProcess(PKPROCESS Process, PKENUMERATE_THREAD_ROUTINE Routine, void* Context)
+{
+	KIPL Ipl = KiLockDispatcher();
+	
+	uint64_t Now = HalGetTickCount();
+	
+	for (PLIST_ENTRY Entry = Process->ThreadList.Flink;
+		Entry != &Process->ThreadList;
+		Entry = Entry->Flink)
+	{
+		PKTHREAD Thread = CONTAINING_RECORD(Entry, KTHREAD, EntryProc);
+		
+		KTHREAD_STATISTICS Statistics;
+		KepSnapshotThreadStatistics(Thread, &Statistics, Now);
+		
+		if (!Routine(Thread, &Statistics, Context))
+			break;
+	}
+	
+	KiUnlockDispatcher(Ipl);
 }
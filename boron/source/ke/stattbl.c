@@ -0,0 +1,82 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ke/stattbl.c
+	
+Abstract:
+	This module implements the statistics tables, which are used
+	by the lock, DPC and pool tag statistics.
+	
+	A statistics table is an open addressing hash table, keyed by
+	a nonzero word such as a call site.  The statistics are kept
+	by code that runs at any IPL, including the spin lock code
+	itself, so the tables can't be protected by locks.  Instead,
+	entries are claimed with a compare-exchange and never freed,
+	and their counters are updated with atomic operations.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "ki.h"
+
+static size_t KepHashStatKey(uintptr_t Key, size_t EntryCount)
+{
+	uint64_t Hash = (uint64_t) Key * 0x9E3779B97F4A7C15ULL;
+	return (size_t)(Hash >> 32) & (EntryCount - 1);
+}
+
+void* KeStatTableLookUp(
+	void* Table,
+	size_t EntryCount,
+	size_t EntrySize,
+	size_t KeyOffset,
+	uintptr_t Key,
+	bool* OutClaimed
+)
+{
+	ASSERT(Key != 0);
+	ASSERT((EntryCount & (EntryCount - 1)) == 0);
+	
+	*OutClaimed = false;
+	size_t Index = KepHashStatKey(Key, EntryCount);
+	
+	for (size_t i = 0; i < EntryCount; i++)
+	{
+		uint8_t* Entry = (uint8_t*) Table + ((Index + i) & (EntryCount - 1)) * EntrySize;
+		uintptr_t* EntryKey = (uintptr_t*)(Entry + KeyOffset);
+		
+		uintptr_t Existing = AtLoadMO(*EntryKey, ATOMIC_MEMORD_ACQUIRE);
+		if (Existing == Key)
+			return Entry;
+		
+		if (Existing != 0)
+			continue;
+		
+		// The entry is free, try to claim it.  If someone else claimed it
+		// first, check if they did so for the same key.
+		if (AtCompareExchange(EntryKey, &Existing, Key))
+		{
+			*OutClaimed = true;
+			return Entry;
+		}
+		
+		if (Existing == Key)
+			return Entry;
+	}
+	
+	// The table is full.
+	return NULL;
+}
+
+void KeStatUpdateMaximum(uint64_t* Maximum, uint64_t Value)
+{
+	uint64_t Current = AtLoad(*Maximum);
+	
+	while (Value > Current)
+	{
+		if (AtCompareExchange(Maximum, &Current, Value))
+			break;
+	}
+}
@@ -15,13 +15,23 @@ Author:
 #include <ke.h>
 #include <string.h>
 #include <rtl/symdefs.h>
+#include <rtl/elf.h>
 
-// TODO: The lookups could be optimized with a sorted list and a binary search.
+// Both tables are generated at build time by scripts/generate_symbols_*.py.
 
 uintptr_t DbgLookUpAddress(const char* Name)
 {
-	for (PCKSYMBOL Symbol = KiSymbolTable; Symbol != KiSymbolTableEnd; Symbol++)
+	if (KiSymbolHashTableSize == 0)
+		return 0;
+	
+	size_t Mask = KiSymbolHashTableSize - 1;
+	
+	for (size_t Slot = RtlGnuHash(Name) & Mask;
+	     KiSymbolHashTable[Slot] != 0;
+	     Slot = (Slot + 1) & Mask)
 	{
+		PCKSYMBOL Symbol = &KiSymbolTable[KiSymbolHashTable[Slot] - 1];
+		
 		if (strcmp(Symbol->Name, Name) == 0)
 			return Symbol->Address;
 	}
@@ -29,27 +39,90 @@ uintptr_t DbgLookUpAddress(const char* Name)
 	return 0;
 }
 
+// Finds the last symbol whose address is at most Address, or NULL if there is none.
+static PCKSYMBOL DbgpFindSymbolAtOrBefore(uintptr_t Address)
+{
+	size_t Low = 0, High = KiSymbolTableSize;
+	
+	while (Low < High)
+	{
+		size_t Middle = Low + (High - Low) / 2;
+		
+		if (KiSymbolTable[Middle].Address <= Address)
+			Low = Middle + 1;
+		else
+			High = Middle;
+	}
+	
+	if (Low == 0)
+		return NULL;
+	
+	return &KiSymbolTable[Low - 1];
+}
+
 const char* DbgLookUpRoutineNameByAddressExact(uintptr_t Address)
 {
+	PCKSYMBOL Symbol = DbgpFindSymbolAtOrBefore(Address);
+	
+	if (!Symbol || Symbol->Address != Address)
+		return NULL;
+	
+	// If several symbols share this address, return the first one.
+	while (Symbol != KiSymbolTable && Symbol[-1].Address == Address)
+		Symbol--;
+	
+	return Symbol->Name;
+}
+
+// Gets the size of the biggest symbol, which bounds how far before an address the
+// symbols containing it can start.
+static uintptr_t DbgpGetMaximumSymbolSize()
+{
+	static uintptr_t MaximumSize;
+	static bool Computed;
+	
+	if (AtLoad(Computed))
+		return MaximumSize;
+	
+	// If several threads get here at once, they all compute the same thing.
+	uintptr_t Size = 0;
 	for (PCKSYMBOL Symbol = KiSymbolTable; Symbol != KiSymbolTableEnd; Symbol++)
 	{
-		if (Symbol->Address == Address)
-			return Symbol->Name;
+		if (Size < Symbol->Size)
+			Size = Symbol->Size;
 	}
 	
-	return NULL;
+	MaximumSize = Size;
+	AtStore(Computed, true);
+	return Size;
 }
 
 const char* DbgLookUpRoutineNameByAddress(uintptr_t Address, uintptr_t* BaseAddressOut)
 {
-	for (PCKSYMBOL Symbol = KiSymbolTable; Symbol != KiSymbolTableEnd; Symbol++)
+	PCKSYMBOL Symbol = DbgpFindSymbolAtOrBefore(Address);
+	if (!Symbol)
+		return NULL;
+	
+	// The closest symbol might not contain the address while an earlier, bigger
+	// one does.  Walk back as far as a symbol could reach, and return the first
+	// one in the table which contains the address, like a linear scan would.
+	uintptr_t MaximumSize = DbgpGetMaximumSymbolSize();
+	PCKSYMBOL Found = NULL;
+	
+	while (Address - Symbol->Address < MaximumSize)
 	{
-		if (Symbol->Address <= Address && Address < Symbol->Address + Symbol->Size)
-		{
-			*BaseAddressOut = Symbol->Address;
-			return Symbol->Name;
-		}
+		if (Address - Symbol->Address < Symbol->Size)
+			Found = Symbol;
+		
+		if (Symbol == KiSymbolTable)
+			break;
+		
+		Symbol--;
 	}
 	
-	return NULL;
+	if (!Found)
+		return NULL;
+	
+	*BaseAddressOut = Found->Address;
+	return Found->Name;
 }
@@ -61,6 +61,7 @@ void KiInitializeThread(PKTHREAD Thread, void* KernelStack, size_t KernelStackSi
 	Thread->Status = KTHREAD_STATUS_INITIALIZED;
 	
 	Thread->LastProcessor = KeGetCurrentPRCB()->Id;
+	Thread->LastRunProcessor = -1;
 	Thread->DontSteal = false;
 	Thread->Probing = false;
 	Thread->Suspended = true;
@@ -17,10 +17,31 @@ Author:
 
 // XXX: A tree is better in theory, but is it really in practice?
 
+static void KiUpdateNextTimerExpiry(PKSCHEDULER Scheduler)
+{
+	uint64_t Expiry = 0;
+	
+	if (!IsEmptyRbTree(&Scheduler->TimerTree))
+	{
+		PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&Scheduler->TimerTree);
+		
+		Expiry = CONTAINING_RECORD(Entry, KTIMER, EntryTree)->ExpiryTick;
+	}
+	
+	AtStore(Scheduler->NextTimerExpiry, Expiry);
+}
+
 bool KiRemoveTimerTree(PKTIMER Timer)
 {
 	ASSERT(Timer->Scheduler);
-	return RemoveItemRbTree(&Timer->Scheduler->TimerTree, &Timer->EntryTree);
+	bool Status = RemoveItemRbTree(&Timer->Scheduler->TimerTree, &Timer->EntryTree);
+	
+	// N.B. If the first timer was removed, the interrupt timer is left as is.  It
+	// will fire a little early, and KeTimerTick will program it again.
+	if (Timer->ExpiryTick == Timer->Scheduler->NextTimerExpiry)
+		KiUpdateNextTimerExpiry(Timer->Scheduler);
+	
+	return Status;
 }
 
 bool KiInsertTimerTree(PKTIMER Timer)
@@ -28,8 +49,20 @@ bool KiInsertTimerTree(PKTIMER Timer)
 	// XXX: What if the key is 32-bit for some reason? Should the key stay 64-bit instead?
 	Timer->EntryTree.Key = Timer->ExpiryTick;
 	
-	Timer->Scheduler = KiGetCurrentScheduler();
-	return InsertItemRbTree(&Timer->Scheduler->TimerTree, &Timer->EntryTree);
+	PKSCHEDULER Scheduler = KiGetCurrentScheduler();
+	Timer->Scheduler = Scheduler;
+	
+	if (!InsertItemRbTree(&Scheduler->TimerTree, &Timer->EntryTree))
+		return false;
+	
+	// If this timer expires before all others, the interrupt timer may have to fire sooner.
+	if (!Scheduler->NextTimerExpiry || Timer->ExpiryTick < Scheduler->NextTimerExpiry)
+	{
+		AtStore(Scheduler->NextTimerExpiry, Timer->ExpiryTick);
+		KiProgramIntTimer();
+	}
+	
+	return true;
 }
 
 bool KiCancelTimer(PKTIMER Timer)
@@ -98,31 +131,6 @@ uint64_t KiGetNextTimerExpiryTick()
 	return Expiry;
 }
 
-uint64_t KiGetNextTimerExpiryItTick()
-{
-	KiAssertOwnDispatcherLock();
-	
-	PRBTREE TimerTree = &KiGetCurrentScheduler()->TimerTree;
-	
-	uint64_t Expiry = 0;
-	
-	if (!IsEmptyRbTree(TimerTree))
-	{
-		PRBTREE_ENTRY Entry = GetFirstEntryRbTree(TimerTree);
-		
-		Expiry = CONTAINING_RECORD(Entry, KTIMER, EntryTree)->ExpiryTick;
-	}
-	
-	if (!Expiry)
-		return Expiry;
-	
-	uint64_t Duration = (Expiry - HalGetTickCount()) * HalGetIntTimerFrequency() / HalGetTickFrequency();
-	if (Duration == 0)
-		Duration = 1;
-	
-	return Duration;
-}
-
 void KiDispatchTimerObjects()
 {
 	KiAssertOwnDispatcherLock();
@@ -154,8 +162,14 @@ void KiDispatchTimerQueue()
 {
 	KIPL Ipl = KiLockDispatcher();
 	
-	if (KiGetNextTimerExpiryTick() <= HalGetTickCount() + 100)
+	uint64_t Expiry = KiGetNextTimerExpiryTick();
+	if (Expiry && Expiry <= HalGetTickCount() + 100)
+	{
 		KiDispatchTimerObjects();
+		
+		// Arm the interrupt timer for the next timer in line, if any.
+		KiProgramIntTimer();
+	}
 	
 	KiUnlockDispatcher(Ipl);
 }
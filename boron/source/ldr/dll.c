@@ -13,6 +13,7 @@ Author:
 ***/
 #include "ldri.h"
 #include <rtl/elf.h>
+#include <ex.h>
 
 // This would be a layering violation, but this component is only active during system init, so it's OK, I think
 //
@@ -348,11 +349,34 @@ void LdrInitializeHal()
 	LdrpInitializeDllByIndex(&KeLoadedDLLs[0]);
 }
 
+INIT
+static void LdrpInitializeDllTask(void* Context)
+{
+	LdrpInitializeDllByIndex(Context);
+}
+
 INIT
 void LdrInitializeDrivers()
 {
-	for (int i = 1; i < KeLoadedDLLCount; i++)
+	int Count = KeLoadedDLLCount - 1;
+	if (Count <= 0)
+		return;
+	
+	// Drivers don't depend on each other during initialization, so their entry
+	// points may run concurrently if the boot configuration allows it.
+	void** Contexts = MmAllocatePool(POOL_NONPAGED, sizeof(void*) * Count);
+	const char** Names = MmAllocatePool(POOL_NONPAGED, sizeof(const char*) * Count);
+	if (!Contexts || !Names)
+		KeCrash("Could not allocate driver initialization tasks");
+	
+	for (int i = 0; i < Count; i++)
 	{
-		LdrpInitializeDllByIndex(&KeLoadedDLLs[i]);
+		Contexts[i] = &KeLoadedDLLs[i + 1];
+		Names[i] = KeLoadedDLLs[i + 1].Name;
 	}
+	
+	ExRunBootTasks(LdrpInitializeDllTask, Contexts, Names, Count);
+	
+	MmFreePool(Contexts);
+	MmFreePool(Names);
 }
@@ -68,6 +68,10 @@ bool MmCheckPteLocation(uintptr_t Address, bool GenerateMissingLevels)
 		return false;
 	}
 	
+	// If a huge page is mapped here, there are no PTEs to speak of, so split it first.
+	if (MmIsHugePte(*Pte) && MiGetHugePteLocation(Address))
+		return MiSplitHugePage(Address);
+	
 	return true;
 }
 
@@ -79,6 +83,40 @@ PMMPTE MmGetPteLocationCheck(uintptr_t Address, bool GenerateMissingLevels)
 	return MmGetPteLocation(Address);
 }
 
+bool MiCheckPteLocationOrSkip(uintptr_t Address, uintptr_t* SkipToAddress)
+{
+	ASSERT(Address < MI_PML1_LOCATION || Address >= MI_PML1_LOC_END);
+	
+	PMMPTE Pte;
+	uintptr_t Span;
+	
+	// A missing PML4 entry means 512 GB of nothing.
+	Span = 1ULL << 39;
+	Pte = MmGetPteLocation(MI_PTE_LOC(MI_PTE_LOC(MI_PTE_LOC(Address))));
+	if (!MmIsPresentPte(*Pte))
+		goto Missing;
+	
+	Span = 1ULL << 30;
+	Pte = MmGetPteLocation(MI_PTE_LOC(MI_PTE_LOC(Address)));
+	if (!MmIsPresentPte(*Pte))
+		goto Missing;
+	
+	Span = 1ULL << 21;
+	Pte = MmGetPteLocation(MI_PTE_LOC(Address));
+	if (!MmIsPresentPte(*Pte))
+		goto Missing;
+	
+	// If a huge page can't be split, skip over it, since it has no PTEs.
+	if (MmIsHugePte(*Pte) && MiGetHugePteLocation(Address) && !MiSplitHugePage(Address))
+		goto Missing;
+	
+	return true;
+	
+Missing:
+	*SkipToAddress = (Address + Span) & ~(Span - 1);
+	return false;
+}
+
 // Creates a page mapping.
 HPAGEMAP MiCreatePageMapping()
 {
@@ -126,7 +164,9 @@ void MiFreePageMapping(HPAGEMAP PageMap)
 
 /***
 	Function description:
-		Gets the PTE (Page Table Entry) pointer for the specified address.
+		Gets the pointer to the entry of the specified page mapping level
+		(1 for the PTE itself, 2 for the PML2 entry, and so on) which maps
+		the specified address.
 		
 		If AllocateMissingPMLs is set, also creates the page mapping levels
 		along the way, otherwise, if the levels aren't already there, this
@@ -140,12 +180,14 @@ void MiFreePageMapping(HPAGEMAP PageMap)
 		Address  - The starting address of the range to map
 		
 		AllocateMissingPMLs - See function description.
+		
+		Level    - The page mapping level whose entry is returned.
 	
 	Return value:
-		The address of the PTE, or NULL. See function description on why
+		The address of the entry, or NULL. See function description on why
 		it would return NULL.
 ***/
-PMMPTE MiGetPTEPointer(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissingPMLs)
+static PMMPTE MmpGetPtePointerAtLevel(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissingPMLs, int Level)
 {
 	const uintptr_t FiveElevenMask = 0x1FF;
 	
@@ -172,7 +214,7 @@ PMMPTE MiGetPTEPointer(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissing
 	HPAGEMAP CurrentLevel = Mapping;
 	PMMPTE EntryPointer = NULL;
 	
-	for (int pml = 4; pml >= 1; pml--)
+	for (int pml = 4; pml >= Level; pml--)
 	{
 		PMMPTE Entries = MmGetHHDMOffsetAddr(CurrentLevel);
 		
@@ -180,7 +222,7 @@ PMMPTE MiGetPTEPointer(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissing
 		
 		MMPTE Entry = *EntryPointer;
 		
-		if (pml > 1 && !MmIsPresentPte(Entry))
+		if (pml > Level && !MmIsPresentPte(Entry))
 		{
 			// not present!! Do we allocate it?
 			if (!AllocateMissingPMLs)
@@ -211,9 +253,10 @@ PMMPTE MiGetPTEPointer(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissing
 			*EntryPointer = Entry = MmBuildPte(pfn, MM_PROT_READ | MM_PROT_WRITE | MM_PROT_EXEC | SupervisorBit);
 		}
 		
-		if (pml > 1 && MmIsUnsupportedHigherLevelPte(Entry))
+		if (pml > Level && MmIsUnsupportedHigherLevelPte(Entry))
 		{
-			// Higher page size, we can't allocate here.  Probably HHDM or something - the kernel itself doesn't use this
+			// Higher page size, we can't allocate here.  Either a huge page or something the boot loader
+			// mapped, such as the HHDM.
 			//DbgPrint("MiGetPTEPointer: Address %p contains a higher page size, we don't support that for now", Address);
 			return NULL;
 		}
@@ -228,6 +271,33 @@ PMMPTE MiGetPTEPointer(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissing
 	return EntryPointer;
 }
 
+/***
+	Function description:
+		Gets the PTE (Page Table Entry) pointer for the specified address.
+		
+		If AllocateMissingPMLs is set, also creates the page mapping levels
+		along the way, otherwise, if the levels aren't already there, this
+		return NULL.
+		
+		This function also returns NULL if allocation of one of the PMLs fails,
+		or if the address is mapped by a huge page.
+	
+	Parameters:
+		Mapping  - The handle to the page table to be modified
+		
+		Address  - The starting address of the range to map
+		
+		AllocateMissingPMLs - See function description.
+	
+	Return value:
+		The address of the PTE, or NULL. See function description on why
+		it would return NULL.
+***/
+PMMPTE MiGetPTEPointer(HPAGEMAP Mapping, uintptr_t Address, bool AllocateMissingPMLs)
+{
+	return MmpGetPtePointerAtLevel(Mapping, Address, AllocateMissingPMLs, 1);
+}
+
 /***
 	Function description:
 		Frees the lowest PML at the specified address if it is vacant.
@@ -422,6 +492,178 @@ bool MiMapPhysicalPage(uintptr_t PhysicalPage, uintptr_t Address, uintptr_t Perm
 	return true;
 }
 
+PMMPTE MiGetHugePteLocation(uintptr_t Address)
+{
+	PMMPTE Pte;
+	
+	Pte = MmGetPteLocation(MI_PTE_LOC(MI_PTE_LOC(MI_PTE_LOC(Address))));
+	if (!MmIsPresentPte(*Pte))
+		return NULL;
+	
+	// A 1 GB page was set up by the boot loader, the memory manager doesn't use them.
+	Pte = MmGetPteLocation(MI_PTE_LOC(MI_PTE_LOC(Address)));
+	if (!MmIsPresentPte(*Pte) || MmIsUnsupportedHigherLevelPte(*Pte))
+		return NULL;
+	
+	// The huge pages that the memory manager creates are always backed by the PMM.
+	Pte = MmGetPteLocation(MI_PTE_LOC(Address));
+	if (!MmIsHugePte(*Pte) || !MmIsFromPmmPte(*Pte))
+		return NULL;
+	
+	return Pte;
+}
+
+/***
+	Function description:
+		Maps a huge page at a huge page aligned address, in the current
+		page mapping.
+		
+		This only succeeds if nothing is mapped in the range that the huge
+		page covers.  If a page table is present there, but all of its
+		entries are zero (because the range was used and then unmapped
+		before), it is freed and replaced by the huge page.
+	
+	Parameters:
+		Address  - The huge page aligned address to map the page at.
+		
+		Pfn      - The first PFN of the huge page.
+		
+		PageBits - The permission bits of the huge page.
+	
+	Return value:
+		Whether the huge page was mapped.
+***/
+bool MiMapHugePage(uintptr_t Address, MMPFN Pfn, uintptr_t PageBits)
+{
+	ASSERT((Address & (MM_HUGE_PAGE_SIZE - 1)) == 0);
+	
+	MMPTE ZeroPte = MmBuildZeroPte();
+	PMMPTE PdePtr = MmpGetPtePointerAtLevel(MiGetCurrentPageMap(), Address, true, 2);
+	if (!PdePtr)
+		return false;
+	
+	MMPTE OldPde = *PdePtr;
+	if (MmIsPresentPte(OldPde))
+	{
+		if (MmIsUnsupportedHigherLevelPte(OldPde))
+			return false;
+		
+		PMMPTE PageTable = MmGetHHDMOffsetAddr(MmPFNToPhysPage(MmGetPfnPte(OldPde)));
+		for (size_t i = 0; i < MI_HUGE_PAGE_PAGES; i++)
+		{
+			if (!MmIsEqualPte(PageTable[i], ZeroPte))
+				return false;
+		}
+	}
+	else if (!MmIsEqualPte(OldPde, ZeroPte))
+	{
+		return false;
+	}
+	
+	*PdePtr = MmBuildHugePte(Pfn, PageBits);
+	
+	if (MmIsPresentPte(OldPde))
+	{
+		// The old page table may still be cached by the processors, so flush it out
+		// before freeing it.
+		MmIssueTLBShootDown(Address, MI_HUGE_PAGE_PAGES);
+		MmFreePhysicalPage(MmGetPfnPte(OldPde));
+	}
+	
+	return true;
+}
+
+/***
+	Function description:
+		Unmaps the huge page at a huge page aligned address, in the current
+		page mapping, and frees its memory.
+	
+	Parameters:
+		Address  - The huge page aligned address of the page.
+	
+	Return value:
+		None.
+***/
+void MiUnmapHugePage(uintptr_t Address)
+{
+	PMMPTE PdePtr = MiGetHugePteLocation(Address);
+	ASSERT(PdePtr);
+	
+	MMPTE OldPde = *PdePtr;
+	*PdePtr = MmBuildZeroPte();
+	
+	MmIssueTLBShootDown(Address, MI_HUGE_PAGE_PAGES);
+	
+	MiFreeHugePhysicalPage(MmGetPfnPte(OldPde));
+	MiRecordHugePageRelease(false);
+}
+
+/***
+	Function description:
+		Splits the huge page which maps the specified address into regular
+		pages, in the current page mapping.  The new PTEs map the same
+		physical pages, with the same permissions, and each of them holds
+		the reference to its page that the huge page held.
+		
+		The huge page is replaced atomically, so this may be called with
+		the address space lock held shared.
+	
+	Parameters:
+		Address  - An address inside the huge page.
+	
+	Return value:
+		True if the address is not mapped by a huge page anymore, false if
+		the page table couldn't be allocated.
+***/
+bool MiSplitHugePage(uintptr_t Address)
+{
+	Address &= ~(MM_HUGE_PAGE_SIZE - 1);
+	
+	PMMPTE PdePtr = MiGetHugePteLocation(Address);
+	if (!PdePtr)
+		return true;
+	
+	MMPFN PageTablePfn = MmAllocatePhysicalPage();
+	if (PageTablePfn == PFN_INVALID)
+	{
+		DbgPrint("MiSplitHugePage: Ran out of memory trying to split the huge page at %p", Address);
+		return false;
+	}
+	
+	uintptr_t SupervisorBit;
+	if (Address >= MM_KERNEL_SPACE_BASE)
+		SupervisorBit = 0;
+	else
+		SupervisorBit = MM_PROT_USER;
+	
+	PMMPTE PageTable = MmGetHHDMOffsetAddr(MmPFNToPhysPage(PageTablePfn));
+	MMPTE NewPde = MmBuildPte(PageTablePfn, MM_PROT_READ | MM_PROT_WRITE | MM_PROT_EXEC | SupervisorBit);
+	MMPTE OldPde = *PdePtr;
+	
+	// The processor may set the accessed and dirty bits of the huge page while the page
+	// table is being filled in, so retry until they've been carried over.
+	do
+	{
+		if (!MmIsHugePte(OldPde))
+		{
+			// Someone else split it first.
+			MmFreePhysicalPage(PageTablePfn);
+			return true;
+		}
+		
+		MMPFN Pfn = MmGetPfnPte(OldPde);
+		uintptr_t PageBits = MmGetPageBitsPte(OldPde);
+		
+		for (size_t i = 0; i < MI_HUGE_PAGE_PAGES; i++)
+			PageTable[i] = MmBuildPte(Pfn + i, PageBits);
+	}
+	while (!AtCompareExchange(&MmHardwarePte(*PdePtr), &MmHardwarePte(OldPde), MmHardwarePte(NewPde)));
+	
+	MmIssueTLBShootDown(Address, MI_HUGE_PAGE_PAGES);
+	MiRecordHugePageRelease(true);
+	return true;
+}
+
 /***
 	Function description:
 		Unmap a range of memory from the specified page mapping.
@@ -439,6 +681,22 @@ void MiUnmapPages(uintptr_t Address, size_t LengthPages)
 	HPAGEMAP Mapping = MiGetCurrentPageMap();
 	MMPTE ZeroPte = MmBuildZeroPte();
 	
+	// Step 0. Unmap the huge pages which lie entirely inside the range, and split the ones
+	// which only partly overlap it, so that the steps below see their PTEs.
+	uintptr_t EndAddress = Address + LengthPages * PAGE_SIZE;
+	for (uintptr_t HugeAddress = Address & ~(MM_HUGE_PAGE_SIZE - 1);
+	     HugeAddress < EndAddress;
+	     HugeAddress += MM_HUGE_PAGE_SIZE)
+	{
+		if (!MiGetHugePteLocation(HugeAddress))
+			continue;
+		
+		if (HugeAddress >= Address && HugeAddress + MM_HUGE_PAGE_SIZE <= EndAddress)
+			MiUnmapHugePage(HugeAddress);
+		else if (!MiSplitHugePage(HugeAddress))
+			DbgPrint("MiUnmapPages: Huge page at %p could not be split and will stay mapped", HugeAddress);
+	}
+	
 	// Step 1. Unset the PRESENT bit on all pages in the range.
 	for (size_t i = 0; i < LengthPages; i++)
 	{
@@ -534,31 +792,39 @@ uintptr_t MiGetTopOfPoolManagedArea()
 bool MiMapAnonPages(uintptr_t Address, size_t SizePages, uintptr_t Permissions, bool NonPaged)
 {
 	HPAGEMAP Mapping = MiGetCurrentPageMap();
-	
-	// As an optimization, we'll wait until the PML1 index rolls over to zero before reloading the PTE pointer.
-	uint64_t CurrentPml1 = PML1_IDX(Address);
+	uintptr_t StartAddress = Address;
 	size_t DonePages = 0;
 	
-	PMMPTE PtePtr = MiGetPTEPointer(Mapping, Address, true);
+	// As an optimization, we'll wait until the PML1 index rolls over to zero before reloading the PTE pointer.
+	PMMPTE PtePtr = NULL;
 	
-	for (size_t i = 0; i < SizePages; i++)
+	while (DonePages < SizePages)
 	{
+		// Non-paged memory which covers an entire huge page is mapped with one, if possible,
+		// since it is allocated right away anyway.
+		if (NonPaged &&
+			(Address & (MM_HUGE_PAGE_SIZE - 1)) == 0 &&
+			SizePages - DonePages >= MI_HUGE_PAGE_PAGES &&
+			MiMapAnonHugePage(Address, Permissions))
+		{
+			Address   += MM_HUGE_PAGE_SIZE;
+			DonePages += MI_HUGE_PAGE_PAGES;
+			PtePtr = NULL;
+			continue;
+		}
+		
+		if (!PtePtr || PML1_IDX(Address) == 0)
+			PtePtr = MiGetPTEPointer(Mapping, Address, true);
+		
 		// If one of these fails, then we should roll back.
 		if (!MmpMapSingleAnonPageAtPte(PtePtr, Permissions, NonPaged))
 			goto ROLLBACK;
 		
-		// Increase the address size, get the next PTE pointer, update the current PML1, and
-		// increment the number of mapped pages (since this one was successfully mapped).
+		// Increase the address size, get the next PTE pointer, and increment the number
+		// of mapped pages (since this one was successfully mapped).
 		Address += PAGE_SIZE;
 		PtePtr++;
-		CurrentPml1++;
 		DonePages++;
-		
-		if (CurrentPml1 % (PAGE_SIZE / sizeof(MMPTE)) == 0)
-		{
-			// We have rolled over.
-			PtePtr = MiGetPTEPointer(Mapping, Address, true);
-		}
 	}
 	
 	// All allocations have succeeded! Let the caller know and don't undo our work. :)
@@ -566,7 +832,7 @@ bool MiMapAnonPages(uintptr_t Address, size_t SizePages, uintptr_t Permissions,
 	
 ROLLBACK:
 	// Unmap all the pages that we have mapped.
-	MiUnmapPages(Address, DonePages);
+	MiUnmapPages(StartAddress, DonePages);
 	return false;
 }
 
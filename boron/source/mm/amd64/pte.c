@@ -192,6 +192,20 @@ bool MmIsUnsupportedHigherLevelPte(MMPTE Pte)
 	return false;
 }
 
+MMPTE MmBuildHugePte(MMPFN Pfn, uintptr_t PageBits)
+{
+	ASSERT((Pfn & (MM_HUGE_PAGE_SIZE / PAGE_SIZE - 1)) == 0);
+	
+	MMPTE Pte = MmBuildPte(Pfn, PageBits);
+	MmHardwarePte(Pte) |= MM_AMD64_PTE_PAGESIZE;
+	return Pte;
+}
+
+bool MmIsHugePte(MMPTE Pte)
+{
+	return MmIsPresentPte(Pte) && (MmHardwarePte(Pte) & MM_AMD64_PTE_PAGESIZE);
+}
+
 bool MmIsFromPmmPte(MMPTE Pte)
 {
 	return (MmIsPresentPte(Pte) || MmWasPresentPte(Pte)) && (MmHardwarePte(Pte) & MM_AMD64_PTE_ISFROMPMM);
@@ -136,6 +136,13 @@ static bool MmpFreeUnusedMappingLevelsInCurrentMapPML(PMMPTE Pte, int MapLevel)
 		if (!MmIsPresentPte(*Pte))
 			continue;
 		
+		// A huge page maps memory directly, there's no page table below it to free.
+		if (MmIsHugePte(*Pte))
+		{
+			FreeParent = false;
+			continue;
+		}
+		
 		PMMPTE SubPte = MiGetSubPteAddress(Pte);
 		
 		if (MmpIsPteListCompletelyEmpty(SubPte))
@@ -0,0 +1,417 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/anonpage.c
+	
+Abstract:
+	This module manages the pages of anonymous sections and
+	copy-on-write overlays.
+	
+	These pages have no file to be written back to.  Once no
+	process has one mapped anymore, the working set manager may
+	move it out of memory.  It's compressed into the compressed
+	page store if it compresses well, otherwise it's written to
+	the page file.  The entry in the object's SLA records where
+	the page went, and the page is brought back in by the object's
+	ReadPage function.
+	
+	The object's mutex is never held while I/O is performed on
+	the page file, because the file system and the storage driver
+	acquire mutexes of lower levels.  Instead, the entry is marked
+	busy for the duration of the I/O.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+
+static PMICOMPRESSED_PAGE MmpGetCompressedPageEntry(MIANON_ENTRY SlaEntry)
+{
+	ASSERT(SlaEntry.Data.Compressed);
+	return (PMICOMPRESSED_PAGE) (SlaEntry.Entry & ~MI_ANON_ENTRY_COMPRESSED);
+}
+
+static bool MmpIsResidentEntry(MIANON_ENTRY SlaEntry)
+{
+	return SlaEntry.Entry != MM_SLA_NO_DATA && !SlaEntry.Data.Compressed && !SlaEntry.Data.PageFile;
+}
+
+// Replaces an entry.  The entry already exists, so this doesn't need any memory.
+static void MmpReplaceEntry(PMMSLA Sla, uint64_t Index, MMSLA_ENTRY Entry)
+{
+	MMSLA_ENTRY NewEntry = MmAssignEntrySla(Sla, Index, Entry);
+	ASSERT(NewEntry == Entry);
+}
+
+// Gets the SLA holding the pages of an anonymous section or a CoW overlay, and the
+// mutex guarding it.
+static bool MmpGetSlaAnonymous(void* MappableObject, PKMUTEX* Mutex, PMMSLA* Sla)
+{
+	POBJECT_TYPE Type = ObGetObjectType(MappableObject);
+	
+	if (Type == MmSectionObjectType)
+	{
+		PMMSECTION Section = MappableObject;
+		*Mutex = &Section->Mutex;
+		*Sla = &Section->Sla;
+		return true;
+	}
+	
+	if (Type == MmOverlayObjectType)
+	{
+		PMMOVERLAY Overlay = MappableObject;
+		*Mutex = &Overlay->Mutex;
+		*Sla = &Overlay->Sla;
+		return true;
+	}
+	
+	return false;
+}
+
+static void MmpLockMutex(PKMUTEX Mutex)
+{
+	BSTATUS Status = KeWaitForSingleObject(Mutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ASSERT(SUCCEEDED(Status));
+}
+
+// Brings a compressed page back into memory.  The SLA's mutex is held.
+static BSTATUS MmpDecompressPageAnonymous(PMMSLA Sla, uint64_t Index, PMIANON_ENTRY SlaEntry)
+{
+	PMICOMPRESSED_PAGE CompressedPage = MmpGetCompressedPageEntry(*SlaEntry);
+	
+	MMPFN Pfn = MmAllocatePhysicalPage();
+	if (Pfn == PFN_INVALID)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	if (!MiDecompressPage(CompressedPage, Pfn))
+	{
+		DbgPrint("MmpDecompressPageAnonymous: Page %llu of SLA %p is damaged.", Index, Sla);
+		MmFreePhysicalPage(Pfn);
+		return STATUS_HARDWARE_IO_ERROR;
+	}
+	
+	SlaEntry->Entry = MiMakeResidentEntryAnonymous(Pfn);
+	MmpReplaceEntry(Sla, Index, SlaEntry->Entry);
+	
+	MiFreeCompressedPage(CompressedPage);
+	return STATUS_SUCCESS;
+}
+
+// Reads a page back from the page file.  The SLA's mutex is held, but is released
+// during the read.
+static BSTATUS MmpReadPageAnonymous(PKMUTEX Mutex, PMMSLA Sla, uint64_t Index, PMIANON_ENTRY SlaEntry)
+{
+	MMPFN Pfn = MmAllocatePhysicalPage();
+	if (Pfn == PFN_INVALID)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	uint32_t Slot = SlaEntry->Data.Pfn;
+	
+	SlaEntry->Data.Busy = 1;
+	MmpReplaceEntry(Sla, Index, SlaEntry->Entry);
+	MiBeginPageIn();
+	
+	KeReleaseMutex(Mutex);
+	BSTATUS Status = MiReadPageFile(Slot, Pfn);
+	MmpLockMutex(Mutex);
+	
+	// No one else touches a busy entry, and the object can't be deleted because the
+	// caller holds a reference to it, so the entry is still the same.
+	ASSERT(MmLookUpEntrySla(Sla, Index) == SlaEntry->Entry);
+	
+	if (FAILED(Status))
+	{
+		DbgPrint(
+			"MmpReadPageAnonymous: Cannot read page %llu of SLA %p from slot %u: %s (%d)",
+			Index,
+			Sla,
+			Slot,
+			RtlGetStatusString(Status),
+			Status
+		);
+		
+		SlaEntry->Data.Busy = 0;
+		MmpReplaceEntry(Sla, Index, SlaEntry->Entry);
+		MiEndPageIn();
+		
+		MmFreePhysicalPage(Pfn);
+		return Status;
+	}
+	
+	SlaEntry->Entry = MiMakeResidentEntryAnonymous(Pfn);
+	MmpReplaceEntry(Sla, Index, SlaEntry->Entry);
+	MiEndPageIn();
+	
+	MiFreePageFileSlot(Slot);
+	return STATUS_SUCCESS;
+}
+
+BSTATUS MiGetPageAnonymous(PKMUTEX Mutex, PMMSLA Sla, uint64_t Index, PMMPFN OutPfn, bool BringIn)
+{
+	BSTATUS Status;
+	MIANON_ENTRY SlaEntry;
+	
+	while (true)
+	{
+		SlaEntry.Entry = MmLookUpEntrySla(Sla, Index);
+		if (SlaEntry.Entry == MM_SLA_NO_DATA)
+		{
+			*OutPfn = PFN_INVALID;
+			return STATUS_SUCCESS;
+		}
+		
+		if (MmpIsResidentEntry(SlaEntry))
+			break;
+		
+		// Bringing the page back takes a while, so it's left to ReadPage, which is
+		// called without the address space lock held.
+		if (!BringIn)
+			return STATUS_MORE_PROCESSING_REQUIRED;
+		
+		if (SlaEntry.Data.Compressed)
+		{
+			Status = MmpDecompressPageAnonymous(Sla, Index, &SlaEntry);
+			if (FAILED(Status))
+				return Status;
+			
+			break;
+		}
+		
+		if (SlaEntry.Data.Busy)
+		{
+			// Someone else is reading this page in.  Wait for them, and look again.
+			KeReleaseMutex(Mutex);
+			MiWaitForPageIn();
+			MmpLockMutex(Mutex);
+			continue;
+		}
+		
+		Status = MmpReadPageAnonymous(Mutex, Sla, Index, &SlaEntry);
+		if (FAILED(Status))
+			return Status;
+		
+		break;
+	}
+	
+	// If the page is being written to the page file, it'll be mapped again, so the
+	// page file writer must not free it once it's done.
+	if (SlaEntry.Data.Busy)
+	{
+		SlaEntry.Data.Busy = 0;
+		MmpReplaceEntry(Sla, Index, SlaEntry.Entry);
+	}
+	
+	MmPageAddReference(SlaEntry.Data.Pfn);
+	*OutPfn = SlaEntry.Data.Pfn;
+	return STATUS_SUCCESS;
+}
+
+void MiFreeEntryAnonymous(MMSLA_ENTRY Entry)
+{
+	if (Entry == MM_SLA_NO_DATA)
+		return;
+	
+	MIANON_ENTRY SlaEntry;
+	SlaEntry.Entry = Entry;
+	
+	if (SlaEntry.Data.Compressed)
+	{
+		MiFreeCompressedPage(MmpGetCompressedPageEntry(SlaEntry));
+		return;
+	}
+	
+	// Whoever is doing I/O on the page holds a reference to the object.
+	ASSERT(!SlaEntry.Data.Busy);
+	
+	if (SlaEntry.Data.PageFile)
+		MiFreePageFileSlot(SlaEntry.Data.Pfn);
+	else
+		MmFreePhysicalPage(SlaEntry.Data.Pfn);
+}
+
+// Checks if the entry holds this page, and if no one but the SLA references it.
+static bool MmpCanPageOutEntry(MIANON_ENTRY SlaEntry, MMPFN Pfn)
+{
+	if (!MmpIsResidentEntry(SlaEntry) || SlaEntry.Data.Busy || SlaEntry.Data.Pfn != Pfn)
+		return false;
+	
+	// New references to the page are only handed out with the SLA's mutex held, so
+	// this can't change until the mutex is released.
+	KIPL Ipl = MiLockPfdb();
+	int ReferenceCount = MiGetReferenceCountPfn(Pfn);
+	MiUnlockPfdb(Ipl);
+	
+	return ReferenceCount == 1;
+}
+
+void MiTrimPageAnonymous(void* MappableObject, uint64_t SectionOffset, MMPFN Pfn)
+{
+	PKMUTEX Mutex;
+	PMMSLA Sla;
+	MIANON_ENTRY SlaEntry;
+	
+	// The page may belong to the object itself, or, if it's a CoW overlay that has no
+	// copy of its own, to one of the objects below it.
+	while (true)
+	{
+		if (!MmpGetSlaAnonymous(MappableObject, &Mutex, &Sla))
+			return;
+		
+		if (ObGetObjectType(MappableObject) == MmOverlayObjectType)
+			SectionOffset += ((PMMOVERLAY) MappableObject)->SectionOffset;
+		
+		MmpLockMutex(Mutex);
+		
+		SlaEntry.Entry = MmLookUpEntrySla(Sla, SectionOffset);
+		if (SlaEntry.Entry != MM_SLA_NO_DATA)
+			break;
+		
+		KeReleaseMutex(Mutex);
+		
+		if (ObGetObjectType(MappableObject) != MmOverlayObjectType)
+			return;
+		
+		MappableObject = ((PMMOVERLAY) MappableObject)->Parent;
+	}
+	
+	if (!MmpCanPageOutEntry(SlaEntry, Pfn))
+	{
+		KeReleaseMutex(Mutex);
+		return;
+	}
+	
+	PMICOMPRESSED_PAGE CompressedPage = MiCompressPage(Pfn);
+	if (CompressedPage)
+	{
+		MmpReplaceEntry(Sla, SectionOffset, (MMSLA_ENTRY) CompressedPage | MI_ANON_ENTRY_COMPRESSED);
+		KeReleaseMutex(Mutex);
+		
+		MmFreePhysicalPage(Pfn);
+		return;
+	}
+	
+	// The page doesn't compress well, so write it to the page file.  If the queue is
+	// full, the page stays in memory until it's trimmed again.
+	if (MiIsPageFileActive())
+		MiQueuePageOut(MappableObject, SectionOffset, Pfn);
+	
+	KeReleaseMutex(Mutex);
+}
+
+void MiPageOutAnonymous(void* MappableObject, PMIPAGE_OUT_REQUEST Requests, size_t Count)
+{
+	PKMUTEX Mutex;
+	PMMSLA Sla;
+	MIANON_ENTRY SlaEntry;
+	
+	MMPFN Pages[MI_PAGE_FILE_CLUSTER];
+	uint64_t Indices[MI_PAGE_FILE_CLUSTER];
+	size_t PageCount = 0;
+	
+	ASSERT(Count <= MI_PAGE_FILE_CLUSTER);
+	
+	// Only anonymous sections and CoW overlays are ever queued.
+	if (!MmpGetSlaAnonymous(MappableObject, &Mutex, &Sla))
+	{
+		ASSERT(!"MiPageOutAnonymous: Not an anonymous object");
+		return;
+	}
+	
+	MmpLockMutex(Mutex);
+	
+	// Mark the pages that are still unmapped as busy.  If one is looked up while it's
+	// being written, the busy flag is cleared, and the page stays.
+	for (size_t i = 0; i < Count; i++)
+	{
+		SlaEntry.Entry = MmLookUpEntrySla(Sla, Requests[i].Index);
+		if (!MmpCanPageOutEntry(SlaEntry, Requests[i].Pfn))
+			continue;
+		
+		SlaEntry.Data.Busy = 1;
+		MmpReplaceEntry(Sla, Requests[i].Index, SlaEntry.Entry);
+		
+		Pages[PageCount] = Requests[i].Pfn;
+		Indices[PageCount] = Requests[i].Index;
+		PageCount++;
+	}
+	
+	if (PageCount == 0)
+	{
+		KeReleaseMutex(Mutex);
+		return;
+	}
+	
+	// If the page file is fragmented, fewer slots may be available in a row.  The
+	// pages that don't fit stay in memory.
+	size_t SlotCount = PageCount;
+	uint32_t Slot = MiAllocatePageFileSlots(&SlotCount);
+	if (Slot == MI_PAGE_FILE_SLOT_INVALID)
+		SlotCount = 0;
+	
+	for (size_t i = SlotCount; i < PageCount; i++)
+		MmpReplaceEntry(Sla, Indices[i], MiMakeResidentEntryAnonymous(Pages[i]));
+	
+	if (SlotCount == 0)
+	{
+		KeReleaseMutex(Mutex);
+		return;
+	}
+	
+	// The MDL holds its own references to the pages, so they stay around even if
+	// they're mapped and unmapped again during the write.
+	struct
+	{
+		MDL Base;
+		MMPFN Pages[MI_PAGE_FILE_CLUSTER];
+	}
+	Mdl;
+	
+	MmInitializePageListMdl(&Mdl.Base, Pages, SlotCount, 0);
+	KeReleaseMutex(Mutex);
+	
+	BSTATUS Status = MiWritePageFile(Slot, &Mdl.Base);
+	if (FAILED(Status))
+	{
+		DbgPrint(
+			"MiPageOutAnonymous: Cannot write %zu pages to slot %u: %s (%d)",
+			SlotCount,
+			Slot,
+			RtlGetStatusString(Status),
+			Status
+		);
+	}
+	
+	MmpLockMutex(Mutex);
+	
+	for (size_t i = 0; i < SlotCount; i++)
+	{
+		SlaEntry.Entry = MmLookUpEntrySla(Sla, Indices[i]);
+		
+		bool StillBusy = MmpIsResidentEntry(SlaEntry) && SlaEntry.Data.Busy && SlaEntry.Data.Pfn == Pages[i];
+		
+		if (StillBusy && SUCCEEDED(Status))
+		{
+			SlaEntry.Entry = 0;
+			SlaEntry.Data.PageFile = 1;
+			SlaEntry.Data.Pfn = Slot + i;
+			MmpReplaceEntry(Sla, Indices[i], SlaEntry.Entry);
+			
+			// This is the SLA's reference.  The page is freed along with the MDL.
+			MmFreePhysicalPage(Pages[i]);
+			continue;
+		}
+		
+		if (StillBusy)
+		{
+			SlaEntry.Data.Busy = 0;
+			MmpReplaceEntry(Sla, Indices[i], SlaEntry.Entry);
+		}
+		
+		MiFreePageFileSlot(Slot + i);
+	}
+	
+	KeReleaseMutex(Mutex);
+	MmFreeMdl(&Mdl.Base);
+}
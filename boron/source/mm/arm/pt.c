@@ -210,6 +210,19 @@ PMMPTE MmGetPteLocationCheck(uintptr_t Address, bool GenerateMissingLevels)
 	return MmGetPteLocation(Address);
 }
 
+bool MiCheckPteLocationOrSkip(uintptr_t Address, uintptr_t* SkipToAddress)
+{
+	// Level 2 tables are allocated four at a time, so a missing one always means
+	// that a whole page worth of PTEs is missing.
+	const uintptr_t Span = PAGE_SIZE * PAGE_SIZE / sizeof(MMPTE);
+	
+	if (MmCheckPteLocation(Address, false))
+		return true;
+	
+	*SkipToAddress = (Address + Span) & ~(Span - 1);
+	return false;
+}
+
 PMMPTE MmGetPteLocation(uintptr_t Address)
 {
 	ASSERT(Address < MI_PML1_LOCATION && "MmGetPteLocation for regions inside the L1 and L2 maps is unimplemented.");
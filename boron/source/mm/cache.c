@@ -27,9 +27,12 @@ void MmInitializeCcb(PCCB Ccb)
 
 static void MmpCcbFreeEntrySla(MMSLA_ENTRY Entry)
 {
-	// TODO: remove this page from the standby list if it's there,
-	// and put it on the free list.
-	(void) Entry;
+	if (Entry == MM_SLA_NO_DATA)
+		return;
+	
+	// The page frame must no longer point into this page cache.  If it was
+	// only kept around on the standby list, it's freed too.
+	MmDetachCachedPfn((MMPFN) Entry);
 }
 
 void MmTearDownCcb(PCCB Ccb)
@@ -89,6 +92,8 @@ MMPFN MmGetEntryCcb(PCCB Ccb, uint64_t PageOffset)
 
 BSTATUS MmSetEntryCcb(PCCB Ccb, uint64_t PageOffset, MMPFN InPfn, PMM_PROTOTYPE_PTE_PTR OutPrototypePtePointer)
 {
+	MM_PROTOTYPE_PTE_PTR PrototypePte = 0;
+	
 	MmLockCcb(Ccb);
 	
 	MMSLA_ENTRY SlaEntry = (MMSLA_ENTRY) InPfn;
@@ -96,15 +101,32 @@ BSTATUS MmSetEntryCcb(PCCB Ccb, uint64_t PageOffset, MMPFN InPfn, PMM_PROTOTYPE_
 	if (InPfn == PFN_INVALID)
 		SlaEntry = MM_SLA_NO_DATA;
 	
+	// If another page was put here in the meantime, then that is the page everyone
+	// else uses, so it must not be replaced.
+	if (MmLookUpEntrySla(&Ccb->Sla, PageOffset) != MM_SLA_NO_DATA)
+	{
+		MmUnlockCcb(Ccb);
+		return STATUS_CONFLICTING_ADDRESSES;
+	}
+	
 	MMSLA_ENTRY ReturnValue = MmAssignEntrySlaEx(
 		&Ccb->Sla,
 		PageOffset,
 		SlaEntry,
-		OutPrototypePtePointer
+		&PrototypePte
 	);
 	
+	// Let the page frame know where it's cached.  This way, once the page is no
+	// longer mapped anywhere, it goes on the standby list (or the modified page
+	// list) instead of the free list, and the entry is cleared if it's reclaimed.
+	if (InPfn != PFN_INVALID && ReturnValue == SlaEntry)
+		MmSetPrototypePtePfn(InPfn, PrototypePte);
+	
 	MmUnlockCcb(Ccb);
 	
+	if (OutPrototypePtePointer)
+		*OutPrototypePtePointer = PrototypePte;
+	
 	if (ReturnValue == MM_SLA_OUT_OF_MEMORY) {
 		DbgPrint("MmSetEntryCcb: MmAssignEntrySlaEx returned MM_SLA_OUT_OF_MEMORY!");
 		return STATUS_INSUFFICIENT_MEMORY;
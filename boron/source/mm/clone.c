@@ -9,7 +9,17 @@ Abstract:
 	This module contains the implementation of the MmCloneAddressSpace
 	function.  This function clones the address space of a process, and
 	modifies the original process' address space by inserting overlays
-	on private mappings.
+	on private mappings of objects.
+	
+	Private anonymous memory is not turned into any object.  Instead,
+	its pages are mapped read-only into both processes, and whichever
+	process writes to one of them first gets its own copy (see
+	MiWriteFault).  Page table walks skip absent page table subtrees,
+	so that the cost of a fork depends on how much memory the process
+	has actually touched, rather than how much it has reserved.
+	
+	Huge pages of private anonymous memory are split before anything
+	else, since copy-on-write works on individual pages.
 	
 Author:
 	iProgramInCpp - 12 December 2025
@@ -17,6 +27,72 @@ Author:
 
 #include "mi.h"
 
+// The amount of virtual memory described by one page of PTEs.
+#define MMP_PAGE_TABLE_SPAN (PAGE_SIZE * PAGE_SIZE / sizeof(MMPTE))
+
+// Finds the next run of PTEs in the range [*Address, EndVa) that lie in the same page table,
+// skipping over page table subtrees that don't exist.  Returns the number of PTEs in the run,
+// and updates *Address to the start of the run.  Returns zero if there are no more page tables
+// in the range.
+static size_t MmpNextPageTableRun(uintptr_t* Address, uintptr_t EndVa)
+{
+	uintptr_t Va = *Address;
+	
+	while (Va < EndVa)
+	{
+		uintptr_t SkipTo = 0;
+		if (MiCheckPteLocationOrSkip(Va, &SkipTo))
+		{
+			uintptr_t RunEnd = (Va + MMP_PAGE_TABLE_SPAN) & ~(MMP_PAGE_TABLE_SPAN - 1);
+			if (RunEnd > EndVa || RunEnd < Va)
+				RunEnd = EndVa;
+			
+			*Address = Va;
+			return (RunEnd - Va) / PAGE_SIZE;
+		}
+		
+		// Check for wraparound at the top of the address space.
+		if (SkipTo <= Va)
+			break;
+		
+		Va = SkipTo;
+	}
+	
+	*Address = EndVa;
+	return 0;
+}
+
+#ifdef MM_HUGE_PAGE_SIZE
+
+// Splits every huge page mapped in private anonymous memory, so that its pages can be
+// shared copy-on-write individually.
+static BSTATUS MmpSplitHugePages(PMMVAD_LIST VadList)
+{
+	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&VadList->Tree);
+		Entry != NULL;
+		Entry = GetNextEntryRbTree(Entry))
+	{
+		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
+		
+		// Huge pages are only used for committed private anonymous memory.
+		if (!Vad->Flags.Private || !Vad->Flags.Committed || Vad->MappedObject)
+			continue;
+		
+		uintptr_t Address = (Vad->Node.StartVa + MM_HUGE_PAGE_SIZE - 1) & ~(MM_HUGE_PAGE_SIZE - 1);
+		uintptr_t EndVa = Vad->Node.StartVa + Vad->Node.Size * PAGE_SIZE;
+		
+		for (; Address + MM_HUGE_PAGE_SIZE <= EndVa; Address += MM_HUGE_PAGE_SIZE)
+		{
+			if (!MiSplitHugePage(Address))
+				return STATUS_INSUFFICIENT_MEMORY;
+		}
+	}
+	
+	return STATUS_SUCCESS;
+}
+
+#endif
+
 static BSTATUS MmpChangeAnonymousMemoryIntoSections(PMMVAD_LIST VadList)
 {
 	// Note:
@@ -38,48 +114,50 @@ static BSTATUS MmpChangeAnonymousMemoryIntoSections(PMMVAD_LIST VadList)
 			continue;
 		}
 		
-		// Anonymous mapping.  Try and create a section object.  This section
-		// object will represent the new mapping.  Eventually it'll also have
-		// a CoW overlay attached to it, although it's not being done in this
-		// step.
+		// Private anonymous memory stays anonymous.  Its pages are shared with the
+		// new process as they are, and copied on the first write to them.
+		if (Vad->Flags.Private)
+			continue;
+		
+		// Shared anonymous mapping.  Both processes must see each other's writes,
+		// so try and create a section object, which will represent the mapping
+		// in both of them.
 		PMMSECTION Section = NULL;
 		Status = MmCreateAnonymousSectionObject(&Section, Vad->Node.Size * PAGE_SIZE);
 		
 		if (FAILED(Status))
 			break;
 		
-		// Now go through each page and put all of the allocated PFNs inside.
-		for (size_t i = 0; i < Vad->Node.Size; i++)
+		// Now go through each present page and put all of the allocated PFNs inside.
+		uintptr_t Address = Vad->Node.StartVa;
+		uintptr_t EndVa = Vad->Node.StartVa + Vad->Node.Size * PAGE_SIZE;
+		size_t Count;
+		
+		while ((Count = MmpNextPageTableRun(&Address, EndVa)) != 0)
 		{
-			uintptr_t Address = Vad->Node.StartVa + i * PAGE_SIZE;
-			PMMPTE PtePtr = MmGetPteLocationCheck(Address, false);
+			PMMPTE PtePtr = MmGetPteLocation(Address);
 			
-			if (!PtePtr)
-			{
-				// PTE doesn't exist, move along.
-				// TODO: skip ALL PTEs within this page.
-				continue;
-			}
-			
-			MMPTE Pte = *PtePtr;
-			if (MmIsPresentPte(Pte))
+			for (size_t i = 0; i < Count; i++)
 			{
+				MMPTE Pte = PtePtr[i];
+				if (!MmIsPresentPte(Pte))
+					continue;
+				
 				// The PTE has to come from the PMM, I can't explain it otherwise.
 				ASSERT(MmIsFromPmmPte(Pte));
 				
 				MMPFN Pfn = MmGetPfnPte(Pte);
 				
-				uint64_t SectionOffset = (Vad->SectionOffset + i * PAGE_SIZE) / PAGE_SIZE;
+				uint64_t SectionOffset = (Vad->SectionOffset + (Address - Vad->Node.StartVa) + i * PAGE_SIZE) / PAGE_SIZE;
 				Status = MiAssignEntrySection(Section, SectionOffset, Pfn);
 				if (FAILED(Status))
 				{
 					ObDereferenceObject(Section);
-					break;
+					return Status;
 				}
 			}
 			
-			// TODO: What if this is a paged-out PTE? Or some other kind of PTE that is
-			// not committed/decommitted?
+			Address += Count * PAGE_SIZE;
 		}
 		
 		// The section conversion was successful, so put the section reference in
@@ -101,7 +179,7 @@ static void MmpUndoAddedOverlays(PMMVAD_LIST VadList, PRBTREE_ENTRY StopEntry)
 	{
 		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
 		
-		if (!Vad->Flags.Private)
+		if (!Vad->Flags.Private || !Vad->MappedObject)
 			continue;
 		
 		ASSERT(ObGetObjectType(Vad->MappedObject) == MmOverlayObjectType);
@@ -119,16 +197,15 @@ static void MmpReferenceMappedObjects(PMMVAD_LIST VadList)
 		Entry = GetNextEntryRbTree(Entry))
 	{
 		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
-		ASSERT(Vad->MappedObject && "Seriously ridiculous.");
 		
-		ObReferenceObjectByPointer(Vad->MappedObject);
+		if (Vad->MappedObject)
+			ObReferenceObjectByPointer(Vad->MappedObject);
 	}
 }
 
-static BSTATUS MmpAddOverlaysIfNeeded(PMMVAD_LIST VadList, bool WritePTEs)
+static BSTATUS MmpAddOverlaysIfNeeded(PMMVAD_LIST VadList)
 {
 	BSTATUS Status = STATUS_SUCCESS;
-	PRBTREE_ENTRY FailedEntry = NULL;
 	
 	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&VadList->Tree);
 		Entry != NULL;
@@ -136,13 +213,9 @@ static BSTATUS MmpAddOverlaysIfNeeded(PMMVAD_LIST VadList, bool WritePTEs)
 	{
 		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
 		
-		ASSERT(
-			Vad->MappedObject && "You should've done an operation that turned every "
-			"existing anonymous VAD into an anon section"
-		);
-		
-		// Shared mappings aren't subject to this conversion.
-		if (!Vad->Flags.Private)
+		// Shared mappings aren't subject to this conversion, and neither is private
+		// anonymous memory, which is copied page by page instead.
+		if (!Vad->Flags.Private || !Vad->MappedObject)
 			continue;
 		
 		PMMOVERLAY Overlay = NULL;
@@ -154,8 +227,8 @@ static BSTATUS MmpAddOverlaysIfNeeded(PMMVAD_LIST VadList, bool WritePTEs)
 		
 		if (FAILED(Status))
 		{
-			FailedEntry = Entry;
-			goto Rollback;
+			MmpUndoAddedOverlays(VadList, Entry);
+			return Status;
 		}
 		
 		ObDereferenceObject(Vad->MappedObject);
@@ -163,73 +236,9 @@ static BSTATUS MmpAddOverlaysIfNeeded(PMMVAD_LIST VadList, bool WritePTEs)
 	}
 	
 	// Okay. Currently *EVERY* privately mapped object has been turned into a CoW
-	// overlay.  Now remove every privately mapped area of memory from the address
-	// space.  It'll be faulted back in through the overlay.
-	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&VadList->Tree);
-		Entry != NULL;
-		Entry = GetNextEntryRbTree(Entry))
-	{
-		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
-		
-		ASSERT(Vad->MappedObject && "This is ridiculous.");
-		
-		if (!Vad->Flags.Private)
-			continue;
-		
-		MMPTE CommittedButNotFaultedInPte = MmBuildZeroPte();
-		if (!Vad->Flags.Committed)
-			CommittedButNotFaultedInPte = MmBuildAbsentPte(MM_PAGE_COMMITTED);
-		
-		// Now go through each page and put all of the allocated PFNs inside.
-		for (size_t i = 0; WritePTEs && i < Vad->Node.Size; i++)
-		{
-			uintptr_t Address = Vad->Node.StartVa + i * PAGE_SIZE;
-			PMMPTE PtePtr = MmGetPteLocationCheck(Address, false);
-			
-			if (!PtePtr)
-			{
-				// This can happen in two cases:
-				// - in VADs where Vad->Flags.Committed = 1, when nobody accessed the
-				//   actual VAD in this X MB region, and
-				// - in VADs where Vad->Flags.Committed = 0, when nobody committed the
-				//   region covered by this X MB of address space.
-				//
-				// In either case, there is NO information here, so we can just move
-				// over this part entirely.
-				
-				// TODO: skip ALL PTEs within this page.
-				continue;
-			}
-			
-			MMPTE Pte = *PtePtr;
-			if (MmIsPresentPte(Pte))
-			{
-				// The PTE has to come from the PMM, I can't explain it otherwise.
-				ASSERT(MmIsFromPmmPte(Pte));
-				
-				MMPFN Pfn = MmGetPfnPte(Pte);
-				MmFreePhysicalPage(Pfn);
-				
-				*PtePtr = CommittedButNotFaultedInPte;
-			}
-			
-			// TODO: What if this is a paged-out PTE? Or some other kind of PTE that is
-			// not committed/decommitted?
-		}
-	}
-	
-	if (WritePTEs) {
-		KeFlushTLB();
-	}
-	
-	return Status;
-	
-Rollback:
-	MmpUndoAddedOverlays(VadList, FailedEntry);
-	if (WritePTEs) {
-		KeFlushTLB();
-	}
-	
+	// overlay.  The pages which are already mapped stay where they are, but they
+	// will be write protected by MmpClonePageTables, so that the first write to
+	// each of them goes through the overlay.
 	return Status;
 }
 
@@ -251,71 +260,180 @@ static BSTATUS MmpCloneAddressNodes(PRBTREE DestTree, PRBTREE SrcTree, size_t It
 	return STATUS_SUCCESS;
 }
 
-static BSTATUS MmpReplicateCommitPtesIfNeeded(PEPROCESS DestinationProcess, PMMVAD_LIST VadList)
+// Fills in the destination process' page tables for every VAD, and write protects the pages
+// that the two processes will share.
+//
+// Pages of private anonymous memory are mapped into the destination process as they are, but
+// read-only, and with an extra reference.  For every other kind of VAD, the destination only
+// receives the commit state of each page, and will fault the pages in through the mapped object.
+//
+// Only page tables that actually exist in the source process are visited, and the TLB is only
+// flushed once, at the end.
+static BSTATUS MmpClonePageTables(PEPROCESS DestinationProcess, PMMVAD_LIST VadList)
 {
+	BSTATUS Status = STATUS_SUCCESS;
 	MMPTE PteCommitted, PteDecommitted, PteZero;
 	PteCommitted = MmBuildAbsentPte(MM_PAGE_COMMITTED);
 	PteDecommitted = MmBuildAbsentPte(MM_PAGE_DECOMMITTED);
 	PteZero = MmBuildZeroPte();
 	
+	uintptr_t FlushStart = UINTPTR_MAX, FlushEnd = 0;
+	
+	// The PTEs for the destination are prepared here, so that it only has to be attached
+	// once per page table.
+	PMMPTE DestPtes = MmAllocatePool(POOL_NONPAGED, PAGE_SIZE);
+	if (!DestPtes)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
 	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&VadList->Tree);
-		Entry != NULL;
+		Entry != NULL && SUCCEEDED(Status);
 		Entry = GetNextEntryRbTree(Entry))
 	{
 		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
 		
+		const bool IsPrivateAnonymous = Vad->Flags.Private && !Vad->MappedObject;
 		const bool MustFillInCommittedPtes = !Vad->Flags.Committed;
 		const bool MustFillInDecommittedPtes = Vad->Flags.Committed;
 		
-		for (size_t i = 0; i < Vad->Node.Size; i++)
+		uintptr_t Address = Vad->Node.StartVa;
+		uintptr_t EndVa = Vad->Node.StartVa + Vad->Node.Size * PAGE_SIZE;
+		size_t Count;
+		
+		while ((Count = MmpNextPageTableRun(&Address, EndVa)) != 0)
 		{
-			uintptr_t Address = Vad->Node.StartVa + i * PAGE_SIZE;
-			PMMPTE PtePtr = MmGetPteLocationCheck(Address, false);
+			PMMPTE PtePtr = MmGetPteLocation(Address);
+			bool HasDestPtes = false;
+			bool HasPresentPtes = false;
 			
-			if (!PtePtr)
+			for (size_t i = 0; i < Count; i++)
 			{
-				// This is already being imitated, funnily enough.
-				continue;
-			}
-			
-			MMPTE DestPte = MmBuildZeroPte();
-			MMPTE Pte = *PtePtr;
-			if (MmIsPresentPte(Pte))
-			{
-				DestPte = MmBuildAbsentPte(MM_PAGE_COMMITTED);
-			}
-			else
-			{
-				if (MmIsCommittedPte(Pte))
+				MMPTE DestPte = PteZero;
+				MMPTE Pte = PtePtr[i];
+				
+				if (MmIsPresentPte(Pte))
+				{
+					HasPresentPtes = true;
+					
+					if (IsPrivateAnonymous)
+					{
+						// The PTE has to come from the PMM, I can't explain it otherwise.
+						ASSERT(MmIsFromPmmPte(Pte));
+						DestPte = MmSetPageBitsPte(Pte, MmGetPageBitsPte(Pte) & ~MM_PROT_WRITE);
+					}
+					else if (MustFillInCommittedPtes)
+					{
+						DestPte = PteCommitted;
+					}
+				}
+				else if (MustFillInCommittedPtes && MmIsCommittedPte(Pte))
+				{
 					DestPte = PteCommitted;
-				else if (MmIsDecommittedPte(Pte))
+				}
+				else if (MustFillInDecommittedPtes && MmIsDecommittedPte(Pte))
+				{
 					DestPte = PteDecommitted;
+				}
+				
+				DestPtes[i] = DestPte;
+				if (!MmIsEqualPte(DestPte, PteZero))
+					HasDestPtes = true;
 			}
 			
-			if (!MmIsEqualPte(Pte, PteZero) &&
-			    ((MustFillInCommittedPtes && MmIsEqualPte(DestPte, PteCommitted)) ||
-				 (MustFillInDecommittedPtes && MmIsEqualPte(DestPte, PteDecommitted))))
+			if (HasDestPtes)
 			{
-				// This is really, *really*, inefficient.  We could do this in a different way,
-				// or disable this entirely and just force every VAD to be committed.
-				DbgPrint("%s: setting PTE for VA %p", __func__, Address);
 				PEPROCESS OldProcess = PsSetAttachedProcess(DestinationProcess);
 				
 				PMMPTE DestPtePtr = MmGetPteLocationCheck(Address, true);
+				if (DestPtePtr)
+					memcpy(DestPtePtr, DestPtes, Count * sizeof(MMPTE));
+				
+				PsSetAttachedProcess(OldProcess);
+				
 				if (!DestPtePtr)
 				{
-					PsSetAttachedProcess(OldProcess);
-					return STATUS_INSUFFICIENT_MEMORY;
+					Status = STATUS_INSUFFICIENT_MEMORY;
+					break;
 				}
+			}
+			
+			// Now account for the destination's references to the shared pages, and make
+			// sure that the first write to any private page, from either process, faults.
+			if (HasPresentPtes && Vad->Flags.Private)
+			{
+				KIPL PfdbIpl = MiLockPfdb();
 				
-				*DestPtePtr = DestPte;
+				for (size_t i = 0; i < Count; i++)
+				{
+					MMPTE Pte = PtePtr[i];
+					if (!MmIsPresentPte(Pte))
+						continue;
+					
+					if (IsPrivateAnonymous)
+						MiPageAddReferenceWithPfdbLocked(MmGetPfnPte(Pte));
+					
+					if (~MmGetPageBitsPte(Pte) & MM_PROT_WRITE)
+						continue;
+					
+					PtePtr[i] = MmSetPageBitsPte(Pte, MmGetPageBitsPte(Pte) & ~MM_PROT_WRITE);
+					
+					uintptr_t PageVa = Address + i * PAGE_SIZE;
+					if (FlushStart > PageVa)
+						FlushStart = PageVa;
+					if (FlushEnd < PageVa + PAGE_SIZE)
+						FlushEnd = PageVa + PAGE_SIZE;
+				}
 				
-				PsSetAttachedProcess(OldProcess);
+				MiUnlockPfdb(PfdbIpl);
 			}
+			
+			Address += Count * PAGE_SIZE;
 		}
 	}
 	
-	return STATUS_SUCCESS;
+	// Even if this failed part of the way, the pages that were write protected until then
+	// need to be flushed.
+	if (FlushStart < FlushEnd)
+		MmIssueTLBShootDown(FlushStart, (FlushEnd - FlushStart) / PAGE_SIZE);
+	
+	MmFreePool(DestPtes);
+	return Status;
+}
+
+// Undoes MmpClonePageTables on the destination process' side, in case a later step fails.
+// The source process' pages stay write protected, but since they are no longer shared,
+// writing to them will simply make them writable again.
+static void MmpReleaseClonedPageTables(PEPROCESS DestinationProcess, PMMVAD_LIST DestVadList)
+{
+	MMPTE PteZero = MmBuildZeroPte();
+	PEPROCESS OldProcess = PsSetAttachedProcess(DestinationProcess);
+	
+	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&DestVadList->Tree);
+		Entry != NULL;
+		Entry = GetNextEntryRbTree(Entry))
+	{
+		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
+		
+		uintptr_t Address = Vad->Node.StartVa;
+		uintptr_t EndVa = Vad->Node.StartVa + Vad->Node.Size * PAGE_SIZE;
+		size_t Count;
+		
+		while ((Count = MmpNextPageTableRun(&Address, EndVa)) != 0)
+		{
+			PMMPTE PtePtr = MmGetPteLocation(Address);
+			
+			for (size_t i = 0; i < Count; i++)
+			{
+				if (MmIsPresentPte(PtePtr[i]) && MmIsFromPmmPte(PtePtr[i]))
+					MmFreePhysicalPage(MmGetPfnPte(PtePtr[i]));
+				
+				PtePtr[i] = PteZero;
+			}
+			
+			Address += Count * PAGE_SIZE;
+		}
+	}
+	
+	PsSetAttachedProcess(OldProcess);
 }
 
 // This function clones the current process' address space to another process' address space.
@@ -324,11 +442,12 @@ static BSTATUS MmpReplicateCommitPtesIfNeeded(PEPROCESS DestinationProcess, PMMV
 //
 // In particular, the following processes are performed:
 // - Copy heap and VAD items to the destination process
-// - Transparently morph every private anonymous non-object mapping into a copy-on-write mapping
-//   of an anonymous section
+// - Transparently morph every shared anonymous non-object mapping into a mapping of an anonymous
+//   section
 // - For every private mapping of a section or file object, create a copy-on-write overlay on top
 //   of the actual object for both the source and destination processes separately
-// - Replicate the committed state of each mapping for each VAD
+// - Map every present page of private anonymous memory read-only into both processes, to be
+//   copied on the first write to it, and replicate the committed state of every other mapping
 //
 // NOTE: For now, you CANNOT clone an arbitrary process. This always clones the CURRENT
 // process. So before attempting to clone, the caller must attach the process they're
@@ -373,8 +492,14 @@ BSTATUS MmCloneAddressSpace(PEPROCESS DestinationProcess)
 		RemoveItemRbTree(&DestHeap->Tree, &DestHeapOnlyNode->Entry);
 	}
 	
+#ifdef MM_HUGE_PAGE_SIZE
+	Status = MmpSplitHugePages(SrcVadList);
+	if (FAILED(Status))
+		goto Exit2;
+#endif
+	
 	// We need to prepare the source process for symmetric copy-on-write.  To do this, we must ensure
-	// that every anonymous memory VAD is turned into a mappable object referencing VAD.
+	// that every shared anonymous memory VAD is turned into a mappable object referencing VAD.
 	Status = MmpChangeAnonymousMemoryIntoSections(SrcVadList);
 	if (FAILED(Status))
 		goto Exit2;
@@ -393,19 +518,20 @@ BSTATUS MmCloneAddressSpace(PEPROCESS DestinationProcess)
 	// Reference every object referenced in the VADs of the destination process.
 	MmpReferenceMappedObjects(DestVadList);
 	
-	// Add overlays inside both the source and destination.
-	Status = MmpAddOverlaysIfNeeded(SrcVadList, true);
+	// Add overlays inside both the source and destination.  If this fails, the overlays that
+	// were added to that VAD list are removed by MmpAddOverlaysIfNeeded itself.
+	Status = MmpAddOverlaysIfNeeded(SrcVadList);
 	if (FAILED(Status))
 		goto Exit3;
 	
-	Status = MmpAddOverlaysIfNeeded(DestVadList, false);
+	Status = MmpAddOverlaysIfNeeded(DestVadList);
 	if (FAILED(Status))
-		goto Exit3;
+		goto Exit4;
 	
 	// Overlays have been added. Now, we still need to replicate the PTEs for each VAD.
-	Status = MmpReplicateCommitPtesIfNeeded(DestinationProcess, SrcVadList);
+	Status = MmpClonePageTables(DestinationProcess, SrcVadList);
 	if (FAILED(Status))
-		goto Exit3;
+		goto Exit5;
 	
 	// Success
 	if (DestHeapOnlyNode) {
@@ -414,18 +540,24 @@ BSTATUS MmCloneAddressSpace(PEPROCESS DestinationProcess)
 	
 	goto Exit;
 	
+Exit5:
+	MmpReleaseClonedPageTables(DestinationProcess, DestVadList);
+	
+Exit4:
+	MmpUndoAddedOverlays(SrcVadList, NULL);
+	
 Exit3:
 	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&DestVadList->Tree);
 		Entry != NULL;
-		Entry = GetFirstEntryRbTree(&DestVadList->Tree))
+		Entry = GetNextEntryRbTree(Entry))
 	{
 		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
 		
 		if (Vad->MappedObject)
 			ObDereferenceObject(Vad->MappedObject);
+		
+		Vad->MappedObject = NULL;
 	}
-	
-	MmpUndoAddedOverlays(SrcVadList, NULL);
 
 Exit2:
 	// Free every VAD and heap item.
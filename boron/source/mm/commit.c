@@ -14,6 +14,7 @@ Author:
 ***/
 #include <mm.h>
 #include <ex.h>
+#include "mi.h"
 
 //
 // Commits a range of virtual memory, with anonymous pages.
@@ -243,6 +244,22 @@ void MiDecommitVad(PMMVAD_LIST VadList, PMMVAD Vad, size_t StartVa, size_t SizeP
 	PMMPTE Pte = MmGetPteLocation(CurrentVa);
 	for (size_t i = 0; i < SizePages; )
 	{
+	#ifdef MM_HUGE_PAGE_SIZE
+		// A huge page that lies entirely inside the range is freed as a whole.  One that
+		// only partly does is split by MmCheckPteLocation below.
+		if (!SetDecommittedPTE &&
+			(CurrentVa & (MM_HUGE_PAGE_SIZE - 1)) == 0 &&
+			SizePages - i >= MI_HUGE_PAGE_PAGES &&
+			MiGetHugePteLocation(CurrentVa))
+		{
+			MiUnmapHugePage(CurrentVa);
+			CurrentVa += MM_HUGE_PAGE_SIZE;
+			Pte = MmGetPteLocation(CurrentVa);
+			i += MI_HUGE_PAGE_PAGES;
+			continue;
+		}
+	#endif
+		
 		if (i == 0 || ((uintptr_t)Pte & (PAGE_SIZE - 1)) == 0)
 		{
 			// If IsVadCommitted is true, then we would need allocate new PTs
@@ -0,0 +1,112 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/cstore.c
+	
+Abstract:
+	This module implements the compressed page store.
+	
+	Pages of anonymous memory have no file to be written back to.
+	When memory runs low, the working set manager compresses the
+	cold ones into non-paged pool instead, which is much smaller
+	than the pages themselves for most data.  They are decompressed
+	when they are faulted back in.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+#include <rtl/compress.h>
+
+struct _MICOMPRESSED_PAGE
+{
+	uint32_t Size;
+	uint8_t  Data[];
+};
+
+// The pool rounds allocations up to the next slab size, and the tag takes up 8 bytes of
+// it.  A page which doesn't compress to half its size would take up as much memory in
+// the pool as it did before, so it isn't stored.
+#define MMP_MAX_COMPRESSED_SIZE (PAGE_SIZE / 2 - 8 - sizeof(MICOMPRESSED_PAGE))
+
+static RTL_LZ_WORKSPACE MmpCompressWorkspace;
+static uint8_t MmpCompressBuffer[MMP_MAX_COMPRESSED_SIZE];
+
+static size_t   MmpStoredPages;
+static size_t   MmpStoredBytes;
+static uint64_t MmpCompressions;
+static uint64_t MmpDecompressions;
+static uint64_t MmpRejections;
+
+PMICOMPRESSED_PAGE MiCompressPage(MMPFN Pfn)
+{
+	MmBeginUsingHHDM();
+	
+	size_t Size = RtlCompressBufferLz(
+		MmpCompressBuffer,
+		sizeof MmpCompressBuffer,
+		MmGetHHDMOffsetAddrPfn(Pfn),
+		PAGE_SIZE,
+		&MmpCompressWorkspace
+	);
+	
+	MmEndUsingHHDM();
+	
+	if (Size == 0)
+	{
+		AtAddFetch(MmpRejections, 1);
+		return NULL;
+	}
+	
+	size_t AllocationSize = sizeof(MICOMPRESSED_PAGE) + Size;
+	PMICOMPRESSED_PAGE CompressedPage = MmAllocatePoolWithTag(POOL_NONPAGED, AllocationSize, POOL_TAG("MmCp"));
+	if (!CompressedPage)
+		return NULL;
+	
+	CompressedPage->Size = Size;
+	memcpy(CompressedPage->Data, MmpCompressBuffer, Size);
+	
+	AtAddFetch(MmpStoredPages, 1);
+	AtAddFetch(MmpStoredBytes, AllocationSize);
+	AtAddFetch(MmpCompressions, 1);
+	return CompressedPage;
+}
+
+bool MiDecompressPage(PMICOMPRESSED_PAGE CompressedPage, MMPFN Pfn)
+{
+	MmBeginUsingHHDM();
+	
+	size_t Size = RtlDecompressBufferLz(
+		MmGetHHDMOffsetAddrPfn(Pfn),
+		PAGE_SIZE,
+		CompressedPage->Data,
+		CompressedPage->Size
+	);
+	
+	MmEndUsingHHDM();
+	
+	if (Size != PAGE_SIZE)
+		return false;
+	
+	AtAddFetch(MmpDecompressions, 1);
+	return true;
+}
+
+void MiFreeCompressedPage(PMICOMPRESSED_PAGE CompressedPage)
+{
+	AtAddFetch(MmpStoredPages, -1);
+	AtAddFetch(MmpStoredBytes, -(sizeof(MICOMPRESSED_PAGE) + CompressedPage->Size));
+	
+	MmFreePool(CompressedPage);
+}
+
+void MmGetCompressedStoreStatistics(PMM_COMPRESSED_STORE_STATISTICS Statistics)
+{
+	Statistics->StoredPages    = AtLoad(MmpStoredPages);
+	Statistics->StoredBytes    = AtLoad(MmpStoredBytes);
+	Statistics->Compressions   = AtLoad(MmpCompressions);
+	Statistics->Decompressions = AtLoad(MmpDecompressions);
+	Statistics->Rejections     = AtLoad(MmpRejections);
+}
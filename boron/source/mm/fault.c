@@ -124,6 +124,15 @@ static BSTATUS MmpHandleFaultCommittedMappedPage(
 		
 		PFDbgPrint("%s: For VA %p, calling MmReadPageMappable", __func__, Va);
 		Status = MmReadPageMappable(MappedObject, SectionOffset, &Pfn);
+		
+		// Bringing a page back from the compressed page store or the page file needs a
+		// new page.  Wait for the working set manager to free some up, and try again.
+		if (Status == STATUS_INSUFFICIENT_MEMORY)
+		{
+			Status = STATUS_REFAULT_SLEEP;
+			goto Exit;
+		}
+		
 		if (FAILED(Status))
 		{
 			DbgPrint("%s: MmReadPageMappable failed to fulfill request with code %d", __func__, Status);
@@ -161,6 +170,30 @@ Exit:
 	return Status;
 }
 
+#ifdef MM_HUGE_PAGE_SIZE
+
+// Tries to map a huge page over the part of a committed private anonymous VAD that
+// contains the faulting address.  The address space lock must be held exclusively.
+static bool MmpTryMapHugePage(PMMVAD Vad, uintptr_t Va)
+{
+	if (Va >= MM_KERNEL_SPACE_BASE)
+		return false;
+	
+	if (!Vad->Flags.Committed || !Vad->Flags.Private || Vad->MappedObject)
+		return false;
+	
+	// The huge page must lie entirely inside the VAD.
+	uintptr_t HugeVa = Va & ~(MM_HUGE_PAGE_SIZE - 1);
+	uintptr_t VadEndVa = Vad->Node.StartVa + Vad->Node.Size * PAGE_SIZE;
+	if (HugeVa < Vad->Node.StartVa || HugeVa + MM_HUGE_PAGE_SIZE > VadEndVa)
+		return false;
+	
+	uintptr_t PageBits = MmGetPteBitsFromProtection(Vad->Flags.Protection) | MM_PROT_USER;
+	return MiMapAnonHugePage(HugeVa, PageBits);
+}
+
+#endif
+
 BSTATUS MiNormalFault(PEPROCESS Process, uintptr_t Va, PMMPTE PtePtr, KIPL SpaceUnlockIpl, bool* RefaultForWrite)
 {
 	// NOTE: IPL is raised to APC level and the relevant address space's lock is held.
@@ -223,6 +256,18 @@ BSTATUS MiNormalFault(PEPROCESS Process, uintptr_t Va, PMMPTE PtePtr, KIPL Space
 		// the PTE itself.
 		if (!PtePtr)
 		{
+		#ifdef MM_HUGE_PAGE_SIZE
+			// There is no page table here yet, so this may be the first access to this
+			// part of the VAD.  Map all of it at once with a huge page if possible.
+			if (MmpTryMapHugePage(Vad, Va))
+			{
+				MmUnlockVadList(VadList);
+				MmUnlockSpace(SpaceUnlockIpl, Va);
+				*RefaultForWrite = false;
+				return STATUS_SUCCESS;
+			}
+		#endif
+			
 			PtePtr = MmGetPteLocationCheck(Va, true);
 			
 			// If the PTE couldn't be allocated, return with STATUS_REFAULT_SLEEP, waiting for more
@@ -376,6 +421,22 @@ BSTATUS MiWriteFault(UNUSED PEPROCESS Process, uintptr_t Va, PMMPTE PtePtr)
 		MMPFN NewPfn = PFN_INVALID;
 		Status = MmGetPageMappable(Vad->MappedObject, SectionOffset, &NewPfn);
 		
+		if (Status == STATUS_MORE_PROCESSING_REQUIRED)
+		{
+			// The object's page was moved out of memory since it was prepared for writing.
+			// Unmap the old page and refault, so that the page is brought back in by a
+			// normal fault, without the address space lock held.
+			MMPTE OldPte = *PtePtr;
+			*PtePtr = Vad->Flags.Committed ? MmBuildZeroPte() : MmBuildAbsentPte(MM_PAGE_COMMITTED);
+			MmIssueTLBShootDown(Va & PageMask, 1);
+			
+			if (MmIsFromPmmPte(OldPte))
+				MmFreePhysicalPage(MmGetPfnPte(OldPte));
+			
+			MmUnlockVadList(VadList);
+			return STATUS_REFAULT;
+		}
+		
 		if (FAILED(Status))
 		{
 			// NOTE: A normal fault should've been handled first, to bring the page's data
@@ -393,13 +454,49 @@ BSTATUS MiWriteFault(UNUSED PEPROCESS Process, uintptr_t Va, PMMPTE PtePtr)
 		
 		PFDbgPrint("%s: For VA %p, using PFN %d.", __func__, Va, NewPfn);
 		
-		*PtePtr = MmBuildPte(NewPfn, MmGetPageBitsPte(*PtePtr) | MM_PROT_READ | MM_PROT_WRITE | MM_MISC_IS_FROM_PMM);
+		// MmGetPageMappable returned a new reference, so drop the one that the old PTE held.
+		// If the object didn't need to copy anything, this is the same page.
+		MMPTE OldPte = *PtePtr;
+		*PtePtr = MmBuildPte(NewPfn, MmGetPageBitsPte(OldPte) | MM_PROT_READ | MM_PROT_WRITE | MM_MISC_IS_FROM_PMM);
+		
+		if (MmIsFromPmmPte(OldPte))
+			MmFreePhysicalPage(MmGetPfnPte(OldPte));
 	}
 	else
 	{
-		// Anonymous memory, so just upgrade permissions
-		PFDbgPrint("%s: Upgrading permissions because this is anonymous memory.", __func__);
-		*PtePtr = MmSetPageBitsPte(*PtePtr, MmGetPageBitsPte(*PtePtr) | MM_PROT_READ | MM_PROT_WRITE | MM_MISC_IS_FROM_PMM);
+		// Anonymous memory.  If the page is still shared with another process because
+		// of a fork, this is the first write to it since, so give this process its own
+		// copy.  Otherwise, just upgrade permissions.
+		ASSERT(MmIsFromPmmPte(*PtePtr));
+		
+		MMPFN Pfn = MmGetPfnPte(*PtePtr);
+		KIPL PfdbIpl = MiLockPfdb();
+		bool IsShared = MiGetReferenceCountPfn(Pfn) > 1;
+		MiUnlockPfdb(PfdbIpl);
+		
+		if (IsShared)
+		{
+			PFDbgPrint("%s: Copying shared anonymous page.", __func__);
+			MMPFN NewPfn = MmAllocatePhysicalPage();
+			if (NewPfn == PFN_INVALID)
+			{
+				MmUnlockVadList(VadList);
+				return STATUS_REFAULT_SLEEP;
+			}
+			
+			// The old page is still mapped here, so copy it from its user address.
+			MmBeginUsingHHDM();
+			memcpy(MmGetHHDMOffsetAddr(MmPFNToPhysPage(NewPfn)), (void*)(Va & ~(PAGE_SIZE - 1)), PAGE_SIZE);
+			MmEndUsingHHDM();
+			
+			*PtePtr = MmBuildPte(NewPfn, MmGetPageBitsPte(*PtePtr) | MM_PROT_READ | MM_PROT_WRITE | MM_MISC_IS_FROM_PMM);
+			MmFreePhysicalPage(Pfn);
+		}
+		else
+		{
+			PFDbgPrint("%s: Upgrading permissions because this is anonymous memory.", __func__);
+			*PtePtr = MmSetPageBitsPte(*PtePtr, MmGetPageBitsPte(*PtePtr) | MM_PROT_READ | MM_PROT_WRITE | MM_MISC_IS_FROM_PMM);
+		}
 	}
 	
 	MmFlushTlbUpdates();
@@ -440,6 +537,27 @@ BSTATUS MmPageFault(UNUSED uintptr_t FaultPC, uintptr_t FaultAddress, uintptr_t
 	// Attempt to interpret the PTE.
 	KIPL OldIpl = MmLockSpaceExclusive(FaultAddress);
 	
+	// (The working set information is guarded by the address space lock)
+	Process->WorkingSet.PageFaultCount++;
+	
+#ifdef MM_HUGE_PAGE_SIZE
+	// Another thread may have mapped a huge page here while this one was waiting for
+	// the lock.  If the access is allowed, the fault was spurious, so don't split the
+	// huge page just to find that out.
+	PMMPTE HugePtePtr = MiGetHugePteLocation(FaultAddress);
+	if (HugePtePtr)
+	{
+		uintptr_t PageBits = MmGetPageBitsPte(*HugePtePtr);
+		
+		if ((PageBits & MM_PROT_WRITE || ~FaultMode & MM_FAULT_WRITE) &&
+			(PageBits & MM_PROT_EXEC  || ~FaultMode & MM_FAULT_INSNFETCH))
+		{
+			MmUnlockSpace(OldIpl, FaultAddress);
+			return STATUS_SUCCESS;
+		}
+	}
+#endif
+	
 	PMMPTE PtePtr = MmGetPteLocationCheck(FaultAddress, false);
 	
 	// If the PTE is present.
@@ -499,11 +617,10 @@ EarlyExit:
 		DbgPrint("MmPageFault: Out of memory, sleeping %d ms waiting for more memory.", MI_REFAULT_SLEEP_MS);
 		
 		// The page fault could not be serviced due to an out of memory condition.
-		// It will be retried in a few milliseconds.
-		//
-		// TODO: Signal to the correct body that they should start trimming working sets
-		// and paging stuff out.
-		//
+		// It will be retried in a few milliseconds.  In the meantime, have the
+		// working set manager trim some pages.
+		MiWakeWorkingSetManager();
+		
 		// TODO: Instead of waiting on a timer, perhaps wait on some other dispatcher
 		// object that's signaled when there's enough memory.
 		//
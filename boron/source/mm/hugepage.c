@@ -0,0 +1,84 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/hugepage.c
+	
+Abstract:
+	This module implements the policy and the statistics of the
+	huge pages used for anonymous memory and non-paged pool.
+	
+	The huge pages are mapped by the architecture specific page
+	table code, and are split back into regular pages when only
+	part of one has to be changed.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+
+#ifdef MM_HUGE_PAGE_SIZE
+
+static bool MmpHugePagesEnabled = true;
+
+static size_t   MmpHugePagesInUse;
+static uint64_t MmpHugePageAllocations;
+static uint64_t MmpHugePageFallbacks;
+static uint64_t MmpHugePageSplits;
+
+void MiInitHugePages()
+{
+	if (ExIsConfigValue("NoHugePages", CONFIG_YES))
+	{
+		MmpHugePagesEnabled = false;
+		DbgPrint("MM: Huge pages are disabled.");
+	}
+}
+
+bool MiMapAnonHugePage(uintptr_t Address, uintptr_t PageBits)
+{
+	if (!MmpHugePagesEnabled)
+		return false;
+	
+	MMPFN Pfn = MiAllocateHugePhysicalPage();
+	if (Pfn == PFN_INVALID)
+	{
+		AtAddFetch(MmpHugePageFallbacks, 1);
+		return false;
+	}
+	
+	if (!MiMapHugePage(Address, Pfn, PageBits | MM_MISC_IS_FROM_PMM))
+	{
+		MiFreeHugePhysicalPage(Pfn);
+		AtAddFetch(MmpHugePageFallbacks, 1);
+		return false;
+	}
+	
+	AtAddFetch(MmpHugePageAllocations, 1);
+	AtAddFetch(MmpHugePagesInUse, 1);
+	return true;
+}
+
+void MiRecordHugePageRelease(bool Split)
+{
+	AtAddFetch(MmpHugePagesInUse, -1);
+	
+	if (Split)
+		AtAddFetch(MmpHugePageSplits, 1);
+}
+
+#endif
+
+void MmGetHugePageStatistics(PMM_HUGE_PAGE_STATISTICS Statistics)
+{
+#ifdef MM_HUGE_PAGE_SIZE
+	Statistics->PageSize    = MmpHugePagesEnabled ? MM_HUGE_PAGE_SIZE : 0;
+	Statistics->InUse       = AtLoad(MmpHugePagesInUse);
+	Statistics->Allocations = AtLoad(MmpHugePageAllocations);
+	Statistics->Fallbacks   = AtLoad(MmpHugePageFallbacks);
+	Statistics->Splits      = AtLoad(MmpHugePageSplits);
+#else
+	memset(Statistics, 0, sizeof *Statistics);
+#endif
+}
@@ -88,6 +88,18 @@ PMMPTE MmGetPteLocationCheck(uintptr_t Address, bool GenerateMissingLevels)
 	return MmGetPteLocation(Address);
 }
 
+bool MiCheckPteLocationOrSkip(uintptr_t Address, uintptr_t* SkipToAddress)
+{
+	// There is only one level of page tables below the page directory.
+	const uintptr_t Span = PAGE_SIZE * PAGE_SIZE / sizeof(MMPTE);
+	
+	if (MmCheckPteLocation(Address, false))
+		return true;
+	
+	*SkipToAddress = (Address + Span) & ~(Span - 1);
+	return false;
+}
+
 // Creates a page mapping.
 HPAGEMAP MiCreatePageMapping()
 {
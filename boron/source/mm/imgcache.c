@@ -0,0 +1,613 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/imgcache.c
+
+Abstract:
+	This module implements the image section cache.
+
+	When a DLL is loaded, the parts of it which only depend on
+	its load address (its contents after relative relocations
+	are applied) come out identical in every process where it
+	is loaded at the same base.  The first time an image is
+	asked for at a certain base, it is read from its file and
+	relocated into a section object here, keyed by the file's
+	FCB and the image base.  Other processes map views of that
+	section copy-on-write instead of building their own copy.
+
+	The sections are only ever built from the file itself, so
+	no process gets to choose what the others will map.  Every
+	write to the file bumps a sequence number in its CCB, and
+	entries built before the last write are dropped instead of
+	being handed out.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+#include <ex.h>
+#include <io.h>
+#include <rtl/elf.h>
+
+#define MI_IMAGE_SECTION_CACHE_MAX (32)
+
+// Images bigger than this aren't cached, they are loaded privately instead.
+#define MI_IMAGE_SECTION_MAX_SIZE (16 * 1024 * 1024)
+
+// The most program headers an image may have in order to be cached.
+#define MI_IMAGE_SECTION_MAX_PHDRS (64)
+
+#if   defined TARGET_AMD64
+#define MI_RELOC_RELATIVE R_X86_64_RELATIVE
+#elif defined TARGET_I386
+#define MI_RELOC_RELATIVE R_386_RELATIVE
+#elif defined TARGET_ARM
+#define MI_RELOC_RELATIVE R_ARM_RELATIVE
+#else
+#error Hey! Add the relative relocation type here
+#endif
+
+typedef struct
+{
+	LIST_ENTRY ListEntry;
+
+	// Keeps the FCB alive, so that its address can't be reused by another
+	// file while this entry exists.
+	PFILE_OBJECT FileObject;
+
+	PMMSECTION Section;
+	uintptr_t ImageBase;
+	size_t ImageSize;
+
+	// The file's write sequence number from before the section was built.
+	// If it has changed since, then the section is stale.
+	int WriteSequence;
+}
+MIIMAGE_SECTION_ENTRY, *PMIIMAGE_SECTION_ENTRY;
+
+static KMUTEX MiImageSectionCacheMutex;
+static LIST_ENTRY MiImageSectionCacheList;
+static int MiImageSectionCacheCount;
+
+void MiInitializeImageSectionCache()
+{
+	KeInitializeMutex(&MiImageSectionCacheMutex, MM_CCB_MUTEX_LEVEL);
+	InitializeListHead(&MiImageSectionCacheList);
+}
+
+// N.B.  The cache mutex must be held.
+static PMIIMAGE_SECTION_ENTRY MmpLookUpImageSection(PFCB Fcb, uintptr_t ImageBase, size_t ImageSize)
+{
+	PLIST_ENTRY Entry = MiImageSectionCacheList.Flink;
+	while (Entry != &MiImageSectionCacheList)
+	{
+		PMIIMAGE_SECTION_ENTRY CacheEntry = CONTAINING_RECORD(Entry, MIIMAGE_SECTION_ENTRY, ListEntry);
+
+		if (CacheEntry->FileObject->Fcb == Fcb &&
+		    CacheEntry->ImageBase == ImageBase &&
+		    CacheEntry->ImageSize == ImageSize)
+			return CacheEntry;
+
+		Entry = Entry->Flink;
+	}
+
+	return NULL;
+}
+
+static bool MmpIsImageSectionStale(PMIIMAGE_SECTION_ENTRY CacheEntry)
+{
+	PCCB Ccb = &CacheEntry->FileObject->Fcb->CacheInfo.PageCache;
+	return AtLoad(Ccb->ImageWriteSequence) != CacheEntry->WriteSequence;
+}
+
+static void MmpFreeImageSectionEntry(PMIIMAGE_SECTION_ENTRY CacheEntry)
+{
+	// Views which are still mapped keep their own reference to the section.
+	ObDereferenceObject(CacheEntry->Section);
+	ObDereferenceObject(CacheEntry->FileObject);
+	MmFreePool(CacheEntry);
+}
+
+// Reads part of an image file into kernel memory.  Reading less than Size bytes
+// means that the image is truncated.
+static BSTATUS MmpReadImageFile(PFILE_OBJECT FileObject, void* Buffer, size_t Size, uint64_t Offset)
+{
+	IO_STATUS_BLOCK Iosb;
+
+	// The buffer is in kernel memory, so it must not be probed as user memory.
+	KPROCESSOR_MODE OldMode = KeSetAddressMode(MODE_KERNEL);
+	BSTATUS Status = IoReadFile(&Iosb, FileObject, Buffer, Size, 0, Offset, true);
+	KeSetAddressMode(OldMode);
+
+	if (FAILED(Status))
+		return Status;
+
+	if (Iosb.BytesRead != Size)
+		return STATUS_INVALID_EXECUTABLE;
+
+	return STATUS_SUCCESS;
+}
+
+// Gets the size of an image in memory.  This must match OSDLLGetImageSize in libboron.
+static size_t MmpGetImageSize(PELF_HEADER ElfHeader, uint8_t* ProgramHeaders)
+{
+	uintptr_t MaximumAddress = 0;
+
+	for (int i = 0; i < ElfHeader->ProgramHeaderCount; i++)
+	{
+		PELF_PROGRAM_HEADER Header = (void*)(ProgramHeaders + i * ElfHeader->ProgramHeaderSize);
+
+		if (Header->Type != PROG_LOAD && Header->Type != PROG_DYNAMIC)
+			continue;
+
+		uintptr_t AddressEnd = (Header->VirtualAddress + Header->SizeInMemory + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+		if (MaximumAddress < AddressEnd)
+			MaximumAddress = AddressEnd;
+	}
+
+	return MaximumAddress;
+}
+
+static bool MmpIsImageRangeValid(size_t ImageSize, uintptr_t Offset, size_t Size)
+{
+	return Offset <= ImageSize && Size <= ImageSize - Offset;
+}
+
+static uintptr_t* MmpGetRelocationPlace(uint8_t* Image, size_t ImageSize, uintptr_t Offset)
+{
+	if ((Offset & (sizeof(uintptr_t) - 1)) || !MmpIsImageRangeValid(ImageSize, Offset, sizeof(uintptr_t)))
+		return NULL;
+
+	return (uintptr_t*)(Image + Offset);
+}
+
+// Reads the file backed part of every loadable segment into the image.
+static BSTATUS MmpReadImageSegments(
+	PFILE_OBJECT FileObject,
+	uint8_t* Image,
+	size_t ImageSize,
+	PELF_HEADER ElfHeader,
+	uint8_t* ProgramHeaders
+)
+{
+	for (int i = 0; i < ElfHeader->ProgramHeaderCount; i++)
+	{
+		PELF_PROGRAM_HEADER Header = (void*)(ProgramHeaders + i * ElfHeader->ProgramHeaderSize);
+
+		if (Header->Type != PROG_LOAD || Header->SizeInFile == 0)
+			continue;
+
+		// Like the loader, start at the beginning of the segment's first page.
+		uintptr_t Misalignment = Header->VirtualAddress & (PAGE_SIZE - 1);
+		if ((Header->Offset & (PAGE_SIZE - 1)) != Misalignment ||
+			Header->SizeInFile > Header->SizeInMemory)
+			return STATUS_INVALID_EXECUTABLE;
+
+		uintptr_t StartOffset = Header->VirtualAddress - Misalignment;
+		size_t Size = Header->SizeInFile + Misalignment;
+
+		if (!MmpIsImageRangeValid(ImageSize, StartOffset, Size))
+			return STATUS_INVALID_EXECUTABLE;
+
+		BSTATUS Status = MmpReadImageFile(FileObject, Image + StartOffset, Size, Header->Offset - Misalignment);
+		if (FAILED(Status))
+			return Status;
+	}
+
+	return STATUS_SUCCESS;
+}
+
+// Applies the relocations of an image which only depend on its load base.  The
+// rest are applied by the loader in every process that maps the image.
+//
+// The image file can contain anything, so every offset taken from it is checked
+// against the size of the image.
+static BSTATUS MmpRelocateImage(
+	uint8_t* Image,
+	size_t ImageSize,
+	uintptr_t ImageBase,
+	uintptr_t DynamicOffset,
+	size_t DynamicSize
+)
+{
+	size_t RelOffset = 0, RelSize = 0, RelaOffset = 0, RelaSize = 0, RelrOffset = 0, RelrSize = 0;
+
+	PELF_DYNAMIC_ITEM DynItem = (PELF_DYNAMIC_ITEM)(Image + DynamicOffset);
+	size_t DynCount = DynamicSize / sizeof(ELF_DYNAMIC_ITEM);
+
+	for (size_t i = 0; i < DynCount && DynItem[i].Tag != DYN_NULL; i++)
+	{
+		switch (DynItem[i].Tag)
+		{
+			case DYN_REL:
+				RelOffset = DynItem[i].Pointer;
+				break;
+			case DYN_RELSZ:
+				RelSize = DynItem[i].Value;
+				break;
+			case DYN_RELA:
+				RelaOffset = DynItem[i].Pointer;
+				break;
+			case DYN_RELASZ:
+				RelaSize = DynItem[i].Value;
+				break;
+			case DYN_RELR:
+				RelrOffset = DynItem[i].Pointer;
+				break;
+			case DYN_RELRSZ:
+				RelrSize = DynItem[i].Value;
+				break;
+		}
+	}
+
+	if (!MmpIsImageRangeValid(ImageSize, RelOffset, RelSize) ||
+		!MmpIsImageRangeValid(ImageSize, RelaOffset, RelaSize) ||
+		!MmpIsImageRangeValid(ImageSize, RelrOffset, RelrSize) ||
+		(RelrOffset & (sizeof(uintptr_t) - 1)))
+		return STATUS_INVALID_EXECUTABLE;
+
+	for (size_t i = 0; i + sizeof(ELF_RELA) <= RelaSize; i += sizeof(ELF_RELA))
+	{
+		PELF_RELA Rela = (PELF_RELA)(Image + RelaOffset + i);
+		if (ELF_R_TYPE(Rela->Info) != MI_RELOC_RELATIVE)
+			continue;
+
+		uintptr_t* Place = MmpGetRelocationPlace(Image, ImageSize, Rela->Offset);
+		if (!Place)
+			return STATUS_INVALID_EXECUTABLE;
+
+		*Place = ImageBase + Rela->Addend;
+	}
+
+	for (size_t i = 0; i + sizeof(ELF_REL) <= RelSize; i += sizeof(ELF_REL))
+	{
+		PELF_REL Rel = (PELF_REL)(Image + RelOffset + i);
+		if (ELF_R_TYPE(Rel->Info) != MI_RELOC_RELATIVE)
+			continue;
+
+		// The addend is stored in the place itself.
+		uintptr_t* Place = MmpGetRelocationPlace(Image, ImageSize, Rel->Offset);
+		if (!Place)
+			return STATUS_INVALID_EXECUTABLE;
+
+		*Place += ImageBase;
+	}
+
+	// An even RELR entry is the offset of a word to relocate.  An odd one is a bitmap
+	// of which of the words following the last relocated one need relocating too.
+	uintptr_t Where = 0;
+	for (size_t i = 0; i + sizeof(uintptr_t) <= RelrSize; i += sizeof(uintptr_t))
+	{
+		uintptr_t Entry = *(uintptr_t*)(Image + RelrOffset + i);
+
+		if (~Entry & 1)
+		{
+			uintptr_t* Place = MmpGetRelocationPlace(Image, ImageSize, Entry);
+			if (!Place)
+				return STATUS_INVALID_EXECUTABLE;
+
+			*Place += ImageBase;
+			Where = Entry + sizeof(uintptr_t);
+			continue;
+		}
+
+		uintptr_t Offset = Where;
+		for (Entry >>= 1; Entry; Entry >>= 1, Offset += sizeof(uintptr_t))
+		{
+			if (~Entry & 1)
+				continue;
+
+			uintptr_t* Place = MmpGetRelocationPlace(Image, ImageSize, Offset);
+			if (!Place)
+				return STATUS_INVALID_EXECUTABLE;
+
+			*Place += ImageBase;
+		}
+
+		Where += (sizeof(uintptr_t) * 8 - 1) * sizeof(uintptr_t);
+	}
+
+	return STATUS_SUCCESS;
+}
+
+// Builds a section holding the base-relocated contents of an image, as read from its file.
+static BSTATUS MmpBuildImageSection(
+	PMMSECTION* OutSection,
+	PFILE_OBJECT FileObject,
+	uintptr_t ImageBase,
+	size_t ImageSize
+)
+{
+	BSTATUS Status;
+	ELF_HEADER ElfHeader;
+
+	Status = MmpReadImageFile(FileObject, &ElfHeader, sizeof ElfHeader, 0);
+	if (FAILED(Status))
+		return Status;
+
+	Status = RtlCheckValidity(&ElfHeader);
+	if (FAILED(Status))
+		return Status;
+
+	if (ElfHeader.Type != ELF_TYPE_DYNAMIC ||
+		ElfHeader.ProgramHeaderSize < sizeof(ELF_PROGRAM_HEADER) ||
+		ElfHeader.ProgramHeaderCount > MI_IMAGE_SECTION_MAX_PHDRS)
+		return STATUS_INVALID_EXECUTABLE;
+
+	size_t ProgramHeadersSize = ElfHeader.ProgramHeaderSize * ElfHeader.ProgramHeaderCount;
+	uint8_t* ProgramHeaders = MmAllocatePool(POOL_PAGED, ProgramHeadersSize);
+	if (!ProgramHeaders)
+		return STATUS_INSUFFICIENT_MEMORY;
+
+	uint8_t* Image = NULL;
+	PMMSECTION Section = NULL;
+
+	Status = MmpReadImageFile(FileObject, ProgramHeaders, ProgramHeadersSize, ElfHeader.ProgramHeadersOffset);
+	if (FAILED(Status))
+		goto Exit;
+
+	// The caller worked out the size from the same headers, so if it doesn't match,
+	// then the file was changed in the meantime.
+	if (MmpGetImageSize(&ElfHeader, ProgramHeaders) != ImageSize)
+	{
+		Status = STATUS_INVALID_PARAMETER;
+		goto Exit;
+	}
+
+	Image = MmAllocatePoolBig(POOL_FLAG_NON_PAGED, ImageSize / PAGE_SIZE, POOL_TAG("MmIc"));
+	if (!Image)
+	{
+		Status = STATUS_INSUFFICIENT_MEMORY;
+		goto Exit;
+	}
+
+	memset(Image, 0, ImageSize);
+
+	Status = MmpReadImageSegments(FileObject, Image, ImageSize, &ElfHeader, ProgramHeaders);
+	if (FAILED(Status))
+		goto Exit;
+
+	for (int i = 0; i < ElfHeader.ProgramHeaderCount; i++)
+	{
+		PELF_PROGRAM_HEADER Header = (void*)(ProgramHeaders + i * ElfHeader.ProgramHeaderSize);
+		if (Header->Type != PROG_DYNAMIC)
+			continue;
+
+		if (!MmpIsImageRangeValid(ImageSize, Header->VirtualAddress, Header->SizeInMemory))
+		{
+			Status = STATUS_INVALID_EXECUTABLE;
+			goto Exit;
+		}
+
+		Status = MmpRelocateImage(Image, ImageSize, ImageBase, Header->VirtualAddress, Header->SizeInMemory);
+		if (FAILED(Status))
+			goto Exit;
+
+		break;
+	}
+
+	Status = MmCreateAnonymousSectionObject(&Section, ImageSize);
+	if (FAILED(Status))
+		goto Exit;
+
+	for (size_t i = 0; i < ImageSize / PAGE_SIZE; i++)
+	{
+		MMPFN Pfn = MmAllocatePhysicalPage();
+		if (Pfn == PFN_INVALID)
+		{
+			Status = STATUS_INSUFFICIENT_MEMORY;
+			goto Exit;
+		}
+
+		MmBeginUsingHHDM();
+		memcpy(MmGetHHDMOffsetAddrPfn(Pfn), Image + i * PAGE_SIZE, PAGE_SIZE);
+		MmEndUsingHHDM();
+
+		// The section takes a reference of its own.
+		Status = MiAssignEntrySection(Section, i, Pfn);
+		MmFreePhysicalPage(Pfn);
+
+		if (FAILED(Status))
+			goto Exit;
+	}
+
+	*OutSection = Section;
+	Section = NULL;
+
+Exit:
+	if (Section)
+		ObDereferenceObject(Section);
+
+	if (Image)
+		MmFreePoolBig(Image);
+
+	MmFreePool(ProgramHeaders);
+	return Status;
+}
+
+BSTATUS MmReferenceImageSection(
+	PMMSECTION* OutSection,
+	PFILE_OBJECT FileObject,
+	uintptr_t ImageBase,
+	size_t ImageSize
+)
+{
+	BSTATUS Status;
+	PCCB Ccb = &FileObject->Fcb->CacheInfo.PageCache;
+	PMIIMAGE_SECTION_ENTRY StaleEntry = NULL;
+	PMIIMAGE_SECTION_ENTRY EvictedEntry = NULL;
+	PMIIMAGE_SECTION_ENTRY FreedEntry = NULL;
+
+	if (ImageSize == 0 || ImageSize > MI_IMAGE_SECTION_MAX_SIZE ||
+		(ImageSize & (PAGE_SIZE - 1)) || (ImageBase & (PAGE_SIZE - 1)))
+		return STATUS_INVALID_PARAMETER;
+
+	Status = KeWaitForSingleObject(&MiImageSectionCacheMutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ASSERT(SUCCEEDED(Status));
+
+	PMIIMAGE_SECTION_ENTRY CacheEntry = MmpLookUpImageSection(FileObject->Fcb, ImageBase, ImageSize);
+	if (CacheEntry && !MmpIsImageSectionStale(CacheEntry))
+	{
+		// Move it to the front, so that the least recently used entries are evicted first.
+		RemoveEntryList(&CacheEntry->ListEntry);
+		InsertHeadList(&MiImageSectionCacheList, &CacheEntry->ListEntry);
+		*OutSection = ObReferenceObjectByPointer(CacheEntry->Section);
+
+		KeReleaseMutex(&MiImageSectionCacheMutex);
+		return STATUS_SUCCESS;
+	}
+
+	if (CacheEntry)
+	{
+		RemoveEntryList(&CacheEntry->ListEntry);
+		MiImageSectionCacheCount--;
+		StaleEntry = CacheEntry;
+	}
+
+	KeReleaseMutex(&MiImageSectionCacheMutex);
+
+	if (StaleEntry)
+		MmpFreeImageSectionEntry(StaleEntry);
+
+	// Any write from here on makes the section that is about to be built stale.
+	int WriteSequence = AtLoad(Ccb->ImageWriteSequence);
+
+	PMMSECTION Section = NULL;
+	Status = MmpBuildImageSection(&Section, FileObject, ImageBase, ImageSize);
+	if (FAILED(Status))
+		return Status;
+
+	PMIIMAGE_SECTION_ENTRY NewEntry = MmAllocatePool(POOL_NONPAGED, sizeof(MIIMAGE_SECTION_ENTRY));
+	if (!NewEntry)
+	{
+		ObDereferenceObject(Section);
+		return STATUS_INSUFFICIENT_MEMORY;
+	}
+
+	NewEntry->FileObject = ObReferenceObjectByPointer(FileObject);
+	NewEntry->Section = Section;
+	NewEntry->ImageBase = ImageBase;
+	NewEntry->ImageSize = ImageSize;
+	NewEntry->WriteSequence = WriteSequence;
+
+	// The section outlives its cache entry if it is still mapped somewhere, so it
+	// keeps its own reference to the file.
+	Section->ImageFile = ObReferenceObjectByPointer(FileObject);
+
+	Status = KeWaitForSingleObject(&MiImageSectionCacheMutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ASSERT(SUCCEEDED(Status));
+
+	CacheEntry = MmpLookUpImageSection(FileObject->Fcb, ImageBase, ImageSize);
+
+	if (MmpIsImageSectionStale(NewEntry))
+	{
+		// The file was written to while it was being read.
+		FreedEntry = NewEntry;
+		Status = STATUS_NAME_NOT_FOUND;
+	}
+	else if (CacheEntry && !MmpIsImageSectionStale(CacheEntry))
+	{
+		// Someone else built the same section in the meantime.
+		FreedEntry = NewEntry;
+		RemoveEntryList(&CacheEntry->ListEntry);
+		InsertHeadList(&MiImageSectionCacheList, &CacheEntry->ListEntry);
+		*OutSection = ObReferenceObjectByPointer(CacheEntry->Section);
+	}
+	else
+	{
+		if (CacheEntry)
+		{
+			RemoveEntryList(&CacheEntry->ListEntry);
+			MiImageSectionCacheCount--;
+			StaleEntry = CacheEntry;
+		}
+
+		if (MiImageSectionCacheCount >= MI_IMAGE_SECTION_CACHE_MAX)
+		{
+			EvictedEntry = CONTAINING_RECORD(MiImageSectionCacheList.Blink, MIIMAGE_SECTION_ENTRY, ListEntry);
+			RemoveEntryList(&EvictedEntry->ListEntry);
+			MiImageSectionCacheCount--;
+		}
+
+		InsertHeadList(&MiImageSectionCacheList, &NewEntry->ListEntry);
+		MiImageSectionCacheCount++;
+		*OutSection = ObReferenceObjectByPointer(Section);
+	}
+
+	KeReleaseMutex(&MiImageSectionCacheMutex);
+
+	if (FreedEntry)
+		MmpFreeImageSectionEntry(FreedEntry);
+
+	if (StaleEntry)
+		MmpFreeImageSectionEntry(StaleEntry);
+
+	if (EvictedEntry)
+		MmpFreeImageSectionEntry(EvictedEntry);
+
+	return Status;
+}
+
+// Makes the cached image sections built from a file stale.  Called after every write
+// to the file.  Because the sequence number is bumped after the data is written, a
+// section which was built from the old data will always see the new number.
+void MmInvalidateImageSections(PFCB Fcb)
+{
+	AtAddFetch(Fcb->CacheInfo.PageCache.ImageWriteSequence, 1);
+}
+
+//
+// Opens the section holding the base-relocated contents of an image.  If the image
+// isn't cached at this base yet, its section is built from the image file first.
+//
+// Parameters:
+//     OutSectionHandle - The handle to the section.  It may only be mapped writable
+//                        copy-on-write, because other processes map it too.
+//
+//     FileHandle - The handle to the image file.
+//
+//     ImageBase - The address at which the image is going to be loaded.
+//
+//     ImageSize - The size of the image in memory.  It must match the size worked out
+//                 from the image's program headers.
+//
+// Returns STATUS_NAME_NOT_FOUND if the file was written to while its section was being
+// built.  In that case, or if this fails at all, the caller should load the image itself.
+//
+BSTATUS OSLookUpImageSection(
+	PHANDLE OutSectionHandle,
+	HANDLE FileHandle,
+	uintptr_t ImageBase,
+	size_t ImageSize
+)
+{
+	BSTATUS Status;
+	void* FileObjectV;
+
+	Status = ExReferenceObjectByHandle(FileHandle, IoFileType, &FileObjectV);
+	if (FAILED(Status))
+		return Status;
+
+	PMMSECTION Section = NULL;
+	Status = MmReferenceImageSection(&Section, FileObjectV, ImageBase, ImageSize);
+	ObDereferenceObject(FileObjectV);
+
+	if (FAILED(Status))
+		return Status;
+
+	HANDLE SectionHandle = HANDLE_NONE;
+	Status = ObInsertObject(Section, &SectionHandle, 0);
+	ObDereferenceObject(Section);
+
+	if (FAILED(Status))
+		return Status;
+
+	Status = MmSafeCopy(OutSectionHandle, &SectionHandle, sizeof(HANDLE), KeGetPreviousMode(), true);
+	if (FAILED(Status))
+		ObClose(SectionHandle);
+
+	return Status;
+}
@@ -60,5 +60,11 @@ bool MmInitSystem()
 		return false;
 	}
 	
+#ifdef MM_HUGE_PAGE_SIZE
+	MiInitHugePages();
+#endif
+	
+	MiInitializeImageSectionCache();
+	MiInitializePoolTagCounters();
 	return true;
 }
@@ -15,6 +15,7 @@ Author:
 #include <ex.h>
 #include <ps.h>
 #include <string.h>
+#include "mi.h"
 
 void MmUnmapPagesMdl(PMDL Mdl)
 {
@@ -147,6 +148,25 @@ PMDL MmAllocateMdl(uintptr_t VirtualAddress, size_t Length)
 	return Mdl;
 }
 
+#ifdef MM_HUGE_PAGE_SIZE
+
+// Gets the PFN of the page at the specified address if it is part of a huge page which
+// allows the access, so that the huge page doesn't have to be split to find its PTE.
+static MMPFN MmpGetPfnInHugePage(uintptr_t Address, bool IsWrite)
+{
+	PMMPTE PdePtr = MiGetHugePteLocation(Address);
+	if (!PdePtr)
+		return PFN_INVALID;
+	
+	MMPTE Pde = *PdePtr;
+	if ((~MmGetPageBitsPte(Pde) & MM_PROT_WRITE) && IsWrite)
+		return PFN_INVALID;
+	
+	return MmGetPfnPte(Pde) + (Address & (MM_HUGE_PAGE_SIZE - 1)) / PAGE_SIZE;
+}
+
+#endif
+
 BSTATUS MmProbeAndPinPagesMdl(PMDL Mdl, KPROCESSOR_MODE AccessMode, bool IsWrite)
 {
 	uintptr_t VirtualAddress = Mdl->SourceStartVA;
@@ -200,6 +220,22 @@ BSTATUS MmProbeAndPinPagesMdl(PMDL Mdl, KPROCESSOR_MODE AccessMode, bool IsWrite
 		while (true)
 		{
 			KIPL OldIpl = MmLockSpaceShared(Address);
+			
+		#ifdef MM_HUGE_PAGE_SIZE
+			MMPFN HugePfn = MmpGetPfnInHugePage(Address, IsWrite);
+			if (HugePfn != PFN_INVALID)
+			{
+				MmPageAddReference(HugePfn);
+				
+				ASSERT(Index < Mdl->NumberPages);
+				Mdl->Pages[Index] = HugePfn;
+				Index++;
+				
+				MmUnlockSpace(OldIpl, Address);
+				break;
+			}
+		#endif
+			
 			PMMPTE PtePtr = MmGetPteLocationCheck(Address, false);
 			
 			bool TryFault = false;
@@ -326,6 +362,28 @@ PMDL_ONEPAGE MmInitializeSinglePageMdl(PMDL_ONEPAGE Mdl, MMPFN Pfn, int Flags)
 	return Mdl;
 }
 
+PMDL MmInitializePageListMdl(PMDL Mdl, const MMPFN* Pfns, size_t PageCount, int Flags)
+{
+	// Like MmInitializeSinglePageMdl, except that the pages are gathered from
+	// several places, so that they can be written with one I/O operation.
+	Mdl->ByteOffset = 0;
+	Mdl->Flags = MDL_FLAG_CAPTURED | Flags;
+	Mdl->Available = 0;
+	Mdl->ByteCount = PageCount * PAGE_SIZE;
+	Mdl->SourceStartVA = (uintptr_t) -1ULL;
+	Mdl->MappedStartVA = 0;
+	Mdl->Process = PsGetAttachedProcess();
+	Mdl->NumberPages = PageCount;
+	
+	for (size_t i = 0; i < PageCount; i++)
+	{
+		MmPageAddReference(Pfns[i]);
+		Mdl->Pages[i] = Pfns[i];
+	}
+	
+	return Mdl;
+}
+
 BSTATUS MmCreateMdl(PMDL* OutMdl, uintptr_t VirtualAddress, size_t Length, KPROCESSOR_MODE AccessMode, bool IsWrite)
 {
 	PMDL Mdl = MmAllocateMdl(VirtualAddress, Length);
@@ -477,3 +535,59 @@ void MmSetIntoMdl(PMDL Mdl, uintptr_t Offset, uint8_t ToSet, size_t Size)
 		Size -= CopyAmount;
 	}
 }
+
+void MmCopyMdlToMdl(PMDL DestinationMdl, uintptr_t DestinationOffset, PMDL SourceMdl, uintptr_t SourceOffset, size_t Size)
+{
+	// NOTE: Neither MDL's starting pointer is necessarily page aligned.
+	// See MmCopyIntoMdl.
+	DestinationOffset += DestinationMdl->ByteOffset;
+	SourceOffset += SourceMdl->ByteOffset;
+	
+#ifdef IS_32_BIT
+	// Only one page may be accessed through the HHDM at a time, so bounce through
+	// a small buffer on the stack, a piece at a time.  Allocating a bigger buffer
+	// could fail, and this function can't report that.
+	char Temporary[256];
+#endif
+	
+	while (Size)
+	{
+		size_t DestPageIndex = DestinationOffset / PAGE_SIZE;
+		size_t DestPageOffs  = DestinationOffset % PAGE_SIZE;
+		size_t SourcePageIndex = SourceOffset / PAGE_SIZE;
+		size_t SourcePageOffs  = SourceOffset % PAGE_SIZE;
+		
+		ASSERT(DestPageIndex < DestinationMdl->NumberPages);
+		ASSERT(SourcePageIndex < SourceMdl->NumberPages);
+		
+		// Copy up to whichever page boundary comes first.
+		size_t CopyAmount = Size;
+		if (CopyAmount > PAGE_SIZE - DestPageOffs)
+			CopyAmount = PAGE_SIZE - DestPageOffs;
+		if (CopyAmount > PAGE_SIZE - SourcePageOffs)
+			CopyAmount = PAGE_SIZE - SourcePageOffs;
+		
+#ifdef IS_32_BIT
+		if (CopyAmount > sizeof Temporary)
+			CopyAmount = sizeof Temporary;
+		
+		MmBeginUsingHHDM();
+		char* PageSource = MmGetHHDMOffsetAddr(MmPFNToPhysPage(SourceMdl->Pages[SourcePageIndex]));
+		memcpy(Temporary, PageSource + SourcePageOffs, CopyAmount);
+		MmEndUsingHHDM();
+		
+		MmBeginUsingHHDM();
+		char* PageDest = MmGetHHDMOffsetAddr(MmPFNToPhysPage(DestinationMdl->Pages[DestPageIndex]));
+		memcpy(PageDest + DestPageOffs, Temporary, CopyAmount);
+		MmEndUsingHHDM();
+#else
+		char* PageSource = MmGetHHDMOffsetAddr(MmPFNToPhysPage(SourceMdl->Pages[SourcePageIndex]));
+		char* PageDest = MmGetHHDMOffsetAddr(MmPFNToPhysPage(DestinationMdl->Pages[DestPageIndex]));
+		memcpy(PageDest + DestPageOffs, PageSource + SourcePageOffs, CopyAmount);
+#endif
+		
+		DestinationOffset += CopyAmount;
+		SourceOffset += CopyAmount;
+		Size -= CopyAmount;
+	}
+}
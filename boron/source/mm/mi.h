@@ -116,6 +116,8 @@ typedef struct MISLAB_CONTAINER_tag
 {
 	int          ItemSize;
 	bool         NonPaged;
+	// Each item starts with a MISLAB_TAG_HEADER.
+	bool         Tagged;
 	KSPIN_LOCK   Lock;
 	LIST_ENTRY   ListHead;
 }
@@ -154,7 +156,18 @@ MISLAB_SIZE;
 
 static_assert(sizeof(MISLAB_ITEM) <= PAGE_SIZE, "This structure needs to fit inside one page.");
 
+// Placed in front of allocations made from tagged slab containers.
+typedef struct
+{
+	int Tag;
+	int Reserved;
+}
+MISLAB_TAG_HEADER, *PMISLAB_TAG_HEADER;
+
+static_assert(sizeof(MISLAB_TAG_HEADER) == 8);
+
 void* MiSlabAllocate(bool NonPaged, size_t Size);
+void* MiSlabAllocateTagged(bool NonPaged, size_t Size, int Tag);
 void  MiSlabFree(void* Pointer);
 void  MiInitSlabs();
 
@@ -199,7 +212,10 @@ HUGE_MEMORY_BLOCK, *PHUGE_MEMORY_BLOCK;
 
 typedef struct MIPOOL_ENTRY_tag
 {
+	// Links all entries in the order of their addresses.
 	LIST_ENTRY ListEntry;
+	// Links free entries into the free list for their size.
+	LIST_ENTRY FreeListEntry;
 	int        Flags;
 	int        Tag;
 	uintptr_t  UserData;
@@ -213,14 +229,16 @@ typedef struct MIPOOL_ENTRY_tag
 MIPOOL_ENTRY, *PMIPOOL_ENTRY;
 
 #ifdef IS_64_BIT
-static_assert(sizeof(MIPOOL_ENTRY) == 48);
+static_assert(sizeof(MIPOOL_ENTRY) == 64);
 #else
-static_assert(sizeof(MIPOOL_ENTRY) == 32);
+static_assert(sizeof(MIPOOL_ENTRY) == 40);
 #endif
 
 typedef enum MIPOOL_ENTRY_FLAGS_tag
 {
 	MI_POOL_ENTRY_ALLOCATED = (1 << 0),
+	// The entry is allocated, but is held in a processor's quantum cache.
+	MI_POOL_ENTRY_CACHED    = (1 << 1),
 }
 MIPOOL_ENTRY_FLAGS;
 
@@ -258,6 +276,28 @@ size_t MiGetSizeFromPoolSpaceHandle(MIPOOL_SPACE_HANDLE);
 // Get the user data from the address range owned by a handle as passed to MiReservePoolSpaceTagged.
 uintptr_t MiGetUserDataFromPoolSpaceHandle(MIPOOL_SPACE_HANDLE);
 
+// Get the tag of the address range owned by a handle.
+int MiGetTagFromPoolSpaceHandle(MIPOOL_SPACE_HANDLE);
+
+// The layers of the pool allocator which keep pool tag statistics.
+typedef enum MIPOOL_LAYER_tag
+{
+	MI_POOL_LAYER_BIG,
+	MI_POOL_LAYER_SLAB,
+	MI_POOL_LAYER_COUNT,
+}
+MIPOOL_LAYER;
+
+// Allocations made without a tag are counted under this tag.
+#define MI_UNTAGGED_TAG MI_TAG("None")
+
+// Update the pool tag statistics (pooltag.c).
+void MiRecordPoolAllocation(int Tag, MIPOOL_LAYER Layer, bool NonPaged, size_t Bytes);
+void MiRecordPoolFree(int Tag, MIPOOL_LAYER Layer, bool NonPaged, size_t Bytes);
+
+// Allocates the per-processor pool tag counters.  Called once all processors are known.
+void MiInitializePoolTagCounters();
+
 // Get the pool space handle from an address returned by MiReservePoolSpaceTagged.
 MIPOOL_SPACE_HANDLE MiGetPoolSpaceHandleFromAddress(void* Address);
 
@@ -392,6 +432,194 @@ BSTATUS MiUnmapVirtualMemoryPartial(uintptr_t StartAddress, size_t SizePages);
 void MiInitializeBaseIdentityMapping();
 #endif
 
+// ===== Huge Pages =====
+#ifdef MM_HUGE_PAGE_SIZE
+
+#define MI_HUGE_PAGE_PAGES (MM_HUGE_PAGE_SIZE / PAGE_SIZE)
+
+// Allocates MI_HUGE_PAGE_PAGES physically contiguous pages, aligned to the size of a
+// huge page, and zeroes them.  Returns the first PFN, or PFN_INVALID if there is no
+// such run of free pages.  Each of the pages is referenced separately.
+MMPFN MiAllocateHugePhysicalPage();
+
+// Frees the pages allocated by MiAllocateHugePhysicalPage.
+void MiFreeHugePhysicalPage(MMPFN Pfn);
+
+// Gets the location of the higher level PTE which maps the huge page at the specified
+// address, in the current page mapping.  Returns NULL if the address is not mapped by
+// a huge page that the memory manager created.  Huge pages set up by the boot loader,
+// such as the ones the HHDM may use, are never returned.
+PMMPTE MiGetHugePteLocation(uintptr_t Address);
+
+// Maps a huge page at a huge page aligned address, in the current page mapping.  Only
+// succeeds if nothing is mapped in the range covered by the huge page yet.
+bool MiMapHugePage(uintptr_t Address, MMPFN Pfn, uintptr_t PageBits);
+
+// Unmaps the huge page at the specified address, and frees its memory.
+void MiUnmapHugePage(uintptr_t Address);
+
+// Splits the huge page at the specified address into regular pages, in place.  This is
+// done when part of it has to be changed on its own.  Returns true if the range is no
+// longer mapped by a huge page, or false if the page table couldn't be allocated.
+bool MiSplitHugePage(uintptr_t Address);
+
+// Allocates a huge page and maps it at the specified address, if huge pages are enabled.
+// Returns false if regular pages should be used instead.
+bool MiMapAnonHugePage(uintptr_t Address, uintptr_t PageBits);
+
+// Records that a huge page created by MiMapAnonHugePage was freed or split.
+void MiRecordHugePageRelease(bool Split);
+
+// Reads the huge page configuration from the boot configuration.
+void MiInitHugePages();
+
+#endif
+
+// ===== Working Set Manager =====
+
+// If the number of free pages drops below this, the working set manager is woken up
+// to trim pages.  This is zero until the working set manager is started.
+extern size_t MiWorkingSetLowWatermark;
+
+// Wakes up the working set manager, so that it trims pages right away.
+void MiWakeWorkingSetManager();
+
+// ===== Compressed Page Store =====
+
+typedef struct _MICOMPRESSED_PAGE MICOMPRESSED_PAGE, *PMICOMPRESSED_PAGE;
+
+// Compresses the contents of a page into the compressed page store.  Returns NULL if the
+// page doesn't compress well enough to be worth storing, or if there's no pool memory.
+// The page itself is left alone.
+//
+// Only the working set manager compresses pages, so this is never called concurrently.
+PMICOMPRESSED_PAGE MiCompressPage(MMPFN Pfn);
+
+// Decompresses a page from the compressed page store into a page.  Returns false if the
+// compressed data is damaged.  The compressed copy stays in the store.
+bool MiDecompressPage(PMICOMPRESSED_PAGE CompressedPage, MMPFN Pfn);
+
+// Removes a page from the compressed page store.
+void MiFreeCompressedPage(PMICOMPRESSED_PAGE CompressedPage);
+
+// ===== Anonymous Pages =====
+
+// The number of bits an anonymous SLA entry has for a PFN or page file slot.  Physical
+// memory whose PFNs don't fit is left unused by MiInitPMM.
+#define MI_ANON_ENTRY_PFN_BITS  (29)
+#define MI_ANON_ENTRY_PFN_LIMIT ((MMPFN) 1 << MI_ANON_ENTRY_PFN_BITS)
+
+// An entry in the SLA of an anonymous section or a CoW overlay.  It holds the PFN of a
+// resident page, a pointer to the compressed copy of the page, or the page file slot
+// that the page was written to.  The SLA's mutex guards the entries.
+typedef union
+{
+	struct
+	{
+		// The rest of the entry is a pointer to the page in the compressed page store.
+		// Pool allocations are always QWORD aligned, so the low bits are free in it.
+		MMPFN Compressed : 1;
+		
+		// Pfn is the page file slot the page was written to.
+		MMPFN PageFile : 1;
+		
+		// The page is being written to the page file, if resident, or read back from it.
+		MMPFN Busy : 1;
+		
+		MMPFN Pfn : MI_ANON_ENTRY_PFN_BITS;
+	}
+	PACKED
+	Data;
+	
+	MMSLA_ENTRY Entry;
+}
+MIANON_ENTRY, *PMIANON_ENTRY;
+
+// Builds the anonymous SLA entry of a resident page.
+static inline MMSLA_ENTRY MiMakeResidentEntryAnonymous(MMPFN Pfn)
+{
+	ASSERT(Pfn < MI_ANON_ENTRY_PFN_LIMIT);
+	
+	MIANON_ENTRY SlaEntry;
+	SlaEntry.Entry = 0;
+	SlaEntry.Data.Pfn = Pfn;
+	return SlaEntry.Entry;
+}
+
+#define MI_ANON_ENTRY_COMPRESSED (1)
+
+typedef struct
+{
+	// The anonymous section or CoW overlay holding the page.  Referenced.
+	void* MappableObject;
+	
+	// The index of the page in the object's SLA.
+	uint64_t Index;
+	
+	MMPFN Pfn;
+}
+MIPAGE_OUT_REQUEST, *PMIPAGE_OUT_REQUEST;
+
+// Looks up a page in the SLA of an anonymous section or CoW overlay, and adds a
+// reference to it.  The SLA's mutex is held.  If there is no entry, PFN_INVALID is
+// returned.
+//
+// If the page isn't resident, STATUS_MORE_PROCESSING_REQUIRED is returned, unless
+// BringIn is set, in which case the page is brought back into memory.  The mutex is
+// released while the page is read from the page file.
+BSTATUS MiGetPageAnonymous(PKMUTEX Mutex, PMMSLA Sla, uint64_t Index, PMMPFN OutPfn, bool BringIn);
+
+// Frees an entry of the SLA of an anonymous section or CoW overlay.
+void MiFreeEntryAnonymous(MMSLA_ENTRY Entry);
+
+// Moves a page of an anonymous section or a CoW overlay out of memory, if the object
+// is the only one still referencing it.  The page is compressed, or, if it doesn't
+// compress well, queued to be written to the page file.  Called by the working set
+// manager after it unmaps the page.
+void MiTrimPageAnonymous(void* MappableObject, uint64_t SectionOffset, MMPFN Pfn);
+
+// Writes a cluster of pages of one anonymous section or CoW overlay to the page file.
+// The pages not mapped again by the time the write completes are freed.  Called by
+// the page file writer.
+void MiPageOutAnonymous(void* MappableObject, PMIPAGE_OUT_REQUEST Requests, size_t Count);
+
+// ===== Page File =====
+
+#define MI_PAGE_FILE_SLOT_INVALID ((uint32_t) -1)
+
+// The most pages written to the page file at once.
+#define MI_PAGE_FILE_CLUSTER (16)
+
+// Returns whether a page file is in use.
+bool MiIsPageFileActive();
+
+// Allocates a run of consecutive page file slots.  *Count is the number of slots wanted,
+// and receives the number of slots allocated, which may be fewer if the page file is
+// fragmented.  Returns MI_PAGE_FILE_SLOT_INVALID if the page file is full.
+uint32_t MiAllocatePageFileSlots(size_t* Count);
+
+void MiFreePageFileSlot(uint32_t Slot);
+
+// Writes the pages of an MDL to consecutive page file slots.
+BSTATUS MiWritePageFile(uint32_t Slot, PMDL Mdl);
+
+// Reads a page back from a page file slot.
+BSTATUS MiReadPageFile(uint32_t Slot, MMPFN Pfn);
+
+// Queues a page to be written to the page file by the page file writer.  A reference
+// to the object is added.  Returns false if the queue is full.
+bool MiQueuePageOut(void* MappableObject, uint64_t Index, MMPFN Pfn);
+
+// Pages being read from the page file have busy entries.  Those who find one must
+// wait until it's read in.  MiBeginPageIn must be called with the SLA's mutex held
+// when an entry is marked busy, and MiEndPageIn when it's no longer busy.
+void MiBeginPageIn();
+
+void MiEndPageIn();
+
+// Waits until no pages are being read from the page file.
+void MiWaitForPageIn();
+
 // ===== Section & Cel Objects =====
 extern POBJECT_TYPE MmSectionObjectType;
 extern POBJECT_TYPE MmOverlayObjectType;
@@ -404,6 +632,8 @@ BSTATUS MiResolveBackingStoreForOverlay(void* Object, void** OutFileOrSectionObj
 
 BSTATUS MiAssignEntrySection(PMMSECTION Section, uint64_t SectionOffset, MMPFN Pfn);
 
+void MiInitializeImageSectionCache();
+
 // ===== Hardware Specific =====
 
 #if defined TARGET_I386 || defined TARGET_AMD64
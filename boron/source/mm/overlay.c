@@ -37,27 +37,19 @@ static uint8_t MmpCowOverlayBuffer[PAGE_SIZE];
 
 #endif
 
-typedef union
+// Looks up the page in the CoW overlay itself.  If it has no page here, PFN_INVALID
+// is returned.
+static BSTATUS MmpGetOwnPageOverlay(PMMOVERLAY Overlay, uint64_t SectionOffset, PMMPFN OutPfn, bool BringIn)
 {
-	struct
-	{
-		MMPFN Pfn : 32;
-	}
-	PACKED
-	Data;
+	BSTATUS Status = KeWaitForSingleObject(&Overlay->Mutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ASSERT(SUCCEEDED(Status));
 	
-	MMSLA_ENTRY Entry;
-}
-MMOVERLAY_SLA_ENTRY, *PMMOVERLAY_SLA_ENTRY;
-
-static void MmpFreeEntryOverlayObject(MMSLA_ENTRY Entry)
-{
-	MMOVERLAY_SLA_ENTRY OverlayEntry;
-	OverlayEntry.Entry = Entry;
+	// N.B. Unlike page caches, we don't need to worry about anything modifying the list while
+	// it's locked with a mutex.
+	Status = MiGetPageAnonymous(&Overlay->Mutex, &Overlay->Sla, SectionOffset, OutPfn, BringIn);
 	
-	MMPFN Pfn = OverlayEntry.Data.Pfn;
-	if (Pfn != PFN_INVALID)
-		MmFreePhysicalPage(Pfn);
+	KeReleaseMutex(&Overlay->Mutex);
+	return Status;
 }
 
 static BSTATUS MmpGetPageOverlay(void* MappableObject, uint64_t SectionOffset, PMMPFN OutPfn)
@@ -65,23 +57,18 @@ static BSTATUS MmpGetPageOverlay(void* MappableObject, uint64_t SectionOffset, P
 	PMMOVERLAY Overlay = MappableObject;
 	SectionOffset += Overlay->SectionOffset;
 	
-	BSTATUS Status = KeWaitForSingleObject(&Overlay->Mutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
-	ASSERT(SUCCEEDED(Status));
+	MMPFN Pfn = PFN_INVALID;
+	BSTATUS Status = MmpGetOwnPageOverlay(Overlay, SectionOffset, &Pfn, false);
+	if (FAILED(Status))
+		return Status;
 	
-	// N.B. Unlike page caches, we don't need to worry about anything modifying the list while
-	// it's locked with a mutex.
-	MMOVERLAY_SLA_ENTRY SlaEntry;
-	SlaEntry.Entry = MmLookUpEntrySla(&Overlay->Sla, SectionOffset);
-	if (SlaEntry.Entry != MM_SLA_NO_DATA)
+	if (Pfn != PFN_INVALID)
 	{
 		// The CoW overlay has its own page here, so return that.
-		MmPageAddReference(SlaEntry.Data.Pfn);
-		KeReleaseMutex(&Overlay->Mutex);
-		*OutPfn = SlaEntry.Data.Pfn;
+		*OutPfn = Pfn;
 		return STATUS_SUCCESS;
 	}
 	
-	KeReleaseMutex(&Overlay->Mutex);
 	return MmGetPageMappable(Overlay->Parent, SectionOffset, OutPfn);
 }
 
@@ -89,6 +76,19 @@ static BSTATUS MmpReadPageOverlay(void* MappableObject, uint64_t SectionOffset,
 {
 	PMMOVERLAY Overlay = MappableObject;
 	SectionOffset += Overlay->SectionOffset;
+	
+	// The CoW overlay's own page may have been moved out of memory.
+	MMPFN Pfn = PFN_INVALID;
+	BSTATUS Status = MmpGetOwnPageOverlay(Overlay, SectionOffset, &Pfn, true);
+	if (FAILED(Status))
+		return Status;
+	
+	if (Pfn != PFN_INVALID)
+	{
+		*OutPfn = Pfn;
+		return STATUS_SUCCESS;
+	}
+	
 	return MmReadPageMappable(Overlay->Parent, SectionOffset, OutPfn);
 }
 
@@ -100,7 +100,7 @@ static BSTATUS MmpPrepareWriteOverlay(void* MappableObject, uint64_t SectionOffs
 	BSTATUS Status = KeWaitForSingleObject(&Overlay->Mutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
 	ASSERT(SUCCEEDED(Status));
 	
-	MMOVERLAY_SLA_ENTRY SlaEntry;
+	MIANON_ENTRY SlaEntry;
 	SlaEntry.Entry = MmLookUpEntrySla(&Overlay->Sla, SectionOffset);
 	if (SlaEntry.Entry != MM_SLA_NO_DATA)
 	{
@@ -114,7 +114,7 @@ static BSTATUS MmpPrepareWriteOverlay(void* MappableObject, uint64_t SectionOffs
 	
 	MMPFN Pfn = PFN_INVALID;
 	Status = MmGetPageMappable(Overlay->Parent, SectionOffset, &Pfn);
-	if (Status == STATUS_HARDWARE_IO_ERROR)
+	if (Status == STATUS_MORE_PROCESSING_REQUIRED)
 	{
 		// Need to call ReadPage.  This will return the page after being
 		// read into memory.
@@ -178,8 +178,7 @@ static BSTATUS MmpPrepareWriteOverlay(void* MappableObject, uint64_t SectionOffs
 	MmFreePhysicalPage(Pfn);
 	
 	// No data here, so assign it now.
-	SlaEntry.Entry = 0;
-	SlaEntry.Data.Pfn = NewPfn;
+	SlaEntry.Entry = MiMakeResidentEntryAnonymous(NewPfn);
 	MMSLA_ENTRY NewEntry = MmAssignEntrySla(&Overlay->Sla, SectionOffset, SlaEntry.Entry);
 	if (NewEntry == MM_SLA_OUT_OF_MEMORY)
 	{
@@ -214,7 +213,7 @@ static MAPPABLE_DISPATCH_TABLE MmpOverlayObjectMappableDispatch =
 void MmDeleteOverlayObject(UNUSED void* ObjectV)
 {
 	PMMOVERLAY Overlay = ObjectV;
-	MmDeinitializeSla(&Overlay->Sla, MmpFreeEntryOverlayObject);
+	MmDeinitializeSla(&Overlay->Sla, MiFreeEntryAnonymous);
 	ObDereferenceObject(Overlay->Parent);
 }
 
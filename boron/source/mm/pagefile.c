@@ -0,0 +1,378 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/pagefile.c
+	
+Abstract:
+	This module implements the page file and the page file writer.
+	
+	The page file is an existing file, named by the "PageFile"
+	boot configuration value, which is divided into page sized
+	slots.  A bitmap keeps track of which slots are in use.
+	
+	The working set manager queues the pages of anonymous sections
+	and CoW overlays that don't compress well.  The page file writer
+	writes them out in clusters of consecutive slots, one I/O per
+	cluster, and frees the pages.  This is the second half of the
+	modified page writer described in mm/mpw.c.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+#include <io.h>
+#include <ex.h>
+
+// The page file's slot number is stored in an anonymous SLA entry, in place of the PFN.
+// The last value is left out, so that a busy entry is never mistaken for MM_SLA_OUT_OF_MEMORY.
+#define MMP_MAX_PAGE_FILE_SLOTS (MI_ANON_ENTRY_PFN_LIMIT - 2)
+
+// The number of pages that can wait to be written to the page file.
+#define MMP_PAGE_OUT_QUEUE_SIZE (256)
+
+#define MMP_BITMAP_BITS (sizeof(uintptr_t) * 8)
+
+static PFILE_OBJECT MmpPageFile;
+
+static KSPIN_LOCK MmpPageFileLock;
+static uintptr_t* MmpPageFileBitmap;
+static size_t MmpPageFileSlotCount;
+static size_t MmpPageFileUsedSlots;
+static size_t MmpPageFileHint;
+
+static KSPIN_LOCK MmpPageOutQueueLock;
+static MIPAGE_OUT_REQUEST MmpPageOutQueue[MMP_PAGE_OUT_QUEUE_SIZE];
+static size_t MmpPageOutQueueHead;
+static size_t MmpPageOutQueueCount;
+static KEVENT MmpPageFileWriterEvent;
+
+// Signaled while no page is being read from the page file.
+static KSPIN_LOCK MmpPageInLock;
+static size_t MmpPageInCount;
+static KEVENT MmpPageInEvent;
+
+static uint64_t MmpPagesWritten;
+static uint64_t MmpPagesRead;
+
+bool MiIsPageFileActive()
+{
+	return MmpPageFile != NULL;
+}
+
+static bool MmpIsSlotUsed(size_t Slot)
+{
+	return MmpPageFileBitmap[Slot / MMP_BITMAP_BITS] & ((uintptr_t) 1 << (Slot % MMP_BITMAP_BITS));
+}
+
+// Finds the first run of Wanted free slots between Start and End.  If there is none,
+// the longest run that was found is returned instead.
+static size_t MmpFindFreeSlots(size_t Start, size_t End, size_t Wanted, size_t* OutCount)
+{
+	size_t BestSlot = MI_PAGE_FILE_SLOT_INVALID, BestCount = 0;
+	size_t Slot = Start;
+	
+	while (Slot < End)
+	{
+		// Skip over words of used slots at once.
+		if (Slot % MMP_BITMAP_BITS == 0 && MmpPageFileBitmap[Slot / MMP_BITMAP_BITS] == (uintptr_t) -1)
+		{
+			Slot += MMP_BITMAP_BITS;
+			continue;
+		}
+		
+		if (MmpIsSlotUsed(Slot))
+		{
+			Slot++;
+			continue;
+		}
+		
+		size_t Count = 1;
+		while (Count < Wanted && Slot + Count < End && !MmpIsSlotUsed(Slot + Count))
+			Count++;
+		
+		if (Count > BestCount)
+		{
+			BestSlot = Slot;
+			BestCount = Count;
+			
+			if (Count == Wanted)
+				break;
+		}
+		
+		Slot += Count;
+	}
+	
+	*OutCount = BestCount;
+	return BestSlot;
+}
+
+uint32_t MiAllocatePageFileSlots(size_t* Count)
+{
+	ASSERT(*Count != 0);
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&MmpPageFileLock, &Ipl);
+	
+	// Search from where the last allocation ended, so that clusters written one after
+	// the other end up next to each other in the file.
+	size_t FoundCount, WrappedCount;
+	size_t Slot = MmpFindFreeSlots(MmpPageFileHint, MmpPageFileSlotCount, *Count, &FoundCount);
+	
+	if (FoundCount < *Count)
+	{
+		size_t WrappedSlot = MmpFindFreeSlots(0, MmpPageFileHint, *Count, &WrappedCount);
+		if (WrappedCount > FoundCount)
+		{
+			Slot = WrappedSlot;
+			FoundCount = WrappedCount;
+		}
+	}
+	
+	if (FoundCount == 0)
+	{
+		KeReleaseSpinLock(&MmpPageFileLock, Ipl);
+		return MI_PAGE_FILE_SLOT_INVALID;
+	}
+	
+	for (size_t i = Slot; i < Slot + FoundCount; i++)
+		MmpPageFileBitmap[i / MMP_BITMAP_BITS] |= (uintptr_t) 1 << (i % MMP_BITMAP_BITS);
+	
+	MmpPageFileUsedSlots += FoundCount;
+	MmpPageFileHint = Slot + FoundCount;
+	if (MmpPageFileHint >= MmpPageFileSlotCount)
+		MmpPageFileHint = 0;
+	
+	KeReleaseSpinLock(&MmpPageFileLock, Ipl);
+	
+	*Count = FoundCount;
+	return (uint32_t) Slot;
+}
+
+void MiFreePageFileSlot(uint32_t Slot)
+{
+	ASSERT(Slot < MmpPageFileSlotCount);
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&MmpPageFileLock, &Ipl);
+	
+	ASSERT(MmpIsSlotUsed(Slot));
+	MmpPageFileBitmap[Slot / MMP_BITMAP_BITS] &= ~((uintptr_t) 1 << (Slot % MMP_BITMAP_BITS));
+	MmpPageFileUsedSlots--;
+	
+	KeReleaseSpinLock(&MmpPageFileLock, Ipl);
+}
+
+BSTATUS MiWritePageFile(uint32_t Slot, PMDL Mdl)
+{
+	IO_STATUS_BLOCK Iosb;
+	
+	BSTATUS Status = IoPerformPagingWrite(&Iosb, MmpPageFile, Mdl, (uint64_t) Slot * PAGE_SIZE);
+	if (FAILED(Status))
+		return Status;
+	
+	// The page file's size doesn't change, so this would mean it was truncated.
+	if (Iosb.BytesWritten != Mdl->ByteCount)
+		return STATUS_HARDWARE_IO_ERROR;
+	
+	AtAddFetch(MmpPagesWritten, Mdl->NumberPages);
+	return STATUS_SUCCESS;
+}
+
+BSTATUS MiReadPageFile(uint32_t Slot, MMPFN Pfn)
+{
+	IO_STATUS_BLOCK Iosb;
+	MDL_ONEPAGE Mdl;
+	MmInitializeSinglePageMdl(&Mdl, Pfn, MDL_FLAG_WRITE);
+	
+	BSTATUS Status = IoPerformPagingRead(&Iosb, MmpPageFile, &Mdl.Base, (uint64_t) Slot * PAGE_SIZE);
+	MmFreeMdl(&Mdl.Base);
+	
+	if (FAILED(Status))
+		return Status;
+	
+	if (Iosb.BytesRead != PAGE_SIZE)
+		return STATUS_HARDWARE_IO_ERROR;
+	
+	AtAddFetch(MmpPagesRead, 1);
+	return STATUS_SUCCESS;
+}
+
+void MiBeginPageIn()
+{
+	KIPL Ipl;
+	KeAcquireSpinLock(&MmpPageInLock, &Ipl);
+	
+	if (MmpPageInCount++ == 0)
+		KeResetEvent(&MmpPageInEvent);
+	
+	KeReleaseSpinLock(&MmpPageInLock, Ipl);
+}
+
+void MiEndPageIn()
+{
+	KIPL Ipl;
+	KeAcquireSpinLock(&MmpPageInLock, &Ipl);
+	
+	ASSERT(MmpPageInCount != 0);
+	if (--MmpPageInCount == 0)
+		KeSetEvent(&MmpPageInEvent, 0);
+	
+	KeReleaseSpinLock(&MmpPageInLock, Ipl);
+}
+
+void MiWaitForPageIn()
+{
+	// The event was reset before the busy entry was seen, and it's only set once that
+	// entry is done, so this can't miss the wake up.
+	BSTATUS Status = KeWaitForSingleObject(&MmpPageInEvent, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ASSERT(SUCCEEDED(Status));
+}
+
+bool MiQueuePageOut(void* MappableObject, uint64_t Index, MMPFN Pfn)
+{
+	KIPL Ipl;
+	KeAcquireSpinLock(&MmpPageOutQueueLock, &Ipl);
+	
+	if (MmpPageOutQueueCount == MMP_PAGE_OUT_QUEUE_SIZE)
+	{
+		KeReleaseSpinLock(&MmpPageOutQueueLock, Ipl);
+		return false;
+	}
+	
+	PMIPAGE_OUT_REQUEST Request = &MmpPageOutQueue[(MmpPageOutQueueHead + MmpPageOutQueueCount) % MMP_PAGE_OUT_QUEUE_SIZE];
+	Request->MappableObject = ObReferenceObjectByPointer(MappableObject);
+	Request->Index = Index;
+	Request->Pfn = Pfn;
+	
+	MmpPageOutQueueCount++;
+	KeReleaseSpinLock(&MmpPageOutQueueLock, Ipl);
+	
+	KeSetEvent(&MmpPageFileWriterEvent, 0);
+	return true;
+}
+
+// Takes the requests for the same object off the front of the queue, up to a cluster.
+static size_t MmpDequeuePageOut(PMIPAGE_OUT_REQUEST Requests)
+{
+	size_t Count = 0;
+	
+	KIPL Ipl;
+	KeAcquireSpinLock(&MmpPageOutQueueLock, &Ipl);
+	
+	while (MmpPageOutQueueCount != 0 && Count < MI_PAGE_FILE_CLUSTER)
+	{
+		PMIPAGE_OUT_REQUEST Request = &MmpPageOutQueue[MmpPageOutQueueHead];
+		if (Count != 0 && Request->MappableObject != Requests[0].MappableObject)
+			break;
+		
+		Requests[Count++] = *Request;
+		MmpPageOutQueueHead = (MmpPageOutQueueHead + 1) % MMP_PAGE_OUT_QUEUE_SIZE;
+		MmpPageOutQueueCount--;
+	}
+	
+	KeReleaseSpinLock(&MmpPageOutQueueLock, Ipl);
+	return Count;
+}
+
+NO_RETURN
+static void MmpPageFileWriter(UNUSED void* Context)
+{
+	MIPAGE_OUT_REQUEST Requests[MI_PAGE_FILE_CLUSTER];
+	
+	while (true)
+	{
+		KeWaitForSingleObject(&MmpPageFileWriterEvent, false, TIMEOUT_INFINITE, MODE_KERNEL);
+		
+		size_t Count;
+		while ((Count = MmpDequeuePageOut(Requests)) != 0)
+		{
+			MiPageOutAnonymous(Requests[0].MappableObject, Requests, Count);
+			
+			for (size_t i = 0; i < Count; i++)
+				ObDereferenceObject(Requests[i].MappableObject);
+		}
+	}
+}
+
+void MmGetPageFileStatistics(PMM_PAGE_FILE_STATISTICS Statistics)
+{
+	Statistics->TotalPages   = MmpPageFileSlotCount;
+	Statistics->UsedPages    = AtLoad(MmpPageFileUsedSlots);
+	Statistics->PagesWritten = AtLoad(MmpPagesWritten);
+	Statistics->PagesRead    = AtLoad(MmpPagesRead);
+}
+
+INIT
+void MmInitializePageFile()
+{
+	KeInitializeEvent(&MmpPageFileWriterEvent, EVENT_SYNCHRONIZATION, false);
+	KeInitializeEvent(&MmpPageInEvent, EVENT_NOTIFICATION, true);
+	
+	const char* Path = ExGetConfigValue("PageFile", NULL);
+	if (!Path)
+		return;
+	
+	// The handle is kept open for as long as the system runs.
+	HANDLE Handle;
+	BSTATUS Status = ObOpenObjectByName(Path, HANDLE_NONE, 0, IoFileType, &Handle);
+	if (FAILED(Status))
+	{
+		DbgPrint("Cannot open page file %s: %s (%d).  Running without a page file.", Path, RtlGetStatusString(Status), Status);
+		return;
+	}
+	
+	void* FileObject;
+	Status = ObReferenceObjectByHandle(Handle, IoFileType, &FileObject);
+	ASSERT(SUCCEEDED(Status));
+	
+	// The page file is used at its current size, so it must have been created in
+	// advance, with all of its blocks allocated.
+	PFILE_OBJECT PageFile = FileObject;
+	size_t SlotCount = AtLoad(PageFile->Fcb->FileLength) / PAGE_SIZE;
+	if (SlotCount > MMP_MAX_PAGE_FILE_SLOTS)
+		SlotCount = MMP_MAX_PAGE_FILE_SLOTS;
+	
+	if (!IoIsSeekable(PageFile->Fcb) || SlotCount == 0)
+	{
+		DbgPrint("Page file %s is empty or not a file.  Running without a page file.", Path);
+		ObDereferenceObject(PageFile);
+		return;
+	}
+	
+	size_t BitmapSize = (SlotCount + MMP_BITMAP_BITS - 1) / MMP_BITMAP_BITS * sizeof(uintptr_t);
+	MmpPageFileBitmap = MmAllocatePoolWithTag(POOL_NONPAGED, BitmapSize, POOL_TAG("MmPf"));
+	if (!MmpPageFileBitmap)
+	{
+		DbgPrint("Cannot allocate the bitmap of page file %s.  Running without a page file.", Path);
+		ObDereferenceObject(PageFile);
+		return;
+	}
+	
+	memset(MmpPageFileBitmap, 0, BitmapSize);
+	MmpPageFileSlotCount = SlotCount;
+	
+	PETHREAD Thread;
+	Status = PsCreateSystemThreadFast(
+		&Thread,
+		MmpPageFileWriter,
+		NULL,
+		false
+	);
+	
+	if (FAILED(Status))
+	{
+		KeCrash(
+			"ERROR: Could not launch page file writer: %d (%s)",
+			Status,
+			RtlGetStatusString(Status)
+		);
+	}
+	
+	ObDereferenceObject(Thread);
+	
+	// Only let the working set manager queue pages once the writer exists.
+	MmpPageFile = PageFile;
+	DbgPrint("Using page file %s with %zu pages.", Path, SlotCount);
+}
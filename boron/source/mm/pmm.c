@@ -427,6 +427,29 @@ void MiInitPMM()
 	}
 #endif
 	
+	// Leave out the memory whose PFNs don't fit in an anonymous SLA entry
+	// (see MIANON_ENTRY).  The PFNs of anonymous pages would otherwise be truncated.
+	const uint64_t MaxAddress = (uint64_t) MI_ANON_ENTRY_PFN_LIMIT * PAGE_SIZE;
+	for (uint64_t i = 0; i < MemoryRegionCount; i++)
+	{
+		PLOADER_MEMORY_REGION Entry = &MemoryRegions[i];
+		
+		if (Entry->Type != LOADER_MEM_FREE &&
+			Entry->Type != LOADER_MEM_LOADER_RECLAIMABLE &&
+			Entry->Type != LOADER_MEM_LOADED_PROGRAM)
+			continue;
+		
+		if ((uint64_t) Entry->Base + Entry->Size <= MaxAddress)
+			continue;
+		
+		DbgPrint("WARNING: Memory above %llu MB is not used.", MaxAddress / 1024 / 1024);
+		
+		if ((uint64_t) Entry->Base >= MaxAddress)
+			Entry->Size = 0;
+		else
+			Entry->Size = MaxAddress - Entry->Base;
+	}
+	
 	// pass 1: mapping the pages themselves
 	int numAllocatedPages = 0;
 	for (uint64_t i = 0; i < MemoryRegionCount; i++)
@@ -653,7 +676,12 @@ void MiDetransitionPfn(MMPFN Pfn)
 	MmpEnsurePfnIsntEndsOfList(&MiFirstStandbyPFN, &MiLastStandbyPFN, Pfdbe, Pfn);
 	MmpEnsurePfnIsntEndsOfList(&MiFirstModifiedPFN, &MiLastModifiedPFN, Pfdbe, Pfn);
 	
+	// Pages on the standby list count as free, but pages on the modified list don't.
+	if (Pfdbe->Type == PF_TYPE_TRANSITION)
+		MmTotalFreePages--;
+	
 	// Now that the PFN is unlinked, we can turn it into a used PFN.
+	Pfdbe->IsInModifiedPageList = false;
 	Pfdbe->RefCount = 1;
 	Pfdbe->NextFrame = 0;
 	Pfdbe->PrevFrame = 0;
@@ -739,6 +767,9 @@ static void MmpInitializePfn(PMMPFDBE Pfdbe)
 	Pfdbe->NextFrame = 0;
 	Pfdbe->PrevFrame = 0;
 	Pfdbe->FileCache._PrototypePte = 0;
+	Pfdbe->IsFileCache = 0;
+	Pfdbe->Modified = 0;
+	Pfdbe->Age = 0;
 	MmTotalFreePages--;
 }
 
@@ -780,6 +811,10 @@ MMPFN MmAllocatePhysicalPage()
 	MMPFN currPFN = MiAllocatePhysicalPageWithPfdbLocked(&FromZero);
 	KeReleaseSpinLock(&MmPfnLock, OldIpl);
 	
+	// If free memory is running low, have the working set manager trim some pages.
+	if (MmTotalFreePages < MiWorkingSetLowWatermark)
+		MiWakeWorkingSetManager();
+	
 	if (!FromZero && currPFN != PFN_INVALID)
 	{
 		MmBeginUsingHHDM();
@@ -826,6 +861,40 @@ void MmSetPrototypePtePfn(MMPFN Pfn, MM_PROTOTYPE_PTE_PTR PrototypePte)
 	KeReleaseSpinLock(&MmPfnLock, OldIpl);
 }
 
+void MmDetachCachedPfn(MMPFN Pfn)
+{
+	ASSERT(Pfn != PFN_INVALID);
+	
+	KIPL OldIpl;
+	KeAcquireSpinLock(&MmPfnLock, &OldIpl);
+	
+	PMMPFDBE Pfdbe = MmGetPageFrameFromPFN(Pfn);
+	
+	if (Pfdbe->Type == PF_TYPE_TRANSITION)
+	{
+		// The page was only kept around in case it was needed again.
+		MmpRemovePfnFromList(&MiFirstStandbyPFN, &MiLastStandbyPFN, Pfn);
+		MmpAddPfnToList(&MiFirstFreePFN, &MiLastFreePFN, Pfn);
+		Pfdbe->Type = PF_TYPE_FREE;
+	}
+	else if (Pfdbe->Type == PF_TYPE_USED && Pfdbe->IsInModifiedPageList)
+	{
+		// There is nowhere to write the page back to anymore.
+		MmpRemovePfnFromList(&MiFirstModifiedPFN, &MiLastModifiedPFN, Pfn);
+		MmpAddPfnToList(&MiFirstFreePFN, &MiLastFreePFN, Pfn);
+		Pfdbe->Type = PF_TYPE_FREE;
+		MmTotalFreePages++;
+	}
+	
+	// If the page is still in use, then it'll go to the free list when it's freed.
+	Pfdbe->FileCache._PrototypePte = 0;
+	Pfdbe->IsInModifiedPageList = false;
+	Pfdbe->IsFileCache = 0;
+	Pfdbe->Modified = 0;
+	
+	KeReleaseSpinLock(&MmPfnLock, OldIpl);
+}
+
 void MmSetCacheDetailsPfn(MMPFN Pfn, PFCB Fcb, uint64_t Offset)
 {
 	ASSERT(Pfn != PFN_INVALID);
@@ -840,8 +909,13 @@ void MmSetCacheDetailsPfn(MMPFN Pfn, PFCB Fcb, uint64_t Offset)
 	Pfdbe->FileCache._Fcb = (uintptr_t) Fcb;
 	Pfdbe->FileCache._OffsetLower = Offset;
 	Pfdbe->_OffsetUpper = (Offset >> 32);
+	
+	// If this page was already part of the page cache, it may have been modified
+	// through another mapping, and that must not be forgotten.
+	if (!Pfdbe->IsFileCache)
+		Pfdbe->Modified = 0;
+	
 	Pfdbe->IsFileCache = 1;
-	Pfdbe->Modified = 0;
 	
 	KeReleaseSpinLock(&MmPfnLock, OldIpl);
 }
@@ -974,6 +1048,17 @@ void MiTransformPageToStandbyPfn(MMPFN Pfn)
 		return;
 	}
 	
+	// If the page cache was torn down while the page was being written, then
+	// there is nothing to keep it around for.
+	if (!Pfdbe->FileCache._PrototypePte)
+	{
+		MmpAddPfnToList(&MiFirstFreePFN, &MiLastFreePFN, Pfn);
+		Pfdbe->Type = PF_TYPE_FREE;
+		Pfdbe->Modified = 0;
+		MmTotalFreePages++;
+		return;
+	}
+	
 	MmpAddPfnToList(&MiFirstStandbyPFN, &MiLastStandbyPFN, Pfn);
 	Pfdbe->Type = PF_TYPE_TRANSITION;
 	Pfdbe->Modified = 0;
@@ -1236,3 +1321,135 @@ void MmFreePhysicalContiguousRegion(MMPFN PfnStart, int PageCount)
 	for (int i = 0; i < PageCount; i++)
 		MmFreePhysicalPage(PfnStart + i);
 }
+
+#ifdef MM_HUGE_PAGE_SIZE
+
+// The PFN at which the next search for a huge page starts.  Searches continue where the
+// last one left off, instead of rescanning the start of memory, which fills up first.
+static MMPFN MiHugePageSearchHint;
+
+// If the last search failed, the number of free pages at the time.  There's no point in
+// searching again until at least a huge page's worth of memory has been freed since.
+static bool MiHugePageSearchFailed;
+static size_t MiHugePageFailedFreePages;
+
+// Claims the huge page starting at Pfn if all of its pages are free.  Otherwise, the
+// first page that isn't free is written to BusyPfn.  The PFDB lock must be held.
+static bool MmpTryClaimHugePage(MMPFN Pfn, MMPFN* BusyPfn)
+{
+	ASSERT(MmPfnLock.Locked);
+	
+	// Only pages on the free list are considered.  Zeroed pages may be off every list
+	// while they're being zeroed, so their type doesn't say whether they can be taken.
+	for (MMPFN i = 0; i < MI_HUGE_PAGE_PAGES; i++)
+	{
+		if (!MmpIsFree(Pfn + i))
+		{
+			*BusyPfn = Pfn + i;
+			return false;
+		}
+	}
+	
+	for (MMPFN i = 0; i < MI_HUGE_PAGE_PAGES; i++)
+	{
+		MmpRemovePfnFromItsList(Pfn + i);
+		MmpInitializePfn(MmGetPageFrameFromPFN(Pfn + i));
+	}
+	
+	return true;
+}
+
+// Searches the huge pages in the range [Start, End) of a memory region.
+static MMPFN MmpSearchHugePage(MMPFN Start, MMPFN End)
+{
+	Start = (Start + MI_HUGE_PAGE_PAGES - 1) & ~(MI_HUGE_PAGE_PAGES - 1);
+	
+	for (MMPFN Pfn = Start; Pfn + MI_HUGE_PAGE_PAGES <= End; )
+	{
+		// The lock is only held while looking at one huge page, so that a long search
+		// doesn't hold up other allocations.
+		KIPL OldIpl;
+		MMPFN BusyPfn = PFN_INVALID;
+		KeAcquireSpinLock(&MmPfnLock, &OldIpl);
+		bool Claimed = MmpTryClaimHugePage(Pfn, &BusyPfn);
+		KeReleaseSpinLock(&MmPfnLock, OldIpl);
+		
+		if (Claimed)
+			return Pfn;
+		
+		// No huge page containing the busy page can be claimed, so skip past it.
+		Pfn = (BusyPfn + MI_HUGE_PAGE_PAGES) & ~(MI_HUGE_PAGE_PAGES - 1);
+	}
+	
+	return PFN_INVALID;
+}
+
+MMPFN MiAllocateHugePhysicalPage()
+{
+	size_t FreePages = AtLoad(MmTotalFreePages);
+	if (FreePages < MI_HUGE_PAGE_PAGES)
+		return PFN_INVALID;
+	
+	if (AtLoad(MiHugePageSearchFailed) && FreePages < AtLoad(MiHugePageFailedFreePages) + MI_HUGE_PAGE_PAGES)
+		return PFN_INVALID;
+	
+	PLOADER_MEMORY_REGION MemoryRegions = KeLoaderParameterBlock.MemoryRegions;
+	size_t MemoryRegionCount = KeLoaderParameterBlock.MemoryRegionCount;
+	MMPFN Hint = AtLoad(MiHugePageSearchHint);
+	MMPFN Pfn = PFN_INVALID;
+	
+	// The first pass searches from the hint onwards, and the second one searches what
+	// the first one skipped.  Only the regions that the PFN database describes are
+	// searched.
+	for (int Pass = 0; Pass < 2 && Pfn == PFN_INVALID; Pass++)
+	{
+		for (size_t i = 0; i < MemoryRegionCount && Pfn == PFN_INVALID; i++)
+		{
+			PLOADER_MEMORY_REGION Entry = &MemoryRegions[i];
+			
+			if (Entry->Type != LOADER_MEM_FREE &&
+				Entry->Type != LOADER_MEM_LOADER_RECLAIMABLE &&
+				Entry->Type != LOADER_MEM_LOADED_PROGRAM)
+				continue;
+			
+			MMPFN Start = MmPhysPageToPFN(Entry->Base);
+			MMPFN End   = MmPhysPageToPFN(Entry->Base + Entry->Size);
+			
+			if (Pass == 0 && Start < Hint)
+				Start = Hint;
+			
+			if (Pass == 1 && End > Hint)
+				End = Hint;
+			
+			if (Start < End)
+				Pfn = MmpSearchHugePage(Start, End);
+		}
+	}
+	
+	if (Pfn == PFN_INVALID)
+	{
+		AtStore(MiHugePageFailedFreePages, FreePages);
+		AtStore(MiHugePageSearchFailed, true);
+		return PFN_INVALID;
+	}
+	
+	AtStore(MiHugePageSearchHint, Pfn + MI_HUGE_PAGE_PAGES);
+	AtStore(MiHugePageSearchFailed, false);
+	
+	MmBeginUsingHHDM();
+	memset(MmGetHHDMOffsetAddr(MmPFNToPhysPage(Pfn)), 0, MM_HUGE_PAGE_SIZE);
+	MmEndUsingHHDM();
+	
+	return Pfn;
+}
+
+void MiFreeHugePhysicalPage(MMPFN Pfn)
+{
+	ASSERT((Pfn & (MI_HUGE_PAGE_PAGES - 1)) == 0);
+	
+	// Pages pinned by an MDL stay allocated until they are unpinned.
+	for (MMPFN i = 0; i < MI_HUGE_PAGE_PAGES; i++)
+		MmFreePhysicalPage(Pfn + i);
+}
+
+#endif
@@ -56,6 +56,8 @@ void* MmAllocatePoolBig(int PoolFlags, size_t PageCount, int Tag)
 		}
 		
 		MmUnlockKernelSpace();
+		
+		MiRecordPoolAllocation(Tag, MI_POOL_LAYER_BIG, NonPaged, PageCount * PAGE_SIZE);
 	}
 	
 	return OutputAddress;
@@ -66,6 +68,16 @@ void MmFreePoolBig(void* Address)
 	MIPOOL_SPACE_HANDLE Handle = MiGetPoolSpaceHandleFromAddress(Address);
 	
 	int PoolFlags = (int) MiGetUserDataFromPoolSpaceHandle(Handle);
+	if (~PoolFlags & POOL_FLAG_CALLER_CONTROLLED)
+	{
+		MiRecordPoolFree(
+			MiGetTagFromPoolSpaceHandle(Handle),
+			MI_POOL_LAYER_BIG,
+			PoolFlags & POOL_FLAG_NON_PAGED,
+			MiGetSizeFromPoolSpaceHandle(Handle) * PAGE_SIZE
+		);
+	}
+	
 	if ((~PoolFlags & POOL_FLAG_CALLER_CONTROLLED) ||
 		(PoolFlags & POOL_FLAG_UNMAP_ANYWAY))
 	{
@@ -93,6 +105,15 @@ void* MmAllocatePool(int PoolFlags, size_t Size)
 	return Result;
 }
 
+void* MmAllocatePoolWithTag(int PoolFlags, size_t Size, int Tag)
+{
+	void* Result = MiSlabAllocateTagged(PoolFlags & POOL_FLAG_NON_PAGED, Size, Tag);
+#ifdef POOLDEBUG
+	DbgPrint("MmAllocatePoolWithTag(%d, %5zu, %.4s) => %p (RA: %p)", PoolFlags, Size, (char*) &Tag, Result, CallerAddress());
+#endif
+	return Result;
+}
+
 void MmFreePool(void* Pointer)
 {
 	MiSlabFree(Pointer);
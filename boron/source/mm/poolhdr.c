@@ -20,15 +20,15 @@ typedef struct
 	// UPDATE MmpAllocateFromPoolEntrySlab if changing these.
 
 #ifdef IS_64_BIT
-	#define POOL_ENTRY_COUNT 84
-	// Size of a MIPOOL_ENTRY is 48.
+	#define POOL_ENTRY_COUNT 63
+	// Size of a MIPOOL_ENTRY is 64.
 	// Size of additional data is 32 bytes. (2xPtr=16 + 2xU64=16)
 	// Note: Free space is 32 bytes
 #else
-	#define POOL_ENTRY_COUNT 64
-	// Size of a MIPOOL_ENTRY is 32
+	#define POOL_ENTRY_COUNT 101
+	// Size of a MIPOOL_ENTRY is 40
 	// Size of additional data is 24 bytes (2xPtr=8 + 2xU64=16)
-	// Note: Free space is 8 bytes
+	// Note: Free space is 32 bytes
 #endif
 
 	MIPOOL_ENTRY Entries[POOL_ENTRY_COUNT];
@@ -39,35 +39,26 @@ MIPOOL_ENTRY_SLAB, *PMIPOOL_ENTRY_SLAB;
 
 static_assert(sizeof(MIPOOL_ENTRY_SLAB) <= PAGE_SIZE);
 static_assert((sizeof(MIPOOL_ENTRY) & 0x7) == 0);
+static_assert(POOL_ENTRY_COUNT <= 64 * 2);
 
 static LIST_ENTRY MmpPoolSlabList;
 static KSPIN_LOCK MmpPoolSlabListLock;
 
 PMIPOOL_ENTRY MmpAllocateFromPoolEntrySlab(PMIPOOL_ENTRY_SLAB Slab)
 {
-	if (Slab->Bitmap[0] != ~0ULL)
+	for (int i = 0; i < POOL_ENTRY_COUNT; i++)
 	{
-		// Can allocate in the first part
-		for (int i = 0; i < 64; i++)
+		// Skip over parts of the bitmap which are full.
+		if (i % 64 == 0 && Slab->Bitmap[i / 64] == ~0ULL)
 		{
-			if (~Slab->Bitmap[0] & (1ULL << i))
-			{
-				Slab->Bitmap[0] |=  1ULL << i;
-				return &Slab->Entries[i];
-			}
+			i += 63;
+			continue;
 		}
-	}
-	
-	const uint64_t FirstTwentyBitsSet = (1ULL << (POOL_ENTRY_COUNT - 64)) - 1;
-	if ((Slab->Bitmap[1] & FirstTwentyBitsSet) != FirstTwentyBitsSet)
-	{
-		for (int i = 0, j = 64; i < POOL_ENTRY_COUNT - 64; i++, j++)
+		
+		if (~Slab->Bitmap[i / 64] & (1ULL << (i % 64)))
 		{
-			if (~Slab->Bitmap[1] & (1ULL << i))
-			{
-				Slab->Bitmap[1] |=  1ULL << i;
-				return &Slab->Entries[j];
-			}
+			Slab->Bitmap[i / 64] |= 1ULL << (i % 64);
+			return &Slab->Entries[i];
 		}
 	}
 	
@@ -142,22 +142,57 @@ uintptr_t MiReconstructPoolHandleFromPte(MMPTE Pte)
 #endif
 
 //
-// TODO: This could be improved, however, it's probably OK for now.
+// The pool space allocator hands out ranges of pages.  It doesn't allocate the actual
+// memory, only the ranges, and the headers are separate from the memory they describe
+// (they're managed by poolhdr.c).
 //
-// Based on NanoShell's heap manager implementation (crt/src/a_mem.c), however,
-// it deals in pages, doesn't allocate the actual memory (only the ranges),
-// and the headers are separate from the actual memory (they're managed by poolhdr.c).
+// All entries, free and allocated, are linked in address order in MmpPoolList.  Since
+// a handle is the entry itself, the neighbors of a range are known in constant time
+// when it is freed, and free neighbors are coalesced with it.
 //
+// Free entries are also linked into segregated free lists.  Free list N holds entries
+// whose size in pages is in the range [2^N, 2^(N+1)).  A reservation takes the first
+// entry of the smallest non-empty list whose entries are all large enough, so it does
+// not search.  Only if there is no such list is the list below it searched.
+//
+// On top of that, each processor keeps a quantum cache of small ranges, which can be
+// reserved and freed without taking the pool lock.  These ranges stay allocated from
+// the point of view of the free lists.
+//
+
+#define MI_POOL_FREE_LIST_COUNT (64)
+
+// Ranges of up to this many pages (including the header page) are cached.
+#define MI_POOL_QUANTUM_MAX (8)
+
+// The number of ranges of each size cached per processor.  When a cache is found
+// empty or full, half this many ranges are moved with one acquisition of the lock.
+#define MI_POOL_QUANTUM_DEPTH (8)
+
+// Matches the processor limit imposed by KeInitSMP.
+#define MI_POOL_MAX_PROCESSORS (64)
+
+typedef struct
+{
+	int Count;
+	PMIPOOL_ENTRY Entries[MI_POOL_QUANTUM_DEPTH];
+}
+MIPOOL_QUANTUM_CACHE, *PMIPOOL_QUANTUM_CACHE;
 
 static KSPIN_LOCK MmpPoolLock;
 static LIST_ENTRY MmpPoolList;
+static LIST_ENTRY MmpPoolFreeLists[MI_POOL_FREE_LIST_COUNT];
+static uint64_t   MmpPoolFreeListBitmap;
+
+static MIPOOL_QUANTUM_CACHE MmpPoolQuantumCaches[MI_POOL_MAX_PROCESSORS][MI_POOL_QUANTUM_MAX];
 
 #define MIP_CURRENT(CE) CONTAINING_RECORD((CE), MIPOOL_ENTRY, ListEntry)
 #define MIP_FLINK(E) CONTAINING_RECORD((E)->Flink, MIPOOL_ENTRY, ListEntry)
 #define MIP_BLINK(E) CONTAINING_RECORD((E)->Blink, MIPOOL_ENTRY, ListEntry)
 #define MIP_START_ITER(Lst) ((Lst)->Flink)
 
-#define MI_EMPTY_TAG MI_TAG("    ")
+#define MI_EMPTY_TAG  MI_TAG("    ")
+#define MI_CACHED_TAG MI_TAG("QCch")
 
 #ifdef TARGET_I386
 
@@ -217,6 +252,43 @@ void MiInitializePoolPageTables()
 
 #endif
 
+static int MmpFloorLog2(uint64_t Value)
+{
+	ASSERT(Value != 0);
+	return 63 - __builtin_clzll(Value);
+}
+
+static int MmpCeilLog2(uint64_t Value)
+{
+	int Log2 = MmpFloorLog2(Value);
+	
+	if (Value & (Value - 1))
+		Log2++;
+	
+	return Log2;
+}
+
+// Links a free entry into the free list for its size.  The pool lock must be held.
+static void MmpInsertFreeEntry(PMIPOOL_ENTRY Entry)
+{
+	int Index = MmpFloorLog2(Entry->Size);
+	
+	InsertHeadList(&MmpPoolFreeLists[Index], &Entry->FreeListEntry);
+	MmpPoolFreeListBitmap |= 1ULL << Index;
+}
+
+// Unlinks a free entry from its free list.  This must be done before changing the
+// size of the entry.  The pool lock must be held.
+static void MmpRemoveFreeEntry(PMIPOOL_ENTRY Entry)
+{
+	int Index = MmpFloorLog2(Entry->Size);
+	
+	RemoveEntryList(&Entry->FreeListEntry);
+	
+	if (IsListEmpty(&MmpPoolFreeLists[Index]))
+		MmpPoolFreeListBitmap &= ~(1ULL << Index);
+}
+
 INIT
 void MiInitPool()
 {
@@ -226,12 +298,16 @@ void MiInitPool()
 	
 	InitializeListHead(&MmpPoolList);
 	
+	for (int i = 0; i < MI_POOL_FREE_LIST_COUNT; i++)
+		InitializeListHead(&MmpPoolFreeLists[i]);
+	
 	PMIPOOL_ENTRY Entry = MiCreatePoolEntry();
 	Entry->Flags = 0;
 	Entry->Tag   = MI_EMPTY_TAG;
 	Entry->Size  = 1ULL << (MI_POOL_LOG2_SIZE - 12);
 	Entry->Address = MiGetTopOfPoolManagedArea();
 	InsertTailList(&MmpPoolList, &Entry->ListEntry);
+	MmpInsertFreeEntry(Entry);
 
 #ifdef MI_USE_TWO_POOLS
 
@@ -242,36 +318,35 @@ void MiInitPool()
 	Entry->Size  = 1ULL << (MI_POOL_LOG2_SIZE_2ND - 12);
 	Entry->Address = MiGetTopOfSecondPoolManagedArea();
 	InsertTailList(&MmpPoolList, &Entry->ListEntry);
+	MmpInsertFreeEntry(Entry);
 	
 #endif
 }
 
-MIPOOL_SPACE_HANDLE MmpSplitEntry(PMIPOOL_ENTRY PoolEntry, size_t SizeInPages, void** OutputAddress, int Tag, uintptr_t UserData)
+// Allocates the first SizeInPages pages of a free entry.  The pool lock must be held.
+static PMIPOOL_ENTRY MmpSplitEntry(PMIPOOL_ENTRY PoolEntry, size_t SizeInPages, int Tag, uintptr_t UserData)
 {
 	// Basic case: If PoolEntry's size matches SizeInPages
 	if (PoolEntry->Size == SizeInPages)
 	{
 		// Convert the entire entry into an allocated one, and return it.
+		MmpRemoveFreeEntry(PoolEntry);
 		PoolEntry->Flags   |= MI_POOL_ENTRY_ALLOCATED;
 		PoolEntry->Tag      = Tag;
 		PoolEntry->UserData = UserData;
-		
-		if (OutputAddress)
-			*OutputAddress = (void*) PoolEntry->Address;
-		
-		return (MIPOOL_SPACE_HANDLE) PoolEntry;
+		return PoolEntry;
 	}
 	
 	// This entry manages the area directly after the PoolEntry does.
 	PMIPOOL_ENTRY NewEntry = MiCreatePoolEntry();
 	
 	if (!NewEntry)
-		return 0;
+		return NULL;
+	
+	MmpRemoveFreeEntry(PoolEntry);
 	
 	// Link it such that:
 	// PoolEntry ====> NewEntry ====> PoolEntry->Flink
-	ASSERT(NewEntry);
-	ASSERT(PoolEntry);
 	ASSERT(PoolEntry->ListEntry.Flink);
 	ASSERT(PoolEntry->ListEntry.Blink);
 	InsertHeadList(&PoolEntry->ListEntry, &NewEntry->ListEntry);
@@ -281,120 +356,292 @@ MIPOOL_SPACE_HANDLE MmpSplitEntry(PMIPOOL_ENTRY PoolEntry, size_t SizeInPages, v
 	NewEntry->Tag   = MI_EMPTY_TAG;
 	NewEntry->Size  = PoolEntry->Size - SizeInPages;
 	NewEntry->Address = PoolEntry->Address + SizeInPages * PAGE_SIZE;
+	MmpInsertFreeEntry(NewEntry);
 	
 	// Update the properties of the pool entry
 	PoolEntry->Size     = SizeInPages;
 	PoolEntry->Tag      = Tag;
 	PoolEntry->Flags   |= MI_POOL_ENTRY_ALLOCATED;
 	PoolEntry->UserData = UserData;
+	return PoolEntry;
+}
+
+// Finds a free entry of at least SizeInPages pages.  The pool lock must be held.
+static PMIPOOL_ENTRY MmpFindFreeEntry(size_t SizeInPages)
+{
+	// Every entry in the lists starting at this index is large enough.
+	int Index = MmpCeilLog2(SizeInPages);
 	
-	// Update the output address
-	if (OutputAddress)
-		*OutputAddress = (void*) PoolEntry->Address;
+	uint64_t Candidates = 0;
+	if (Index < MI_POOL_FREE_LIST_COUNT)
+		Candidates = MmpPoolFreeListBitmap & ~((1ULL << Index) - 1);
+	
+	if (Candidates)
+	{
+		PLIST_ENTRY Entry = MmpPoolFreeLists[__builtin_ctzll(Candidates)].Flink;
+		return CONTAINING_RECORD(Entry, MIPOOL_ENTRY, FreeListEntry);
+	}
 	
-	return (MIPOOL_SPACE_HANDLE) PoolEntry;
+	// The list below might still contain an entry that is large enough.
+	PLIST_ENTRY Head = &MmpPoolFreeLists[MmpFloorLog2(SizeInPages)];
+	
+	for (PLIST_ENTRY Entry = Head->Flink; Entry != Head; Entry = Entry->Flink)
+	{
+		PMIPOOL_ENTRY PoolEntry = CONTAINING_RECORD(Entry, MIPOOL_ENTRY, FreeListEntry);
+		
+		if (PoolEntry->Size >= SizeInPages)
+			return PoolEntry;
+	}
+	
+	return NULL;
 }
 
-MIPOOL_SPACE_HANDLE MiReservePoolSpaceTaggedSub(size_t SizeInPages, void** OutputAddress, int Tag, uintptr_t UserData)
+// Reserves a range of SizeInPages pages.  The pool lock must be held.
+static PMIPOOL_ENTRY MmpReserveEntry(size_t SizeInPages, int Tag, uintptr_t UserData)
 {
-	KIPL OldIpl;
-	KeAcquireSpinLock(&MmpPoolLock, &OldIpl);
-	PLIST_ENTRY CurrentEntry = MIP_START_ITER(&MmpPoolList);
+	PMIPOOL_ENTRY Entry = MmpFindFreeEntry(SizeInPages);
 	
-	if (OutputAddress)
-		*OutputAddress = NULL;
+	if (!Entry)
+		return NULL;
 	
-	// This is a first-fit allocator.
+	return MmpSplitEntry(Entry, SizeInPages, Tag, UserData);
+}
+
+static bool MmpCanCoalesce(PMIPOOL_ENTRY First, PMIPOOL_ENTRY Second)
+{
+	return ~First->Flags & MI_POOL_ENTRY_ALLOCATED &&
+	       ~Second->Flags & MI_POOL_ENTRY_ALLOCATED &&
+	       First->Address + First->Size * PAGE_SIZE == Second->Address;
+}
+
+// Returns an allocated entry to the free lists, coalescing it with its neighbors.
+// The pool lock must be held.
+static void MmpFreeEntry(PMIPOOL_ENTRY Entry)
+{
+	Entry->Flags   &= ~(MI_POOL_ENTRY_ALLOCATED | MI_POOL_ENTRY_CACHED);
+	Entry->Tag      = MI_EMPTY_TAG;
+	Entry->UserData = 0;
 	
-	while (CurrentEntry != &MmpPoolList)
+	if (Entry->ListEntry.Flink != &MmpPoolList)
 	{
-#ifdef DEBUG
-		if (CurrentEntry == NULL)
-			KeCrash("HUH?!?  CurrentEntry is NULL");
-#endif
+		PMIPOOL_ENTRY Next = MIP_FLINK(&Entry->ListEntry);
 		
-		// Skip allocated entries.
-		PMIPOOL_ENTRY Current = MIP_CURRENT(CurrentEntry);
+		if (MmpCanCoalesce(Entry, Next))
+		{
+			MmpRemoveFreeEntry(Next);
+			Entry->Size += Next->Size;
+			RemoveEntryList(&Next->ListEntry);
+			MiDeletePoolEntry(Next);
+		}
+	}
+	
+	if (Entry->ListEntry.Blink != &MmpPoolList)
+	{
+		PMIPOOL_ENTRY Previous = MIP_BLINK(&Entry->ListEntry);
 		
-		if (Current->Flags & MI_POOL_ENTRY_ALLOCATED)
+		if (MmpCanCoalesce(Previous, Entry))
 		{
-			CurrentEntry = CurrentEntry->Flink;
-			continue;
+			MmpRemoveFreeEntry(Previous);
+			Previous->Size += Entry->Size;
+			RemoveEntryList(&Entry->ListEntry);
+			MiDeletePoolEntry(Entry);
+			Entry = Previous;
 		}
+	}
+	
+	MmpInsertFreeEntry(Entry);
+}
+
+// Gets the current processor's quantum cache for ranges of SizeInPages pages.
+// The IPL must be at least IPL_DPC.
+static PMIPOOL_QUANTUM_CACHE MmpGetQuantumCache(size_t SizeInPages)
+{
+	int Id = KeGetCurrentPRCB()->Id;
+	ASSERT(Id < MI_POOL_MAX_PROCESSORS);
+	
+	return &MmpPoolQuantumCaches[Id][SizeInPages - 1];
+}
+
+// Takes a range of SizeInPages pages from the current processor's quantum cache,
+// refilling the cache from the free lists if it's empty.  Returns NULL if the range
+// is too large to be cached, or if the pool ran out of space.
+static PMIPOOL_ENTRY MmpReserveFromQuantumCache(size_t SizeInPages)
+{
+	// The quantum caches are only used once the processors have been initialized.
+	if (SizeInPages > MI_POOL_QUANTUM_MAX || !KeGetCurrentPRCB())
+		return NULL;
+	
+	KIPL OldIpl = KeRaiseIPL(IPL_DPC);
+	PMIPOOL_QUANTUM_CACHE Cache = MmpGetQuantumCache(SizeInPages);
+	
+	if (Cache->Count == 0)
+	{
+		KIPL Unused;
+		KeAcquireSpinLock(&MmpPoolLock, &Unused);
 		
-		if (Current->Size >= SizeInPages)
+		while (Cache->Count < MI_POOL_QUANTUM_DEPTH / 2)
 		{
-			MIPOOL_SPACE_HANDLE Handle = MmpSplitEntry(Current, SizeInPages, OutputAddress, Tag, UserData);
-			KeReleaseSpinLock(&MmpPoolLock, OldIpl);
-			return Handle;
+			PMIPOOL_ENTRY Entry = MmpReserveEntry(SizeInPages, MI_CACHED_TAG, 0);
+			if (!Entry)
+				break;
+			
+			Entry->Flags |= MI_POOL_ENTRY_CACHED;
+			Cache->Entries[Cache->Count++] = Entry;
 		}
 		
-#ifdef DEBUG
-		if (CurrentEntry->Flink == NULL)
-			KeCrash("HUH?!?  CurrentEntry->Flink is NULL!  CurrentEntry: %p");
-#endif
+		KeReleaseSpinLock(&MmpPoolLock, Unused);
+	}
+	
+	PMIPOOL_ENTRY Entry = NULL;
+	if (Cache->Count != 0)
+	{
+		Entry = Cache->Entries[--Cache->Count];
+		Entry->Flags &= ~MI_POOL_ENTRY_CACHED;
+	}
+	
+	KeLowerIPL(OldIpl);
+	return Entry;
+}
+
+// Puts a range into the current processor's quantum cache, returning the older half
+// of the cache to the free lists if it's full.  Returns false if the range is too large
+// to be cached.
+static bool MmpFreeToQuantumCache(PMIPOOL_ENTRY Entry)
+{
+	if (Entry->Size > MI_POOL_QUANTUM_MAX || !KeGetCurrentPRCB())
+		return false;
+	
+	KIPL OldIpl = KeRaiseIPL(IPL_DPC);
+	PMIPOOL_QUANTUM_CACHE Cache = MmpGetQuantumCache(Entry->Size);
+	
+	if (Cache->Count == MI_POOL_QUANTUM_DEPTH)
+	{
+		KIPL Unused;
+		KeAcquireSpinLock(&MmpPoolLock, &Unused);
 		
-		CurrentEntry = CurrentEntry->Flink;
+		for (int i = 0; i < MI_POOL_QUANTUM_DEPTH / 2; i++)
+			MmpFreeEntry(Cache->Entries[i]);
+		
+		KeReleaseSpinLock(&MmpPoolLock, Unused);
+		
+		memmove(
+			Cache->Entries,
+			Cache->Entries + MI_POOL_QUANTUM_DEPTH / 2,
+			sizeof(PMIPOOL_ENTRY) * (MI_POOL_QUANTUM_DEPTH - MI_POOL_QUANTUM_DEPTH / 2)
+		);
+		
+		Cache->Count -= MI_POOL_QUANTUM_DEPTH / 2;
 	}
 	
+	Entry->Flags   |= MI_POOL_ENTRY_CACHED;
+	Entry->Tag      = MI_CACHED_TAG;
+	Entry->UserData = 0;
+	Cache->Entries[Cache->Count++] = Entry;
+	
+	KeLowerIPL(OldIpl);
+	return true;
+}
+
+MIPOOL_SPACE_HANDLE MiReservePoolSpaceTaggedSub(size_t SizeInPages, void** OutputAddress, int Tag, uintptr_t UserData)
+{
+	if (OutputAddress)
+		*OutputAddress = NULL;
+	
+	PMIPOOL_ENTRY Entry = MmpReserveFromQuantumCache(SizeInPages);
+	
+	if (Entry)
+	{
+		Entry->Tag      = Tag;
+		Entry->UserData = UserData;
+	}
+	else
+	{
+		KIPL OldIpl;
+		KeAcquireSpinLock(&MmpPoolLock, &OldIpl);
+		Entry = MmpReserveEntry(SizeInPages, Tag, UserData);
+		KeReleaseSpinLock(&MmpPoolLock, OldIpl);
+	}
+	
+	if (!Entry)
+	{
 #ifdef DEBUG
-	DbgPrint("ERROR: MiReservePoolSpaceTaggedSub ran out of pool space?! (Dude, we have 512 GiB of VM space, what are you doing?!)");
+		DbgPrint("ERROR: MiReservePoolSpaceTaggedSub ran out of pool space?! (Dude, we have 512 GiB of VM space, what are you doing?!)");
 #endif
+		return (MIPOOL_SPACE_HANDLE) NULL;
+	}
 	
 	if (OutputAddress)
-		*OutputAddress = NULL;
+		*OutputAddress = (void*) Entry->Address;
 	
-	KeReleaseSpinLock(&MmpPoolLock, OldIpl);
-	return (MIPOOL_SPACE_HANDLE) NULL;
+	return (MIPOOL_SPACE_HANDLE) Entry;
 }
 
-static void MmpTryConnectEntryWithItsFlink(PMIPOOL_ENTRY Entry)
+#ifdef MM_HUGE_PAGE_SIZE
+
+// Reserves a range of SizeInPages pages, such that the address Offset bytes into it is
+// aligned to Alignment.  The pool lock must be held.
+static PMIPOOL_ENTRY MmpReserveEntryAligned(size_t SizeInPages, uintptr_t Alignment, uintptr_t Offset, int Tag, uintptr_t UserData)
 {
+	PMIPOOL_ENTRY Entry = MmpFindFreeEntry(SizeInPages + Alignment / PAGE_SIZE - 1);
+	
 	if (!Entry)
-		return;
+		return NULL;
 	
-	PMIPOOL_ENTRY Flink = MIP_FLINK(&Entry->ListEntry);
-	if (Flink &&
-		~Flink->Flags & MI_POOL_ENTRY_ALLOCATED &&
-		~Entry->Flags & MI_POOL_ENTRY_ALLOCATED &&
-		Flink->Address == Entry->Address + Entry->Size * PAGE_SIZE)
-	{
-		Entry->Size += Flink->Size;
-		
-		// remove the 'flink' entry
-		RemoveEntryList(&Flink->ListEntry);
-		ASSERT(Entry->ListEntry.Flink != NULL);
-		ASSERT(Entry->ListEntry.Blink != NULL);
-		ASSERT(Flink->ListEntry.Flink == NULL);
-		ASSERT(Flink->ListEntry.Blink == NULL);
-		
-		MiDeletePoolEntry(Flink);
-	}
+	uintptr_t AlignedAddress = (Entry->Address + Offset + Alignment - 1) & ~(Alignment - 1);
+	size_t LeadingPages = (AlignedAddress - Offset - Entry->Address) / PAGE_SIZE;
+	
+	if (LeadingPages == 0)
+		return MmpSplitEntry(Entry, SizeInPages, Tag, UserData);
+	
+	// Reserve the leading part too, so that the rest of the entry is split off after it,
+	// then give it back.
+	PMIPOOL_ENTRY Leading = MmpSplitEntry(Entry, LeadingPages, MI_EMPTY_TAG, 0);
+	
+	if (!Leading)
+		return NULL;
+	
+	PMIPOOL_ENTRY Result = MmpSplitEntry(MIP_FLINK(&Leading->ListEntry), SizeInPages, Tag, UserData);
+	MmpFreeEntry(Leading);
+	return Result;
 }
 
-void MiFreePoolSpaceSub(MIPOOL_SPACE_HANDLE Handle)
+// Reserves a range whose usable part, after the reserved page, starts on a huge page
+// boundary, so that it can be mapped with huge pages.
+static MIPOOL_SPACE_HANDLE MmpReservePoolSpaceForHugePages(size_t SizeInPages, void** OutputAddress, int Tag, uintptr_t UserData)
 {
 	KIPL OldIpl;
 	KeAcquireSpinLock(&MmpPoolLock, &OldIpl);
+	PMIPOOL_ENTRY Entry = MmpReserveEntryAligned(SizeInPages, MM_HUGE_PAGE_SIZE, PAGE_SIZE, Tag, UserData);
+	KeReleaseSpinLock(&MmpPoolLock, OldIpl);
+	
+	if (!Entry)
+		return (MIPOOL_SPACE_HANDLE) NULL;
 	
+	*OutputAddress = (void*) Entry->Address;
+	return (MIPOOL_SPACE_HANDLE) Entry;
+}
+
+#endif
+
+void MiFreePoolSpaceSub(MIPOOL_SPACE_HANDLE Handle)
+{
 	// Get the handle to the pool entry.
 	PMIPOOL_ENTRY Entry = (PMIPOOL_ENTRY) Handle;
 	ASSERT(!(Handle & 0x7));
 	ASSERT(Handle >= MM_KERNEL_SPACE_BASE);
 	ASSERT(MmGetPoolHeaderAddressPte(MmBuildPoolHeaderPte(Handle)) == Handle);
 	
-	if (~Entry->Flags & MI_POOL_ENTRY_ALLOCATED)
+	if (~Entry->Flags & MI_POOL_ENTRY_ALLOCATED || Entry->Flags & MI_POOL_ENTRY_CACHED)
 	{
 		KeCrash("MiFreePoolSpace: Returned a free entry");
 	}
 	
-	Entry->Flags &= ~MI_POOL_ENTRY_ALLOCATED;
-	Entry->Tag    = MI_EMPTY_TAG;
-	
-	MmpTryConnectEntryWithItsFlink(Entry);
-	if (Entry->ListEntry.Blink != &MmpPoolList)
-		MmpTryConnectEntryWithItsFlink(MIP_BLINK(&Entry->ListEntry));
+	if (MmpFreeToQuantumCache(Entry))
+		return;
 	
+	KIPL OldIpl;
+	KeAcquireSpinLock(&MmpPoolLock, &OldIpl);
+	MmpFreeEntry(Entry);
 	KeReleaseSpinLock(&MmpPoolLock, OldIpl);
 }
 
@@ -429,7 +676,15 @@ MIPOOL_SPACE_HANDLE MiReservePoolSpaceTagged(size_t SizeInPages, void** OutputAd
 	SizeInPages += 1;
 	
 	void* OutputAddressSub;
-	MIPOOL_SPACE_HANDLE Handle = MiReservePoolSpaceTaggedSub(SizeInPages, &OutputAddressSub, Tag, UserData);
+	MIPOOL_SPACE_HANDLE Handle = (MIPOOL_SPACE_HANDLE) NULL;
+	
+#ifdef MM_HUGE_PAGE_SIZE
+	if (SizeInPages > MI_HUGE_PAGE_PAGES)
+		Handle = MmpReservePoolSpaceForHugePages(SizeInPages, &OutputAddressSub, Tag, UserData);
+#endif
+	
+	if (!Handle)
+		Handle = MiReservePoolSpaceTaggedSub(SizeInPages, &OutputAddressSub, Tag, UserData);
 	
 	if (!Handle)
 		return Handle;
@@ -482,7 +737,9 @@ void MiDumpPoolInfo()
 		*((int*)Tag) = Current->Tag;
 		
 		const char* UsedText = "Free";
-		if (Current->Flags & MI_POOL_ENTRY_ALLOCATED)
+		if (Current->Flags & MI_POOL_ENTRY_CACHED)
+			UsedText = "Cach";
+		else if (Current->Flags & MI_POOL_ENTRY_ALLOCATED)
 			UsedText = "Used";
 		
 		DbgPrint("* %p  %s    %s    %p %p   %18zu",
@@ -516,6 +773,11 @@ uintptr_t MiGetUserDataFromPoolSpaceHandle(MIPOOL_SPACE_HANDLE Handle)
 	return ((PMIPOOL_ENTRY)Handle)->UserData;
 }
 
+int MiGetTagFromPoolSpaceHandle(MIPOOL_SPACE_HANDLE Handle)
+{
+	return ((PMIPOOL_ENTRY)Handle)->Tag;
+}
+
 MIPOOL_SPACE_HANDLE MiGetPoolSpaceHandleFromAddress(void* AddressV)
 {
 	uintptr_t Address = (uintptr_t) AddressV;
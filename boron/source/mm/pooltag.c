@@ -0,0 +1,213 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/pooltag.c
+	
+Abstract:
+	This module implements the pool tag statistics, which count
+	the allocations and the bytes in use under each pool tag.
+	
+	The tags are kept in a statistics table (see ke/stattbl.c).
+	The counters of each tag are kept per processor, and only
+	updated by their own processor at IPL_DPC, so recording an
+	allocation or a free takes no atomic operations and touches
+	no shared cache lines once the tag is in the table.  A query
+	sums up the counters of all processors.
+	
+	The per-processor counters are allocated once the processor
+	count is known.  Until then, the counters are recorded into
+	one shared set with atomic operations.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+
+#define MI_POOL_TAG_TABLE_SIZE (256)
+
+// The per-processor counters only ever move by their own processor's allocations and
+// frees, so Bytes may wrap around below zero, and only the sum over all processors
+// is meaningful.  PeakBytes is the highest Bytes has been on that processor.
+typedef struct
+{
+	uint64_t Allocations;
+	uint64_t Frees;
+	uint64_t Bytes;
+	uint64_t PeakBytes;
+}
+MIPOOL_TAG_COUNTERS, *PMIPOOL_TAG_COUNTERS;
+
+typedef struct
+{
+	// Indexed by tag, then by layer, then by whether the pool is non-paged.
+	MIPOOL_TAG_COUNTERS Counters[MI_POOL_TAG_TABLE_SIZE][MI_POOL_LAYER_COUNT][2];
+}
+MIPOOL_TAG_COUNTER_SET, *PMIPOOL_TAG_COUNTER_SET;
+
+// The tags, zero-extended.  Zero if the entry is unused.
+static uintptr_t MmpPoolTagTable[MI_POOL_TAG_TABLE_SIZE];
+
+// The counters recorded before the per-processor counters were allocated.
+static MIPOOL_TAG_COUNTER_SET MmpPoolTagBootCounters;
+
+// One counter set per processor, indexed by the processor's ID.
+static PMIPOOL_TAG_COUNTER_SET MmpPoolTagCounters;
+static int MmpPoolTagCounterSetCount;
+
+static bool MmpGetPoolTagIndex(int Tag, size_t* OutIndex)
+{
+	if (Tag == 0)
+		Tag = MI_UNTAGGED_TAG;
+	
+	bool Claimed;
+	uintptr_t* Entry = KeStatTableLookUp(
+		MmpPoolTagTable,
+		MI_POOL_TAG_TABLE_SIZE,
+		sizeof(uintptr_t),
+		0,
+		(uint32_t) Tag,
+		&Claimed
+	);
+	
+	if (!Entry)
+		return false;
+	
+	*OutIndex = Entry - MmpPoolTagTable;
+	return true;
+}
+
+static void MmpRecordPoolOperation(int Tag, MIPOOL_LAYER Layer, bool NonPaged, bool IsFree, uint64_t Bytes)
+{
+	size_t Index;
+	if (!MmpGetPoolTagIndex(Tag, &Index))
+		return;
+	
+	PMIPOOL_TAG_COUNTER_SET CounterSets = AtLoadMO(MmpPoolTagCounters, ATOMIC_MEMORD_ACQUIRE);
+	if (!CounterSets)
+	{
+		PMIPOOL_TAG_COUNTERS Counters = &MmpPoolTagBootCounters.Counters[Index][Layer][NonPaged];
+		
+		if (IsFree)
+			AtAddFetch(Counters->Frees, 1);
+		else
+			AtAddFetch(Counters->Allocations, 1);
+		
+		// Everything freed before the per-processor counters exist was counted here
+		// when it was allocated, so this never goes below zero.
+		uint64_t InUse = AtAddFetch(Counters->Bytes, Bytes);
+		KeStatUpdateMaximum(&Counters->PeakBytes, InUse);
+		return;
+	}
+	
+	// Stay on this processor while its counters are updated.  Nothing allocates
+	// pool above IPL_DPC, so nothing can interrupt the update with one of its own.
+	KIPL OldIpl = KeRaiseIPLIfNeeded(IPL_DPC);
+	
+	int Id = KeGetCurrentPRCB()->Id;
+	ASSERT(Id < MmpPoolTagCounterSetCount);
+	
+	PMIPOOL_TAG_COUNTERS Counters = &CounterSets[Id].Counters[Index][Layer][NonPaged];
+	
+	// The counters are read by queries on other processors, so they're written with
+	// atomic stores, but they don't need an atomic read-modify-write.
+	if (IsFree)
+		AtStoreMO(Counters->Frees, Counters->Frees + 1, ATOMIC_MEMORD_RELAXED);
+	else
+		AtStoreMO(Counters->Allocations, Counters->Allocations + 1, ATOMIC_MEMORD_RELAXED);
+	
+	uint64_t InUse = Counters->Bytes + Bytes;
+	AtStoreMO(Counters->Bytes, InUse, ATOMIC_MEMORD_RELAXED);
+	
+	if ((int64_t) InUse > (int64_t) Counters->PeakBytes)
+		AtStoreMO(Counters->PeakBytes, InUse, ATOMIC_MEMORD_RELAXED);
+	
+	KeLowerIPL(OldIpl);
+}
+
+void MiRecordPoolAllocation(int Tag, MIPOOL_LAYER Layer, bool NonPaged, size_t Bytes)
+{
+	MmpRecordPoolOperation(Tag, Layer, NonPaged, false, Bytes);
+}
+
+void MiRecordPoolFree(int Tag, MIPOOL_LAYER Layer, bool NonPaged, size_t Bytes)
+{
+	MmpRecordPoolOperation(Tag, Layer, NonPaged, true, -(uint64_t) Bytes);
+}
+
+void MiInitializePoolTagCounters()
+{
+	int Count = KeGetProcessorCount();
+	
+	// Allocations made while this is being allocated are still recorded in the boot
+	// counters, so this memory shows up under its own tag too.
+	PMIPOOL_TAG_COUNTER_SET CounterSets = MmAllocatePoolWithTag(
+		POOL_NONPAGED,
+		sizeof(MIPOOL_TAG_COUNTER_SET) * Count,
+		MI_TAG("MmPt")
+	);
+	
+	if (!CounterSets)
+	{
+		DbgPrint("WARNING: Could not allocate per-processor pool tag counters.");
+		return;
+	}
+	
+	memset(CounterSets, 0, sizeof(MIPOOL_TAG_COUNTER_SET) * Count);
+	
+	MmpPoolTagCounterSetCount = Count;
+	AtStoreMO(MmpPoolTagCounters, CounterSets, ATOMIC_MEMORD_RELEASE);
+}
+
+static void MmpAddPoolCounters(PSYSTEM_POOL_COUNTERS Output, PMIPOOL_TAG_COUNTERS Counters)
+{
+	Output->Allocations += AtLoadMO(Counters->Allocations, ATOMIC_MEMORD_RELAXED);
+	Output->Frees       += AtLoadMO(Counters->Frees,       ATOMIC_MEMORD_RELAXED);
+	Output->Bytes       += AtLoadMO(Counters->Bytes,       ATOMIC_MEMORD_RELAXED);
+	Output->PeakBytes   += AtLoadMO(Counters->PeakBytes,   ATOMIC_MEMORD_RELAXED);
+}
+
+static void MmpAddPoolCounterSet(PSYSTEM_POOL_TAG_INFORMATION TagInfo, PMIPOOL_TAG_COUNTER_SET CounterSet, size_t Index)
+{
+	MmpAddPoolCounters(&TagInfo->BigNonPaged,  &CounterSet->Counters[Index][MI_POOL_LAYER_BIG][true]);
+	MmpAddPoolCounters(&TagInfo->BigPaged,     &CounterSet->Counters[Index][MI_POOL_LAYER_BIG][false]);
+	MmpAddPoolCounters(&TagInfo->SlabNonPaged, &CounterSet->Counters[Index][MI_POOL_LAYER_SLAB][true]);
+	MmpAddPoolCounters(&TagInfo->SlabPaged,    &CounterSet->Counters[Index][MI_POOL_LAYER_SLAB][false]);
+}
+
+BSTATUS MmQueryPoolTagInformation(void* Buffer, size_t BufferSize, size_t* WrittenBufferSize)
+{
+	PSYSTEM_POOL_TAG_INFORMATION TagInfo = Buffer;
+	size_t Written = 0;
+	
+	PMIPOOL_TAG_COUNTER_SET CounterSets = AtLoadMO(MmpPoolTagCounters, ATOMIC_MEMORD_ACQUIRE);
+	
+	for (size_t i = 0; i < MI_POOL_TAG_TABLE_SIZE; i++)
+	{
+		uint32_t Tag = (uint32_t) AtLoad(MmpPoolTagTable[i]);
+		if (!Tag)
+			continue;
+		
+		if (Written + sizeof(*TagInfo) > BufferSize)
+			break;
+		
+		memset(TagInfo, 0, sizeof(*TagInfo));
+		TagInfo->Size = sizeof(*TagInfo);
+		memcpy(TagInfo->Tag, &Tag, sizeof TagInfo->Tag);
+		
+		MmpAddPoolCounterSet(TagInfo, &MmpPoolTagBootCounters, i);
+		
+		if (CounterSets)
+		{
+			for (int Id = 0; Id < MmpPoolTagCounterSetCount; Id++)
+				MmpAddPoolCounterSet(TagInfo, &CounterSets[Id], i);
+		}
+		
+		Written += sizeof(*TagInfo);
+		TagInfo = NEXT_SYSTEM_INFORMATION(TagInfo);
+	}
+	
+	*WrittenBufferSize = Written;
+	return STATUS_SUCCESS;
+}
@@ -11,42 +11,19 @@ Abstract:
 	The section object represents a section of memory, either backed
 	by a file, or backed by virtual memory and page files.
 	
+	Pages of an anonymous section which aren't mapped anywhere may be
+	moved into the compressed page store or the page file by the
+	working set manager.  See mm/anonpage.c.
+	
 Author:
 	iProgramInCpp - 7 December 2025
 ***/
 #include "mi.h"
 #include <ex.h>
 
-typedef union
-{
-	struct
-	{
-		MMPFN Pfn : 32;
-	}
-	PACKED
-	Data;
-	
-	MMSLA_ENTRY Entry;
-}
-MMSECTION_SLA_ENTRY, *PMMSECTION_SLA_ENTRY;
-
-static void MmpFreeEntrySectionObject(MMSLA_ENTRY Entry)
-{
-	MMSECTION_SLA_ENTRY SectionEntry;
-	SectionEntry.Entry = Entry;
-	
-	MMPFN Pfn = SectionEntry.Data.Pfn;
-	if (Pfn != PFN_INVALID)
-		MmFreePhysicalPage(Pfn);
-}
-
 BSTATUS MiAssignEntrySection(PMMSECTION Section, uint64_t SectionOffset, MMPFN Pfn)
 {
-	MMSECTION_SLA_ENTRY SlaEntry;
-	SlaEntry.Entry = 0;
-	SlaEntry.Data.Pfn = Pfn;
-	
-	MMSLA_ENTRY NewEntry = MmAssignEntrySla(&Section->Sla, SectionOffset, SlaEntry.Entry);
+	MMSLA_ENTRY NewEntry = MmAssignEntrySla(&Section->Sla, SectionOffset, MiMakeResidentEntryAnonymous(Pfn));
 	if (NewEntry == MM_SLA_OUT_OF_MEMORY)
 		return STATUS_INSUFFICIENT_MEMORY;
 	
@@ -55,54 +32,55 @@ BSTATUS MiAssignEntrySection(PMMSECTION Section, uint64_t SectionOffset, MMPFN P
 	return STATUS_SUCCESS;
 }
 
-static BSTATUS MmpGetPageSection(void* MappableObject, uint64_t SectionOffset, PMMPFN OutPfn)
+static BSTATUS MmpGetPageSectionEx(PMMSECTION Section, uint64_t SectionOffset, PMMPFN OutPfn, bool BringIn)
 {
-	PMMSECTION Section = MappableObject;
-	
 	BSTATUS Status = KeWaitForSingleObject(&Section->Mutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
 	ASSERT(SUCCEEDED(Status));
 	
-	// N.B. Unlike page caches, we don't need to worry about anything modifying the list while
-	// it's locked with a mutex.
-	MMSECTION_SLA_ENTRY SlaEntry;
-	SlaEntry.Entry = MmLookUpEntrySla(&Section->Sla, SectionOffset);
-	if (SlaEntry.Entry == MM_SLA_NO_DATA)
+	MMPFN Pfn = PFN_INVALID;
+	Status = MiGetPageAnonymous(&Section->Mutex, &Section->Sla, SectionOffset, &Pfn, BringIn);
+	if (FAILED(Status) || Pfn != PFN_INVALID)
+	{
+		KeReleaseMutex(&Section->Mutex);
+		*OutPfn = Pfn;
+		return Status;
+	}
+	
+	// This page was never touched, so give it a new page.
+	Pfn = MmAllocatePhysicalPage();
+	if (Pfn == PFN_INVALID)
 	{
-		MMPFN Pfn = MmAllocatePhysicalPage();
-		if (Pfn == PFN_INVALID)
-		{
-			KeReleaseMutex(&Section->Mutex);
-			return STATUS_INSUFFICIENT_MEMORY;
-		}
-		
-		SlaEntry.Entry = 0;
-		SlaEntry.Data.Pfn = Pfn;
-		
-		MMSLA_ENTRY NewEntry = MmAssignEntrySla(&Section->Sla, SectionOffset, SlaEntry.Entry);
-		if (NewEntry == MM_SLA_OUT_OF_MEMORY)
-		{
-			MmFreePhysicalPage(Pfn);
-			KeReleaseMutex(&Section->Mutex);
-			return STATUS_INSUFFICIENT_MEMORY;
-		}
-		
-		ASSERT(NewEntry == SlaEntry.Entry);
+		KeReleaseMutex(&Section->Mutex);
+		return STATUS_INSUFFICIENT_MEMORY;
 	}
 	
-	MmPageAddReference(SlaEntry.Data.Pfn);
+	MMSLA_ENTRY SlaEntry = MiMakeResidentEntryAnonymous(Pfn);
+	MMSLA_ENTRY NewEntry = MmAssignEntrySla(&Section->Sla, SectionOffset, SlaEntry);
+	if (NewEntry == MM_SLA_OUT_OF_MEMORY)
+	{
+		MmFreePhysicalPage(Pfn);
+		KeReleaseMutex(&Section->Mutex);
+		return STATUS_INSUFFICIENT_MEMORY;
+	}
+	
+	ASSERT(NewEntry == SlaEntry);
+	
+	MmPageAddReference(Pfn);
 	KeReleaseMutex(&Section->Mutex);
-	*OutPfn = SlaEntry.Data.Pfn;
+	*OutPfn = Pfn;
 	return STATUS_SUCCESS;
 }
 
+static BSTATUS MmpGetPageSection(void* MappableObject, uint64_t SectionOffset, PMMPFN OutPfn)
+{
+	return MmpGetPageSectionEx(MappableObject, SectionOffset, OutPfn, false);
+}
+
 static BSTATUS MmpReadPageSection(void* MappableObject, uint64_t SectionOffset, PMMPFN OutPfn)
 {
-	(void) MappableObject;
-	(void) SectionOffset;
-	(void) OutPfn;
-	
-	// There is nothing to page in. (for now!)
-	return STATUS_HARDWARE_IO_ERROR;
+	// The page might have been brought back in by someone else in the meantime, in
+	// which case it's simply returned.
+	return MmpGetPageSectionEx(MappableObject, SectionOffset, OutPfn, true);
 }
 
 static BSTATUS MmpPrepareWriteSection(void* MappableObject, uint64_t SectionOffset)
@@ -135,7 +113,10 @@ static MAPPABLE_DISPATCH_TABLE MmpSectionObjectMappableDispatch =
 void MmDeleteSectionObject(UNUSED void* ObjectV)
 {
 	PMMSECTION Section = ObjectV;
-	MmDeinitializeSla(&Section->Sla, MmpFreeEntrySectionObject);
+	MmDeinitializeSla(&Section->Sla, MiFreeEntryAnonymous);
+	
+	if (Section->ImageFile)
+		ObDereferenceObject(Section->ImageFile);
 }
 
 void MmInitializeSectionObject(PMMSECTION Section)
@@ -144,6 +125,7 @@ void MmInitializeSectionObject(PMMSECTION Section)
 	KeInitializeMutex(&Section->Mutex, 4);
 	MmInitializeSla(&Section->Sla);
 	Section->MaxSizePages = 0;
+	Section->ImageFile = NULL;
 }
 
 typedef struct
@@ -72,9 +72,8 @@ static void MmpFreeSlaIntermediateLevel(MMPFN Pfn, int LevelNumber, MM_SLA_FREE_
 		if (Entry != PFN_INVALID)
 		{
 			MmpFreeSlaIntermediateLevel(Entry, LevelNumber - 1, FreeEntryFunc);
+			MmFreePhysicalPage(Entry);
 		}
-		
-		MmFreePhysicalPage(Entry);
 	}
 }
 
@@ -87,8 +86,14 @@ void MmDeinitializeSla(PMMSLA Sla, MM_SLA_FREE_ENTRY_FUNC FreeEntryFunc)
 	
 	for (int i = 0; i < MM_SLA_INDIRECT_LEVELS; i++)
 	{
+		if (Sla->Indirect[i] == PFN_INVALID)
+			continue;
+		
 		MmpFreeSlaIntermediateLevel(Sla->Indirect[i], i, FreeEntryFunc);
+		MmFreePhysicalPage(Sla->Indirect[i]);
 	}
+	
+	MmInitializeSla(Sla);
 }
 
 static MMPFN MmpAllocatePhysicalPageSlaInitialized()
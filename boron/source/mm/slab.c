@@ -43,6 +43,9 @@ static const int MiSlabSizes[] =
 
 static MISLAB_CONTAINER MiSlabContainer[2][MISLAB_SIZE_COUNT];
 
+// Containers for allocations which start with a MISLAB_TAG_HEADER.
+static MISLAB_CONTAINER MiTaggedSlabContainer[2][MISLAB_SIZE_COUNT];
+
 // This tree is used when a slab item larger than a page size is allocated.
 //
 // TODO: There is probably going to be a ton of contention on this lock, we need something better.
@@ -91,10 +94,11 @@ static bool MmpRemoveSlabItemFromTree(PMISLAB_ITEM SlabItem)
 }
 
 INIT
-static void MmpInitSlabContainer(PMISLAB_CONTAINER Container, int Size, bool NonPaged)
+static void MmpInitSlabContainer(PMISLAB_CONTAINER Container, int Size, bool NonPaged, bool Tagged)
 {
 	Container->ItemSize = Size;
 	Container->NonPaged = NonPaged;
+	Container->Tagged   = Tagged;
 	Container->Lock.Locked = false;
 	InitializeListHead(&Container->ListHead);
 }
@@ -104,8 +108,10 @@ void MiInitSlabs()
 {
 	for (int i = 0; i < MISLAB_SIZE_COUNT; i++)
 	{
-		MmpInitSlabContainer(&MiSlabContainer[0][i], MiSlabSizes[i], false);
-		MmpInitSlabContainer(&MiSlabContainer[1][i], MiSlabSizes[i], true);
+		MmpInitSlabContainer(&MiSlabContainer[0][i], MiSlabSizes[i], false, false);
+		MmpInitSlabContainer(&MiSlabContainer[1][i], MiSlabSizes[i], true, false);
+		MmpInitSlabContainer(&MiTaggedSlabContainer[0][i], MiSlabSizes[i], false, true);
+		MmpInitSlabContainer(&MiTaggedSlabContainer[1][i], MiSlabSizes[i], true, true);
 	}
 }
 
@@ -287,14 +293,14 @@ void MmpSlabContainerFree(PMISLAB_CONTAINER Container, PMISLAB_ITEM Item, void*
 		MmFreePoolBig(MemoryToFreeBig);
 }
 
-void* MmpAllocateHuge(bool IsNonPaged, size_t Size)
+void* MmpAllocateHuge(bool IsNonPaged, size_t Size, int Tag)
 {	
 	size_t PageCount = (Size + sizeof(HUGE_MEMORY_BLOCK) + PAGE_SIZE - 1) / PAGE_SIZE;
 	
 	void* Addr = MmAllocatePoolBig(
 		IsNonPaged ? POOL_FLAG_NON_PAGED : 0,
 		PageCount,
-		POOL_TAG("BHUG")
+		Tag
 	);
 	
 	if (!Addr)
@@ -316,16 +322,48 @@ void MmpFreeHuge(PHUGE_MEMORY_BLOCK Hmb)
 	MmFreePoolBig(Hmb);
 }
 
-void* MiSlabAllocate(bool IsNonPaged, size_t Size)
+static void* MmpSlabAllocate(bool IsNonPaged, size_t Size, bool Tagged, int Tag)
 {
-	int Index = MmGetSmallestSlabSizeThatFitsSize(Size);
+	size_t ItemSize = Size;
+	if (Tagged)
+		ItemSize += sizeof(MISLAB_TAG_HEADER);
+	
+	int Index = MmGetSmallestSlabSizeThatFitsSize(ItemSize);
 	
 	if (Index >= MISLAB_SIZE_COUNT)
 	{
-		return MmpAllocateHuge(IsNonPaged, Size);
+		// Huge blocks are counted by the big pool, under the tag they're allocated with.
+		return MmpAllocateHuge(IsNonPaged, Size, Tagged ? Tag : POOL_TAG("BHUG"));
 	}
 	
-	return MmpSlabContainerAllocate(&MiSlabContainer[IsNonPaged][Index]);
+	PMISLAB_CONTAINER Container;
+	if (Tagged)
+		Container = &MiTaggedSlabContainer[IsNonPaged][Index];
+	else
+		Container = &MiSlabContainer[IsNonPaged][Index];
+	
+	void* Memory = MmpSlabContainerAllocate(Container);
+	if (!Memory)
+		return NULL;
+	
+	MiRecordPoolAllocation(Tag, MI_POOL_LAYER_SLAB, IsNonPaged, Container->ItemSize);
+	
+	if (!Tagged)
+		return Memory;
+	
+	PMISLAB_TAG_HEADER Header = Memory;
+	Header->Tag = Tag;
+	return Header + 1;
+}
+
+void* MiSlabAllocate(bool IsNonPaged, size_t Size)
+{
+	return MmpSlabAllocate(IsNonPaged, Size, false, 0);
+}
+
+void* MiSlabAllocateTagged(bool IsNonPaged, size_t Size, int Tag)
+{
+	return MmpSlabAllocate(IsNonPaged, Size, true, Tag);
 }
 
 void MiSlabFree(void* Ptr)
@@ -386,5 +424,16 @@ StandardHandling:
 	}
 	ASSERT(Item->Check == MI_SLAB_ITEM_CHECK);
 	
-	MmpSlabContainerFree(Item->Parent, Item, Ptr);
+	PMISLAB_CONTAINER Container = Item->Parent;
+	int Tag = 0;
+	
+	if (Container->Tagged)
+	{
+		PMISLAB_TAG_HEADER Header = (PMISLAB_TAG_HEADER) Ptr - 1;
+		Tag = Header->Tag;
+		Ptr = Header;
+	}
+	
+	MmpSlabContainerFree(Container, Item, Ptr);
+	MiRecordPoolFree(Tag, MI_POOL_LAYER_SLAB, Container->NonPaged, Container->ItemSize);
 }
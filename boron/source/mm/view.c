@@ -95,6 +95,48 @@ BSTATUS MmpMapViewOfFile(
 	return MmpMapViewOfObject(FileObject, BaseAddressInOut, ViewSize, AllocationType, SectionOffset, Protection);
 }
 
+// Same as MmMapViewOfObject, but takes a referenced file or section object
+// instead of a handle.  The parameters have been validated by the caller.
+BSTATUS MmMapViewOfObjectPointer(
+	void* MappableObject,
+	void** BaseAddressInOut,
+	size_t ViewSize,
+	int AllocationType,
+	uint64_t SectionOffset,
+	int Protection
+)
+{
+	if (ObGetObjectType(MappableObject) == IoFileType)
+	{
+		return MmpMapViewOfFile(
+			MappableObject,
+			BaseAddressInOut,
+			ViewSize,
+			AllocationType,
+			SectionOffset,
+			Protection
+		);
+	}
+	
+	if (ObGetObjectType(MappableObject) != MmSectionObjectType)
+		return STATUS_TYPE_MISMATCH;
+	
+	// Image sections are mapped by every process that loads the image, so writes
+	// must go to a private copy.
+	if (((PMMSECTION) MappableObject)->ImageFile &&
+		(Protection & PAGE_WRITE) && !(AllocationType & MEM_COW))
+		return STATUS_INVALID_PARAMETER;
+	
+	return MmpMapViewOfObject(
+		MappableObject,
+		BaseAddressInOut,
+		ViewSize,
+		AllocationType,
+		SectionOffset,
+		Protection
+	);
+}
+
 //
 // Maps a view of either a file or a section.  The type will be checked inside.
 // The only supported types of object are MmSectionType and IoFileType.
@@ -138,25 +180,13 @@ BSTATUS MmMapViewOfObject(
 	void* MappableObject = NULL;
 	
 	Status = ObReferenceObjectByHandle(MappedObject, IoFileType, &MappableObject);
-	if (SUCCEEDED(Status))
-	{
-		// You cannot map files that are not seekable.
-		PFILE_OBJECT FileObject = MappableObject;
-		if (!IoIsSeekable(FileObject->Fcb))
-		{
-			ObDereferenceObject(FileObject);
-			return STATUS_UNSUPPORTED_FUNCTION;
-		}
-	}
-	else if (Status == STATUS_TYPE_MISMATCH)
-	{
+	if (Status == STATUS_TYPE_MISMATCH)
 		Status = ObReferenceObjectByHandle(MappedObject, MmSectionObjectType, &MappableObject);
-	}
 	
 	if (FAILED(Status))
 		return Status;
 	
-	Status = MmpMapViewOfObject(
+	Status = MmMapViewOfObjectPointer(
 		MappableObject,
 		BaseAddressInOut,
 		ViewSize,
@@ -204,6 +234,10 @@ BSTATUS OSGetMappedFileHandle(
 	if (FAILED(Status))
 		goto ReturnEarlyUnlockDetach;
 	
+	// Images mapped from the image section cache are still backed by their file.
+	if (ObGetObjectType(FileObject) == MmSectionObjectType && ((PMMSECTION) FileObject)->ImageFile)
+		FileObject = ((PMMSECTION) FileObject)->ImageFile;
+	
 	if (ObGetObjectType(FileObject) != IoFileType)
 	{
 		DbgPrint("Type mismatch in OSGetMappedFileHandle(%p)!", Address);
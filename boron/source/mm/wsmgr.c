@@ -0,0 +1,452 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	mm/wsmgr.c
+	
+Abstract:
+	This module implements the working set manager.
+	
+	Once every second, or sooner if free memory runs low, the
+	working set manager walks the resident pages of each process.
+	It uses the accessed bits of their PTEs to age them, and, while
+	free memory is low, it trims the pages that weren't accessed in
+	a while.  Trimmed pages go on the standby list, or on the
+	modified page list if they were written to.
+	
+	Pages of anonymous sections and CoW overlays are compressed, or
+	written to the page file, once no process has them mapped
+	anymore.  Private anonymous memory is not trimmed, because it
+	has nowhere to be written to.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "mi.h"
+
+// How often the working sets are aged, if nothing wakes the working set manager earlier.
+#define MI_WS_SCAN_INTERVAL_MS (1000)
+
+// The maximum number of processes scanned in one pass.  The rest are scanned in the next pass.
+#define MI_WS_MAX_PROCESSES (64)
+
+// The number of PTEs looked at with the PFDB lock held at once.
+#define MI_WS_BATCH_SIZE (64)
+
+// The number of scans in a row which must find a page not accessed, before it may be trimmed.
+#define MI_WS_TRIM_AGE (2)
+
+// The highest age a page can have.  This is the largest value the Age field can hold.
+#define MI_WS_MAX_AGE (7)
+
+// The lowest that the low watermark can be, in pages.
+#define MI_WS_MIN_LOW_WATERMARK (128)
+
+// The amount of virtual memory described by one page of PTEs.
+#define MMP_PAGE_TABLE_SPAN (PAGE_SIZE * PAGE_SIZE / sizeof(MMPTE))
+
+typedef struct
+{
+	PEPROCESS Processes[MI_WS_MAX_PROCESSES];
+	size_t Count;
+	
+	// The position in the process list.  Processes before StartIndex were scanned
+	// in the previous pass.
+	size_t Index;
+	size_t StartIndex;
+	size_t NextIndex;
+}
+MIWS_PROCESS_LIST, *PMIWS_PROCESS_LIST;
+
+typedef struct
+{
+	// Whether pages may be trimmed.  Cleared once enough memory is free again.
+	bool Trim;
+	
+	size_t ResidentPages;
+	size_t AccessedPages;
+	size_t TrimmedPages;
+	
+	// The anonymous section or CoW overlay mapped by the VAD being scanned, if any.
+	void* AnonymousObject;
+}
+MIWS_SCAN, *PMIWS_SCAN;
+
+typedef struct
+{
+	PMMPTE Pte;
+	MMPTE PteCopy;
+	bool Accessed;
+	bool Trim;
+	
+	// The page belongs to the page cache, rather than to the anonymous object.
+	bool FileCache;
+}
+MIWS_BATCH_ENTRY, *PMIWS_BATCH_ENTRY;
+
+size_t MiWorkingSetLowWatermark;
+
+static size_t MmpWorkingSetHighWatermark;
+static KEVENT MmpWorkingSetEvent;
+static bool   MmpWorkingSetWakePending;
+static size_t MmpWorkingSetNextProcess;
+
+void MiWakeWorkingSetManager()
+{
+	// The dispatcher lock can't be acquired above IPL_DPC.  The working set manager
+	// will notice that memory is low on its next pass anyway.
+	if (KeGetIPL() > IPL_DPC)
+		return;
+	
+	// Only signal the event once per pass.
+	if (AtTestAndSet(MmpWorkingSetWakePending))
+		return;
+	
+	KeSetEvent(&MmpWorkingSetEvent, 0);
+}
+
+static void MmpCollectProcess(PEPROCESS Process, void* Context)
+{
+	PMIWS_PROCESS_LIST List = Context;
+	size_t Index = List->Index++;
+	
+	if (Index < List->StartIndex || List->Count >= MI_WS_MAX_PROCESSES)
+		return;
+	
+	// The system process' address space is managed separately.  Processes without
+	// threads are either still being set up, or are exiting.
+	if (Process == &PsSystemProcess || IsListEmpty(&Process->Pcb.ThreadList))
+		return;
+	
+	if (!ObReferenceObjectSafe(Process))
+		return;
+	
+	List->Processes[List->Count++] = Process;
+	List->NextIndex = Index + 1;
+}
+
+// Ages up to MI_WS_BATCH_SIZE PTEs from the same page table, and trims the cold ones
+// if requested.  The address space lock and the VAD list lock are held.
+//
+// Returns true if any accessed bits were cleared.
+static bool MmpScanPtes(PMIWS_SCAN Scan, PMMVAD Vad, uintptr_t StartVa, size_t Count)
+{
+	MIWS_BATCH_ENTRY Batch[MI_WS_BATCH_SIZE];
+	size_t BatchCount = 0;
+	bool ClearedAccessed = false;
+	
+	ASSERT(Count <= MI_WS_BATCH_SIZE);
+	
+	// Find the resident pages and clear their accessed bits.
+	PMMPTE Pte = MmGetPteLocation(StartVa);
+	for (size_t i = 0; i < Count; i++)
+	{
+		MMPTE PteCopy = Pte[i];
+		if (!MmIsPresentPte(PteCopy) || !MmIsFromPmmPte(PteCopy))
+			continue;
+		
+		uintptr_t PageBits = MmGetPageBitsPte(PteCopy);
+		bool Accessed = PageBits & MM_MISC_ACCESSED;
+		
+		if (Accessed)
+		{
+			// If this fails, the processor set the dirty bit in the meantime.  The page
+			// is in use anyway, so just try again next time.
+			MMPTE NewPte = MmSetPageBitsPte(PteCopy, PageBits & ~MM_MISC_ACCESSED);
+			if (AtCompareExchange(&MmHardwarePte(Pte[i]), &MmHardwarePte(PteCopy), MmHardwarePte(NewPte)))
+			{
+				PteCopy = NewPte;
+				ClearedAccessed = true;
+			}
+			
+			Scan->AccessedPages++;
+		}
+		
+		Batch[BatchCount].Pte = &Pte[i];
+		Batch[BatchCount].PteCopy = PteCopy;
+		Batch[BatchCount].Accessed = Accessed;
+		Batch[BatchCount].Trim = false;
+		Batch[BatchCount].FileCache = false;
+		BatchCount++;
+	}
+	
+	Scan->ResidentPages += BatchCount;
+	
+	if (BatchCount == 0)
+		return ClearedAccessed;
+	
+	// Only pages of the page cache, of anonymous sections, and of CoW overlays can be
+	// trimmed.  They can be brought back from the page cache, the file they belong to,
+	// or the object, which keeps its own reference to them.
+	bool CanTrim = Scan->Trim && Vad->MappedObject;
+	bool AnyTrimCandidates = false;
+	
+	// Age the pages.  Pages that were accessed become young again.
+	KIPL Ipl = MiLockPfdb();
+	
+	for (size_t i = 0; i < BatchCount; i++)
+	{
+		PMMPFDBE Pfdbe = MmGetPageFrameFromPFN(MmGetPfnPte(Batch[i].PteCopy));
+		
+		if (Batch[i].Accessed)
+		{
+			Pfdbe->Age = 0;
+			continue;
+		}
+		
+		if (Pfdbe->Age < MI_WS_MAX_AGE)
+			Pfdbe->Age++;
+		
+		Batch[i].FileCache = Pfdbe->FileCache._PrototypePte;
+		
+		if (CanTrim &&
+			Pfdbe->Age >= MI_WS_TRIM_AGE &&
+			Pfdbe->Type == PF_TYPE_USED &&
+			(Batch[i].FileCache || Scan->AnonymousObject))
+		{
+			Batch[i].Trim = true;
+			AnyTrimCandidates = true;
+		}
+	}
+	
+	MiUnlockPfdb(Ipl);
+	
+	if (!AnyTrimCandidates)
+		return ClearedAccessed;
+	
+	// Unmap the cold pages.  If a PTE changed in the meantime, then the page was
+	// accessed, so leave it alone.
+	//
+	// If the VAD isn't committed as a whole, the PTE must stay committed so that
+	// the page can be faulted back in.
+	MMPTE TrimmedPte = Vad->Flags.Committed ? MmBuildZeroPte() : MmBuildAbsentPte(MM_PAGE_COMMITTED);
+	size_t TrimmedPages = 0;
+	
+	for (size_t i = 0; i < BatchCount; i++)
+	{
+		if (!Batch[i].Trim)
+			continue;
+		
+		if (!AtCompareExchange(&MmHardwarePte(*Batch[i].Pte), &MmHardwarePte(Batch[i].PteCopy), MmHardwarePte(TrimmedPte)))
+		{
+			Batch[i].Trim = false;
+			continue;
+		}
+		
+		TrimmedPages++;
+	}
+	
+	if (TrimmedPages == 0)
+		return ClearedAccessed;
+	
+	// The pages may only be let go of once no processor can access them anymore.
+	// This also flushes the cleared accessed bits.
+	MmIssueTLBShootDown(StartVa, Count);
+	
+	for (size_t i = 0; i < BatchCount; i++)
+	{
+		if (!Batch[i].Trim)
+			continue;
+		
+		MMPFN Pfn = MmGetPfnPte(Batch[i].PteCopy);
+		
+		if (!Batch[i].FileCache)
+		{
+			// The object still holds the page.  If this was the last mapping of it,
+			// the page can be moved out of memory.
+			uintptr_t Va = StartVa + (Batch[i].Pte - Pte) * PAGE_SIZE;
+			uint64_t SectionOffset = (Va - Vad->Node.StartVa + Vad->SectionOffset) / PAGE_SIZE;
+			
+			MmFreePhysicalPage(Pfn);
+			MiTrimPageAnonymous(Scan->AnonymousObject, SectionOffset, Pfn);
+			continue;
+		}
+		
+		// If the page was written to through a stale TLB entry, the dirty bit was
+		// already set in the PTE when it was captured, so nothing is lost here.
+		if (MmIsModifiedPte(Batch[i].PteCopy))
+			MmSetModifiedPage(Pfn);
+		
+		MmFreePhysicalPage(Pfn);
+	}
+	
+	Scan->ResidentPages -= TrimmedPages;
+	Scan->TrimmedPages += TrimmedPages;
+	
+	if (MmGetTotalFreePages() >= MmpWorkingSetHighWatermark)
+		Scan->Trim = false;
+	
+	// The accessed bits were flushed along with the trimmed pages.
+	return false;
+}
+
+static void MmpScanVad(PMIWS_SCAN Scan, PMMVAD Vad)
+{
+	uintptr_t Va = Vad->Node.StartVa;
+	uintptr_t EndVa = Va + Vad->Node.Size * PAGE_SIZE;
+	uintptr_t FlushStartVa = 0, FlushEndVa = 0;
+	
+	Scan->AnonymousObject = NULL;
+	if (Vad->MappedObject)
+	{
+		POBJECT_TYPE Type = ObGetObjectType(Vad->MappedObject);
+		if (Type == MmSectionObjectType || Type == MmOverlayObjectType)
+			Scan->AnonymousObject = Vad->MappedObject;
+	}
+	
+	while (Va < EndVa)
+	{
+	#ifdef MM_HUGE_PAGE_SIZE
+		// Huge pages are never trimmed, so they're only counted.  They're checked
+		// for first, so that MiCheckPteLocationOrSkip doesn't split them.
+		if (MiGetHugePteLocation(Va))
+		{
+			Scan->ResidentPages += MI_HUGE_PAGE_PAGES;
+			Va = (Va + MM_HUGE_PAGE_SIZE) & ~(MM_HUGE_PAGE_SIZE - 1);
+			continue;
+		}
+	#endif
+		
+		uintptr_t SkipTo = 0;
+		if (!MiCheckPteLocationOrSkip(Va, &SkipTo))
+		{
+			// Check for wraparound at the top of the address space.
+			if (SkipTo <= Va)
+				break;
+			
+			Va = SkipTo;
+			continue;
+		}
+		
+		uintptr_t RunEnd = (Va + MMP_PAGE_TABLE_SPAN) & ~(MMP_PAGE_TABLE_SPAN - 1);
+		if (RunEnd > EndVa || RunEnd < Va)
+			RunEnd = EndVa;
+		
+		while (Va < RunEnd)
+		{
+			size_t Count = (RunEnd - Va) / PAGE_SIZE;
+			if (Count > MI_WS_BATCH_SIZE)
+				Count = MI_WS_BATCH_SIZE;
+			
+			if (MmpScanPtes(Scan, Vad, Va, Count))
+			{
+				if (FlushStartVa == FlushEndVa)
+					FlushStartVa = Va;
+				
+				FlushEndVa = Va + Count * PAGE_SIZE;
+			}
+			
+			Va += Count * PAGE_SIZE;
+		}
+	}
+	
+	// The processors must forget the cleared accessed bits, otherwise they won't
+	// be set again on the next access.
+	if (FlushStartVa != FlushEndVa)
+		MmIssueTLBShootDown(FlushStartVa, (FlushEndVa - FlushStartVa) / PAGE_SIZE);
+}
+
+static void MmpScanProcess(PEPROCESS Process, bool* Trim)
+{
+	MIWS_SCAN Scan;
+	memset(&Scan, 0, sizeof Scan);
+	Scan.Trim = *Trim;
+	
+	PEPROCESS OldProcess = PsSetAttachedProcess(Process);
+	KIPL Ipl = MmLockSpaceExclusive(0);
+	
+	PMMVAD_LIST VadList = MmLockVadListProcess(Process);
+	
+	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&VadList->Tree);
+		Entry != NULL;
+		Entry = GetNextEntryRbTree(Entry))
+	{
+		PMMVAD Vad = CONTAINING_RECORD(Entry, MMVAD, Node.Entry);
+		MmpScanVad(&Scan, Vad);
+	}
+	
+	MmUnlockVadList(VadList);
+	
+	PMMWORKING_SET WorkingSet = &Process->WorkingSet;
+	WorkingSet->ResidentPages = Scan.ResidentPages;
+	WorkingSet->AccessedPages = Scan.AccessedPages;
+	WorkingSet->TrimmedPages += Scan.TrimmedPages;
+	
+	if (WorkingSet->PeakResidentPages < Scan.ResidentPages)
+		WorkingSet->PeakResidentPages = Scan.ResidentPages;
+	
+	MmUnlockSpace(Ipl, 0);
+	PsSetAttachedProcess(OldProcess);
+	
+	*Trim = Scan.Trim;
+}
+
+NO_RETURN
+static void MmpWorkingSetManager(UNUSED void* Context)
+{
+	MIWS_PROCESS_LIST List;
+	
+	while (true)
+	{
+		KeWaitForSingleObject(&MmpWorkingSetEvent, false, MI_WS_SCAN_INTERVAL_MS, MODE_KERNEL);
+		AtClear(MmpWorkingSetWakePending);
+		
+		// Start trimming once free memory drops below the low watermark, and keep
+		// going until it's back above the high watermark.
+		bool Trim = MmGetTotalFreePages() < MiWorkingSetLowWatermark;
+		
+		List.Count = 0;
+		List.Index = 0;
+		List.StartIndex = MmpWorkingSetNextProcess;
+		List.NextIndex = 0;
+		
+		PsEnumerateProcesses(MmpCollectProcess, &List);
+		
+		// If there were too many processes, continue where this pass left off.
+		if (List.Count == MI_WS_MAX_PROCESSES)
+			MmpWorkingSetNextProcess = List.NextIndex;
+		else
+			MmpWorkingSetNextProcess = 0;
+		
+		for (size_t i = 0; i < List.Count; i++)
+		{
+			MmpScanProcess(List.Processes[i], &Trim);
+			ObDereferenceObject(List.Processes[i]);
+		}
+	}
+}
+
+INIT
+void MmInitializeWorkingSetManager()
+{
+	KeInitializeEvent(&MmpWorkingSetEvent, EVENT_SYNCHRONIZATION, false);
+	
+	size_t LowWatermark = MmGetTotalAvailablePages() / 32;
+	if (LowWatermark < MI_WS_MIN_LOW_WATERMARK)
+		LowWatermark = MI_WS_MIN_LOW_WATERMARK;
+	
+	MmpWorkingSetHighWatermark = LowWatermark * 2;
+	
+	PETHREAD Thread;
+	BSTATUS Status = PsCreateSystemThreadFast(
+		&Thread,
+		MmpWorkingSetManager,
+		NULL,
+		false
+	);
+	
+	if (FAILED(Status))
+	{
+		KeCrash(
+			"ERROR: Could not launch working set manager: %d (%s)",
+			Status,
+			RtlGetStatusString(Status)
+		);
+	}
+	
+	ObDereferenceObject(Thread);
+	
+	// Only enable the wake up from the page allocator once the manager exists.
+	MiWorkingSetLowWatermark = LowWatermark;
+}
@@ -130,6 +130,25 @@ void* ObReferenceObjectByPointer(void* Object)
 	return Object;
 }
 
+bool ObReferenceObjectSafe(void* Object)
+{
+	POBJECT_HEADER Hdr = OBJECT_GET_HEADER(Object);
+	
+	ASSERTN(Hdr->Signature == OBJECT_HEADER_SIGNATURE);
+	
+	int Count = AtLoad(Hdr->NonPagedObjectHeader->PointerCount);
+	
+	// Once the count drops to zero, the object is on its way to being deleted,
+	// so it must not be brought back.
+	while (Count > 0)
+	{
+		if (AtCompareExchange(&Hdr->NonPagedObjectHeader->PointerCount, &Count, Count + 1))
+			return true;
+	}
+	
+	return false;
+}
+
 void ObDereferenceObject(void* Object)
 {
 	POBJECT_HEADER Hdr = OBJECT_GET_HEADER(Object);
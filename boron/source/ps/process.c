@@ -105,6 +105,8 @@ BSTATUS PspInitializeProcessObject(void* ProcessV, void* Context)
 	
 	MmInitializeVadList(&Process->VadList);
 	
+	memset(&Process->WorkingSet, 0, sizeof Process->WorkingSet);
+	
 	// Set the exit code to 0.
 	Process->ExitCode = 0;
 	
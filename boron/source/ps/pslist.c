@@ -79,6 +79,36 @@ void PspRemoveProcessFromList(PEPROCESS Process)
 	return;
 }
 
+typedef struct
+{
+	PPS_ENUMERATE_PROCESS_ROUTINE Routine;
+	void* Context;
+}
+PSP_ENUMERATE_CONTEXT, *PPSP_ENUMERATE_CONTEXT;
+
+static bool PspEnumerateFilter(void* Pointer, void* ContextV)
+{
+	PPSP_ENUMERATE_CONTEXT Context = ContextV;
+	
+	Context->Routine((PEPROCESS) Pointer, Context->Context);
+	return false; // do not delete
+}
+
+void PsEnumerateProcesses(PPS_ENUMERATE_PROCESS_ROUTINE Routine, void* Context)
+{
+	PSP_ENUMERATE_CONTEXT EnumerateContext;
+	EnumerateContext.Routine = Routine;
+	EnumerateContext.Context = Context;
+	
+	ExFilterHandleTable(
+		PspProcessHandleTable,
+		PspEnumerateFilter,
+		NULL,  // KillHandleMethod
+		&EnumerateContext,
+		NULL   // KillContext
+	);
+}
+
 bool PspDebugDumpFilter(void* Pointer, UNUSED void* Context)
 {
 	PEPROCESS Process = (PEPROCESS) Pointer;
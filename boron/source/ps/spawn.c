@@ -0,0 +1,507 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	ps/spawn.c
+
+Abstract:
+	This module implements the OSSpawnProcess() system call.
+	
+	Creating a process by hand takes dozens of system calls:
+	one to create it, a few for every segment of the executable
+	and its interpreter, and several more to build the PEB and
+	hand out the standard I/O handles.  OSSpawnProcess takes a
+	mapping plan prepared by libboron and carries all of it out
+	in a single call.
+	
+	The interpreter is mapped from the image section cache if
+	possible.  The cached sections are built by the kernel from
+	the file itself, never supplied by user mode.  The
+	interpreter's base is chosen before that of any other image,
+	so that it lands at the same address in every spawned
+	process and the cached section can actually be reused.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "psp.h"
+#include <io.h>
+
+#define PSP_SPAWN_MAX_PEB_SIZE (1024 * 1024)
+
+typedef struct
+{
+	SPAWN_PARAMETERS Parameters;
+	PSPAWN_VIEW Views;
+	PPEB Peb;
+	char ImageName[MAX_IMAGE_NAME];
+	
+	PFILE_OBJECT FileObjects[SPAWN_MAX_IMAGES];
+	PMMSECTION Sections[SPAWN_MAX_IMAGES];
+	uintptr_t ImageBases[SPAWN_MAX_IMAGES];
+}
+SPAWN_CONTEXT, *PSPAWN_CONTEXT;
+
+static void PspFreeSpawnContext(PSPAWN_CONTEXT Context)
+{
+	for (int i = 0; i < SPAWN_MAX_IMAGES; i++)
+	{
+		if (Context->FileObjects[i])
+			ObDereferenceObject(Context->FileObjects[i]);
+		
+		if (Context->Sections[i])
+			ObDereferenceObject(Context->Sections[i]);
+	}
+	
+	if (Context->Views)
+		MmFreePool(Context->Views);
+	
+	if (Context->Peb)
+		MmFreePool(Context->Peb);
+	
+	MmFreePool(Context);
+}
+
+// Copies the spawn parameters, the views and the PEB template into kernel memory,
+// and references the image files.
+static BSTATUS PspCaptureSpawnParameters(PSPAWN_CONTEXT Context, PSPAWN_PARAMETERS UserParameters)
+{
+	BSTATUS Status;
+	KPROCESSOR_MODE PreviousMode = KeGetPreviousMode();
+	PSPAWN_PARAMETERS Parameters = &Context->Parameters;
+	
+	Status = MmSafeCopy(Parameters, UserParameters, sizeof(SPAWN_PARAMETERS), PreviousMode, false);
+	if (FAILED(Status))
+		return Status;
+	
+	if (Parameters->ImageCount < 1 || Parameters->ImageCount > SPAWN_MAX_IMAGES ||
+		Parameters->ViewCount  < 1 || Parameters->ViewCount  > SPAWN_MAX_VIEWS ||
+		Parameters->EntryImage < 0 || Parameters->EntryImage >= Parameters->ImageCount ||
+		Parameters->PebSize < sizeof(PEB) || Parameters->PebSize > PSP_SPAWN_MAX_PEB_SIZE)
+		return STATUS_INVALID_PARAMETER;
+	
+	size_t ViewsSize = Parameters->ViewCount * sizeof(SPAWN_VIEW);
+	Context->Views = MmAllocatePool(POOL_PAGED, ViewsSize);
+	if (!Context->Views)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	Status = MmSafeCopy(Context->Views, Parameters->Views, ViewsSize, PreviousMode, false);
+	if (FAILED(Status))
+		return Status;
+	
+	for (int i = 0; i < Parameters->ViewCount; i++)
+	{
+		PSPAWN_VIEW View = &Context->Views[i];
+		
+		if (View->Image < 0 || View->Image >= Parameters->ImageCount ||
+			View->Size == 0 || View->SizeInFile > View->Size ||
+			(View->Protection & ~(PAGE_READ | PAGE_WRITE | PAGE_EXECUTE)))
+			return STATUS_INVALID_PARAMETER;
+	}
+	
+	Context->Peb = MmAllocatePool(POOL_PAGED, Parameters->PebSize);
+	if (!Context->Peb)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	Status = MmSafeCopy(Context->Peb, Parameters->Peb, Parameters->PebSize, PreviousMode, false);
+	if (FAILED(Status))
+		return Status;
+	
+	// Truncate the image name if needed, like OSSetImageNameProcess does.
+	size_t ImageNameLength = Parameters->ImageNameLength;
+	if (ImageNameLength >= MAX_IMAGE_NAME - 1)
+		ImageNameLength =  MAX_IMAGE_NAME - 1;
+	
+	Status = MmSafeCopy(Context->ImageName, Parameters->ImageName, ImageNameLength, PreviousMode, false);
+	if (FAILED(Status))
+		return Status;
+	
+	for (int i = 0; i < Parameters->ImageCount; i++)
+	{
+		void* FileObject;
+		Status = ExReferenceObjectByHandle(Parameters->Images[i].FileHandle, IoFileType, &FileObject);
+		if (FAILED(Status))
+			return Status;
+		
+		Context->FileObjects[i] = FileObject;
+	}
+	
+	return STATUS_SUCCESS;
+}
+
+// Gives the new process the caller's standard I/O handles.
+static BSTATUS PspDuplicateStandardHandles(PSPAWN_CONTEXT Context, PEPROCESS Process)
+{
+	BSTATUS Status;
+	
+	for (int i = 0; i < 3; i++)
+	{
+		if (!Context->Peb->StandardIO[i])
+			continue;
+		
+		void* Object;
+		Status = ExReferenceObjectByHandle(Context->Peb->StandardIO[i], NULL, &Object);
+		if (FAILED(Status))
+			return Status;
+		
+		Status = ObInsertObjectProcess(Process, Object, &Context->Peb->StandardIO[i], 0);
+		ObDereferenceObject(Object);
+		
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	return STATUS_SUCCESS;
+}
+
+// N.B.  The new process must be attached.
+static BSTATUS PspChooseImageBase(PSPAWN_CONTEXT Context, int Index)
+{
+	PSPAWN_IMAGE Image = &Context->Parameters.Images[Index];
+	
+	// Images with no size are mapped at their absolute addresses.
+	if (Image->ImageSize == 0)
+		return STATUS_SUCCESS;
+	
+	void* Address = NULL;
+	BSTATUS Status = MmReserveVirtualMemory(
+		(Image->ImageSize + PAGE_SIZE - 1) / PAGE_SIZE,
+		&Address,
+		MEM_RESERVE | MEM_TOP_DOWN,
+		0
+	);
+	
+	if (FAILED(Status))
+		return Status;
+	
+	// The views are mapped at fixed addresses inside of this range, so release it.
+	// Nothing runs in the new process yet, so nobody can take the range meanwhile.
+	Status = MmReleaseVirtualMemory(Address);
+	if (FAILED(Status))
+		return Status;
+	
+	Context->ImageBases[Index] = (uintptr_t) Address;
+	
+	// If the section can't be had, the interpreter is mapped from its file and
+	// relocates itself instead.
+	if (Image->IsInterpreter &&
+		FAILED(MmReferenceImageSection(&Context->Sections[Index], Context->FileObjects[Index], (uintptr_t) Address, Image->ImageSize)))
+		Context->Sections[Index] = NULL;
+	
+	return STATUS_SUCCESS;
+}
+
+// N.B.  The new process must be attached.
+static BSTATUS PspZeroUserMemory(uintptr_t Address, size_t Size)
+{
+	static const char Zeroes[256];
+	
+	while (Size)
+	{
+		size_t Chunk = Size < sizeof Zeroes ? Size : sizeof Zeroes;
+		
+		BSTATUS Status = MmSafeCopy((void*) Address, Zeroes, Chunk, KeGetPreviousMode(), true);
+		if (FAILED(Status))
+			return Status;
+		
+		Address += Chunk;
+		Size -= Chunk;
+	}
+	
+	return STATUS_SUCCESS;
+}
+
+// N.B.  The new process must be attached.
+static BSTATUS PspMapSpawnView(PSPAWN_CONTEXT Context, PSPAWN_VIEW View)
+{
+	BSTATUS Status;
+	uintptr_t ImageBase = Context->ImageBases[View->Image];
+	uintptr_t StartVa = ImageBase + View->Address;
+	uintptr_t AlignedStartVa = StartVa & ~(PAGE_SIZE - 1);
+	uintptr_t EndVa = (StartVa + View->Size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	
+	if (EndVa <= StartVa || EndVa > MM_USER_SPACE_END)
+		return STATUS_INVALID_PARAMETER;
+	
+	void* Address;
+	
+	// The cached section holds the whole image, already base-relocated, laid out
+	// at the same offsets as in memory.
+	if (Context->Sections[View->Image])
+	{
+		Address = (void*) AlignedStartVa;
+		return MmMapViewOfObjectPointer(
+			Context->Sections[View->Image],
+			&Address,
+			EndVa - AlignedStartVa,
+			MEM_COMMIT | MEM_FIXED | MEM_COW,
+			AlignedStartVa - ImageBase,
+			View->Protection
+		);
+	}
+	
+	uintptr_t FileEndVa = AlignedStartVa;
+	
+	if (View->SizeInFile)
+	{
+		if ((View->Offset & (PAGE_SIZE - 1)) != (StartVa & (PAGE_SIZE - 1)))
+			return STATUS_INVALID_PARAMETER;
+		
+		// Only map the pages which hold file data.  The rest of the view is
+		// anonymous memory, which doesn't need to be zeroed by hand.
+		FileEndVa = (StartVa + View->SizeInFile + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+		
+		Address = (void*) StartVa;
+		Status = MmMapViewOfObjectPointer(
+			Context->FileObjects[View->Image],
+			&Address,
+			FileEndVa - StartVa,
+			MEM_COMMIT | MEM_FIXED | MEM_COW,
+			View->Offset,
+			View->Protection
+		);
+		
+		if (FAILED(Status))
+			return Status;
+		
+		// The last page holds whatever follows the view's contents in the file.
+		uintptr_t ZeroEndVa = StartVa + View->Size < FileEndVa ? StartVa + View->Size : FileEndVa;
+		
+		Status = PspZeroUserMemory(StartVa + View->SizeInFile, ZeroEndVa - StartVa - View->SizeInFile);
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	if (FileEndVa < EndVa)
+	{
+		Address = (void*) FileEndVa;
+		Status = MmReserveVirtualMemory(
+			(EndVa - FileEndVa) / PAGE_SIZE,
+			&Address,
+			MEM_RESERVE | MEM_COMMIT | MEM_FIXED,
+			View->Protection
+		);
+		
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	return STATUS_SUCCESS;
+}
+
+static void* PspRebasePointer(void* Pointer, uintptr_t Base)
+{
+	return Pointer ? (void*)((uintptr_t) Pointer + Base) : NULL;
+}
+
+// Maps the images and the PEB into the new process.
+//
+// N.B.  The new process must be attached.
+static BSTATUS PspMapSpawnImages(PSPAWN_CONTEXT Context, void** OutPebPointer)
+{
+	BSTATUS Status;
+	PSPAWN_PARAMETERS Parameters = &Context->Parameters;
+	
+	// Place the interpreter first, see the abstract.
+	for (int i = 0; i < Parameters->ImageCount; i++)
+	{
+		if (!Parameters->Images[i].IsInterpreter)
+			continue;
+		
+		Status = PspChooseImageBase(Context, i);
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	for (int i = 0; i < Parameters->ImageCount; i++)
+	{
+		if (Parameters->Images[i].IsInterpreter)
+			continue;
+		
+		Status = PspChooseImageBase(Context, i);
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	for (int i = 0; i < Parameters->ViewCount; i++)
+	{
+		Status = PspMapSpawnView(Context, &Context->Views[i]);
+		if (FAILED(Status))
+			return Status;
+	}
+	
+	void* PebPointer = NULL;
+	size_t PebSizePages = (Parameters->PebSize + PAGE_SIZE - 1) / PAGE_SIZE;
+	Status = MmReserveVirtualMemory(
+		PebSizePages,
+		&PebPointer,
+		MEM_RESERVE | MEM_COMMIT | MEM_TOP_DOWN,
+		PAGE_READ | PAGE_WRITE
+	);
+	
+	if (FAILED(Status))
+		return Status;
+	
+	// Update all the pointers to point to the correct place.
+	PPEB Peb = Context->Peb;
+	uintptr_t PebDelta = (uintptr_t) PebPointer - (uintptr_t) Parameters->Peb;
+	
+	Peb->ImageName   = PspRebasePointer(Peb->ImageName,   PebDelta);
+	Peb->CommandLine = PspRebasePointer(Peb->CommandLine, PebDelta);
+	Peb->Environment = PspRebasePointer(Peb->Environment, PebDelta);
+	Peb->PebFreeSize = PebSizePages * PAGE_SIZE;
+	
+	uintptr_t ImageBase = Context->ImageBases[0];
+	Peb->Loader.MappedImage    = true;
+	Peb->Loader.ImageBase      = ImageBase;
+	Peb->Loader.FileHeader     = (void*)((uintptr_t) Peb->Loader.FileHeader + ImageBase);
+	Peb->Loader.ProgramHeaders = (void*)((uintptr_t) Peb->Loader.ProgramHeaders + ImageBase);
+	Peb->Loader.Interpreter    = PspRebasePointer((void*) Peb->Loader.Interpreter, ImageBase);
+	
+	for (int i = 0; i < Parameters->ImageCount; i++)
+	{
+		if (!Parameters->Images[i].IsInterpreter)
+			continue;
+		
+		if (Context->Sections[i])
+			Peb->Loader.InterpreterRelocated = true;
+	}
+	
+	Status = MmSafeCopy(PebPointer, Peb, Parameters->PebSize, KeGetPreviousMode(), true);
+	if (FAILED(Status))
+		return Status;
+	
+	*OutPebPointer = PebPointer;
+	return STATUS_SUCCESS;
+}
+
+//
+// Creates a process, maps its images and PEB, and starts its main thread.
+//
+// Parameters:
+//     OutProcessHandle - The handle to the new process.
+//
+//     OutThreadHandle - The handle to the new process' main thread.
+//
+//     ObjectAttributes - The attributes of the new process object.  It may not have a name.
+//
+//     Parameters - The description of the new process.  See SPAWN_PARAMETERS for details.
+//
+BSTATUS OSSpawnProcess(
+	PHANDLE OutProcessHandle,
+	PHANDLE OutThreadHandle,
+	POBJECT_ATTRIBUTES ObjectAttributes,
+	PSPAWN_PARAMETERS Parameters
+)
+{
+	BSTATUS Status;
+	
+	PSPAWN_CONTEXT Context = MmAllocatePool(POOL_PAGED, sizeof(SPAWN_CONTEXT));
+	if (!Context)
+		return STATUS_INSUFFICIENT_MEMORY;
+	
+	memset(Context, 0, sizeof(SPAWN_CONTEXT));
+	
+	Status = PspCaptureSpawnParameters(Context, Parameters);
+	if (FAILED(Status))
+		goto Fail1;
+	
+	OBJECT_ATTRIBUTES Attributes;
+	if (ObjectAttributes)
+	{
+		Status = MmSafeCopy(&Attributes, ObjectAttributes, sizeof(OBJECT_ATTRIBUTES), KeGetPreviousMode(), false);
+		if (FAILED(Status))
+			goto Fail1;
+	}
+	
+	// Create the process.  See OSForkProcess for why the address mode is changed.
+	HANDLE ProcessHandle = HANDLE_NONE;
+	KPROCESSOR_MODE OldMode = KeSetAddressMode(MODE_KERNEL);
+	Status = OSCreateProcess(
+		&ProcessHandle,
+		ObjectAttributes ? &Attributes : NULL,
+		CURRENT_PROCESS_HANDLE,
+		Context->Parameters.InheritHandles,
+		Context->Parameters.DeepCloneHandles
+	);
+	KeSetAddressMode(OldMode);
+	
+	if (FAILED(Status))
+		goto Fail1;
+	
+	PEPROCESS Process = NULL;
+	Status = ObReferenceObjectByHandle(ProcessHandle, PsProcessObjectType, (void**) &Process);
+	if (FAILED(Status))
+		goto Fail2;
+	
+	// If the handles are inherited, then the standard I/O handles already mean
+	// the same thing in the new process.
+	if (!Context->Parameters.InheritHandles && !Context->Parameters.DeepCloneHandles)
+	{
+		Status = PspDuplicateStandardHandles(Context, Process);
+		if (FAILED(Status))
+			goto Fail3;
+	}
+	
+	void* PebPointer = NULL;
+	PEPROCESS OldProcess = PsSetAttachedProcess(Process);
+	Status = PspMapSpawnImages(Context, &PebPointer);
+	PsSetAttachedProcess(OldProcess);
+	
+	if (FAILED(Status))
+		goto Fail3;
+	
+	// The process has no threads yet, so this can be set directly.
+	Process->Pcb.PebPointer = PebPointer;
+	memcpy(Process->ImageName, Context->ImageName, MAX_IMAGE_NAME);
+	
+	uintptr_t EntryPoint = Context->ImageBases[Context->Parameters.EntryImage] + Context->Parameters.EntryPoint;
+	if (EntryPoint >= MM_USER_SPACE_END)
+	{
+		Status = STATUS_INVALID_PARAMETER;
+		goto Fail3;
+	}
+	
+	HANDLE ThreadHandle = HANDLE_NONE;
+	OldMode = KeSetAddressMode(MODE_KERNEL);
+	Status = OSCreateThread(
+		&ThreadHandle,
+		ProcessHandle,
+		NULL, // ObjectAttributes
+		(PKTHREAD_START) EntryPoint,
+		PebPointer,
+		Context->Parameters.CreateSuspended
+	);
+	KeSetAddressMode(OldMode);
+	
+	if (FAILED(Status))
+		goto Fail3;
+	
+	// The handles are only handed out once the process exists in full, so that
+	// the caller never gets a handle to a process without a thread.
+	Status = MmSafeCopy(OutProcessHandle, &ProcessHandle, sizeof(HANDLE), KeGetPreviousMode(), true);
+	if (SUCCEEDED(Status))
+		Status = MmSafeCopy(OutThreadHandle, &ThreadHandle, sizeof(HANDLE), KeGetPreviousMode(), true);
+	
+	if (FAILED(Status))
+	{
+		// The process is running already, so the only thing left to do is to
+		// report the failure.  The caller won't close handles it was told it
+		// didn't get, so close both of them here.
+		ObClose(ThreadHandle);
+		ObClose(ProcessHandle);
+	}
+	
+	ObDereferenceObject(Process);
+	PspFreeSpawnContext(Context);
+	return Status;
+
+Fail3:
+	ObDereferenceObject(Process);
+Fail2:
+	ObClose(ProcessHandle);
+Fail1:
+	PspFreeSpawnContext(Context);
+	return Status;
+}
@@ -0,0 +1,299 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	rtl/compress.c
+	
+Abstract:
+	This module implements a fast LZ compressor and decompressor.
+	
+	The compressor finds matches using a hash table of the last
+	position at which each 4-byte sequence was seen, and never
+	searches any further than that.  This trades compression ratio
+	for speed, which is what the memory manager wants when it
+	compresses pages.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <rtl/compress.h>
+#include <string.h>
+
+// When this many bytes in a row don't match anything, the compressor starts skipping
+// ahead, so that incompressible data is given up on quickly.
+#define RTLP_LZ_SKIP_SHIFT (6)
+
+// The kernel is built freestanding, so memcpy isn't a builtin unless asked for explicitly.
+// These are unaligned loads and stores, and compile to a single instruction each.
+static uint32_t RtlpReadSequenceLz(const uint8_t* Pointer)
+{
+	uint32_t Sequence;
+	__builtin_memcpy(&Sequence, Pointer, sizeof Sequence);
+	return Sequence;
+}
+
+static uintptr_t RtlpReadWordLz(const uint8_t* Pointer)
+{
+	uintptr_t Word;
+	__builtin_memcpy(&Word, Pointer, sizeof Word);
+	return Word;
+}
+
+static uint32_t RtlpHashSequenceLz(uint32_t Sequence)
+{
+	return (Sequence * 2654435761u) >> (32 - RTL_LZ_HASH_BITS);
+}
+
+static uint8_t* RtlpWriteLengthLz(uint8_t* Output, size_t Length)
+{
+	while (Length >= 255)
+	{
+		*Output++ = 255;
+		Length -= 255;
+	}
+	
+	*Output++ = (uint8_t) Length;
+	return Output;
+}
+
+static bool RtlpReadLengthLz(const uint8_t** Input, const uint8_t* InputEnd, size_t* Length)
+{
+	uint8_t Byte;
+	
+	do
+	{
+		if (*Input >= InputEnd)
+			return false;
+		
+		Byte = *(*Input)++;
+		*Length += Byte;
+	}
+	while (Byte == 255);
+	
+	return true;
+}
+
+// Counts the bytes that match between two places, a word at a time.  The first
+// differing byte of a word is found from the lowest set bit, since all of the
+// supported architectures are little endian.
+static size_t RtlpCountMatchLz(const uint8_t* Pointer, const uint8_t* Match, const uint8_t* End)
+{
+	const uint8_t* Start = Pointer;
+	
+	while (Pointer + sizeof(uintptr_t) <= End)
+	{
+		uintptr_t Difference = RtlpReadWordLz(Pointer) ^ RtlpReadWordLz(Match);
+		if (Difference)
+			return Pointer - Start + __builtin_ctzl(Difference) / 8;
+		
+		Pointer += sizeof(uintptr_t);
+		Match   += sizeof(uintptr_t);
+	}
+	
+	while (Pointer < End && *Pointer == *Match)
+	{
+		Pointer++;
+		Match++;
+	}
+	
+	return Pointer - Start;
+}
+
+// Copies a match, which may overlap the bytes being written.
+static void RtlpCopyMatchLz(uint8_t* Output, size_t Offset, size_t Length)
+{
+	const uint8_t* Match = Output - Offset;
+	
+	if (Offset < sizeof(uintptr_t))
+	{
+		// The match repeats the last Offset bytes.  Write the first few repetitions
+		// byte by byte, until a whole word of them is behind the output.  After that,
+		// the same pattern can be read from that far back, a word at a time.
+		size_t Distance = Offset;
+		while (Distance < sizeof(uintptr_t))
+			Distance += Offset;
+		
+		size_t Count = Distance < Length ? Distance : Length;
+		for (size_t i = 0; i < Count; i++)
+			Output[i] = Match[i];
+		
+		Output += Count;
+		Length -= Count;
+		Match = Output - Distance;
+	}
+	
+	while (Length >= sizeof(uintptr_t))
+	{
+		uintptr_t Word = RtlpReadWordLz(Match);
+		__builtin_memcpy(Output, &Word, sizeof Word);
+		
+		Output += sizeof(uintptr_t);
+		Match  += sizeof(uintptr_t);
+		Length -= sizeof(uintptr_t);
+	}
+	
+	while (Length--)
+		*Output++ = *Match++;
+}
+
+// Writes one sequence.  If there is no match, MatchLength is zero.  Returns NULL if
+// the sequence doesn't fit.
+static uint8_t* RtlpWriteSequenceLz(
+	uint8_t* Output,
+	const uint8_t* OutputEnd,
+	const uint8_t* Literals,
+	size_t LiteralLength,
+	size_t Offset,
+	size_t MatchLength
+)
+{
+	// The token, the literals and their extra length bytes, the offset, and the
+	// extra match length bytes.
+	size_t Required = 1 + LiteralLength + LiteralLength / 255 + 1;
+	if (MatchLength)
+		Required += 2 + MatchLength / 255 + 1;
+	
+	if (Required > (size_t)(OutputEnd - Output))
+		return NULL;
+	
+	size_t MatchCode = MatchLength ? MatchLength - RTL_LZ_MIN_MATCH : 0;
+	uint8_t* Token = Output++;
+	
+	*Token = (uint8_t)(((LiteralLength < 15 ? LiteralLength : 15) << 4) | (MatchCode < 15 ? MatchCode : 15));
+	
+	if (LiteralLength >= 15)
+		Output = RtlpWriteLengthLz(Output, LiteralLength - 15);
+	
+	memcpy(Output, Literals, LiteralLength);
+	Output += LiteralLength;
+	
+	if (!MatchLength)
+		return Output;
+	
+	*Output++ = (uint8_t) Offset;
+	*Output++ = (uint8_t)(Offset >> 8);
+	
+	if (MatchCode >= 15)
+		Output = RtlpWriteLengthLz(Output, MatchCode - 15);
+	
+	return Output;
+}
+
+size_t RtlCompressBufferLz(
+	void* Destination,
+	size_t DestinationSize,
+	const void* Source,
+	size_t SourceSize,
+	PRTL_LZ_WORKSPACE Workspace
+)
+{
+	const uint8_t* Input = Source;
+	uint8_t* Output = Destination;
+	const uint8_t* OutputEnd = Output + DestinationSize;
+	
+	if (SourceSize > RTL_LZ_MAX_INPUT_SIZE)
+		return 0;
+	
+	// The hash table isn't cleared.  It's as large as a page, and the entries left
+	// over from earlier calls are harmless, since every candidate is compared with
+	// the input before it's used.
+	size_t Position = 0;
+	size_t LiteralStart = 0;
+	
+	while (Position + RTL_LZ_MIN_MATCH <= SourceSize)
+	{
+		uint32_t Sequence = RtlpReadSequenceLz(Input + Position);
+		uint32_t Hash = RtlpHashSequenceLz(Sequence);
+		size_t Candidate = Workspace->HashTable[Hash];
+		Workspace->HashTable[Hash] = (uint16_t) Position;
+		
+		if (Candidate >= Position || RtlpReadSequenceLz(Input + Candidate) != Sequence)
+		{
+			Position += 1 + ((Position - LiteralStart) >> RTLP_LZ_SKIP_SHIFT);
+			continue;
+		}
+		
+		size_t MatchLength = RTL_LZ_MIN_MATCH + RtlpCountMatchLz(
+			Input + Position + RTL_LZ_MIN_MATCH,
+			Input + Candidate + RTL_LZ_MIN_MATCH,
+			Input + SourceSize
+		);
+		
+		Output = RtlpWriteSequenceLz(
+			Output,
+			OutputEnd,
+			Input + LiteralStart,
+			Position - LiteralStart,
+			Position - Candidate,
+			MatchLength
+		);
+		
+		if (!Output)
+			return 0;
+		
+		Position += MatchLength;
+		LiteralStart = Position;
+	}
+	
+	// The rest of the input goes into the last sequence, which has no match.
+	Output = RtlpWriteSequenceLz(Output, OutputEnd, Input + LiteralStart, SourceSize - LiteralStart, 0, 0);
+	if (!Output)
+		return 0;
+	
+	return Output - (uint8_t*) Destination;
+}
+
+size_t RtlDecompressBufferLz(
+	void* Destination,
+	size_t DestinationSize,
+	const void* Source,
+	size_t SourceSize
+)
+{
+	const uint8_t* Input = Source;
+	const uint8_t* InputEnd = Input + SourceSize;
+	uint8_t* OutputStart = Destination;
+	uint8_t* Output = OutputStart;
+	uint8_t* OutputEnd = Output + DestinationSize;
+	
+	while (Input < InputEnd)
+	{
+		uint8_t Token = *Input++;
+		
+		size_t LiteralLength = Token >> 4;
+		if (LiteralLength == 15 && !RtlpReadLengthLz(&Input, InputEnd, &LiteralLength))
+			return 0;
+		
+		if (LiteralLength > (size_t)(InputEnd - Input) || LiteralLength > (size_t)(OutputEnd - Output))
+			return 0;
+		
+		memcpy(Output, Input, LiteralLength);
+		Output += LiteralLength;
+		Input  += LiteralLength;
+		
+		// The last sequence ends with its literals.
+		if (Input == InputEnd)
+			break;
+		
+		if (InputEnd - Input < 2)
+			return 0;
+		
+		size_t Offset = Input[0] | Input[1] << 8;
+		Input += 2;
+		
+		size_t MatchLength = Token & 15;
+		if (MatchLength == 15 && !RtlpReadLengthLz(&Input, InputEnd, &MatchLength))
+			return 0;
+		
+		MatchLength += RTL_LZ_MIN_MATCH;
+		
+		if (Offset == 0 || Offset > (size_t)(Output - OutputStart) || MatchLength > (size_t)(OutputEnd - Output))
+			return 0;
+		
+		RtlpCopyMatchLz(Output, Offset, MatchLength);
+		Output += MatchLength;
+	}
+	
+	return Output - OutputStart;
+}
@@ -306,11 +306,34 @@ static bool RtlpApplyRelocation(
 	return true;
 }
 
-bool RtlPerformRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase)
+static bool RtlpIsRelocationSelected(uintptr_t Info, int Kinds)
+{
+	// Only relative relocations count as depending on the load base alone, because
+	// those are the only ones the kernel applies to cached image sections.
+#if   defined TARGET_AMD64
+	bool IsRelative = ELF_R_TYPE(Info) == R_X86_64_RELATIVE;
+#elif defined TARGET_I386
+	bool IsRelative = ELF_R_TYPE(Info) == R_386_RELATIVE;
+#elif defined TARGET_ARM
+	bool IsRelative = ELF_R_TYPE(Info) == R_ARM_RELATIVE;
+#else
+#error Hey! Add the relative relocation type here
+#endif
+	int Kind = IsRelative ? RTL_RELOC_BASE : RTL_RELOC_SYMBOLIC;
+	return (Kinds & Kind) != 0;
+}
+
+// Applies the relocations of the kinds selected by Kinds.  Used by libboron.so to
+// skip the relocations which the kernel has already applied to an image that was
+// mapped from the image section cache.
+bool RtlPerformSelectedRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, int Kinds)
 {
 	for (size_t i = 0; i < DynInfo->RelaCount; i++)
 	{
 		PELF_RELA Rela = &DynInfo->RelaEntries[i];
+		if (!RtlpIsRelocationSelected(Rela->Info, Kinds))
+			continue;
+		
 		if (!RtlpApplyRelocation(DynInfo, NULL, Rela, LoadBase, 0))
 			return false;
 	}
@@ -318,6 +341,9 @@ bool RtlPerformRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase)
 	for (size_t i = 0; i < DynInfo->RelCount; i++)
 	{
 		PELF_REL Rel = &DynInfo->RelEntries[i];
+		if (!RtlpIsRelocationSelected(Rel->Info, Kinds))
+			continue;
+		
 		if (!RtlpApplyRelocation(DynInfo, Rel, NULL, LoadBase, 0))
 			return false;
 	}
@@ -325,6 +351,11 @@ bool RtlPerformRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase)
 	return true;
 }
 
+bool RtlPerformRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase)
+{
+	return RtlPerformSelectedRelocations(DynInfo, LoadBase, RTL_RELOC_BASE | RTL_RELOC_SYMBOLIC);
+}
+
 // Parses the dynamic table of an ELF file and fills in the relevant info in the
 // ELF_DYNAMIC_INFO structure.
 //
@@ -401,6 +432,28 @@ bool RtlParseDynamicTable(PELF_DYNAMIC_ITEM DynItem, PELF_DYNAMIC_INFO Info, uin
 				Info->HashTable = (ELF_HASH_TABLE*)(LoadBase + DynItem->Pointer);
 				break;
 			
+			case DYN_GNU_HASH:
+				Info->GnuHashTable = (ELF_GNU_HASH_TABLE*)(LoadBase + DynItem->Pointer);
+				break;
+			
+			case DYN_PLTGOT:
+				Info->PltGot = (uintptr_t*)(LoadBase + DynItem->Pointer);
+				break;
+			
+			case DYN_BIND_NOW:
+				Info->BindNow = true;
+				break;
+			
+			case DYN_FLAGS:
+				if (DynItem->Value & DF_BIND_NOW)
+					Info->BindNow = true;
+				break;
+			
+			case DYN_FLAGS_1:
+				if (DynItem->Value & DF_1_NOW)
+					Info->BindNow = true;
+				break;
+			
 			case DYN_INIT:
 				Info->Init = (PELF_INIT_FUNC)(LoadBase + DynItem->Pointer);
 				break;
@@ -493,6 +546,82 @@ bool RtlLinkPlt(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, UNUSED const char
 	return true;
 }
 
+// Prepares the PLT of a module for lazy binding.  Instead of resolving every PLT
+// relocation now, each GOT slot is left pointing back into its PLT stub, which
+// will call Resolver the first time the function is called.  Resolver receives
+// Context and the index of the PLT relocation, and is expected to call
+// RtlBindLazyPltEntry.
+//
+// Returns false if the module can't be lazily bound, in which case RtlLinkPlt
+// must be used instead.  Lazy binding is only done on AMD64.  The i386 and ARM
+// PLTs use REL relocations and would need resolver stubs of their own, so they
+// are always bound eagerly.
+bool RtlPrepareLazyPlt(
+	UNUSED PELF_DYNAMIC_INFO DynInfo,
+	UNUSED uintptr_t LoadBase,
+	UNUSED void* Context,
+	UNUSED uintptr_t Resolver)
+{
+#ifdef TARGET_AMD64
+	if (!DynInfo->PltGot || !DynInfo->PltUsesRela || DynInfo->BindNow)
+		return false;
+	
+	PELF_RELA PltRelocations = (PELF_RELA) DynInfo->PltRelocations;
+	size_t PltRelocationCount = DynInfo->PltRelocationCount / sizeof(ELF_RELA);
+	
+	// Some linkers make DYN_RELASZ cover the PLT relocations too.  If so, they
+	// were already applied by RtlPerformRelocations.
+	if (PltRelocations >= DynInfo->RelaEntries &&
+	    PltRelocations <  DynInfo->RelaEntries + DynInfo->RelaCount)
+		return false;
+	
+	for (size_t i = 0; i < PltRelocationCount; i++)
+	{
+		if (ELF_R_TYPE(PltRelocations[i].Info) != R_X86_64_JUMP_SLOT)
+			return false;
+	}
+	
+	// The GOT slots contain the link-time addresses of the second instruction
+	// of each PLT stub, which pushes the relocation index and jumps to PLT0.
+	for (size_t i = 0; i < PltRelocationCount; i++)
+		*(uintptr_t*)(LoadBase + PltRelocations[i].Offset) += LoadBase;
+	
+	// PLT0 pushes GOT[1] and jumps to GOT[2].
+	DynInfo->PltGot[1] = (uintptr_t) Context;
+	DynInfo->PltGot[2] = Resolver;
+	return true;
+#else
+	// Bound eagerly, see above.
+	return false;
+#endif
+}
+
+#ifdef IS_BORON_DLL
+
+// Resolves a single PLT relocation prepared by RtlPrepareLazyPlt, and patches
+// its GOT slot so that further calls go directly to the function.
+//
+// Returns the address of the function, or 0 if it could not be found.
+uintptr_t RtlBindLazyPltEntry(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, size_t Index)
+{
+	PELF_RELA Rela = (PELF_RELA) DynInfo->PltRelocations + Index;
+	ASSERT(Index < DynInfo->PltRelocationCount / sizeof(ELF_RELA));
+	
+	PELF_SYMBOL Symbol = &DynInfo->DynSymTable[ELF_R_SYM(Rela->Info)];
+	const char* SymbolName = DynInfo->DynStrTable + Symbol->Name;
+	
+	uintptr_t SymbolAddress = OSDLLGetProcedureAddress(SymbolName);
+	if (!SymbolAddress)
+		return 0;
+	
+	if (!RtlpApplyRelocation(DynInfo, NULL, Rela, LoadBase, SymbolAddress))
+		return 0;
+	
+	return SymbolAddress;
+}
+
+#endif
+
 // TODO: Is this even needed? We aren't using it now
 bool RtlUpdateGlobalOffsetTable(uintptr_t *Got, size_t Size, uintptr_t LoadBase)
 {
@@ -647,3 +776,100 @@ uint32_t RtlElfHash(const char* Name)
 	
 	return H;
 }
+
+uint32_t RtlGnuHash(const char* Name)
+{
+	const uint8_t* NameU = (const uint8_t*) Name;
+	
+	uint32_t H = 5381;
+	
+	while (*NameU)
+		H = H * 33 + *NameU++;
+	
+	return H;
+}
+
+static PELF_SYMBOL RtlpLookUpGnuHash(PELF_DYNAMIC_INFO DynInfo, const char* Name, uint32_t GnuHash)
+{
+	PELF_GNU_HASH_TABLE HashTable = DynInfo->GnuHashTable;
+	const uint32_t WordBits = sizeof(uintptr_t) * 8;
+	
+	if (HashTable->BucketCount == 0 || HashTable->BloomSize == 0)
+		return NULL;
+	
+	// Check the bloom filter first.  Most lookups are for symbols that
+	// this module doesn't define, and those are usually rejected here.
+	uintptr_t BloomWord = HashTable->Bloom[(GnuHash / WordBits) & (HashTable->BloomSize - 1)];
+	uintptr_t BloomMask =
+		((uintptr_t) 1 << (GnuHash % WordBits)) |
+		((uintptr_t) 1 << ((GnuHash >> HashTable->BloomShift) % WordBits));
+	
+	if ((BloomWord & BloomMask) != BloomMask)
+		return NULL;
+	
+	const uint32_t* Buckets = (const uint32_t*) &HashTable->Bloom[HashTable->BloomSize];
+	const uint32_t* Chains = &Buckets[HashTable->BucketCount];
+	
+	uint32_t SymbolIndex = Buckets[GnuHash % HashTable->BucketCount];
+	if (SymbolIndex < HashTable->SymbolOffset)
+		return NULL;
+	
+	// The low bit of a chain entry marks the end of the chain.
+	while (true)
+	{
+		uint32_t ChainHash = Chains[SymbolIndex - HashTable->SymbolOffset];
+		
+		if ((ChainHash | 1) == (GnuHash | 1))
+		{
+			PELF_SYMBOL Symbol = &DynInfo->DynSymTable[SymbolIndex];
+			
+			if (Symbol->SectionHeaderIndex != SHN_UNDEF &&
+			    strcmp(DynInfo->DynStrTable + Symbol->Name, Name) == 0)
+				return Symbol;
+		}
+		
+		if (ChainHash & 1)
+			return NULL;
+		
+		SymbolIndex++;
+	}
+}
+
+static PELF_SYMBOL RtlpLookUpSysvHash(PELF_DYNAMIC_INFO DynInfo, const char* Name)
+{
+	PELF_HASH_TABLE HashTable = DynInfo->HashTable;
+	
+	if (HashTable->BucketCount == 0)
+		return NULL;
+	
+	const uint32_t* Chains = &HashTable->Data[HashTable->BucketCount];
+	uint32_t BucketIndex = RtlElfHash(Name) % HashTable->BucketCount;
+	
+	for (uint32_t SymbolIndex = HashTable->Data[BucketIndex];
+	     SymbolIndex != 0; // STN_UNDEF
+	     SymbolIndex = Chains[SymbolIndex])
+	{
+		PELF_SYMBOL Symbol = &DynInfo->DynSymTable[SymbolIndex];
+		
+		if (Symbol->SectionHeaderIndex != SHN_UNDEF &&
+		    strcmp(DynInfo->DynStrTable + Symbol->Name, Name) == 0)
+			return Symbol;
+	}
+	
+	return NULL;
+}
+
+// Looks up a symbol defined by a module.  The GNU hash table is preferred because
+// its bloom filter rejects most misses without touching the symbol table.  GnuHash
+// must be RtlGnuHash(Name), so that it is only calculated once when probing several
+// modules.
+PELF_SYMBOL RtlLookUpDynamicSymbol(PELF_DYNAMIC_INFO DynInfo, const char* Name, uint32_t GnuHash)
+{
+	if (DynInfo->GnuHashTable)
+		return RtlpLookUpGnuHash(DynInfo, Name, GnuHash);
+	
+	if (DynInfo->HashTable)
+		return RtlpLookUpSysvHash(DynInfo, Name);
+	
+	return NULL;
+}
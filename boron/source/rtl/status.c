@@ -91,7 +91,9 @@ static const char* const RtlpStatusCodes[] =
 	"The process is still running.",
 	
 	"The host closed the port before a connection could be created.",
-	"The message could not be created because the specified buffer is too long."
+	"The message could not be created because the specified buffer is too long.",
+	
+	"The file is already associated with a completion port."
 };
 
 const char* RtlGetStatusString(int code)
@@ -109,6 +109,10 @@ BSTATUS TtyInitializeTerminal(void* TerminalV, void* Context)
 	Host->Terminal = Terminal;
 	Session->Terminal = Terminal;
 	
+	// The host reads what the session writes, and the other way around.
+	IoSetNotifyFcbsPipe(Terminal->SessionToHostPipeFcb, Terminal->HostFcb, Terminal->SessionFcb);
+	IoSetNotifyFcbsPipe(Terminal->HostToSessionPipeFcb, Terminal->SessionFcb, Terminal->HostFcb);
+	
 	KeInitializeMutex(&Terminal->StateMutex, 0);
 	
 	// Initialize the terminal to a default state.
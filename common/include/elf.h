@@ -101,6 +101,7 @@ enum
 	DYN_INIT_ARRAYSZ,
 	DYN_FINI_ARRAYSZ,
 	DYN_RUNPATH,
+	DYN_FLAGS,
 	DYN_ENCODING = 32,
 	DYN_PREINIT_ARRAY = 32, // ignored
 	DYN_PREINIT_ARRAYSZ,
@@ -108,8 +109,21 @@ enum
 	DYN_RELR,
 	DYN_RELRENT,
 	DYN_MAXPOSTAGS,
+	
+	// OS-specific tags.
+	DYN_GNU_HASH = 0x6ffffef5,
+	DYN_FLAGS_1  = 0x6ffffffb,
 };
 
+// Flags for DYN_FLAGS.
+#define DF_BIND_NOW (1 << 3)
+
+// Flags for DYN_FLAGS_1.
+#define DF_1_NOW    (1 << 0)
+
+// Section index of an undefined symbol.
+#define SHN_UNDEF   (0)
+
 enum
 {
 	ELF_PHDR_READ  = (1 << 2),
@@ -302,6 +316,19 @@ typedef struct
 }
 ELF_HASH_TABLE, *PELF_HASH_TABLE;
 
+// The GNU hash table is followed by the bloom filter (BloomSize words), the
+// buckets (BucketCount uint32_t's) and the hash chains.  Only the symbols from
+// index SymbolOffset onwards are part of the table.
+typedef struct
+{
+	uint32_t  BucketCount;
+	uint32_t  SymbolOffset;
+	uint32_t  BloomSize;
+	uint32_t  BloomShift;
+	uintptr_t Bloom[];
+}
+ELF_GNU_HASH_TABLE, *PELF_GNU_HASH_TABLE;
+
 #ifdef IS_64_BIT
 #define ELF_R_SYM(x)  ((x) >> 32)
 #define ELF_R_TYPE(x) ((x) & 0xFFFFFFFF)
@@ -117,6 +117,31 @@ typedef struct _IO_DIRECTORY_ENTRY
 }
 IO_DIRECTORY_ENTRY, *PIO_DIRECTORY_ENTRY;
 
+// An entry removed from a completion port.
+typedef struct _IO_COMPLETION_ENTRY
+{
+	// The key given when the file was associated with the port, or when the
+	// entry was posted.
+	void* Key;
+	
+	BSTATUS Status;
+	
+	// For entries posted on behalf of an associated file, a combination of the
+	// IO_COMPLETION_* flags below.  Otherwise, the value that was posted.
+	uint64_t Information;
+}
+IO_COMPLETION_ENTRY, *PIO_COMPLETION_ENTRY;
+
+// The associated file may have become readable.  This is also reported when the other
+// end of a pipe goes away, so that the reader can see the end of the file.
+#define IO_COMPLETION_READABLE (1 << 0)
+
+// The associated file may have become writable.
+#define IO_COMPLETION_WRITABLE (1 << 1)
+
+// The maximum number of entries removed from a completion port at once.
+#define IO_COMPLETION_MAX_ENTRIES (64)
+
 // The operation may not block.  If a situation arises where this operation would block, it is immediately ended.
 #define IO_RW_NONBLOCK         (1 << 0)
 
@@ -41,6 +41,23 @@ enum
 	THREAD_STATUS_TERMINATED
 };
 
+// Types of locks tracked by the lock statistics facility.
+enum
+{
+	LOCK_TYPE_SPIN_LOCK,
+	LOCK_TYPE_MUTEX,
+	LOCK_TYPE_RW_LOCK_EXCLUSIVE,
+	LOCK_TYPE_RW_LOCK_SHARED,
+};
+
+// Types of routines tracked by the DPC statistics facility.
+enum
+{
+	DPC_STAT_TYPE_DPC,
+	DPC_STAT_TYPE_THREADED_DPC,
+	DPC_STAT_TYPE_INTERRUPT,
+};
+
 #define VER_MAJOR(vn) ((vn) >> 24)
 #define VER_MINOR(vn) (((vn) >> 16) & 0xFF)
 #define VER_BUILD(vn) (vn & 0xFFFF)
@@ -42,6 +42,11 @@ typedef struct
 	// it should call OSFreeVirtualMemory with MEM_PARTIAL.
 	void* OldInterpreterBase;
 	size_t OldInterpreterSize;
+	
+	// Was the interpreter mapped from the image section cache by OSSpawnProcess?
+	// If so, its pages are already base-relocated, and it must not relocate
+	// itself again.
+	bool InterpreterRelocated;
 }
 LOADER_INFORMATION;
 
@@ -114,3 +119,77 @@ enum
 	FILE_STANDARD_OUTPUT,
 	FILE_STANDARD_ERROR
 };
+
+#define SPAWN_MAX_IMAGES (2)
+#define SPAWN_MAX_VIEWS  (32)
+
+// An image mapped by OSSpawnProcess.
+typedef struct
+{
+	// The file that the image's views are mapped from.
+	HANDLE FileHandle;
+	
+	// The size of the image in memory.  If this is zero, the image's views
+	// are mapped at their absolute addresses.  Otherwise, a base address is
+	// chosen for the image and its views are relative to it.
+	size_t ImageSize;
+	
+	// This image is the interpreter.  It may be mapped from the image section
+	// cache, in which case the interpreter is told not to relocate itself.
+	bool IsInterpreter;
+}
+SPAWN_IMAGE, *PSPAWN_IMAGE;
+
+// A region of an image mapped by OSSpawnProcess.  This corresponds to an
+// ELF loadable segment.
+typedef struct
+{
+	// The index of the image within SPAWN_PARAMETERS::Images.
+	int Image;
+	
+	int Protection;
+	
+	// The address of the view, relative to the image base.
+	uintptr_t Address;
+	size_t Size;
+	
+	// The offset and size of the view's contents within the file.  The rest
+	// of the view is zero-filled.  If SizeInFile is zero, the view is anonymous.
+	uint64_t Offset;
+	size_t SizeInFile;
+}
+SPAWN_VIEW, *PSPAWN_VIEW;
+
+// Describes the process to create with OSSpawnProcess.
+typedef struct
+{
+	bool InheritHandles;
+	bool DeepCloneHandles;
+	bool CreateSuspended;
+	
+	int ImageCount;
+	SPAWN_IMAGE Images[SPAWN_MAX_IMAGES];
+	
+	int ViewCount;
+	const SPAWN_VIEW* Views;
+	
+	// The main thread starts at this address, relative to the base of the
+	// image with the index EntryImage.
+	int EntryImage;
+	uintptr_t EntryPoint;
+	
+	// The PEB to copy into the new process.  Its string pointers point inside
+	// of this copy, and are rebased to point inside the new process' copy.
+	//
+	// The FileHeader, ProgramHeaders and Interpreter loader pointers are relative
+	// to the base of the first image, and ImageBase is filled in by the kernel.
+	//
+	// Unless the handles are inherited, the standard I/O handles are duplicated
+	// into the new process.
+	const PEB* Peb;
+	size_t PebSize;
+	
+	const char* ImageName;
+	size_t ImageNameLength;
+}
+SPAWN_PARAMETERS, *PSPAWN_PARAMETERS;
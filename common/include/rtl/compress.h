@@ -0,0 +1,70 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	rtl/compress.h
+	
+Abstract:
+	This header file defines function prototypes for the
+	LZ compressor and decompressor.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// The compressed data is a series of sequences.  Each sequence is a token byte, the
+// literal bytes, and a back reference of at least RTL_LZ_MIN_MATCH bytes.  The upper
+// nibble of the token is the literal count, and the lower nibble is the match length
+// minus RTL_LZ_MIN_MATCH.  A nibble of 15 means that more bytes of length follow,
+// each one added to the length, until one isn't 255.  The back reference is a 16-bit
+// little endian offset behind the current output position.  The last sequence has
+// no back reference.
+#define RTL_LZ_MIN_MATCH (4)
+
+// The largest buffer that can be compressed.  Offsets and the positions stored in
+// the hash table are only 16 bits wide.
+#define RTL_LZ_MAX_INPUT_SIZE (65536)
+
+#define RTL_LZ_HASH_BITS (12)
+
+// The work area of the compressor.  This is too large for the stack of a kernel thread.
+// It doesn't need to be initialized, but it can't be shared by two calls at once.
+typedef struct
+{
+	uint16_t HashTable[1 << RTL_LZ_HASH_BITS];
+}
+RTL_LZ_WORKSPACE, *PRTL_LZ_WORKSPACE;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Compresses SourceSize bytes into Destination.  Returns the size of the compressed data,
+// or 0 if it would not fit in DestinationSize bytes.
+size_t RtlCompressBufferLz(
+	void* Destination,
+	size_t DestinationSize,
+	const void* Source,
+	size_t SourceSize,
+	PRTL_LZ_WORKSPACE Workspace
+);
+
+// Decompresses SourceSize bytes of compressed data into Destination.  Returns the size
+// of the decompressed data, or 0 if the compressed data is malformed or would not fit
+// in DestinationSize bytes.
+size_t RtlDecompressBufferLz(
+	void* Destination,
+	size_t DestinationSize,
+	const void* Source,
+	size_t SourceSize
+);
+
+#ifdef __cplusplus
+}
+#endif
@@ -19,6 +19,10 @@ Author:
 typedef void(*PELF_INIT_FUNC)();
 typedef void(*PELF_FINI_FUNC)();
 
+// Kinds of relocations, for RtlPerformSelectedRelocations.
+#define RTL_RELOC_BASE     (1 << 0) // Relative relocations, which only depend on the load base.
+#define RTL_RELOC_SYMBOLIC (1 << 1) // All other relocations.
+
 // Struct not part of the ELF format, but part of the loader.
 typedef struct ELF_DYNAMIC_INFO_tag
 {
@@ -37,6 +41,9 @@ typedef struct ELF_DYNAMIC_INFO_tag
 	PELF_SYMBOL SymbolTable;
 	size_t      SymbolTableSize;
 	PELF_HASH_TABLE HashTable;
+	PELF_GNU_HASH_TABLE GnuHashTable;
+	uintptr_t*      PltGot;
+	bool            BindNow;
 	PELF_INIT_FUNC* InitTable;
 	PELF_FINI_FUNC* FiniTable;
 	size_t          InitTableSize;
@@ -52,6 +59,8 @@ extern "C" {
 
 bool RtlPerformRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase);
 
+bool RtlPerformSelectedRelocations(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, int Kinds);
+
 bool RtlParseDynamicTable(PELF_DYNAMIC_ITEM DynItem, PELF_DYNAMIC_INFO Info, uintptr_t LoadBase);
 
 bool RtlLinkPlt(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, UNUSED const char* FileName);
@@ -64,6 +73,14 @@ void RtlRelocateRelrEntries(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase);
 
 uint32_t RtlElfHash(const char* Name);
 
+uint32_t RtlGnuHash(const char* Name);
+
+PELF_SYMBOL RtlLookUpDynamicSymbol(PELF_DYNAMIC_INFO DynInfo, const char* Name, uint32_t GnuHash);
+
+bool RtlPrepareLazyPlt(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, void* Context, uintptr_t Resolver);
+
+uintptr_t RtlBindLazyPltEntry(PELF_DYNAMIC_INFO DynInfo, uintptr_t LoadBase, size_t Index);
+
 BSTATUS RtlCheckValidity(PELF_HEADER Header);
 
 #ifdef __cplusplus
@@ -35,6 +35,14 @@ extern const KSYMBOL KiSymbolTableEnd[];
 
 #define KiSymbolTableSize (KiSymbolTableEnd - KiSymbolTable)
 
+// KiSymbolTable is sorted by address.  KiSymbolHashTable is an open addressed hash
+// table, keyed by the GNU hash of the symbol's name, whose entries are indices into
+// KiSymbolTable plus one.  Zero marks an empty slot.  Its size is a power of two.
+extern const uint32_t KiSymbolHashTable[];
+extern const uint32_t KiSymbolHashTableEnd[];
+
+#define KiSymbolHashTableSize ((size_t)(KiSymbolHashTableEnd - KiSymbolHashTable))
+
 #endif
 
 #endif//BORON_RTL_SYMDEFS_H
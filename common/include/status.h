@@ -102,6 +102,9 @@ enum
 	STATUS_PORT_CLOSED,         // The host closed the port before the client could connect to it.
 	STATUS_MESSAGE_TOO_LONG,    // The message cannot be created because the buffer is too long.
 	
+	// Completion port error codes
+	STATUS_ALREADY_ASSOCIATED,  // The file is already associated with a completion port.
+	
 	STATUS_MAX,
 	
 	// Wait for object(s) error ranges
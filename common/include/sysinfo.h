@@ -40,6 +40,7 @@ typedef struct
 }
 SYSTEM_BASIC_INFORMATION, *PSYSTEM_BASIC_INFORMATION;
 
+// QUERY_THREAD_INFORMATION returns an array of these, one per thread in the system.
 typedef struct
 {
 	short Size;
@@ -47,6 +48,28 @@ typedef struct
 	int Status;
 	
 	uint32_t ParentProcessId;
+	
+	int Priority;
+	int BasePriority;
+	
+	// The processor the thread last ran on, or -1 if it never ran.
+	int LastProcessor;
+	
+	// All times are measured in ticks.  Use OSGetTickFrequency to convert them.
+	uint64_t RunTime;
+	uint64_t WaitTime;
+	
+	// Time spent ready to run, but waiting for a processor.
+	uint64_t ReadyTime;
+	uint64_t MaxReadyLatency;
+	
+	// Voluntary switches happen when the thread blocks.  Involuntary switches
+	// happen when the thread is preempted or yields while still runnable.
+	uint64_t VoluntarySwitches;
+	uint64_t InvoluntarySwitches;
+	
+	// How many times the thread was moved to another processor.
+	uint64_t Migrations;
 }
 SYSTEM_THREAD_INFORMATION, *PSYSTEM_THREAD_INFORMATION;
 
@@ -64,9 +87,20 @@ typedef struct
 	// Information pertaining to the main thread, which is the first thread in the thread list.
 	SYSTEM_THREAD_INFORMATION MainThread;
 	
+	// The number of pages mapped in the process, as of the last time the working
+	// set manager looked at it, and the highest that number has been.
+	size_t WorkingSetPages;
+	size_t PeakWorkingSetPages;
+	
+	// The total number of page faults taken, and pages trimmed, on the process.
+	uint64_t PageFaultCount;
+	uint64_t TrimmedPages;
+	
 	// TODO: add more members here
 	
 	char ImageName[SPI_MAX_IMAGE_NAME];
+	
+	int ThreadCount;
 }
 SYSTEM_PROCESS_INFORMATION, *PSYSTEM_PROCESS_INFORMATION;
 
@@ -79,10 +113,179 @@ typedef struct
 	size_t TotalPhysicalMemoryPages;
 	size_t FreePhysicalMemoryPages;
 	
+	// The size of a huge page, or zero if huge pages aren't used.
+	uint32_t HugePageSize;
+	
+	// The number of huge pages currently mapped.
+	size_t HugePagesInUse;
+	
+	// The number of huge pages mapped so far, the number of times regular
+	// pages were used because no contiguous memory was found, and the
+	// number of huge pages that were split into regular pages.
+	uint64_t HugePageAllocations;
+	uint64_t HugePageFallbacks;
+	uint64_t HugePageSplits;
+	
+	// The number of pages held compressed in memory, and the size of their
+	// compressed data in bytes.
+	size_t CompressedStorePages;
+	size_t CompressedStoreBytes;
+	
+	// The number of pages compressed and decompressed so far, and the number
+	// of pages that didn't compress well enough to be kept compressed.
+	uint64_t PageCompressions;
+	uint64_t PageDecompressions;
+	uint64_t PageCompressionRejections;
+	
+	// The size of the page file and the number of its pages in use, and the
+	// number of pages written to and read back from it so far.
+	size_t PageFileTotalPages;
+	size_t PageFileUsedPages;
+	uint64_t PageFileWrites;
+	uint64_t PageFileReads;
+	
 	// TODO: add more members here.
 }
 SYSTEM_MEMORY_INFORMATION, *PSYSTEM_MEMORY_INFORMATION;
 
+// QUERY_PROCESSOR_INFORMATION returns an array of these, one per processor.
+typedef struct
+{
+	short Size;
+	
+	uint32_t ProcessorId;
+	
+	// The number of ticks spent running threads other than the idle thread.
+	uint64_t BusyTime;
+	
+	uint64_t ContextSwitches;
+	uint64_t WorkSteals;
+	uint64_t IpisReceived;
+	uint64_t DpcsRun;
+	uint64_t Interrupts;
+}
+SYSTEM_PROCESSOR_INFORMATION, *PSYSTEM_PROCESSOR_INFORMATION;
+
+#define LOCK_CALL_SITE_NAME_SIZE (48)
+
+// QUERY_LOCK_INFORMATION returns an array of these, one per lock class.  A lock
+// class is identified by the call site that acquired the lock.  This query is only
+// supported if the kernel was built with lock statistics enabled.
+typedef struct
+{
+	short Size;
+	
+	// The type of lock (LOCK_TYPE_*).
+	short Type;
+	
+	uintptr_t CallSite;
+	
+	// Name of the routine that contains the call site, if known.
+	char CallSiteName[LOCK_CALL_SITE_NAME_SIZE];
+	
+	uint64_t Acquisitions;
+	uint64_t ContendedAcquisitions;
+	
+	// All times are measured in ticks.  Use OSGetTickFrequency to convert them.
+	uint64_t TotalWaitTime;
+	uint64_t MaxWaitTime;
+	
+	// Hold times are not tracked for shared acquisitions of rwlocks.
+	uint64_t TotalHoldTime;
+	uint64_t MaxHoldTime;
+}
+SYSTEM_LOCK_INFORMATION, *PSYSTEM_LOCK_INFORMATION;
+
+#define BOOT_PHASE_NAME_SIZE (32)
+
+// QUERY_BOOT_TRACE_INFORMATION returns an array of these, one per boot phase, in the
+// order in which the phases were started.  Phases may be nested inside each other.
+typedef struct
+{
+	short Size;
+	
+	// The processor on which the phase was started.
+	uint32_t ProcessorId;
+	
+	char Name[BOOT_PHASE_NAME_SIZE];
+	
+	// Both times are tick counts.  Use OSGetTickFrequency to convert them.  If the
+	// phase hasn't finished, EndTime is zero.
+	uint64_t StartTime;
+	uint64_t EndTime;
+}
+SYSTEM_BOOT_TRACE_INFORMATION, *PSYSTEM_BOOT_TRACE_INFORMATION;
+
+#define DPC_ROUTINE_NAME_SIZE (48)
+
+// QUERY_DPC_INFORMATION returns an array of these, one per DPC routine, followed by
+// one per interrupt vector which was serviced.  This query is only supported if the
+// kernel was built with DPC statistics enabled.
+typedef struct
+{
+	short Size;
+	
+	// The type of routine (DPC_STAT_TYPE_*, see kes.h).
+	short Type;
+	
+	// The interrupt vector, or -1 for DPCs.
+	int Vector;
+	
+	// For interrupts, this is the service routine which was last run for the vector.
+	uintptr_t Routine;
+	
+	// Name of the routine, if known.
+	char RoutineName[DPC_ROUTINE_NAME_SIZE];
+	
+	uint64_t Count;
+	
+	// All times are measured in ticks.  Use OSGetTickFrequency to convert them.
+	uint64_t TotalTime;
+	uint64_t MaxTime;
+	
+	// The time between a DPC being enqueued and it starting to run.  Zero for interrupts.
+	uint64_t TotalLatency;
+	uint64_t MaxLatency;
+	
+	// The number of runs which went over the DPC watchdog's budget.
+	uint64_t OverBudgetCount;
+}
+SYSTEM_DPC_INFORMATION, *PSYSTEM_DPC_INFORMATION;
+
+typedef struct
+{
+	uint64_t Allocations;
+	uint64_t Frees;
+	
+	// The number of bytes currently allocated, and the most that were allocated at once.
+	// The kernel counts the peak on each processor separately, so PeakBytes is the sum
+	// of those, which may be higher than the real peak.
+	uint64_t Bytes;
+	uint64_t PeakBytes;
+}
+SYSTEM_POOL_COUNTERS, *PSYSTEM_POOL_COUNTERS;
+
+// QUERY_POOL_TAG_INFORMATION returns an array of these, one per pool tag in use.
+typedef struct
+{
+	short Size;
+	
+	// The four characters of the tag.  This is not null terminated.
+	char Tag[4];
+	
+	// Allocations of whole pages from the big pool.  This includes slab layer allocations
+	// larger than the largest size class, and the pages of the slabs themselves, which are
+	// counted under the "SbIt" tag.
+	SYSTEM_POOL_COUNTERS BigNonPaged;
+	SYSTEM_POOL_COUNTERS BigPaged;
+	
+	// Allocations from the slab layer, counted by the size of their size class.  Allocations
+	// made without a tag are counted under the "None" tag.
+	SYSTEM_POOL_COUNTERS SlabNonPaged;
+	SYSTEM_POOL_COUNTERS SlabPaged;
+}
+SYSTEM_POOL_TAG_INFORMATION, *PSYSTEM_POOL_TAG_INFORMATION;
+
 
 
 
@@ -95,5 +298,10 @@ enum
 	QUERY_MEMORY_INFORMATION,
 	QUERY_PROCESS_INFORMATION,
 	QUERY_THREAD_INFORMATION,
+	QUERY_LOCK_INFORMATION,
+	QUERY_PROCESSOR_INFORMATION,
+	QUERY_BOOT_TRACE_INFORMATION,
+	QUERY_DPC_INFORMATION,
+	QUERY_POOL_TAG_INFORMATION,
 	QUERY_MAXIMUM
 };
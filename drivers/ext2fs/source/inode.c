@@ -398,7 +398,7 @@ BSTATUS Ext2Read(PIO_STATUS_BLOCK Iosb, PFCB Fcb, uint64_t Offset, PMDL MdlBuffe
 		Size = FileSize - Offset;
 	
 	// TODO: A better way?
-	uint8_t* BlockBuffer = MmAllocatePool(POOL_NONPAGED, FileSystem->BlockSize);
+	uint8_t* BlockBuffer = MmAllocatePoolWithTag(POOL_NONPAGED, FileSystem->BlockSize, POOL_TAG("E2fs"));
 	if (!BlockBuffer)
 		// TODO: Use the builtin one for paging if Flags & PAGING
 		return STATUS_INSUFFICIENT_MEMORY;
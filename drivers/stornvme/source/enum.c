@@ -27,7 +27,7 @@ int DriveNumber; // TODO: Maybe a system wide solution?
 void NvmeInitializeNamespace(PCONTROLLER_EXTENSION ContExtension, uint32_t NamespaceId, const char* ContName)
 {
 	// Send an identification request.
-	void* Memory = MmAllocatePool(POOL_NONPAGED, PAGE_SIZE);
+	void* Memory = MmAllocatePoolWithTag(POOL_NONPAGED, PAGE_SIZE, POOL_TAG("Nvme"));
 	BSTATUS Status = NvmeIdentify(ContExtension, Memory, CNS_NAMESPACE, NamespaceId);
 	if (FAILED(Status))
 		KeCrash("StorNvme TODO: failure to identify namespace id 0x%x on controller %s", NamespaceId, ContName);
@@ -290,7 +290,7 @@ bool NvmePciDeviceEnumerated(PPCI_DEVICE Device, UNUSED void* CallbackContext)
 	);
 	
 	// Send an identification request.
-	PNVME_IDENTIFICATION Ident = MmAllocatePool(POOL_PAGED, PAGE_SIZE);
+	PNVME_IDENTIFICATION Ident = MmAllocatePoolWithTag(POOL_PAGED, PAGE_SIZE, POOL_TAG("Nvme"));
 	memset(Ident, 0, PAGE_SIZE);
 	
 	Status = NvmeIdentify(ContExtension, Ident, CNS_CONTROLLER, 0);
@@ -316,7 +316,7 @@ bool NvmePciDeviceEnumerated(PPCI_DEVICE Device, UNUSED void* CallbackContext)
 	ContExtension->MaximumDataTransferSize = MinPageSize << Ident->MaximumDataTransferSize;
 	
 	// Get namespace list.
-	uint32_t* NamespaceList = MmAllocatePool(POOL_PAGED, PAGE_SIZE);
+	uint32_t* NamespaceList = MmAllocatePoolWithTag(POOL_PAGED, PAGE_SIZE, POOL_TAG("Nvme"));
 	memset(NamespaceList, 0, sizeof NamespaceList);
 	
 	Status = NvmeIdentify(ContExtension, NamespaceList, CNS_NAMESPACELIST, 0);
@@ -343,7 +343,7 @@ bool NvmePciDeviceEnumerated(PPCI_DEVICE Device, UNUSED void* CallbackContext)
 	ContExtension->IoQueueCount = IoQueueCount;
 	
 	size_t AllocSize = sizeof(QUEUE_CONTROL_BLOCK) * IoQueueCount;
-	ContExtension->IoQueues = MmAllocatePool(POOL_NONPAGED, AllocSize);
+	ContExtension->IoQueues = MmAllocatePoolWithTag(POOL_NONPAGED, AllocSize, POOL_TAG("Nvme"));
 	
 	DbgPrint("StorNvme: %s Using %zu I/O queues", Buffer, ContExtension->IoQueueCount);
 	
@@ -21,6 +21,9 @@ Author:
 // Priority boost used when setting events or releasing semaphores.
 #define NVME_PRIORITY_BOOST 1
 
+// Maximum number of completion queue entries handled while holding the queue's lock.
+#define NVME_COMPLETION_BATCH 32
+
 #define CSTS_RDY   (1 << 0) // Ready
 #define CSTS_CFS   (1 << 1) // Controller Fatal Status
 #define CSTS_PP    (1 << 5) // Processing Paused
@@ -19,40 +19,48 @@ static void NvmeDpc(PKDPC Dpc, void* Context, UNUSED void* SystemArgument1, UNUS
 	PQUEUE_CONTROL_BLOCK Qcb = Context;
 	ASSERT(CONTAINING_RECORD(Dpc, QUEUE_CONTROL_BLOCK, Dpc) == Qcb);
 	
-	KIPL Ipl;
-	KeAcquireSpinLock(&Qcb->SpinLock, &Ipl);
-	
 	PNVME_COMPLETION_QUEUE_ENTRY CompletionQueue = Qcb->CompletionQueue.Address;
-	int Count = 0;
+	KIPL Ipl;
+	int Count;
 	
-	while (CompletionQueue[Qcb->CompletionQueue.Index].Status.Phase == Qcb->CompletionQueue.Phase)
+	// The queue is drained in batches, releasing the lock in between, so that
+	// a deep queue doesn't keep the processor at IPL_DPC for the whole drain.
+	do
 	{
-		int SubmissionId = CompletionQueue[Qcb->CompletionQueue.Index].CommandIdentifier;
-		
-		// Copy the completion queue entry.
-		Qcb->Entries[SubmissionId]->Comp = CompletionQueue[Qcb->CompletionQueue.Index];
+		KeAcquireSpinLock(&Qcb->SpinLock, &Ipl);
+		Count = 0;
 		
-		// Set the event.
-		KeSetEvent(Qcb->Entries[SubmissionId]->Event, NVME_PRIORITY_BOOST);
+		while (Count < NVME_COMPLETION_BATCH &&
+		       CompletionQueue[Qcb->CompletionQueue.Index].Status.Phase == Qcb->CompletionQueue.Phase)
+		{
+			int SubmissionId = CompletionQueue[Qcb->CompletionQueue.Index].CommandIdentifier;
+			
+			// Copy the completion queue entry.
+			Qcb->Entries[SubmissionId]->Comp = CompletionQueue[Qcb->CompletionQueue.Index];
+			
+			// Set the event.
+			KeSetEvent(Qcb->Entries[SubmissionId]->Event, NVME_PRIORITY_BOOST);
+			
+			// Clear the entry in the Entries list and release the entry semaphore.
+			ASSERT(SubmissionId >= 0 && SubmissionId < (int)ARRAY_COUNT(Qcb->Entries) && Qcb->Entries[SubmissionId] != NULL);
+			
+			Qcb->Entries[SubmissionId] = NULL;
+			KeReleaseSemaphore(&Qcb->Semaphore, 1, NVME_PRIORITY_BOOST);
+			
+			// Increment the pair's completion queue index in a round fashion.
+			Qcb->CompletionQueue.Index = (Qcb->CompletionQueue.Index + 1) % Qcb->CompletionQueue.EntryCount;
+			if (Qcb->CompletionQueue.Index == 0)
+				Qcb->CompletionQueue.Phase ^= 1;
+			
+			Count++;
+		}
 		
-		// Clear the entry in the Entries list and release the entry semaphore.
-		ASSERT(SubmissionId >= 0 && SubmissionId < (int)ARRAY_COUNT(Qcb->Entries) && Qcb->Entries[SubmissionId] != NULL);
+		if (Count)
+			*Qcb->CompletionQueue.DoorBell = Qcb->CompletionQueue.Index;
 		
-		Qcb->Entries[SubmissionId] = NULL;
-		KeReleaseSemaphore(&Qcb->Semaphore, 1, NVME_PRIORITY_BOOST);
-		
-		// Increment the pair's completion queue index in a round fashion.
-		Qcb->CompletionQueue.Index = (Qcb->CompletionQueue.Index + 1) % Qcb->CompletionQueue.EntryCount;
-		if (Qcb->CompletionQueue.Index == 0)
-			Qcb->CompletionQueue.Phase ^= 1;
-		
-		Count++;
+		KeReleaseSpinLock(&Qcb->SpinLock, Ipl);
 	}
-	
-	if (Count)
-		*Qcb->CompletionQueue.DoorBell = Qcb->CompletionQueue.Index;
-	
-	KeReleaseSpinLock(&Qcb->SpinLock, Ipl);
+	while (Count == NVME_COMPLETION_BATCH);
 }
 
 static void NvmeService(PKINTERRUPT Interrupt, void* Context)
@@ -71,7 +79,9 @@ static void NvmeCreateInterruptForQueue(PQUEUE_CONTROL_BLOCK Qcb, int MsixIndex)
 	if (Vector < 0)
 		ASSERT(Vector >= 0);
 	
-	KeInitializeDpc(&Qcb->Dpc, NvmeDpc, Qcb);
+	// A deep completion queue can take a while to drain, so do it from the
+	// threaded DPC thread, where it doesn't delay the processor's other DPCs.
+	KeInitializeThreadedDpc(&Qcb->Dpc, NvmeDpc, Qcb);
 	
 	KeInitializeInterrupt(
 		&Qcb->Interrupt,
@@ -0,0 +1,648 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	benchtst.c
+	
+Abstract:
+	This module implements the microbenchmarks for the test
+	driver.  They are run instead of the functional tests if
+	the "Benchmark=yes" boot option is specified.
+	
+	The results are printed over the debug port, one per line,
+	in the following format, so that they can be parsed by a
+	script:
+	
+	BENCH-BEGIN version=1 cpus=<n> tick_frequency=<hz>
+	BENCH name=<name> threads=<n> iterations=<n> total_ns=<n> ns_per_op=<n> [min_ns=<n> max_ns=<n>]
+	BENCH-END count=<number of results>
+	
+	The minimum and maximum are only printed by benchmarks that
+	measure the latency of each operation.  New keys may be added
+	to the end of a line, but existing ones will not change their
+	meaning without a change of the version number.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include "utils.h"
+#include <ke.h>
+#include <mm.h>
+#include <ex.h>
+#include <io.h>
+#include <hal.h>
+#include <string.h>
+
+#define BENCH_FORMAT_VERSION (1)
+
+#define BENCH_SPINLOCK_ITERATIONS (100000)
+#define BENCH_MUTEX_ITERATIONS    (20000)
+#define BENCH_WAKE_ITERATIONS     (2000)
+#define BENCH_DPC_ITERATIONS      (10000)
+#define BENCH_APC_ITERATIONS      (10000)
+#define BENCH_POOL_ITERATIONS     (100000)
+#define BENCH_POOL_SPACE_HELD     (1024)
+#define BENCH_HANDLE_ITERATIONS   (10000)
+#define BENCH_PIPE_ITERATIONS     (10000)
+#define BENCH_FAULT_PAGES         (256)
+#define BENCH_FAULT_ROUNDS        (4)
+
+#define BENCH_MAX_THREADS (32)
+
+// The file that is mapped by the file-backed page fault benchmarks.
+// The test driver itself is always there while it's running.
+static const char BenchFaultFile[] = "/InitRoot/test.sys";
+
+typedef struct
+{
+	uint64_t Count;
+	uint64_t Total;
+	uint64_t Min;
+	uint64_t Max;
+}
+BENCH_LATENCY, *PBENCH_LATENCY;
+
+static int BenchResultCount;
+
+static uint64_t BenchTicksToNs(uint64_t Ticks)
+{
+	uint64_t Frequency = HalGetTickFrequency();
+	
+	// Split the multiplication, so that it doesn't overflow for long runs.
+	return Ticks / Frequency * 1000000000ULL + Ticks % Frequency * 1000000000ULL / Frequency;
+}
+
+static void BenchReport(const char* Name, int Threads, uint64_t Operations, uint64_t Ticks)
+{
+	uint64_t Nanoseconds = BenchTicksToNs(Ticks);
+	
+	DbgPrint(
+		"BENCH name=%s threads=%d iterations=%llu total_ns=%llu ns_per_op=%llu",
+		Name,
+		Threads,
+		Operations,
+		Nanoseconds,
+		Nanoseconds / Operations
+	);
+	
+	BenchResultCount++;
+}
+
+static void BenchReportLatency(const char* Name, PBENCH_LATENCY Latency)
+{
+	uint64_t Nanoseconds = BenchTicksToNs(Latency->Total);
+	
+	DbgPrint(
+		"BENCH name=%s threads=1 iterations=%llu total_ns=%llu ns_per_op=%llu min_ns=%llu max_ns=%llu",
+		Name,
+		Latency->Count,
+		Nanoseconds,
+		Nanoseconds / Latency->Count,
+		BenchTicksToNs(Latency->Min),
+		BenchTicksToNs(Latency->Max)
+	);
+	
+	BenchResultCount++;
+}
+
+static void BenchInitializeLatency(PBENCH_LATENCY Latency)
+{
+	Latency->Count = 0;
+	Latency->Total = 0;
+	Latency->Min = UINT64_MAX;
+	Latency->Max = 0;
+}
+
+static void BenchAddLatency(PBENCH_LATENCY Latency, uint64_t Ticks)
+{
+	Latency->Count++;
+	Latency->Total += Ticks;
+	
+	if (Latency->Min > Ticks)
+		Latency->Min = Ticks;
+	if (Latency->Max < Ticks)
+		Latency->Max = Ticks;
+}
+
+#define BenchCheck(Status, What) do {                                         \
+	BSTATUS Status_ = (Status);                                               \
+	if (FAILED(Status_))                                                      \
+		KeCrash("Bench: %s failed: %d (%s)", What, Status_, RtlGetStatusString(Status_)); \
+} while (0)
+
+//
+// Contended lock benchmarks.
+//
+// Each thread acquires and releases the same lock a number of times.  The
+// threads are released at the same time by a start gate, and the time is
+// measured until the last of them is done.  The scheduler decides which
+// processors the threads run on.
+//
+
+typedef void(*BENCH_CONTENTION_ROUTINE)(void);
+
+static KSPIN_LOCK BenchSpinLock;
+static KMUTEX BenchMutex;
+static volatile uint64_t BenchSharedCounter;
+
+static BENCH_CONTENTION_ROUTINE BenchContentionRoutine;
+static int BenchContentionIterations;
+static volatile int BenchThreadsReady;
+static volatile int BenchThreadsRunning;
+static volatile bool BenchStartGate;
+static volatile uint64_t BenchEndTick;
+
+static void BenchSpinLockRoutine()
+{
+	KIPL OldIpl;
+	KeAcquireSpinLock(&BenchSpinLock, &OldIpl);
+	BenchSharedCounter++;
+	KeReleaseSpinLock(&BenchSpinLock, OldIpl);
+}
+
+static void BenchMutexRoutine()
+{
+	KeWaitForSingleObject(&BenchMutex, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	BenchSharedCounter++;
+	KeReleaseMutex(&BenchMutex);
+}
+
+static NO_RETURN void BenchContentionThread(UNUSED void* Parameter)
+{
+	AtAddFetch(BenchThreadsReady, 1);
+	
+	while (!AtLoad(BenchStartGate))
+		KeSpinningHint();
+	
+	for (int i = 0; i < BenchContentionIterations; i++)
+		BenchContentionRoutine();
+	
+	if (AtAddFetch(BenchThreadsRunning, -1) == 0)
+		BenchEndTick = HalGetTickCount();
+	
+	KeTerminateThread(0);
+}
+
+static void BenchRunContention(const char* Name, BENCH_CONTENTION_ROUTINE Routine, int Iterations, int ThreadCount)
+{
+	PKTHREAD Threads[BENCH_MAX_THREADS];
+	
+	BenchContentionRoutine = Routine;
+	BenchContentionIterations = Iterations;
+	BenchSharedCounter = 0;
+	BenchThreadsReady = 0;
+	BenchThreadsRunning = ThreadCount;
+	BenchStartGate = false;
+	
+	for (int i = 0; i < ThreadCount; i++)
+	{
+		Threads[i] = CreateThread(BenchContentionThread, NULL);
+		if (!Threads[i])
+			KeCrash("Bench: Failed to create thread %d for %s", i, Name);
+	}
+	
+	while (AtLoad(BenchThreadsReady) != ThreadCount)
+		KeSpinningHint();
+	
+	uint64_t StartTick = HalGetTickCount();
+	AtStore(BenchStartGate, true);
+	
+	for (int i = 0; i < ThreadCount; i++)
+	{
+		KeWaitForSingleObject(Threads[i], false, TIMEOUT_INFINITE, MODE_KERNEL);
+		ObDereferenceObject(Threads[i]);
+	}
+	
+	if (BenchSharedCounter != (uint64_t) Iterations * ThreadCount)
+		KeCrash("Bench: %s lost updates: %llu, expected %llu", Name, BenchSharedCounter, (uint64_t) Iterations * ThreadCount);
+	
+	BenchReport(Name, ThreadCount, (uint64_t) Iterations * ThreadCount, BenchEndTick - StartTick);
+}
+
+static void BenchContention()
+{
+	int ProcessorCount = KeGetProcessorCount();
+	if (ProcessorCount > BENCH_MAX_THREADS)
+		ProcessorCount = BENCH_MAX_THREADS;
+	
+	KeInitializeSpinLock(&BenchSpinLock);
+	KeInitializeMutex(&BenchMutex, 1);
+	
+	// 1, 2, 4, ... threads, and finally one per processor.
+	for (int ThreadCount = 1; ; ThreadCount *= 2)
+	{
+		if (ThreadCount > ProcessorCount)
+			ThreadCount = ProcessorCount;
+		
+		BenchRunContention("spinlock", BenchSpinLockRoutine, BENCH_SPINLOCK_ITERATIONS, ThreadCount);
+		BenchRunContention("mutex", BenchMutexRoutine, BENCH_MUTEX_ITERATIONS, ThreadCount);
+		
+		if (ThreadCount == ProcessorCount)
+			break;
+	}
+}
+
+//
+// Wake latency benchmark.
+//
+// The time is measured from just before KeSetEvent is called to when the
+// thread waiting on the event starts running again.
+//
+
+static KEVENT BenchWakeEvent;
+static KEVENT BenchAckEvent;
+static volatile uint64_t BenchWakeTick;
+
+static NO_RETURN void BenchWakeThread(UNUSED void* Parameter)
+{
+	for (int i = 0; i < BENCH_WAKE_ITERATIONS; i++)
+	{
+		KeWaitForSingleObject(&BenchWakeEvent, false, TIMEOUT_INFINITE, MODE_KERNEL);
+		BenchWakeTick = HalGetTickCount();
+		KeSetEvent(&BenchAckEvent, 1);
+	}
+	
+	KeTerminateThread(0);
+}
+
+static void BenchWakeLatency()
+{
+	BENCH_LATENCY Latency;
+	BenchInitializeLatency(&Latency);
+	
+	KeInitializeEvent(&BenchWakeEvent, EVENT_SYNCHRONIZATION, false);
+	KeInitializeEvent(&BenchAckEvent, EVENT_SYNCHRONIZATION, false);
+	
+	PKTHREAD Thread = CreateThread(BenchWakeThread, NULL);
+	if (!Thread)
+		KeCrash("Bench: Failed to create the wake latency thread");
+	
+	// Let it start waiting first.
+	PerformDelay(10, NULL);
+	
+	for (int i = 0; i < BENCH_WAKE_ITERATIONS; i++)
+	{
+		uint64_t StartTick = HalGetTickCount();
+		KeSetEvent(&BenchWakeEvent, 1);
+		KeWaitForSingleObject(&BenchAckEvent, false, TIMEOUT_INFINITE, MODE_KERNEL);
+		
+		BenchAddLatency(&Latency, BenchWakeTick - StartTick);
+	}
+	
+	KeWaitForSingleObject(Thread, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ObDereferenceObject(Thread);
+	
+	BenchReportLatency("event_wake", &Latency);
+}
+
+//
+// DPC and APC delivery latency benchmarks.
+//
+// The time is measured from just before the DPC or APC is enqueued to
+// when its routine starts running.
+//
+
+static volatile uint64_t BenchDeliveryTick;
+
+static void BenchDpcRoutine(UNUSED PKDPC Dpc, UNUSED void* Context, UNUSED void* SA1, UNUSED void* SA2)
+{
+	AtStore(BenchDeliveryTick, HalGetTickCount());
+}
+
+static void BenchApcRoutine(UNUSED PKAPC Apc, UNUSED PKAPC_NORMAL_ROUTINE* R, UNUSED void** A, UNUSED void** B, UNUSED void** C)
+{
+	AtStore(BenchDeliveryTick, HalGetTickCount());
+}
+
+static void BenchDpcLatency()
+{
+	BENCH_LATENCY Latency;
+	BenchInitializeLatency(&Latency);
+	
+	KDPC Dpc;
+	KeInitializeDpc(&Dpc, BenchDpcRoutine, NULL);
+	
+	for (int i = 0; i < BENCH_DPC_ITERATIONS; i++)
+	{
+		AtStore(BenchDeliveryTick, 0);
+		
+		uint64_t StartTick = HalGetTickCount();
+		KeEnqueueDpc(&Dpc, NULL, NULL);
+		
+		while (AtLoad(BenchDeliveryTick) == 0)
+			KeSpinningHint();
+		
+		BenchAddLatency(&Latency, BenchDeliveryTick - StartTick);
+	}
+	
+	BenchReportLatency("dpc_delivery", &Latency);
+}
+
+static void BenchApcLatency()
+{
+	BENCH_LATENCY Latency;
+	BenchInitializeLatency(&Latency);
+	
+	KAPC Apc;
+	
+	for (int i = 0; i < BENCH_APC_ITERATIONS; i++)
+	{
+		AtStore(BenchDeliveryTick, 0);
+		KeInitializeApc(&Apc, KeGetCurrentThread(), BenchApcRoutine, NULL, NULL, MODE_KERNEL);
+		
+		uint64_t StartTick = HalGetTickCount();
+		if (!KeInsertQueueApc(&Apc, NULL, NULL, 0))
+			KeCrash("Bench: Failed to enqueue APC");
+		
+		while (AtLoad(BenchDeliveryTick) == 0)
+			KeSpinningHint();
+		
+		BenchAddLatency(&Latency, BenchDeliveryTick - StartTick);
+	}
+	
+	BenchReportLatency("apc_delivery", &Latency);
+}
+
+//
+// Page fault benchmarks.
+//
+// Every page of a fresh view is touched once, so each access takes exactly
+// one fault.  The copy-on-write benchmark reads each page first, so only the
+// cost of making the private copy is measured.
+//
+
+static void BenchTouchPages(void* Address, size_t PageCount, bool Write)
+{
+	volatile uint8_t* Bytes = Address;
+	
+	for (size_t i = 0; i < PageCount; i++)
+	{
+		if (Write)
+			Bytes[i * PAGE_SIZE] = (uint8_t) i;
+		else
+			(void) Bytes[i * PAGE_SIZE];
+	}
+}
+
+static void BenchAnonymousFaults()
+{
+	uint64_t Ticks = 0;
+	
+	for (int Round = 0; Round < BENCH_FAULT_ROUNDS; Round++)
+	{
+		void* Address = NULL;
+		size_t RegionSize = BENCH_FAULT_PAGES * PAGE_SIZE;
+		
+		BenchCheck(
+			OSAllocateVirtualMemory(CURRENT_PROCESS_HANDLE, &Address, &RegionSize, MEM_RESERVE | MEM_COMMIT, PAGE_READ | PAGE_WRITE),
+			"OSAllocateVirtualMemory"
+		);
+		
+		uint64_t StartTick = HalGetTickCount();
+		BenchTouchPages(Address, BENCH_FAULT_PAGES, true);
+		Ticks += HalGetTickCount() - StartTick;
+		
+		BenchCheck(OSFreeVirtualMemory(CURRENT_PROCESS_HANDLE, Address, RegionSize, MEM_RELEASE), "OSFreeVirtualMemory");
+	}
+	
+	BenchReport("fault_anonymous", 1, BENCH_FAULT_ROUNDS * BENCH_FAULT_PAGES, Ticks);
+}
+
+static void BenchFileFaults(bool CopyOnWrite)
+{
+	HANDLE FileHandle;
+	OBJECT_ATTRIBUTES ObjectAttributes;
+	ObjectAttributes.RootDirectory = HANDLE_NONE;
+	ObjectAttributes.ObjectName = BenchFaultFile;
+	ObjectAttributes.ObjectNameLength = sizeof(BenchFaultFile) - 1;
+	
+	BenchCheck(OSOpenFile(&FileHandle, &ObjectAttributes), "OSOpenFile");
+	
+	uint64_t Length = 0;
+	BenchCheck(OSGetLengthFile(FileHandle, &Length), "OSGetLengthFile");
+	
+	size_t PageCount = Length / PAGE_SIZE;
+	if (PageCount > BENCH_FAULT_PAGES)
+		PageCount = BENCH_FAULT_PAGES;
+	
+	if (PageCount == 0)
+	{
+		LogMsg("Bench: %s is too small to map, skipping file-backed faults.", BenchFaultFile);
+		OSClose(FileHandle);
+		return;
+	}
+	
+	int AllocationType = MEM_TOP_DOWN;
+	int Protection = PAGE_READ;
+	if (CopyOnWrite)
+	{
+		AllocationType |= MEM_COW;
+		Protection |= PAGE_WRITE;
+	}
+	
+	uint64_t Ticks = 0;
+	
+	for (int Round = 0; Round < BENCH_FAULT_ROUNDS; Round++)
+	{
+		void* Address = NULL;
+		size_t RegionSize = PageCount * PAGE_SIZE;
+		
+		BenchCheck(MmMapViewOfObject(FileHandle, &Address, RegionSize, AllocationType, 0, Protection), "MmMapViewOfObject");
+		
+		if (CopyOnWrite)
+			BenchTouchPages(Address, PageCount, false);
+		
+		uint64_t StartTick = HalGetTickCount();
+		BenchTouchPages(Address, PageCount, CopyOnWrite);
+		Ticks += HalGetTickCount() - StartTick;
+		
+		BenchCheck(OSFreeVirtualMemory(CURRENT_PROCESS_HANDLE, Address, RegionSize, MEM_RELEASE), "OSFreeVirtualMemory");
+	}
+	
+	BenchReport(CopyOnWrite ? "fault_cow" : "fault_file", 1, BENCH_FAULT_ROUNDS * PageCount, Ticks);
+	OSClose(FileHandle);
+}
+
+//
+// Pool allocation benchmark.
+//
+
+static void BenchPool()
+{
+	static const size_t Sizes[] = { 16, 64, 256, 1024, 4096 };
+	char Name[32];
+	
+	for (size_t i = 0; i < ARRAY_COUNT(Sizes); i++)
+	{
+		uint64_t StartTick = HalGetTickCount();
+		
+		for (int j = 0; j < BENCH_POOL_ITERATIONS; j++)
+		{
+			void* Memory = MmAllocatePool(POOL_NONPAGED, Sizes[i]);
+			if (!Memory)
+				KeCrash("Bench: Failed to allocate %zu bytes from pool", Sizes[i]);
+			
+			MmFreePool(Memory);
+		}
+		
+		snprintf(Name, sizeof Name, "pool_%zu", Sizes[i]);
+		BenchReport(Name, 1, BENCH_POOL_ITERATIONS, HalGetTickCount() - StartTick);
+	}
+}
+
+//
+// Pool space benchmark.  Reserves and frees pool address space, without
+// mapping anything into it, while the pool is fragmented by many other
+// reservations of various sizes.
+//
+
+static void BenchPoolSpace()
+{
+	static const size_t PageCounts[] = { 1, 3, 16, 64 };
+	char Name[32];
+	
+	void** Held = MmAllocatePool(POOL_NONPAGED, sizeof(void*) * BENCH_POOL_SPACE_HELD);
+	if (!Held)
+		KeCrash("Bench: Failed to allocate the held pool space array");
+	
+	// Fragment the pool by reserving ranges and then freeing every other one.
+	for (int i = 0; i < BENCH_POOL_SPACE_HELD; i++)
+	{
+		Held[i] = MmAllocatePoolBig(POOL_FLAG_CALLER_CONTROLLED, 1 + (i * 7) % 32, POOL_TAG("BnPs"));
+		if (!Held[i])
+			KeCrash("Bench: Failed to reserve pool space");
+	}
+	
+	for (int i = 0; i < BENCH_POOL_SPACE_HELD; i += 2)
+	{
+		MmFreePoolBig(Held[i]);
+		Held[i] = NULL;
+	}
+	
+	for (size_t i = 0; i < ARRAY_COUNT(PageCounts); i++)
+	{
+		uint64_t StartTick = HalGetTickCount();
+		
+		for (int j = 0; j < BENCH_POOL_ITERATIONS; j++)
+		{
+			void* Memory = MmAllocatePoolBig(POOL_FLAG_CALLER_CONTROLLED, PageCounts[i], POOL_TAG("BnPs"));
+			if (!Memory)
+				KeCrash("Bench: Failed to reserve %zu pages of pool space", PageCounts[i]);
+			
+			MmFreePoolBig(Memory);
+		}
+		
+		snprintf(Name, sizeof Name, "pool_space_%zu", PageCounts[i]);
+		BenchReport(Name, 1, BENCH_POOL_ITERATIONS, HalGetTickCount() - StartTick);
+	}
+	
+	for (int i = 0; i < BENCH_POOL_SPACE_HELD; i++)
+	{
+		if (Held[i])
+			MmFreePoolBig(Held[i]);
+	}
+	
+	MmFreePool(Held);
+}
+
+//
+// Handle benchmark.  Creates, looks up and closes event handles.
+//
+
+static void BenchHandles()
+{
+	HANDLE* Handles = MmAllocatePool(POOL_NONPAGED, sizeof(HANDLE) * BENCH_HANDLE_ITERATIONS);
+	if (!Handles)
+		KeCrash("Bench: Failed to allocate the handle array");
+	
+	uint64_t StartTick = HalGetTickCount();
+	for (int i = 0; i < BENCH_HANDLE_ITERATIONS; i++)
+		BenchCheck(OSCreateEvent(&Handles[i], NULL, EVENT_NOTIFICATION, false), "OSCreateEvent");
+	
+	BenchReport("handle_create", 1, BENCH_HANDLE_ITERATIONS, HalGetTickCount() - StartTick);
+	
+	StartTick = HalGetTickCount();
+	for (int i = 0; i < BENCH_HANDLE_ITERATIONS; i++)
+	{
+		void* Object;
+		BenchCheck(ObReferenceObjectByHandle(Handles[i], NULL, &Object), "ObReferenceObjectByHandle");
+		ObDereferenceObject(Object);
+	}
+	
+	BenchReport("handle_lookup", 1, BENCH_HANDLE_ITERATIONS, HalGetTickCount() - StartTick);
+	
+	StartTick = HalGetTickCount();
+	for (int i = 0; i < BENCH_HANDLE_ITERATIONS; i++)
+		BenchCheck(OSClose(Handles[i]), "OSClose");
+	
+	BenchReport("handle_close", 1, BENCH_HANDLE_ITERATIONS, HalGetTickCount() - StartTick);
+	
+	MmFreePool(Handles);
+}
+
+//
+// Pipe benchmark.  Writes a message into a pipe and reads it back.
+//
+
+static void BenchPipe()
+{
+	static const size_t Sizes[] = { 64, 4096 };
+	static uint8_t Buffer[4096];
+	char Name[32];
+	
+	HANDLE Handle;
+	IO_STATUS_BLOCK Iosb;
+	
+	BenchCheck(OSCreatePipe(&Handle, NULL, sizeof Buffer), "OSCreatePipe");
+	
+	for (size_t i = 0; i < ARRAY_COUNT(Sizes); i++)
+	{
+		uint64_t StartTick = HalGetTickCount();
+		
+		for (int j = 0; j < BENCH_PIPE_ITERATIONS; j++)
+		{
+			BenchCheck(OSWriteFile(&Iosb, Handle, 0, Buffer, Sizes[i], 0, NULL), "OSWriteFile");
+			BenchCheck(OSReadFile(&Iosb, Handle, 0, Buffer, Sizes[i], 0), "OSReadFile");
+			
+			if (Iosb.BytesRead != Sizes[i])
+				KeCrash("Bench: Short pipe read: %zu, expected %zu", (size_t) Iosb.BytesRead, Sizes[i]);
+		}
+		
+		snprintf(Name, sizeof Name, "pipe_roundtrip_%zu", Sizes[i]);
+		BenchReport(Name, 1, BENCH_PIPE_ITERATIONS, HalGetTickCount() - StartTick);
+	}
+	
+	OSClose(Handle);
+}
+
+void PerformBenchmarkTest()
+{
+	LogMsg("Bench: Performing delay so everything calms down");
+	PerformDelay(2000, NULL);
+	
+	LogMsg("Bench: Running benchmarks.  The results are printed over the debug port.");
+	
+	BenchResultCount = 0;
+	DbgPrint(
+		"BENCH-BEGIN version=%d cpus=%d tick_frequency=%llu",
+		BENCH_FORMAT_VERSION,
+		KeGetProcessorCount(),
+		HalGetTickFrequency()
+	);
+	
+	BenchContention();
+	BenchWakeLatency();
+	BenchDpcLatency();
+	BenchApcLatency();
+	BenchAnonymousFaults();
+	BenchFileFaults(false);
+	BenchFileFaults(true);
+	BenchPool();
+	BenchPoolSpace();
+	BenchHandles();
+	BenchPipe();
+	
+	DbgPrint("BENCH-END count=%d", BenchResultCount);
+	LogMsg("Bench: Done, %d results.", BenchResultCount);
+}
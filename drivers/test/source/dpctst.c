@@ -0,0 +1,73 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	dpctst.c
+	
+Abstract:
+	This module implements the targeted and threaded DPC test
+	for the test driver.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <ke.h>
+#include "utils.h"
+
+typedef struct
+{
+	KDPC Dpc;
+	KEVENT Event;
+	int Processor;
+	KIPL Ipl;
+}
+DPC_TEST_CONTEXT, *PDPC_TEST_CONTEXT;
+
+static void DpcTestRoutine(UNUSED PKDPC Dpc, void* Context, UNUSED void* SA1, UNUSED void* SA2)
+{
+	PDPC_TEST_CONTEXT TestContext = Context;
+	
+	TestContext->Processor = KeGetCurrentPRCB()->Id;
+	TestContext->Ipl = KeGetIPL();
+	
+	KeSetEvent(&TestContext->Event, 1);
+}
+
+static void DpcTestOne(int Processor, bool Threaded)
+{
+	DPC_TEST_CONTEXT Context;
+	
+	if (Threaded)
+		KeInitializeThreadedDpc(&Context.Dpc, DpcTestRoutine, &Context);
+	else
+		KeInitializeDpc(&Context.Dpc, DpcTestRoutine, &Context);
+	
+	KeInitializeEvent(&Context.Event, EVENT_NOTIFICATION, false);
+	KeSetTargetProcessorDpc(&Context.Dpc, Processor);
+	Context.Processor = -1;
+	
+	KeEnqueueDpc(&Context.Dpc, NULL, NULL);
+	
+	BSTATUS Status = KeWaitForSingleObject(&Context.Event, false, 5000, MODE_KERNEL);
+	if (Status != STATUS_SUCCESS)
+		KeCrash("Dpc: %s DPC targeted at processor %d never ran", Threaded ? "Threaded" : "Regular", Processor);
+	
+	if (Context.Processor != Processor)
+		KeCrash("Dpc: DPC targeted at processor %d ran on processor %d", Processor, Context.Processor);
+	
+	KIPL ExpectedIpl = Threaded ? IPL_NORMAL : IPL_DPC;
+	if (Context.Ipl != ExpectedIpl)
+		KeCrash("Dpc: DPC ran at IPL %d, expected %d", Context.Ipl, ExpectedIpl);
+}
+
+void PerformDpcTest()
+{
+	for (int i = 0; i < KeGetProcessorCount(); i++)
+	{
+		DpcTestOne(i, false);
+		DpcTestOne(i, true);
+	}
+	
+	LogMsg("Dpc: Targeted and threaded DPCs ran on all %d processors.", KeGetProcessorCount());
+}
@@ -15,6 +15,7 @@ Author:
 #include "utils.h"
 #include "tests.h"
 #include <ps.h>
+#include <ex.h>
 #include <string.h>
 
 PKTHREAD CreateThread(PKTHREAD_START StartRoutine, void* Parameter)
@@ -82,6 +83,12 @@ void DumpHex(void* DataV, size_t DataSize, bool LogScreen)
 
 NO_RETURN void DriverTestThread(UNUSED void* Parameter)
 {
+	if (ExIsConfigValue("Benchmark", CONFIG_YES))
+	{
+		PerformBenchmarkTest();
+		KeTerminateThread(0);
+	}
+	
 	//PerformProcessTest();
 	//PerformMutexTest();
 	//PerformBallTest();
@@ -104,6 +111,8 @@ NO_RETURN void DriverTestThread(UNUSED void* Parameter)
 	//PerformFs1Test();
 	//PerformPipeTest();
 	//PerformTwoThreadsTest();
+	//PerformWorkQueueTest();
+	//PerformDpcTest();
 	
 	LogMsg(ANSI_GREEN "*** All tests have concluded." ANSI_RESET);
 	KeTerminateThread(0);
@@ -15,9 +15,82 @@ Author:
 #include <ob.h>
 #include <ex.h>
 #include <string.h>
+#include "utils.h"
 
 uint8_t SomeData[4096];
 
+#define DIRECT_PIPE_SIZE  (1024)
+#define DIRECT_DATA_SIZE  (64 * 1024)
+#define DIRECT_WRITE_SIZE (16 * 1024)
+#define DIRECT_READ_SIZE  (5000)
+
+static uint8_t DirectData[DIRECT_DATA_SIZE];
+static uint8_t DirectReadBuffer[DIRECT_DATA_SIZE];
+
+static NO_RETURN void PipeDirectWriterThread(void* Context)
+{
+	PFILE_OBJECT FileObject = Context;
+	IO_STATUS_BLOCK Iosb;
+	
+	for (size_t Offset = 0; Offset < DIRECT_DATA_SIZE; Offset += DIRECT_WRITE_SIZE)
+	{
+		BSTATUS Status = IoWriteFile(&Iosb, FileObject, DirectData + Offset, DIRECT_WRITE_SIZE, 0, 0, false);
+		if (FAILED(Status))
+			KeCrash("Pipe: Direct write at %zu failed: %d (%s)", Offset, Status, RtlGetStatusString(Status));
+	}
+	
+	KeTerminateThread(0);
+}
+
+// Writes which don't fit into the pipe are handed to the reader directly.  The
+// pipe object is created from the kernel, so it has two owners (the FCB reference
+// and the file object), and therefore, it blocks instead of returning end of file.
+static void PerformPipeDirectTest()
+{
+	PFILE_OBJECT FileObject;
+	PFCB Fcb;
+	IO_STATUS_BLOCK Iosb;
+	
+	for (size_t i = 0; i < DIRECT_DATA_SIZE; i++)
+		DirectData[i] = (uint8_t)(i * 7 + i / 4096);
+	
+	BSTATUS Status = IoCreatePipeObject(&FileObject, &Fcb, NULL, DIRECT_PIPE_SIZE);
+	if (FAILED(Status))
+		KeCrash("Pipe: Failed to create pipe object: %d (%s)", Status, RtlGetStatusString(Status));
+	
+	PKTHREAD Thread = CreateThread(PipeDirectWriterThread, FileObject);
+	if (!Thread)
+		KeCrash("Pipe: Failed to create writer thread");
+	
+	// Read in sizes which don't line up with the writes, and switch between waiting
+	// for the whole read and taking whatever is there.
+	size_t Offset = 0;
+	for (int i = 0; Offset < DIRECT_DATA_SIZE; i++)
+	{
+		size_t ReadSize = DIRECT_READ_SIZE;
+		if (ReadSize > DIRECT_DATA_SIZE - Offset)
+			ReadSize = DIRECT_DATA_SIZE - Offset;
+		
+		uint32_t Flags = (i & 1) ? IO_RW_NONBLOCK_UNLESS_EMPTY : 0;
+		Status = IoReadFile(&Iosb, FileObject, DirectReadBuffer + Offset, ReadSize, Flags, 0, false);
+		if (IOFAILED(Status) || Iosb.BytesRead == 0)
+			KeCrash("Pipe: Direct read at %zu failed: %d (%s)", Offset, Status, RtlGetStatusString(Status));
+		
+		Offset += Iosb.BytesRead;
+	}
+	
+	KeWaitForSingleObject(Thread, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	ObDereferenceObject(Thread);
+	
+	if (memcmp(DirectReadBuffer, DirectData, DIRECT_DATA_SIZE) != 0)
+		KeCrash("Pipe: Data passed directly through the pipe was corrupted!");
+	
+	LogMsg("Pipe: Direct transfer of %d bytes succeeded.", DIRECT_DATA_SIZE);
+	
+	ObDereferenceObject(FileObject);
+	IoDereferenceFcb(Fcb);
+}
+
 void PerformPipeTest()
 {
 	HANDLE Handle;
@@ -84,9 +157,12 @@ void PerformPipeTest()
 		);
 	}
 	
-	LogMsg("Pipe: Test finished. Closing handle.");
+	LogMsg("Pipe: Closing handle.");
 	Status = OSClose(Handle);
 	if (FAILED(Status))
 		KeCrash("Pipe: Failed to close handle: %d (%s)", Status, RtlGetStatusString(Status));
+	
+	PerformPipeDirectTest();
+	LogMsg("Pipe: Test finished.");
 }
 
@@ -36,3 +36,6 @@ void PerformMm5Test(void);
 void PerformFs1Test(void);
 void PerformPipeTest(void);
 void PerformTwoThreadsTest(void);
+void PerformBenchmarkTest(void);
+void PerformWorkQueueTest(void);
+void PerformDpcTest(void);
@@ -0,0 +1,119 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	worktst.c
+	
+Abstract:
+	This module implements the executive work queue test for
+	the test driver.
+	
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <ex.h>
+#include <hal.h>
+#include <string.h>
+#include "utils.h"
+
+#define WORK_ITEMS_PER_POOL (16)
+#define WORK_MAX_PROCESSORS (16)
+
+typedef struct
+{
+	EX_WORK_ITEM WorkItem;
+	int Processor;
+}
+WORK_TEST_ITEM, *PWORK_TEST_ITEM;
+
+static WORK_TEST_ITEM WorkItems[WORK_MAX_PROCESSORS][WORK_QUEUE_COUNT][WORK_ITEMS_PER_POOL];
+static int WorkItemsLeft;
+static KEVENT WorkDoneEvent;
+
+static void WorkTestRoutine(void* Context)
+{
+	PWORK_TEST_ITEM Item = Context;
+	
+	if (KeGetIPL() != IPL_NORMAL)
+		KeCrash("Work: Routine called at IPL %d", KeGetIPL());
+	
+	if (KeGetCurrentPRCB()->Id != Item->Processor)
+		KeCrash("Work: Item for processor %d ran on processor %d", Item->Processor, KeGetCurrentPRCB()->Id);
+	
+	if (AtAddFetch(WorkItemsLeft, -1) == 0)
+		KeSetEvent(&WorkDoneEvent, 1);
+}
+
+// Queues items to every pool of every processor, and checks that each one runs
+// on the processor it was queued to.
+static void PerformWorkPoolTest()
+{
+	int ProcessorCount = KeGetProcessorCount();
+	if (ProcessorCount > WORK_MAX_PROCESSORS)
+		ProcessorCount = WORK_MAX_PROCESSORS;
+	
+	KeInitializeEvent(&WorkDoneEvent, EVENT_NOTIFICATION, false);
+	WorkItemsLeft = ProcessorCount * WORK_QUEUE_COUNT * WORK_ITEMS_PER_POOL;
+	
+	for (int Processor = 0; Processor < ProcessorCount; Processor++)
+	{
+		for (int Type = 0; Type < WORK_QUEUE_COUNT; Type++)
+		{
+			for (int i = 0; i < WORK_ITEMS_PER_POOL; i++)
+			{
+				PWORK_TEST_ITEM Item = &WorkItems[Processor][Type][i];
+				Item->Processor = Processor;
+				ExInitializeWorkItem(&Item->WorkItem, WorkTestRoutine, Item);
+				ExQueueWorkItemProcessor(&Item->WorkItem, Type, Processor);
+			}
+		}
+	}
+	
+	BSTATUS Status = KeWaitForSingleObject(&WorkDoneEvent, false, 10000, MODE_KERNEL);
+	if (Status != STATUS_SUCCESS)
+		KeCrash("Work: Items did not finish: %d left", AtLoad(WorkItemsLeft));
+	
+	LogMsg("Work: All %d items ran on their processors.", ProcessorCount * WORK_QUEUE_COUNT * WORK_ITEMS_PER_POOL);
+}
+
+static KEVENT WorkBlockEvent;
+static EX_WORK_ITEM WorkBlockItem, WorkUnblockItem;
+
+static void WorkBlockRoutine(UNUSED void* Context)
+{
+	KeWaitForSingleObject(&WorkBlockEvent, false, TIMEOUT_INFINITE, MODE_KERNEL);
+	KeSetEvent(&WorkDoneEvent, 1);
+}
+
+static void WorkUnblockRoutine(UNUSED void* Context)
+{
+	KeSetEvent(&WorkBlockEvent, 1);
+}
+
+// The first item blocks until the second one runs.  Because both are queued to
+// the same pool, this only finishes if the pool grows a worker.
+static void PerformWorkGrowthTest()
+{
+	KeInitializeEvent(&WorkDoneEvent, EVENT_NOTIFICATION, false);
+	KeInitializeEvent(&WorkBlockEvent, EVENT_NOTIFICATION, false);
+	
+	ExInitializeWorkItem(&WorkBlockItem, WorkBlockRoutine, NULL);
+	ExInitializeWorkItem(&WorkUnblockItem, WorkUnblockRoutine, NULL);
+	
+	ExQueueWorkItemProcessor(&WorkBlockItem, WORK_QUEUE_DELAYED, 0);
+	ExQueueWorkItemProcessor(&WorkUnblockItem, WORK_QUEUE_DELAYED, 0);
+	
+	uint64_t Start = HalGetTickCount();
+	BSTATUS Status = KeWaitForSingleObject(&WorkDoneEvent, false, 10000, MODE_KERNEL);
+	if (Status != STATUS_SUCCESS)
+		KeCrash("Work: The pool did not grow while its worker was blocked");
+	
+	LogMsg("Work: The pool grew in %llu ms.", (HalGetTickCount() - Start) * 1000 / HalGetTickFrequency());
+}
+
+void PerformWorkQueueTest()
+{
+	PerformWorkPoolTest();
+	PerformWorkGrowthTest();
+}
@@ -170,7 +170,7 @@ BSTATUS TmpResize(PFCB Fcb, uint64_t NewLength)
 			NewPageListCount = NewNewPLC;
 		}
 		
-		PMMPFN NewPageList = MmAllocatePool(POOL_NONPAGED, sizeof(MMPFN) * NewPageListCount);
+		PMMPFN NewPageList = MmAllocatePoolWithTag(POOL_NONPAGED, sizeof(MMPFN) * NewPageListCount, POOL_TAG("Tmfs"));
 		if (!NewPageList)
 		{
 			Fcb->FileLength = OldLength;
@@ -206,7 +206,7 @@ BSTATUS TmpResize(PFCB Fcb, uint64_t NewLength)
 	{
 		// Try and shrink it.
 		size_t NewPageListCount = (size_t) LengthPages;
-		PMMPFN NewPageList = MmAllocatePool(POOL_NONPAGED, sizeof(MMPFN) * NewPageListCount);
+		PMMPFN NewPageList = MmAllocatePoolWithTag(POOL_NONPAGED, sizeof(MMPFN) * NewPageListCount, POOL_TAG("Tmfs"));
 		if (!NewPageList)
 		{
 			// Can't reduce the size of the page list, but this is a non-fatal error.
@@ -567,7 +567,7 @@ BSTATUS TmpMakeHardLink(PFCB Fcb, PIO_DIRECTORY_ENTRY NewName, PFCB DestFcb)
 	if (Fcb->FileType != FILE_TYPE_DIRECTORY)
 		return STATUS_NOT_A_DIRECTORY;
 	
-	PTMPFS_DIR_ENTRY DirEntry = MmAllocatePool(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY));
+	PTMPFS_DIR_ENTRY DirEntry = MmAllocatePoolWithTag(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY), POOL_TAG("Tmfs"));
 	if (!DirEntry)
 		return STATUS_INSUFFICIENT_MEMORY;
 	
@@ -651,7 +651,7 @@ BSTATUS TmpCreateFile(PFILE_OBJECT* OutFileObject, void* InitialAddress, size_t
 		TmpReferenceFcb(ParentFcb);
 		TmpReferenceFcb(Fcb);
 		
-		DirEntry = MmAllocatePool(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY));
+		DirEntry = MmAllocatePoolWithTag(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY), POOL_TAG("Tmfs"));
 		if (!DirEntry)
 		{
 			TmpDereferenceFcb(ParentFcb);
@@ -684,8 +684,8 @@ BSTATUS TmpCreateFile(PFILE_OBJECT* OutFileObject, void* InitialAddress, size_t
 		
 		PTMPFS_DIR_ENTRY DotDirEntry, DotDotDirEntry;
 		
-		DotDirEntry = MmAllocatePool(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY));
-		DotDotDirEntry = MmAllocatePool(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY));
+		DotDirEntry = MmAllocatePoolWithTag(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY), POOL_TAG("Tmfs"));
+		DotDotDirEntry = MmAllocatePoolWithTag(POOL_NONPAGED, sizeof(TMPFS_DIR_ENTRY), POOL_TAG("Tmfs"));
 		
 		if (!DotDirEntry || !DotDotDirEntry)
 		{
@@ -0,0 +1,63 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	hostsup.h
+
+Abstract:
+	This header file provides forward declarations for the
+	services that the host test harness gets from the host
+	operating system.
+
+	It only uses freestanding headers, so that it can be
+	included both by the hosted parts of the harness and by
+	code compiled against the Boron headers.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+
+typedef void(*PHOST_THREAD_START)(void* Context);
+
+// Prints a line to the standard output.
+void HostPrintf(const char* Format, ...);
+void HostVPrintf(const char* Format, va_list ArgList);
+
+// Prints a message and terminates the harness with a failure status.
+__attribute__((noreturn))
+void HostAbort(const char* Format, ...);
+
+// Gets the value of a monotonic counter, and the number of times it
+// increments per second.
+uint64_t HostGetTickCount(void);
+uint64_t HostGetTickFrequency(void);
+
+// Allocates zeroed, page aligned memory from the host, and frees it.
+void* HostAllocatePages(size_t Size);
+void HostFreePages(void* Address, size_t Size);
+
+// Gets the number of bytes currently allocated through HostAllocatePages.
+size_t HostGetAllocatedPageBytes(void);
+
+// Creates a thread running StartRoutine, and waits for it to exit.
+void* HostCreateThread(PHOST_THREAD_START StartRoutine, void* Context);
+void HostJoinThread(void* Thread);
+
+void HostYield(void);
+
+int HostGetProcessorCount(void);
+
+// Implemented by the kernel shim.  Gets the number of physical pages which
+// are currently allocated.
+size_t HostGetAllocatedPhysicalPageCount(void);
+
+// Implemented by the libboron shim.  Makes OSTryEnterCriticalSection fail on
+// the calling thread, as if every critical section was contended.
+void HostSetContention(bool Contended);
@@ -0,0 +1,43 @@
+#pragma once
+#include "hostsup.h"
+
+// The test framework of the host test harness.  It mirrors the one of the
+// TestHarness application, so that tests can be moved between them easily.
+
+void TestPrintf(const char *, ...);
+
+bool TestAssertionFailed(
+	const char* File,
+	int Line,
+	const char* Func,
+	const char* Condition,
+	const char* Format,
+	...
+);
+
+#define TestAssertMsg(condition, ...) \
+	((void)((condition) || TestAssertionFailed(__FILE__, __LINE__, __func__, #condition, __VA_ARGS__)))
+
+#define TestAssert(condition) \
+	((void)((condition) || TestAssertionFailed(__FILE__, __LINE__, __func__, #condition, NULL)))
+
+// Benchmarks report their results in the same format as the test driver's
+// benchmark mode:
+//
+// BENCH name=<name> threads=<n> iterations=<n> total_ns=<n> ns_per_op=<n>
+//
+// Iteration counts are divided by BenchScale, which is set by the -q option,
+// so that CI can do a quick run.
+
+extern int BenchScale;
+
+#define BENCH_ITERATIONS(n) ((n) / BenchScale > 0 ? (n) / BenchScale : 1)
+
+uint64_t BenchGetTime(void);
+
+void BenchReport(const char* Name, int Threads, uint64_t Operations, uint64_t Ticks);
+
+// Same as BenchReport, but the reported name is "<Name>_<Size>".
+void BenchReportSize(const char* Name, size_t Size, int Threads, uint64_t Operations, uint64_t Ticks);
+
+uint32_t BenchRandom(uint32_t* State);
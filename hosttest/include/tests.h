@@ -0,0 +1,12 @@
+TEST(StringTest)
+TEST(RbTreeTest)
+TEST(SlaTest)
+TEST(ElfTest)
+TEST(HeapTest)
+TEST(CompressTest)
+BENCH(StringBenchmark)
+BENCH(RbTreeBenchmark)
+BENCH(SlaBenchmark)
+BENCH(ElfBenchmark)
+BENCH(HeapBenchmark)
+BENCH(CompressBenchmark)
\ No newline at end of file
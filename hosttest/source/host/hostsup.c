@@ -0,0 +1,165 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	host/hostsup.c
+
+Abstract:
+	This module implements the services that the host test
+	harness gets from the host operating system, as well as
+	the debug output routines shared by the kernel and user
+	mode shims.
+
+	This is the only part of the harness, besides main.c, that
+	is compiled against the host's C library.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "hostsup.h"
+
+static size_t HostAllocatedPageBytes;
+
+void HostVPrintf(const char* Format, va_list ArgList)
+{
+	vprintf(Format, ArgList);
+	putchar('\n');
+	fflush(stdout);
+}
+
+void HostPrintf(const char* Format, ...)
+{
+	va_list ArgList;
+	va_start(ArgList, Format);
+	HostVPrintf(Format, ArgList);
+	va_end(ArgList);
+}
+
+void HostAbort(const char* Format, ...)
+{
+	va_list ArgList;
+	va_start(ArgList, Format);
+	HostVPrintf(Format, ArgList);
+	va_end(ArgList);
+
+	exit(1);
+}
+
+uint64_t HostGetTickCount()
+{
+	struct timespec Time;
+	clock_gettime(CLOCK_MONOTONIC, &Time);
+	return (uint64_t) Time.tv_sec * 1000000000ULL + (uint64_t) Time.tv_nsec;
+}
+
+uint64_t HostGetTickFrequency()
+{
+	return 1000000000ULL;
+}
+
+void* HostAllocatePages(size_t Size)
+{
+	void* Address = mmap(NULL, Size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (Address == MAP_FAILED)
+		return NULL;
+
+	__atomic_add_fetch(&HostAllocatedPageBytes, Size, __ATOMIC_RELAXED);
+	return Address;
+}
+
+void HostFreePages(void* Address, size_t Size)
+{
+	if (munmap(Address, Size) != 0)
+		HostAbort("HostFreePages: munmap(%p, %zu) failed", Address, Size);
+
+	__atomic_sub_fetch(&HostAllocatedPageBytes, Size, __ATOMIC_RELAXED);
+}
+
+size_t HostGetAllocatedPageBytes()
+{
+	return __atomic_load_n(&HostAllocatedPageBytes, __ATOMIC_RELAXED);
+}
+
+typedef struct
+{
+	pthread_t Thread;
+	PHOST_THREAD_START StartRoutine;
+	void* Context;
+}
+HOST_THREAD;
+
+static void* HostThreadEntry(void* Parameter)
+{
+	HOST_THREAD* Thread = Parameter;
+	Thread->StartRoutine(Thread->Context);
+	return NULL;
+}
+
+void* HostCreateThread(PHOST_THREAD_START StartRoutine, void* Context)
+{
+	HOST_THREAD* Thread = malloc(sizeof(HOST_THREAD));
+	if (!Thread)
+		HostAbort("HostCreateThread: out of memory");
+
+	Thread->StartRoutine = StartRoutine;
+	Thread->Context = Context;
+
+	if (pthread_create(&Thread->Thread, NULL, HostThreadEntry, Thread) != 0)
+		HostAbort("HostCreateThread: pthread_create failed");
+
+	return Thread;
+}
+
+void HostJoinThread(void* ThreadV)
+{
+	HOST_THREAD* Thread = ThreadV;
+	pthread_join(Thread->Thread, NULL);
+	free(Thread);
+}
+
+void HostYield()
+{
+	sched_yield();
+}
+
+int HostGetProcessorCount()
+{
+	long Count = sysconf(_SC_NPROCESSORS_ONLN);
+	return Count > 0 ? (int) Count : 1;
+}
+
+// ===== Shared by both shims =====
+
+void DbgPrint(const char* Format, ...)
+{
+	va_list ArgList;
+	va_start(ArgList, Format);
+	HostVPrintf(Format, ArgList);
+	va_end(ArgList);
+}
+
+bool RtlAssert(const char* Condition, const char* File, int Line, const char* Message)
+{
+	HostAbort(
+		"Assertion failed: %s%s%s\nAt %s:%d",
+		Condition,
+		Message ? "\nMessage: " : "",
+		Message ? Message : "",
+		File,
+		Line
+	);
+}
+
+void RtlAbort()
+{
+	HostAbort("RtlAbort called");
+}
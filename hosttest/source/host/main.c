@@ -0,0 +1,187 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	host/main.c
+
+Abstract:
+	This module implements the entry point of the host test
+	harness.  It runs the unit tests, or, with the -b option,
+	the benchmarks, of the kernel and libboron modules which
+	can be built for the host.
+
+	Usage: hosttest [-b] [-q <scale>] [name...]
+
+	If names are given, only the tests or benchmarks with
+	those names run.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "testfmk.h"
+
+typedef struct
+{
+	const char* Name;
+	void (*Routine)();
+	bool IsBenchmark;
+}
+TEST_ENTRY;
+
+#define TEST(x) extern void x();
+#define BENCH(x) extern void x();
+#include "tests.h"
+#undef BENCH
+#undef TEST
+
+static const TEST_ENTRY Tests[] = {
+#define TEST(x) { #x, x, false },
+#define BENCH(x) { #x, x, true },
+#include "tests.h"
+#undef BENCH
+#undef TEST
+};
+
+static const char* CurrentTestName = "";
+static int BenchResultCount;
+
+int BenchScale = 1;
+
+void TestPrintf(const char* Format, ...)
+{
+	va_list vl;
+	va_start(vl, Format);
+	char Buffer[2048];
+	vsnprintf(Buffer, sizeof Buffer, Format, vl);
+	va_end(vl);
+
+	printf("%s: %s\n", CurrentTestName, Buffer);
+}
+
+bool TestAssertionFailed(
+	const char* File,
+	int Line,
+	const char* Func,
+	const char* Condition,
+	const char* Format,
+	...
+)
+{
+	fprintf(stderr, "%s: %s (%s:%d): Assertion failed.\nCondition: %s\n", CurrentTestName, Func, File, Line, Condition);
+
+	if (Format)
+	{
+		va_list vl;
+		va_start(vl, Format);
+		char Buffer[2048];
+		vsnprintf(Buffer, sizeof Buffer, Format, vl);
+		va_end(vl);
+
+		fprintf(stderr, "Message: %s\n", Buffer);
+	}
+
+	exit(1);
+}
+
+uint64_t BenchGetTime()
+{
+	return HostGetTickCount();
+}
+
+void BenchReport(const char* Name, int Threads, uint64_t Operations, uint64_t Ticks)
+{
+	uint64_t Nanoseconds = Ticks * 1000000000ULL / HostGetTickFrequency();
+
+	printf(
+		"BENCH name=%s threads=%d iterations=%llu total_ns=%llu ns_per_op=%llu\n",
+		Name,
+		Threads,
+		(unsigned long long) Operations,
+		(unsigned long long) Nanoseconds,
+		(unsigned long long)(Operations ? Nanoseconds / Operations : 0)
+	);
+
+	BenchResultCount++;
+}
+
+void BenchReportSize(const char* Name, size_t Size, int Threads, uint64_t Operations, uint64_t Ticks)
+{
+	char Buffer[128];
+	snprintf(Buffer, sizeof Buffer, "%s_%zu", Name, Size);
+	BenchReport(Buffer, Threads, Operations, Ticks);
+}
+
+uint32_t BenchRandom(uint32_t* State)
+{
+	*State = *State * 1103515245 + 12345;
+	return *State >> 8;
+}
+
+static bool IsSelected(const char* Name, int NameCount, char** Names)
+{
+	if (NameCount == 0)
+		return true;
+
+	for (int i = 0; i < NameCount; i++)
+	{
+		if (strcmp(Names[i], Name) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+int main(int ArgumentCount, char** ArgumentArray)
+{
+	bool RunBenchmarks = false;
+	int i = 1;
+
+	for (; i < ArgumentCount; i++)
+	{
+		if (strcmp(ArgumentArray[i], "-b") == 0)
+		{
+			RunBenchmarks = true;
+		}
+		else if (strcmp(ArgumentArray[i], "-q") == 0 && i + 1 < ArgumentCount)
+		{
+			BenchScale = atoi(ArgumentArray[++i]);
+			if (BenchScale < 1)
+				BenchScale = 1;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	int NameCount = ArgumentCount - i;
+	char** Names = &ArgumentArray[i];
+	int RunCount = 0;
+
+	if (RunBenchmarks)
+		printf("BENCH-BEGIN version=1 cpus=%d tick_frequency=%llu\n", HostGetProcessorCount(), (unsigned long long) HostGetTickFrequency());
+
+	for (size_t j = 0; j < sizeof Tests / sizeof Tests[0]; j++)
+	{
+		if (Tests[j].IsBenchmark != RunBenchmarks || !IsSelected(Tests[j].Name, NameCount, Names))
+			continue;
+
+		CurrentTestName = Tests[j].Name;
+		if (!RunBenchmarks)
+			printf("Running %s...\n", CurrentTestName);
+
+		Tests[j].Routine();
+		RunCount++;
+	}
+
+	if (RunBenchmarks)
+		printf("BENCH-END count=%d\n", BenchResultCount);
+	else
+		printf("All %d tests passed.\n", RunCount);
+
+	return 0;
+}
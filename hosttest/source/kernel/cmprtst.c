@@ -0,0 +1,162 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	kernel/cmprtst.c
+
+Abstract:
+	This module implements the tests and benchmarks of the
+	LZ compressor in rtl/compress.c.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <main.h>
+#include <string.h>
+#include <rtl/compress.h>
+#include "testfmk.h"
+
+#define COMPRESS_PAGE_SIZE   (4096)
+#define COMPRESS_BUFFER_SIZE (COMPRESS_PAGE_SIZE * 2)
+
+static RTL_LZ_WORKSPACE CompressWorkspace;
+static uint8_t CompressSource[COMPRESS_BUFFER_SIZE];
+static uint8_t CompressOutput[COMPRESS_BUFFER_SIZE + 64];
+static uint8_t CompressResult[COMPRESS_BUFFER_SIZE];
+
+typedef enum
+{
+	COMPRESS_ZEROES,
+	COMPRESS_TEXT,
+	COMPRESS_STRUCTS,
+	COMPRESS_RANDOM,
+	COMPRESS_KIND_COUNT
+}
+COMPRESS_KIND;
+
+// Fills the source with data resembling what is found in the pages of a process.
+static void CompressFillSource(COMPRESS_KIND Kind, size_t Size, uint32_t Seed)
+{
+	static const char Text[] = "The Boron Operating System keeps idle pages compressed in memory. ";
+	uint32_t State = Seed;
+
+	for (size_t i = 0; i < Size; i++)
+	{
+		switch (Kind)
+		{
+			case COMPRESS_ZEROES:
+				CompressSource[i] = 0;
+				break;
+
+			case COMPRESS_TEXT:
+				CompressSource[i] = Text[(i + Seed) % (sizeof Text - 1)];
+				break;
+
+			case COMPRESS_STRUCTS:
+				// Mostly zero structures with pointers and small counters in them.
+				CompressSource[i] = (i % 32 < 6) ? (uint8_t)(BenchRandom(&State) & 0x0F) : (i % 32 == 7 ? 0xFF : 0);
+				break;
+
+			default:
+				CompressSource[i] = (uint8_t) BenchRandom(&State);
+				break;
+		}
+	}
+}
+
+static void CompressRoundTrip(COMPRESS_KIND Kind, size_t Size)
+{
+	CompressFillSource(Kind, Size, (uint32_t) Size + 1);
+
+	size_t CompressedSize = RtlCompressBufferLz(CompressOutput, sizeof CompressOutput, CompressSource, Size, &CompressWorkspace);
+	TestAssertMsg(CompressedSize != 0, "kind %d, size %zu did not compress", Kind, Size);
+
+	memset(CompressResult, 0xCC, sizeof CompressResult);
+	size_t ResultSize = RtlDecompressBufferLz(CompressResult, Size, CompressOutput, CompressedSize);
+
+	TestAssertMsg(ResultSize == Size, "kind %d, size %zu decompressed to %zu bytes", Kind, Size, ResultSize);
+	TestAssertMsg(memcmp(CompressResult, CompressSource, Size) == 0, "kind %d, size %zu differs", Kind, Size);
+
+	// Nothing past the end may be written.
+	if (Size < sizeof CompressResult)
+		TestAssert(CompressResult[Size] == 0xCC);
+}
+
+void CompressTest()
+{
+	static const size_t Sizes[] = { 1, 3, 4, 5, 15, 16, 19, 100, 270, 1000, COMPRESS_PAGE_SIZE, COMPRESS_BUFFER_SIZE };
+
+	for (int Kind = 0; Kind < COMPRESS_KIND_COUNT; Kind++)
+	{
+		for (size_t i = 0; i < ARRAY_COUNT(Sizes); i++)
+			CompressRoundTrip(Kind, Sizes[i]);
+	}
+
+	// Repetitive data must shrink a lot, and random data must not grow by much.
+	CompressFillSource(COMPRESS_ZEROES, COMPRESS_PAGE_SIZE, 1);
+	size_t ZeroSize = RtlCompressBufferLz(CompressOutput, sizeof CompressOutput, CompressSource, COMPRESS_PAGE_SIZE, &CompressWorkspace);
+	TestAssertMsg(ZeroSize != 0 && ZeroSize < 64, "a page of zeroes compressed to %zu bytes", ZeroSize);
+
+	CompressFillSource(COMPRESS_RANDOM, COMPRESS_PAGE_SIZE, 1);
+	size_t RandomSize = RtlCompressBufferLz(CompressOutput, sizeof CompressOutput, CompressSource, COMPRESS_PAGE_SIZE, &CompressWorkspace);
+	TestAssertMsg(RandomSize <= COMPRESS_PAGE_SIZE + COMPRESS_PAGE_SIZE / 128, "a page of random data compressed to %zu bytes", RandomSize);
+
+	// Output which doesn't fit is refused.
+	TestAssert(RtlCompressBufferLz(CompressOutput, COMPRESS_PAGE_SIZE / 2, CompressSource, COMPRESS_PAGE_SIZE, &CompressWorkspace) == 0);
+
+	// Malformed input is refused.
+	CompressFillSource(COMPRESS_TEXT, COMPRESS_PAGE_SIZE, 1);
+	size_t TextSize = RtlCompressBufferLz(CompressOutput, sizeof CompressOutput, CompressSource, COMPRESS_PAGE_SIZE, &CompressWorkspace);
+	TestAssert(TextSize != 0);
+
+	TestAssert(RtlDecompressBufferLz(CompressResult, COMPRESS_PAGE_SIZE - 1, CompressOutput, TextSize) == 0);
+
+	// The last sequence may be a lone token without literals, so cutting off one byte
+	// may lose nothing.  Any more than that must lose data.
+	for (size_t Cut = 2; Cut < TextSize; Cut += 7)
+	{
+		size_t ResultSize = RtlDecompressBufferLz(CompressResult, COMPRESS_PAGE_SIZE, CompressOutput, TextSize - Cut);
+		TestAssert(ResultSize < COMPRESS_PAGE_SIZE);
+	}
+
+	// A match which refers to before the start of the output.
+	static const uint8_t BadOffset[] = { 0x10, 'A', 0x05, 0x00 };
+	TestAssert(RtlDecompressBufferLz(CompressResult, COMPRESS_PAGE_SIZE, BadOffset, sizeof BadOffset) == 0);
+
+	// A match with an offset of one repeats the last byte.
+	static const uint8_t Run[] = { 0x13, 'A', 0x01, 0x00, 0x00 };
+	TestAssert(RtlDecompressBufferLz(CompressResult, COMPRESS_PAGE_SIZE, Run, sizeof Run) == 8);
+	TestAssert(memcmp(CompressResult, "AAAAAAAA", 8) == 0);
+}
+
+static void CompressBenchmarkKind(const char* CompressName, const char* DecompressName, COMPRESS_KIND Kind, int Iterations)
+{
+	CompressFillSource(Kind, COMPRESS_PAGE_SIZE, 1);
+
+	size_t CompressedSize = 0;
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < Iterations; i++)
+		CompressedSize = RtlCompressBufferLz(CompressOutput, sizeof CompressOutput, CompressSource, COMPRESS_PAGE_SIZE, &CompressWorkspace);
+
+	BenchReport(CompressName, 1, Iterations, BenchGetTime() - Start);
+
+	Start = BenchGetTime();
+
+	for (int i = 0; i < Iterations; i++)
+		RtlDecompressBufferLz(CompressResult, COMPRESS_PAGE_SIZE, CompressOutput, CompressedSize);
+
+	BenchReport(DecompressName, 1, Iterations, BenchGetTime() - Start);
+}
+
+void CompressBenchmark()
+{
+	int Iterations = BENCH_ITERATIONS(200000);
+
+	// One page at a time, like the compressed page store does.
+	CompressBenchmarkKind("lz_compress_zero_page", "lz_decompress_zero_page", COMPRESS_ZEROES, Iterations);
+	CompressBenchmarkKind("lz_compress_text_page", "lz_decompress_text_page", COMPRESS_TEXT, Iterations);
+	CompressBenchmarkKind("lz_compress_struct_page", "lz_decompress_struct_page", COMPRESS_STRUCTS, Iterations);
+	CompressBenchmarkKind("lz_compress_random_page", "lz_decompress_random_page", COMPRESS_RANDOM, Iterations / 4);
+}
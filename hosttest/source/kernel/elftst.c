@@ -0,0 +1,418 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	kernel/elftst.c
+
+Abstract:
+	This module implements the tests and benchmarks of the
+	ELF relocation and symbol lookup code in rtl/elf.c.
+
+	The tests build a synthetic image in memory: a symbol
+	table, its SysV and GNU hash tables and relocation tables
+	pointing into a data area.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <main.h>
+#include <mm.h>
+#include <string.h>
+#include <rtl/elf.h>
+#include "testfmk.h"
+
+#define ELF_R_INFO(Symbol, Type) (((uintptr_t)(Symbol) << 32) | (Type))
+
+#define ELF_IMAGE_SIZE     (0x4000)
+#define ELF_BENCH_SYMBOLS  (2048)
+#define ELF_BENCH_RELOCS   (65536)
+
+typedef struct
+{
+	char* StringTable;
+	PELF_SYMBOL Symbols;
+	PELF_HASH_TABLE HashTable;
+	PELF_GNU_HASH_TABLE GnuHashTable;
+	size_t SymbolCount;
+	size_t AllocationSize;
+	void* Allocation;
+}
+ELF_TEST_TABLES, *PELF_TEST_TABLES;
+
+static uint8_t ElfImage[ELF_IMAGE_SIZE] __attribute__((aligned(4096)));
+
+static uintptr_t* ElfPlace(size_t Offset)
+{
+	return (uintptr_t*)(ElfImage + Offset);
+}
+
+static char* ElfFormatName(char* Buffer, const char* Prefix, size_t Number)
+{
+	char Digits[24];
+	int DigitCount = 0;
+
+	do
+	{
+		Digits[DigitCount++] = (char)('0' + Number % 10);
+		Number /= 10;
+	}
+	while (Number);
+
+	strcpy(Buffer, Prefix);
+	char* End = Buffer + strlen(Buffer);
+	while (DigitCount)
+		*End++ = Digits[--DigitCount];
+
+	*End = 0;
+	return Buffer;
+}
+
+// Builds a symbol table with the given names, preceded by the null symbol, and
+// both kinds of hash tables for it.  Symbols are defined at 0x1000 + 0x10 * their
+// position in Names, except for the undefined one, if any.
+static void ElfBuildTables(PELF_TEST_TABLES Tables, const char* const* Names, size_t NameCount, size_t UndefinedIndex)
+{
+	size_t SymbolCount = NameCount + 1;
+	size_t BucketCount = NameCount / 4 + 1;
+	size_t BloomSize = 1;
+	while (BloomSize * 8 < NameCount)
+		BloomSize *= 2;
+
+	size_t StringSize = 1;
+	for (size_t i = 0; i < NameCount; i++)
+		StringSize += strlen(Names[i]) + 1;
+
+	size_t SymbolsSize = sizeof(ELF_SYMBOL) * SymbolCount;
+	size_t HashSize = sizeof(ELF_HASH_TABLE) + sizeof(uint32_t) * (BucketCount + SymbolCount);
+	size_t GnuHashSize = sizeof(ELF_GNU_HASH_TABLE) + sizeof(uintptr_t) * BloomSize + sizeof(uint32_t) * (BucketCount + SymbolCount);
+
+	Tables->AllocationSize = (SymbolsSize + HashSize + GnuHashSize + StringSize + 64 + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	Tables->Allocation = HostAllocatePages(Tables->AllocationSize);
+	TestAssert(Tables->Allocation);
+
+	uint8_t* Memory = Tables->Allocation;
+	Tables->Symbols = (PELF_SYMBOL) Memory;
+	Tables->GnuHashTable = (PELF_GNU_HASH_TABLE)(Memory + ((SymbolsSize + 15) & ~15));
+	Tables->HashTable = (PELF_HASH_TABLE)((uint8_t*) Tables->GnuHashTable + ((GnuHashSize + 15) & ~15));
+	Tables->StringTable = (char*) Tables->HashTable + ((HashSize + 15) & ~15);
+	Tables->SymbolCount = SymbolCount;
+
+	// The GNU hash table requires the symbols to be sorted by bucket, so they are laid
+	// out in that order.  The undefined symbol, if any, goes before the hashed ones.
+	PELF_GNU_HASH_TABLE Gnu = Tables->GnuHashTable;
+	Gnu->BucketCount = BucketCount;
+	Gnu->BloomSize = BloomSize;
+	Gnu->BloomShift = 6;
+	Gnu->SymbolOffset = UndefinedIndex < NameCount ? 2 : 1;
+
+	uint32_t* GnuBuckets = (uint32_t*) &Gnu->Bloom[BloomSize];
+	uint32_t* GnuChains = &GnuBuckets[BucketCount];
+	const uint32_t WordBits = sizeof(uintptr_t) * 8;
+
+	size_t StringOffset = 1;
+	size_t SymbolIndex = 1;
+	Tables->StringTable[0] = 0;
+
+	if (UndefinedIndex < NameCount)
+	{
+		PELF_SYMBOL Symbol = &Tables->Symbols[SymbolIndex++];
+		memset(Symbol, 0, sizeof *Symbol);
+		Symbol->Name = StringOffset;
+		Symbol->SectionHeaderIndex = SHN_UNDEF;
+		strcpy(Tables->StringTable + StringOffset, Names[UndefinedIndex]);
+		StringOffset += strlen(Names[UndefinedIndex]) + 1;
+	}
+
+	for (size_t Bucket = 0; Bucket < BucketCount; Bucket++)
+	{
+		GnuBuckets[Bucket] = 0;
+
+		for (size_t i = 0; i < NameCount; i++)
+		{
+			uint32_t Hash = RtlGnuHash(Names[i]);
+			if (i == UndefinedIndex || Hash % BucketCount != Bucket)
+				continue;
+
+			if (GnuBuckets[Bucket] == 0)
+				GnuBuckets[Bucket] = SymbolIndex;
+			else
+				GnuChains[SymbolIndex - 1 - Gnu->SymbolOffset] &= ~1u;
+
+			GnuChains[SymbolIndex - Gnu->SymbolOffset] = Hash | 1;
+
+			Gnu->Bloom[(Hash / WordBits) & (BloomSize - 1)] |=
+				((uintptr_t) 1 << (Hash % WordBits)) |
+				((uintptr_t) 1 << ((Hash >> Gnu->BloomShift) % WordBits));
+
+			PELF_SYMBOL Symbol = &Tables->Symbols[SymbolIndex++];
+			memset(Symbol, 0, sizeof *Symbol);
+			Symbol->Name = StringOffset;
+			Symbol->Value = 0x1000 + 0x10 * i;
+			Symbol->SectionHeaderIndex = 1;
+			strcpy(Tables->StringTable + StringOffset, Names[i]);
+			StringOffset += strlen(Names[i]) + 1;
+		}
+	}
+
+	TestAssert(SymbolIndex == SymbolCount);
+
+	// The SysV hash table covers every symbol.
+	PELF_HASH_TABLE Sysv = Tables->HashTable;
+	Sysv->BucketCount = BucketCount;
+	Sysv->ChainCount = SymbolCount;
+
+	uint32_t* SysvBuckets = Sysv->Data;
+	uint32_t* SysvChains = &Sysv->Data[BucketCount];
+	memset(SysvBuckets, 0, sizeof(uint32_t) * (BucketCount + SymbolCount));
+
+	for (size_t i = 1; i < SymbolCount; i++)
+	{
+		uint32_t Bucket = RtlElfHash(Tables->StringTable + Tables->Symbols[i].Name) % BucketCount;
+		SysvChains[i] = SysvBuckets[Bucket];
+		SysvBuckets[Bucket] = i;
+	}
+}
+
+static void ElfFreeTables(PELF_TEST_TABLES Tables)
+{
+	HostFreePages(Tables->Allocation, Tables->AllocationSize);
+}
+
+static void ElfUseTables(PELF_DYNAMIC_INFO DynInfo, PELF_TEST_TABLES Tables, bool UseGnuHash)
+{
+	memset(DynInfo, 0, sizeof *DynInfo);
+	DynInfo->DynStrTable = Tables->StringTable;
+	DynInfo->DynSymTable = Tables->Symbols;
+
+	if (UseGnuHash)
+		DynInfo->GnuHashTable = Tables->GnuHashTable;
+	else
+		DynInfo->HashTable = Tables->HashTable;
+}
+
+static void ElfTestHashes()
+{
+	TestAssert(RtlElfHash("") == 0);
+	TestAssert(RtlElfHash("printf") == 0x077905A6);
+	TestAssert(RtlElfHash("OSAllocate") == 0x0330DF25);
+
+	TestAssert(RtlGnuHash("") == 0x00001505);
+	TestAssert(RtlGnuHash("printf") == 0x156B2BB8);
+	TestAssert(RtlGnuHash("OSAllocate") == 0xB38FB3AC);
+}
+
+static void ElfTestLookUp()
+{
+	static const char* const Names[] = { "exit", "OSAllocate", "printf", "OSFree", "DbgPrint" };
+	ELF_TEST_TABLES Tables;
+	ELF_DYNAMIC_INFO DynInfo;
+
+	ElfBuildTables(&Tables, Names, ARRAY_COUNT(Names), 0);
+
+	for (int UseGnuHash = 0; UseGnuHash < 2; UseGnuHash++)
+	{
+		ElfUseTables(&DynInfo, &Tables, UseGnuHash);
+
+		for (size_t i = 1; i < ARRAY_COUNT(Names); i++)
+		{
+			PELF_SYMBOL Symbol = RtlLookUpDynamicSymbol(&DynInfo, Names[i], RtlGnuHash(Names[i]));
+			TestAssertMsg(Symbol, "%s not found (gnu hash: %d)", Names[i], UseGnuHash);
+			TestAssert(Symbol->Value == 0x1000 + 0x10 * i);
+			TestAssert(strcmp(Tables.StringTable + Symbol->Name, Names[i]) == 0);
+		}
+
+		// Undefined symbols aren't returned, and neither are ones that don't exist.
+		TestAssert(RtlLookUpDynamicSymbol(&DynInfo, "exit", RtlGnuHash("exit")) == NULL);
+		TestAssert(RtlLookUpDynamicSymbol(&DynInfo, "malloc", RtlGnuHash("malloc")) == NULL);
+		TestAssert(RtlLookUpDynamicSymbol(&DynInfo, "printf2", RtlGnuHash("printf2")) == NULL);
+	}
+
+	ElfFreeTables(&Tables);
+}
+
+static void ElfTestRelocations()
+{
+	static const char* const Names[] = { "OSAllocate", "printf" };
+	ELF_TEST_TABLES Tables;
+	ELF_DYNAMIC_INFO DynInfo;
+
+	ElfBuildTables(&Tables, Names, ARRAY_COUNT(Names), (size_t) -1);
+	ElfUseTables(&DynInfo, &Tables, true);
+
+	// Find the symbol indices, since the symbols are sorted by hash bucket.
+	uint32_t OSAllocateIndex = RtlLookUpDynamicSymbol(&DynInfo, "OSAllocate", RtlGnuHash("OSAllocate")) - Tables.Symbols;
+	uint32_t PrintfIndex = RtlLookUpDynamicSymbol(&DynInfo, "printf", RtlGnuHash("printf")) - Tables.Symbols;
+
+	ELF_RELA Rela[] = {
+		{ 0x100, ELF_R_INFO(0, R_X86_64_RELATIVE), 0x1234 },
+		{ 0x108, ELF_R_INFO(OSAllocateIndex, R_X86_64_64), 8 },
+		{ 0x110, ELF_R_INFO(PrintfIndex, R_X86_64_GLOB_DAT), 0 },
+		{ 0x118, ELF_R_INFO(PrintfIndex, R_X86_64_JUMP_SLOT), 0 },
+		{ 0x128, ELF_R_INFO(0, R_X86_64_64), 0x55 },
+	};
+
+	ELF_REL Rel[] = {
+		{ 0x120, ELF_R_INFO(0, R_X86_64_RELATIVE) },
+	};
+
+	DynInfo.RelaEntries = Rela;
+	DynInfo.RelaCount = ARRAY_COUNT(Rela);
+	DynInfo.RelEntries = Rel;
+	DynInfo.RelCount = ARRAY_COUNT(Rel);
+
+	uintptr_t Base = (uintptr_t) ElfImage;
+	memset(ElfImage, 0, sizeof ElfImage);
+
+	// Relative relocations only, which are the ones the kernel applies to cached
+	// image sections.  Absolute ones count as symbolic even without a symbol.
+	TestAssert(RtlPerformSelectedRelocations(&DynInfo, Base, RTL_RELOC_BASE));
+	TestAssert(*ElfPlace(0x100) == Base + 0x1234);
+	TestAssert(*ElfPlace(0x108) == 0);
+	TestAssert(*ElfPlace(0x110) == 0);
+	TestAssert(*ElfPlace(0x120) == Base);
+	TestAssert(*ElfPlace(0x128) == 0);
+
+	TestAssert(RtlPerformSelectedRelocations(&DynInfo, Base, RTL_RELOC_SYMBOLIC));
+	TestAssert(*ElfPlace(0x108) == Base + 0x1000 + 8);
+	TestAssert(*ElfPlace(0x110) == Base + 0x1010);
+	TestAssert(*ElfPlace(0x118) == Base + 0x1010);
+	TestAssert(*ElfPlace(0x128) == 0x55);
+
+	// RELR: an address entry followed by a bitmap entry.
+	uintptr_t Relr[] = { 0x200, (0xB << 1) | 1 };
+	memset(&DynInfo, 0, sizeof DynInfo);
+	DynInfo.RelrEntries = Relr;
+	DynInfo.RelrCount = ARRAY_COUNT(Relr);
+
+	for (int i = 0; i < 6; i++)
+		*ElfPlace(0x200 + i * 8) = 0x10 * (i + 1);
+
+	RtlRelocateRelrEntries(&DynInfo, Base);
+
+	TestAssert(*ElfPlace(0x200) == Base + 0x10);
+	TestAssert(*ElfPlace(0x208) == Base + 0x20);
+	TestAssert(*ElfPlace(0x210) == Base + 0x30);
+	TestAssert(*ElfPlace(0x218) == 0x40);
+	TestAssert(*ElfPlace(0x220) == Base + 0x50);
+	TestAssert(*ElfPlace(0x228) == 0x60);
+
+	ElfFreeTables(&Tables);
+}
+
+static void ElfTestValidity()
+{
+	ELF_HEADER Header;
+	memset(&Header, 0, sizeof Header);
+	memcpy(Header.Identifier, "\x7F" "ELF", 4);
+	Header.Identifier[ELF_IDENT_CLASS] = ELF_MCLASS_64BIT;
+	Header.Identifier[ELF_IDENT_DATA] = ELF_MDATA_LSB;
+	Header.Machine = ELF_ARCH_AMD64;
+	Header.Type = ELF_TYPE_DYNAMIC;
+	Header.ProgramHeaderCount = 1;
+
+	TestAssert(RtlCheckValidity(&Header) == STATUS_SUCCESS);
+
+	Header.ProgramHeaderCount = 0;
+	TestAssert(RtlCheckValidity(&Header) == STATUS_INVALID_EXECUTABLE);
+	Header.ProgramHeaderCount = 1;
+
+	Header.Machine = ELF_ARCH_386;
+	TestAssert(RtlCheckValidity(&Header) == STATUS_INVALID_ARCHITECTURE);
+	Header.Machine = ELF_ARCH_AMD64;
+
+	Header.Identifier[0] = 0;
+	TestAssert(RtlCheckValidity(&Header) == STATUS_INVALID_EXECUTABLE);
+}
+
+void ElfTest()
+{
+	ElfTestHashes();
+	ElfTestLookUp();
+	ElfTestRelocations();
+	ElfTestValidity();
+}
+
+static void ElfBenchmarkLookUp()
+{
+	static char NameStorage[ELF_BENCH_SYMBOLS][24];
+	static const char* Names[ELF_BENCH_SYMBOLS];
+	static char MissStorage[ELF_BENCH_SYMBOLS][24];
+
+	for (size_t i = 0; i < ELF_BENCH_SYMBOLS; i++)
+	{
+		Names[i] = ElfFormatName(NameStorage[i], "OSDLLSymbol", i);
+		ElfFormatName(MissStorage[i], "OSDLLMissing", i);
+	}
+
+	ELF_TEST_TABLES Tables;
+	ELF_DYNAMIC_INFO DynInfo;
+	ElfBuildTables(&Tables, Names, ELF_BENCH_SYMBOLS, (size_t) -1);
+
+	int Iterations = BENCH_ITERATIONS(1000000);
+	uint32_t State = 1;
+
+	for (int UseGnuHash = 0; UseGnuHash < 2; UseGnuHash++)
+	{
+		ElfUseTables(&DynInfo, &Tables, UseGnuHash);
+
+		uint64_t Start = BenchGetTime();
+		for (int i = 0; i < Iterations; i++)
+		{
+			const char* Name = Names[BenchRandom(&State) % ELF_BENCH_SYMBOLS];
+			if (!RtlLookUpDynamicSymbol(&DynInfo, Name, RtlGnuHash(Name)))
+				TestAssert(!"lookup failed");
+		}
+		BenchReport(UseGnuHash ? "elf_lookup_hit_gnu" : "elf_lookup_hit_sysv", 1, Iterations, BenchGetTime() - Start);
+
+		// Misses are the common case when probing the modules loaded before the right one.
+		Start = BenchGetTime();
+		for (int i = 0; i < Iterations; i++)
+		{
+			const char* Name = MissStorage[BenchRandom(&State) % ELF_BENCH_SYMBOLS];
+			if (RtlLookUpDynamicSymbol(&DynInfo, Name, RtlGnuHash(Name)))
+				TestAssert(!"lookup succeeded");
+		}
+		BenchReport(UseGnuHash ? "elf_lookup_miss_gnu" : "elf_lookup_miss_sysv", 1, Iterations, BenchGetTime() - Start);
+	}
+
+	ElfFreeTables(&Tables);
+}
+
+static void ElfBenchmarkRelocations()
+{
+	size_t RelocationCount = BENCH_ITERATIONS(ELF_BENCH_RELOCS);
+	size_t DataSize = (RelocationCount * sizeof(uintptr_t) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	size_t RelaSize = (RelocationCount * sizeof(ELF_RELA) + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+
+	uintptr_t* Data = HostAllocatePages(DataSize);
+	PELF_RELA Rela = HostAllocatePages(RelaSize);
+	TestAssert(Data && Rela);
+
+	for (size_t i = 0; i < RelocationCount; i++)
+	{
+		Rela[i].Offset = i * sizeof(uintptr_t);
+		Rela[i].Info = ELF_R_INFO(0, R_X86_64_RELATIVE);
+		Rela[i].Addend = i * 16;
+	}
+
+	ELF_DYNAMIC_INFO DynInfo;
+	memset(&DynInfo, 0, sizeof DynInfo);
+	DynInfo.RelaEntries = Rela;
+	DynInfo.RelaCount = RelocationCount;
+
+	uint64_t Start = BenchGetTime();
+	TestAssert(RtlPerformRelocations(&DynInfo, (uintptr_t) Data));
+	BenchReport("elf_relocate_rela", 1, RelocationCount, BenchGetTime() - Start);
+
+	TestAssert(Data[RelocationCount - 1] == (uintptr_t) Data + (RelocationCount - 1) * 16);
+
+	HostFreePages(Rela, RelaSize);
+	HostFreePages(Data, DataSize);
+}
+
+void ElfBenchmark()
+{
+	ElfBenchmarkLookUp();
+	ElfBenchmarkRelocations();
+}
@@ -0,0 +1,117 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	kernel/kshim.c
+
+Abstract:
+	This module implements the kernel services used by the
+	kernel modules that are built for the host.
+
+	Physical pages are emulated with pages allocated from the
+	host.  A page frame number is an index into a table of
+	such pages, and the "physical address" of a page is its
+	page frame number shifted left by the page size's log.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <mm.h>
+#include <ke.h>
+#include "hostsup.h"
+
+#define HOST_MAX_PAGES (65536)
+
+static void* HostPages[HOST_MAX_PAGES];
+static MMPFN HostFreePfns[HOST_MAX_PAGES];
+static size_t HostFreePfnCount;
+static size_t HostNextPfn = 1; // PFN 0 is never handed out, to catch misuse.
+static size_t HostAllocatedPfnCount;
+
+MMPFN MmAllocatePhysicalPage()
+{
+	MMPFN Pfn;
+
+	if (HostFreePfnCount)
+	{
+		Pfn = HostFreePfns[--HostFreePfnCount];
+	}
+	else
+	{
+		if (HostNextPfn >= HOST_MAX_PAGES)
+			return PFN_INVALID;
+
+		Pfn = (MMPFN) HostNextPfn++;
+	}
+
+	HostPages[Pfn] = HostAllocatePages(PAGE_SIZE);
+	if (!HostPages[Pfn])
+	{
+		HostFreePfns[HostFreePfnCount++] = Pfn;
+		return PFN_INVALID;
+	}
+
+	HostAllocatedPfnCount++;
+	return Pfn;
+}
+
+void MmFreePhysicalPage(MMPFN Pfn)
+{
+	ASSERT(Pfn != PFN_INVALID);
+	ASSERT(Pfn < HOST_MAX_PAGES && HostPages[Pfn]);
+
+	HostFreePages(HostPages[Pfn], PAGE_SIZE);
+	HostPages[Pfn] = NULL;
+	HostFreePfns[HostFreePfnCount++] = Pfn;
+	HostAllocatedPfnCount--;
+}
+
+uintptr_t MmPFNToPhysPage(MMPFN Pfn)
+{
+	return (uintptr_t) Pfn << 12;
+}
+
+MMPFN MmPhysPageToPFN(uintptr_t PhysAddr)
+{
+	return (MMPFN)(PhysAddr >> 12);
+}
+
+void* MmGetHHDMOffsetAddr(uintptr_t PhysAddr)
+{
+	MMPFN Pfn = MmPhysPageToPFN(PhysAddr);
+	ASSERT(Pfn < HOST_MAX_PAGES && HostPages[Pfn]);
+
+	return (uint8_t*) HostPages[Pfn] + (PhysAddr & (PAGE_SIZE - 1));
+}
+
+size_t HostGetAllocatedPhysicalPageCount()
+{
+	return HostAllocatedPfnCount;
+}
+
+NO_RETURN void KeCrash(const char* Message, ...)
+{
+	va_list ArgList;
+	va_start(ArgList, Message);
+	HostVPrintf(Message, ArgList);
+	va_end(ArgList);
+
+	HostAbort("KeCrash called");
+}
+
+NO_RETURN void KeCrashBeforeSMPInit(const char* Message, ...)
+{
+	va_list ArgList;
+	va_start(ArgList, Message);
+	HostVPrintf(Message, ArgList);
+	va_end(ArgList);
+
+	HostAbort("KeCrashBeforeSMPInit called");
+}
+
+uintptr_t DbgLookUpAddress(UNUSED const char* Name)
+{
+	// There is no kernel to link against.
+	return 0;
+}
@@ -0,0 +1,155 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	kernel/rbtrtst.c
+
+Abstract:
+	This module implements the tests and benchmarks of the
+	rank-balanced tree in rtl/rbtree.c.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <main.h>
+#include "testfmk.h"
+
+#define RBTREE_TEST_COUNT  (4096)
+#define RBTREE_BENCH_COUNT (200000)
+
+static RBTREE_ENTRY RbTreeEntries[RBTREE_BENCH_COUNT];
+
+// Spreads the keys out, and makes them come in a scrambled order.
+static RBTREE_KEY RbTreeKey(size_t Index)
+{
+	return (RBTREE_KEY)((Index * 2654435761u) % 1000003u) * 16 + 16;
+}
+
+static bool RbTreeCheckOrder(void* Context, PRBTREE_ENTRY Entry)
+{
+	RBTREE_KEY* Previous = Context;
+	TestAssertMsg(Entry->Key > *Previous, "key %zu follows key %zu", (size_t) Entry->Key, (size_t) *Previous);
+	*Previous = Entry->Key;
+	return true;
+}
+
+void RbTreeTest()
+{
+	RBTREE Tree;
+	InitializeRbTree(&Tree);
+
+	TestAssert(IsEmptyRbTree(&Tree));
+	TestAssert(GetFirstEntryRbTree(&Tree) == NULL);
+	TestAssert(LookUpItemApproximateRbTree(&Tree, 100) == NULL);
+
+	RBTREE_KEY MinKey = (RBTREE_KEY) -1, MaxKey = 0;
+	for (size_t i = 0; i < RBTREE_TEST_COUNT; i++)
+	{
+		RbTreeEntries[i].Key = RbTreeKey(i);
+		TestAssert(InsertItemRbTree(&Tree, &RbTreeEntries[i]));
+
+		if (MinKey > RbTreeEntries[i].Key) MinKey = RbTreeEntries[i].Key;
+		if (MaxKey < RbTreeEntries[i].Key) MaxKey = RbTreeEntries[i].Key;
+	}
+
+	// Duplicate keys are rejected.
+	RBTREE_ENTRY Duplicate;
+	Duplicate.Key = RbTreeKey(10);
+	TestAssert(!InsertItemRbTree(&Tree, &Duplicate));
+
+	TestAssert(GetItemCountRbTree(&Tree) == RBTREE_TEST_COUNT);
+	TestAssert(GetFirstEntryRbTree(&Tree)->Key == MinKey);
+	TestAssert(GetLastEntryRbTree(&Tree)->Key == MaxKey);
+
+	RBTREE_KEY Previous = 0;
+	TraverseRbTree(&Tree, RbTreeCheckOrder, &Previous);
+
+	// Exact lookups.
+	for (size_t i = 0; i < RBTREE_TEST_COUNT; i++)
+		TestAssert(LookUpItemRbTree(&Tree, RbTreeKey(i)) == &RbTreeEntries[i]);
+
+	TestAssert(LookUpItemRbTree(&Tree, RbTreeKey(3) + 1) == NULL);
+
+	// Approximate lookups find the greatest key less than or equal to the one given.
+	for (size_t i = 0; i < RBTREE_TEST_COUNT; i++)
+	{
+		PRBTREE_ENTRY Entry = &RbTreeEntries[i];
+		TestAssert(LookUpItemApproximateRbTree(&Tree, Entry->Key) == Entry);
+		TestAssert(LookUpItemApproximateRbTree(&Tree, Entry->Key + 15) == Entry);
+
+		PRBTREE_ENTRY Next = GetNextEntryRbTree(Entry);
+		if (Next)
+			TestAssert(GetPrevEntryRbTree(Next) == Entry);
+	}
+
+	TestAssert(LookUpItemApproximateRbTree(&Tree, MinKey - 1) == NULL);
+	TestAssert(LookUpItemApproximateRbTree(&Tree, (RBTREE_KEY) -1)->Key == MaxKey);
+
+	// Remove every other entry, and check that the rest are still found.
+	for (size_t i = 0; i < RBTREE_TEST_COUNT; i += 2)
+		TestAssert(RemoveItemRbTree(&Tree, &RbTreeEntries[i]));
+
+	TestAssert(GetItemCountRbTree(&Tree) == RBTREE_TEST_COUNT / 2);
+
+	for (size_t i = 0; i < RBTREE_TEST_COUNT; i++)
+	{
+		PRBTREE_ENTRY Expected = (i % 2) ? &RbTreeEntries[i] : NULL;
+		TestAssert(LookUpItemRbTree(&Tree, RbTreeKey(i)) == Expected);
+	}
+
+	Previous = 0;
+	TraverseRbTree(&Tree, RbTreeCheckOrder, &Previous);
+
+	for (size_t i = 1; i < RBTREE_TEST_COUNT; i += 2)
+		TestAssert(RemoveItemRbTree(&Tree, &RbTreeEntries[i]));
+
+	TestAssert(IsEmptyRbTree(&Tree));
+}
+
+void RbTreeBenchmark()
+{
+	RBTREE Tree;
+	InitializeRbTree(&Tree);
+
+	size_t Count = BENCH_ITERATIONS(RBTREE_BENCH_COUNT);
+
+	uint64_t Start = BenchGetTime();
+	for (size_t i = 0; i < Count; i++)
+	{
+		RbTreeEntries[i].Key = RbTreeKey(i);
+		InsertItemRbTree(&Tree, &RbTreeEntries[i]);
+	}
+	BenchReport("rbtree_insert", 1, Count, BenchGetTime() - Start);
+
+	uint32_t State = 1;
+	Start = BenchGetTime();
+	for (size_t i = 0; i < Count; i++)
+	{
+		size_t Index = BenchRandom(&State) % Count;
+		if (LookUpItemRbTree(&Tree, RbTreeKey(Index)) != &RbTreeEntries[Index])
+			TestAssert(!"lookup failed");
+	}
+	BenchReport("rbtree_lookup", 1, Count, BenchGetTime() - Start);
+
+	// Approximate lookups are what the VAD list uses to find the VAD containing an address.
+	Start = BenchGetTime();
+	for (size_t i = 0; i < Count; i++)
+	{
+		size_t Index = BenchRandom(&State) % Count;
+		if (LookUpItemApproximateRbTree(&Tree, RbTreeKey(Index) + 8) != &RbTreeEntries[Index])
+			TestAssert(!"approximate lookup failed");
+	}
+	BenchReport("rbtree_lookup_approximate", 1, Count, BenchGetTime() - Start);
+
+	Start = BenchGetTime();
+	size_t Visited = 0;
+	for (PRBTREE_ENTRY Entry = GetFirstEntryRbTree(&Tree); Entry; Entry = GetNextEntryRbTree(Entry))
+		Visited++;
+	BenchReport("rbtree_iterate", 1, Visited, BenchGetTime() - Start);
+
+	Start = BenchGetTime();
+	for (size_t i = 0; i < Count; i++)
+		RemoveItemRbTree(&Tree, &RbTreeEntries[i]);
+	BenchReport("rbtree_remove", 1, Count, BenchGetTime() - Start);
+}
@@ -0,0 +1,158 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	kernel/slatst.c
+
+Abstract:
+	This module implements the tests and benchmarks of the
+	sparse linear array in mm/sla.c.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <mm.h>
+#include "testfmk.h"
+
+#define SLA_ENTRIES_PER_PAGE (PAGE_SIZE / sizeof(MMSLA_ENTRY))
+#define PFN_ENTRIES_PER_PAGE (PAGE_SIZE / sizeof(MMPFN))
+
+#define SLA_BENCH_COUNT (262144)
+
+static size_t SlaFreedEntryCount;
+static size_t SlaReferencedEntryCount;
+
+static void SlaFreeEntry(MMSLA_ENTRY Entry)
+{
+	if (Entry != MM_SLA_NO_DATA)
+		SlaFreedEntryCount++;
+}
+
+static void SlaReferenceEntry(PMMSLA_ENTRY Entry)
+{
+	(void) Entry;
+	SlaReferencedEntryCount++;
+}
+
+static MMSLA_ENTRY SlaValue(uint64_t Index)
+{
+	return (MMSLA_ENTRY)(Index * 3 + 1);
+}
+
+void SlaTest()
+{
+	MMSLA Sla;
+	MmInitializeSla(&Sla);
+
+	size_t PagesBefore = HostGetAllocatedPhysicalPageCount();
+
+	// One index in each part of the array: the direct entries, each level of
+	// indirection, and the edges between them.
+	const uint64_t Level0 = MM_SLA_DIRECT_ENTRY_COUNT;
+	const uint64_t Level1 = Level0 + SLA_ENTRIES_PER_PAGE;
+	const uint64_t Level2 = Level1 + SLA_ENTRIES_PER_PAGE * PFN_ENTRIES_PER_PAGE;
+	const uint64_t Indices[] = {
+		0,
+		MM_SLA_DIRECT_ENTRY_COUNT - 1,
+		Level0,
+		Level0 + 1,
+		Level1 - 1,
+		Level1,
+		Level1 + PFN_ENTRIES_PER_PAGE,
+		Level1 + 12345,
+		Level2 - 1,
+		Level2,
+		Level2 + 987654,
+	};
+
+	for (size_t i = 0; i < ARRAY_COUNT(Indices); i++)
+	{
+		TestAssertMsg(MmLookUpEntrySla(&Sla, Indices[i]) == MM_SLA_NO_DATA, "index %llu", Indices[i]);
+
+		MMSLA_ENTRY Result = MmAssignEntrySla(&Sla, Indices[i], SlaValue(Indices[i]));
+		TestAssertMsg(Result == SlaValue(Indices[i]), "index %llu", Indices[i]);
+	}
+
+	for (size_t i = 0; i < ARRAY_COUNT(Indices); i++)
+		TestAssertMsg(MmLookUpEntrySla(&Sla, Indices[i]) == SlaValue(Indices[i]), "index %llu", Indices[i]);
+
+	// Neighbours of assigned entries must not be affected.
+	TestAssert(MmLookUpEntrySla(&Sla, 1) == MM_SLA_NO_DATA);
+	TestAssert(MmLookUpEntrySla(&Sla, Level0 + 2) == MM_SLA_NO_DATA);
+	TestAssert(MmLookUpEntrySla(&Sla, Level1 + 1) == MM_SLA_NO_DATA);
+	TestAssert(MmLookUpEntrySla(&Sla, Level2 + 1) == MM_SLA_NO_DATA);
+
+	// The reference function is called for each entry which is looked up.
+	SlaReferencedEntryCount = 0;
+	TestAssert(MmLookUpEntrySlaEx(&Sla, Level1, SlaReferenceEntry) == SlaValue(Level1));
+	TestAssert(MmLookUpEntrySlaEx(&Sla, 0, SlaReferenceEntry) == SlaValue(0));
+	TestAssert(SlaReferencedEntryCount == 2);
+
+	// Overwriting an entry.
+	MmAssignEntrySla(&Sla, Level1, 42);
+	TestAssert(MmLookUpEntrySla(&Sla, Level1) == 42);
+	MmAssignEntrySla(&Sla, Level1, SlaValue(Level1));
+
+	TestAssert(HostGetAllocatedPhysicalPageCount() > PagesBefore);
+
+	// Deinitializing frees every entry and every page used for the indirections.
+	SlaFreedEntryCount = 0;
+	MmDeinitializeSla(&Sla, SlaFreeEntry);
+
+	TestAssertMsg(SlaFreedEntryCount == ARRAY_COUNT(Indices), "%zu entries freed", SlaFreedEntryCount);
+	TestAssertMsg(
+		HostGetAllocatedPhysicalPageCount() == PagesBefore,
+		"%zu pages leaked",
+		HostGetAllocatedPhysicalPageCount() - PagesBefore
+	);
+}
+
+void SlaBenchmark()
+{
+	MMSLA Sla;
+	MmInitializeSla(&Sla);
+
+	uint64_t Count = BENCH_ITERATIONS(SLA_BENCH_COUNT);
+
+	// Sequential assignment, like a file being read into the page cache.
+	uint64_t Start = BenchGetTime();
+	for (uint64_t i = 0; i < Count; i++)
+		MmAssignEntrySla(&Sla, i, SlaValue(i));
+	BenchReport("sla_assign_sequential", 1, Count, BenchGetTime() - Start);
+
+	Start = BenchGetTime();
+	for (uint64_t i = 0; i < Count; i++)
+	{
+		if (MmLookUpEntrySla(&Sla, i) != SlaValue(i))
+			TestAssert(!"lookup failed");
+	}
+	BenchReport("sla_lookup_sequential", 1, Count, BenchGetTime() - Start);
+
+	uint32_t State = 1;
+	Start = BenchGetTime();
+	for (uint64_t i = 0; i < Count; i++)
+	{
+		uint64_t Index = BenchRandom(&State) % Count;
+		if (MmLookUpEntrySla(&Sla, Index) != SlaValue(Index))
+			TestAssert(!"lookup failed");
+	}
+	BenchReport("sla_lookup_random", 1, Count, BenchGetTime() - Start);
+
+	Start = BenchGetTime();
+	MmDeinitializeSla(&Sla, SlaFreeEntry);
+	BenchReport("sla_deinitialize", 1, Count, BenchGetTime() - Start);
+
+	// Sparse assignment, like a large anonymous section touched here and there.
+	MmInitializeSla(&Sla);
+
+	Start = BenchGetTime();
+	for (uint64_t i = 0; i < Count / 64; i++)
+	{
+		uint64_t Index = (uint64_t) BenchRandom(&State) * 64;
+		MmAssignEntrySla(&Sla, Index, SlaValue(Index));
+	}
+	BenchReport("sla_assign_sparse", 1, Count / 64, BenchGetTime() - Start);
+
+	MmDeinitializeSla(&Sla, SlaFreeEntry);
+}
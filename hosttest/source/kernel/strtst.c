@@ -0,0 +1,206 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	kernel/strtst.c
+
+Abstract:
+	This module implements the tests and benchmarks of the
+	string routines in rtl/string.c.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <main.h>
+#include <string.h>
+#include "testfmk.h"
+
+#define STRING_BUFFER_SIZE (4096)
+
+static uint8_t StringSource[STRING_BUFFER_SIZE + 64];
+static uint8_t StringDest[STRING_BUFFER_SIZE + 64];
+
+static uint8_t StringPattern(size_t Index)
+{
+	return (uint8_t)(Index * 7 + 3);
+}
+
+static void StringFillSource()
+{
+	for (size_t i = 0; i < sizeof StringSource; i++)
+		StringSource[i] = StringPattern(i);
+}
+
+// Copies with every combination of small sizes and misalignments, and checks
+// that no byte outside of the destination range is touched.
+static void StringTestMemcpy()
+{
+	StringFillSource();
+
+	for (size_t Size = 0; Size < 80; Size++)
+	{
+		for (size_t SrcOffset = 0; SrcOffset < 8; SrcOffset++)
+		{
+			for (size_t DstOffset = 0; DstOffset < 8; DstOffset++)
+			{
+				for (size_t i = 0; i < sizeof StringDest; i++)
+					StringDest[i] = 0xCC;
+
+				void* Result = memcpy(StringDest + DstOffset, StringSource + SrcOffset, Size);
+				TestAssert(Result == StringDest + DstOffset);
+
+				for (size_t i = 0; i < 96; i++)
+				{
+					uint8_t Expected = 0xCC;
+					if (i >= DstOffset && i < DstOffset + Size)
+						Expected = StringPattern(i - DstOffset + SrcOffset);
+
+					TestAssertMsg(StringDest[i] == Expected, "size %zu, src+%zu, dst+%zu, byte %zu", Size, SrcOffset, DstOffset, i);
+				}
+			}
+		}
+	}
+}
+
+static void StringTestMemmove()
+{
+	// Overlapping forwards and backwards.
+	for (int Shift = -9; Shift <= 9; Shift++)
+	{
+		for (size_t i = 0; i < 128; i++)
+			StringDest[i] = StringPattern(i);
+
+		size_t Src = 32, Dst = 32 + Shift, Size = 50;
+		memmove(StringDest + Dst, StringDest + Src, Size);
+
+		for (size_t i = 0; i < Size; i++)
+			TestAssertMsg(StringDest[Dst + i] == StringPattern(Src + i), "shift %d, byte %zu", Shift, i);
+	}
+}
+
+static void StringTestMemsetMemcmp()
+{
+	for (size_t Size = 0; Size < 70; Size++)
+	{
+		for (size_t i = 0; i < 80; i++)
+			StringDest[i] = 0;
+
+		memset(StringDest + 3, 0x5A, Size);
+
+		for (size_t i = 0; i < 80; i++)
+		{
+			uint8_t Expected = (i >= 3 && i < 3 + Size) ? 0x5A : 0;
+			TestAssertMsg(StringDest[i] == Expected, "size %zu, byte %zu", Size, i);
+		}
+	}
+
+	TestAssert(memcmp("abcd", "abcd", 4) == 0);
+	TestAssert(memcmp("abcd", "abce", 4) < 0);
+	TestAssert(memcmp("abce", "abcd", 4) > 0);
+	TestAssert(memcmp("\x80", "\x7F", 1) > 0);
+	TestAssert(memcmp("x", "y", 0) == 0);
+}
+
+static void StringTestStrings()
+{
+	char Buffer[16];
+
+	TestAssert(strlen("") == 0);
+	TestAssert(strlen("Boron") == 5);
+
+	TestAssert(strcmp("abc", "abc") == 0);
+	TestAssert(strcmp("abc", "abd") < 0);
+	TestAssert(strcmp("abc", "ab") > 0);
+	TestAssert(strcmp("ab", "abc") < 0);
+
+	TestAssert(strncmp("abcdef", "abcxyz", 3) == 0);
+	TestAssert(strncmp("abcdef", "abcxyz", 4) < 0);
+	TestAssert(strncmp("ab", "ab", 10) == 0);
+
+	TestAssert(strcmp(strchr("hello", 'l'), "llo") == 0);
+	TestAssert(strchr("hello", 'z') == NULL);
+
+	TestAssert(strcmp(strstr("the quick fox", "quick"), "quick fox") == 0);
+	TestAssert(strstr("the quick fox", "slow") == NULL);
+
+	// strncpy pads the rest of the buffer with zeroes.
+	memset(Buffer, 'X', sizeof Buffer);
+	strncpy(Buffer, "abc", 8);
+	TestAssert(memcmp(Buffer, "abc\0\0\0\0\0XXXXXXXX", 16) == 0);
+
+	// StringCopySafe always terminates the string.
+	memset(Buffer, 'X', sizeof Buffer);
+	StringCopySafe(Buffer, "abcdefgh", 4);
+	TestAssert(strcmp(Buffer, "abc") == 0);
+	StringCopySafe(Buffer, "ab", sizeof Buffer);
+	TestAssert(strcmp(Buffer, "ab") == 0);
+	TestAssert(StringCopySafe(Buffer, "ab", 0) == NULL);
+
+	strcpy(Buffer, "foo");
+	strcat(Buffer, "bar");
+	TestAssert(strcmp(Buffer, "foobar") == 0);
+
+	TestAssert(StringMatchesCaseInsensitive("BoRoN", "boron", 5));
+	TestAssert(!StringMatchesCaseInsensitive("Boron", "Borax", 5));
+	TestAssert(StringContainsCaseInsensitive("/InitRoot/Test.SYS", "test.sys"));
+	TestAssert(!StringContainsCaseInsensitive("short", "much longer"));
+}
+
+void StringTest()
+{
+	StringTestMemcpy();
+	StringTestMemmove();
+	StringTestMemsetMemcmp();
+	StringTestStrings();
+}
+
+static void StringBenchmarkCopy(size_t Size, int Iterations)
+{
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < Iterations; i++)
+		memcpy(StringDest, StringSource, Size);
+
+	BenchReportSize("memcpy", Size, 1, Iterations, BenchGetTime() - Start);
+}
+
+static void StringBenchmarkSet(size_t Size, int Iterations)
+{
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < Iterations; i++)
+		memset(StringDest, i, Size);
+
+	BenchReportSize("memset", Size, 1, Iterations, BenchGetTime() - Start);
+}
+
+void StringBenchmark()
+{
+	static const size_t Sizes[] = { 16, 256, 4096 };
+
+	StringFillSource();
+
+	for (size_t i = 0; i < ARRAY_COUNT(Sizes); i++)
+	{
+		int Iterations = BENCH_ITERATIONS(4 * 1024 * 1024 / (int) Sizes[i] * 16);
+		StringBenchmarkCopy(Sizes[i], Iterations);
+		StringBenchmarkSet(Sizes[i], Iterations);
+	}
+
+	// strcmp and strlen on a path-like string, as used by the object manager.
+	static const char Path1[] = "/Devices/Nvme0Disk1/Partition0/Boron/System/test.sys";
+	static const char Path2[] = "/Devices/Nvme0Disk1/Partition0/Boron/System/test.syx";
+	int Iterations = BENCH_ITERATIONS(4000000);
+	volatile int Sink = 0;
+
+	uint64_t Start = BenchGetTime();
+	for (int i = 0; i < Iterations; i++)
+		Sink += strcmp(Path1, Path2);
+	BenchReport("strcmp_path", 1, Iterations, BenchGetTime() - Start);
+
+	Start = BenchGetTime();
+	for (int i = 0; i < Iterations; i++)
+		Sink += (int) strlen(Path1);
+	BenchReport("strlen_path", 1, Iterations, BenchGetTime() - Start);
+}
@@ -0,0 +1,295 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	user/heaptst.c
+
+Abstract:
+	This module implements the tests and benchmarks of the
+	libboron heap manager in heap.c.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <boron.h>
+#include <string.h>
+#include "pebteb.h"
+#include "testfmk.h"
+
+#define HEAP_TEST_COUNT    (2000)
+#define HEAP_BENCH_SLOTS   (256)
+#define HEAP_MAX_THREADS   (8)
+
+// The size of the arenas that the heap maps, DEFAULT_ARENA_SIZE in heap.c.
+#define HEAP_ARENA_SIZE    (128 * 1024)
+
+// Objects of this size fill the largest size class, whose slabs hold the fewest objects.
+#define HEAP_CACHE_OBJECT_SIZE (1000)
+#define HEAP_CACHE_SIZE_CLASS  (OS_HEAP_SIZE_CLASS_COUNT - 1)
+
+extern void OSDLLInitializeGlobalHeap();
+extern void OSDLLFlushHeapCache();
+
+static void* HeapBlocks[HEAP_TEST_COUNT];
+static size_t HeapSizes[HEAP_TEST_COUNT];
+
+static void HeapEnsureGlobalHeap()
+{
+	static bool Initialized;
+
+	if (!Initialized)
+	{
+		OSDLLInitializeGlobalHeap();
+		Initialized = true;
+	}
+}
+
+// Mostly small sizes spread over the size classes, with some large ones mixed in.
+static size_t HeapTestSize(uint32_t* State)
+{
+	uint32_t Random = BenchRandom(State);
+
+	if (Random % 16 == 0)
+		return 1025 + Random % 40000;
+
+	return 1 + Random % 1024;
+}
+
+static uint8_t HeapPattern(size_t Block)
+{
+	return (uint8_t)(Block * 13 + 5);
+}
+
+static void HeapCheckBlock(size_t Block)
+{
+	uint8_t* Memory = HeapBlocks[Block];
+	uint8_t Expected = HeapPattern(Block);
+
+	for (size_t i = 0; i < HeapSizes[Block]; i++)
+		TestAssertMsg(Memory[i] == Expected, "block %zu (size %zu) was overwritten at byte %zu", Block, HeapSizes[Block], i);
+}
+
+// Allocates blocks of various sizes, fills each with its own pattern, and checks
+// that no block overwrote another.  Then frees them in a scrambled order.
+static void HeapTestAllocations(void* (*Allocate)(void*, size_t), void (*Free)(void*, void*), void* Heap)
+{
+	uint32_t State = 1;
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i++)
+	{
+		HeapSizes[i] = HeapTestSize(&State);
+		HeapBlocks[i] = Allocate(Heap, HeapSizes[i]);
+		TestAssertMsg(HeapBlocks[i], "allocation of %zu bytes failed", HeapSizes[i]);
+		TestAssert(((uintptr_t) HeapBlocks[i] & 7) == 0);
+		memset(HeapBlocks[i], HeapPattern(i), HeapSizes[i]);
+	}
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i++)
+		HeapCheckBlock(i);
+
+	// Free half of them, reallocate them with other sizes, and check again.
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i += 2)
+		Free(Heap, HeapBlocks[i]);
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i += 2)
+	{
+		HeapSizes[i] = HeapTestSize(&State);
+		HeapBlocks[i] = Allocate(Heap, HeapSizes[i]);
+		TestAssert(HeapBlocks[i]);
+		memset(HeapBlocks[i], HeapPattern(i), HeapSizes[i]);
+	}
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i++)
+		HeapCheckBlock(i);
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i++)
+	{
+		size_t Block = (i * 7919) % HEAP_TEST_COUNT;
+		Free(Heap, HeapBlocks[Block]);
+		HeapBlocks[Block] = NULL;
+	}
+}
+
+static void* HeapAllocateOwn(void* Heap, size_t Size)
+{
+	return OSAllocateHeap(Heap, Size);
+}
+
+static void HeapFreeOwn(void* Heap, void* Memory)
+{
+	OSFreeHeap(Heap, Memory);
+}
+
+static void* HeapAllocateGlobal(void* Heap, size_t Size)
+{
+	(void) Heap;
+	return OSAllocate(Size);
+}
+
+static void HeapFreeGlobal(void* Heap, void* Memory)
+{
+	(void) Heap;
+	OSFree(Memory);
+}
+
+// Fills the thread's cache by pretending that the global heap is contended, then
+// flushes it like OSExitThread does, and checks that the slabs which the cached
+// objects kept alive were released.
+static void HeapTestThreadCache()
+{
+	POS_HEAP_CACHE Cache = &OSDLLTryGetCurrentTeb()->HeapCache;
+	size_t BytesBefore = HostGetAllocatedPageBytes();
+
+	HostSetContention(true);
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i++)
+	{
+		HeapBlocks[i] = OSAllocate(HEAP_CACHE_OBJECT_SIZE);
+		TestAssert(HeapBlocks[i]);
+	}
+
+	for (size_t i = 0; i < HEAP_TEST_COUNT; i++)
+	{
+		OSFree(HeapBlocks[i]);
+		HeapBlocks[i] = NULL;
+	}
+
+	HostSetContention(false);
+
+	TestAssert(Cache->Counts[HEAP_CACHE_SIZE_CLASS] != 0);
+
+	OSDLLFlushHeapCache();
+
+	for (int i = 0; i < OS_HEAP_SIZE_CLASS_COUNT; i++)
+	{
+		TestAssert(Cache->Counts[i] == 0);
+		TestAssert(Cache->Objects[i] == NULL);
+	}
+
+	// The size class may keep one empty slab around, but nothing else.
+	TestAssertMsg(
+		HostGetAllocatedPageBytes() <= BytesBefore + HEAP_ARENA_SIZE,
+		"%zu bytes are still allocated",
+		HostGetAllocatedPageBytes() - BytesBefore
+	);
+}
+
+void HeapTest()
+{
+	size_t BytesBefore = HostGetAllocatedPageBytes();
+
+	OS_HEAP Heap;
+	TestAssert(SUCCEEDED(OSInitializeHeap(&Heap)));
+
+	TestAssert(OSAllocateHeap(&Heap, 0) == NULL);
+	OSFreeHeap(&Heap, NULL);
+
+	HeapTestAllocations(HeapAllocateOwn, HeapFreeOwn, &Heap);
+
+	// Deleting a heap returns all of its memory, including blocks which weren't freed.
+	for (size_t i = 0; i < 100; i++)
+		TestAssert(OSAllocateHeap(&Heap, 16 + i * 100));
+
+	OSDeleteHeap(&Heap);
+
+	TestAssertMsg(
+		HostGetAllocatedPageBytes() == BytesBefore,
+		"%zu bytes leaked",
+		HostGetAllocatedPageBytes() - BytesBefore
+	);
+
+	HeapEnsureGlobalHeap();
+	HeapTestThreadCache();
+	HeapTestAllocations(HeapAllocateGlobal, HeapFreeGlobal, NULL);
+}
+
+static void HeapBenchmarkChurn(const char* Name, size_t MaxSize, int Iterations)
+{
+	void* Slots[HEAP_BENCH_SLOTS];
+	memset(Slots, 0, sizeof Slots);
+
+	uint32_t State = 1;
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < Iterations; i++)
+	{
+		uint32_t Random = BenchRandom(&State);
+		size_t Slot = Random % HEAP_BENCH_SLOTS;
+
+		OSFree(Slots[Slot]);
+		Slots[Slot] = OSAllocate(1 + (Random >> 8) % MaxSize);
+	}
+
+	BenchReport(Name, 1, Iterations, BenchGetTime() - Start);
+
+	for (size_t i = 0; i < HEAP_BENCH_SLOTS; i++)
+		OSFree(Slots[i]);
+}
+
+typedef struct
+{
+	int Iterations;
+	uint32_t Seed;
+}
+HEAP_BENCH_THREAD, *PHEAP_BENCH_THREAD;
+
+static void HeapBenchmarkThread(void* Context)
+{
+	PHEAP_BENCH_THREAD Thread = Context;
+	void* Slots[HEAP_BENCH_SLOTS / 4];
+	memset(Slots, 0, sizeof Slots);
+
+	uint32_t State = Thread->Seed;
+
+	for (int i = 0; i < Thread->Iterations; i++)
+	{
+		uint32_t Random = BenchRandom(&State);
+		size_t Slot = Random % ARRAY_COUNT(Slots);
+
+		OSFree(Slots[Slot]);
+		Slots[Slot] = OSAllocate(16 + (Random >> 8) % 240);
+	}
+
+	for (size_t i = 0; i < ARRAY_COUNT(Slots); i++)
+		OSFree(Slots[i]);
+}
+
+static void HeapBenchmarkThreads(int ThreadCount, int Iterations)
+{
+	HEAP_BENCH_THREAD Threads[HEAP_MAX_THREADS];
+	void* Handles[HEAP_MAX_THREADS];
+
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < ThreadCount; i++)
+	{
+		Threads[i].Iterations = Iterations;
+		Threads[i].Seed = i + 1;
+		Handles[i] = HostCreateThread(HeapBenchmarkThread, &Threads[i]);
+		TestAssert(Handles[i]);
+	}
+
+	for (int i = 0; i < ThreadCount; i++)
+		HostJoinThread(Handles[i]);
+
+	BenchReport("heap_small_threads", ThreadCount, (uint64_t) Iterations * ThreadCount, BenchGetTime() - Start);
+}
+
+void HeapBenchmark()
+{
+	HeapEnsureGlobalHeap();
+
+	int Iterations = BENCH_ITERATIONS(2000000);
+	HeapBenchmarkChurn("heap_small_churn", 256, Iterations);
+	HeapBenchmarkChurn("heap_mixed_churn", 8192, Iterations / 4);
+
+	int ThreadCount = HostGetProcessorCount();
+	if (ThreadCount > HEAP_MAX_THREADS)
+		ThreadCount = HEAP_MAX_THREADS;
+
+	HeapBenchmarkThreads(1, Iterations / 2);
+
+	if (ThreadCount > 1)
+		HeapBenchmarkThreads(ThreadCount, Iterations / 2);
+}
@@ -0,0 +1,112 @@
+/***
+	The Boron Operating System
+	Copyright (C) 2026 iProgramInCpp
+
+Module name:
+	user/ushim.c
+
+Abstract:
+	This module implements the system services and libboron
+	internals used by the libboron modules that are built for
+	the host.
+
+	Virtual memory comes from the host, critical sections are
+	plain spin locks which yield to the host's scheduler, and
+	each thread gets its own TEB, so that the heap's thread
+	caches are used like they are on Boron.  Tests can also
+	pretend that every critical section is contended, so that
+	the thread caches are used every time.
+
+Author:
+	iProgramInCpp - 19 October 2026
+***/
+#include <boron.h>
+#include <atom.h>
+#include "pebteb.h"
+#include "hostsup.h"
+
+static _Thread_local TEB HostTeb;
+static _Thread_local bool HostContended;
+
+PTEB OSDLLTryGetCurrentTeb()
+{
+	return &HostTeb;
+}
+
+BSTATUS OSAllocateVirtualMemory(
+	HANDLE ProcessHandle,
+	void** BaseAddress,
+	size_t* RegionSize,
+	int AllocationType,
+	int Protection
+)
+{
+	if (ProcessHandle != CURRENT_PROCESS_HANDLE ||
+	    *BaseAddress != NULL ||
+	    AllocationType != (MEM_RESERVE | MEM_COMMIT) ||
+	    Protection != (PAGE_READ | PAGE_WRITE))
+		return STATUS_UNIMPLEMENTED;
+
+	size_t Size = (*RegionSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+	void* Address = HostAllocatePages(Size);
+	if (!Address)
+		return STATUS_INSUFFICIENT_MEMORY;
+
+	*BaseAddress = Address;
+	*RegionSize = Size;
+	return STATUS_SUCCESS;
+}
+
+BSTATUS OSFreeVirtualMemory(HANDLE ProcessHandle, void* BaseAddress, size_t RegionSize, int FreeType)
+{
+	if (ProcessHandle != CURRENT_PROCESS_HANDLE || FreeType != MEM_RELEASE)
+		return STATUS_UNIMPLEMENTED;
+
+	HostFreePages(BaseAddress, (RegionSize + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1));
+	return STATUS_SUCCESS;
+}
+
+BSTATUS OSInitializeCriticalSection(POS_CRITICAL_SECTION CriticalSection)
+{
+	CriticalSection->Locked = 0;
+	CriticalSection->MaxSpins = 100;
+	CriticalSection->EventHandle = HANDLE_NONE;
+	return STATUS_SUCCESS;
+}
+
+void OSDeleteCriticalSection(UNUSED POS_CRITICAL_SECTION CriticalSection)
+{
+}
+
+void HostSetContention(bool Contended)
+{
+	HostContended = Contended;
+}
+
+static bool HostTryEnterCriticalSection(POS_CRITICAL_SECTION CriticalSection)
+{
+	int Expected = 0;
+	return AtCompareExchange(&CriticalSection->Locked, &Expected, 1);
+}
+
+bool OSTryEnterCriticalSection(POS_CRITICAL_SECTION CriticalSection)
+{
+	if (HostContended)
+		return false;
+
+	return HostTryEnterCriticalSection(CriticalSection);
+}
+
+void OSEnterCriticalSection(POS_CRITICAL_SECTION CriticalSection)
+{
+	for (int i = 0; !HostTryEnterCriticalSection(CriticalSection); i++)
+	{
+		if (i >= CriticalSection->MaxSpins)
+			HostYield();
+	}
+}
+
+void OSLeaveCriticalSection(POS_CRITICAL_SECTION CriticalSection)
+{
+	AtStore(CriticalSection->Locked, 0);
+}
@@ -156,6 +156,29 @@ void CmdSystemInfoMemory()
 	OSPrintf("Page Size:             %u\n", MemoryInfo.PageSize);
 	OSPrintf("Total Physical Memory: %zu KB\n", MemoryInfo.TotalPhysicalMemoryPages * MemoryInfo.PageSize / 1024);
 	OSPrintf("Free Physical Memory:  %zu KB\n", MemoryInfo.FreePhysicalMemoryPages * MemoryInfo.PageSize / 1024);
+	OSPrintf("Compressed Pages:      %zu (%zu KB in %zu KB)\n",
+		MemoryInfo.CompressedStorePages,
+		MemoryInfo.CompressedStorePages * MemoryInfo.PageSize / 1024,
+		MemoryInfo.CompressedStoreBytes / 1024);
+	OSPrintf("Page Compressions:     %llu (%llu rejected)\n", MemoryInfo.PageCompressions, MemoryInfo.PageCompressionRejections);
+	OSPrintf("Page Decompressions:   %llu\n", MemoryInfo.PageDecompressions);
+	
+	if (MemoryInfo.PageFileTotalPages != 0)
+	{
+		OSPrintf("Page File:             %zu KB used of %zu KB\n",
+			MemoryInfo.PageFileUsedPages * MemoryInfo.PageSize / 1024,
+			MemoryInfo.PageFileTotalPages * MemoryInfo.PageSize / 1024);
+		OSPrintf("Page File Writes:      %llu (%llu read back)\n", MemoryInfo.PageFileWrites, MemoryInfo.PageFileReads);
+	}
+	
+	if (MemoryInfo.HugePageSize == 0)
+		return;
+	
+	OSPrintf("Huge Page Size:        %u KB\n", MemoryInfo.HugePageSize / 1024);
+	OSPrintf("Huge Pages In Use:     %zu (%zu KB)\n", MemoryInfo.HugePagesInUse, MemoryInfo.HugePagesInUse * MemoryInfo.HugePageSize / 1024);
+	OSPrintf("Huge Page Allocations: %llu\n", MemoryInfo.HugePageAllocations);
+	OSPrintf("Huge Page Fallbacks:   %llu\n", MemoryInfo.HugePageFallbacks);
+	OSPrintf("Huge Page Splits:      %llu\n", MemoryInfo.HugePageSplits);
 }
 
 void CmdTest1()
@@ -180,9 +203,344 @@ void CmdTest1()
 	}
 }
 
-void CmdSystemInfoProcess()
+#define SCHED_INFO_BUFFER_SIZE (64 * 1024)
+
+// Queries a system information class whose size isn't known in advance.
+static void* CmdQuerySystemInformation(uint32_t QueryType, size_t* WrittenSize, const char* What)
+{
+	void* Buffer = OSAllocate(SCHED_INFO_BUFFER_SIZE);
+	if (!Buffer) {
+		OSFPrintf(FILE_STANDARD_ERROR, "Could not get %s info: out of memory\n", What);
+		return NULL;
+	}
+	
+	BSTATUS Status = OSQuerySystemInformation(
+		QueryType,
+		Buffer,
+		SCHED_INFO_BUFFER_SIZE,
+		WrittenSize
+	);
+	
+	if (FAILED(Status)) {
+		OSFPrintf(FILE_STANDARD_ERROR, "Could not get %s info: %s\n", What, RtlGetStatusString(Status));
+		OSFree(Buffer);
+		return NULL;
+	}
+	
+	return Buffer;
+}
+
+void CmdSystemInfoProcess(UNUSED const char* Arguments)
+{
+	size_t WrittenSize = 0;
+	PSYSTEM_PROCESS_INFORMATION Buffer = CmdQuerySystemInformation(QUERY_PROCESS_INFORMATION, &WrittenSize, "process");
+	if (!Buffer)
+		return;
+	
+	uint64_t Frequency = 1;
+	OSGetTickFrequency(&Frequency);
+	
+	OSPrintf("PID    Threads  Main Run (ms)  WS Pages Peak     Faults     Trimmed  Image Name\n");
+	
+	for (PSYSTEM_PROCESS_INFORMATION Info = Buffer;
+	     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+	     Info = NEXT_SYSTEM_INFORMATION(Info))
+	{
+		OSPrintf(
+			"%-6zu %-8d %-14llu %-8zu %-8zu %-10llu %-8llu %s\n",
+			(size_t) Info->ProcessId,
+			Info->ThreadCount,
+			Info->ThreadCount ? Info->MainThread.RunTime * 1000 / Frequency : 0,
+			Info->WorkingSetPages,
+			Info->PeakWorkingSetPages,
+			Info->PageFaultCount,
+			Info->TrimmedPages,
+			Info->ImageName
+		);
+	}
+	
+	OSFree(Buffer);
+}
+
+void CmdSystemInfoThreads(UNUSED const char* Arguments)
+{
+	size_t WrittenSize = 0;
+	PSYSTEM_THREAD_INFORMATION Buffer = CmdQuerySystemInformation(QUERY_THREAD_INFORMATION, &WrittenSize, "thread");
+	if (!Buffer)
+		return;
+	
+	uint64_t Frequency = 1;
+	OSGetTickFrequency(&Frequency);
+	
+	OSPrintf("PID    St Pri CPU Run (ms)   Wait (ms)  Ready (ms) MaxLat(us) Vol      Invol    Migr\n");
+	
+	for (PSYSTEM_THREAD_INFORMATION Info = Buffer;
+	     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+	     Info = NEXT_SYSTEM_INFORMATION(Info))
+	{
+		OSPrintf(
+			"%-6u %-2d %-3d %-3d %-10llu %-10llu %-10llu %-10llu %-8llu %-8llu %llu\n",
+			Info->ParentProcessId,
+			Info->Status,
+			Info->Priority,
+			Info->LastProcessor,
+			Info->RunTime * 1000 / Frequency,
+			Info->WaitTime * 1000 / Frequency,
+			Info->ReadyTime * 1000 / Frequency,
+			Info->MaxReadyLatency * 1000000 / Frequency,
+			Info->VoluntarySwitches,
+			Info->InvoluntarySwitches,
+			Info->Migrations
+		);
+	}
+	
+	OSFree(Buffer);
+}
+
+void CmdSystemInfoProcessors(UNUSED const char* Arguments)
+{
+	size_t WrittenSize = 0;
+	PSYSTEM_PROCESSOR_INFORMATION Buffer = CmdQuerySystemInformation(QUERY_PROCESSOR_INFORMATION, &WrittenSize, "processor");
+	if (!Buffer)
+		return;
+	
+	uint64_t Frequency = 1;
+	OSGetTickFrequency(&Frequency);
+	
+	OSPrintf("CPU  Busy (ms)  Switches   Steals     IPIs       DPCs       Interrupts\n");
+	
+	for (PSYSTEM_PROCESSOR_INFORMATION Info = Buffer;
+	     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+	     Info = NEXT_SYSTEM_INFORMATION(Info))
+	{
+		OSPrintf(
+			"%-4u %-10llu %-10llu %-10llu %-10llu %-10llu %llu\n",
+			Info->ProcessorId,
+			Info->BusyTime * 1000 / Frequency,
+			Info->ContextSwitches,
+			Info->WorkSteals,
+			Info->IpisReceived,
+			Info->DpcsRun,
+			Info->Interrupts
+		);
+	}
+	
+	OSFree(Buffer);
+}
+
+#define LOCK_INFO_BUFFER_SIZE (64 * 1024)
+#define LOCK_INFO_SHOWN (20)
+
+void CmdSystemInfoLocks(UNUSED const char* Arguments)
+{
+	PSYSTEM_LOCK_INFORMATION Buffer = OSAllocate(LOCK_INFO_BUFFER_SIZE);
+	if (!Buffer) {
+		OSFPrintf(FILE_STANDARD_ERROR, "Could not get lock info: out of memory\n");
+		return;
+	}
+	
+	size_t WrittenSize = 0;
+	BSTATUS Status = OSQuerySystemInformation(
+		QUERY_LOCK_INFORMATION,
+		Buffer,
+		LOCK_INFO_BUFFER_SIZE,
+		&WrittenSize
+	);
+	
+	if (FAILED(Status)) {
+		OSFPrintf(FILE_STANDARD_ERROR, "Could not get lock info: %s\n", RtlGetStatusString(Status));
+		OSFree(Buffer);
+		return;
+	}
+	
+	uint64_t Frequency = 1;
+	OSGetTickFrequency(&Frequency);
+	
+	static const char* const TypeNames[] = { "spin", "mutex", "rw-excl", "rw-shrd" };
+	
+	OSPrintf("Type     Acquired   Contended  Wait (us)  Max Wait   Max Hold   Call Site\n");
+	
+	// Print the lock classes with the most time spent waiting first.  Entries that
+	// were already printed are marked by clearing their Acquisitions member.
+	for (int Shown = 0; Shown < LOCK_INFO_SHOWN; Shown++)
+	{
+		PSYSTEM_LOCK_INFORMATION Worst = NULL;
+		
+		for (PSYSTEM_LOCK_INFORMATION Info = Buffer;
+		     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+		     Info = NEXT_SYSTEM_INFORMATION(Info))
+		{
+			if (!Info->Acquisitions)
+				continue;
+			
+			if (!Worst || Worst->TotalWaitTime < Info->TotalWaitTime)
+				Worst = Info;
+		}
+		
+		if (!Worst)
+			break;
+		
+		OSPrintf(
+			"%-8s %-10llu %-10llu %-10llu %-10llu %-10llu %s (%p)\n",
+			Worst->Type < (short) ARRAY_COUNT(TypeNames) ? TypeNames[Worst->Type] : "?",
+			Worst->Acquisitions,
+			Worst->ContendedAcquisitions,
+			Worst->TotalWaitTime * 1000000 / Frequency,
+			Worst->MaxWaitTime * 1000000 / Frequency,
+			Worst->MaxHoldTime * 1000000 / Frequency,
+			Worst->CallSiteName[0] ? Worst->CallSiteName : "??",
+			(void*) Worst->CallSite
+		);
+		
+		Worst->Acquisitions = 0;
+	}
+	
+	OSFree(Buffer);
+}
+
+void CmdSystemInfoBootTrace(UNUSED const char* Arguments)
+{
+	size_t WrittenSize = 0;
+	PSYSTEM_BOOT_TRACE_INFORMATION Buffer = CmdQuerySystemInformation(QUERY_BOOT_TRACE_INFORMATION, &WrittenSize, "boot trace");
+	if (!Buffer)
+		return;
+	
+	uint64_t Frequency = 1;
+	OSGetTickFrequency(&Frequency);
+	
+	uint64_t BootStart = Buffer->StartTime;
+	
+	OSPrintf("Phase                            CPU  Start (us)   Duration (us)\n");
+	
+	for (PSYSTEM_BOOT_TRACE_INFORMATION Info = Buffer;
+	     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+	     Info = NEXT_SYSTEM_INFORMATION(Info))
+	{
+		if (!Info->EndTime)
+		{
+			OSPrintf("%-32s %-4u %-12llu unfinished\n", Info->Name, Info->ProcessorId, (Info->StartTime - BootStart) * 1000000 / Frequency);
+			continue;
+		}
+		
+		OSPrintf(
+			"%-32s %-4u %-12llu %llu\n",
+			Info->Name,
+			Info->ProcessorId,
+			(Info->StartTime - BootStart) * 1000000 / Frequency,
+			(Info->EndTime - Info->StartTime) * 1000000 / Frequency
+		);
+	}
+	
+	OSFree(Buffer);
+}
+
+#define DPC_INFO_SHOWN (20)
+
+void CmdSystemInfoDpcs(UNUSED const char* Arguments)
+{
+	size_t WrittenSize = 0;
+	PSYSTEM_DPC_INFORMATION Buffer = CmdQuerySystemInformation(QUERY_DPC_INFORMATION, &WrittenSize, "DPC");
+	if (!Buffer)
+		return;
+	
+	uint64_t Frequency = 1;
+	OSGetTickFrequency(&Frequency);
+	
+	static const char* const TypeNames[] = { "dpc", "thrd-dpc", "int" };
+	
+	OSPrintf("Type     Vec  Count      Time (us)  Max (us)   Max Lat    Over       Routine\n");
+	
+	// Print the routines with the most time spent running first.  Entries that
+	// were already printed are marked by clearing their Count member.
+	for (int Shown = 0; Shown < DPC_INFO_SHOWN; Shown++)
+	{
+		PSYSTEM_DPC_INFORMATION Worst = NULL;
+		
+		for (PSYSTEM_DPC_INFORMATION Info = Buffer;
+		     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+		     Info = NEXT_SYSTEM_INFORMATION(Info))
+		{
+			if (!Info->Count)
+				continue;
+			
+			if (!Worst || Worst->TotalTime < Info->TotalTime)
+				Worst = Info;
+		}
+		
+		if (!Worst)
+			break;
+		
+		OSPrintf(
+			"%-8s %-4d %-10llu %-10llu %-10llu %-10llu %-10llu %s (%p)\n",
+			Worst->Type < (short) ARRAY_COUNT(TypeNames) ? TypeNames[Worst->Type] : "?",
+			Worst->Vector,
+			Worst->Count,
+			Worst->TotalTime * 1000000 / Frequency,
+			Worst->MaxTime * 1000000 / Frequency,
+			Worst->MaxLatency * 1000000 / Frequency,
+			Worst->OverBudgetCount,
+			Worst->RoutineName[0] ? Worst->RoutineName : "??",
+			(void*) Worst->Routine
+		);
+		
+		Worst->Count = 0;
+	}
+	
+	OSFree(Buffer);
+}
+
+#define POOL_INFO_SHOWN (20)
+
+static uint64_t CmdPoolTagBytes(PSYSTEM_POOL_TAG_INFORMATION Info)
 {
-	OSPrintf("TODO\n");
+	return Info->BigNonPaged.Bytes + Info->BigPaged.Bytes + Info->SlabNonPaged.Bytes + Info->SlabPaged.Bytes;
+}
+
+void CmdSystemInfoPoolTags(UNUSED const char* Arguments)
+{
+	size_t WrittenSize = 0;
+	PSYSTEM_POOL_TAG_INFORMATION Buffer = CmdQuerySystemInformation(QUERY_POOL_TAG_INFORMATION, &WrittenSize, "pool tag");
+	if (!Buffer)
+		return;
+	
+	OSPrintf("Tag   NP Allocs  NP Frees   NP Bytes   P Allocs   P Frees    P Bytes    NP Peak\n");
+	
+	// Print the tags with the most bytes in use first.  Entries that were already
+	// printed are marked by clearing the first character of their tag.
+	for (int Shown = 0; Shown < POOL_INFO_SHOWN; Shown++)
+	{
+		PSYSTEM_POOL_TAG_INFORMATION Worst = NULL;
+		
+		for (PSYSTEM_POOL_TAG_INFORMATION Info = Buffer;
+		     (uintptr_t) Info < (uintptr_t) Buffer + WrittenSize;
+		     Info = NEXT_SYSTEM_INFORMATION(Info))
+		{
+			if (!Info->Tag[0])
+				continue;
+			
+			if (!Worst || CmdPoolTagBytes(Worst) < CmdPoolTagBytes(Info))
+				Worst = Info;
+		}
+		
+		if (!Worst)
+			break;
+		
+		OSPrintf(
+			"%.4s  %-10llu %-10llu %-10llu %-10llu %-10llu %-10llu %llu\n",
+			Worst->Tag,
+			Worst->BigNonPaged.Allocations + Worst->SlabNonPaged.Allocations,
+			Worst->BigNonPaged.Frees + Worst->SlabNonPaged.Frees,
+			Worst->BigNonPaged.Bytes + Worst->SlabNonPaged.Bytes,
+			Worst->BigPaged.Allocations + Worst->SlabPaged.Allocations,
+			Worst->BigPaged.Frees + Worst->SlabPaged.Frees,
+			Worst->BigPaged.Bytes + Worst->SlabPaged.Bytes,
+			Worst->BigNonPaged.PeakBytes + Worst->SlabNonPaged.PeakBytes
+		);
+		
+		Worst->Tag[0] = 0;
+	}
+	
+	OSFree(Buffer);
 }
 
 void CmdShutDown()
@@ -215,6 +573,12 @@ COMMAND_ENTRY CommandTable[] = {
 	ENTRY("bi",       CmdSystemInfoBasic, "Get basic system info"),
 	ENTRY("mi",       CmdSystemInfoMemory, "Get system memory info"),
 	ENTRY("ps",       CmdSystemInfoProcess, "Get system process info"),
+	ENTRY("threads",  CmdSystemInfoThreads, "Get thread scheduler statistics"),
+	ENTRY("cpus",     CmdSystemInfoProcessors, "Get processor scheduler statistics"),
+	ENTRY("locks",    CmdSystemInfoLocks, "Get kernel lock statistics"),
+	ENTRY("boot",     CmdSystemInfoBootTrace, "Get boot phase timings"),
+	ENTRY("dpcs",     CmdSystemInfoDpcs, "Get DPC and interrupt time statistics"),
+	ENTRY("pool",     CmdSystemInfoPoolTags, "Get kernel pool usage by tag"),
 	ENTRY("test1",    CmdTest1, "Run the 'free memory' command in a loop"),
 	ENTRY("shutdown", CmdShutDown, "Shuts down the system"),
 };
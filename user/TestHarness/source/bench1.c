@@ -0,0 +1,32 @@
+#include "testfmk.h"
+
+// System call benchmark.  Measures the round trip of the cheapest system services,
+// which is dominated by the cost of entering and leaving the kernel.
+
+#define BENCH_SYSCALL_ITERATIONS (1000000)
+
+void Bench1SystemCalls()
+{
+	int VersionNumber = 0;
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_SYSCALL_ITERATIONS; i++)
+		OSGetVersionNumber(&VersionNumber);
+
+	BenchReport("syscall_null", 1, BENCH_SYSCALL_ITERATIONS, BenchGetTime() - Start);
+
+	// A system service that references a handle.
+	HANDLE EventHandle;
+	BSTATUS Status = OSCreateEvent(&EventHandle, NULL, EVENT_NOTIFICATION, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateEvent failed: %s", ST(Status));
+
+	int EventState = 0;
+	Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_SYSCALL_ITERATIONS; i++)
+		OSQueryEvent(EventHandle, &EventState);
+
+	BenchReport("syscall_handle", 1, BENCH_SYSCALL_ITERATIONS, BenchGetTime() - Start);
+
+	OSClose(EventHandle);
+}
@@ -0,0 +1,107 @@
+#include "testfmk.h"
+
+// Event ping-pong benchmark.  Two threads, and then two processes, take turns
+// setting an event and waiting on the other one.  Each round trip involves two
+// wake ups and two context switches.
+
+#define BENCH_PING_PONG_ITERATIONS (20000)
+
+typedef struct
+{
+	HANDLE PingEvent;
+	HANDLE PongEvent;
+}
+BENCH_PING_PONG;
+
+static void BenchPongLoop(BENCH_PING_PONG* PingPong)
+{
+	for (int i = 0; i < BENCH_PING_PONG_ITERATIONS; i++)
+	{
+		OSWaitForSingleObject(PingPong->PingEvent, false, WAIT_TIMEOUT_INFINITE);
+		OSSetEvent(PingPong->PongEvent);
+	}
+}
+
+static uint64_t BenchPingLoop(BENCH_PING_PONG* PingPong)
+{
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_PING_PONG_ITERATIONS; i++)
+	{
+		OSSetEvent(PingPong->PingEvent);
+		OSWaitForSingleObject(PingPong->PongEvent, false, WAIT_TIMEOUT_INFINITE);
+	}
+
+	return BenchGetTime() - Start;
+}
+
+static NO_RETURN void BenchPongThread(void* Context)
+{
+	BenchPongLoop(Context);
+	OSExitThread();
+}
+
+static void BenchCreateEvents(BENCH_PING_PONG* PingPong)
+{
+	BSTATUS Status;
+
+	Status = OSCreateEvent(&PingPong->PingEvent, NULL, EVENT_SYNCHRONIZATION, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateEvent failed: %s", ST(Status));
+
+	Status = OSCreateEvent(&PingPong->PongEvent, NULL, EVENT_SYNCHRONIZATION, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateEvent failed: %s", ST(Status));
+}
+
+static void BenchDeleteEvents(BENCH_PING_PONG* PingPong)
+{
+	OSClose(PingPong->PingEvent);
+	OSClose(PingPong->PongEvent);
+}
+
+static void BenchPingPongThreads()
+{
+	BENCH_PING_PONG PingPong;
+	BenchCreateEvents(&PingPong);
+
+	HANDLE ThreadHandle;
+	BSTATUS Status = OSCreateThread(&ThreadHandle, CURRENT_PROCESS_HANDLE, NULL, BenchPongThread, &PingPong, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateThread failed: %s", ST(Status));
+
+	uint64_t Ticks = BenchPingLoop(&PingPong);
+	BenchReport("event_ping_pong_thread", 2, BENCH_PING_PONG_ITERATIONS, Ticks);
+
+	OSWaitForSingleObject(ThreadHandle, false, WAIT_TIMEOUT_INFINITE);
+	OSClose(ThreadHandle);
+	BenchDeleteEvents(&PingPong);
+}
+
+static void BenchPingPongProcesses()
+{
+	BENCH_PING_PONG PingPong;
+	BenchCreateEvents(&PingPong);
+
+	// The child inherits the event handles.
+	HANDLE ChildHandle = HANDLE_NONE;
+	BSTATUS Status = OSForkProcess(&ChildHandle);
+
+	if (Status == STATUS_IS_CHILD_PROCESS)
+	{
+		BenchPongLoop(&PingPong);
+		OSExitProcess(0);
+	}
+
+	TestAssertMsg(SUCCEEDED(Status), "OSForkProcess failed: %s", ST(Status));
+
+	uint64_t Ticks = BenchPingLoop(&PingPong);
+	BenchReport("event_ping_pong_process", 2, BENCH_PING_PONG_ITERATIONS, Ticks);
+
+	OSWaitForSingleObject(ChildHandle, false, WAIT_TIMEOUT_INFINITE);
+	OSClose(ChildHandle);
+	BenchDeleteEvents(&PingPong);
+}
+
+void Bench2Events()
+{
+	BenchPingPongThreads();
+	BenchPingPongProcesses();
+}
@@ -0,0 +1,135 @@
+#include "testfmk.h"
+
+// Pipe benchmark.  Measures the throughput of a pipe between two threads at several
+// transfer sizes, and the latency of a one byte round trip through a pair of pipes.
+
+#define BENCH_PIPE_SIZE            (32768)
+#define BENCH_PIPE_TOTAL_BYTES     (16 * 1024 * 1024)
+#define BENCH_PIPE_LATENCY_ROUNDS  (20000)
+
+typedef struct
+{
+	HANDLE Pipe;
+	HANDLE ReplyPipe;
+	size_t TransferSize;
+	size_t TransferCount;
+}
+BENCH_PIPE;
+
+static char BenchPipeBuffer[BENCH_PIPE_SIZE];
+static char BenchPipeWriterBuffer[BENCH_PIPE_SIZE];
+
+static HANDLE BenchCreatePipe()
+{
+	HANDLE Handle;
+	BSTATUS Status = OSCreatePipe(&Handle, NULL, BENCH_PIPE_SIZE, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreatePipe failed: %s", ST(Status));
+	return Handle;
+}
+
+static void BenchPipeWrite(HANDLE Handle, const void* Buffer, size_t Size)
+{
+	IO_STATUS_BLOCK Iosb;
+	uint64_t OutSize = 0;
+	BSTATUS Status = OSWriteFile(&Iosb, Handle, 0, Buffer, Size, 0, &OutSize);
+	TestAssertMsg(SUCCEEDED(Status), "OSWriteFile failed: %s", ST(Status));
+}
+
+static void BenchPipeRead(HANDLE Handle, void* Buffer, size_t Size)
+{
+	IO_STATUS_BLOCK Iosb;
+	BSTATUS Status = OSReadFile(&Iosb, Handle, 0, Buffer, Size, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+	TestAssert(Iosb.BytesRead == Size);
+}
+
+static NO_RETURN void BenchPipeWriterThread(void* Context)
+{
+	BENCH_PIPE* Pipe = Context;
+
+	for (size_t i = 0; i < Pipe->TransferCount; i++)
+		BenchPipeWrite(Pipe->Pipe, BenchPipeWriterBuffer, Pipe->TransferSize);
+
+	OSExitThread();
+}
+
+static NO_RETURN void BenchPipeEchoThread(void* Context)
+{
+	BENCH_PIPE* Pipe = Context;
+	char Byte;
+
+	for (size_t i = 0; i < Pipe->TransferCount; i++)
+	{
+		BenchPipeRead(Pipe->Pipe, &Byte, 1);
+		BenchPipeWrite(Pipe->ReplyPipe, &Byte, 1);
+	}
+
+	OSExitThread();
+}
+
+static void BenchPipeThroughput(size_t TransferSize)
+{
+	BENCH_PIPE Pipe;
+	Pipe.Pipe = BenchCreatePipe();
+	Pipe.ReplyPipe = HANDLE_NONE;
+	Pipe.TransferSize = TransferSize;
+	Pipe.TransferCount = BENCH_PIPE_TOTAL_BYTES / TransferSize;
+
+	// Fewer transfers for the small sizes, which are dominated by the per call cost.
+	if (Pipe.TransferCount > 100000)
+		Pipe.TransferCount = 100000;
+
+	HANDLE ThreadHandle;
+	BSTATUS Status = OSCreateThread(&ThreadHandle, CURRENT_PROCESS_HANDLE, NULL, BenchPipeWriterThread, &Pipe, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateThread failed: %s", ST(Status));
+
+	uint64_t Start = BenchGetTime();
+
+	for (size_t i = 0; i < Pipe.TransferCount; i++)
+		BenchPipeRead(Pipe.Pipe, BenchPipeBuffer, TransferSize);
+
+	BenchReportSize("pipe_transfer", TransferSize, 2, Pipe.TransferCount, BenchGetTime() - Start);
+
+	OSWaitForSingleObject(ThreadHandle, false, WAIT_TIMEOUT_INFINITE);
+	OSClose(ThreadHandle);
+	OSClose(Pipe.Pipe);
+}
+
+static void BenchPipeLatency()
+{
+	BENCH_PIPE Pipe;
+	Pipe.Pipe = BenchCreatePipe();
+	Pipe.ReplyPipe = BenchCreatePipe();
+	Pipe.TransferSize = 1;
+	Pipe.TransferCount = BENCH_PIPE_LATENCY_ROUNDS;
+
+	HANDLE ThreadHandle;
+	BSTATUS Status = OSCreateThread(&ThreadHandle, CURRENT_PROCESS_HANDLE, NULL, BenchPipeEchoThread, &Pipe, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateThread failed: %s", ST(Status));
+
+	char Byte = 'B';
+	uint64_t Start = BenchGetTime();
+
+	for (size_t i = 0; i < Pipe.TransferCount; i++)
+	{
+		BenchPipeWrite(Pipe.Pipe, &Byte, 1);
+		BenchPipeRead(Pipe.ReplyPipe, &Byte, 1);
+	}
+
+	BenchReport("pipe_round_trip", 2, Pipe.TransferCount, BenchGetTime() - Start);
+
+	OSWaitForSingleObject(ThreadHandle, false, WAIT_TIMEOUT_INFINITE);
+	OSClose(ThreadHandle);
+	OSClose(Pipe.Pipe);
+	OSClose(Pipe.ReplyPipe);
+}
+
+void Bench3Pipes()
+{
+	static const size_t TransferSizes[] = { 64, 1024, 4096, BENCH_PIPE_SIZE };
+
+	for (size_t i = 0; i < ARRAY_COUNT(TransferSizes); i++)
+		BenchPipeThroughput(TransferSizes[i]);
+
+	BenchPipeLatency();
+}
@@ -0,0 +1,131 @@
+#include "testfmk.h"
+
+// File read benchmark.  Reads a file on the tmpfs, and optionally one on an ext2
+// file system (given with -e), in chunks of several sizes.
+//
+// There is no way to bypass the page cache from user mode, so for ext2, the first
+// pass over the file is reported separately from the following ones.  It is only
+// uncached if nothing else has read the file since boot.
+
+#define BENCH_FILE_NAME     "BenchFile.dat"
+#define BENCH_FILE_SIZE     (1024 * 1024)
+#define BENCH_FILE_MAX_SIZE (8 * 1024 * 1024)
+#define BENCH_FILE_PASSES   (8)
+#define BENCH_CHUNK_SIZE    (65536)
+
+static char BenchFileBuffer[BENCH_CHUNK_SIZE];
+
+// Reads the whole file once, in chunks of the given size.  Returns the number of reads.
+static uint64_t BenchReadFile(HANDLE Handle, uint64_t Length, size_t ChunkSize)
+{
+	uint64_t ReadCount = 0;
+
+	for (uint64_t Offset = 0; Offset < Length; Offset += ChunkSize)
+	{
+		IO_STATUS_BLOCK Iosb;
+		BSTATUS Status = OSReadFile(&Iosb, Handle, Offset, BenchFileBuffer, ChunkSize, 0);
+		TestAssertMsg(IOSUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+		ReadCount++;
+	}
+
+	return ReadCount;
+}
+
+static HANDLE BenchCreateTmpfsFile()
+{
+	HANDLE Handle, RootDirHandle;
+	BSTATUS Status;
+
+	OBJECT_ATTRIBUTES Attributes;
+	OSInitializeObjectAttributes(&Attributes);
+	OSSetNameObjectAttributes(&Attributes, "/" BENCH_FILE_NAME);
+
+	// The root directory is on the tmpfs.
+	Status = OSOpenFile(&Handle, &Attributes);
+	if (FAILED(Status))
+	{
+		OSSetNameObjectAttributes(&Attributes, "/");
+		Status = OSOpenFile(&RootDirHandle, &Attributes);
+		TestAssertMsg(SUCCEEDED(Status), "OSOpenFile failed: %s", ST(Status));
+
+		Status = OSCreateFile(&Handle, RootDirHandle, BENCH_FILE_NAME, sizeof(BENCH_FILE_NAME) - 1);
+		TestAssertMsg(SUCCEEDED(Status), "OSCreateFile failed: %s", ST(Status));
+		OSClose(RootDirHandle);
+	}
+
+	for (size_t i = 0; i < sizeof BenchFileBuffer; i++)
+		BenchFileBuffer[i] = (char) i;
+
+	for (uint64_t Offset = 0; Offset < BENCH_FILE_SIZE; Offset += sizeof BenchFileBuffer)
+	{
+		IO_STATUS_BLOCK Iosb;
+		uint64_t OutSize = 0;
+		Status = OSWriteFile(&Iosb, Handle, Offset, BenchFileBuffer, sizeof BenchFileBuffer, 0, &OutSize);
+		TestAssertMsg(SUCCEEDED(Status), "OSWriteFile failed: %s", ST(Status));
+	}
+
+	return Handle;
+}
+
+static void BenchTmpfsReads()
+{
+	static const size_t ChunkSizes[] = { 512, 4096, BENCH_CHUNK_SIZE };
+	HANDLE Handle = BenchCreateTmpfsFile();
+
+	for (size_t i = 0; i < ARRAY_COUNT(ChunkSizes); i++)
+	{
+		uint64_t ReadCount = 0;
+		uint64_t Start = BenchGetTime();
+
+		for (int Pass = 0; Pass < BENCH_FILE_PASSES; Pass++)
+			ReadCount += BenchReadFile(Handle, BENCH_FILE_SIZE, ChunkSizes[i]);
+
+		BenchReportSize("file_read_tmpfs", ChunkSizes[i], 1, ReadCount, BenchGetTime() - Start);
+	}
+
+	OSClose(Handle);
+}
+
+static void BenchExt2Reads()
+{
+	if (!BenchExt2FileName)
+	{
+		TestPrintf("No ext2 file given with -e, skipping ext2 file read benchmarks.");
+		return;
+	}
+
+	HANDLE Handle;
+	OBJECT_ATTRIBUTES Attributes;
+	OSInitializeObjectAttributes(&Attributes);
+	OSSetNameObjectAttributes(&Attributes, BenchExt2FileName);
+
+	BSTATUS Status = OSOpenFile(&Handle, &Attributes);
+	TestAssertMsg(SUCCEEDED(Status), "Could not open %s: %s", BenchExt2FileName, ST(Status));
+
+	uint64_t Length = 0;
+	Status = OSGetLengthFile(Handle, &Length);
+	TestAssertMsg(SUCCEEDED(Status), "OSGetLengthFile failed: %s", ST(Status));
+
+	if (Length > BENCH_FILE_MAX_SIZE)
+		Length = BENCH_FILE_MAX_SIZE;
+
+	uint64_t Start = BenchGetTime();
+	uint64_t ReadCount = BenchReadFile(Handle, Length, BENCH_CHUNK_SIZE);
+	BenchReportSize("file_read_ext2_first", BENCH_CHUNK_SIZE, 1, ReadCount, BenchGetTime() - Start);
+
+	ReadCount = 0;
+	Start = BenchGetTime();
+
+	for (int Pass = 0; Pass < BENCH_FILE_PASSES; Pass++)
+		ReadCount += BenchReadFile(Handle, Length, BENCH_CHUNK_SIZE);
+
+	BenchReportSize("file_read_ext2_cached", BENCH_CHUNK_SIZE, 1, ReadCount, BenchGetTime() - Start);
+
+	OSClose(Handle);
+}
+
+void Bench4Files()
+{
+	BenchTmpfsReads();
+	BenchExt2Reads();
+}
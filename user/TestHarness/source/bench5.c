@@ -0,0 +1,93 @@
+#include "testfmk.h"
+
+// Mapping benchmark.  Maps views of an anonymous section and of a file with
+// OSMapViewOfObject, and measures how fast their pages are faulted in.
+
+#define BENCH_SECTION_SIZE  (16 * 1024 * 1024)
+#define BENCH_MAP_ROUNDS    (4)
+#define BENCH_MAPPED_FILE   "/bin/TestHarness.exe"
+
+static void* BenchMapView(HANDLE Handle, size_t Size, int Protection)
+{
+	void* Address = NULL;
+	BSTATUS Status = OSMapViewOfObject(CURRENT_PROCESS_HANDLE, Handle, &Address, Size, MEM_COMMIT, 0, Protection);
+	TestAssertMsg(SUCCEEDED(Status), "OSMapViewOfObject failed: %s", ST(Status));
+	return Address;
+}
+
+static void BenchUnmapView(void* Address, size_t Size)
+{
+	BSTATUS Status = OSFreeVirtualMemory(CURRENT_PROCESS_HANDLE, Address, Size, MEM_RELEASE);
+	TestAssertMsg(SUCCEEDED(Status), "OSFreeVirtualMemory failed: %s", ST(Status));
+}
+
+static void BenchAnonymousFaults()
+{
+	HANDLE SectionHandle;
+	BSTATUS Status = OSCreateSectionObject(&SectionHandle, NULL, BENCH_SECTION_SIZE);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateSectionObject failed: %s", ST(Status));
+
+	uint64_t Ticks = 0;
+
+	for (int Round = 0; Round < BENCH_MAP_ROUNDS; Round++)
+	{
+		volatile uint8_t* View = BenchMapView(SectionHandle, BENCH_SECTION_SIZE, PAGE_READ | PAGE_WRITE);
+
+		// The first round allocates the section's pages, the following ones only map them.
+		uint64_t Start = BenchGetTime();
+		for (size_t Offset = 0; Offset < BENCH_SECTION_SIZE; Offset += PAGE_SIZE)
+			View[Offset] = (uint8_t) Round;
+
+		if (Round == 0)
+			BenchReport("map_fault_anonymous_new", 1, BENCH_SECTION_SIZE / PAGE_SIZE, BenchGetTime() - Start);
+		else
+			Ticks += BenchGetTime() - Start;
+
+		BenchUnmapView((void*) View, BENCH_SECTION_SIZE);
+	}
+
+	BenchReport("map_fault_anonymous_resident", 1, (BENCH_MAP_ROUNDS - 1) * (BENCH_SECTION_SIZE / PAGE_SIZE), Ticks);
+	OSClose(SectionHandle);
+}
+
+static void BenchFileFaults()
+{
+	HANDLE FileHandle;
+	OBJECT_ATTRIBUTES Attributes;
+	OSInitializeObjectAttributes(&Attributes);
+	OSSetNameObjectAttributes(&Attributes, BENCH_MAPPED_FILE);
+
+	BSTATUS Status = OSOpenFile(&FileHandle, &Attributes);
+	TestAssertMsg(SUCCEEDED(Status), "OSOpenFile failed: %s", ST(Status));
+
+	uint64_t Length = 0;
+	Status = OSGetLengthFile(FileHandle, &Length);
+	TestAssertMsg(SUCCEEDED(Status), "OSGetLengthFile failed: %s", ST(Status));
+
+	size_t Size = Length & ~(PAGE_SIZE - 1);
+	TestAssert(Size != 0);
+
+	uint64_t Ticks = 0;
+	volatile uint32_t Sink = 0;
+
+	for (int Round = 0; Round < BENCH_MAP_ROUNDS; Round++)
+	{
+		volatile uint8_t* View = BenchMapView(FileHandle, Size, PAGE_READ);
+
+		uint64_t Start = BenchGetTime();
+		for (size_t Offset = 0; Offset < Size; Offset += PAGE_SIZE)
+			Sink += View[Offset];
+
+		Ticks += BenchGetTime() - Start;
+		BenchUnmapView((void*) View, Size);
+	}
+
+	BenchReport("map_fault_file", 1, BENCH_MAP_ROUNDS * (Size / PAGE_SIZE), Ticks);
+	OSClose(FileHandle);
+}
+
+void Bench5Mappings()
+{
+	BenchAnonymousFaults();
+	BenchFileFaults();
+}
@@ -0,0 +1,83 @@
+#include "testfmk.h"
+
+// Process benchmark.  Measures the cost of creating a process that exits right
+// away, and of forking.
+
+#define BENCH_SPAWN_PROGRAM    "Hello.exe"
+#define BENCH_SPAWN_ITERATIONS (32)
+#define BENCH_FORK_ITERATIONS  (64)
+
+static void BenchWaitForExit(HANDLE ProcessHandle)
+{
+	BSTATUS Status = OSWaitForSingleObject(ProcessHandle, false, WAIT_TIMEOUT_INFINITE);
+	TestAssert(SUCCEEDED(Status));
+
+	int ExitCode = -1;
+	Status = OSGetExitCodeProcess(ProcessHandle, &ExitCode);
+	TestAssert(SUCCEEDED(Status));
+	TestAssertMsg(ExitCode == 0, "process exited with code %d", ExitCode);
+}
+
+static void BenchCreateProcesses()
+{
+	uint64_t CreateTicks = 0;
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_SPAWN_ITERATIONS; i++)
+	{
+		HANDLE ProcessHandle = HANDLE_NONE, ThreadHandle = HANDLE_NONE;
+
+		uint64_t CreateStart = BenchGetTime();
+		BSTATUS Status = OSCreateProcess(
+			&ProcessHandle,
+			&ThreadHandle,
+			NULL,
+			0,
+			BENCH_SPAWN_PROGRAM,
+			BENCH_SPAWN_PROGRAM,
+			NULL
+		);
+		CreateTicks += BenchGetTime() - CreateStart;
+
+		TestAssertMsg(SUCCEEDED(Status), "OSCreateProcess failed: %s", ST(Status));
+
+		BenchWaitForExit(ProcessHandle);
+		OSClose(ThreadHandle);
+		OSClose(ProcessHandle);
+	}
+
+	BenchReport("process_create_exit", 1, BENCH_SPAWN_ITERATIONS, BenchGetTime() - Start);
+	BenchReport("process_create", 1, BENCH_SPAWN_ITERATIONS, CreateTicks);
+}
+
+static void BenchFork()
+{
+	uint64_t ForkTicks = 0;
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_FORK_ITERATIONS; i++)
+	{
+		HANDLE ChildHandle = HANDLE_NONE;
+
+		uint64_t ForkStart = BenchGetTime();
+		BSTATUS Status = OSForkProcess(&ChildHandle);
+
+		if (Status == STATUS_IS_CHILD_PROCESS)
+			OSExitProcess(0);
+
+		ForkTicks += BenchGetTime() - ForkStart;
+		TestAssertMsg(SUCCEEDED(Status), "OSForkProcess failed: %s", ST(Status));
+
+		BenchWaitForExit(ChildHandle);
+		OSClose(ChildHandle);
+	}
+
+	BenchReport("fork_exit", 1, BENCH_FORK_ITERATIONS, BenchGetTime() - Start);
+	BenchReport("fork", 1, BENCH_FORK_ITERATIONS, ForkTicks);
+}
+
+void Bench6Processes()
+{
+	BenchCreateProcesses();
+	BenchFork();
+}
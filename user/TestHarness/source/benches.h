@@ -0,0 +1,7 @@
+BENCH(Bench1SystemCalls)
+BENCH(Bench2Events)
+BENCH(Bench3Pipes)
+BENCH(Bench4Files)
+BENCH(Bench5Mappings)
+BENCH(Bench6Processes)
+BENCH(Test6HeapBenchmark)
\ No newline at end of file
@@ -15,6 +15,23 @@ static void (*Tests[])() = {
 #undef TEST
 };
 
+#define BENCH(x) extern void x();
+#include "benches.h"
+#undef BENCH
+
+static void (*Benchmarks[])() = {
+#define BENCH(x) x,
+#include "benches.h"
+#undef BENCH
+};
+
+const char* BenchExt2FileName;
+
+static bool IsBenchmarkMode;
+static HANDLE BenchOutputHandle = HANDLE_NONE;
+static int BenchResultCount;
+static uint64_t BenchTickFrequency = 1;
+
 // Prints both to stdout as well as to debug console.
 void TestPrintf(const char * Format, ...)
 {
@@ -96,6 +113,184 @@ bool TestAssertionFailed(
 	return true;
 }
 
+// Writes a line of benchmark results to stdout, as well as to the results file if there is one.
+static void BenchWriteLine(const char* Format, ...)
+{
+	va_list vl;
+	va_start(vl, Format);
+	char Buffer[512];
+	vsnprintf(Buffer, sizeof Buffer - 1, Format, vl);
+	va_end(vl);
+	
+	OSPrintf("%s\n", Buffer);
+	
+	if (BenchOutputHandle == HANDLE_NONE)
+		return;
+	
+	size_t Length = strlen(Buffer);
+	Buffer[Length++] = '\n';
+	
+	IO_STATUS_BLOCK Iosb;
+	uint64_t OutSize = 0;
+	OSWriteFile(&Iosb, BenchOutputHandle, 0, Buffer, Length, IO_RW_APPEND, &OutSize);
+}
+
+uint64_t BenchGetTime()
+{
+	uint64_t TickCount = 0;
+	OSGetTickCount(&TickCount);
+	return TickCount;
+}
+
+uint32_t BenchRandom(uint32_t* State)
+{
+	*State = *State * 1103515245 + 12345;
+	return *State >> 8;
+}
+
+static uint64_t BenchTicksToNs(uint64_t Ticks)
+{
+	// Split up to avoid overflowing for long benchmarks.
+	return Ticks / BenchTickFrequency * 1000000000ULL + Ticks % BenchTickFrequency * 1000000000ULL / BenchTickFrequency;
+}
+
+void BenchReport(const char* Name, int Threads, uint64_t Operations, uint64_t Ticks)
+{
+	uint64_t Nanoseconds = BenchTicksToNs(Ticks);
+	if (Operations == 0)
+		Operations = 1;
+	
+	if (!IsBenchmarkMode)
+	{
+		TestPrintf(
+			"%s: %llu ops in %llu ms, %llu ns/op",
+			Name,
+			Operations,
+			Nanoseconds / 1000000,
+			Nanoseconds / Operations
+		);
+		return;
+	}
+	
+	BenchResultCount++;
+	BenchWriteLine(
+		"BENCH name=%s threads=%d iterations=%llu total_ns=%llu ns_per_op=%llu",
+		Name,
+		Threads,
+		Operations,
+		Nanoseconds,
+		Nanoseconds / Operations
+	);
+}
+
+void BenchReportSize(const char* Name, size_t Size, int Threads, uint64_t Operations, uint64_t Ticks)
+{
+	char Buffer[64];
+	snprintf(Buffer, sizeof Buffer, "%s_%zu", Name, Size);
+	BenchReport(Buffer, Threads, Operations, Ticks);
+}
+
+// Opens the results file for appending, creating it if it doesn't exist.  Results of
+// successive runs are appended, each run delimited by BENCH-BEGIN and BENCH-END lines.
+static BSTATUS BenchOpenOutput(const char* FileName)
+{
+	OBJECT_ATTRIBUTES Attributes;
+	OSInitializeObjectAttributes(&Attributes);
+	OSSetNameObjectAttributes(&Attributes, FileName);
+	
+	BSTATUS Status = OSOpenFile(&BenchOutputHandle, &Attributes);
+	if (SUCCEEDED(Status))
+		return Status;
+	
+	// Split the name into the directory and the file name.
+	const char* Name = FileName;
+	for (const char* Char = FileName; *Char; Char++)
+	{
+		if (*Char == '/')
+			Name = Char + 1;
+	}
+	
+	HANDLE DirectoryHandle = OSGetCurrentDirectory();
+	bool CloseDirectory = false;
+	
+	if (Name != FileName)
+	{
+		char DirectoryName[256];
+		size_t Length = Name - FileName - 1;
+		if (Length == 0)
+			Length = 1;
+		
+		if (Length >= sizeof DirectoryName)
+			return STATUS_NAME_TOO_LONG;
+		
+		memcpy(DirectoryName, FileName, Length);
+		DirectoryName[Length] = 0;
+		
+		OSSetNameObjectAttributes(&Attributes, DirectoryName);
+		Status = OSOpenFile(&DirectoryHandle, &Attributes);
+		if (FAILED(Status))
+			return Status;
+		
+		CloseDirectory = true;
+	}
+	
+	Status = OSCreateFile(&BenchOutputHandle, DirectoryHandle, Name, strlen(Name));
+	
+	if (CloseDirectory)
+		OSClose(DirectoryHandle);
+	
+	return Status;
+}
+
+// Runs all of the benchmarks.  The arguments are the ones following -b.
+static int RunBenchmarks(int ArgumentCount, char** ArgumentArray)
+{
+	for (int i = 0; i < ArgumentCount; i++)
+	{
+		if (strcmp(ArgumentArray[i], "-o") == 0 && i + 1 < ArgumentCount)
+		{
+			BSTATUS Status = BenchOpenOutput(ArgumentArray[++i]);
+			if (FAILED(Status))
+			{
+				TestPrintf("Could not open %s: %s", ArgumentArray[i], ST(Status));
+				return 1;
+			}
+		}
+		else if (strcmp(ArgumentArray[i], "-e") == 0 && i + 1 < ArgumentCount)
+		{
+			BenchExt2FileName = ArgumentArray[++i];
+		}
+		else
+		{
+			TestPrintf("Unknown benchmark option %s", ArgumentArray[i]);
+			return 1;
+		}
+	}
+	
+	IsBenchmarkMode = true;
+	OSGetTickFrequency(&BenchTickFrequency);
+	
+	size_t WrittenSize;
+	SYSTEM_BASIC_INFORMATION BasicInfo;
+	BasicInfo.ProcessorCount = 0;
+	OSQuerySystemInformation(QUERY_BASIC_INFORMATION, &BasicInfo, sizeof BasicInfo, &WrittenSize);
+	
+	BenchWriteLine("BENCH-BEGIN version=1 cpus=%u tick_frequency=%llu", BasicInfo.ProcessorCount, BenchTickFrequency);
+	
+	for (size_t i = 0; i < ARRAY_COUNT(Benchmarks); i++)
+	{
+		CurrentTestNumber = i + 1;
+		Benchmarks[i]();
+	}
+	
+	BenchWriteLine("BENCH-END count=%d", BenchResultCount);
+	
+	if (BenchOutputHandle != HANDLE_NONE)
+		OSClose(BenchOutputHandle);
+	
+	return 0;
+}
+
 int main(int ArgumentCount, char** ArgumentArray)
 {
 	DbgPrint("Boron Operating System Test Harness");
@@ -105,6 +300,9 @@ int main(int ArgumentCount, char** ArgumentArray)
 	OSPrintf("Boron Operating System Test Harness\n");
 	OSPrintf("-----------------------------------\n");
 	
+	if (ArgumentCount > 1 && strcmp(ArgumentArray[1], "-b") == 0)
+		return RunBenchmarks(ArgumentCount - 2, ArgumentArray + 2);
+	
 	if (ArgumentCount > 1)
 	{
 		// Take the first argument, and see if it's a number, or '-f'.
@@ -138,10 +336,15 @@ int main(int ArgumentCount, char** ArgumentArray)
 				"Usage:\n"
 				"\t%s                    : Runs all tests, until a failure is encountered\n"
 				"\t%s [test number 1-%d]  : Runs a specific test number\n"
-				"\t%s [-f]               : Runs all tests, assertions do not exit\n",
+				"\t%s [-f]               : Runs all tests, assertions do not exit\n"
+				"\t%s -b [-o file] [-e file]\n"
+				"\t    : Runs the benchmarks, appending the results to a file if -o is given.\n"
+				"\t      The file given with -e, which should be on an ext2 file system, is\n"
+				"\t      used for the ext2 file read benchmarks.\n",
 				Program,
 				Program,
 				(int) ARRAY_COUNT(Tests),
+				Program,
 				Program
 			);
 			
@@ -0,0 +1,165 @@
+#include "testfmk.h"
+
+// Completion port test.  Posts packets directly and checks that they come back
+// in order and in batches, checks the readiness notifications of a pipe which is
+// associated with the port, and lets a pool of worker threads drain the port.
+
+#define PORT_POST_COUNT    (10)
+#define PORT_WORKER_COUNT  (4)
+#define PORT_WORK_COUNT    (1000)
+#define PORT_KEY_PIPE      ((void*) 0x1234)
+#define PORT_KEY_QUIT      ((void*) 0xDEAD)
+
+static HANDLE PortWorkerPort;
+static int PortWorkDone;
+
+static NO_RETURN void PortWorkerThread(UNUSED void* Context)
+{
+	IO_COMPLETION_ENTRY Entry;
+	int Count;
+	
+	while (true)
+	{
+		BSTATUS Status = OSRemoveCompletionPort(PortWorkerPort, &Entry, 1, &Count, false, WAIT_TIMEOUT_INFINITE);
+		TestAssertMsg(SUCCEEDED(Status), "OSRemoveCompletionPort failed: %s", ST(Status));
+		TestAssert(Count == 1);
+		
+		if (Entry.Key == PORT_KEY_QUIT)
+			break;
+		
+		__atomic_fetch_add(&PortWorkDone, 1, __ATOMIC_RELAXED);
+	}
+	
+	OSExitThread();
+}
+
+static void PortTestPosting(HANDLE Port)
+{
+	IO_COMPLETION_ENTRY Entries[IO_COMPLETION_MAX_ENTRIES];
+	int Count;
+	
+	for (int i = 0; i < PORT_POST_COUNT; i++)
+	{
+		BSTATUS Status = OSPostCompletionPort(Port, (void*)(uintptr_t)(i + 1), STATUS_SUCCESS, i * 100);
+		TestAssertMsg(SUCCEEDED(Status), "OSPostCompletionPort failed: %s", ST(Status));
+	}
+	
+	// All of the packets are removed at once, in the order they were posted.
+	BSTATUS Status = OSRemoveCompletionPort(Port, Entries, IO_COMPLETION_MAX_ENTRIES, &Count, false, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSRemoveCompletionPort failed: %s", ST(Status));
+	TestAssertMsg(Count == PORT_POST_COUNT, "%d entries removed", Count);
+	
+	for (int i = 0; i < Count; i++)
+	{
+		TestAssert(Entries[i].Key == (void*)(uintptr_t)(i + 1));
+		TestAssert(Entries[i].Status == STATUS_SUCCESS);
+		TestAssert(Entries[i].Information == (uint64_t)(i * 100));
+	}
+	
+	// The port is empty now.
+	Status = OSRemoveCompletionPort(Port, Entries, IO_COMPLETION_MAX_ENTRIES, &Count, false, 0);
+	TestAssertMsg(Status == STATUS_TIMEOUT, "OSRemoveCompletionPort returned %s", ST(Status));
+	TestAssert(Count == 0);
+}
+
+static void PortExpectPipeEntry(HANDLE Port, uint64_t Readiness)
+{
+	IO_COMPLETION_ENTRY Entries[4];
+	int Count;
+	
+	BSTATUS Status = OSRemoveCompletionPort(Port, Entries, 4, &Count, false, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSRemoveCompletionPort failed: %s", ST(Status));
+	TestAssertMsg(Count == 1, "%d entries removed", Count);
+	TestAssert(Entries[0].Key == PORT_KEY_PIPE);
+	TestAssertMsg(Entries[0].Information == Readiness, "readiness is %llu, expected %llu", Entries[0].Information, Readiness);
+}
+
+static void PortTestPipe(HANDLE Port)
+{
+	IO_STATUS_BLOCK Iosb;
+	IO_COMPLETION_ENTRY Entry;
+	HANDLE Pipe;
+	uint64_t OutSize;
+	char Buffer[64];
+	int Count;
+	
+	BSTATUS Status = OSCreatePipe(&Pipe, NULL, 4096, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreatePipe failed: %s", ST(Status));
+	
+	Status = OSAssociateCompletionPort(Port, Pipe, PORT_KEY_PIPE);
+	TestAssertMsg(SUCCEEDED(Status), "OSAssociateCompletionPort failed: %s", ST(Status));
+	
+	Status = OSAssociateCompletionPort(Port, Pipe, PORT_KEY_PIPE);
+	TestAssertMsg(Status == STATUS_ALREADY_ASSOCIATED, "OSAssociateCompletionPort returned %s", ST(Status));
+	
+	// Associating a file posts an entry right away, so that nothing is missed
+	// between the association and the first read.
+	PortExpectPipeEntry(Port, IO_COMPLETION_READABLE | IO_COMPLETION_WRITABLE);
+	
+	// Two writes before the port is checked are merged into one entry.
+	for (int i = 0; i < 2; i++)
+	{
+		memset(Buffer, 'A' + i, sizeof Buffer);
+		Status = OSWriteFile(&Iosb, Pipe, 0, Buffer, sizeof Buffer, 0, &OutSize);
+		TestAssertMsg(SUCCEEDED(Status), "OSWriteFile failed: %s", ST(Status));
+	}
+	
+	PortExpectPipeEntry(Port, IO_COMPLETION_READABLE);
+	
+	Status = OSReadFile(&Iosb, Pipe, 0, Buffer, sizeof Buffer, IO_RW_NONBLOCK);
+	TestAssertMsg(SUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+	TestAssert(Iosb.BytesRead == sizeof Buffer);
+	TestAssert(Buffer[0] == 'A');
+	
+	PortExpectPipeEntry(Port, IO_COMPLETION_WRITABLE);
+	
+	// A pipe closed while its entry is still queued takes the entry away with it.
+	Status = OSWriteFile(&Iosb, Pipe, 0, Buffer, sizeof Buffer, 0, &OutSize);
+	TestAssertMsg(SUCCEEDED(Status), "OSWriteFile failed: %s", ST(Status));
+	OSClose(Pipe);
+	
+	Status = OSRemoveCompletionPort(Port, &Entry, 1, &Count, false, 0);
+	TestAssertMsg(Status == STATUS_TIMEOUT, "OSRemoveCompletionPort returned %s", ST(Status));
+}
+
+static void PortTestWorkers(HANDLE Port)
+{
+	HANDLE Threads[PORT_WORKER_COUNT];
+	
+	PortWorkerPort = Port;
+	PortWorkDone = 0;
+	
+	for (int i = 0; i < PORT_WORKER_COUNT; i++)
+	{
+		BSTATUS Status = OSCreateThread(&Threads[i], CURRENT_PROCESS_HANDLE, NULL, PortWorkerThread, NULL, false);
+		TestAssertMsg(SUCCEEDED(Status), "OSCreateThread failed: %s", ST(Status));
+	}
+	
+	for (int i = 0; i < PORT_WORK_COUNT; i++)
+		OSPostCompletionPort(Port, (void*)(uintptr_t)(i + 1), STATUS_SUCCESS, 0);
+	
+	for (int i = 0; i < PORT_WORKER_COUNT; i++)
+		OSPostCompletionPort(Port, PORT_KEY_QUIT, STATUS_SUCCESS, 0);
+	
+	for (int i = 0; i < PORT_WORKER_COUNT; i++)
+	{
+		OSWaitForSingleObject(Threads[i], false, WAIT_TIMEOUT_INFINITE);
+		OSClose(Threads[i]);
+	}
+	
+	TestAssertMsg(PortWorkDone == PORT_WORK_COUNT, "%d packets handled", PortWorkDone);
+}
+
+void Test10CompletionPort()
+{
+	HANDLE Port;
+	
+	BSTATUS Status = OSCreateCompletionPort(&Port, NULL, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateCompletionPort failed: %s", ST(Status));
+	
+	PortTestPosting(Port);
+	PortTestPipe(Port);
+	PortTestWorkers(Port);
+	
+	OSClose(Port);
+}
@@ -0,0 +1,152 @@
+#include "testfmk.h"
+
+// Allocator benchmark.  Measures the global heap under a few allocation patterns,
+// and checks that blocks don't overlap by filling and verifying each one.
+
+#define BENCH_SMALL_ITERATIONS  (200000)
+#define BENCH_MIXED_ITERATIONS  (200000)
+#define BENCH_MIXED_SLOTS       (1024)
+#define BENCH_THREAD_COUNT      (4)
+#define BENCH_THREAD_ITERATIONS (50000)
+
+typedef struct
+{
+	void* Memory;
+	size_t Size;
+}
+BENCH_SLOT;
+
+static void BenchFill(BENCH_SLOT* Slot)
+{
+	memset(Slot->Memory, (int)(Slot->Size & 0xFF), Slot->Size);
+}
+
+static bool BenchCheck(BENCH_SLOT* Slot)
+{
+	uint8_t* Bytes = Slot->Memory;
+
+	for (size_t i = 0; i < Slot->Size; i++)
+	{
+		if (Bytes[i] != (uint8_t)(Slot->Size & 0xFF))
+			return false;
+	}
+
+	return true;
+}
+
+// Allocates and frees a small block over and over.
+static void BenchSmallChurn()
+{
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_SMALL_ITERATIONS; i++)
+	{
+		void* Memory = OSAllocate(32);
+		TestAssert(Memory);
+		OSFree(Memory);
+	}
+
+	BenchReport("heap_small_churn", 1, BENCH_SMALL_ITERATIONS, BenchGetTime() - Start);
+}
+
+// Keeps a working set of blocks of random sizes, freeing and allocating at random.
+static void BenchMixedSizes()
+{
+	BENCH_SLOT* Slots = OSAllocate(sizeof(BENCH_SLOT) * BENCH_MIXED_SLOTS);
+	TestAssert(Slots);
+	memset(Slots, 0, sizeof(BENCH_SLOT) * BENCH_MIXED_SLOTS);
+
+	uint32_t State = 1;
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_MIXED_ITERATIONS; i++)
+	{
+		BENCH_SLOT* Slot = &Slots[BenchRandom(&State) % BENCH_MIXED_SLOTS];
+
+		if (Slot->Memory)
+		{
+			TestAssert(BenchCheck(Slot));
+			OSFree(Slot->Memory);
+			Slot->Memory = NULL;
+			continue;
+		}
+
+		// Mostly small blocks, with the occasional large one.
+		uint32_t Random = BenchRandom(&State);
+		Slot->Size = (Random % 8 == 0) ? 1024 + Random % 8192 : 1 + Random % 512;
+		Slot->Memory = OSAllocate(Slot->Size);
+		TestAssert(Slot->Memory);
+		BenchFill(Slot);
+	}
+
+	BenchReport("heap_mixed_sizes", 1, BENCH_MIXED_ITERATIONS, BenchGetTime() - Start);
+
+	for (int i = 0; i < BENCH_MIXED_SLOTS; i++)
+	{
+		if (!Slots[i].Memory)
+			continue;
+
+		TestAssert(BenchCheck(&Slots[i]));
+		OSFree(Slots[i].Memory);
+	}
+
+	OSFree(Slots);
+}
+
+static NO_RETURN void BenchThread(void* Context)
+{
+	uint32_t State = (uint32_t)(uintptr_t) Context;
+	BENCH_SLOT Slots[16];
+	memset(Slots, 0, sizeof Slots);
+
+	for (int i = 0; i < BENCH_THREAD_ITERATIONS; i++)
+	{
+		BENCH_SLOT* Slot = &Slots[BenchRandom(&State) % ARRAY_COUNT(Slots)];
+
+		if (Slot->Memory)
+		{
+			TestAssert(BenchCheck(Slot));
+			OSFree(Slot->Memory);
+		}
+
+		Slot->Size = 1 + BenchRandom(&State) % 256;
+		Slot->Memory = OSAllocate(Slot->Size);
+		TestAssert(Slot->Memory);
+		BenchFill(Slot);
+	}
+
+	for (size_t i = 0; i < ARRAY_COUNT(Slots); i++)
+		OSFree(Slots[i].Memory);
+
+	OSExitThread();
+}
+
+// Several threads allocating and freeing small blocks at the same time.
+static void BenchThreads()
+{
+	HANDLE Threads[BENCH_THREAD_COUNT];
+	BSTATUS Status;
+
+	uint64_t Start = BenchGetTime();
+
+	for (int i = 0; i < BENCH_THREAD_COUNT; i++)
+	{
+		Status = OSCreateThread(&Threads[i], CURRENT_PROCESS_HANDLE, NULL, BenchThread, (void*)(uintptr_t)(i + 1), false);
+		TestAssertMsg(SUCCEEDED(Status), "OSCreateThread failed: %s", ST(Status));
+	}
+
+	Status = OSWaitForMultipleObjects(BENCH_THREAD_COUNT, Threads, WAIT_ALL_OBJECTS, false, WAIT_TIMEOUT_INFINITE);
+	TestAssert(SUCCEEDED(Status));
+
+	BenchReport("heap_threads", BENCH_THREAD_COUNT, BENCH_THREAD_COUNT * BENCH_THREAD_ITERATIONS, BenchGetTime() - Start);
+
+	for (int i = 0; i < BENCH_THREAD_COUNT; i++)
+		OSClose(Threads[i]);
+}
+
+void Test6HeapBenchmark()
+{
+	BenchSmallChurn();
+	BenchMixedSizes();
+	BenchThreads();
+}
@@ -0,0 +1,96 @@
+#include "testfmk.h"
+
+// Fork test.  Reserves a large region, touches a few pages of it, and forks.  Both
+// processes then write to the touched pages and check that they don't see each
+// other's writes.  The fork itself is timed, since it should not depend on the size
+// of the region.
+
+#define FORK_REGION_SIZE  (256 * 1024 * 1024)
+#define FORK_TOUCH_STRIDE (16 * 1024 * 1024)
+#define FORK_TOUCH_COUNT  (FORK_REGION_SIZE / FORK_TOUCH_STRIDE)
+
+#define FORK_CHILD_SUCCESS (7)
+#define FORK_CHILD_FAILURE (8)
+
+static uint32_t* ForkGetPage(uint8_t* Region, int Index)
+{
+	return (uint32_t*)(Region + Index * FORK_TOUCH_STRIDE);
+}
+
+static NO_RETURN void ForkChild(uint8_t* Region)
+{
+	// The child sees what the parent wrote before forking...
+	for (int i = 0; i < FORK_TOUCH_COUNT; i++)
+	{
+		if (*ForkGetPage(Region, i) != 0x1000u + i)
+			OSExitProcess(FORK_CHILD_FAILURE);
+	}
+
+	// ...and nothing that it writes itself is seen by the parent.
+	for (int i = 0; i < FORK_TOUCH_COUNT; i++)
+		*ForkGetPage(Region, i) = 0x2000u + i;
+
+	for (int i = 0; i < FORK_TOUCH_COUNT; i++)
+	{
+		if (*ForkGetPage(Region, i) != 0x2000u + i)
+			OSExitProcess(FORK_CHILD_FAILURE);
+	}
+
+	OSExitProcess(FORK_CHILD_SUCCESS);
+}
+
+void Test7ForkCopyOnWrite()
+{
+	void* Address = NULL;
+	size_t RegionSize = FORK_REGION_SIZE;
+	BSTATUS Status;
+
+	Status = OSAllocateVirtualMemory(CURRENT_PROCESS_HANDLE, &Address, &RegionSize, MEM_RESERVE | MEM_COMMIT, PAGE_READ | PAGE_WRITE);
+	TestAssertMsg(SUCCEEDED(Status), "OSAllocateVirtualMemory failed: %s", ST(Status));
+
+	uint8_t* Region = Address;
+	for (int i = 0; i < FORK_TOUCH_COUNT; i++)
+		*ForkGetPage(Region, i) = 0x1000u + i;
+
+	uint64_t Frequency = 1, Start = 0, End = 0;
+	OSGetTickFrequency(&Frequency);
+	OSGetTickCount(&Start);
+
+	HANDLE ChildHandle = HANDLE_NONE;
+	Status = OSForkProcess(&ChildHandle);
+
+	if (Status == STATUS_IS_CHILD_PROCESS)
+		ForkChild(Region);
+
+	OSGetTickCount(&End);
+	TestAssertMsg(SUCCEEDED(Status), "OSForkProcess failed: %s", ST(Status));
+
+	TestPrintf(
+		"fork with %d MB reserved, %d pages touched: %llu us",
+		FORK_REGION_SIZE / (1024 * 1024),
+		FORK_TOUCH_COUNT,
+		(End - Start) * 1000000ULL / Frequency
+	);
+
+	// Write to half of the pages while the child may still be reading them.
+	for (int i = 0; i < FORK_TOUCH_COUNT; i += 2)
+		*ForkGetPage(Region, i) = 0x3000u + i;
+
+	Status = OSWaitForSingleObject(ChildHandle, false, WAIT_TIMEOUT_INFINITE);
+	TestAssert(SUCCEEDED(Status));
+
+	int ExitCode = 0;
+	Status = OSGetExitCodeProcess(ChildHandle, &ExitCode);
+	TestAssert(SUCCEEDED(Status));
+	TestAssertMsg(ExitCode == FORK_CHILD_SUCCESS, "child exited with code %d", ExitCode);
+	OSClose(ChildHandle);
+
+	for (int i = 0; i < FORK_TOUCH_COUNT; i++)
+	{
+		uint32_t Expected = (i % 2 == 0) ? 0x3000u + i : 0x1000u + i;
+		TestAssertMsg(*ForkGetPage(Region, i) == Expected, "page %d holds %x", i, *ForkGetPage(Region, i));
+	}
+
+	Status = OSFreeVirtualMemory(CURRENT_PROCESS_HANDLE, Address, RegionSize, MEM_RELEASE);
+	TestAssert(SUCCEEDED(Status));
+}
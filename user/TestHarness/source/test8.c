@@ -0,0 +1,51 @@
+#include "testfmk.h"
+
+// Process creation test.  Starts a small program several times, checking that it
+// runs to completion, and measures how long OSCreateProcess takes to return.
+
+#define SPAWN_PROGRAM    "Hello.exe"
+#define SPAWN_ITERATIONS (8)
+
+void Test8SpawnProcess()
+{
+	uint64_t Frequency = 1, TotalTicks = 0;
+	OSGetTickFrequency(&Frequency);
+	
+	for (int i = 0; i < SPAWN_ITERATIONS; i++)
+	{
+		HANDLE ProcessHandle = HANDLE_NONE, ThreadHandle = HANDLE_NONE;
+		uint64_t Start = 0, End = 0;
+		
+		OSGetTickCount(&Start);
+		BSTATUS Status = OSCreateProcess(
+			&ProcessHandle,
+			&ThreadHandle,
+			NULL,
+			0,
+			SPAWN_PROGRAM,
+			SPAWN_PROGRAM,
+			NULL
+		);
+		OSGetTickCount(&End);
+		
+		TestAssertMsg(SUCCEEDED(Status), "OSCreateProcess failed: %s", ST(Status));
+		TotalTicks += End - Start;
+		
+		Status = OSWaitForSingleObject(ProcessHandle, false, WAIT_TIMEOUT_INFINITE);
+		TestAssert(SUCCEEDED(Status));
+		
+		int ExitCode = -1;
+		Status = OSGetExitCodeProcess(ProcessHandle, &ExitCode);
+		TestAssert(SUCCEEDED(Status));
+		TestAssertMsg(ExitCode == 0, "%s exited with code %d", SPAWN_PROGRAM, ExitCode);
+		
+		OSClose(ThreadHandle);
+		OSClose(ProcessHandle);
+	}
+	
+	TestPrintf(
+		"%d processes created, %llu us each on average",
+		SPAWN_ITERATIONS,
+		TotalTicks * 1000000ULL / Frequency / SPAWN_ITERATIONS
+	);
+}
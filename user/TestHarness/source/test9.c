@@ -0,0 +1,148 @@
+#include "testfmk.h"
+
+// Splice test.  Moves a file into a pipe and a pipe into another file with
+// OSSpliceFile, checking the data at every step.
+//
+// Anonymous pipes created by OSCreatePipe have only one owner, so reads and writes
+// which would block return end of file instead.  Because of that, this test moves
+// the data in pieces which fit into the pipe, from one thread.  It also relies on
+// that to check that a splice which fills the pipe leaves the input file's offset
+// just after the last byte which made it into the pipe.
+
+#define SPLICE_PIPE_SIZE  (32768)
+#define SPLICE_DATA_SIZE  (96 * 1024)
+#define SPLICE_PIECE_SIZE (20000)
+#define SPLICE_FILE_IN    "SpliceIn.dat"
+#define SPLICE_FILE_OUT   "SpliceOut.dat"
+
+static char SpliceData[SPLICE_DATA_SIZE];
+static char SpliceReadBuffer[SPLICE_DATA_SIZE];
+
+static void SpliceCheckData(const char* Buffer, size_t Offset, size_t Size, const char* What)
+{
+	for (size_t i = 0; i < Size; i++)
+		TestAssertMsg(Buffer[i] == SpliceData[Offset + i], "%s: byte %zu differs", What, Offset + i);
+}
+
+static HANDLE SpliceCreateFile(const char* Name, const char* Path)
+{
+	HANDLE Handle, RootDirHandle;
+	
+	OBJECT_ATTRIBUTES Attributes;
+	OSInitializeObjectAttributes(&Attributes);
+	OSSetNameObjectAttributes(&Attributes, Path);
+	
+	// The file is left behind by a previous run.
+	BSTATUS Status = OSOpenFile(&Handle, &Attributes);
+	if (SUCCEEDED(Status))
+		return Handle;
+	
+	// The root directory is on the tmpfs.
+	OSSetNameObjectAttributes(&Attributes, "/");
+	Status = OSOpenFile(&RootDirHandle, &Attributes);
+	TestAssertMsg(SUCCEEDED(Status), "OSOpenFile failed: %s", ST(Status));
+	
+	Status = OSCreateFile(&Handle, RootDirHandle, Name, strlen(Name));
+	TestAssertMsg(SUCCEEDED(Status), "OSCreateFile(%s) failed: %s", Name, ST(Status));
+	
+	OSClose(RootDirHandle);
+	return Handle;
+}
+
+void Test9PipeSplice()
+{
+	BSTATUS Status;
+	IO_STATUS_BLOCK Iosb;
+	uint64_t OutSize = 0;
+	
+	for (size_t i = 0; i < sizeof SpliceData; i++)
+		SpliceData[i] = (char)(i * 7 + i / 4096);
+	
+	HANDLE Pipe;
+	Status = OSCreatePipe(&Pipe, NULL, SPLICE_PIPE_SIZE, false);
+	TestAssertMsg(SUCCEEDED(Status), "OSCreatePipe failed: %s", ST(Status));
+	
+	HANDLE InFile = SpliceCreateFile(SPLICE_FILE_IN, "/" SPLICE_FILE_IN);
+	HANDLE OutFile = SpliceCreateFile(SPLICE_FILE_OUT, "/" SPLICE_FILE_OUT);
+	
+	Status = OSWriteFile(&Iosb, InFile, 0, SpliceData, SPLICE_DATA_SIZE, 0, &OutSize);
+	TestAssertMsg(SUCCEEDED(Status), "OSWriteFile failed: %s", ST(Status));
+	
+	// File to pipe, using and advancing our own offset into the input file.
+	uint64_t InOffset = 0;
+	while (InOffset < SPLICE_DATA_SIZE)
+	{
+		size_t Size = SPLICE_DATA_SIZE - InOffset;
+		if (Size > SPLICE_PIECE_SIZE)
+			Size = SPLICE_PIECE_SIZE;
+		
+		uint64_t Start = InOffset;
+		Status = OSSpliceFile(&Iosb, InFile, &InOffset, Pipe, NULL, Size, 0);
+		TestAssertMsg(SUCCEEDED(Status), "OSSpliceFile from file failed: %s", ST(Status));
+		TestAssert(Iosb.BytesWritten == Size);
+		TestAssert(InOffset == Start + Size);
+		
+		Status = OSReadFile(&Iosb, Pipe, 0, SpliceReadBuffer, Size, 0);
+		TestAssertMsg(SUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+		TestAssert(Iosb.BytesRead == Size);
+		SpliceCheckData(SpliceReadBuffer, Start, Size, "file to pipe");
+	}
+	
+	// Pipe to file, at the output file's current offset.
+	for (size_t Offset = 0; Offset < SPLICE_DATA_SIZE; Offset += SPLICE_PIECE_SIZE)
+	{
+		size_t Size = SPLICE_DATA_SIZE - Offset;
+		if (Size > SPLICE_PIECE_SIZE)
+			Size = SPLICE_PIECE_SIZE;
+		
+		Status = OSWriteFile(&Iosb, Pipe, 0, SpliceData + Offset, Size, 0, &OutSize);
+		TestAssertMsg(SUCCEEDED(Status), "OSWriteFile failed: %s", ST(Status));
+		
+		// Ask for more than there is.  The splice stops once the pipe is drained.
+		Status = OSSpliceFile(&Iosb, Pipe, NULL, OutFile, NULL, SPLICE_DATA_SIZE, 0);
+		TestAssertMsg(IOSUCCEEDED(Status), "OSSpliceFile to file failed: %s", ST(Status));
+		TestAssertMsg(Iosb.BytesWritten == Size, "%llu bytes spliced, expected %zu", Iosb.BytesWritten, Size);
+	}
+	
+	Status = OSReadFile(&Iosb, OutFile, 0, SpliceReadBuffer, SPLICE_DATA_SIZE, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+	TestAssert(Iosb.BytesRead == SPLICE_DATA_SIZE);
+	SpliceCheckData(SpliceReadBuffer, 0, SPLICE_DATA_SIZE, "pipe to file");
+	
+	// File to pipe, more than the pipe can hold.  The pipe keeps one byte of its
+	// buffer free, and the rest of the data must be left unread in the file.
+	const size_t PipeCapacity = SPLICE_PIPE_SIZE - 1;
+	
+	InOffset = 0;
+	Status = OSSpliceFile(&Iosb, InFile, &InOffset, Pipe, NULL, SPLICE_DATA_SIZE, 0);
+	TestAssertMsg(IOSUCCEEDED(Status), "OSSpliceFile into a full pipe failed: %s", ST(Status));
+	TestAssertMsg(Iosb.BytesWritten == PipeCapacity, "%llu bytes spliced, expected %zu", Iosb.BytesWritten, PipeCapacity);
+	TestAssertMsg(InOffset == PipeCapacity, "input offset is %llu, expected %zu", InOffset, PipeCapacity);
+	
+	Status = OSReadFile(&Iosb, Pipe, 0, SpliceReadBuffer, PipeCapacity, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+	TestAssert(Iosb.BytesRead == PipeCapacity);
+	SpliceCheckData(SpliceReadBuffer, 0, PipeCapacity, "file to full pipe");
+	
+	// The same, at the input file's current offset.
+	uint64_t CurrentOffset = 0;
+	Status = OSSeekFile(InFile, 0, IO_SEEK_SET, &CurrentOffset);
+	TestAssertMsg(SUCCEEDED(Status), "OSSeekFile failed: %s", ST(Status));
+	
+	Status = OSSpliceFile(&Iosb, InFile, NULL, Pipe, NULL, SPLICE_DATA_SIZE, 0);
+	TestAssertMsg(IOSUCCEEDED(Status), "OSSpliceFile into a full pipe failed: %s", ST(Status));
+	TestAssertMsg(Iosb.BytesWritten == PipeCapacity, "%llu bytes spliced, expected %zu", Iosb.BytesWritten, PipeCapacity);
+	
+	Status = OSSeekFile(InFile, 0, IO_SEEK_CUR, &CurrentOffset);
+	TestAssertMsg(SUCCEEDED(Status), "OSSeekFile failed: %s", ST(Status));
+	TestAssertMsg(CurrentOffset == PipeCapacity, "input offset is %llu, expected %zu", CurrentOffset, PipeCapacity);
+	
+	Status = OSReadFile(&Iosb, Pipe, 0, SpliceReadBuffer, PipeCapacity, 0);
+	TestAssertMsg(SUCCEEDED(Status), "OSReadFile failed: %s", ST(Status));
+	TestAssert(Iosb.BytesRead == PipeCapacity);
+	SpliceCheckData(SpliceReadBuffer, 0, PipeCapacity, "file to full pipe");
+	
+	OSClose(OutFile);
+	OSClose(InFile);
+	OSClose(Pipe);
+}
@@ -44,3 +44,22 @@ bool TestAssertionFailed(
 	((void)((condition) || TestAssertionFailed(__FILE__, __LINE__, __func__, #condition, NULL)))
 
 #endif
+
+// Benchmarks.  In benchmark mode (-b), results are written in the same format as
+// the test driver's benchmark mode, so that the same tools can track them:
+//
+// BENCH name=<name> threads=<n> iterations=<n> total_ns=<n> ns_per_op=<n>
+//
+// In test mode, they are printed in a human readable form instead.
+
+uint64_t BenchGetTime();
+
+void BenchReport(const char* Name, int Threads, uint64_t Operations, uint64_t Ticks);
+
+// Same as BenchReport, but the reported name is "<Name>_<Size>".
+void BenchReportSize(const char* Name, size_t Size, int Threads, uint64_t Operations, uint64_t Ticks);
+
+uint32_t BenchRandom(uint32_t* State);
+
+// The file on an ext2 file system that the file benchmarks read, set with -e.
+extern const char* BenchExt2FileName;
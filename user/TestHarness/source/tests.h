@@ -2,4 +2,9 @@ TEST(Test1BasicOpenAndClose)
 TEST(Test2ReadExistingFile)
 TEST(Test3CreateFile)
 TEST(Test4ListDirectory)
-TEST(Test5)
\ No newline at end of file
+TEST(Test5)
+TEST(Test6HeapBenchmark)
+TEST(Test7ForkCopyOnWrite)
+TEST(Test8SpawnProcess)
+TEST(Test9PipeSplice)
+TEST(Test10CompletionPort)
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "handle.h"
+#include "heap.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -12,6 +13,9 @@ typedef struct _TEB
 	
 	HANDLE CurrentDirectory;
 	
+	// Free objects of the global heap cached by this thread.
+	OS_HEAP_CACHE HeapCache;
+	
 	// More to define here such as TLS
 }
 TEB, *PTEB;
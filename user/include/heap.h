@@ -16,20 +16,54 @@ Author:
 #include "list.h"
 #include "csect.h"
 
+// The number of size classes that small allocations are sorted into.
+#define OS_HEAP_SIZE_CLASS_COUNT (12)
+
+// The number of free lists that free large blocks are segregated into.
+#define OS_HEAP_FREE_LIST_COUNT  (18)
+
+typedef struct
+{
+	// The slabs of this size class that have at least one free object.
+	LIST_ENTRY PartialSlabs;
+	
+	// The critical section that guards the slabs of this size class.
+	OS_CRITICAL_SECTION CriticalSection;
+}
+OS_HEAP_SIZE_CLASS, *POS_HEAP_SIZE_CLASS;
+
 typedef struct
 {
 	// The block list is used for fast coalescing.  Every entry *should*
 	// be in order of address, and this is asserted by OSDebugDumpHeap.
 	LIST_ENTRY BlockList;
 
-	// The free list is used to determine where to allocate.
-	LIST_ENTRY FreeList;
+	// The free lists are used to determine where to allocate.  Free blocks
+	// are placed on the list for the highest power of two not above their size.
+	LIST_ENTRY FreeLists[OS_HEAP_FREE_LIST_COUNT];
 	
-	// The critical section that guards the whole structure.
+	// Which free lists have any blocks on them.
+	uint32_t FreeListMask;
+	
+	// The critical section that guards the block and free lists.
 	OS_CRITICAL_SECTION CriticalSection;
+	
+	// Small allocations are served from slabs, sorted by size class.
+	OS_HEAP_SIZE_CLASS SizeClasses[OS_HEAP_SIZE_CLASS_COUNT];
 }
 OS_HEAP, *POS_HEAP;
 
+// A cache of free small objects of the global heap, kept in each thread's TEB.
+// It's used when a size class is contended, so that threads don't have to wait
+// for each other on every allocation.
+typedef struct
+{
+	void* Objects[OS_HEAP_SIZE_CLASS_COUNT];
+	
+	int Counts[OS_HEAP_SIZE_CLASS_COUNT];
+}
+OS_HEAP_CACHE, *POS_HEAP_CACHE;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -14,6 +14,8 @@ BSTATUS OSAllocateVirtualMemory(
 	int Protection
 );
 
+BSTATUS OSAssociateCompletionPort(HANDLE PortHandle, HANDLE FileHandle, void* Key);
+
 BSTATUS OSCheckIsTerminalFile(HANDLE FileHandle);
 
 BSTATUS OSCheckIsValidHandle(HANDLE Handle);
@@ -22,6 +24,8 @@ BSTATUS OSClose(HANDLE Handle);
 
 BSTATUS OSCloseAllUninheritableHandles();
 
+BSTATUS OSCreateCompletionPort(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, int MaximumConcurrency);
+
 BSTATUS OSCreateFile(PHANDLE OutFileHandle, HANDLE DirectoryHandle, const char* FileName, size_t FileNameLength);
 
 BSTATUS OSCreateEvent(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, int EventType, bool State);
@@ -32,6 +36,8 @@ BSTATUS OSCreateMutex(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes);
 
 BSTATUS OSCreatePipe(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes, size_t BufferSize, bool NonBlock);
 
+BSTATUS OSCreateSectionObject(PHANDLE OutSectionHandle, POBJECT_ATTRIBUTES ObjectAttributes, uint64_t MaxSize);
+
 BSTATUS OSCreateSymbolicLink(PHANDLE OutFileHandle, HANDLE DirectoryHandle, const char* FileName, size_t FileNameLength, const char* TargetName, size_t TargetNameLength);
 
 #ifdef IS_BORON_DLL
@@ -74,6 +80,8 @@ BSTATUS OSDuplicateHandle(HANDLE SourceHandle, HANDLE DestinationProcessHandle,
 
 NO_RETURN void OSExitProcessInternal(int ExitCode);
 
+NO_RETURN void OSExitThreadInternal();
+
 #endif
 
 NO_RETURN void OSExitProcess(int ExitCode);
@@ -107,6 +115,8 @@ BSTATUS OSGetTickFrequency(uint64_t* TickFrequency);
 
 BSTATUS OSGetVersionNumber(int* VersionNumber);
 
+BSTATUS OSLookUpImageSection(PHANDLE OutSectionHandle, HANDLE FileHandle, uintptr_t ImageBase, size_t ImageSize);
+
 BSTATUS OSMapViewOfObject(
 	HANDLE ProcessHandle,
 	HANDLE MappedObject,
@@ -125,6 +135,8 @@ BSTATUS OSOpenMutex(PHANDLE OutHandle, POBJECT_ATTRIBUTES ObjectAttributes);
 
 BSTATUS OSOutputDebugString(const char* String, size_t StringLength);
 
+BSTATUS OSPostCompletionPort(HANDLE PortHandle, void* Key, BSTATUS Status, uintptr_t Information);
+
 BSTATUS OSPulseEvent(HANDLE EventHandle);
 
 BSTATUS OSQueryEvent(HANDLE EventHandle, int* EventState);
@@ -152,6 +164,15 @@ BSTATUS OSReadVirtualMemory(HANDLE ProcessHandle, void* DestinationAddress, cons
 
 BSTATUS OSReleaseMutex(HANDLE MutexHandle);
 
+BSTATUS OSRemoveCompletionPort(
+	HANDLE PortHandle,
+	PIO_COMPLETION_ENTRY Entries,
+	int MaximumEntries,
+	int* OutEntryCount,
+	bool Alertable,
+	int TimeoutMS
+);
+
 BSTATUS OSResetEvent(HANDLE EventHandle);
 
 BSTATUS OSSeekFile(HANDLE FileHandle, int64_t Offset, int Whence, uint64_t* NewOutOffset);
@@ -174,6 +195,10 @@ BSTATUS OSShutDownSystem(void);
 
 BSTATUS OSSleep(int Milliseconds);
 
+BSTATUS OSSpawnProcess(PHANDLE OutProcessHandle, PHANDLE OutThreadHandle, POBJECT_ATTRIBUTES ObjectAttributes, PSPAWN_PARAMETERS Parameters);
+
+BSTATUS OSSpliceFile(PIO_STATUS_BLOCK Iosb, HANDLE InputHandle, uint64_t* InputOffset, HANDLE OutputHandle, uint64_t* OutputOffset, size_t Length, uint32_t Flags);
+
 BSTATUS OSTerminateThread(HANDLE ThreadHandle);
 
 BSTATUS OSTouchFile(HANDLE Handle, bool IsWrite);
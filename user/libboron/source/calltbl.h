@@ -16,7 +16,7 @@ CALL 9,  6, OSCreateThread
 CALL 10, 6, OSDeviceIoControl
 CALL 11, 4, OSDuplicateHandle
 CALL 12, 1, OSExitProcessInternal
-CALL 13, 0, OSExitThread
+CALL 13, 0, OSExitThreadInternal
 CALL 14, 4, OSFreeVirtualMemory
 CALL 15, 2, OSGetAlignmentFile
 CALL 16, 0, OSGetCurrentPeb
@@ -64,6 +64,14 @@ CALL 57, 6, OSCreateSymbolicLink
 CALL 58, 3, OSSetImageNameProcess
 CALL 59, 4, OSQuerySystemInformation
 CALL 60, 1, OSShutDownSystem
+//   61     OSCreateSectionObject
+CALL 62, 4, OSLookUpImageSection
+CALL 63, 4, OSSpawnProcess
+CALL 64, 7, OSSpliceFile
+CALL 65, 3, OSCreateCompletionPort
+CALL 66, 3, OSAssociateCompletionPort
+CALL 67, 4, OSPostCompletionPort
+CALL 68, 6, OSRemoveCompletionPort
 
 // The following system calls use at least one 64-bit parameter.
 // On 32-bit, 64-bit arguments typically get passed as high/low pairs of 32-bit arguments.
@@ -73,6 +81,7 @@ CALL 24, 7, OSMapViewOfObject
 CALL 33, 6, OSReadFile
 CALL 37, 4, OSSeekFile
 CALL 49, 7, OSWriteFile
+CALL 61, 3, OSCreateSectionObject
 
 #elif defined TARGET_ARM
 
@@ -87,6 +96,8 @@ CALL 33, 7, OSReadFile
 CALL 37, 5, OSSeekFile
 // no change, ByteOffset occupies r2 and r3
 CALL 49, 8, OSWriteFile
+// no change, MaxSize occupies r2 and r3
+CALL 61, 4, OSCreateSectionObject
 
 #else
 
@@ -94,5 +105,6 @@ CALL 24, 8, OSMapViewOfObject
 CALL 33, 7, OSReadFile
 CALL 37, 5, OSSeekFile
 CALL 49, 8, OSWriteFile
+CALL 61, 4, OSCreateSectionObject
 
 #endif
@@ -45,6 +45,10 @@ typedef struct
 	
 	int FileKind;
 	uintptr_t ImageBase;
+	
+	// The relocations that only depend on ImageBase have been applied already,
+	// either while loading, or by the process which shared the image section.
+	bool IsBaseRelocated;
 	PELF_DYNAMIC_ITEM DynamicTable;
 	ELF_DYNAMIC_INFO DynamicInfo;
 }
@@ -85,14 +89,40 @@ void OSDLLJumpToEntry(uintptr_t StackBottom, void* EntryPoint, void* Context);
 HIDDEN
 BSTATUS OSDLLOpenSelf(PHANDLE FileHandle);
 
+// Gets the size of an ELF image in memory, or zero if it has nothing to load.
+HIDDEN
+size_t OSDLLGetImageSize(PELF_HEADER ElfHeader, uint8_t* ProgramHeaders);
+
+// Creates a process through OSSpawnProcess.  Returns STATUS_UNIMPLEMENTED if the
+// image can't be spawned this way, in which case the caller should build the
+// process by hand.
+HIDDEN
+BSTATUS OSDLLSpawnProcess(
+	PHANDLE OutHandle,
+	PHANDLE OutMainThreadHandle,
+	POBJECT_ATTRIBUTES ObjectAttributes,
+	int ProcessFlags,
+	const char* ImageName,
+	const char* CommandLine,
+	const char* Environment
+);
+
 HIDDEN
 void OSDLLReinitializeHeap();
 
 HIDDEN
 void OSDLLClearEntireHeap(POS_HEAP Heap);
 
+// Gives the objects in the current thread's heap cache back to the global heap.
+HIDDEN
+void OSDLLFlushHeapCache();
+
 HIDDEN
 void OSInitializeExitCallbackList();
 
 HIDDEN
 void OSDLLDestroySharedObjects();
+
+// Sets up lazy binding for the PLT of a loaded image, if possible.
+HIDDEN
+bool OSDLLPrepareLazyPlt(PLOADED_IMAGE Image);
@@ -4,10 +4,18 @@
 
 Module name:
 	borondll/src/heap.c
-	
+
 Abstract:
 	This module implements the OSDLL's heap manager.
-	
+
+	Small allocations are served from slabs, which are carved into objects of
+	a single size class.  Each size class has its own lock, and the global
+	heap lets threads keep a cache of free objects in their TEB, so that they
+	don't have to wait for each other when a size class is contended.
+
+	Large allocations, as well as the slabs themselves, are served from arenas
+	of memory, whose free blocks are segregated by size.
+
 Author:
 	iProgramInCpp - 14 July 2025
 ***/
@@ -15,6 +23,7 @@ Author:
 #include <list.h>
 #include <string.h>
 #include <rtl/assert.h>
+#include "pebteb.h"
 
 //#define HEAP_DEBUG
 
@@ -41,6 +50,32 @@ Author:
 // The default size of an arena of memory.
 #define DEFAULT_ARENA_SIZE (128 * 1024)
 
+// The size of a slab.  Slabs are allocated as large blocks.
+#define SLAB_SIZE          (16 * 1024)
+
+// How many blocks of the free list for the requested size's power of two are
+// looked at, before only looking at free lists whose blocks are all big enough.
+#define MAX_FREE_LIST_SCAN (8)
+
+// How many objects a thread's cache may hold per size class, and how many are
+// moved between the cache and the heap at once.
+#define MAX_CACHED_OBJECTS (32)
+#define CACHE_BATCH_SIZE   (16)
+
+// The word right before the data of every block is a tag.  For large blocks, it's
+// HEAP_TAG_LARGE.  For small objects, it points to the object's slab, and has the
+// HEAP_TAG_FREE bit set if the object is free.
+#define HEAP_TAG_LARGE     (1)
+#define HEAP_TAG_FREE      (2)
+
+static const size_t OSHeapSizeClasses[] = {
+	16, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024
+};
+
+static_assert(ARRAY_COUNT(OSHeapSizeClasses) == OS_HEAP_SIZE_CLASS_COUNT);
+
+#define MAX_SMALL_SIZE     (OSHeapSizeClasses[OS_HEAP_SIZE_CLASS_COUNT - 1])
+
 typedef struct
 {
 	LIST_ENTRY BlockListEntry;
@@ -73,24 +108,117 @@ typedef struct
 	};
 #endif
 
+	// Always HEAP_TAG_LARGE.
+	uintptr_t Tag;
+
 	char Data[];
 }
 OS_HEAP_HEADER, *POS_HEAP_HEADER;
 
+typedef struct
+{
+	// Entry into the size class' list of partial slabs.  Only valid if
+	// the slab has at least one free object.
+	LIST_ENTRY ListEntry;
+
+	// The free objects of this slab, linked through their first word.
+	void* FreeObjects;
+
+	int FreeCount;
+	int ObjectCount;
+	int SizeClass;
+
+	// Keeps the objects aligned to 8 bytes.
+	int Padding;
+
+	char Data[];
+}
+OS_HEAP_SLAB, *POS_HEAP_SLAB;
+
+typedef struct
+{
+	uintptr_t Tag;
+
+	char Data[];
+}
+OS_HEAP_OBJECT, *POS_HEAP_OBJECT;
+
+#define OBJECT_FROM_DATA(Memory) CONTAINING_RECORD(Memory, OS_HEAP_OBJECT, Data)
+
+// ===== Large Blocks =====
+
+static int OSGetFreeListIndex(size_t Size)
+{
+	if (!Size)
+		return 0;
+
+	int Index = 63 - __builtin_clzll((unsigned long long) Size);
+	if (Index >= OS_HEAP_FREE_LIST_COUNT)
+		Index = OS_HEAP_FREE_LIST_COUNT - 1;
+
+	return Index;
+}
+
+static void OSInsertFreeBlock(POS_HEAP Heap, POS_HEAP_HEADER Header)
+{
+	int Index = OSGetFreeListIndex(Header->BlockSize);
+
+	InsertHeadList(&Heap->FreeLists[Index], &Header->FreeListEntry);
+	Heap->FreeListMask |= 1U << Index;
+}
+
+static void OSRemoveFreeBlock(POS_HEAP Heap, POS_HEAP_HEADER Header)
+{
+	int Index = OSGetFreeListIndex(Header->BlockSize);
+
+	RemoveEntryList(&Header->FreeListEntry);
+	if (IsListEmpty(&Heap->FreeLists[Index]))
+		Heap->FreeListMask &= ~(1U << Index);
+}
+
+// Finds a free block of at least Size bytes, or returns NULL if there isn't one.
+static POS_HEAP_HEADER OSFindFreeBlock(POS_HEAP Heap, size_t Size)
+{
+	int Index = OSGetFreeListIndex(Size);
+
+	// The blocks on the free list of the same power of two may or may not fit.
+	PLIST_ENTRY Head = &Heap->FreeLists[Index];
+	PLIST_ENTRY Entry = Head->Flink;
+
+	for (int i = 0; i < MAX_FREE_LIST_SCAN && Entry != Head; i++)
+	{
+		POS_HEAP_HEADER Header = CONTAINING_RECORD(Entry, OS_HEAP_HEADER, FreeListEntry);
+		if (Header->BlockSize >= Size)
+			return Header;
+
+		Entry = Entry->Flink;
+	}
+
+	// Every block on the free lists that follow fits, so take any one from the first
+	// of them that isn't empty.
+	uint32_t Mask = Heap->FreeListMask & ~((2U << Index) - 1);
+	if (!Mask)
+		return NULL;
+
+	Index = __builtin_ctz(Mask);
+	return CONTAINING_RECORD(Heap->FreeLists[Index].Flink, OS_HEAP_HEADER, FreeListEntry);
+}
+
 static void OSAddRegionHeap(POS_HEAP Heap, void* Address, size_t Size)
 {
 	OS_HEAP_HEADER* Header = (OS_HEAP_HEADER*)Address;
 	Header->BlockSize = Size - sizeof(OS_HEAP_HEADER);
 	Header->IsFree = true;
-	
+	Header->Tag = HEAP_TAG_LARGE;
+
 	InsertHeadList(&Heap->BlockList, &Header->BlockListEntry);
-	InsertHeadList(&Heap->FreeList,  &Header->FreeListEntry);
+	OSInsertFreeBlock(Heap, Header);
 }
 
 static POS_HEAP_HEADER OSCreateMappedRegionHeap(POS_HEAP Heap, size_t Size, bool IsArenaStart)
 {
 	HeapDbg("VirtualAlloc of size %zu...", Size);
-	
+
 #ifdef _WIN32
 
 	void* Address = VirtualAlloc(NULL, Size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
@@ -111,7 +239,7 @@ static POS_HEAP_HEADER OSCreateMappedRegionHeap(POS_HEAP Heap, size_t Size, bool
 		MEM_COMMIT | MEM_RESERVE,
 		PAGE_READ | PAGE_WRITE
 	);
-	
+
 	if (FAILED(Status))
 	{
 		DbgPrint("OS: Cannot allocate more memory: %d (%s).", Status, RtlGetStatusString(Status));
@@ -135,101 +263,74 @@ static POS_HEAP_HEADER OSCreateArenaHeap(POS_HEAP Heap)
 	return OSCreateMappedRegionHeap(Heap, DEFAULT_ARENA_SIZE, true);
 }
 
-void* OSAllocateHeap(POS_HEAP Heap, size_t Size)
+static void* OSAllocateLarge(POS_HEAP Heap, size_t Size)
 {
-	if (!Size)
-		return NULL;
-	
 	OSEnterCriticalSection(&Heap->CriticalSection);
-	
-	PLIST_ENTRY Entry;
 
-	// Make sure the size is aligned to 8 bytes.
-	Size = (Size + 7) & ~7;
-
-	// Search the free list and return the region.
-	while (true)
+	// If the size is too big for an arena, map a region just for this block.
+	if (Size >= DEFAULT_ARENA_SIZE - sizeof(OS_HEAP_HEADER))
 	{
-		Entry = Heap->FreeList.Flink;
-
-		while (Size < DEFAULT_ARENA_SIZE - sizeof(OS_HEAP_HEADER) && Entry != &Heap->FreeList)
+		POS_HEAP_HEADER Header = OSCreateMappedRegionHeap(Heap, Size + sizeof(OS_HEAP_HEADER), false);
+		if (!Header)
 		{
-			POS_HEAP_HEADER Header = CONTAINING_RECORD(Entry, OS_HEAP_HEADER, FreeListEntry);
-
-			if (Header->BlockSize < Size)
-			{
-				// No fit.
-				Entry = Entry->Flink;
-				continue;
-			}
-
-			// Check if the fit is within our tolerance.
-			if (Header->BlockSize >= Size + MIN_FREE_GAP + sizeof(OS_HEAP_HEADER))
-			{
-				// No, this is a good fit with some clearance, so setup a new header.
-				POS_HEAP_HEADER NewHeader = (POS_HEAP_HEADER)&Header->Data[Size];
-				memset(NewHeader, 0, sizeof(OS_HEAP_HEADER));
-
-				// Add this new header to the two lists.
-				InsertHeadList(&Header->BlockListEntry, &NewHeader->BlockListEntry);
-				InsertHeadList(Entry, &NewHeader->FreeListEntry);
-
-				NewHeader->BlockSize = Header->BlockSize - sizeof(OS_HEAP_HEADER) - Size;
-				NewHeader->IsFree = true;
-				Header->BlockSize = Size;
-			}
-
-			// Now return the block.
-			RemoveEntryList(Entry);
-
-			Header->IsFree = false;
-			Header->WasMapped = false;
-			
+			// Out of virtual address space (or memory).
 			OSLeaveCriticalSection(&Heap->CriticalSection);
-			return Header->Data;
+			return NULL;
 		}
 
-		// There are no free regions, or the size is too big.
-		// If the size requested is smaller than an arena size, then create one arena
-		// and retry.
+		OSRemoveFreeBlock(Heap, Header);
 
-		if (Size < DEFAULT_ARENA_SIZE - sizeof(OS_HEAP_HEADER))
-		{
-			POS_HEAP_HEADER Header = OSCreateArenaHeap(Heap);
-			if (!Header)
-			{
-				// Out of virtual address space (or memory).
-				OSLeaveCriticalSection(&Heap->CriticalSection);
-				return NULL;
-			}
-
-			// The arena has been added, so do a retry.
-			continue;
-		}
+		Header->IsFree = false;
+		Header->WasMapped = true;
 
-		POS_HEAP_HEADER Header = OSCreateMappedRegionHeap(Heap, Size + sizeof(OS_HEAP_HEADER), false);
+		OSLeaveCriticalSection(&Heap->CriticalSection);
+		return Header->Data;
+	}
+
+	POS_HEAP_HEADER Header = OSFindFreeBlock(Heap, Size);
+	if (!Header)
+	{
+		// There are no free regions big enough, so create another arena.
+		Header = OSCreateArenaHeap(Heap);
 		if (!Header)
 		{
 			// Out of virtual address space (or memory).
 			OSLeaveCriticalSection(&Heap->CriticalSection);
 			return NULL;
 		}
+	}
 
-		RemoveEntryList(&Header->FreeListEntry);
+	OSRemoveFreeBlock(Heap, Header);
 
-		Header->IsFree = false;
-		Header->WasMapped = true;
+	// Check if the fit is within our tolerance.
+	if (Header->BlockSize >= Size + MIN_FREE_GAP + sizeof(OS_HEAP_HEADER))
+	{
+		// No, this is a good fit with some clearance, so setup a new header.
+		POS_HEAP_HEADER NewHeader = (POS_HEAP_HEADER)&Header->Data[Size];
+		memset(NewHeader, 0, sizeof(OS_HEAP_HEADER));
 
-		OSLeaveCriticalSection(&Heap->CriticalSection);
-		return Header->Data;
+		InsertHeadList(&Header->BlockListEntry, &NewHeader->BlockListEntry);
+
+		NewHeader->BlockSize = Header->BlockSize - sizeof(OS_HEAP_HEADER) - Size;
+		NewHeader->IsFree = true;
+		NewHeader->Tag = HEAP_TAG_LARGE;
+		Header->BlockSize = Size;
+
+		OSInsertFreeBlock(Heap, NewHeader);
 	}
+
+	Header->IsFree = false;
+	Header->WasMapped = false;
+
+	OSLeaveCriticalSection(&Heap->CriticalSection);
+	return Header->Data;
 }
 
 static bool OSTryMergeNext(POS_HEAP Heap, POS_HEAP_HEADER Header)
 {
 	if (!Header->IsFree)
 		return false;
-	
+
 	if (Header->BlockListEntry.Flink == &Heap->BlockList)
 		return false;
 
@@ -244,30 +345,25 @@ static bool OSTryMergeNext(POS_HEAP Heap, POS_HEAP_HEADER Header)
 	if (!OtherHeader->IsFree || OtherHeader->WasMapped || OtherHeader->IsArenaStart)
 		return false;
 
+	// The merged block may belong on a different free list.
+	OSRemoveFreeBlock(Heap, Header);
+	OSRemoveFreeBlock(Heap, OtherHeader);
+
 	Header->BlockSize += sizeof(OS_HEAP_HEADER) + OtherHeader->BlockSize;
 
 	RemoveEntryList(&OtherHeader->BlockListEntry);
-	RemoveEntryList(&OtherHeader->FreeListEntry);
 
+	OSInsertFreeBlock(Heap, Header);
 	return true;
 }
 
 #ifdef HEAP_DEBUG
 
-static void OSDebugDumpHeap(POS_HEAP Heap, bool ShowFreeList)
+static void OSDebugDumpHeapList(PLIST_ENTRY Head, bool ShowFreeList)
 {
-	PLIST_ENTRY Entry, Head;
-
-	if (ShowFreeList)
-		Head = &Heap->FreeList;
-	else
-		Head = &Heap->BlockList;
-
-	HeapDbg("\tDumping %s list state for debug:", ShowFreeList ? "Free" : "Block");
-
 	PLIST_ENTRY LastAddress = 0;
 
-	Entry = Head->Flink;
+	PLIST_ENTRY Entry = Head->Flink;
 	while (Entry != Head)
 	{
 		UNUSED
@@ -290,19 +386,30 @@ static void OSDebugDumpHeap(POS_HEAP Heap, bool ShowFreeList)
 	}
 }
 
+static void OSDebugDumpHeap(POS_HEAP Heap, bool ShowFreeList)
+{
+	HeapDbg("\tDumping %s list state for debug:", ShowFreeList ? "Free" : "Block");
+
+	if (!ShowFreeList)
+	{
+		OSDebugDumpHeapList(&Heap->BlockList, false);
+		return;
+	}
+
+	for (int i = 0; i < OS_HEAP_FREE_LIST_COUNT; i++)
+		OSDebugDumpHeapList(&Heap->FreeLists[i], true);
+}
+
 #else
-	
+
 #define OSDebugDumpHeap(...)
 
 #endif
 
-void OSFreeHeap(POS_HEAP Heap, void* Memory)
+static void OSFreeLarge(POS_HEAP Heap, void* Memory)
 {
-	if (!Memory)
-		return;
-	
 	OSEnterCriticalSection(&Heap->CriticalSection);
-	
+
 	// Access the header.
 	POS_HEAP_HEADER Header = CONTAINING_RECORD(Memory, OS_HEAP_HEADER, Data);
 
@@ -337,7 +444,7 @@ void OSFreeHeap(POS_HEAP Heap, void* Memory)
 			sizeof(OS_HEAP_HEADER) + Header->BlockSize,
 			MEM_RELEASE
 		);
-		
+
 		if (FAILED(Status))
 			DbgPrint("OS: Cannot free pointer %p: %d (%s).", Header, Status, RtlGetStatusString(Status));
 
@@ -349,7 +456,7 @@ void OSFreeHeap(POS_HEAP Heap, void* Memory)
 
 	// First, mark as free.
 	Header->IsFree = true;
-	InsertTailList(&Heap->FreeList, &Header->FreeListEntry);
+	OSInsertFreeBlock(Heap, Header);
 
 	// If the next item exists, then merge with it.
 	OSTryMergeNext(Heap, Header);
@@ -374,7 +481,7 @@ void OSFreeHeap(POS_HEAP Heap, void* Memory)
 		Header->BlockSize + sizeof(OS_HEAP_HEADER) == DEFAULT_ARENA_SIZE)
 	{
 		RemoveEntryList(&Header->BlockListEntry);
-		RemoveEntryList(&Header->FreeListEntry);
+		OSRemoveFreeBlock(Heap, Header);
 
 		HeapDbg("Unmapping arena %p", Header);
 
@@ -390,21 +497,315 @@ void OSFreeHeap(POS_HEAP Heap, void* Memory)
 			sizeof(OS_HEAP_HEADER) + Header->BlockSize,
 			MEM_RELEASE
 		);
-		
+
 		if (FAILED(Status))
 			DbgPrint("OS: Cannot free arena %p: %d (%s).", Header, Status, RtlGetStatusString(Status));
 #endif
 	}
-	
+
 	OSLeaveCriticalSection(&Heap->CriticalSection);
 }
 
-BSTATUS OSInitializeHeap(POS_HEAP Heap)
+// ===== Slabs =====
+
+static int OSGetSizeClass(size_t Size)
+{
+	int Index = 0;
+	while (OSHeapSizeClasses[Index] < Size)
+		Index++;
+
+	return Index;
+}
+
+// Creates a new slab for a size class.  The size class' lock must be held.
+static POS_HEAP_SLAB OSCreateSlab(POS_HEAP Heap, int SizeClass)
+{
+	POS_HEAP_SLAB Slab = OSAllocateLarge(Heap, SLAB_SIZE);
+	if (!Slab)
+		return NULL;
+
+	size_t SlotSize = sizeof(OS_HEAP_OBJECT) + OSHeapSizeClasses[SizeClass];
+
+	Slab->ObjectCount = (SLAB_SIZE - sizeof(OS_HEAP_SLAB)) / SlotSize;
+	Slab->FreeCount = Slab->ObjectCount;
+	Slab->SizeClass = SizeClass;
+	Slab->FreeObjects = NULL;
+
+	// Link the objects backwards, so that they're handed out in order of address.
+	for (int i = Slab->ObjectCount - 1; i >= 0; i--)
+	{
+		POS_HEAP_OBJECT Object = (POS_HEAP_OBJECT) &Slab->Data[i * SlotSize];
+
+		Object->Tag = (uintptr_t) Slab | HEAP_TAG_FREE;
+		*(void**) Object->Data = Slab->FreeObjects;
+		Slab->FreeObjects = Object->Data;
+	}
+
+	InsertHeadList(&Heap->SizeClasses[SizeClass].PartialSlabs, &Slab->ListEntry);
+
+	HeapDbg("Created slab %p for size class %zu.", Slab, OSHeapSizeClasses[SizeClass]);
+	return Slab;
+}
+
+// Allocates an object from a size class.  The size class' lock must be held.
+static void* OSAllocateSlabObject(POS_HEAP Heap, int SizeClass)
+{
+	POS_HEAP_SIZE_CLASS Class = &Heap->SizeClasses[SizeClass];
+
+	if (IsListEmpty(&Class->PartialSlabs) && !OSCreateSlab(Heap, SizeClass))
+		return NULL;
+
+	POS_HEAP_SLAB Slab = CONTAINING_RECORD(Class->PartialSlabs.Flink, OS_HEAP_SLAB, ListEntry);
+
+	void* Memory = Slab->FreeObjects;
+	Slab->FreeObjects = *(void**) Memory;
+
+	// If the slab is now full, it can't serve any more allocations.
+	if (--Slab->FreeCount == 0)
+		RemoveEntryList(&Slab->ListEntry);
+
+	OBJECT_FROM_DATA(Memory)->Tag = (uintptr_t) Slab;
+	return Memory;
+}
+
+// Returns an object to its slab.  The size class' lock must be held.
+static void OSFreeSlabObject(POS_HEAP Heap, void* Memory)
+{
+	POS_HEAP_OBJECT Object = OBJECT_FROM_DATA(Memory);
+	POS_HEAP_SLAB Slab = (POS_HEAP_SLAB) (Object->Tag & ~HEAP_TAG_FREE);
+	POS_HEAP_SIZE_CLASS Class = &Heap->SizeClasses[Slab->SizeClass];
+
+	Object->Tag = (uintptr_t) Slab | HEAP_TAG_FREE;
+	*(void**) Memory = Slab->FreeObjects;
+	Slab->FreeObjects = Memory;
+
+	// If the slab was full, it can serve allocations again.
+	if (Slab->FreeCount++ == 0)
+		InsertHeadList(&Class->PartialSlabs, &Slab->ListEntry);
+
+	// If the slab is now entirely free, give it back, unless it's the only one
+	// left that can serve allocations.
+	if (Slab->FreeCount == Slab->ObjectCount &&
+		Class->PartialSlabs.Flink != Class->PartialSlabs.Blink)
+	{
+		HeapDbg("Freeing slab %p of size class %zu.", Slab, OSHeapSizeClasses[Slab->SizeClass]);
+
+		RemoveEntryList(&Slab->ListEntry);
+		OSFreeLarge(Heap, Slab);
+	}
+}
+
+// ===== Thread Caches =====
+
+static POS_HEAP_CACHE OSGetHeapCache()
+{
+#ifdef _WIN32
+	return NULL;
+#else
+	PTEB Teb = OSDLLTryGetCurrentTeb();
+	if (!Teb)
+		return NULL;
+
+	return &Teb->HeapCache;
+#endif
+}
+
+static void* OSPopHeapCache(POS_HEAP_CACHE Cache, int SizeClass)
+{
+	void* Memory = Cache->Objects[SizeClass];
+	if (!Memory)
+		return NULL;
+
+	Cache->Objects[SizeClass] = *(void**) Memory;
+	Cache->Counts[SizeClass]--;
+
+	// The object is no longer free.
+	OBJECT_FROM_DATA(Memory)->Tag &= ~HEAP_TAG_FREE;
+	return Memory;
+}
+
+static void OSPushHeapCache(POS_HEAP_CACHE Cache, int SizeClass, void* Memory)
+{
+	// The object stays marked as free while in the cache, so double frees are still caught.
+	OBJECT_FROM_DATA(Memory)->Tag |= HEAP_TAG_FREE;
+
+	*(void**) Memory = Cache->Objects[SizeClass];
+	Cache->Objects[SizeClass] = Memory;
+	Cache->Counts[SizeClass]++;
+}
+
+// Moves a batch of objects from the heap into the cache.  This waits for the size class' lock.
+static void OSRefillHeapCache(POS_HEAP Heap, POS_HEAP_CACHE Cache, int SizeClass)
+{
+	POS_HEAP_SIZE_CLASS Class = &Heap->SizeClasses[SizeClass];
+
+	OSEnterCriticalSection(&Class->CriticalSection);
+
+	for (int i = 0; i < CACHE_BATCH_SIZE; i++)
+	{
+		void* Memory = OSAllocateSlabObject(Heap, SizeClass);
+		if (!Memory)
+			break;
+
+		OSPushHeapCache(Cache, SizeClass, Memory);
+	}
+
+	OSLeaveCriticalSection(&Class->CriticalSection);
+}
+
+// Moves a batch of objects from the cache back into the heap.  This waits for the size class' lock.
+static void OSFlushHeapCache(POS_HEAP Heap, POS_HEAP_CACHE Cache, int SizeClass, int Count)
+{
+	POS_HEAP_SIZE_CLASS Class = &Heap->SizeClasses[SizeClass];
+
+	OSEnterCriticalSection(&Class->CriticalSection);
+
+	for (int i = 0; i < Count && Cache->Objects[SizeClass]; i++)
+		OSFreeSlabObject(Heap, OSPopHeapCache(Cache, SizeClass));
+
+	OSLeaveCriticalSection(&Class->CriticalSection);
+}
+
+// ===== Allocation =====
+
+static void* OSAllocateSmall(POS_HEAP Heap, int SizeClass, bool UseCache)
+{
+	POS_HEAP_SIZE_CLASS Class = &Heap->SizeClasses[SizeClass];
+
+	if (!OSTryEnterCriticalSection(&Class->CriticalSection))
+	{
+		// Someone else is using this size class.  Rather than waiting for them every
+		// time, take objects from this thread's cache, refilling it in batches.
+		POS_HEAP_CACHE Cache = UseCache ? OSGetHeapCache() : NULL;
+		if (Cache)
+		{
+			if (!Cache->Counts[SizeClass])
+				OSRefillHeapCache(Heap, Cache, SizeClass);
+
+			void* Memory = OSPopHeapCache(Cache, SizeClass);
+			if (Memory)
+				return Memory;
+		}
+
+		OSEnterCriticalSection(&Class->CriticalSection);
+	}
+
+	void* Memory = OSAllocateSlabObject(Heap, SizeClass);
+
+	OSLeaveCriticalSection(&Class->CriticalSection);
+	return Memory;
+}
+
+static void OSFreeSmall(POS_HEAP Heap, void* Memory, bool UseCache)
+{
+	POS_HEAP_SLAB Slab = (POS_HEAP_SLAB) OBJECT_FROM_DATA(Memory)->Tag;
+	int SizeClass = Slab->SizeClass;
+	POS_HEAP_SIZE_CLASS Class = &Heap->SizeClasses[SizeClass];
+
+	if (!OSTryEnterCriticalSection(&Class->CriticalSection))
+	{
+		// Someone else is using this size class, so put the object in this thread's
+		// cache instead of waiting for them.  If it's full, flush half of it.
+		POS_HEAP_CACHE Cache = UseCache ? OSGetHeapCache() : NULL;
+		if (Cache)
+		{
+			if (Cache->Counts[SizeClass] >= MAX_CACHED_OBJECTS)
+				OSFlushHeapCache(Heap, Cache, SizeClass, MAX_CACHED_OBJECTS / 2);
+
+			OSPushHeapCache(Cache, SizeClass, Memory);
+			return;
+		}
+
+		OSEnterCriticalSection(&Class->CriticalSection);
+	}
+
+	OSFreeSlabObject(Heap, Memory);
+
+	OSLeaveCriticalSection(&Class->CriticalSection);
+}
+
+static void* OSAllocateHeapInternal(POS_HEAP Heap, size_t Size, bool UseCache)
+{
+	if (!Size)
+		return NULL;
+
+	// Make sure the size is aligned to 8 bytes.
+	Size = (Size + 7) & ~7;
+
+	if (Size <= MAX_SMALL_SIZE)
+		return OSAllocateSmall(Heap, OSGetSizeClass(Size), UseCache);
+
+	return OSAllocateLarge(Heap, Size);
+}
+
+static void OSFreeHeapInternal(POS_HEAP Heap, void* Memory, bool UseCache)
+{
+	if (!Memory)
+		return;
+
+	uintptr_t Tag = OBJECT_FROM_DATA(Memory)->Tag;
+
+	if (Tag & HEAP_TAG_LARGE)
+	{
+		OSFreeLarge(Heap, Memory);
+		return;
+	}
+
+	if (Tag & HEAP_TAG_FREE)
+	{
+		DbgPrint("OS: double-free detected");
+		ABORT();
+		return;
+	}
+
+	OSFreeSmall(Heap, Memory, UseCache);
+}
+
+void* OSAllocateHeap(POS_HEAP Heap, size_t Size)
+{
+	return OSAllocateHeapInternal(Heap, Size, false);
+}
+
+void OSFreeHeap(POS_HEAP Heap, void* Memory)
+{
+	OSFreeHeapInternal(Heap, Memory, false);
+}
+
+static void OSInitializeHeapLists(POS_HEAP Heap)
 {
 	InitializeListHead(&Heap->BlockList);
-	InitializeListHead(&Heap->FreeList);
-	
-	return OSInitializeCriticalSection(&Heap->CriticalSection);
+
+	for (int i = 0; i < OS_HEAP_FREE_LIST_COUNT; i++)
+		InitializeListHead(&Heap->FreeLists[i]);
+
+	Heap->FreeListMask = 0;
+
+	for (int i = 0; i < OS_HEAP_SIZE_CLASS_COUNT; i++)
+		InitializeListHead(&Heap->SizeClasses[i].PartialSlabs);
+}
+
+BSTATUS OSInitializeHeap(POS_HEAP Heap)
+{
+	OSInitializeHeapLists(Heap);
+
+	BSTATUS Status = OSInitializeCriticalSection(&Heap->CriticalSection);
+	if (FAILED(Status))
+		return Status;
+
+	for (int i = 0; i < OS_HEAP_SIZE_CLASS_COUNT; i++)
+	{
+		Status = OSInitializeCriticalSection(&Heap->SizeClasses[i].CriticalSection);
+		if (FAILED(Status))
+		{
+			while (i--)
+				OSDeleteCriticalSection(&Heap->SizeClasses[i].CriticalSection);
+
+			OSDeleteCriticalSection(&Heap->CriticalSection);
+			return Status;
+		}
+	}
+
+	return STATUS_SUCCESS;
 }
 
 // TODO: Add OSReallocateHeap
@@ -412,6 +813,31 @@ BSTATUS OSInitializeHeap(POS_HEAP Heap)
 // Global Heap
 static OS_HEAP OSDLLGlobalHeap;
 
+// Forgets about the objects in the current thread's cache.  Used when the
+// global heap is reset, since they will no longer belong to it.
+static void OSDLLForgetHeapCache()
+{
+	POS_HEAP_CACHE Cache = OSGetHeapCache();
+	if (Cache)
+		memset(Cache, 0, sizeof *Cache);
+}
+
+// Gives the objects in the current thread's cache back to the global heap.  Called
+// before the thread exits, since they, and the slabs they're in, would leak otherwise.
+HIDDEN
+void OSDLLFlushHeapCache()
+{
+	POS_HEAP_CACHE Cache = OSGetHeapCache();
+	if (!Cache)
+		return;
+
+	for (int i = 0; i < OS_HEAP_SIZE_CLASS_COUNT; i++)
+	{
+		if (Cache->Counts[i])
+			OSFlushHeapCache(&OSDLLGlobalHeap, Cache, i, Cache->Counts[i]);
+	}
+}
+
 HIDDEN
 void OSDLLInitializeGlobalHeap()
 {
@@ -427,10 +853,11 @@ HIDDEN
 void OSDLLReinitializeHeap()
 {
 	POS_HEAP Heap = &OSDLLGlobalHeap;
-	
+
+	OSDLLForgetHeapCache();
+
 	OSEnterCriticalSection(&Heap->CriticalSection);
-	InitializeListHead(&Heap->BlockList);
-	InitializeListHead(&Heap->FreeList);
+	OSInitializeHeapLists(Heap);
 	OSLeaveCriticalSection(&Heap->CriticalSection);
 }
 
@@ -439,39 +866,47 @@ void OSDLLClearEntireHeap(POS_HEAP Heap)
 {
 	if (!Heap) {
 		Heap = &OSDLLGlobalHeap;
+		OSDLLForgetHeapCache();
 	}
-	
-	// First, free everything.
+
+	// First, free everything.  This includes the slabs, which are large blocks.
 	PLIST_ENTRY Entry = Heap->BlockList.Flink;
 	while (Entry != &Heap->BlockList)
 	{
 		POS_HEAP_HEADER Header = CONTAINING_RECORD(Entry, OS_HEAP_HEADER, BlockListEntry);
 		Entry = Entry->Flink;
-		
+
 		if (Header->IsFree)
 			continue;
-		
-		OSFreeHeap(Heap, &Header->Data);
+
+		OSFreeLarge(Heap, &Header->Data);
 		Entry = Heap->BlockList.Flink;
 	}
-	
+
+	for (int i = 0; i < OS_HEAP_SIZE_CLASS_COUNT; i++)
+		InitializeListHead(&Heap->SizeClasses[i].PartialSlabs);
+
 	// Make sure everything is deleted.
 	ASSERT(IsListEmpty(&Heap->BlockList));
-	ASSERT(IsListEmpty(&Heap->FreeList));
+	ASSERT(Heap->FreeListMask == 0);
 }
 
 void OSDeleteHeap(POS_HEAP Heap)
 {
-	OSDeleteCriticalSection(&Heap->CriticalSection);
 	OSDLLClearEntireHeap(Heap);
+
+	for (int i = 0; i < OS_HEAP_SIZE_CLASS_COUNT; i++)
+		OSDeleteCriticalSection(&Heap->SizeClasses[i].CriticalSection);
+
+	OSDeleteCriticalSection(&Heap->CriticalSection);
 }
 
 void* OSAllocate(size_t Size)
 {
-	return OSAllocateHeap(&OSDLLGlobalHeap, Size);
+	return OSAllocateHeapInternal(&OSDLLGlobalHeap, Size, true);
 }
 
 void OSFree(void* Memory)
 {
-	OSFreeHeap(&OSDLLGlobalHeap, Memory);
+	OSFreeHeapInternal(&OSDLLGlobalHeap, Memory, true);
 }
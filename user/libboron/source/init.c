@@ -20,6 +20,30 @@ extern HIDDEN ELF_DYNAMIC_ITEM _DYNAMIC[];
 static LIST_ENTRY OSDllLoadQueue;
 static LIST_ENTRY OSDllsLoaded;
 
+// Cache of symbols that have already been looked up, so that every module importing
+// the same function doesn't have to probe every loaded module again.  Because DLLs are
+// never unloaded, the entries never go stale.
+#define OSDLL_SYMBOL_CACHE_BUCKETS (256)
+
+typedef struct OSDLL_SYMBOL_CACHE_ENTRY_tag
+{
+	struct OSDLL_SYMBOL_CACHE_ENTRY_tag* Next;
+	const char* Name;
+	uintptr_t Address;
+	uint32_t Hash;
+}
+OSDLL_SYMBOL_CACHE_ENTRY, *POSDLL_SYMBOL_CACHE_ENTRY;
+
+static POSDLL_SYMBOL_CACHE_ENTRY OSDllSymbolCache[OSDLL_SYMBOL_CACHE_BUCKETS];
+
+// Lazily bound PLT entries may be resolved by any thread.
+static OS_CRITICAL_SECTION OSDllSymbolCacheLock;
+
+#ifdef TARGET_AMD64
+// Resolver trampoline for lazily bound PLT entries.  See entry.S.
+extern void OSDLLLazyBindEntry();
+#endif
+
 // Adds a NEEDED entry, which resolves to an offset in strtab which
 // will be resolved later.
 HIDDEN
@@ -52,6 +76,52 @@ const char* OSDLLOffsetPathAway(const char* Name)
 	return Name;
 }
 
+// Maps the pages of a loadable segment from a cached image section, copy-on-write.
+static BSTATUS OSDLLMapSegmentFromImageSection(
+	HANDLE ProcessHandle,
+	HANDLE SectionHandle,
+	uintptr_t ImageBase,
+	PELF_PROGRAM_HEADER ProgramHeader,
+	int Protection
+)
+{
+	uintptr_t StartOffset = ProgramHeader->VirtualAddress & ~(PAGE_SIZE - 1);
+	uintptr_t EndOffset = PAGE_ALIGN_UP(ProgramHeader->VirtualAddress + ProgramHeader->SizeInMemory);
+	void* Address = (void*)(ImageBase + StartOffset);
+	
+	return OSMapViewOfObject(
+		ProcessHandle,
+		SectionHandle,
+		&Address,
+		EndOffset - StartOffset,
+		MEM_COMMIT | MEM_FIXED | MEM_COW,
+		StartOffset,
+		Protection
+	);
+}
+
+// Gets the size of an ELF image in memory, or zero if it has nothing to load.
+HIDDEN
+size_t OSDLLGetImageSize(PELF_HEADER ElfHeader, uint8_t* ProgramHeaders)
+{
+	uintptr_t MaximumAddress = 0;
+	
+	for (int i = 0; i < ElfHeader->ProgramHeaderCount; i++)
+	{
+		PELF_PROGRAM_HEADER Header = (void*)(ProgramHeaders + i * ElfHeader->ProgramHeaderSize);
+		
+		if (Header->Type != PROG_LOAD && Header->Type != PROG_DYNAMIC)
+			continue;
+		
+		uintptr_t AddressEnd = (Header->VirtualAddress + Header->SizeInMemory + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+		
+		if (MaximumAddress < AddressEnd)
+			MaximumAddress = AddressEnd;
+	}
+	
+	return MaximumAddress;
+}
+
 // TODO: If we need to implement loading libraries at runtime,
 // we should protect this with a critical section!
 HIDDEN
@@ -73,6 +143,8 @@ BSTATUS OSDLLMapElfFile(
 	PLOADED_IMAGE LoadedImage;
 	uint8_t* ProgramHeaders = NULL;
 	uintptr_t ImageBase = 0;
+	size_t ImageSize = 0;
+	HANDLE ImageSectionHandle = HANDLE_NONE;
 	bool NeedFreeProgramHeaders = false;
 	bool NeedReadAndMapFile = true;
 	bool IsMainExecutable = FileKind == FILE_KIND_MAIN_EXECUTABLE;
@@ -162,20 +234,7 @@ BSTATUS OSDLLMapElfFile(
 	if (ElfHeader.Type == ELF_TYPE_DYNAMIC)
 	{
 		// Read the program headers and decide on the maximum address.
-		uintptr_t MaximumAddress = 0;
-		
-		for (int i = 0; i < ElfHeader.ProgramHeaderCount; i++)
-		{
-			PELF_PROGRAM_HEADER Header = (void*)(ProgramHeaders + i * ElfHeader.ProgramHeaderSize);
-			
-			if (Header->Type != PROG_LOAD && Header->Type != PROG_DYNAMIC)
-				continue;
-			
-			uintptr_t AddressEnd = (Header->VirtualAddress + Header->SizeInMemory + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
-			
-			if (MaximumAddress < AddressEnd)
-				MaximumAddress = AddressEnd;
-		}
+		uintptr_t MaximumAddress = OSDLLGetImageSize(&ElfHeader, ProgramHeaders);
 		
 		if (MaximumAddress == 0)
 		{
@@ -208,6 +267,7 @@ BSTATUS OSDLLMapElfFile(
 		// Found it.
 		LdrDbgPrint("OSDLL: %s's image base is %p (size is %zu)", Name, BaseAddress, RegionSize);
 		ImageBase = (uintptr_t) BaseAddress;
+		ImageSize = (size_t) MaximumAddress;
 		
 		// TODO: Now, free the reserved memory.  But we may need to avoid a race condition
 		// where someone else wants to reserve memory there.
@@ -239,6 +299,21 @@ BSTATUS OSDLLMapElfFile(
 		Peb->Loader.ImageBase = ImageBase;
 	}
 	
+	// DLLs loaded into this process may share their base-relocated pages with
+	// other processes that loaded them at the same base.  The kernel builds the
+	// section from the file the first time.  If that fails for any reason, the
+	// DLL is simply loaded and relocated privately.
+	bool CanShareImage =
+		FileKind == FILE_KIND_DYNAMIC_LIBRARY &&
+		!IsSeparateProcess &&
+		ElfHeader.Type == ELF_TYPE_DYNAMIC;
+	
+	if (CanShareImage && FAILED(OSLookUpImageSection(&ImageSectionHandle, Handle, ImageBase, ImageSize)))
+		ImageSectionHandle = HANDLE_NONE;
+	
+	if (ImageSectionHandle != HANDLE_NONE)
+		LdrDbgPrint("OSDLL: Mapping %s from the image section cache.", Name);
+	
 	// Step 1.  Parse program headers.
 	for (int i = 0; i < ElfHeader.ProgramHeaderCount; i++)
 	{
@@ -292,6 +367,31 @@ BSTATUS OSDLLMapElfFile(
 					goto EarlyExit;
 				}
 				
+				if (ImageSectionHandle != HANDLE_NONE)
+				{
+					Status = OSDLLMapSegmentFromImageSection(
+						ProcessHandle,
+						ImageSectionHandle,
+						ImageBase,
+						&ElfProgramHeader,
+						Protection
+					);
+					
+					if (FAILED(Status))
+					{
+						DbgPrint(
+							"OSDLL: Failed to map segment %d of %s from its image section: %s (%d)",
+							i,
+							Name,
+							RtlGetStatusString(Status),
+							Status
+						);
+						goto EarlyExit;
+					}
+					
+					break;
+				}
+				
 				if (ElfProgramHeader.SizeInFile == 0)
 				{
 					LdrDbgPrint("OSDLL: Uninitialized data at %p", ElfProgramHeader.VirtualAddress);
@@ -451,14 +551,20 @@ BSTATUS OSDLLMapElfFile(
 		!RtlParseDynamicTable(DynamicTable, &LoadedImage->DynamicInfo, ImageBase))
 	{
 		OSFree(LoadedImage);
-		return STATUS_INVALID_EXECUTABLE;
+		Status = STATUS_INVALID_EXECUTABLE;
+		goto EarlyExit;
 	}
 	
 	LoadedImage->DynamicTable = DynamicTable;
 	LoadedImage->ImageBase = ImageBase;
+	LoadedImage->IsBaseRelocated = ImageSectionHandle != HANDLE_NONE;
+	
 	InsertTailList(&OSDllsLoaded, &LoadedImage->ListEntry);
 	
 EarlyExit:
+	if (ImageSectionHandle != HANDLE_NONE)
+		OSClose(ImageSectionHandle);
+	
 	if (ProgramHeaders && NeedFreeProgramHeaders)
 		OSFree(ProgramHeaders);
 	
@@ -504,6 +610,7 @@ void OSDLLAddSelfToDllList()
 	LoadedImage->ImageBase = RtlGetImageBase();
 	LoadedImage->DynamicTable = _DYNAMIC;
 	LoadedImage->FileKind = FILE_KIND_INTERPRETER;
+	LoadedImage->IsBaseRelocated = true;
 	
 #ifdef DEBUG
 	// Assert that DYN_NEEDED is not specified.
@@ -631,15 +738,21 @@ BSTATUS OSDLLRunImage(PPEB Peb, OSDLL_ENTRY_POINT* OutEntryPoint)
 		if (LoadedImage->FileKind != FILE_KIND_INTERPRETER)
 		{
 			LdrDbgPrint("OSDLL: Linking %s, file kind: %d...", LoadedImage->Name, LoadedImage->FileKind);
-			if (!RtlPerformRelocations(&LoadedImage->DynamicInfo, LoadedImage->ImageBase))
+			int Kinds = RTL_RELOC_SYMBOLIC;
+			if (!LoadedImage->IsBaseRelocated)
+				Kinds |= RTL_RELOC_BASE;
+			
+			if (!RtlPerformSelectedRelocations(&LoadedImage->DynamicInfo, LoadedImage->ImageBase, Kinds))
 			{
 				DbgPrint("OSDLL: Cannot perform relocations on module %s.", LoadedImage->Name);
 				return STATUS_INVALID_EXECUTABLE;
 			}
 			
-			RtlRelocateRelrEntries(&LoadedImage->DynamicInfo, LoadedImage->ImageBase);
+			if (!LoadedImage->IsBaseRelocated)
+				RtlRelocateRelrEntries(&LoadedImage->DynamicInfo, LoadedImage->ImageBase);
 			
-			if (!RtlLinkPlt(&LoadedImage->DynamicInfo, LoadedImage->ImageBase, LoadedImage->Name))
+			if (!OSDLLPrepareLazyPlt(LoadedImage) &&
+				!RtlLinkPlt(&LoadedImage->DynamicInfo, LoadedImage->ImageBase, LoadedImage->Name))
 			{
 				DbgPrint("OSDLL: Module %s could not be linked.", LoadedImage->Name);
 				return STATUS_INVALID_EXECUTABLE;
@@ -655,45 +768,39 @@ BSTATUS OSDLLRunImage(PPEB Peb, OSDLL_ENTRY_POINT* OutEntryPoint)
 }
 
 HIDDEN
-uintptr_t OSDLLGetProcedureAddressInModule(PLOADED_IMAGE Image, const char* ProcName)
+uintptr_t OSDLLGetProcedureAddressInModule(PLOADED_IMAGE Image, const char* ProcName, uint32_t Hash)
 {
-	PELF_HASH_TABLE HashTable = Image->DynamicInfo.HashTable;
-	PELF_SYMBOL DynSymTable = Image->DynamicInfo.DynSymTable;
-	const char* DynStrTable = Image->DynamicInfo.DynStrTable;
-	uint32_t* Chains = &HashTable->Data[HashTable->BucketCount];
-	
-	if (!HashTable || HashTable->BucketCount == 0)
-	{
-		LdrDbgPrint("OSDLL: Module %s does not have a hash table.", Image->Name);
+	PELF_SYMBOL Symbol = RtlLookUpDynamicSymbol(&Image->DynamicInfo, ProcName, Hash);
+	if (!Symbol)
 		return 0;
-	}
-	
-	uint32_t NameHash = RtlElfHash(ProcName);
-	uint32_t BucketIndex = NameHash % HashTable->BucketCount;
-	
-	for (uint32_t SymbolIndex = HashTable->Data[BucketIndex];
-	     SymbolIndex != 0; // STN_UNDEF
-	     SymbolIndex = Chains[SymbolIndex])
-	{
-		PELF_SYMBOL Symbol = &DynSymTable[SymbolIndex];
-		const char* Name = DynStrTable + Symbol->Name;
-		
-		if (strcmp(Name, ProcName) == 0)
-			return Image->ImageBase + Symbol->Value;
-	}
 	
-	return 0;
+	return Image->ImageBase + Symbol->Value;
 }
 
 HIDDEN
 uintptr_t OSDLLGetProcedureAddress(const char* ProcName)
 {
+	uint32_t Hash = RtlGnuHash(ProcName);
+	uintptr_t Address = 0;
+	
+	OSEnterCriticalSection(&OSDllSymbolCacheLock);
+	
+	POSDLL_SYMBOL_CACHE_ENTRY* Bucket = &OSDllSymbolCache[Hash % OSDLL_SYMBOL_CACHE_BUCKETS];
+	for (POSDLL_SYMBOL_CACHE_ENTRY Entry = *Bucket; Entry; Entry = Entry->Next)
+	{
+		if (Entry->Hash == Hash && strcmp(Entry->Name, ProcName) == 0)
+		{
+			Address = Entry->Address;
+			goto Exit;
+		}
+	}
+	
 	PLIST_ENTRY DllEntry = OSDllsLoaded.Flink;
 	while (DllEntry != &OSDllsLoaded)
 	{
 		PLOADED_IMAGE LoadedImage = CONTAINING_RECORD(DllEntry, LOADED_IMAGE, ListEntry);
 		
-		uintptr_t Address = OSDLLGetProcedureAddressInModule(LoadedImage, ProcName);
+		Address = OSDLLGetProcedureAddressInModule(LoadedImage, ProcName, Hash);
 		if (Address)
 		{
 			LdrDbgPrint(
@@ -702,15 +809,65 @@ uintptr_t OSDLLGetProcedureAddress(const char* ProcName)
 				LoadedImage->Name,
 				Address
 			);
-			
-			return Address;
+			break;
 		}
 		
 		DllEntry = DllEntry->Flink;
 	}
 	
-	LdrDbgPrint("OSDLL: Cannot find address of procedure %s.", ProcName);
-	return 0;
+	if (!Address)
+	{
+		LdrDbgPrint("OSDLL: Cannot find address of procedure %s.", ProcName);
+		goto Exit;
+	}
+	
+	// The name belongs to the importing module's string table, which stays
+	// mapped, so it doesn't need to be copied.  If the allocation fails, the
+	// symbol simply isn't cached.
+	POSDLL_SYMBOL_CACHE_ENTRY Entry = OSAllocate(sizeof(OSDLL_SYMBOL_CACHE_ENTRY));
+	if (Entry)
+	{
+		Entry->Name = ProcName;
+		Entry->Address = Address;
+		Entry->Hash = Hash;
+		Entry->Next = *Bucket;
+		*Bucket = Entry;
+	}
+	
+Exit:
+	OSLeaveCriticalSection(&OSDllSymbolCacheLock);
+	return Address;
+}
+
+// Called by OSDLLLazyBindEntry the first time a lazily bound PLT entry is called.
+HIDDEN
+uintptr_t OSDLLBindLazySymbol(PLOADED_IMAGE Image, size_t Index)
+{
+	uintptr_t Address = RtlBindLazyPltEntry(&Image->DynamicInfo, Image->ImageBase, Index);
+	if (!Address)
+	{
+		DbgPrint("OSDLL: Module %s could not bind PLT entry %zu.", Image->Name, Index);
+		OSExitProcess(STATUS_INVALID_EXECUTABLE);
+	}
+	
+	return Address;
+}
+
+// Sets up lazy binding for a module's PLT, so that start-up doesn't have to look up
+// functions which the program will never call.  Returns false if the module must be
+// bound eagerly instead.
+HIDDEN
+bool OSDLLPrepareLazyPlt(UNUSED PLOADED_IMAGE Image)
+{
+#ifdef TARGET_AMD64
+	if (!RtlPrepareLazyPlt(&Image->DynamicInfo, Image->ImageBase, Image, (uintptr_t) OSDLLLazyBindEntry))
+		return false;
+	
+	LdrDbgPrint("OSDLL: Module %s will be bound lazily.", Image->Name);
+	return true;
+#else
+	return false;
+#endif
 }
 
 HIDDEN
@@ -840,6 +997,7 @@ static void OSDLLInitializeBasics()
 	OSInitializeExitCallbackList();
 	InitializeListHead(&OSDllLoadQueue);
 	InitializeListHead(&OSDllsLoaded);
+	OSInitializeCriticalSection(&OSDllSymbolCacheLock);
 	OSDLLAddSelfToDllList();
 }
 
@@ -4,7 +4,7 @@
 //  Created on 9/4/2026.
 //
 //  Implements the OSRegisterExitCallback() function, as well as the logic to call destructors upon
-//  an app's exit.
+//  an app's exit, and the cleanup done when a thread exits.
 //
 #include <boron.h>
 #include <rtl/assert.h>
@@ -86,3 +86,10 @@ void OSExitProcess(int ExitCode)
 	OSDLLDestroySharedObjects();
 	OSExitProcessInternal(ExitCode);
 }
+
+NO_RETURN
+void OSExitThread()
+{
+	OSDLLFlushHeapCache();
+	OSExitThreadInternal();
+}
@@ -12,6 +12,14 @@ PTEB OSDLLGetCurrentTeb()
 	return (PTEB) OSGetCurrentTeb();
 }
 
+PTEB OSDLLTryGetCurrentTeb()
+{
+	if (OSDLLGetCurrentPeb()->Override.BlockTebAccess)
+		return NULL;
+	
+	return (PTEB) OSGetCurrentTeb();
+}
+
 PPEB OSDLLGetCurrentPeb()
 {
 	return (PPEB) OSGetCurrentPeb();
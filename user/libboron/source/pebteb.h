@@ -3,6 +3,10 @@
 #include <pss.h>
 #include <eb.h>
 
+// Gets the current TEB, or NULL if there's none or it belongs to another library.
+// Unlike OSDLLGetCurrentTeb, this doesn't complain if the TEB can't be accessed.
+PTEB OSDLLTryGetCurrentTeb();
+
 // Creates a TEB but does not assign it to any thread.
 PTEB OSDLLCreateTebObject(PPEB Peb, HANDLE CurrentDirectory);
 
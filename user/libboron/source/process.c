@@ -199,6 +199,18 @@ BSTATUS OSCreateProcess(
 		CommandLine = AllocatedCmdLine;
 	}
 	
+	// If the environment wasn't specified, copy the one from our process.
+	if (!Environment)
+		Environment = OSDLLGetCurrentPeb()->Environment;
+	
+	// Let the kernel do all of the work in one go, if the image allows it.
+	Status = OSDLLSpawnProcess(OutHandle, OutMainThreadHandle, ObjectAttributes, ProcessFlags, ImageName, CommandLine, Environment);
+	if (Status != STATUS_UNIMPLEMENTED)
+	{
+		if (AllocatedCmdLine) OSFree(AllocatedCmdLine);
+		return Status;
+	}
+	
 	// Create the process.
 	Status = OSCreateProcessInternal(
 		OutHandle,
@@ -212,10 +224,6 @@ BSTATUS OSCreateProcess(
 	
 	ProcessHandle = *OutHandle;
 	
-	// If the environment wasn't specified, copy the one from our process.
-	if (!Environment)
-		Environment = OSDLLGetCurrentPeb()->Environment;
-	
 	// Create the PEB for this process.
 	size_t PebSize = 0;
 	Status = OSDLLCreatePebForProcess(&Peb, &PebSize, ImageName, CommandLine, Environment);
@@ -50,6 +50,10 @@ extern NO_RETURN HIDDEN void DLLEntryPoint(PPEB Peb);
 //
 // Thanks to https://github.com/managarm/mlibc for the inspiration.
 //
+// If OSSpawnProcess mapped Libboron.so from the image section cache, then
+// its pages are already relocated, and relocating them again would corrupt
+// the REL and RELR entries, which are applied by adding to them.
+//
 // TODO: Consider using automated testing to check if this function
 // contains relocations.
 //
@@ -91,6 +95,9 @@ void OSDLLRelocateSelf(PPEB Peb)
 	
 	uintptr_t ImageBase = RtlGetImageBase();
 	
+	if (Peb && Peb->Loader.InterpreterRelocated)
+		RelaSize = RelSize = RelrSize = 0;
+	
 	for (size_t i = 0; i < RelaSize; i += sizeof(ELF_RELA))
 	{
 		PELF_RELA Rela = (PELF_RELA) (ImageBase + RelaOffset + i);
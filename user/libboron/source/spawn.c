@@ -0,0 +1,284 @@
+#include <boron.h>
+#include <string.h>
+#include <rtl/elf.h>
+#include <rtl/cmdline.h>
+#include "pebteb.h"
+#include "dll.h"
+
+// The handle to libboron.so's own file.  Every spawned process maps it, so keep
+// it open instead of looking it up each time.
+static HANDLE OSDLLSelfHandle = HANDLE_NONE;
+
+static BSTATUS OSDLLGetSelfHandle(PHANDLE OutHandle)
+{
+	HANDLE Handle = __atomic_load_n(&OSDLLSelfHandle, __ATOMIC_ACQUIRE);
+	if (Handle != HANDLE_NONE)
+	{
+		*OutHandle = Handle;
+		return STATUS_SUCCESS;
+	}
+	
+	BSTATUS Status = OSDLLOpenSelf(&Handle);
+	if (FAILED(Status))
+		return Status;
+	
+	HANDLE Expected = HANDLE_NONE;
+	if (!__atomic_compare_exchange_n(&OSDLLSelfHandle, &Expected, Handle, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+	{
+		// Another thread got here first.
+		OSClose(Handle);
+		Handle = Expected;
+	}
+	
+	*OutHandle = Handle;
+	return STATUS_SUCCESS;
+}
+
+// Adds a view for each loadable segment of an image.
+static BSTATUS OSDLLAddSpawnViews(
+	PSPAWN_PARAMETERS Parameters,
+	PSPAWN_VIEW Views,
+	int ImageIndex,
+	PELF_HEADER ElfHeader,
+	uint8_t* ProgramHeaders
+)
+{
+	for (int i = 0; i < ElfHeader->ProgramHeaderCount; i++)
+	{
+		PELF_PROGRAM_HEADER ProgramHeader = (void*)(ProgramHeaders + i * ElfHeader->ProgramHeaderSize);
+		
+		if (ProgramHeader->Type != PROG_LOAD || ProgramHeader->SizeInMemory == 0)
+			continue;
+		
+		if (Parameters->ViewCount >= SPAWN_MAX_VIEWS)
+			return STATUS_UNIMPLEMENTED;
+		
+		// See OSDLLMapElfFile.
+		if ((ProgramHeader->Offset & (PAGE_SIZE - 1)) != (ProgramHeader->VirtualAddress & (PAGE_SIZE - 1)))
+			return STATUS_UNIMPLEMENTED;
+		
+		// Like OSDLLMapElfFile, map everything writable and copy-on-write.
+		int Protection = PAGE_WRITE;
+		if (ProgramHeader->Flags & ELF_PHDR_EXEC) Protection |= PAGE_EXECUTE;
+		if (ProgramHeader->Flags & ELF_PHDR_READ) Protection |= PAGE_READ;
+		
+		PSPAWN_VIEW View = &Views[Parameters->ViewCount++];
+		View->Image = ImageIndex;
+		View->Protection = Protection;
+		View->Address = ProgramHeader->VirtualAddress;
+		View->Size = ProgramHeader->SizeInMemory;
+		View->Offset = ProgramHeader->Offset;
+		View->SizeInFile = ProgramHeader->SizeInFile;
+	}
+	
+	return STATUS_SUCCESS;
+}
+
+static size_t OSDLLGetSpawnImageSize(PELF_HEADER ElfHeader, uint8_t* ProgramHeaders)
+{
+	// Executables which aren't position independent are mapped at their absolute addresses.
+	if (ElfHeader->Type != ELF_TYPE_DYNAMIC)
+		return 0;
+	
+	return OSDLLGetImageSize(ElfHeader, ProgramHeaders);
+}
+
+// Builds the mapping plan for the main image from its first page, which is
+// expected to contain the ELF header, the program headers and the interpreter's
+// name.  Anything else is left to OSDLLMapElfFile.
+static BSTATUS OSDLLPlanMainImage(
+	PSPAWN_PARAMETERS Parameters,
+	PSPAWN_VIEW Views,
+	PPEB Peb,
+	uint8_t* FirstPage,
+	size_t FirstPageSize,
+	bool* OutHasInterpreter
+)
+{
+	BSTATUS Status;
+	PELF_HEADER ElfHeader = (PELF_HEADER) FirstPage;
+	
+	if (FirstPageSize < sizeof(ELF_HEADER))
+		return STATUS_UNIMPLEMENTED;
+	
+	Status = RtlCheckValidity(ElfHeader);
+	if (FAILED(Status))
+		return Status;
+	
+	if (ElfHeader->Type != ELF_TYPE_EXECUTABLE && ElfHeader->Type != ELF_TYPE_DYNAMIC)
+		return STATUS_UNIMPLEMENTED;
+	
+	size_t ProgramHeadersEnd = ElfHeader->ProgramHeadersOffset + ElfHeader->ProgramHeaderCount * ElfHeader->ProgramHeaderSize;
+	if (ProgramHeadersEnd > FirstPageSize)
+		return STATUS_UNIMPLEMENTED;
+	
+	uint8_t* ProgramHeaders = FirstPage + ElfHeader->ProgramHeadersOffset;
+	bool HasFileHeader = false, HasProgramHeaders = false;
+	
+	*OutHasInterpreter = false;
+	
+	for (int i = 0; i < ElfHeader->ProgramHeaderCount; i++)
+	{
+		PELF_PROGRAM_HEADER ProgramHeader = (void*)(ProgramHeaders + i * ElfHeader->ProgramHeaderSize);
+		
+		switch (ProgramHeader->Type)
+		{
+			case PROG_LOAD:
+			{
+				if (ProgramHeader->Offset == 0 && ProgramHeader->SizeInFile >= ProgramHeadersEnd)
+				{
+					Peb->Loader.FileHeader = (void*) ProgramHeader->VirtualAddress;
+					HasFileHeader = true;
+				}
+				
+				break;
+			}
+			case PROG_PHDR:
+			{
+				Peb->Loader.ProgramHeaders = (void*) ProgramHeader->VirtualAddress;
+				HasProgramHeaders = true;
+				break;
+			}
+			case PROG_INTERP:
+			{
+				static const char LibBoron[] = "libboron.so";
+				
+				if (ProgramHeader->Offset + ProgramHeader->SizeInFile > FirstPageSize)
+					return STATUS_UNIMPLEMENTED;
+				
+				// Any other interpreter is opened by name.
+				const char* Interpreter = (const char*)(FirstPage + ProgramHeader->Offset);
+				if (ProgramHeader->SizeInFile < sizeof LibBoron || memcmp(Interpreter, LibBoron, sizeof LibBoron) != 0)
+					return STATUS_UNIMPLEMENTED;
+				
+				Peb->Loader.Interpreter = (const char*) ProgramHeader->VirtualAddress;
+				*OutHasInterpreter = true;
+				break;
+			}
+		}
+	}
+	
+	// The interpreter finds the main image through these.
+	if (!HasFileHeader || !HasProgramHeaders)
+		return STATUS_UNIMPLEMENTED;
+	
+	Parameters->Images[0].ImageSize = OSDLLGetSpawnImageSize(ElfHeader, ProgramHeaders);
+	Parameters->EntryImage = 0;
+	Parameters->EntryPoint = (uintptr_t) ElfHeader->EntryPoint;
+	
+	return OSDLLAddSpawnViews(Parameters, Views, 0, ElfHeader, ProgramHeaders);
+}
+
+// Adds libboron.so as the interpreter.  Its headers are read from its own image in memory.
+static BSTATUS OSDLLPlanInterpreter(PSPAWN_PARAMETERS Parameters, PSPAWN_VIEW Views)
+{
+	BSTATUS Status;
+	uintptr_t ImageBase = RtlGetImageBase();
+	PELF_HEADER ElfHeader = (PELF_HEADER) ImageBase;
+	
+	Status = RtlCheckValidity(ElfHeader);
+	if (FAILED(Status))
+		return STATUS_UNIMPLEMENTED;
+	
+	uint8_t* ProgramHeaders = (uint8_t*)(ImageBase + ElfHeader->ProgramHeadersOffset);
+	
+	PSPAWN_IMAGE Image = &Parameters->Images[1];
+	Status = OSDLLGetSelfHandle(&Image->FileHandle);
+	if (FAILED(Status))
+		return Status;
+	
+	Image->ImageSize = OSDLLGetSpawnImageSize(ElfHeader, ProgramHeaders);
+	Image->IsInterpreter = true;
+	
+	Parameters->ImageCount = 2;
+	Parameters->EntryImage = 1;
+	Parameters->EntryPoint = (uintptr_t) ElfHeader->EntryPoint;
+	
+	return OSDLLAddSpawnViews(Parameters, Views, 1, ElfHeader, ProgramHeaders);
+}
+
+HIDDEN
+BSTATUS OSDLLSpawnProcess(
+	PHANDLE OutHandle,
+	PHANDLE OutMainThreadHandle,
+	POBJECT_ATTRIBUTES ObjectAttributes,
+	int ProcessFlags,
+	const char* ImageName,
+	const char* CommandLine,
+	const char* Environment
+)
+{
+	BSTATUS Status;
+	IO_STATUS_BLOCK Iosb;
+	HANDLE FileHandle = HANDLE_NONE;
+	uint8_t* FirstPage = NULL;
+	PPEB Peb = NULL;
+	size_t PebSize = 0;
+	bool HasInterpreter = false;
+	
+	SPAWN_VIEW Views[SPAWN_MAX_VIEWS];
+	SPAWN_PARAMETERS Parameters;
+	memset(&Parameters, 0, sizeof Parameters);
+	
+	Status = OSDLLOpenFileByName(&FileHandle, ImageName, false);
+	if (FAILED(Status))
+	{
+		DbgPrint("OSDLL: Failed to open %s. %s (%d)", ImageName, RtlGetStatusString(Status), Status);
+		return Status;
+	}
+	
+	FirstPage = OSAllocate(PAGE_SIZE);
+	if (!FirstPage)
+	{
+		Status = STATUS_INSUFFICIENT_MEMORY;
+		goto Exit;
+	}
+	
+	Status = OSReadFile(&Iosb, FileHandle, 0, FirstPage, PAGE_SIZE, 0);
+	if (FAILED(Status))
+		goto Exit;
+	
+	Status = OSDLLCreatePebForProcess(&Peb, &PebSize, ImageName, CommandLine, Environment);
+	if (FAILED(Status))
+		goto Exit;
+	
+	Peb->Loader.MappedImage = true;
+	
+	Parameters.ImageCount = 1;
+	Parameters.Images[0].FileHandle = FileHandle;
+	Parameters.Views = Views;
+	
+	Status = OSDLLPlanMainImage(&Parameters, Views, Peb, FirstPage, (size_t) Iosb.BytesRead, &HasInterpreter);
+	if (FAILED(Status))
+		goto Exit;
+	
+	if (HasInterpreter)
+	{
+		Status = OSDLLPlanInterpreter(&Parameters, Views);
+		if (FAILED(Status))
+			goto Exit;
+	}
+	
+	// The kernel duplicates these into the new process, unless the handles are inherited.
+	PPEB CurrentPeb = OSDLLGetCurrentPeb();
+	for (int i = 0; i < 3; i++)
+		Peb->StandardIO[i] = CurrentPeb->StandardIO[i];
+	
+	const char* ExecutableName = RtlGetFileNameFromPath(ImageName);
+	
+	Parameters.InheritHandles   = ProcessFlags & OS_PROCESS_INHERIT_HANDLES;
+	Parameters.DeepCloneHandles = ProcessFlags & OS_PROCESS_DEEP_CLONE_HANDLES;
+	Parameters.CreateSuspended  = ProcessFlags & OS_PROCESS_CREATE_SUSPENDED;
+	Parameters.Peb = Peb;
+	Parameters.PebSize = PebSize;
+	Parameters.ImageName = ExecutableName;
+	Parameters.ImageNameLength = strlen(ExecutableName);
+	
+	Status = OSSpawnProcess(OutHandle, OutMainThreadHandle, ObjectAttributes, &Parameters);
+
+Exit:
+	if (Peb) OSFree(Peb);
+	if (FirstPage) OSFree(FirstPage);
+	OSClose(FileHandle);
+	return Status;
+}